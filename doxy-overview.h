@@ -14,6 +14,7 @@ Tkrzw is a C++ library implementing DBM with various algorithms.  It features hi
 @li tkrzw::SkipDBM -- File database manager implementation based on skip list.
 @li tkrzw::TinyDBM -- On-memory database manager implementation based on hash table.
 @li tkrzw::BabyDBM -- On-memory database manager implementation based on B+ tree.
+@li tkrzw::RadixDBM -- On-memory database manager implementation based on adaptive radix tree.
 @li tkrzw::CacheDBM -- On-memory database manager implementations with LRU deletion.
 @li tkrzw::StdHashDBM -- On-memory hash database manager implementation using std::unordered_map.
 @li tkrzw::StdTreeDBM -- On-memory tree database manager implementation using std::map.
@@ -84,6 +85,8 @@ namespace tkrzw {}
  * @file tkrzw_file.h File interface.
  * @file tkrzw_file_mmap.h File implementations by memory mapping.
  * @file tkrzw_file_pos.h File implementations by positional access.
+ * @file tkrzw_file_uring.h File implementation by io_uring.
+ * @file tkrzw_file_direct.h File implementation by direct I/O.
  * @file tkrzw_dbm.h Database manager interface.
  * @file tkrzw_dbm_common_impl.h Common implementation components for database managers.
  * @file tkrzw_dbm_hash_impl.h Implementation components for the hash database manager.
@@ -94,6 +97,7 @@ namespace tkrzw {}
  * @file tkrzw_dbm_skip.h File database manager implementation based on skip list.
  * @file tkrzw_dbm_tiny.h On-memory database manager implementations based on hash table.
  * @file tkrzw_dbm_baby.h On-memory database manager implementations based on B+ tree.
+ * @file tkrzw_dbm_radix.h On-memory database manager implementations based on adaptive radix tree.
  * @file tkrzw_dbm_cache.h On-memory database manager implementations with LRU deletion.
  * @file tkrzw_dbm_std.h On-memory database manager implementations with the C++ standard containers.
  * @file tkrzw_dbm_poly.h Polymorphic database manager adapter.
@@ -250,6 +250,10 @@ std::unique_ptr<File> MakeFileOrDie(
     file = std::make_unique<PositionalParallelFile>();
   } else if (impl_name == "pos-atom") {
     file = std::make_unique<PositionalAtomicFile>();
+  } else if (impl_name == "uring") {
+    file = std::make_unique<IoUringParallelFile>();
+  } else if (impl_name == "direct") {
+    file = std::make_unique<DirectIOFile>();
   } else {
     Die("Unknown File implementation: ", impl_name);
   }
@@ -32,6 +32,7 @@
 #include "tkrzw_containers.h"
 #include "tkrzw_dbm.h"
 #include "tkrzw_dbm_baby.h"
+#include "tkrzw_dbm_radix.h"
 #include "tkrzw_dbm_cache.h"
 #include "tkrzw_dbm_common_impl.h"
 #include "tkrzw_dbm_hash.h"
@@ -45,8 +46,10 @@
 #include "tkrzw_dbm_tree.h"
 #include "tkrzw_dbm_tree_impl.h"
 #include "tkrzw_file.h"
+#include "tkrzw_file_direct.h"
 #include "tkrzw_file_mmap.h"
 #include "tkrzw_file_pos.h"
+#include "tkrzw_file_uring.h"
 #include "tkrzw_file_util.h"
 #include "tkrzw_index.h"
 #include "tkrzw_key_comparators.h"
@@ -236,7 +239,7 @@ inline void Die(const FIRST& first, const REST&... rest) {
  * Makes a file object or die.
  * @param impl_name The name of a File implementation: "mmap-para" for MemoryMapParallelFile,
  * "mmap-atom" for MemoryMapAtomicFile, "pos-para" for PositionalParallelFile. "pos-atom" fo
- * PositionalAtomicFile,
+ * PositionalAtomicFile, "uring" for IoUringParallelFile, "direct" for DirectIOFile.
  * @param alloc_init_size An initial size of allocation.
  * @param alloc_inc_factor A factor to increase the size of allocation.
  * @return The created object.
@@ -197,6 +197,10 @@ TEST(CmdUtilTest, MakeFileOrDie) {
             typeid(*tkrzw::MakeFileOrDie("pos-para", 1 << 10, 2)));
   EXPECT_EQ(typeid(tkrzw::PositionalAtomicFile),
             typeid(*tkrzw::MakeFileOrDie("pos-atom", 1 << 10, 2)));
+  EXPECT_EQ(typeid(tkrzw::IoUringParallelFile),
+            typeid(*tkrzw::MakeFileOrDie("uring", 1 << 10, 2)));
+  EXPECT_EQ(typeid(tkrzw::DirectIOFile),
+            typeid(*tkrzw::MakeFileOrDie("direct", 1 << 10, 2)));
   EXPECT_THROW({
       tkrzw::MakeFileOrDie("foo", 0, 0);
     }, tkrzw::StatusException);
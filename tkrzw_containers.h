@@ -22,6 +22,7 @@
 #include <vector>
 
 #include <cinttypes>
+#include <cstdlib>
 #include <cstring>
 
 #include "tkrzw_lib_common.h"
@@ -866,6 +867,182 @@ class AtomicSet final {
   std::mutex mutex_;
 };
 
+/**
+ * Allocator of memory blocks in size classes, which are cut out of large slabs.
+ * @details Blocks up to MAX_SLAB_BLOCK_SIZE are cut out of slabs shared by the same size class
+ * and recycled through free lists, which saves the header and fragmentation of the general
+ * allocator for small objects.  A slab all of whose blocks are deallocated is returned to the
+ * system, except one spare slab kept for the next class which needs one.  Larger blocks are
+ * allocated individually.  In both cases, the
+ * requested size is rounded up to the size class, which is a multiple of 16 up to 128 and four
+ * steps between each power of two above that.  The size given to Reallocate and Deallocate must
+ * be the one given to the last Allocate or Reallocate for the block.  All operations are
+ * thread-safe.
+ */
+class SlabAllocator final {
+ public:
+  /** The size of each slab. */
+  static constexpr int32_t SLAB_SIZE = 1 << 16;
+  /** The maximum size of blocks cut out of slabs. */
+  static constexpr int32_t MAX_SLAB_BLOCK_SIZE = 4096;
+
+  /**
+   * Constructor.
+   */
+  SlabAllocator();
+
+  /**
+   * Destructor.
+   * @details All slabs are released.  Blocks larger than MAX_SLAB_BLOCK_SIZE are not released.
+   */
+  ~SlabAllocator();
+
+  /**
+   * Copy and assignment are disabled.
+   */
+  explicit SlabAllocator(const SlabAllocator& rhs) = delete;
+  SlabAllocator& operator =(const SlabAllocator& rhs) = delete;
+
+  /**
+   * Allocates a block.
+   * @param size The size of the block.
+   * @return The pointer to the block, which is aligned to 16 bytes.
+   */
+  void* Allocate(size_t size);
+
+  /**
+   * Reallocates a block.
+   * @param ptr The pointer to the block, or nullptr to allocate a new one.
+   * @param old_size The current size of the block.
+   * @param new_size The new size of the block.
+   * @return The pointer to the block, which is the same as the given one if the size class
+   * doesn't change.
+   */
+  void* Reallocate(void* ptr, size_t old_size, size_t new_size);
+
+  /**
+   * Deallocates a block.
+   * @param ptr The pointer to the block.
+   * @param size The current size of the block.
+   */
+  void Deallocate(void* ptr, size_t size);
+
+  /**
+   * Releases all slabs at once.
+   * @details Blocks cut out of slabs become invalid without being deallocated.  Blocks larger
+   * than MAX_SLAB_BLOCK_SIZE must be deallocated individually beforehand.
+   */
+  void Clear();
+
+  /**
+   * Gets the total size of memory obtained from the system.
+   * @return The total size of slabs and large blocks, which includes free blocks in the slabs
+   * and the spare slab.
+   */
+  int64_t GetReservedSize() const;
+
+  /**
+   * Gets the total size of memory occupied by blocks including free ones.
+   * @return The total size of the regions cut out of slabs, including free blocks and the slab
+   * headers, and large blocks.  Parts of slabs which have never been cut out are excluded.
+   */
+  int64_t GetOccupiedSize() const;
+
+  /**
+   * Gets the total size of blocks in use.
+   * @return The total size of blocks in use, rounded up to their size classes.
+   */
+  int64_t GetUsedSize() const;
+
+  /**
+   * Gets the number of blocks in use.
+   * @return The number of blocks in use.
+   */
+  int64_t GetNumBlocks() const;
+
+  /**
+   * Gets the size class of a block.
+   * @param size The requested size of the block.
+   * @return The actual size occupied by the block.
+   */
+  static size_t GetClassSize(size_t size);
+
+ private:
+  /** The number of size classes cut out of slabs. */
+  static constexpr int32_t NUM_SLAB_CLASSES = 28;
+  /** The size of the header at the top of each slab. */
+  static constexpr int32_t SLAB_HEADER_SIZE = 64;
+
+  /**
+   * Header at the top of a slab, which is aligned to SLAB_SIZE.
+   */
+  struct SlabHeader final {
+    /** The previous slab of the same class. */
+    SlabHeader* prev;
+    /** The next slab of the same class. */
+    SlabHeader* next;
+    /** The previous slab with free blocks. */
+    SlabHeader* free_prev;
+    /** The next slab with free blocks. */
+    SlabHeader* free_next;
+    /** The head of the free list. */
+    void* free_list;
+    /** The number of blocks in use. */
+    int32_t num_used;
+    /** The size of the region cut out into blocks, including the header. */
+    int32_t cut_size;
+  };
+  static_assert(sizeof(SlabHeader) <= SLAB_HEADER_SIZE);
+
+  /**
+   * Slabs and free blocks of a size class.
+   */
+  struct SizeClass final {
+    /** All slabs of the class. */
+    SlabHeader* slabs = nullptr;
+    /** The slabs with free blocks. */
+    SlabHeader* free_slabs = nullptr;
+    /** The slab from which new blocks are cut out. */
+    SlabHeader* current = nullptr;
+    /** The position to cut out the next block in the current slab. */
+    char* cursor = nullptr;
+    /** The mutex for the class. */
+    std::mutex mutex;
+  };
+
+  /**
+   * Gets the index of the size class cut out of slabs.
+   * @param class_size The size class.
+   * @return The index of the size class.
+   */
+  static int32_t GetClassIndex(size_t class_size);
+
+  /**
+   * Gets a slab from the spare or the system.
+   * @return The pointer to the slab.
+   */
+  SlabHeader* AcquireSlab();
+
+  /**
+   * Keeps a slab as the spare or returns it to the system.
+   * @param slab The pointer to the slab.
+   */
+  void ReleaseSlab(SlabHeader* slab);
+
+  /** The size classes cut out of slabs. */
+  SizeClass classes_[NUM_SLAB_CLASSES];
+  /** The empty slab kept for reuse. */
+  std::atomic<SlabHeader*> spare_slab_;
+  /** The total size of memory obtained from the system. */
+  std::atomic_int64_t reserved_size_;
+  /** The total size of regions cut out of slabs and large blocks. */
+  std::atomic_int64_t occupied_size_;
+  /** The total size of blocks in use. */
+  std::atomic_int64_t used_size_;
+  /** The number of blocks in use. */
+  std::atomic_int64_t num_blocks_;
+};
+
 /**
  * Adds a pair of a cont and a payload to a heap vector.
  * @param cost The cost.
@@ -1710,6 +1887,225 @@ inline void AtomicSet<VALUETYPE>::Clear() {
   empty_.store(true);
 }
 
+inline SlabAllocator::SlabAllocator() :
+    classes_(), spare_slab_(nullptr), reserved_size_(0), occupied_size_(0),
+    used_size_(0), num_blocks_(0) {}
+
+inline SlabAllocator::~SlabAllocator() {
+  Clear();
+}
+
+inline void* SlabAllocator::Allocate(size_t size) {
+  const size_t class_size = GetClassSize(size);
+  used_size_.fetch_add(class_size);
+  num_blocks_.fetch_add(1);
+  if (class_size > static_cast<size_t>(MAX_SLAB_BLOCK_SIZE)) {
+    reserved_size_.fetch_add(class_size);
+    occupied_size_.fetch_add(class_size);
+    return xmalloc(class_size);
+  }
+  SizeClass& size_class = classes_[GetClassIndex(class_size)];
+  std::lock_guard<std::mutex> lock(size_class.mutex);
+  SlabHeader* slab = size_class.free_slabs;
+  if (slab != nullptr) {
+    void* ptr = slab->free_list;
+    std::memcpy(&slab->free_list, ptr, sizeof(slab->free_list));
+    slab->num_used++;
+    if (slab->free_list == nullptr) {
+      size_class.free_slabs = slab->free_next;
+      if (slab->free_next != nullptr) {
+        slab->free_next->free_prev = nullptr;
+      }
+    }
+    return ptr;
+  }
+  if (size_class.current == nullptr ||
+      static_cast<size_t>(reinterpret_cast<char*>(size_class.current) + SLAB_SIZE -
+                          size_class.cursor) < class_size) {
+    slab = AcquireSlab();
+    slab->prev = nullptr;
+    slab->next = size_class.slabs;
+    if (size_class.slabs != nullptr) {
+      size_class.slabs->prev = slab;
+    }
+    size_class.slabs = slab;
+    size_class.current = slab;
+    size_class.cursor = reinterpret_cast<char*>(slab) + SLAB_HEADER_SIZE;
+    slab->cut_size = SLAB_HEADER_SIZE;
+    occupied_size_.fetch_add(SLAB_HEADER_SIZE);
+  }
+  void* ptr = size_class.cursor;
+  size_class.cursor += class_size;
+  size_class.current->num_used++;
+  size_class.current->cut_size += class_size;
+  occupied_size_.fetch_add(class_size);
+  return ptr;
+}
+
+inline void* SlabAllocator::Reallocate(void* ptr, size_t old_size, size_t new_size) {
+  if (ptr == nullptr) {
+    return Allocate(new_size);
+  }
+  const size_t old_class_size = GetClassSize(old_size);
+  const size_t new_class_size = GetClassSize(new_size);
+  if (old_class_size == new_class_size) {
+    return ptr;
+  }
+  if (old_class_size > static_cast<size_t>(MAX_SLAB_BLOCK_SIZE) &&
+      new_class_size > static_cast<size_t>(MAX_SLAB_BLOCK_SIZE)) {
+    const int64_t diff = static_cast<int64_t>(new_class_size) - old_class_size;
+    used_size_.fetch_add(diff);
+    reserved_size_.fetch_add(diff);
+    occupied_size_.fetch_add(diff);
+    return xrealloc(ptr, new_class_size);
+  }
+  void* new_ptr = Allocate(new_size);
+  std::memcpy(new_ptr, ptr, std::min(old_size, new_size));
+  Deallocate(ptr, old_size);
+  return new_ptr;
+}
+
+inline void SlabAllocator::Deallocate(void* ptr, size_t size) {
+  const size_t class_size = GetClassSize(size);
+  used_size_.fetch_sub(class_size);
+  num_blocks_.fetch_sub(1);
+  if (class_size > static_cast<size_t>(MAX_SLAB_BLOCK_SIZE)) {
+    reserved_size_.fetch_sub(class_size);
+    occupied_size_.fetch_sub(class_size);
+    xfree(ptr);
+    return;
+  }
+  SizeClass& size_class = classes_[GetClassIndex(class_size)];
+  SlabHeader* slab = reinterpret_cast<SlabHeader*>(
+      reinterpret_cast<uintptr_t>(ptr) & ~static_cast<uintptr_t>(SLAB_SIZE - 1));
+  std::lock_guard<std::mutex> lock(size_class.mutex);
+  const bool was_full = slab->free_list == nullptr;
+  std::memcpy(ptr, &slab->free_list, sizeof(slab->free_list));
+  slab->free_list = ptr;
+  slab->num_used--;
+  if (slab->num_used > 0) {
+    if (was_full) {
+      slab->free_prev = nullptr;
+      slab->free_next = size_class.free_slabs;
+      if (size_class.free_slabs != nullptr) {
+        size_class.free_slabs->free_prev = slab;
+      }
+      size_class.free_slabs = slab;
+    }
+    return;
+  }
+  if (!was_full) {
+    if (slab->free_prev == nullptr) {
+      size_class.free_slabs = slab->free_next;
+    } else {
+      slab->free_prev->free_next = slab->free_next;
+    }
+    if (slab->free_next != nullptr) {
+      slab->free_next->free_prev = slab->free_prev;
+    }
+  }
+  if (slab->prev == nullptr) {
+    size_class.slabs = slab->next;
+  } else {
+    slab->prev->next = slab->next;
+  }
+  if (slab->next != nullptr) {
+    slab->next->prev = slab->prev;
+  }
+  if (slab == size_class.current) {
+    size_class.current = nullptr;
+    size_class.cursor = nullptr;
+  }
+  occupied_size_.fetch_sub(slab->cut_size);
+  ReleaseSlab(slab);
+}
+
+inline void SlabAllocator::Clear() {
+  for (auto& size_class : classes_) {
+    std::lock_guard<std::mutex> lock(size_class.mutex);
+    SlabHeader* slab = size_class.slabs;
+    while (slab != nullptr) {
+      SlabHeader* next = slab->next;
+      std::free(slab);
+      slab = next;
+    }
+    size_class.slabs = nullptr;
+    size_class.free_slabs = nullptr;
+    size_class.current = nullptr;
+    size_class.cursor = nullptr;
+  }
+  std::free(spare_slab_.exchange(nullptr));
+  reserved_size_.store(0);
+  occupied_size_.store(0);
+  used_size_.store(0);
+  num_blocks_.store(0);
+}
+
+inline SlabAllocator::SlabHeader* SlabAllocator::AcquireSlab() {
+  SlabHeader* slab = spare_slab_.exchange(nullptr);
+  if (slab == nullptr) {
+    slab = static_cast<SlabHeader*>(std::aligned_alloc(SLAB_SIZE, SLAB_SIZE));
+    if (slab == nullptr) {
+      throw std::bad_alloc();
+    }
+    reserved_size_.fetch_add(SLAB_SIZE);
+  }
+  slab->free_prev = nullptr;
+  slab->free_next = nullptr;
+  slab->free_list = nullptr;
+  slab->num_used = 0;
+  slab->cut_size = 0;
+  return slab;
+}
+
+inline void SlabAllocator::ReleaseSlab(SlabHeader* slab) {
+  SlabHeader* expected = nullptr;
+  if (!spare_slab_.compare_exchange_strong(expected, slab)) {
+    reserved_size_.fetch_sub(SLAB_SIZE);
+    std::free(slab);
+  }
+}
+
+inline int64_t SlabAllocator::GetReservedSize() const {
+  return reserved_size_.load();
+}
+
+inline int64_t SlabAllocator::GetOccupiedSize() const {
+  return occupied_size_.load();
+}
+
+inline int64_t SlabAllocator::GetUsedSize() const {
+  return used_size_.load();
+}
+
+inline int64_t SlabAllocator::GetNumBlocks() const {
+  return num_blocks_.load();
+}
+
+inline size_t SlabAllocator::GetClassSize(size_t size) {
+  if (size <= 128) {
+    return size <= 16 ? 16 : (size + 15) & ~static_cast<size_t>(15);
+  }
+  int32_t exp = 7;
+  while (((size - 1) >> (exp + 1)) != 0) {
+    exp++;
+  }
+  const size_t step = static_cast<size_t>(1) << (exp - 2);
+  return (size + step - 1) & ~(step - 1);
+}
+
+inline int32_t SlabAllocator::GetClassIndex(size_t class_size) {
+  if (class_size <= 128) {
+    return class_size / 16 - 1;
+  }
+  int32_t exp = 7;
+  while (((class_size - 1) >> (exp + 1)) != 0) {
+    exp++;
+  }
+  const size_t step = static_cast<size_t>(1) << (exp - 2);
+  return 8 + (exp - 7) * 4 + (class_size - (static_cast<size_t>(1) << exp)) / step - 1;
+}
+
 }  // namespace tkrzw
 
 #endif  // _TKRZW_CONTAINER_H
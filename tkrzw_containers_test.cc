@@ -434,6 +434,102 @@ TEST(AtomicSetTest, Basic) {
   EXPECT_FALSE(set.Remove("2"));
 }
 
+TEST(SlabAllocatorTest, Basic) {
+  EXPECT_EQ(16, tkrzw::SlabAllocator::GetClassSize(1));
+  EXPECT_EQ(16, tkrzw::SlabAllocator::GetClassSize(16));
+  EXPECT_EQ(32, tkrzw::SlabAllocator::GetClassSize(17));
+  EXPECT_EQ(128, tkrzw::SlabAllocator::GetClassSize(128));
+  EXPECT_EQ(160, tkrzw::SlabAllocator::GetClassSize(129));
+  EXPECT_EQ(256, tkrzw::SlabAllocator::GetClassSize(256));
+  EXPECT_EQ(320, tkrzw::SlabAllocator::GetClassSize(257));
+  EXPECT_EQ(4096, tkrzw::SlabAllocator::GetClassSize(4000));
+  EXPECT_EQ(5120, tkrzw::SlabAllocator::GetClassSize(4097));
+  tkrzw::SlabAllocator alloc;
+  std::vector<std::pair<char*, size_t>> blocks;
+  for (int32_t i = 0; i < 10000; i++) {
+    const size_t size = i % 5000 + 1;
+    char* ptr = static_cast<char*>(alloc.Allocate(size));
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(ptr) % 16);
+    std::memset(ptr, i % 256, size);
+    blocks.emplace_back(ptr, size);
+  }
+  EXPECT_EQ(10000, alloc.GetNumBlocks());
+  EXPECT_GE(alloc.GetReservedSize(), alloc.GetOccupiedSize());
+  EXPECT_GE(alloc.GetOccupiedSize(), alloc.GetUsedSize());
+  for (int32_t i = 0; i < static_cast<int32_t>(blocks.size()); i++) {
+    auto& block = blocks[i];
+    for (size_t j = 0; j < block.second; j++) {
+      ASSERT_EQ(static_cast<char>(i % 256), block.first[j]);
+    }
+    if (i % 3 == 0) {
+      const size_t new_size = block.second * 2 + 1;
+      block.first = static_cast<char*>(alloc.Reallocate(block.first, block.second, new_size));
+      for (size_t j = 0; j < block.second; j++) {
+        ASSERT_EQ(static_cast<char>(i % 256), block.first[j]);
+      }
+      block.second = new_size;
+    }
+  }
+  int64_t used_size = 0;
+  for (const auto& block : blocks) {
+    used_size += tkrzw::SlabAllocator::GetClassSize(block.second);
+  }
+  EXPECT_EQ(used_size, alloc.GetUsedSize());
+  const int64_t reserved_size = alloc.GetReservedSize();
+  for (int32_t i = 0; i < static_cast<int32_t>(blocks.size()); i += 2) {
+    alloc.Deallocate(blocks[i].first, blocks[i].second);
+    blocks[i].first = static_cast<char*>(alloc.Allocate(blocks[i].second));
+  }
+  EXPECT_EQ(used_size, alloc.GetUsedSize());
+  EXPECT_EQ(reserved_size, alloc.GetReservedSize());
+  for (const auto& block : blocks) {
+    alloc.Deallocate(block.first, block.second);
+  }
+  EXPECT_EQ(0, alloc.GetNumBlocks());
+  EXPECT_EQ(0, alloc.GetUsedSize());
+  EXPECT_EQ(0, alloc.GetOccupiedSize());
+  EXPECT_LE(alloc.GetReservedSize(), tkrzw::SlabAllocator::SLAB_SIZE);
+  alloc.Clear();
+  EXPECT_EQ(0, alloc.GetReservedSize());
+  void* ptr = alloc.Reallocate(nullptr, 0, 100);
+  EXPECT_EQ(1, alloc.GetNumBlocks());
+  alloc.Deallocate(ptr, 100);
+}
+
+TEST(SlabAllocatorTest, Churn) {
+  tkrzw::SlabAllocator alloc;
+  std::vector<void*> blocks;
+  for (int32_t size = 16; size <= 1024; size *= 2) {
+    for (int32_t i = 0; i < 10000; i++) {
+      blocks.emplace_back(alloc.Allocate(size));
+    }
+    EXPECT_GE(alloc.GetReservedSize(), 10000 * size);
+    for (auto* ptr : blocks) {
+      alloc.Deallocate(ptr, size);
+    }
+    blocks.clear();
+    EXPECT_EQ(0, alloc.GetOccupiedSize());
+    EXPECT_LE(alloc.GetReservedSize(), tkrzw::SlabAllocator::SLAB_SIZE);
+  }
+  for (int32_t i = 0; i < 10000; i++) {
+    blocks.emplace_back(alloc.Allocate(100));
+  }
+  const int64_t occupied_size = alloc.GetOccupiedSize();
+  for (int32_t i = 0; i < 10000; i += 2) {
+    alloc.Deallocate(blocks[i], 100);
+  }
+  EXPECT_EQ(occupied_size, alloc.GetOccupiedSize());
+  EXPECT_EQ(5000 * tkrzw::SlabAllocator::GetClassSize(100), alloc.GetUsedSize());
+  for (int32_t i = 0; i < 10000; i += 2) {
+    blocks[i] = alloc.Allocate(100);
+  }
+  EXPECT_EQ(occupied_size, alloc.GetOccupiedSize());
+  for (auto* ptr : blocks) {
+    alloc.Deallocate(ptr, 100);
+  }
+  EXPECT_EQ(0, alloc.GetNumBlocks());
+}
+
 TEST(MiscTest, HeapByCost) {
   constexpr size_t capacity = 5;
   std::vector<std::pair<int32_t, int32_t>> heap;
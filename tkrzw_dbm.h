@@ -14,6 +14,7 @@
 #ifndef _TKRZW_DBM_H
 #define _TKRZW_DBM_H
 
+#include <future>
 #include <initializer_list>
 #include <memory>
 #include <string>
@@ -26,6 +27,7 @@
 #include "tkrzw_file.h"
 #include "tkrzw_lib_common.h"
 #include "tkrzw_str_util.h"
+#include "tkrzw_thread_util.h"
 
 namespace tkrzw {
 
@@ -701,6 +703,25 @@ class DBM {
     return records;
   }
 
+  /**
+   * Gets the value of a record of a key asynchronously.
+   * @param key The key of the record.
+   * @return The future of a pair of the result status and the value of the matching record.
+   * @details The default implementation does Get in a worker thread of the shared I/O queue,
+   * which is given by TaskQueue::GetSharedIOQueue.  The database must not be closed until the
+   * future becomes ready.
+   */
+  virtual std::future<std::pair<Status, std::string>> GetAsync(std::string_view key) {
+    auto promise = std::make_shared<std::promise<std::pair<Status, std::string>>>();
+    auto future = promise->get_future();
+    TaskQueue::GetSharedIOQueue()->Add([this, key = std::string(key), promise]() {
+      std::string value;
+      const Status status = Get(key, &value);
+      promise->set_value(std::make_pair(status, std::move(value)));
+    });
+    return future;
+  }
+
   /**
    * Sets a record of a key and a value.
    * @param key The key of the record.
@@ -720,6 +741,29 @@ class DBM {
     return impl_status;
   }
 
+  /**
+   * Sets a record of a key and a value asynchronously.
+   * @param key The key of the record.
+   * @param value The value of the record.
+   * @param overwrite Whether to overwrite the existing value if there's a record with the same
+   * key.  If true, the existing value is overwritten by the new value.  If false, the operation
+   * is given up and an error status is returned.
+   * @return The future of the result status.
+   * @details The default implementation does Set in a worker thread of the shared I/O queue,
+   * which is given by TaskQueue::GetSharedIOQueue.  The database must not be closed until the
+   * future becomes ready.
+   */
+  virtual std::future<Status> SetAsync(
+      std::string_view key, std::string_view value, bool overwrite = true) {
+    auto promise = std::make_shared<std::promise<Status>>();
+    auto future = promise->get_future();
+    TaskQueue::GetSharedIOQueue()->Add(
+        [this, key = std::string(key), value = std::string(value), overwrite, promise]() {
+          promise->set_value(Set(key, value, overwrite));
+        });
+    return future;
+  }
+
   /**
    * Sets multiple records.
    * @param records The records to store.
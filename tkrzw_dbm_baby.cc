@@ -31,6 +31,14 @@ constexpr int32_t MAX_LEAF_NODE_RECORDS = 256;
 constexpr int32_t MAX_INNER_NODE_BRANCHES = 256;
 constexpr int32_t TREE_LEVEL_MAX = 20;
 constexpr int32_t ITER_BUFFER_SIZE = 128;
+constexpr int32_t RECORD_ARRAY_MIN_CAPACITY = 8;
+constexpr int32_t OPTIMISTIC_READ_RETRIES = 4;
+constexpr int32_t OPTIMISTIC_READ_BUFFER_SIZE = 256;
+constexpr int32_t ARENA_MIN_CHUNK_SIZE = 512;
+constexpr int32_t ARENA_MAX_CHUNK_SIZE = 32768;
+constexpr int64_t SNAPSHOT_BUFFER_SIZE = 1LL << 20;
+constexpr char SNAPSHOT_MAGIC[8] = {'T', 'k', 'r', 'z', 'w', 'B', 'S', 'N'};
+constexpr uint32_t SNAPSHOT_ENDIAN_MARK = 0x01020304;
 
 struct BabyRecord final {
   int32_t key_size;
@@ -39,12 +47,143 @@ struct BabyRecord final {
   std::string_view GetValue() const;
 };
 
-BabyRecord* CreateBabyRecord(std::string_view key, std::string_view value);
-BabyRecord* ModifyBabyRecord(BabyRecord* record, std::string_view new_value);
+struct BabySnapshotHeader final {
+  char magic[sizeof(SNAPSHOT_MAGIC)];
+  uint32_t endian_mark;
+  int32_t record_align;
+  int64_t num_records;
+  int64_t records_offset;
+  int64_t end_offset;
+  int64_t reserved;
+};
+
+struct BabyArenaChunk final {
+  BabyArenaChunk* next;
+  int32_t capacity;
+  int32_t used;
+  char* GetData();
+};
+
+class BabyRecordArena final {
+ public:
+  explicit BabyRecordArena(EpochReclaimer* reclaimer);
+  ~BabyRecordArena();
+  BabyRecord* Allocate(int32_t size, int64_t reserve = 0);
+  bool Resize(BabyRecord* record, int32_t new_size);
+  void Release(const BabyRecord* record);
+  void Adopt(int64_t size);
+  bool ShouldCompact() const;
+  void Retire();
+  void swap(BabyRecordArena& other);
+  int64_t GetCapacity() const;
+  int64_t GetUsedSize() const;
+  int64_t GetLiveSize() const;
+  static int32_t GetAllocSize(int32_t size);
+
+ private:
+  EpochReclaimer* reclaimer_;
+  BabyArenaChunk* head_;
+  int64_t capacity_;
+  int64_t used_size_;
+  int64_t live_size_;
+};
+
+BabyRecord* CreateBabyRecord(
+    BabyRecordArena* arena, std::string_view key, std::string_view value);
+BabyRecord* ModifyBabyRecord(
+    BabyRecordArena* arena, BabyRecord* record, std::string_view new_value);
 BabyRecord* AppendBabyRecord(
-    BabyRecord* record, std::string_view cat_value, std::string_view cat_delim);
-void FreeBabyRecord(BabyRecord* record);
-void FreeBabyRecords(std::vector<BabyRecord*>* records);
+    BabyRecordArena* arena, BabyRecord* record,
+    std::string_view cat_value, std::string_view cat_delim);
+
+class BabyRecordArray final {
+ public:
+  class Iterator final {
+   public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef BabyRecord* value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const std::atomic<BabyRecord*>* pointer;
+    typedef BabyRecord* reference;
+    explicit Iterator(pointer ptr = nullptr) : ptr_(ptr) {}
+    BabyRecord* operator *() const {
+      return ptr_->load(std::memory_order_acquire);
+    }
+    Iterator& operator ++() {
+      ++ptr_;
+      return *this;
+    }
+    Iterator& operator --() {
+      --ptr_;
+      return *this;
+    }
+    Iterator& operator +=(difference_type diff) {
+      ptr_ += diff;
+      return *this;
+    }
+    Iterator& operator -=(difference_type diff) {
+      ptr_ -= diff;
+      return *this;
+    }
+    Iterator operator +(difference_type diff) const {
+      return Iterator(ptr_ + diff);
+    }
+    Iterator operator -(difference_type diff) const {
+      return Iterator(ptr_ - diff);
+    }
+    difference_type operator -(const Iterator& rhs) const {
+      return ptr_ - rhs.ptr_;
+    }
+    bool operator ==(const Iterator& rhs) const {
+      return ptr_ == rhs.ptr_;
+    }
+    bool operator !=(const Iterator& rhs) const {
+      return ptr_ != rhs.ptr_;
+    }
+    bool operator <(const Iterator& rhs) const {
+      return ptr_ < rhs.ptr_;
+    }
+    bool operator >(const Iterator& rhs) const {
+      return ptr_ > rhs.ptr_;
+    }
+   private:
+    friend class BabyRecordArray;
+    pointer ptr_;
+  };
+
+  explicit BabyRecordArray(EpochReclaimer* reclaimer);
+  ~BabyRecordArray();
+  Iterator begin() const;
+  Iterator end() const;
+  int32_t size() const;
+  int32_t capacity() const;
+  bool empty() const;
+  BabyRecord* front() const;
+  BabyRecord* back() const;
+  void reserve(int32_t capacity);
+  void shrink_to_fit();
+  Iterator insert(Iterator pos, BabyRecord* record);
+  void append(Iterator first, Iterator last);
+  void emplace_back(BabyRecord* record);
+  void replace(Iterator pos, BabyRecord* record);
+  void erase(Iterator pos);
+  void erase(Iterator first, Iterator last);
+  void clear();
+  void swap(BabyRecordArray& other);
+  Iterator SnapshotForRead(Iterator* end) const;
+
+ private:
+  struct Buffer final {
+    int32_t capacity;
+    std::atomic<BabyRecord*> records[1];
+  };
+  static Buffer* AllocateBuffer(int32_t capacity);
+  void Reallocate(int32_t capacity);
+
+  EpochReclaimer* reclaimer_;
+  std::atomic<Buffer*> buffer_;
+  std::atomic_int32_t size_;
+};
 
 struct BabyRecordOnStack final {
   static constexpr int32_t STACK_BUFFER_SIZE = 256;
@@ -94,12 +233,20 @@ struct BabyLinkComparator final {
 struct BabyLeafNode final {
   BabyLeafNode* prev;
   BabyLeafNode* next;
-  std::vector<BabyRecord*> records;
+  BabyRecordArray records;
+  BabyRecordArena arena;
+  std::atomic_uint64_t version;
   std::shared_timed_mutex mutex;
-  BabyLeafNode(BabyLeafNode* prev, BabyLeafNode* next)
-      : prev(prev), next(next), records(), mutex() {}
-  ~BabyLeafNode() {
-    FreeBabyRecords(&records);
+  BabyLeafNode(BabyLeafNode* prev, BabyLeafNode* next, EpochReclaimer* reclaimer)
+      : prev(prev), next(next), records(reclaimer), arena(reclaimer), version(0), mutex() {}
+  void AppendRecords(BabyRecordArray::Iterator first, BabyRecordArray::Iterator last);
+  void CompactArena();
+  void BeginUpdate() {
+    version.store(version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+  void EndUpdate() {
+    version.store(version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
   }
 };
 
@@ -116,7 +263,8 @@ class BabyDBMImpl final {
   friend class BabyDBMIteratorImpl;
   typedef std::list<BabyDBMIteratorImpl*> IteratorList;
  public:
-  BabyDBMImpl(std::unique_ptr<File> file, KeyComparator key_comparator);
+  BabyDBMImpl(std::unique_ptr<File> file, KeyComparator key_comparator,
+              BabyDBM::FileFormat file_format);
   ~BabyDBMImpl();
   Status Open(const std::string& path, bool writable, int32_t options);
   Status Close();
@@ -140,6 +288,9 @@ class BabyDBMImpl final {
   void InitializeNodes();
   void FreeNodes();
   BabyLeafNode* SearchTree(std::string_view key);
+  bool ProcessOptimistically(std::string_view key, DBM::RecordProcessor* proc);
+  void BeginTreeUpdate();
+  void EndTreeUpdate();
   void TraceTree(std::string_view key, BabyInnerNode** hist, int32_t* hist_size);
   void ReorganizeTree();
   bool CheckLeafNodeToDivide(BabyLeafNode* node);
@@ -149,8 +300,13 @@ class BabyDBMImpl final {
   void AddLinkToInnerNode(BabyInnerNode* node, void* child, std::string_view key);
   void JoinPrevLinkInInnerNode(BabyInnerNode* node, void* child);
   void JoinNextLinkInInnerNode(BabyInnerNode* node, void* child, void* next);
-  Status ImportRecords();
-  Status ExportRecords();
+  Status ImportRecords(const std::string& path);
+  Status ImportFlatRecords();
+  Status ImportSnapshot(const std::string& path);
+  void BuildTreeFromSnapshot(const BabySnapshotHeader& head);
+  Status ExportRecords(bool synchronize, bool hard);
+  Status WriteFlatRecords(File* file);
+  Status WriteSnapshot(File* file);
   void ProcessImpl(
       BabyLeafNode* node, std::string_view key, DBM::RecordProcessor* proc, bool writable);
   void AppendImpl(
@@ -161,6 +317,9 @@ class BabyDBMImpl final {
   bool open_;
   bool writable_;
   std::string path_;
+  int32_t open_options_;
+  BabyDBM::FileFormat file_format_;
+  BabyDBM::FileFormat open_format_;
   KeyComparator key_comparator_;
   BabyRecordComparator record_comp_;
   BabyLinkComparator link_comp_;
@@ -170,6 +329,9 @@ class BabyDBMImpl final {
   BabyLeafNode* first_node_;
   BabyLeafNode* last_node_;
   AtomicSet<std::pair<BabyLeafNode*, std::string>> reorg_nodes_;
+  EpochReclaimer reclaimer_;
+  std::atomic_uint64_t tree_version_;
+  PrivateMemoryMap snapshot_;
   std::shared_timed_mutex mutex_;
 };
 
@@ -214,9 +376,9 @@ std::string_view BabyRecord::GetValue() const {
   return std::string_view(rp, value_size);
 }
 
-BabyRecord* CreateBabyRecord(std::string_view key, std::string_view value) {
-  BabyRecord* rec =
-      static_cast<BabyRecord*>(xmalloc(sizeof(BabyRecord) + key.size() + value.size()));
+BabyRecord* CreateBabyRecord(
+    BabyRecordArena* arena, std::string_view key, std::string_view value) {
+  BabyRecord* rec = arena->Allocate(sizeof(BabyRecord) + key.size() + value.size());
   rec->key_size = key.size();
   rec->value_size = value.size();
   char* wp = reinterpret_cast<char*>(rec) + sizeof(*rec);
@@ -225,38 +387,296 @@ BabyRecord* CreateBabyRecord(std::string_view key, std::string_view value) {
   return rec;
 }
 
-BabyRecord* ModifyBabyRecord(BabyRecord* record, std::string_view new_value) {
-  if (static_cast<int32_t>(new_value.size()) > record->value_size) {
-    record = static_cast<BabyRecord*>(xrealloc(
-        record, sizeof(BabyRecord) + record->key_size + new_value.size()));
+BabyRecord* ModifyBabyRecord(
+    BabyRecordArena* arena, BabyRecord* record, std::string_view new_value) {
+  if (!arena->Resize(record, sizeof(BabyRecord) + record->key_size + new_value.size())) {
+    BabyRecord* new_rec = CreateBabyRecord(arena, record->GetKey(), new_value);
+    arena->Release(record);
+    return new_rec;
   }
   char* wp = reinterpret_cast<char*>(record) + sizeof(*record) + record->key_size;
-  std::memcpy(wp, new_value.data(), new_value.size());
+  std::memmove(wp, new_value.data(), new_value.size());
   record->value_size = new_value.size();
   return record;
 }
 
 BabyRecord* AppendBabyRecord(
-    BabyRecord* record, std::string_view cat_value, std::string_view cat_delim) {
-  int32_t new_value_size = record->value_size + cat_delim.size() + cat_value.size();
-  record = static_cast<BabyRecord*>(xreallocappend(
-      record, sizeof(BabyRecord) + record->key_size + new_value_size));
-  char* wp = reinterpret_cast<char*>(record) + sizeof(*record) +
+    BabyRecordArena* arena, BabyRecord* record,
+    std::string_view cat_value, std::string_view cat_delim) {
+  const int32_t new_value_size = record->value_size + cat_delim.size() + cat_value.size();
+  const int32_t new_size = sizeof(BabyRecord) + record->key_size + new_value_size;
+  BabyRecord* new_rec = record;
+  if (!arena->Resize(record, new_size)) {
+    new_rec = arena->Allocate(new_size, new_size * 2);
+    new_rec->key_size = record->key_size;
+    std::memcpy(reinterpret_cast<char*>(new_rec) + sizeof(*new_rec),
+                reinterpret_cast<const char*>(record) + sizeof(*record),
+                record->key_size + record->value_size);
+  }
+  char* wp = reinterpret_cast<char*>(new_rec) + sizeof(*new_rec) +
       record->key_size + record->value_size;
   std::memcpy(wp, cat_delim.data(), cat_delim.size());
   wp += cat_delim.size();
   std::memcpy(wp, cat_value.data(), cat_value.size());
-  record->value_size = new_value_size;
+  new_rec->value_size = new_value_size;
+  if (new_rec != record) {
+    arena->Release(record);
+  }
+  return new_rec;
+}
+
+char* BabyArenaChunk::GetData() {
+  return reinterpret_cast<char*>(this) + sizeof(*this);
+}
+
+BabyRecordArena::BabyRecordArena(EpochReclaimer* reclaimer)
+    : reclaimer_(reclaimer), head_(nullptr), capacity_(0), used_size_(0), live_size_(0) {}
+
+BabyRecordArena::~BabyRecordArena() {
+  while (head_ != nullptr) {
+    BabyArenaChunk* next = head_->next;
+    xfree(head_);
+    head_ = next;
+  }
+}
+
+BabyRecord* BabyRecordArena::Allocate(int32_t size, int64_t reserve) {
+  const int32_t alloc_size = GetAllocSize(size);
+  if (head_ == nullptr || head_->capacity - head_->used < alloc_size) {
+    const int64_t chunk_size = std::max<int64_t>(
+        std::max<int64_t>(alloc_size, reserve),
+        std::min<int64_t>(std::max<int64_t>(capacity_, ARENA_MIN_CHUNK_SIZE),
+                          ARENA_MAX_CHUNK_SIZE));
+    BabyArenaChunk* chunk =
+        static_cast<BabyArenaChunk*>(xmalloc(sizeof(BabyArenaChunk) + chunk_size));
+    chunk->next = head_;
+    chunk->capacity = chunk_size;
+    chunk->used = 0;
+    head_ = chunk;
+    capacity_ += chunk_size;
+  }
+  BabyRecord* record = reinterpret_cast<BabyRecord*>(head_->GetData() + head_->used);
+  head_->used += alloc_size;
+  used_size_ += alloc_size;
+  live_size_ += alloc_size;
   return record;
 }
 
-void FreeBabyRecord(BabyRecord* record) {
-  xfree(record);
+bool BabyRecordArena::Resize(BabyRecord* record, int32_t new_size) {
+  const int32_t old_alloc_size =
+      GetAllocSize(sizeof(BabyRecord) + record->key_size + record->value_size);
+  const int32_t new_alloc_size = GetAllocSize(new_size);
+  if (new_alloc_size <= old_alloc_size) {
+    live_size_ -= old_alloc_size - new_alloc_size;
+    return true;
+  }
+  if (head_ == nullptr ||
+      reinterpret_cast<char*>(record) + old_alloc_size != head_->GetData() + head_->used ||
+      head_->used + new_alloc_size - old_alloc_size > head_->capacity) {
+    return false;
+  }
+  head_->used += new_alloc_size - old_alloc_size;
+  used_size_ += new_alloc_size - old_alloc_size;
+  live_size_ += new_alloc_size - old_alloc_size;
+  return true;
+}
+
+void BabyRecordArena::Release(const BabyRecord* record) {
+  live_size_ -= GetAllocSize(sizeof(BabyRecord) + record->key_size + record->value_size);
 }
 
-void FreeBabyRecords(std::vector<BabyRecord*>* records) {
-  for (auto* rec : *records) {
-    xfree(rec);
+void BabyRecordArena::Adopt(int64_t size) {
+  used_size_ += size;
+  live_size_ += size;
+}
+
+bool BabyRecordArena::ShouldCompact() const {
+  const int64_t dead_size = used_size_ - live_size_;
+  return dead_size > ARENA_MIN_CHUNK_SIZE && dead_size > live_size_;
+}
+
+void BabyRecordArena::Retire() {
+  while (head_ != nullptr) {
+    BabyArenaChunk* next = head_->next;
+    reclaimer_->Retire(head_, xfree);
+    head_ = next;
+  }
+  capacity_ = 0;
+  used_size_ = 0;
+  live_size_ = 0;
+}
+
+void BabyRecordArena::swap(BabyRecordArena& other) {
+  std::swap(head_, other.head_);
+  std::swap(capacity_, other.capacity_);
+  std::swap(used_size_, other.used_size_);
+  std::swap(live_size_, other.live_size_);
+}
+
+int64_t BabyRecordArena::GetCapacity() const {
+  return capacity_;
+}
+
+int64_t BabyRecordArena::GetUsedSize() const {
+  return used_size_;
+}
+
+int64_t BabyRecordArena::GetLiveSize() const {
+  return live_size_;
+}
+
+int32_t BabyRecordArena::GetAllocSize(int32_t size) {
+  constexpr int32_t align = alignof(BabyRecord);
+  return (size + align - 1) / align * align;
+}
+
+BabyRecordArray::BabyRecordArray(EpochReclaimer* reclaimer)
+    : reclaimer_(reclaimer), buffer_(nullptr), size_(0) {}
+
+BabyRecordArray::~BabyRecordArray() {
+  xfree(buffer_.load(std::memory_order_relaxed));
+}
+
+BabyRecordArray::Iterator BabyRecordArray::begin() const {
+  const Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+  return Iterator(buffer == nullptr ? nullptr : buffer->records);
+}
+
+BabyRecordArray::Iterator BabyRecordArray::end() const {
+  return begin() + size_.load(std::memory_order_relaxed);
+}
+
+int32_t BabyRecordArray::size() const {
+  return size_.load(std::memory_order_relaxed);
+}
+
+int32_t BabyRecordArray::capacity() const {
+  const Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+  return buffer == nullptr ? 0 : buffer->capacity;
+}
+
+bool BabyRecordArray::empty() const {
+  return size_.load(std::memory_order_relaxed) == 0;
+}
+
+BabyRecord* BabyRecordArray::front() const {
+  return *begin();
+}
+
+BabyRecord* BabyRecordArray::back() const {
+  return *(end() - 1);
+}
+
+void BabyRecordArray::reserve(int32_t capacity) {
+  const Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+  if (buffer == nullptr || buffer->capacity < capacity) {
+    Reallocate(capacity);
+  }
+}
+
+void BabyRecordArray::shrink_to_fit() {
+  const Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+  const int32_t capacity = std::max(size(), RECORD_ARRAY_MIN_CAPACITY);
+  if (buffer != nullptr && buffer->capacity > capacity) {
+    Reallocate(capacity);
+  }
+}
+
+BabyRecordArray::Iterator BabyRecordArray::insert(Iterator pos, BabyRecord* record) {
+  const int32_t index = pos - begin();
+  const int32_t size = size_.load(std::memory_order_relaxed);
+  const Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+  if (buffer == nullptr || size >= buffer->capacity) {
+    Reallocate(std::max(size * 2, RECORD_ARRAY_MIN_CAPACITY));
+  }
+  Buffer* new_buffer = buffer_.load(std::memory_order_relaxed);
+  auto* records = new_buffer->records;
+  for (int32_t i = size; i > index; i--) {
+    records[i].store(records[i - 1].load(std::memory_order_relaxed), std::memory_order_release);
+  }
+  records[index].store(record, std::memory_order_release);
+  size_.store(size + 1, std::memory_order_release);
+  return Iterator(records + index);
+}
+
+void BabyRecordArray::append(Iterator first, Iterator last) {
+  reserve(size() + (last - first));
+  while (first != last) {
+    emplace_back(*first);
+    ++first;
+  }
+}
+
+void BabyRecordArray::emplace_back(BabyRecord* record) {
+  insert(end(), record);
+}
+
+void BabyRecordArray::replace(Iterator pos, BabyRecord* record) {
+  const_cast<std::atomic<BabyRecord*>*>(pos.ptr_)->store(record, std::memory_order_release);
+}
+
+void BabyRecordArray::erase(Iterator pos) {
+  erase(pos, pos + 1);
+}
+
+void BabyRecordArray::erase(Iterator first, Iterator last) {
+  Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+  if (buffer == nullptr || first == last) {
+    return;
+  }
+  auto* records = buffer->records;
+  const int32_t size = size_.load(std::memory_order_relaxed);
+  const int32_t index = first - begin();
+  const int32_t num_erased = last - first;
+  for (int32_t i = index; i < size - num_erased; i++) {
+    records[i].store(records[i + num_erased].load(std::memory_order_relaxed),
+                     std::memory_order_release);
+  }
+  size_.store(size - num_erased, std::memory_order_release);
+}
+
+void BabyRecordArray::clear() {
+  size_.store(0, std::memory_order_release);
+}
+
+void BabyRecordArray::swap(BabyRecordArray& other) {
+  Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+  const int32_t size = size_.load(std::memory_order_relaxed);
+  buffer_.store(other.buffer_.load(std::memory_order_relaxed), std::memory_order_release);
+  size_.store(other.size_.load(std::memory_order_relaxed), std::memory_order_release);
+  other.buffer_.store(buffer, std::memory_order_release);
+  other.size_.store(size, std::memory_order_release);
+}
+
+BabyRecordArray::Iterator BabyRecordArray::SnapshotForRead(Iterator* end) const {
+  const Buffer* buffer = buffer_.load(std::memory_order_acquire);
+  if (buffer == nullptr) {
+    *end = Iterator(nullptr);
+    return Iterator(nullptr);
+  }
+  const int32_t size = std::min(size_.load(std::memory_order_acquire), buffer->capacity);
+  *end = Iterator(buffer->records + size);
+  return Iterator(buffer->records);
+}
+
+BabyRecordArray::Buffer* BabyRecordArray::AllocateBuffer(int32_t capacity) {
+  Buffer* buffer = static_cast<Buffer*>(xmalloc(
+      sizeof(Buffer) + sizeof(std::atomic<BabyRecord*>) * (capacity - 1)));
+  buffer->capacity = capacity;
+  return buffer;
+}
+
+void BabyRecordArray::Reallocate(int32_t capacity) {
+  Buffer* old_buffer = buffer_.load(std::memory_order_relaxed);
+  Buffer* new_buffer = AllocateBuffer(capacity);
+  const int32_t size = size_.load(std::memory_order_relaxed);
+  for (int32_t i = 0; i < size; i++) {
+    new (new_buffer->records + i) std::atomic<BabyRecord*>(
+        old_buffer->records[i].load(std::memory_order_relaxed));
+  }
+  buffer_.store(new_buffer, std::memory_order_release);
+  if (old_buffer != nullptr) {
+    reclaimer_->Retire(old_buffer, xfree);
   }
 }
 
@@ -329,14 +749,40 @@ BabyLinkOnStack::~BabyLinkOnStack() {
   }
 }
 
-BabyDBMImpl::BabyDBMImpl(std::unique_ptr<File> file, KeyComparator key_comparator)
+void BabyLeafNode::AppendRecords(
+    BabyRecordArray::Iterator first, BabyRecordArray::Iterator last) {
+  records.reserve(records.size() + (last - first));
+  while (first != last) {
+    const BabyRecord* rec = *first;
+    records.emplace_back(CreateBabyRecord(&arena, rec->GetKey(), rec->GetValue()));
+    ++first;
+  }
+}
+
+void BabyLeafNode::CompactArena() {
+  BabyRecordArena new_arena(nullptr);
+  const int64_t live_size = arena.GetLiveSize();
+  for (auto it = records.begin(); it != records.end(); ++it) {
+    const BabyRecord* rec = *it;
+    const int32_t size = sizeof(BabyRecord) + rec->key_size + rec->value_size;
+    BabyRecord* new_rec = new_arena.Allocate(size, live_size);
+    std::memcpy(new_rec, rec, size);
+    records.replace(it, new_rec);
+  }
+  arena.Retire();
+  arena.swap(new_arena);
+}
+
+BabyDBMImpl::BabyDBMImpl(std::unique_ptr<File> file, KeyComparator key_comparator,
+                         BabyDBM::FileFormat file_format)
     : iterators_(), file_(std::move(file)), open_(false), writable_(false), path_(),
-      key_comparator_(key_comparator),
+      open_options_(File::OPEN_DEFAULT), file_format_(file_format),
+      open_format_(BabyDBM::FORMAT_FLAT), key_comparator_(key_comparator),
       record_comp_(BabyRecordComparator(key_comparator)),
       link_comp_(BabyLinkComparator(key_comparator)),
       num_records_(0), tree_level_(0),
       root_node_(nullptr), first_node_(nullptr), last_node_(nullptr),
-      reorg_nodes_(),
+      reorg_nodes_(), reclaimer_(), tree_version_(0), snapshot_(),
       mutex_() {
   InitializeNodes();
   num_records_.store(0);
@@ -361,7 +807,7 @@ Status BabyDBMImpl::Open(const std::string& path, bool writable, int32_t options
   if (status != Status::SUCCESS) {
     return status;
   }
-  status = ImportRecords();
+  status = ImportRecords(path);
   if (status != Status::SUCCESS) {
     file_->Close();
     return status;
@@ -369,6 +815,7 @@ Status BabyDBMImpl::Open(const std::string& path, bool writable, int32_t options
   open_ = true;
   writable_ = writable;
   path_ = path;
+  open_options_ = options & ~File::OPEN_TRUNCATE;
   return Status(Status::SUCCESS);
 }
 
@@ -382,19 +829,29 @@ Status BabyDBMImpl::Close() {
   }
   Status status(Status::SUCCESS);
   if (writable_) {
-    status |= ExportRecords();
+    status |= ExportRecords(false, false);
   }
   status |= file_->Close();
+  BeginTreeUpdate();
   FreeNodes();
   InitializeNodes();
+  if (snapshot_.Pointer() != nullptr) {
+    snapshot_.Close();
+  }
+  EndTreeUpdate();
   num_records_.store(0);
   open_ = false;
   writable_ = false;
   path_.clear();
+  open_options_ = File::OPEN_DEFAULT;
+  open_format_ = BabyDBM::FORMAT_FLAT;
   return status;
 }
 
 Status BabyDBMImpl::Process(std::string_view key, DBM::RecordProcessor* proc, bool writable) {
+  if (!writable && ProcessOptimistically(key, proc)) {
+    return Status(Status::SUCCESS);
+  }
   if (writable && !reorg_nodes_.IsEmpty()) {
     std::lock_guard<std::shared_timed_mutex> lock(mutex_);
     ReorganizeTree();
@@ -479,8 +936,13 @@ Status BabyDBMImpl::Clear() {
   for (auto* iterator : iterators_) {
     iterator->ClearPosition();
   }
+  BeginTreeUpdate();
   FreeNodes();
   InitializeNodes();
+  if (snapshot_.Pointer() != nullptr) {
+    snapshot_.Close();
+  }
+  EndTreeUpdate();
   num_records_.store(0);
   return Status(Status::SUCCESS);
 }
@@ -489,8 +951,7 @@ Status BabyDBMImpl::Synchronize(bool hard, DBM::FileProcessor* proc) {
   std::lock_guard<std::shared_timed_mutex> lock(mutex_);
   Status status(Status::SUCCESS);
   if (open_ && writable_) {
-    status |= ExportRecords();
-    status |= file_->Synchronize(hard);
+    status |= ExportRecords(true, hard);
     if (proc != nullptr) {
       proc->Process(path_);
     }
@@ -508,8 +969,30 @@ std::vector<std::pair<std::string, std::string>> BabyDBMImpl::Inspect() {
   if (open_) {
     Add("path", path_);
   }
-  Add("num_records", ToString(num_records_.load()));
+  const int64_t num_records = num_records_.load();
+  Add("num_records", ToString(num_records));
   Add("tree_level", ToString(tree_level_));
+  int64_t arena_capacity = 0;
+  int64_t arena_used_size = 0;
+  int64_t arena_live_size = 0;
+  int64_t mem_usage = 0;
+  for (const BabyLeafNode* leaf_node = first_node_; leaf_node != nullptr;
+       leaf_node = leaf_node->next) {
+    arena_capacity += leaf_node->arena.GetCapacity();
+    arena_used_size += leaf_node->arena.GetUsedSize();
+    arena_live_size += leaf_node->arena.GetLiveSize();
+    mem_usage += sizeof(BabyLeafNode) + leaf_node->arena.GetCapacity() +
+        leaf_node->records.capacity() * sizeof(BabyRecord*);
+  }
+  Add("arena_capacity", ToString(arena_capacity));
+  Add("arena_used_size", ToString(arena_used_size));
+  Add("arena_live_size", ToString(arena_live_size));
+  Add("mem_per_record", ToString(num_records > 0 ?
+                                 static_cast<double>(mem_usage) / num_records : 0.0));
+  if (open_) {
+    Add("file_format", BabyDBM::GetFileFormatName(open_format_));
+  }
+  Add("snapshot_size", ToString(snapshot_.Size()));
   return meta;
 }
 
@@ -525,7 +1008,7 @@ bool BabyDBMImpl::IsWritable() {
 
 std::unique_ptr<DBM> BabyDBMImpl::MakeDBM() {
   std::shared_lock<std::shared_timed_mutex> lock(mutex_);
-  return std::make_unique<BabyDBM>(file_->MakeFile());
+  return std::make_unique<BabyDBM>(file_->MakeFile(), key_comparator_, file_format_);
 }
 
 KeyComparator BabyDBMImpl::GetKeyComparator() {
@@ -533,7 +1016,7 @@ KeyComparator BabyDBMImpl::GetKeyComparator() {
 }
 
 void BabyDBMImpl::InitializeNodes() {
-  root_node_ = new BabyLeafNode(nullptr, nullptr);
+  root_node_ = new BabyLeafNode(nullptr, nullptr, &reclaimer_);
   first_node_ = reinterpret_cast<BabyLeafNode*>(root_node_);
   last_node_ = reinterpret_cast<BabyLeafNode*>(root_node_);
   tree_level_ = 1;
@@ -581,6 +1064,73 @@ BabyLeafNode* BabyDBMImpl::SearchTree(std::string_view key) {
   return reinterpret_cast<BabyLeafNode*>(node);
 }
 
+bool BabyDBMImpl::ProcessOptimistically(std::string_view key, DBM::RecordProcessor* proc) {
+  const int32_t slot_index = reclaimer_.Enter();
+  if (slot_index < 0) {
+    return false;
+  }
+  BabyRecordOnStack search_stack(key);
+  const BabyRecord* search_rec = search_stack.record;
+  char value_stack[OPTIMISTIC_READ_BUFFER_SIZE];
+  std::string value_heap;
+  std::string_view value;
+  bool hit = false;
+  bool done = false;
+  for (int32_t retry = 0; retry < OPTIMISTIC_READ_RETRIES; retry++) {
+    if (tree_version_.load() & 1) {
+      break;
+    }
+    BabyLeafNode* leaf_node = SearchTree(key);
+    const uint64_t version = leaf_node->version.load(std::memory_order_acquire);
+    if (version & 1) {
+      std::this_thread::yield();
+      continue;
+    }
+    BabyRecordArray::Iterator end;
+    const BabyRecordArray::Iterator begin = leaf_node->records.SnapshotForRead(&end);
+    auto it = std::lower_bound(begin, end, search_rec, record_comp_);
+    hit = false;
+    if (it != end) {
+      const BabyRecord* rec = *it;
+      if (!record_comp_(search_rec, rec)) {
+        const std::string_view rec_value = rec->GetValue();
+        if (rec_value.size() <= sizeof(value_stack)) {
+          std::memcpy(value_stack, rec_value.data(), rec_value.size());
+          value = std::string_view(value_stack, rec_value.size());
+        } else {
+          value_heap.assign(rec_value.data(), rec_value.size());
+          value = value_heap;
+        }
+        hit = true;
+      }
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (leaf_node->version.load(std::memory_order_relaxed) == version) {
+      done = true;
+      break;
+    }
+  }
+  reclaimer_.Leave(slot_index);
+  if (!done) {
+    return false;
+  }
+  if (hit) {
+    proc->ProcessFull(key, value);
+  } else {
+    proc->ProcessEmpty(key);
+  }
+  return true;
+}
+
+void BabyDBMImpl::BeginTreeUpdate() {
+  tree_version_.fetch_add(1);
+  reclaimer_.Synchronize();
+}
+
+void BabyDBMImpl::EndTreeUpdate() {
+  tree_version_.fetch_add(1);
+}
+
 void BabyDBMImpl::TraceTree(std::string_view key, BabyInnerNode** hist, int32_t* hist_size) {
   void* node = root_node_;
   int32_t level = 1;
@@ -603,6 +1153,7 @@ void BabyDBMImpl::TraceTree(std::string_view key, BabyInnerNode** hist, int32_t*
 }
 
 void BabyDBMImpl::ReorganizeTree() {
+  BeginTreeUpdate();
   std::set<BabyLeafNode*> done_nodes;
   while (!reorg_nodes_.IsEmpty()) {
     const auto& node_key = reorg_nodes_.Pop();
@@ -615,6 +1166,7 @@ void BabyDBMImpl::ReorganizeTree() {
       MergeNodes(node_key.first, node_key.second);
     }
   }
+  EndTreeUpdate();
 }
 
 bool BabyDBMImpl::CheckLeafNodeToDivide(BabyLeafNode* node) {
@@ -629,7 +1181,7 @@ void BabyDBMImpl::DivideNodes(BabyLeafNode* leaf_node, const std::string& node_k
   BabyInnerNode* hist[TREE_LEVEL_MAX];
   int32_t hist_size = 0;
   TraceTree(node_key, hist, &hist_size);
-  BabyLeafNode* new_leaf_node = new BabyLeafNode(leaf_node, leaf_node->next);
+  BabyLeafNode* new_leaf_node = new BabyLeafNode(leaf_node, leaf_node->next, &reclaimer_);
   if (new_leaf_node->next != nullptr) {
     new_leaf_node->next->prev = new_leaf_node;
   }
@@ -637,12 +1189,7 @@ void BabyDBMImpl::DivideNodes(BabyLeafNode* leaf_node, const std::string& node_k
   auto& records = leaf_node->records;
   auto mid = records.begin() + records.size() / 2;
   auto it = mid;
-  auto& new_records = new_leaf_node->records;
-  while (it != records.end()) {
-    BabyRecord* rec = *it;
-    new_records.emplace_back(rec);
-    ++it;
-  }
+  new_leaf_node->AppendRecords(it, records.end());
   if (last_node_ == leaf_node) {
     last_node_ = new_leaf_node;
   }
@@ -655,6 +1202,8 @@ void BabyDBMImpl::DivideNodes(BabyLeafNode* leaf_node, const std::string& node_k
     }
   }
   records.erase(mid, records.end());
+  records.shrink_to_fit();
+  leaf_node->CompactArena();
   void* heir = leaf_node;
   void* child = new_leaf_node;
   std::string new_node_key(new_leaf_node->records.front()->GetKey());
@@ -719,9 +1268,7 @@ void BabyDBMImpl::MergeNodes(BabyLeafNode* leaf_node, const std::string& node_ke
   if (prev_leaf_node != nullptr &&
       (next_leaf_node == nullptr ||
        prev_leaf_node->records.size() <= next_leaf_node->records.size())) {
-    prev_leaf_node->records.reserve(prev_leaf_node->records.size() + leaf_node->records.size());
-    prev_leaf_node->records.insert(
-        prev_leaf_node->records.end(), leaf_node->records.begin(), leaf_node->records.end());
+    prev_leaf_node->AppendRecords(leaf_node->records.begin(), leaf_node->records.end());
     leaf_node->records.clear();
     prev_leaf_node->next = leaf_node->next;
     if (leaf_node->next != nullptr) {
@@ -742,9 +1289,8 @@ void BabyDBMImpl::MergeNodes(BabyLeafNode* leaf_node, const std::string& node_ke
     delete leaf_node;
   } else if (next_leaf_node != nullptr) {
     next_leaf_node->records.swap(leaf_node->records);
-    next_leaf_node->records.reserve(next_leaf_node->records.size() + leaf_node->records.size());
-    next_leaf_node->records.insert(
-        next_leaf_node->records.end(), leaf_node->records.begin(), leaf_node->records.end());
+    next_leaf_node->arena.swap(leaf_node->arena);
+    next_leaf_node->AppendRecords(leaf_node->records.begin(), leaf_node->records.end());
     leaf_node->records.clear();
     next_leaf_node->prev = leaf_node->prev;
     if (leaf_node->prev != nullptr) {
@@ -864,12 +1410,28 @@ void BabyDBMImpl::JoinNextLinkInInnerNode(BabyInnerNode* node, void* child, void
   }
 }
 
-Status BabyDBMImpl::ImportRecords() {
-  int64_t end_offset = 0;
-  Status status = file_->GetSize(&end_offset);
+Status BabyDBMImpl::ImportRecords(const std::string& path) {
+  int64_t file_size = 0;
+  Status status = file_->GetSize(&file_size);
   if (status != Status::SUCCESS) {
     return status;
   }
+  open_format_ = BabyDBM::FORMAT_FLAT;
+  if (file_size >= static_cast<int64_t>(sizeof(BabySnapshotHeader))) {
+    char magic[sizeof(SNAPSHOT_MAGIC)];
+    status = file_->Read(0, magic, sizeof(magic));
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+    if (std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) == 0) {
+      open_format_ = BabyDBM::FORMAT_SNAPSHOT;
+      return ImportSnapshot(path);
+    }
+  }
+  return ImportFlatRecords();
+}
+
+Status BabyDBMImpl::ImportFlatRecords() {
   FlatRecordReader reader(file_.get());
   std::string key_store;
   while (true) {
@@ -898,12 +1460,153 @@ Status BabyDBMImpl::ImportRecords() {
   return Status(Status::SUCCESS);
 }
 
-Status BabyDBMImpl::ExportRecords() {
-  Status status = file_->Truncate(0);
+Status BabyDBMImpl::ImportSnapshot(const std::string& path) {
+  Status status = snapshot_.Open(path);
   if (status != Status::SUCCESS) {
     return status;
   }
-  FlatRecord flat_rec(file_.get());
+  const char* const base = snapshot_.Pointer();
+  BabySnapshotHeader head;
+  std::memcpy(&head, base, sizeof(head));
+  if (head.endian_mark != SNAPSHOT_ENDIAN_MARK ||
+      head.record_align != static_cast<int32_t>(alignof(BabyRecord)) ||
+      head.num_records < 0 || head.records_offset != static_cast<int64_t>(sizeof(head)) ||
+      head.end_offset < head.records_offset || head.end_offset > snapshot_.Size()) {
+    snapshot_.Close();
+    return Status(Status::BROKEN_DATA_ERROR, "invalid snapshot header");
+  }
+  int64_t num_records = 0;
+  bool sorted = true;
+  const BabyRecord* prev_rec = nullptr;
+  const char* rp = base + head.records_offset;
+  const char* const end = base + head.end_offset;
+  while (rp < end) {
+    const BabyRecord* rec = reinterpret_cast<const BabyRecord*>(rp);
+    if (end - rp < static_cast<int64_t>(sizeof(BabyRecord)) ||
+        rec->key_size < 0 || rec->value_size < 0 ||
+        static_cast<int64_t>(rec->key_size) + rec->value_size >
+        end - rp - static_cast<int64_t>(sizeof(BabyRecord))) {
+      snapshot_.Close();
+      return Status(Status::BROKEN_DATA_ERROR, "invalid snapshot record");
+    }
+    if (prev_rec != nullptr && !record_comp_(prev_rec, rec)) {
+      sorted = false;
+    }
+    prev_rec = rec;
+    num_records++;
+    rp += BabyRecordArena::GetAllocSize(sizeof(BabyRecord) + rec->key_size + rec->value_size);
+  }
+  if (num_records != head.num_records) {
+    snapshot_.Close();
+    return Status(Status::BROKEN_DATA_ERROR, "inconsistent number of snapshot records");
+  }
+  if (num_records_.load() > 0 || !sorted) {
+    rp = base + head.records_offset;
+    while (rp < end) {
+      const BabyRecord* rec = reinterpret_cast<const BabyRecord*>(rp);
+      DBM::RecordProcessorSet setter(&status, rec->GetValue(), true);
+      BabyLeafNode* leaf_node = SearchTree(rec->GetKey());
+      std::lock_guard<std::shared_timed_mutex> page_lock(leaf_node->mutex);
+      ProcessImpl(leaf_node, rec->GetKey(), &setter, true);
+      rp += BabyRecordArena::GetAllocSize(sizeof(BabyRecord) + rec->key_size + rec->value_size);
+    }
+    snapshot_.Close();
+    return Status(Status::SUCCESS);
+  }
+  BeginTreeUpdate();
+  FreeNodes();
+  if (num_records > 0) {
+    BuildTreeFromSnapshot(head);
+  } else {
+    InitializeNodes();
+  }
+  EndTreeUpdate();
+  num_records_.store(num_records);
+  return Status(Status::SUCCESS);
+}
+
+void BabyDBMImpl::BuildTreeFromSnapshot(const BabySnapshotHeader& head) {
+  const int64_t num_leaves =
+      (head.num_records + MAX_LEAF_NODE_RECORDS - 1) / MAX_LEAF_NODE_RECORDS;
+  std::vector<std::pair<std::string_view, void*>> nodes;
+  nodes.reserve(num_leaves);
+  char* rp = snapshot_.Pointer() + head.records_offset;
+  BabyLeafNode* prev_node = nullptr;
+  for (int64_t leaf_index = 0; leaf_index < num_leaves; leaf_index++) {
+    const int64_t num_leaf_records = head.num_records * (leaf_index + 1) / num_leaves -
+        head.num_records * leaf_index / num_leaves;
+    BabyLeafNode* leaf_node = new BabyLeafNode(prev_node, nullptr, &reclaimer_);
+    if (prev_node == nullptr) {
+      first_node_ = leaf_node;
+    } else {
+      prev_node->next = leaf_node;
+    }
+    leaf_node->records.reserve(num_leaf_records);
+    int64_t adopted_size = 0;
+    for (int64_t i = 0; i < num_leaf_records; i++) {
+      BabyRecord* rec = reinterpret_cast<BabyRecord*>(rp);
+      const int32_t alloc_size =
+          BabyRecordArena::GetAllocSize(sizeof(BabyRecord) + rec->key_size + rec->value_size);
+      leaf_node->records.emplace_back(rec);
+      adopted_size += alloc_size;
+      rp += alloc_size;
+    }
+    leaf_node->arena.Adopt(adopted_size);
+    nodes.emplace_back(leaf_node->records.front()->GetKey(), leaf_node);
+    prev_node = leaf_node;
+  }
+  last_node_ = prev_node;
+  tree_level_ = 1;
+  while (nodes.size() > 1) {
+    const int64_t num_children = nodes.size();
+    const int64_t num_nodes =
+        (num_children + MAX_INNER_NODE_BRANCHES) / (MAX_INNER_NODE_BRANCHES + 1);
+    std::vector<std::pair<std::string_view, void*>> upper_nodes;
+    upper_nodes.reserve(num_nodes);
+    for (int64_t node_index = 0; node_index < num_nodes; node_index++) {
+      const int64_t begin = num_children * node_index / num_nodes;
+      const int64_t end = num_children * (node_index + 1) / num_nodes;
+      BabyInnerNode* inner_node = new BabyInnerNode(nodes[begin].second);
+      inner_node->links.reserve(end - begin - 1);
+      for (int64_t i = begin + 1; i < end; i++) {
+        inner_node->links.emplace_back(CreateBabyLink(nodes[i].first, nodes[i].second));
+      }
+      upper_nodes.emplace_back(nodes[begin].first, inner_node);
+    }
+    nodes.swap(upper_nodes);
+    tree_level_++;
+  }
+  root_node_ = nodes.front().second;
+}
+
+Status BabyDBMImpl::ExportRecords(bool synchronize, bool hard) {
+  const BabyDBM::FileFormat format =
+      file_format_ == BabyDBM::FORMAT_DEFAULT ? open_format_ : file_format_;
+  if (format != BabyDBM::FORMAT_SNAPSHOT && snapshot_.Pointer() == nullptr) {
+    Status status = file_->Truncate(0);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+    status = WriteFlatRecords(file_.get());
+    if (synchronize) {
+      status |= file_->Synchronize(hard);
+    }
+    return status;
+  }
+  const Status status = RewriteDBMFile(
+      file_.get(), path_, open_options_,
+      [&](File* file) {
+        return format == BabyDBM::FORMAT_SNAPSHOT ? WriteSnapshot(file) : WriteFlatRecords(file);
+      }, synchronize, hard);
+  if (status == Status::SUCCESS) {
+    open_format_ = format;
+  }
+  return status;
+}
+
+Status BabyDBMImpl::WriteFlatRecords(File* file) {
+  Status status(Status::SUCCESS);
+  FlatRecord flat_rec(file);
   BabyLeafNode* leaf_node = first_node_;
   while (leaf_node != nullptr) {
     std::shared_lock<std::shared_timed_mutex> page_lock(leaf_node->mutex);
@@ -922,6 +1625,45 @@ Status BabyDBMImpl::ExportRecords() {
   return Status(Status::SUCCESS);
 }
 
+Status BabyDBMImpl::WriteSnapshot(File* file) {
+  BabySnapshotHeader head;
+  std::memset(&head, 0, sizeof(head));
+  std::memcpy(head.magic, SNAPSHOT_MAGIC, sizeof(head.magic));
+  head.endian_mark = SNAPSHOT_ENDIAN_MARK;
+  head.record_align = alignof(BabyRecord);
+  head.records_offset = sizeof(head);
+  std::string buffer;
+  buffer.reserve(SNAPSHOT_BUFFER_SIZE * 2);
+  Status status(Status::SUCCESS);
+  auto write = [&](const void* data, size_t size) {
+    buffer.append(static_cast<const char*>(data), size);
+    if (static_cast<int64_t>(buffer.size()) >= SNAPSHOT_BUFFER_SIZE) {
+      status |= file->Append(buffer.data(), buffer.size());
+      buffer.clear();
+    }
+  };
+  write(&head, sizeof(head));
+  int64_t offset = head.records_offset;
+  for (BabyLeafNode* leaf_node = first_node_; leaf_node != nullptr;
+       leaf_node = leaf_node->next) {
+    std::shared_lock<std::shared_timed_mutex> page_lock(leaf_node->mutex);
+    for (const auto* rec : leaf_node->records) {
+      const int32_t size = sizeof(BabyRecord) + rec->key_size + rec->value_size;
+      const int32_t alloc_size = BabyRecordArena::GetAllocSize(size);
+      write(rec, size);
+      buffer.append(alloc_size - size, 0);
+      offset += alloc_size;
+      head.num_records++;
+    }
+  }
+  if (!buffer.empty()) {
+    status |= file->Append(buffer.data(), buffer.size());
+  }
+  head.end_offset = offset;
+  status |= file->Write(0, &head, sizeof(head));
+  return status;
+}
+
 void BabyDBMImpl::ProcessImpl(
     BabyLeafNode* node, std::string_view key, DBM::RecordProcessor* proc, bool writable) {
   BabyRecordOnStack search_stack(key);
@@ -933,14 +1675,28 @@ void BabyDBMImpl::ProcessImpl(
     const std::string_view new_value = proc->ProcessFull(rec->GetKey(), rec->GetValue());
     if (new_value.data() != DBM::RecordProcessor::NOOP.data() && writable) {
       if (new_value.data() == DBM::RecordProcessor::REMOVE.data()) {
-        node->records.erase(it);
+        node->BeginUpdate();
+        records.erase(it);
+        node->arena.Release(rec);
         if (CheckLeafNodeToMerge(node)) {
-          reorg_nodes_.Insert(std::make_pair(node, std::string(records.front()->GetKey())));
+          reorg_nodes_.Insert(std::make_pair(node, std::string(
+              records.empty() ? rec->GetKey() : records.front()->GetKey())));
         }
-        FreeBabyRecord(rec);
+        if (node->arena.ShouldCompact()) {
+          node->CompactArena();
+        }
+        node->EndUpdate();
         num_records_.fetch_sub(1);
       } else {
-        *it = ModifyBabyRecord(rec, new_value);
+        node->BeginUpdate();
+        BabyRecord* new_rec = ModifyBabyRecord(&node->arena, rec, new_value);
+        if (new_rec != rec) {
+          records.replace(it, new_rec);
+          if (node->arena.ShouldCompact()) {
+            node->CompactArena();
+          }
+        }
+        node->EndUpdate();
       }
     }
   } else {
@@ -948,8 +1704,10 @@ void BabyDBMImpl::ProcessImpl(
     if (new_value.data() != DBM::RecordProcessor::NOOP.data() &&
         new_value.data() != DBM::RecordProcessor::REMOVE.data() &&
         writable) {
-      BabyRecord* new_rec = CreateBabyRecord(key, new_value);
-      node->records.insert(it, new_rec);
+      node->BeginUpdate();
+      BabyRecord* new_rec = CreateBabyRecord(&node->arena, key, new_value);
+      records.insert(it, new_rec);
+      node->EndUpdate();
       num_records_.fetch_add(1);
       if (CheckLeafNodeToDivide(node)) {
         reorg_nodes_.Insert(std::make_pair(node, std::string(records.front()->GetKey())));
@@ -966,10 +1724,20 @@ void BabyDBMImpl::AppendImpl(
   auto it = std::lower_bound(records.begin(), records.end(), search_rec, record_comp_);
   if (it != records.end() && !record_comp_(search_rec, *it)) {
     BabyRecord* rec = *it;
-    *it = AppendBabyRecord(rec, value, delim);
+    node->BeginUpdate();
+    BabyRecord* new_rec = AppendBabyRecord(&node->arena, rec, value, delim);
+    if (new_rec != rec) {
+      records.replace(it, new_rec);
+      if (node->arena.ShouldCompact()) {
+        node->CompactArena();
+      }
+    }
+    node->EndUpdate();
   } else {
-    BabyRecord* new_rec = CreateBabyRecord(key, value);
-    node->records.insert(it, new_rec);
+    node->BeginUpdate();
+    BabyRecord* new_rec = CreateBabyRecord(&node->arena, key, value);
+    records.insert(it, new_rec);
+    node->EndUpdate();
     num_records_.fetch_add(1);
     if (CheckLeafNodeToDivide(node)) {
       reorg_nodes_.Insert(std::make_pair(node, std::string(records.front()->GetKey())));
@@ -1300,14 +2068,16 @@ Status BabyDBMIteratorImpl::ProcessImpl(
   return Status(Status::SUCCESS);
 }
 
-BabyDBM::BabyDBM(KeyComparator key_comparator) {
+BabyDBM::BabyDBM(KeyComparator key_comparator, FileFormat file_format) {
   assert(key_comparator != nullptr);
-  impl_ = new BabyDBMImpl(std::make_unique<MemoryMapParallelFile>(), key_comparator);
+  impl_ = new BabyDBMImpl(std::make_unique<MemoryMapParallelFile>(), key_comparator,
+                          file_format);
 }
 
-BabyDBM::BabyDBM(std::unique_ptr<File> file, KeyComparator key_comparator) {
+BabyDBM::BabyDBM(std::unique_ptr<File> file, KeyComparator key_comparator,
+                 FileFormat file_format) {
   assert(key_comparator != nullptr);
-  impl_ = new BabyDBMImpl(std::move(file), key_comparator);
+  impl_ = new BabyDBMImpl(std::move(file), key_comparator, file_format);
 }
 
 BabyDBM::~BabyDBM() {
@@ -1384,6 +2154,29 @@ KeyComparator BabyDBM::GetKeyComparator() const {
   return impl_->GetKeyComparator();
 }
 
+const char* BabyDBM::GetFileFormatName(FileFormat file_format) {
+  switch (file_format) {
+    case FORMAT_FLAT:
+      return "flat";
+    case FORMAT_SNAPSHOT:
+      return "snapshot";
+    default:
+      break;
+  }
+  return "default";
+}
+
+BabyDBM::FileFormat BabyDBM::ParseFileFormat(std::string_view name) {
+  const std::string lower_name = StrLowerCase(name);
+  if (lower_name == "flat") {
+    return FORMAT_FLAT;
+  }
+  if (lower_name == "snapshot") {
+    return FORMAT_SNAPSHOT;
+  }
+  return FORMAT_DEFAULT;
+}
+
 BabyDBM::Iterator::Iterator(BabyDBMImpl* dbm_impl) {
   impl_ = new BabyDBMIteratorImpl(dbm_impl);
 }
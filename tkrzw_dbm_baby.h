@@ -39,6 +39,18 @@ class BabyDBMIteratorImpl;
  */
 class BabyDBM final : public DBM {
  public:
+  /**
+   * Enumeration for formats of the database file.
+   */
+  enum FileFormat : int32_t {
+    /** To keep the format of the loaded file, or to use FORMAT_FLAT for a new file. */
+    FORMAT_DEFAULT = 0,
+    /** The flat record format, which is portable and read sequentially. */
+    FORMAT_FLAT = 1,
+    /** The memory image of the sorted records, which is mapped on memory without parsing. */
+    FORMAT_SNAPSHOT = 2,
+  };
+
   /**
    * Iterator for each record.
    * @details When the database is updated, some iterators may or may not be invalided.
@@ -145,15 +157,19 @@ class BabyDBM final : public DBM {
   /**
    * Default constructor.
    * @param key_comparator The comparator of record keys.
+   * @param file_format The format of the file to save records in.
    */
-  BabyDBM(KeyComparator key_comparator = LexicalKeyComparator);
+  BabyDBM(KeyComparator key_comparator = LexicalKeyComparator,
+          FileFormat file_format = FORMAT_DEFAULT);
 
   /**
    * Constructor with a file object.
    * @param file The file object to handle the data.  The ownership is taken.
    * @param key_comparator The comparator of record keys.
+   * @param file_format The format of the file to save records in.
    */
-  BabyDBM(std::unique_ptr<File> file, KeyComparator key_comparator = LexicalKeyComparator);
+  BabyDBM(std::unique_ptr<File> file, KeyComparator key_comparator = LexicalKeyComparator,
+          FileFormat file_format = FORMAT_DEFAULT);
 
   /**
    * Destructor.
@@ -328,6 +344,20 @@ class BabyDBM final : public DBM {
    */
   KeyComparator GetKeyComparator() const;
 
+  /**
+   * Gets the name of a file format.
+   * @param file_format The file format.
+   * @return The name of the file format: "flat" or "snapshot".
+   */
+  static const char* GetFileFormatName(FileFormat file_format);
+
+  /**
+   * Parses the name of a file format.
+   * @param name The name of the file format, which is case-insensitive.
+   * @return The file format, or FORMAT_DEFAULT if the name is unknown.
+   */
+  static FileFormat ParseFileFormat(std::string_view name);
+
  private:
   /** Pointer to the actual implementation. */
   class BabyDBMImpl* impl_;
@@ -225,4 +225,227 @@ TEST_F(BabyDBMTest, Comparator) {
   }
 }
 
+TEST_F(BabyDBMTest, RecordArena) {
+  tkrzw::BabyDBM dbm;
+  auto GetMeta = [&]() {
+    const auto meta = dbm.Inspect();
+    return std::map<std::string, std::string>(meta.begin(), meta.end());
+  };
+  for (int32_t i = 0; i < 10000; i++) {
+    const std::string key = tkrzw::SPrintF("%08d", i);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(key, key));
+  }
+  auto meta = GetMeta();
+  const int64_t live_size = tkrzw::StrToInt(tkrzw::SearchMap(meta, "arena_live_size", "-1"));
+  EXPECT_EQ(10000 * 24, live_size);
+  EXPECT_LE(live_size, tkrzw::StrToInt(tkrzw::SearchMap(meta, "arena_capacity", "-1")));
+  const double mem_per_record = tkrzw::StrToDouble(tkrzw::SearchMap(meta, "mem_per_record", ""));
+  EXPECT_GT(mem_per_record, 24);
+  EXPECT_LT(mem_per_record, 64);
+  for (int32_t i = 0; i < 10000; i++) {
+    const std::string key = tkrzw::SPrintF("%08d", i);
+    if (i % 4 != 0) {
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Remove(key));
+    } else {
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(key, key + key));
+    }
+  }
+  meta = GetMeta();
+  EXPECT_EQ(2500 * 32, tkrzw::StrToInt(tkrzw::SearchMap(meta, "arena_live_size", "-1")));
+  EXPECT_LE(tkrzw::StrToInt(tkrzw::SearchMap(meta, "arena_used_size", "-1")), 2500 * 32 * 3);
+  for (int32_t i = 0; i < 10000; i++) {
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Append("append", "x", ""));
+  }
+  EXPECT_EQ(std::string(10000, 'x'), dbm.GetSimple("append"));
+  auto iter = dbm.MakeIterator();
+  EXPECT_EQ(tkrzw::Status::SUCCESS, iter->First());
+  int32_t count = 0;
+  std::string key, value;
+  while (iter->Get(&key, &value) == tkrzw::Status::SUCCESS) {
+    if (key != "append") {
+      EXPECT_EQ(count * 4, tkrzw::StrToInt(key));
+      EXPECT_EQ(key + key, value);
+      count++;
+    }
+    EXPECT_EQ(tkrzw::Status::SUCCESS, iter->Next());
+  }
+  EXPECT_EQ(2500, count);
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Clear());
+  EXPECT_EQ("0", tkrzw::SearchMap(GetMeta(), "arena_live_size", ""));
+}
+
+TEST_F(BabyDBMTest, SnapshotFormat) {
+  const auto snapshot = tkrzw::BabyDBM::FORMAT_SNAPSHOT;
+  EXPECT_EQ(snapshot, tkrzw::BabyDBM::ParseFileFormat(
+      tkrzw::BabyDBM::GetFileFormatName(snapshot)));
+  EXPECT_EQ(tkrzw::BabyDBM::FORMAT_DEFAULT, tkrzw::BabyDBM::ParseFileFormat("foo"));
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string file_path = tmp_dir.MakeUniquePath();
+  constexpr int32_t num_records = 70000;
+  std::map<std::string, std::string> expected;
+  auto check_records = [&](tkrzw::DBM* dbm) {
+    EXPECT_EQ(expected.size(), dbm->CountSimple());
+    auto iter = dbm->MakeIterator();
+    EXPECT_EQ(tkrzw::Status::SUCCESS, iter->First());
+    std::string key, value;
+    for (const auto& record : expected) {
+      EXPECT_EQ(tkrzw::Status::SUCCESS, iter->Get(&key, &value));
+      EXPECT_EQ(record.first, key);
+      EXPECT_EQ(record.second, value);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, iter->Next());
+    }
+    EXPECT_EQ(tkrzw::Status::NOT_FOUND_ERROR, iter->Get());
+    EXPECT_EQ(tkrzw::Status::SUCCESS, iter->Last());
+    for (auto it = expected.rbegin(); it != expected.rend(); ++it) {
+      EXPECT_EQ(tkrzw::Status::SUCCESS, iter->Get(&key, &value));
+      EXPECT_EQ(it->first, key);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, iter->Previous());
+    }
+    for (const auto& record : expected) {
+      EXPECT_EQ(record.second, dbm->GetSimple(record.first));
+    }
+  };
+  {
+    tkrzw::BabyDBM dbm(tkrzw::LexicalKeyComparator, snapshot);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Open(file_path, true, tkrzw::File::OPEN_TRUNCATE));
+    for (int32_t i = 0; i < num_records; i++) {
+      const std::string key = tkrzw::ToString(static_cast<int64_t>(i) * i);
+      const std::string value(i % 100, 'v');
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(key, value));
+      expected.emplace(key, value);
+    }
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+  }
+  std::string content;
+  EXPECT_EQ(tkrzw::Status::SUCCESS, tkrzw::ReadFile(file_path, &content));
+  EXPECT_EQ("TkrzwBSN", content.substr(0, 8));
+  {
+    tkrzw::BabyDBM dbm;
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Open(file_path, true));
+    auto meta = dbm.Inspect();
+    std::map<std::string, std::string> meta_map(meta.begin(), meta.end());
+    EXPECT_EQ("snapshot", tkrzw::SearchMap(meta_map, "file_format", ""));
+    EXPECT_GE(tkrzw::StrToInt(tkrzw::SearchMap(meta_map, "snapshot_size", "")), content.size());
+    EXPECT_EQ("3", tkrzw::SearchMap(meta_map, "tree_level", ""));
+    check_records(&dbm);
+    for (int32_t i = 0; i < num_records; i += 3) {
+      const std::string key = tkrzw::ToString(static_cast<int64_t>(i) * i);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Remove(key));
+      expected.erase(key);
+    }
+    for (int32_t i = 1; i < num_records; i += 3) {
+      const std::string key = tkrzw::ToString(static_cast<int64_t>(i) * i);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(key, "x"));
+      expected[key] = "x";
+    }
+    for (int32_t i = 2; i < num_records; i += 3) {
+      const std::string key = tkrzw::ToString(static_cast<int64_t>(i) * i);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Append(key, "y", ":"));
+      expected[key] = expected[key] + ":y";
+    }
+    for (int32_t i = num_records; i < num_records + 2000; i++) {
+      const std::string key = tkrzw::ToString(static_cast<int64_t>(i) * i);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(key, key));
+      expected.emplace(key, key);
+    }
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Synchronize(false));
+    check_records(&dbm);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+    meta = dbm.Inspect();
+    meta_map = std::map<std::string, std::string>(meta.begin(), meta.end());
+    EXPECT_EQ("0", tkrzw::SearchMap(meta_map, "snapshot_size", ""));
+  }
+  {
+    tkrzw::BabyDBM dbm(tkrzw::DecimalKeyComparator);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Open(file_path, false));
+    const auto meta = dbm.Inspect();
+    const std::map<std::string, std::string> meta_map(meta.begin(), meta.end());
+    EXPECT_EQ("0", tkrzw::SearchMap(meta_map, "snapshot_size", ""));
+    EXPECT_EQ(expected.size(), dbm.CountSimple());
+    for (const auto& record : expected) {
+      EXPECT_EQ(record.second, dbm.GetSimple(record.first));
+    }
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+  }
+  {
+    tkrzw::BabyDBM dbm(tkrzw::LexicalKeyComparator, tkrzw::BabyDBM::FORMAT_FLAT);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set("extra", "record"));
+    expected.emplace("extra", "record");
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Open(file_path, true));
+    const auto meta = dbm.Inspect();
+    const std::map<std::string, std::string> meta_map(meta.begin(), meta.end());
+    EXPECT_EQ("0", tkrzw::SearchMap(meta_map, "snapshot_size", ""));
+    check_records(&dbm);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+  }
+  EXPECT_EQ(tkrzw::Status::SUCCESS, tkrzw::ReadFile(file_path, &content));
+  EXPECT_NE("TkrzwBSN", content.substr(0, 8));
+  {
+    tkrzw::BabyDBM dbm(tkrzw::LexicalKeyComparator, snapshot);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Open(file_path, true));
+    check_records(&dbm);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+  }
+  EXPECT_EQ(tkrzw::Status::SUCCESS, tkrzw::ReadFile(file_path, &content));
+  EXPECT_EQ("TkrzwBSN", content.substr(0, 8));
+  EXPECT_FALSE(tkrzw::PathIsFile(file_path + ".tmp"));
+  content[16] ^= 0xFF;
+  EXPECT_EQ(tkrzw::Status::SUCCESS, tkrzw::WriteFile(file_path, content));
+  tkrzw::BabyDBM dbm;
+  EXPECT_EQ(tkrzw::Status::BROKEN_DATA_ERROR, dbm.Open(file_path, false));
+}
+
+TEST_F(BabyDBMTest, OptimisticRead) {
+  constexpr int32_t num_threads = 4;
+  constexpr int32_t num_iterations = 20000;
+  constexpr int32_t num_keys = 3000;
+  tkrzw::BabyDBM dbm;
+  auto func = [&](int32_t id) {
+    std::mt19937 mt(id);
+    std::uniform_int_distribution<int32_t> key_dist(0, num_keys - 1);
+    std::uniform_int_distribution<int32_t> op_dist(0, 9);
+    std::uniform_int_distribution<int32_t> size_dist(0, 400);
+    for (int32_t i = 0; i < num_iterations; i++) {
+      const std::string key = tkrzw::ToString(key_dist(mt));
+      const int32_t op = op_dist(mt);
+      if (id == 0 && op == 0 && i % 100 == 0) {
+        EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Clear());
+      } else if (op < 3) {
+        const std::string value = key + ":" + std::string(size_dist(mt), 'v');
+        EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(key, value));
+      } else if (op < 4) {
+        const tkrzw::Status status = dbm.Remove(key);
+        EXPECT_TRUE(status == tkrzw::Status::SUCCESS || status == tkrzw::Status::NOT_FOUND_ERROR);
+      } else if (op < 5) {
+        EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Append(key, "a", ""));
+      } else {
+        std::string value;
+        const tkrzw::Status status = dbm.Get(key, &value);
+        if (status == tkrzw::Status::SUCCESS) {
+          EXPECT_THAT(value, AnyOf(StartsWith(key + ":"), StartsWith("a")));
+        } else {
+          EXPECT_EQ(tkrzw::Status::NOT_FOUND_ERROR, status);
+        }
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int32_t i = 0; i < num_threads; i++) {
+    threads.emplace_back(std::thread(func, i));
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  int64_t count = 0;
+  auto iter = dbm.MakeIterator();
+  EXPECT_EQ(tkrzw::Status::SUCCESS, iter->First());
+  std::string key, value;
+  while (iter->Get(&key, &value) == tkrzw::Status::SUCCESS) {
+    EXPECT_EQ(value, dbm.GetSimple(key));
+    count++;
+    EXPECT_EQ(tkrzw::Status::SUCCESS, iter->Next());
+  }
+  EXPECT_EQ(dbm.CountSimple(), count);
+}
+
 // END OF FILE
@@ -11,6 +11,7 @@
  * and limitations under the License.
  *************************************************************************************************/
 
+#include "tkrzw_containers.h"
 #include "tkrzw_dbm.h"
 #include "tkrzw_dbm_common_impl.h"
 #include "tkrzw_dbm_cache.h"
@@ -27,59 +28,148 @@ namespace tkrzw {
 
 constexpr int32_t NUM_CACHE_SLOTS = 32;
 constexpr double MAX_LOAD_FACTOR = 1.2;
+constexpr int32_t NUM_CACHE_QUEUES = 3;
+constexpr int32_t QUEUE_ENTRY = 0;
+constexpr int32_t QUEUE_MAIN = 1;
+constexpr int32_t QUEUE_PROTECTED = 2;
+constexpr uint8_t META_QUEUE_MASK = 0x03;
+constexpr int32_t META_FREQ_SHIFT = 2;
+constexpr int32_t S3FIFO_MAX_FREQ = 3;
+constexpr double S3FIFO_SMALL_RATIO = 0.1;
+constexpr double WTINYLFU_WINDOW_RATIO = 0.01;
+constexpr double WTINYLFU_PROTECTED_RATIO = 0.8;
+constexpr int64_t SNAPSHOT_BUFFER_SIZE = 1LL << 20;
+constexpr char SNAPSHOT_MAGIC[8] = {'T', 'k', 'r', 'z', 'w', 'C', 'S', 'N'};
+constexpr uint32_t SNAPSHOT_ENDIAN_MARK = 0x01020304;
 
 struct CacheRecord final {
   char* child;
   char* prev;
   char* next;
+  uint8_t meta;
   int32_t key_size;
   const char* key_ptr;
   int32_t value_size;
   const char* value_ptr;
-  char* Serialize() const;
-  char* Reserialize(char* ptr, int32_t old_value_size) const;
+  char* Serialize(SlabAllocator* alloc) const;
+  char* Reserialize(char* ptr, int32_t old_value_size, SlabAllocator* alloc) const;
   void Deserialize(const char* ptr);
+  bool Deserialize(const char* ptr, int64_t max_size);
+  int32_t GetSerializedSize() const;
   static char* GetChild(char* ptr);
   static void SetChild(char* ptr, const char* child);
   static char* GetPrev(char* ptr);
   static void SetPrev(char* ptr, const char* prev);
   static char* GetNext(char* ptr);
   static void SetNext(char* ptr, const char* next);
+  static uint8_t GetMeta(const char* ptr);
+  static void SetMeta(char* ptr, uint8_t meta);
+  static void IncrementFrequency(char* ptr, int32_t max_freq);
+  static std::atomic_uint8_t* GetMetaAtom(const char* ptr);
+};
+
+struct CacheSnapshotHeader final {
+  char magic[sizeof(SNAPSHOT_MAGIC)];
+  uint32_t endian_mark;
+  int32_t num_slots;
+  int32_t policy;
+  int32_t reserved;
+  int64_t num_records;
+  int64_t end_offset;
+};
+
+struct CacheSnapshotSlot final {
+  int64_t num_buckets;
+  int64_t num_records;
+  int64_t eff_data_size;
+  int64_t queue_sizes[NUM_CACHE_QUEUES];
+  int64_t end_offset;
+};
+
+class FrequencySketch final {
+ public:
+  FrequencySketch();
+  void Init(int64_t capacity);
+  void CleanUp();
+  void Increment(uint64_t hash);
+  int32_t Estimate(uint64_t hash) const;
+
+ private:
+  int64_t GetIndex(uint64_t hash, int32_t row) const;
+
+  static constexpr int32_t DEPTH = 4;
+  static constexpr uint8_t MAX_COUNT = 15;
+  static constexpr int32_t SAMPLE_FACTOR = 10;
+  uint8_t* table_;
+  int64_t width_;
+  int64_t num_samples_;
 };
 
 class CacheSlot final {
  public:
   CacheSlot();
-  void Init(int64_t cap_rec_num, int64_t cap_mem_size);
+  void Init(int64_t cap_rec_num, int64_t cap_mem_size, CacheDBM::EvictionPolicy policy);
   void CleanUp();
   void Process(std::string_view key, uint64_t hash, DBM::RecordProcessor* proc, bool writable);
+  void ProcessShared(std::string_view key, uint64_t hash, DBM::RecordProcessor* proc);
   void ProcessEach(DBM::RecordProcessor* proc, bool writable);
   int64_t Count();
   int64_t GetEffectiveDataSize();
   int64_t GetMemoryUsage();
   int64_t GetMemoryUsageImpl();
+  int64_t GetNumBuckets();
   void Rebuild(int64_t cap_rec_num, int64_t cap_mem_size);
   Status ExportRecords(FlatRecord* flat_rec);
-  void RemoveLRU();
+  bool ImportSnapshot(char* base, int64_t offset, const CacheSnapshotSlot& head,
+                      int32_t slot_index);
+  int64_t WriteSnapshot(const std::function<void(const void*, size_t)>& write, int64_t* offset);
   std::vector<std::string> GetKeys();
+  void AddAllocatorStats(int64_t* reserved_size, int64_t* occupied_size,
+                         int64_t* used_size, int64_t* num_blocks);
 
  private:
+  void SetCapacity(int64_t cap_rec_num, int64_t cap_mem_size);
+  void LinkToBack(int32_t queue, char* ptr);
+  void Unlink(char* ptr);
+  void Relink(char* ptr);
+  void Touch(char* ptr, uint64_t hash);
+  void Admit(char* ptr, uint64_t hash);
+  void Evict();
+  void RemoveRecord(char* ptr);
+  bool IsBorrowed(const char* ptr) const;
+  void FreeRecord(char* ptr, int32_t size);
+  void AddGhost(uint64_t hash);
+  bool CheckGhost(uint64_t hash);
+  static uint64_t GetRecordHash(char* ptr);
+
   char** buckets_;
-  char* first_;
-  char* last_;
+  char* firsts_[NUM_CACHE_QUEUES];
+  char* lasts_[NUM_CACHE_QUEUES];
+  int64_t queue_sizes_[NUM_CACHE_QUEUES];
+  CacheDBM::EvictionPolicy policy_;
   int64_t cap_rec_num_;
   int64_t cap_mem_size_;
+  int64_t entry_cap_;
+  int64_t protected_cap_;
   int64_t num_buckets_;
   int64_t num_records_;
   int64_t eff_data_size_;
-  std::mutex mutex_;
+  FrequencySketch sketch_;
+  std::deque<uint64_t> ghost_queue_;
+  std::unordered_map<uint64_t, int32_t> ghost_counts_;
+  SlabAllocator alloc_;
+  char* borrowed_begin_;
+  char* borrowed_end_;
+  int64_t borrowed_size_;
+  std::shared_timed_mutex mutex_;
 };
 
 class CacheDBMImpl final {
   friend class CacheDBMIteratorImpl;
   typedef std::list<CacheDBMIteratorImpl*> IteratorList;
  public:
-  CacheDBMImpl(std::unique_ptr<File> file, int64_t cap_rec_num, int64_t cap_mem_size);
+  CacheDBMImpl(std::unique_ptr<File> file, int64_t cap_rec_num, int64_t cap_mem_size,
+               CacheDBM::EvictionPolicy policy, CacheDBM::FileFormat file_format);
   ~CacheDBMImpl();
   Status Open(const std::string& path, bool writable, int32_t options);
   Status Close();
@@ -102,8 +192,12 @@ class CacheDBMImpl final {
   void CancelIterators();
   void InitAllSlots();
   void CleanUpAllSlots();
-  Status ImportRecords();
-  Status ExportRecords();
+  Status ImportRecords(const std::string& path);
+  Status ImportFlatRecords();
+  Status ImportSnapshot(const std::string& path);
+  Status ExportRecords(bool synchronize, bool hard);
+  Status WriteFlatRecords(File* file);
+  Status WriteSnapshot(File* file);
   Status ReadNextBucketRecords(CacheDBMIteratorImpl* iter);
 
   IteratorList iterators_;
@@ -111,9 +205,14 @@ class CacheDBMImpl final {
   bool open_;
   bool writable_;
   std::string path_;
+  int32_t open_options_;
   int64_t cap_rec_num_;
   int64_t cap_mem_size_;
+  CacheDBM::EvictionPolicy policy_;
+  CacheDBM::FileFormat file_format_;
+  CacheDBM::FileFormat open_format_;
   CacheSlot slots_[NUM_CACHE_SLOTS];
+  PrivateMemoryMap snapshot_;
   std::shared_timed_mutex mutex_;
 };
 
@@ -135,11 +234,8 @@ class CacheDBMIteratorImpl final {
   std::vector<std::string> keys_;
 };
 
-char* CacheRecord::Serialize() const {
-  const int32_t size = sizeof(child) + sizeof(prev) + sizeof(next) +
-      SizeVarNum(key_size) + key_size +
-      SizeVarNum(value_size) + value_size;
-  char* ptr = static_cast<char*>(xmalloc(size));
+char* CacheRecord::Serialize(SlabAllocator* alloc) const {
+  char* ptr = static_cast<char*>(alloc->Allocate(GetSerializedSize()));
   char* wp = ptr;
   std::memcpy(wp, &child, sizeof(child));
   wp += sizeof(child);
@@ -147,6 +243,7 @@ char* CacheRecord::Serialize() const {
   wp += sizeof(prev);
   std::memcpy(wp, &next, sizeof(next));
   wp += sizeof(next);
+  new (wp++) std::atomic_uint8_t(meta);
   wp += WriteVarNum(wp, key_size);
   std::memcpy(wp, key_ptr, key_size);
   wp += key_size;
@@ -155,21 +252,20 @@ char* CacheRecord::Serialize() const {
   return ptr;
 }
 
-char* CacheRecord::Reserialize(char* ptr, int32_t old_value_size) const {
+char* CacheRecord::Reserialize(
+    char* ptr, int32_t old_value_size, SlabAllocator* alloc) const {
   const int32_t old_value_header_size = SizeVarNum(old_value_size);
   const int32_t new_value_header_size = SizeVarNum(value_size);
-  if (new_value_header_size > old_value_header_size) {
-    char* new_ptr = Serialize();
-    xfree(ptr);
+  const int32_t old_size = sizeof(child) + sizeof(prev) + sizeof(next) + sizeof(meta) +
+      SizeVarNum(key_size) + key_size + old_value_header_size + old_value_size;
+  if (new_value_header_size > old_value_header_size ||
+      SlabAllocator::GetClassSize(GetSerializedSize()) != SlabAllocator::GetClassSize(old_size)) {
+    char* new_ptr = Serialize(alloc);
+    alloc->Deallocate(ptr, old_size);
     return new_ptr;
   }
-  if (value_size > old_value_size) {
-    const int32_t size = sizeof(child) + sizeof(prev) + sizeof(next) +
-        SizeVarNum(key_size) + key_size +
-        SizeVarNum(value_size) + value_size;
-    ptr = static_cast<char*>(xrealloc(ptr, size));
-  }
-  char* wp = ptr + sizeof(child) + sizeof(prev) + sizeof(next) + SizeVarNum(key_size) + key_size;
+  char* wp = ptr + sizeof(child) + sizeof(prev) + sizeof(next) + sizeof(meta) +
+      SizeVarNum(key_size) + key_size;
   wp += WriteVarNum(wp, value_size);
   std::memcpy(wp, value_ptr, value_size);
   return ptr;
@@ -184,6 +280,10 @@ void CacheRecord::Deserialize(const char* ptr) {
   rp += sizeof(prev);
   std::memcpy(&next, rp, sizeof(next));
   rp += sizeof(next);
+  child = ResolveSnapshotLink(ptr, child);
+  prev = ResolveSnapshotLink(ptr, prev);
+  next = ResolveSnapshotLink(ptr, next);
+  meta = GetMetaAtom(rp++)->load(std::memory_order_relaxed);
   uint64_t num = 0;
   rp += ReadVarNum(rp, dummy_size, &num);
   key_size = num;
@@ -194,11 +294,54 @@ void CacheRecord::Deserialize(const char* ptr) {
   value_ptr = rp;
 }
 
+bool CacheRecord::Deserialize(const char* ptr, int64_t max_size) {
+  const char* rp = ptr;
+  constexpr int32_t fixed_size = sizeof(child) + sizeof(prev) + sizeof(next) + sizeof(meta);
+  if (max_size < fixed_size) {
+    return false;
+  }
+  std::memcpy(&child, rp, sizeof(child));
+  rp += sizeof(child);
+  std::memcpy(&prev, rp, sizeof(prev));
+  rp += sizeof(prev);
+  std::memcpy(&next, rp, sizeof(next));
+  rp += sizeof(next);
+  child = ResolveSnapshotLink(ptr, child);
+  prev = ResolveSnapshotLink(ptr, prev);
+  next = ResolveSnapshotLink(ptr, next);
+  meta = GetMetaAtom(rp++)->load(std::memory_order_relaxed);
+  max_size -= fixed_size;
+  uint64_t num = 0;
+  int32_t step = ReadVarNum(rp, max_size, &num);
+  if (step < 1 || static_cast<int64_t>(num) > max_size - step) {
+    return false;
+  }
+  rp += step;
+  max_size -= step;
+  key_size = num;
+  key_ptr = rp;
+  rp += key_size;
+  max_size -= key_size;
+  step = ReadVarNum(rp, max_size, &num);
+  if (step < 1 || static_cast<int64_t>(num) > max_size - step) {
+    return false;
+  }
+  rp += step;
+  value_size = num;
+  value_ptr = rp;
+  return true;
+}
+
+int32_t CacheRecord::GetSerializedSize() const {
+  return sizeof(child) + sizeof(prev) + sizeof(next) + sizeof(meta) +
+      SizeVarNum(key_size) + key_size + SizeVarNum(value_size) + value_size;
+}
+
 char* CacheRecord::GetChild(char* ptr) {
   const char* rp = ptr;
   char* child;
   std::memcpy(&child, rp, sizeof(child));
-  return child;
+  return ResolveSnapshotLink(ptr, child);
 }
 
 void CacheRecord::SetChild(char* ptr, const char* child) {
@@ -210,7 +353,7 @@ char* CacheRecord::GetPrev(char* ptr) {
   const char* rp = ptr + sizeof(char*);
   char* prev;
   std::memcpy(&prev, rp, sizeof(prev));
-  return prev;
+  return ResolveSnapshotLink(ptr, prev);
 }
 
 void CacheRecord::SetPrev(char* ptr, const char* prev) {
@@ -222,7 +365,7 @@ char* CacheRecord::GetNext(char* ptr) {
   const char* rp = ptr + sizeof(char*) + sizeof(char*);
   char* next;
   std::memcpy(&next, rp, sizeof(next));
-  return next;
+  return ResolveSnapshotLink(ptr, next);
 }
 
 void CacheRecord::SetNext(char* ptr, const char* next) {
@@ -230,43 +373,136 @@ void CacheRecord::SetNext(char* ptr, const char* next) {
   std::memcpy(wp, &next, sizeof(next));
 }
 
-CacheSlot::CacheSlot() :
-    buckets_(nullptr), first_(nullptr), last_(nullptr),
-    cap_rec_num_(0), cap_mem_size_(0), num_buckets_(0), num_records_(0),
-    eff_data_size_(0), mutex_() {}
+uint8_t CacheRecord::GetMeta(const char* ptr) {
+  return GetMetaAtom(ptr + sizeof(char*) * 3)->load(std::memory_order_relaxed);
+}
 
-void CacheSlot::Init(int64_t cap_rec_num, int64_t cap_mem_size) {
-  cap_rec_num_ = cap_rec_num;
-  cap_mem_size_ = cap_mem_size;
-  num_buckets_ = GetHashBucketSize(std::min<int64_t>(cap_rec_num_ * MAX_LOAD_FACTOR, INT32MAX));
+void CacheRecord::SetMeta(char* ptr, uint8_t meta) {
+  GetMetaAtom(ptr + sizeof(char*) * 3)->store(meta, std::memory_order_relaxed);
+}
+
+void CacheRecord::IncrementFrequency(char* ptr, int32_t max_freq) {
+  std::atomic_uint8_t* meta = GetMetaAtom(ptr + sizeof(char*) * 3);
+  uint8_t old_meta = meta->load(std::memory_order_relaxed);
+  while ((old_meta >> META_FREQ_SHIFT) < max_freq &&
+         !meta->compare_exchange_weak(old_meta, old_meta + (1 << META_FREQ_SHIFT),
+                                      std::memory_order_relaxed)) {
+  }
+}
+
+std::atomic_uint8_t* CacheRecord::GetMetaAtom(const char* ptr) {
+  static_assert(sizeof(std::atomic_uint8_t) == sizeof(uint8_t));
+  return reinterpret_cast<std::atomic_uint8_t*>(const_cast<char*>(ptr));
+}
+
+FrequencySketch::FrequencySketch() : table_(nullptr), width_(0), num_samples_(0) {}
+
+void FrequencySketch::Init(int64_t capacity) {
+  width_ = 16;
+  while (width_ < capacity) {
+    width_ *= 2;
+  }
+  table_ = static_cast<uint8_t*>(xcalloc(width_ * DEPTH, sizeof(*table_)));
+  num_samples_ = 0;
+}
+
+void FrequencySketch::CleanUp() {
+  xfree(table_);
+  table_ = nullptr;
+  width_ = 0;
+  num_samples_ = 0;
+}
+
+void FrequencySketch::Increment(uint64_t hash) {
+  for (int32_t row = 0; row < DEPTH; row++) {
+    uint8_t& count = table_[GetIndex(hash, row)];
+    if (count < MAX_COUNT) {
+      count++;
+    }
+  }
+  num_samples_++;
+  if (num_samples_ >= width_ * SAMPLE_FACTOR) {
+    for (int64_t i = 0; i < width_ * DEPTH; i++) {
+      table_[i] >>= 1;
+    }
+    num_samples_ /= 2;
+  }
+}
+
+int32_t FrequencySketch::Estimate(uint64_t hash) const {
+  int32_t min_count = MAX_COUNT;
+  for (int32_t row = 0; row < DEPTH; row++) {
+    min_count = std::min<int32_t>(min_count, table_[GetIndex(hash, row)]);
+  }
+  return min_count;
+}
+
+int64_t FrequencySketch::GetIndex(uint64_t hash, int32_t row) const {
+  uint64_t mixed = (hash + (row + 1) * 0x9E3779B97F4A7C15ULL) * 0xBF58476D1CE4E5B9ULL;
+  mixed ^= mixed >> 31;
+  return row * width_ + static_cast<int64_t>(mixed & (width_ - 1));
+}
+
+CacheSlot::CacheSlot() :
+    buckets_(nullptr), firsts_(), lasts_(), queue_sizes_(),
+    policy_(CacheDBM::EVICT_LRU), cap_rec_num_(0), cap_mem_size_(0),
+    entry_cap_(0), protected_cap_(0), num_buckets_(0), num_records_(0),
+    eff_data_size_(0), sketch_(), ghost_queue_(), ghost_counts_(), alloc_(),
+    borrowed_begin_(nullptr), borrowed_end_(nullptr), borrowed_size_(0), mutex_() {}
+
+void CacheSlot::Init(int64_t cap_rec_num, int64_t cap_mem_size,
+                     CacheDBM::EvictionPolicy policy) {
+  policy_ = policy;
+  SetCapacity(cap_rec_num, cap_mem_size);
   buckets_ = static_cast<char**>(xcalloc(num_buckets_, sizeof(*buckets_)));
-  first_ = nullptr;
-  last_ = nullptr;
+  for (int32_t queue = 0; queue < NUM_CACHE_QUEUES; queue++) {
+    firsts_[queue] = nullptr;
+    lasts_[queue] = nullptr;
+    queue_sizes_[queue] = 0;
+  }
   num_records_ = 0;
   eff_data_size_ = 0;
+  if (policy_ == CacheDBM::EVICT_WTINYLFU) {
+    sketch_.Init(cap_rec_num_);
+  }
 }
 
 void CacheSlot::CleanUp() {
   if (buckets_ == nullptr) {
     return;
   }
-  char* ptr = first_;
-  while (ptr != nullptr) {
-    char* next = CacheRecord::GetNext(ptr);
-    xfree(ptr);
-    ptr = next;
+  for (int32_t queue = 0; queue < NUM_CACHE_QUEUES; queue++) {
+    char* ptr = firsts_[queue];
+    while (ptr != nullptr) {
+      CacheRecord rec;
+      rec.Deserialize(ptr);
+      FreeRecord(ptr, rec.GetSerializedSize());
+      ptr = rec.next;
+    }
+    firsts_[queue] = nullptr;
+    lasts_[queue] = nullptr;
+    queue_sizes_[queue] = 0;
   }
   xfree(buckets_);
   buckets_ = nullptr;
-  first_ = nullptr;
-  last_ = nullptr;
+  alloc_.Clear();
+  borrowed_begin_ = nullptr;
+  borrowed_end_ = nullptr;
+  borrowed_size_ = 0;
   num_records_ = 0;
   eff_data_size_ = 0;
+  sketch_.CleanUp();
+  ghost_queue_.clear();
+  ghost_counts_.clear();
 }
 
 void CacheSlot::Process(
     std::string_view key, uint64_t hash, DBM::RecordProcessor* proc, bool writable) {
-  std::lock_guard<std::mutex> lock(mutex_);
+  if (!writable && (policy_ == CacheDBM::EVICT_CLOCK || policy_ == CacheDBM::EVICT_S3FIFO)) {
+    ProcessShared(key, hash, proc);
+    return;
+  }
+  std::lock_guard<std::shared_timed_mutex> lock(mutex_);
   const int32_t bucket_index = hash % num_buckets_;
   CacheRecord rec;
   char* top = buckets_[bucket_index];
@@ -277,61 +513,43 @@ void CacheSlot::Process(
     const std::string_view rec_key(rec.key_ptr, rec.key_size);
     const std::string_view rec_value(rec.value_ptr, rec.value_size);
     if (key == rec_key) {
-      if (last_ != ptr) {
-        if (rec.prev != nullptr) {
-          CacheRecord::SetNext(rec.prev, rec.next);
-        }
-        if (rec.next != nullptr) {
-          CacheRecord::SetPrev(rec.next, rec.prev);
-        }
-        if (first_ == ptr) {
-          first_ = rec.next;
-        }
-        CacheRecord::SetNext(last_, ptr);
-        rec.prev = last_;
-        CacheRecord::SetPrev(ptr, last_);
-        rec.next = nullptr;
-        CacheRecord::SetNext(ptr, nullptr);
-        last_ = ptr;
-      }
+      Touch(ptr, hash);
       std::string_view new_value = proc->ProcessFull(key, rec_value);
       if (new_value.data() != DBM::RecordProcessor::NOOP.data() && writable) {
         if (new_value.data() == DBM::RecordProcessor::REMOVE.data()) {
-          xfree(ptr);
           if (parent == nullptr) {
             buckets_[bucket_index] = rec.child;
           } else {
             CacheRecord::SetChild(parent, rec.child);
           }
-          if (rec.prev == nullptr) {
-            first_ = nullptr;
-            last_ = nullptr;
-          } else {
-            CacheRecord::SetNext(rec.prev, nullptr);
-            last_ = rec.prev;
-          }
+          Unlink(ptr);
+          FreeRecord(ptr, rec.GetSerializedSize());
           num_records_--;
           eff_data_size_ -= rec.key_size + rec.value_size;
         } else {
           const int32_t diff_size = new_value.size() - rec.value_size;
+          rec.Deserialize(ptr);
+          const int32_t old_size = rec.GetSerializedSize();
           rec.value_ptr = new_value.data();
           rec.value_size = new_value.size();
-          char* new_ptr = rec.Reserialize(ptr, rec_value.size());
+          const bool borrowed = IsBorrowed(ptr);
+          char* new_ptr = borrowed ?
+              rec.Serialize(&alloc_) : rec.Reserialize(ptr, rec_value.size(), &alloc_);
           if (new_ptr != ptr) {
+            if (borrowed) {
+              borrowed_size_ -= old_size;
+            }
             if (parent == nullptr) {
               buckets_[bucket_index] = new_ptr;
             } else {
               CacheRecord::SetChild(parent, new_ptr);
             }
-            if (rec.prev != nullptr) {
-              CacheRecord::SetNext(rec.prev, new_ptr);
-            }
-            if (first_ == ptr) {
-              first_ = new_ptr;
-            }
-            last_ = new_ptr;
+            Relink(new_ptr);
           }
           eff_data_size_ += diff_size;
+          while (num_records_ > 0 && GetMemoryUsageImpl() > cap_mem_size_) {
+            Evict();
+          }
         }
       }
       return;
@@ -343,193 +561,582 @@ void CacheSlot::Process(
   if (new_value.data() != DBM::RecordProcessor::NOOP.data() &&
       new_value.data() != DBM::RecordProcessor::REMOVE.data() && writable) {
     rec.child = top;
-    rec.prev = last_;
+    rec.prev = nullptr;
     rec.next = nullptr;
+    rec.meta = 0;
     rec.key_ptr = key.data();
     rec.key_size = key.size();
     rec.value_ptr = new_value.data();
     rec.value_size = new_value.size();
-    char* new_ptr = rec.Serialize();
+    char* new_ptr = rec.Serialize(&alloc_);
     buckets_[bucket_index] = new_ptr;
-    if (first_ == nullptr) {
-      first_ = new_ptr;
-    }
-    if (last_ != nullptr) {
-      CacheRecord::SetNext(last_, new_ptr);
-    }
-    last_ = new_ptr;
+    Admit(new_ptr, hash);
     num_records_++;
     eff_data_size_ += key.size() + new_value.size();
-    if (num_records_ > cap_rec_num_ || GetMemoryUsageImpl() > cap_mem_size_) {
-      RemoveLRU();
+    if (num_records_ > cap_rec_num_) {
+      Evict();
+    }
+    // A slab is returned only when all of its records are removed, so eviction may continue
+    // beyond one record.
+    while (num_records_ > 0 && GetMemoryUsageImpl() > cap_mem_size_) {
+      Evict();
     }
   }
 }
 
+void CacheSlot::ProcessShared(
+    std::string_view key, uint64_t hash, DBM::RecordProcessor* proc) {
+  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+  const int32_t bucket_index = hash % num_buckets_;
+  CacheRecord rec;
+  char* ptr = buckets_[bucket_index];
+  while (ptr != nullptr) {
+    rec.Deserialize(ptr);
+    const std::string_view rec_key(rec.key_ptr, rec.key_size);
+    if (key == rec_key) {
+      Touch(ptr, hash);
+      proc->ProcessFull(key, std::string_view(rec.value_ptr, rec.value_size));
+      return;
+    }
+    ptr = rec.child;
+  }
+  proc->ProcessEmpty(key);
+}
+
 void CacheSlot::ProcessEach(DBM::RecordProcessor* proc, bool writable) {
   if (writable) {
-    std::vector<std::string> keys;
-    keys.reserve(num_records_);
-    {
-      std::lock_guard<std::mutex> lock(mutex_);
-      char* ptr = first_;
-      while (ptr != nullptr) {
-        CacheRecord rec;
-        rec.Deserialize(ptr);
-        keys.emplace_back(std::string(rec.key_ptr, rec.key_size));
-        ptr = rec.next;
-      }
-    }
+    std::vector<std::string> keys = GetKeys();
     for (const auto& key : keys) {
       const uint64_t hash = PrimaryHash(key, UINT64MAX) >> 8;
       Process(key, hash, proc, true);
     }
   } else {
-    std::lock_guard<std::mutex> lock(mutex_);
-    char* ptr = first_;
-    while (ptr != nullptr) {
-      CacheRecord rec;
-      rec.Deserialize(ptr);
-      const std::string_view key(rec.key_ptr, rec.key_size);
-      const std::string_view value(rec.value_ptr, rec.value_size);
-      proc->ProcessFull(key, value);
-      ptr = rec.next;
+    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    for (int32_t queue = 0; queue < NUM_CACHE_QUEUES; queue++) {
+      char* ptr = firsts_[queue];
+      while (ptr != nullptr) {
+        CacheRecord rec;
+        rec.Deserialize(ptr);
+        const std::string_view key(rec.key_ptr, rec.key_size);
+        const std::string_view value(rec.value_ptr, rec.value_size);
+        proc->ProcessFull(key, value);
+        ptr = rec.next;
+      }
     }
   }
 }
 
 int64_t CacheSlot::Count() {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
   return num_records_;
 }
 
 int64_t CacheSlot::GetEffectiveDataSize() {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
   return eff_data_size_;
 }
 
 int64_t CacheSlot::GetMemoryUsage() {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
   return GetMemoryUsageImpl();
 }
 
 int64_t CacheSlot::GetMemoryUsageImpl() {
-  constexpr int32_t bucket_footprint = sizeof(char*);
-  constexpr int32_t record_footprint = sizeof(char*) * 3 + sizeof(uint8_t) * 2;
-  constexpr int32_t alloc_footprint = sizeof(void*);
-  return num_buckets_ * bucket_footprint + num_records_ * (record_footprint + alloc_footprint) +
-      eff_data_size_;
+  return num_buckets_ * static_cast<int64_t>(sizeof(char*)) + alloc_.GetOccupiedSize() +
+      borrowed_size_;
+}
+
+int64_t CacheSlot::GetNumBuckets() {
+  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+  return num_buckets_;
 }
 
 void CacheSlot::Rebuild(int64_t cap_rec_num, int64_t cap_mem_size) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  cap_rec_num_ = cap_rec_num;
-  cap_mem_size_ = cap_mem_size;
-  num_buckets_ = GetHashBucketSize(std::min<int64_t>(cap_rec_num_ * MAX_LOAD_FACTOR, INT32MAX));
+  std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+  SetCapacity(cap_rec_num, cap_mem_size);
   xfree(buckets_);
   buckets_ = static_cast<char**>(xcalloc(num_buckets_, sizeof(*buckets_)));
+  if (policy_ == CacheDBM::EVICT_WTINYLFU) {
+    sketch_.CleanUp();
+    sketch_.Init(cap_rec_num_);
+  }
   num_records_ = 0;
   eff_data_size_ = 0;
-  char* ptr = first_;
-  last_ = nullptr;
-  while (ptr != nullptr) {
-    char* next = CacheRecord::GetNext(ptr);
-    if (num_records_ < cap_rec_num_ && GetMemoryUsageImpl() < cap_mem_size_) {
+  for (int32_t queue = 0; queue < NUM_CACHE_QUEUES; queue++) {
+    char* ptr = firsts_[queue];
+    while (ptr != nullptr) {
       CacheRecord rec;
       rec.Deserialize(ptr);
-      const std::string_view key(rec.key_ptr, rec.key_size);
-      const uint64_t hash = PrimaryHash(key, UINT64MAX) >> 8;
-      const int32_t bucket_index = hash % num_buckets_;
-      CacheRecord::SetChild(ptr, buckets_[bucket_index]);
-      buckets_[bucket_index] = ptr;
-      num_records_++;
-      eff_data_size_ += rec.key_size + rec.value_size;
-      last_ = ptr;
-    } else {
-      xfree(ptr);
+      char* next = rec.next;
+      if (num_records_ < cap_rec_num_) {
+        const std::string_view key(rec.key_ptr, rec.key_size);
+        const uint64_t hash = PrimaryHash(key, UINT64MAX) >> 8;
+        const int32_t bucket_index = hash % num_buckets_;
+        CacheRecord::SetChild(ptr, buckets_[bucket_index]);
+        buckets_[bucket_index] = ptr;
+        num_records_++;
+        eff_data_size_ += rec.key_size + rec.value_size;
+      } else {
+        Unlink(ptr);
+        FreeRecord(ptr, rec.GetSerializedSize());
+      }
+      ptr = next;
     }
-    ptr = next;
   }
-  if (last_ == nullptr) {
-    first_ = nullptr;
-  } else {
-    CacheRecord::SetNext(last_, nullptr);
+  while (num_records_ > 0 && GetMemoryUsageImpl() > cap_mem_size_) {
+    Evict();
   }
 }
 
 Status CacheSlot::ExportRecords(FlatRecord* flat_rec) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  char* ptr = first_;
-  while (ptr != nullptr) {
+  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+  for (int32_t queue = 0; queue < NUM_CACHE_QUEUES; queue++) {
+    char* ptr = firsts_[queue];
+    while (ptr != nullptr) {
+      CacheRecord rec;
+      rec.Deserialize(ptr);
+      Status status = flat_rec->Write(std::string_view(rec.key_ptr, rec.key_size));
+      if (status != Status::SUCCESS) {
+        return status;
+      }
+      status = flat_rec->Write(std::string_view(rec.value_ptr, rec.value_size));
+      if (status != Status::SUCCESS) {
+        return status;
+      }
+      ptr = rec.next;
+    }
+  }
+  return Status(Status::SUCCESS);
+}
+
+bool CacheSlot::ImportSnapshot(
+    char* base, int64_t offset, const CacheSnapshotSlot& head, int32_t slot_index) {
+  std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+  const char* const table = base + offset;
+  char* const begin = base + offset + head.num_buckets * sizeof(int64_t);
+  char* const end = base + head.end_offset;
+  std::vector<char*> starts;
+  starts.reserve(head.num_records);
+  for (char* ptr = begin; ptr < end;) {
     CacheRecord rec;
     rec.Deserialize(ptr);
-    Status status = flat_rec->Write(std::string_view(rec.key_ptr, rec.key_size));
-    if (status != Status::SUCCESS) {
-      return status;
+    starts.emplace_back(ptr);
+    ptr = const_cast<char*>(rec.value_ptr) + rec.value_size;
+  }
+  auto is_record = [&](const char* ptr) {
+    return std::binary_search(starts.begin(), starts.end(), ptr);
+  };
+  int64_t index = 0;
+  for (int32_t queue = 0; queue < NUM_CACHE_QUEUES; queue++) {
+    const char* prev = nullptr;
+    for (int64_t i = 0; i < head.queue_sizes[queue]; i++) {
+      char* ptr = starts[index++];
+      const char* next = i + 1 < head.queue_sizes[queue] ? starts[index] : nullptr;
+      CacheRecord rec;
+      rec.Deserialize(ptr);
+      if (rec.prev != prev || rec.next != next || (rec.meta & META_QUEUE_MASK) != queue ||
+          (rec.child != nullptr && !is_record(rec.child))) {
+        return false;
+      }
+      prev = ptr;
     }
-    status = flat_rec->Write(std::string_view(rec.value_ptr, rec.value_size));
-    if (status != Status::SUCCESS) {
-      return status;
+  }
+  int64_t num_chained = 0;
+  for (int64_t bucket_index = 0; bucket_index < num_buckets_; bucket_index++) {
+    int64_t top = 0;
+    std::memcpy(&top, table + bucket_index * sizeof(top), sizeof(top));
+    if (top != 0 && (top < begin - base || top >= end - base || !is_record(base + top))) {
+      return false;
+    }
+    char* ptr = top == 0 ? nullptr : base + top;
+    while (ptr != nullptr) {
+      if (++num_chained > head.num_records) {
+        return false;
+      }
+      CacheRecord rec;
+      rec.Deserialize(ptr);
+      const uint64_t hash = PrimaryHash(std::string_view(rec.key_ptr, rec.key_size), UINT64MAX);
+      if (static_cast<int32_t>((hash & 0xff) % NUM_CACHE_SLOTS) != slot_index ||
+          static_cast<int64_t>((hash >> 8) % num_buckets_) != bucket_index) {
+        return false;
+      }
+      ptr = rec.child;
     }
-    ptr = CacheRecord::GetNext(ptr);
   }
-  return Status(Status::SUCCESS);
+  if (num_chained != head.num_records) {
+    return false;
+  }
+  borrowed_begin_ = begin;
+  borrowed_end_ = end;
+  for (int64_t bucket_index = 0; bucket_index < num_buckets_; bucket_index++) {
+    int64_t top = 0;
+    std::memcpy(&top, table + bucket_index * sizeof(top), sizeof(top));
+    buckets_[bucket_index] = top == 0 ? nullptr : base + top;
+  }
+  index = 0;
+  for (int32_t queue = 0; queue < NUM_CACHE_QUEUES; queue++) {
+    for (int64_t i = 0; i < head.queue_sizes[queue]; i++) {
+      char* ptr = starts[index++];
+      CacheRecord rec;
+      rec.Deserialize(ptr);
+      if (i == 0) {
+        firsts_[queue] = ptr;
+      }
+      lasts_[queue] = ptr;
+      queue_sizes_[queue]++;
+      num_records_++;
+      eff_data_size_ += rec.key_size + rec.value_size;
+      borrowed_size_ += rec.GetSerializedSize();
+    }
+  }
+  while (num_records_ > cap_rec_num_) {
+    Evict();
+  }
+  while (num_records_ > 0 && GetMemoryUsageImpl() > cap_mem_size_) {
+    Evict();
+  }
+  return true;
 }
 
-void CacheSlot::RemoveLRU() {
-  CacheRecord first_rec;
-  first_rec.Deserialize(first_);
-  const std::string_view key(first_rec.key_ptr, first_rec.key_size);
+int64_t CacheSlot::WriteSnapshot(
+    const std::function<void(const void*, size_t)>& write, int64_t* offset) {
+  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+  CacheSnapshotSlot head;
+  std::memset(&head, 0, sizeof(head));
+  head.num_buckets = num_buckets_;
+  head.num_records = num_records_;
+  head.eff_data_size = eff_data_size_;
+  head.end_offset = *offset + sizeof(head) + num_buckets_ * sizeof(int64_t);
+  std::unordered_map<const char*, int64_t> rec_offsets;
+  rec_offsets.reserve(num_records_);
+  for (int32_t queue = 0; queue < NUM_CACHE_QUEUES; queue++) {
+    head.queue_sizes[queue] = queue_sizes_[queue];
+    for (char* ptr = firsts_[queue]; ptr != nullptr; ptr = CacheRecord::GetNext(ptr)) {
+      CacheRecord rec;
+      rec.Deserialize(ptr);
+      rec_offsets.emplace(ptr, head.end_offset);
+      head.end_offset += rec.GetSerializedSize();
+    }
+  }
+  write(&head, sizeof(head));
+  for (int64_t bucket_index = 0; bucket_index < num_buckets_; bucket_index++) {
+    const char* top = buckets_[bucket_index];
+    const int64_t top_offset = top == nullptr ? 0 : rec_offsets[top];
+    write(&top_offset, sizeof(top_offset));
+  }
+  for (int32_t queue = 0; queue < NUM_CACHE_QUEUES; queue++) {
+    for (char* ptr = firsts_[queue]; ptr != nullptr; ptr = CacheRecord::GetNext(ptr)) {
+      CacheRecord rec;
+      rec.Deserialize(ptr);
+      const int64_t rec_offset = rec_offsets[ptr];
+      const int32_t rec_size = rec.GetSerializedSize();
+      const int64_t links[3] = {
+        rec.child == nullptr ? 0 : MakeSnapshotLink(rec_offset, rec_offsets[rec.child]),
+        rec.prev == nullptr ? 0 : MakeSnapshotLink(rec_offset, rec_offsets[rec.prev]),
+        rec.next == nullptr ? 0 : MakeSnapshotLink(rec_offset, rec_offset + rec_size),
+      };
+      static_assert(sizeof(links) == sizeof(char*) * 3);
+      write(links, sizeof(links));
+      write(ptr + sizeof(links), rec_size - sizeof(links));
+    }
+  }
+  *offset = head.end_offset;
+  return num_records_;
+}
+
+std::vector<std::string> CacheSlot::GetKeys() {
+  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+  std::vector<std::string> keys;
+  keys.reserve(num_records_);
+  for (int32_t queue = 0; queue < NUM_CACHE_QUEUES; queue++) {
+    char* ptr = firsts_[queue];
+    while (ptr != nullptr) {
+      CacheRecord rec;
+      rec.Deserialize(ptr);
+      keys.emplace_back(std::string(rec.key_ptr, rec.key_size));
+      ptr = rec.next;
+    }
+  }
+  return keys;
+}
+
+void CacheSlot::AddAllocatorStats(
+    int64_t* reserved_size, int64_t* occupied_size, int64_t* used_size, int64_t* num_blocks) {
+  *reserved_size += alloc_.GetReservedSize();
+  *occupied_size += alloc_.GetOccupiedSize();
+  *used_size += alloc_.GetUsedSize();
+  *num_blocks += alloc_.GetNumBlocks();
+}
+
+void CacheSlot::SetCapacity(int64_t cap_rec_num, int64_t cap_mem_size) {
+  cap_rec_num_ = cap_rec_num;
+  cap_mem_size_ = cap_mem_size;
+  num_buckets_ = GetHashBucketSize(std::min<int64_t>(cap_rec_num_ * MAX_LOAD_FACTOR, INT32MAX));
+  switch (policy_) {
+    case CacheDBM::EVICT_S3FIFO:
+      entry_cap_ = std::max<int64_t>(cap_rec_num_ * S3FIFO_SMALL_RATIO, 1);
+      protected_cap_ = 0;
+      break;
+    case CacheDBM::EVICT_WTINYLFU:
+      entry_cap_ = std::max<int64_t>(cap_rec_num_ * WTINYLFU_WINDOW_RATIO, 1);
+      protected_cap_ = std::max<int64_t>(
+          (cap_rec_num_ - entry_cap_) * WTINYLFU_PROTECTED_RATIO, 1);
+      break;
+    default:
+      entry_cap_ = cap_rec_num_;
+      protected_cap_ = 0;
+      break;
+  }
+}
+
+void CacheSlot::LinkToBack(int32_t queue, char* ptr) {
+  char* last = lasts_[queue];
+  CacheRecord::SetPrev(ptr, last);
+  CacheRecord::SetNext(ptr, nullptr);
+  if (last == nullptr) {
+    firsts_[queue] = ptr;
+  } else {
+    CacheRecord::SetNext(last, ptr);
+  }
+  lasts_[queue] = ptr;
+  CacheRecord::SetMeta(ptr, (CacheRecord::GetMeta(ptr) & ~META_QUEUE_MASK) | queue);
+  queue_sizes_[queue]++;
+}
+
+void CacheSlot::Unlink(char* ptr) {
+  const int32_t queue = CacheRecord::GetMeta(ptr) & META_QUEUE_MASK;
+  char* prev = CacheRecord::GetPrev(ptr);
+  char* next = CacheRecord::GetNext(ptr);
+  if (prev == nullptr) {
+    firsts_[queue] = next;
+  } else {
+    CacheRecord::SetNext(prev, next);
+  }
+  if (next == nullptr) {
+    lasts_[queue] = prev;
+  } else {
+    CacheRecord::SetPrev(next, prev);
+  }
+  queue_sizes_[queue]--;
+}
+
+void CacheSlot::Relink(char* ptr) {
+  const int32_t queue = CacheRecord::GetMeta(ptr) & META_QUEUE_MASK;
+  char* prev = CacheRecord::GetPrev(ptr);
+  char* next = CacheRecord::GetNext(ptr);
+  if (prev == nullptr) {
+    firsts_[queue] = ptr;
+  } else {
+    CacheRecord::SetNext(prev, ptr);
+  }
+  if (next == nullptr) {
+    lasts_[queue] = ptr;
+  } else {
+    CacheRecord::SetPrev(next, ptr);
+  }
+}
+
+void CacheSlot::Touch(char* ptr, uint64_t hash) {
+  const uint8_t meta = CacheRecord::GetMeta(ptr);
+  const int32_t queue = meta & META_QUEUE_MASK;
+  switch (policy_) {
+    case CacheDBM::EVICT_CLOCK:
+      CacheRecord::IncrementFrequency(ptr, 1);
+      break;
+    case CacheDBM::EVICT_S3FIFO:
+      CacheRecord::IncrementFrequency(ptr, S3FIFO_MAX_FREQ);
+      break;
+    case CacheDBM::EVICT_WTINYLFU:
+      sketch_.Increment(hash);
+      if (queue == QUEUE_MAIN) {
+        Unlink(ptr);
+        LinkToBack(QUEUE_PROTECTED, ptr);
+        while (queue_sizes_[QUEUE_PROTECTED] > protected_cap_) {
+          char* demoted = firsts_[QUEUE_PROTECTED];
+          Unlink(demoted);
+          LinkToBack(QUEUE_MAIN, demoted);
+        }
+      } else if (lasts_[queue] != ptr) {
+        Unlink(ptr);
+        LinkToBack(queue, ptr);
+      }
+      break;
+    default:
+      if (lasts_[queue] != ptr) {
+        Unlink(ptr);
+        LinkToBack(queue, ptr);
+      }
+      break;
+  }
+}
+
+void CacheSlot::Admit(char* ptr, uint64_t hash) {
+  switch (policy_) {
+    case CacheDBM::EVICT_S3FIFO:
+      LinkToBack(CheckGhost(hash) ? QUEUE_MAIN : QUEUE_ENTRY, ptr);
+      break;
+    case CacheDBM::EVICT_WTINYLFU:
+      sketch_.Increment(hash);
+      LinkToBack(QUEUE_ENTRY, ptr);
+      if (queue_sizes_[QUEUE_ENTRY] > entry_cap_ && num_records_ < cap_rec_num_) {
+        char* spilled = firsts_[QUEUE_ENTRY];
+        Unlink(spilled);
+        LinkToBack(QUEUE_MAIN, spilled);
+      }
+      break;
+    default:
+      LinkToBack(QUEUE_ENTRY, ptr);
+      break;
+  }
+}
+
+void CacheSlot::Evict() {
+  switch (policy_) {
+    case CacheDBM::EVICT_CLOCK:
+      while (true) {
+        char* ptr = firsts_[QUEUE_ENTRY];
+        const uint8_t meta = CacheRecord::GetMeta(ptr);
+        if ((meta >> META_FREQ_SHIFT) == 0) {
+          RemoveRecord(ptr);
+          return;
+        }
+        CacheRecord::SetMeta(ptr, meta & META_QUEUE_MASK);
+        Unlink(ptr);
+        LinkToBack(QUEUE_ENTRY, ptr);
+      }
+      break;
+    case CacheDBM::EVICT_S3FIFO:
+      while (true) {
+        if (queue_sizes_[QUEUE_ENTRY] > 0 &&
+            (queue_sizes_[QUEUE_ENTRY] >= entry_cap_ || queue_sizes_[QUEUE_MAIN] == 0)) {
+          char* ptr = firsts_[QUEUE_ENTRY];
+          if ((CacheRecord::GetMeta(ptr) >> META_FREQ_SHIFT) == 0) {
+            AddGhost(GetRecordHash(ptr));
+            RemoveRecord(ptr);
+            return;
+          }
+          Unlink(ptr);
+          CacheRecord::SetMeta(ptr, 0);
+          LinkToBack(QUEUE_MAIN, ptr);
+        } else {
+          char* ptr = firsts_[QUEUE_MAIN];
+          const uint8_t meta = CacheRecord::GetMeta(ptr);
+          const int32_t freq = meta >> META_FREQ_SHIFT;
+          if (freq == 0) {
+            RemoveRecord(ptr);
+            return;
+          }
+          Unlink(ptr);
+          CacheRecord::SetMeta(ptr, ((freq - 1) << META_FREQ_SHIFT) | QUEUE_MAIN);
+          LinkToBack(QUEUE_MAIN, ptr);
+        }
+      }
+      break;
+    case CacheDBM::EVICT_WTINYLFU: {
+      if (queue_sizes_[QUEUE_ENTRY] > entry_cap_) {
+        char* candidate = firsts_[QUEUE_ENTRY];
+        char* victim = firsts_[QUEUE_MAIN];
+        if (victim == nullptr) {
+          victim = firsts_[QUEUE_PROTECTED];
+        }
+        if (victim == nullptr) {
+          RemoveRecord(candidate);
+          return;
+        }
+        Unlink(candidate);
+        LinkToBack(QUEUE_MAIN, candidate);
+        if (sketch_.Estimate(GetRecordHash(candidate)) >
+            sketch_.Estimate(GetRecordHash(victim))) {
+          RemoveRecord(victim);
+        } else {
+          RemoveRecord(candidate);
+        }
+        return;
+      }
+      for (const int32_t queue : {QUEUE_MAIN, QUEUE_PROTECTED, QUEUE_ENTRY}) {
+        if (firsts_[queue] != nullptr) {
+          RemoveRecord(firsts_[queue]);
+          return;
+        }
+      }
+      break;
+    }
+    default:
+      RemoveRecord(firsts_[QUEUE_ENTRY]);
+      break;
+  }
+}
+
+void CacheSlot::RemoveRecord(char* ptr) {
+  CacheRecord rec;
+  rec.Deserialize(ptr);
+  const std::string_view key(rec.key_ptr, rec.key_size);
   const uint64_t hash = PrimaryHash(key, UINT64MAX) >> 8;
   const int32_t bucket_index = hash % num_buckets_;
-  CacheRecord rec;
-  char* top = buckets_[bucket_index];
   char* parent = nullptr;
-  char* ptr = top;
-  while (ptr != nullptr) {
-    rec.Deserialize(ptr);
-    if (ptr == first_) {
-      xfree(ptr);
+  char* cur = buckets_[bucket_index];
+  while (cur != nullptr) {
+    if (cur == ptr) {
       if (parent == nullptr) {
         buckets_[bucket_index] = rec.child;
       } else {
         CacheRecord::SetChild(parent, rec.child);
       }
-      if (rec.next != nullptr) {
-        CacheRecord::SetPrev(rec.next, nullptr);
-      }
-      first_ = rec.next;
-      if (last_ == ptr) {
-        last_ = nullptr;
-      }
-      num_records_--;
-      eff_data_size_ -= rec.key_size + rec.value_size;
-      return;
+      break;
     }
-    parent = ptr;
-    ptr = rec.child;
+    parent = cur;
+    cur = CacheRecord::GetChild(cur);
   }
+  Unlink(ptr);
+  num_records_--;
+  eff_data_size_ -= rec.key_size + rec.value_size;
+  FreeRecord(ptr, rec.GetSerializedSize());
 }
 
-std::vector<std::string> CacheSlot::GetKeys() {
-  std::lock_guard<std::mutex> lock(mutex_);
-  std::vector<std::string> keys;
-  keys.reserve(num_records_);
-  char* ptr = first_;
-  while (ptr != nullptr) {
-    CacheRecord rec;
-    rec.Deserialize(ptr);
-    keys.emplace_back(std::string(rec.key_ptr, rec.key_size));
-    ptr = CacheRecord::GetNext(ptr);
+bool CacheSlot::IsBorrowed(const char* ptr) const {
+  return ptr >= borrowed_begin_ && ptr < borrowed_end_;
+}
+
+void CacheSlot::FreeRecord(char* ptr, int32_t size) {
+  if (IsBorrowed(ptr)) {
+    borrowed_size_ -= size;
+  } else {
+    alloc_.Deallocate(ptr, size);
   }
-  return keys;
 }
 
-CacheDBMImpl::CacheDBMImpl(std::unique_ptr<File> file, int64_t cap_rec_num, int64_t cap_mem_size)
+void CacheSlot::AddGhost(uint64_t hash) {
+  const int64_t ghost_cap = std::max<int64_t>(cap_rec_num_ - entry_cap_, 1);
+  ghost_queue_.emplace_back(hash);
+  ghost_counts_[hash]++;
+  while (static_cast<int64_t>(ghost_queue_.size()) > ghost_cap) {
+    auto it = ghost_counts_.find(ghost_queue_.front());
+    if (--it->second <= 0) {
+      ghost_counts_.erase(it);
+    }
+    ghost_queue_.pop_front();
+  }
+}
+
+bool CacheSlot::CheckGhost(uint64_t hash) {
+  return ghost_counts_.find(hash) != ghost_counts_.end();
+}
+
+uint64_t CacheSlot::GetRecordHash(char* ptr) {
+  CacheRecord rec;
+  rec.Deserialize(ptr);
+  return PrimaryHash(std::string_view(rec.key_ptr, rec.key_size), UINT64MAX) >> 8;
+}
+
+CacheDBMImpl::CacheDBMImpl(std::unique_ptr<File> file, int64_t cap_rec_num, int64_t cap_mem_size,
+                           CacheDBM::EvictionPolicy policy, CacheDBM::FileFormat file_format)
     : file_(std::move(file)), open_(false), writable_(false), path_(),
+      open_options_(File::OPEN_DEFAULT),
       cap_rec_num_(cap_rec_num > 0 ? cap_rec_num : CacheDBM::DEFAULT_CAP_REC_NUM),
       cap_mem_size_(cap_mem_size > 0 ? cap_mem_size : INT64MAX),
-      slots_(), mutex_() {
+      policy_(policy == CacheDBM::EVICT_DEFAULT ? CacheDBM::EVICT_LRU : policy),
+      file_format_(file_format), open_format_(CacheDBM::FORMAT_FLAT),
+      slots_(), snapshot_(), mutex_() {
   InitAllSlots();
 }
 
@@ -552,7 +1159,7 @@ Status CacheDBMImpl::Open(const std::string& path, bool writable, int32_t option
   if (status != Status::SUCCESS) {
     return status;
   }
-  status = ImportRecords();
+  status = ImportRecords(path);
   if (status != Status::SUCCESS) {
     file_->Close();
     return status;
@@ -560,6 +1167,7 @@ Status CacheDBMImpl::Open(const std::string& path, bool writable, int32_t option
   open_ = true;
   writable_ = writable;
   path_ = path;
+  open_options_ = options & ~File::OPEN_TRUNCATE;
   return Status(Status::SUCCESS);
 }
 
@@ -570,15 +1178,20 @@ Status CacheDBMImpl::Close() {
   }
   Status status(Status::SUCCESS);
   if (writable_) {
-    status |= ExportRecords();
+    status |= ExportRecords(false, false);
   }
   status |= file_->Close();
   CleanUpAllSlots();
+  if (snapshot_.Pointer() != nullptr) {
+    snapshot_.Close();
+  }
   CancelIterators();
   InitAllSlots();
   open_ = false;
   writable_ = false;
   path_.clear();
+  open_options_ = File::OPEN_DEFAULT;
+  open_format_ = CacheDBM::FORMAT_FLAT;
   return status;
 }
 
@@ -631,6 +1244,9 @@ Status CacheDBMImpl::GetFilePath(std::string* path) {
 Status CacheDBMImpl::Clear() {
   std::lock_guard<std::shared_timed_mutex> lock(mutex_);
   CleanUpAllSlots();
+  if (snapshot_.Pointer() != nullptr) {
+    snapshot_.Close();
+  }
   CancelIterators();
   InitAllSlots();
   return Status(Status::SUCCESS);
@@ -657,8 +1273,7 @@ Status CacheDBMImpl::Synchronize(bool hard, DBM::FileProcessor* proc) {
   std::lock_guard<std::shared_timed_mutex> lock(mutex_);
   Status status(Status::SUCCESS);
   if (open_ && writable_) {
-    status |= ExportRecords();
-    status |= file_->Synchronize(hard);
+    status |= ExportRecords(true, hard);
     if (proc != nullptr) {
       proc->Process(path_);
     }
@@ -679,16 +1294,31 @@ std::vector<std::pair<std::string, std::string>> CacheDBMImpl::Inspect() {
   int64_t num_records = 0;
   int64_t eff_data_size = 0;
   int64_t mem_usage = 0;
+  int64_t slab_reserved_size = 0;
+  int64_t slab_occupied_size = 0;
+  int64_t slab_used_size = 0;
+  int64_t slab_num_blocks = 0;
   for (auto& slot : slots_) {
     num_records += slot.Count();
     eff_data_size += slot.GetEffectiveDataSize();
     mem_usage += slot.GetMemoryUsage();
+    slot.AddAllocatorStats(&slab_reserved_size, &slab_occupied_size,
+                           &slab_used_size, &slab_num_blocks);
   }
   Add("num_records", ToString(num_records));
   Add("eff_data_size", ToString(eff_data_size));
   Add("mem_usage", ToString(mem_usage));
+  Add("slab_reserved_size", ToString(slab_reserved_size));
+  Add("slab_occupied_size", ToString(slab_occupied_size));
+  Add("slab_used_size", ToString(slab_used_size));
+  Add("slab_num_blocks", ToString(slab_num_blocks));
   Add("cap_rec_num", ToString(cap_rec_num_));
   Add("cap_mem_size", ToString(cap_mem_size_));
+  Add("eviction", CacheDBM::GetEvictionPolicyName(policy_));
+  if (open_) {
+    Add("file_format", CacheDBM::GetFileFormatName(open_format_));
+  }
+  Add("snapshot_size", ToString(snapshot_.Size()));
   return meta;
 }
 
@@ -704,7 +1334,8 @@ bool CacheDBMImpl::IsWritable() {
 
 std::unique_ptr<DBM> CacheDBMImpl::MakeDBM() {
   std::shared_lock<std::shared_timed_mutex> lock(mutex_);
-  return std::make_unique<CacheDBM>(file_->MakeFile(), cap_rec_num_, cap_mem_size_);
+  return std::make_unique<CacheDBM>(
+      file_->MakeFile(), cap_rec_num_, cap_mem_size_, policy_, file_format_);
 }
 
 int64_t CacheDBMImpl::GetEffectiveDataSize() {
@@ -735,7 +1366,7 @@ void CacheDBMImpl::InitAllSlots() {
   const int64_t slot_cap_rec_num = cap_rec_num_ / NUM_CACHE_SLOTS + 1;
   const int64_t slot_cap_mem_size = cap_mem_size_ / NUM_CACHE_SLOTS + 1;
   for (auto& slot : slots_) {
-    slot.Init(slot_cap_rec_num, slot_cap_mem_size);
+    slot.Init(slot_cap_rec_num, slot_cap_mem_size, policy_);
   }
 }
 
@@ -745,49 +1376,181 @@ void CacheDBMImpl::CleanUpAllSlots() {
   }
 }
 
-Status CacheDBMImpl::ImportRecords() {
-  int64_t end_offset = 0;
-  Status status = file_->GetSize(&end_offset);
+Status CacheDBMImpl::ImportRecords(const std::string& path) {
+  int64_t file_size = 0;
+  Status status = file_->GetSize(&file_size);
   if (status != Status::SUCCESS) {
     return status;
   }
-  FlatRecordReader reader(file_.get());
-  std::string key_store;
-  while (true) {
-    std::string_view key;
-    Status status = reader.Read(&key);
+  open_format_ = CacheDBM::FORMAT_FLAT;
+  if (file_size >= static_cast<int64_t>(sizeof(CacheSnapshotHeader))) {
+    char magic[sizeof(SNAPSHOT_MAGIC)];
+    status = file_->Read(0, magic, sizeof(magic));
     if (status != Status::SUCCESS) {
-      if (status != Status::NOT_FOUND_ERROR) {
-        return status;
+      return status;
+    }
+    if (std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) == 0) {
+      open_format_ = CacheDBM::FORMAT_SNAPSHOT;
+      return ImportSnapshot(path);
+    }
+  }
+  return ImportFlatRecords();
+}
+
+Status CacheDBMImpl::ImportFlatRecords() {
+  const int32_t num_threads = std::min(
+      std::max(static_cast<int32_t>(std::thread::hardware_concurrency()), 2),
+      NUM_CACHE_SLOTS);
+  return ImportFlatRecordsInParallel(
+      file_.get(), num_threads, [](int64_t batch_size) {},
+      [&](uint64_t hash) {
+        return (hash & 0xff) % NUM_CACHE_SLOTS % num_threads;
+      },
+      [&](std::string_view key, std::string_view value, uint64_t hash) {
+        const int32_t slot_index = (hash & 0xff) % NUM_CACHE_SLOTS;
+        Status status(Status::SUCCESS);
+        DBM::RecordProcessorSet setter(&status, value, true);
+        slots_[slot_index].Process(key, hash >> 8, &setter, true);
+      });
+}
+
+Status CacheDBMImpl::ImportSnapshot(const std::string& path) {
+  Status status = snapshot_.Open(path);
+  if (status != Status::SUCCESS) {
+    return status;
+  }
+  char* const base = snapshot_.Pointer();
+  CacheSnapshotHeader head;
+  std::memcpy(&head, base, sizeof(head));
+  if (head.endian_mark != SNAPSHOT_ENDIAN_MARK || head.num_slots < 1 ||
+      head.num_records < 0 || head.end_offset < static_cast<int64_t>(sizeof(head)) ||
+      head.end_offset > snapshot_.Size()) {
+    snapshot_.Close();
+    return Status(Status::BROKEN_DATA_ERROR, "invalid snapshot header");
+  }
+  auto check_slot = [&](int64_t offset, const CacheSnapshotSlot& disk_slot) {
+    int64_t num_queue_records = 0;
+    for (int32_t queue = 0; queue < NUM_CACHE_QUEUES; queue++) {
+      if (disk_slot.queue_sizes[queue] < 0) {
+        return false;
       }
+      num_queue_records += disk_slot.queue_sizes[queue];
+    }
+    if (num_queue_records != disk_slot.num_records || disk_slot.num_buckets < 0 ||
+        disk_slot.end_offset < offset || disk_slot.end_offset > head.end_offset ||
+        disk_slot.num_buckets > (disk_slot.end_offset - offset) /
+        static_cast<int64_t>(sizeof(int64_t))) {
+      return false;
+    }
+    int64_t num_records = 0;
+    const char* rp = base + offset + disk_slot.num_buckets * sizeof(int64_t);
+    const char* const end = base + disk_slot.end_offset;
+    while (rp < end) {
+      CacheRecord rec;
+      if (!rec.Deserialize(rp, end - rp)) {
+        return false;
+      }
+      num_records++;
+      rp = rec.value_ptr + rec.value_size;
+    }
+    return num_records == disk_slot.num_records;
+  };
+  std::vector<std::pair<int64_t, CacheSnapshotSlot>> disk_slots;
+  disk_slots.reserve(std::min(head.num_slots, NUM_CACHE_SLOTS));
+  int64_t offset = sizeof(head);
+  int64_t num_records = 0;
+  for (int32_t slot_index = 0; slot_index < head.num_slots; slot_index++) {
+    CacheSnapshotSlot disk_slot;
+    if (head.end_offset - offset < static_cast<int64_t>(sizeof(disk_slot))) {
+      status = Status(Status::BROKEN_DATA_ERROR, "invalid snapshot slot");
       break;
     }
-    key_store = key;
-    std::string_view value;
-    status = reader.Read(&value);
-    if (status != Status::SUCCESS) {
-      if (status != Status::NOT_FOUND_ERROR) {
-        return status;
+    std::memcpy(&disk_slot, base + offset, sizeof(disk_slot));
+    offset += sizeof(disk_slot);
+    if (!check_slot(offset, disk_slot)) {
+      status = Status(Status::BROKEN_DATA_ERROR, "invalid snapshot slot");
+      break;
+    }
+    disk_slots.emplace_back(offset, disk_slot);
+    offset = disk_slot.end_offset;
+    num_records += disk_slot.num_records;
+  }
+  if (status == Status::SUCCESS &&
+      (offset != head.end_offset || num_records != head.num_records)) {
+    status = Status(Status::BROKEN_DATA_ERROR, "inconsistent number of snapshot records");
+  }
+  if (status != Status::SUCCESS) {
+    snapshot_.Close();
+    return status;
+  }
+  bool adoptable = head.num_slots == NUM_CACHE_SLOTS && head.policy == policy_;
+  for (int32_t slot_index = 0; adoptable && slot_index < NUM_CACHE_SLOTS; slot_index++) {
+    auto& slot = slots_[slot_index];
+    if (slot.Count() > 0 || slot.GetNumBuckets() != disk_slots[slot_index].second.num_buckets) {
+      adoptable = false;
+    }
+  }
+  if (!adoptable) {
+    for (const auto& disk_slot : disk_slots) {
+      const char* rp = base + disk_slot.first + disk_slot.second.num_buckets * sizeof(int64_t);
+      const char* const end = base + disk_slot.second.end_offset;
+      while (rp < end) {
+        CacheRecord rec;
+        rec.Deserialize(rp);
+        const std::string_view key(rec.key_ptr, rec.key_size);
+        const uint64_t hash = PrimaryHash(key, UINT64MAX);
+        const int32_t slot_index = (hash & 0xff) % NUM_CACHE_SLOTS;
+        DBM::RecordProcessorSet setter(&status, std::string_view(rec.value_ptr, rec.value_size),
+                                       true);
+        slots_[slot_index].Process(key, hash >> 8, &setter, true);
+        rp = rec.value_ptr + rec.value_size;
       }
-      return Status(Status::BROKEN_DATA_ERROR, "odd number of records");
     }
-    uint64_t hash = PrimaryHash(key_store, UINT64MAX);
-    const int32_t slot_index = (hash & 0xff) % NUM_CACHE_SLOTS;
-    hash >>= 8;
-    DBM::RecordProcessorSet setter(&status, value, true);
-    slots_[slot_index].Process(key_store, hash, &setter, true);
+    snapshot_.Close();
+    return status;
+  }
+  for (int32_t slot_index = 0; slot_index < NUM_CACHE_SLOTS; slot_index++) {
+    const auto& disk_slot = disk_slots[slot_index];
+    if (!slots_[slot_index].ImportSnapshot(
+            base, disk_slot.first, disk_slot.second, slot_index)) {
+      CleanUpAllSlots();
+      InitAllSlots();
+      snapshot_.Close();
+      return Status(Status::BROKEN_DATA_ERROR, "invalid snapshot record links");
+    }
   }
   return Status(Status::SUCCESS);
 }
 
-Status CacheDBMImpl::ExportRecords() {
-  Status status = file_->Truncate(0);
-  if (status != Status::SUCCESS) {
+Status CacheDBMImpl::ExportRecords(bool synchronize, bool hard) {
+  const CacheDBM::FileFormat format =
+      file_format_ == CacheDBM::FORMAT_DEFAULT ? open_format_ : file_format_;
+  if (format != CacheDBM::FORMAT_SNAPSHOT && snapshot_.Pointer() == nullptr) {
+    Status status = file_->Truncate(0);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+    status = WriteFlatRecords(file_.get());
+    if (synchronize) {
+      status |= file_->Synchronize(hard);
+    }
     return status;
   }
-  FlatRecord flat_rec(file_.get());
+  const Status status = RewriteDBMFile(
+      file_.get(), path_, open_options_,
+      [&](File* file) {
+        return format == CacheDBM::FORMAT_SNAPSHOT ? WriteSnapshot(file) : WriteFlatRecords(file);
+      }, synchronize, hard);
+  if (status == Status::SUCCESS) {
+    open_format_ = format;
+  }
+  return status;
+}
+
+Status CacheDBMImpl::WriteFlatRecords(File* file) {
+  FlatRecord flat_rec(file);
   for (auto& slot : slots_) {
-    status = slot.ExportRecords(&flat_rec);
+    const Status status = slot.ExportRecords(&flat_rec);
     if (status != Status::SUCCESS) {
       return status;
     }
@@ -795,6 +1558,36 @@ Status CacheDBMImpl::ExportRecords() {
   return Status(Status::SUCCESS);
 }
 
+Status CacheDBMImpl::WriteSnapshot(File* file) {
+  CacheSnapshotHeader head;
+  std::memset(&head, 0, sizeof(head));
+  std::memcpy(head.magic, SNAPSHOT_MAGIC, sizeof(head.magic));
+  head.endian_mark = SNAPSHOT_ENDIAN_MARK;
+  head.num_slots = NUM_CACHE_SLOTS;
+  head.policy = policy_;
+  std::string buffer;
+  buffer.reserve(SNAPSHOT_BUFFER_SIZE * 2);
+  Status status(Status::SUCCESS);
+  auto write = [&](const void* data, size_t size) {
+    buffer.append(static_cast<const char*>(data), size);
+    if (static_cast<int64_t>(buffer.size()) >= SNAPSHOT_BUFFER_SIZE) {
+      status |= file->Append(buffer.data(), buffer.size());
+      buffer.clear();
+    }
+  };
+  write(&head, sizeof(head));
+  int64_t offset = sizeof(head);
+  for (auto& slot : slots_) {
+    head.num_records += slot.WriteSnapshot(write, &offset);
+  }
+  if (!buffer.empty()) {
+    status |= file->Append(buffer.data(), buffer.size());
+  }
+  head.end_offset = offset;
+  status |= file->Write(0, &head, sizeof(head));
+  return status;
+}
+
 Status CacheDBMImpl::ReadNextBucketRecords(CacheDBMIteratorImpl* iter) {
   while (true) {
     int64_t slot_index = iter->slot_index_.load();
@@ -916,12 +1709,15 @@ Status CacheDBMIteratorImpl::ReadKeys() {
   return Status(Status::SUCCESS);
 }
 
-CacheDBM::CacheDBM(int64_t cap_rec_num, int64_t cap_mem_size) {
-  impl_ = new CacheDBMImpl(std::make_unique<MemoryMapParallelFile>(), cap_rec_num, cap_mem_size);
+CacheDBM::CacheDBM(int64_t cap_rec_num, int64_t cap_mem_size, EvictionPolicy policy,
+                   FileFormat file_format) {
+  impl_ = new CacheDBMImpl(std::make_unique<MemoryMapParallelFile>(), cap_rec_num, cap_mem_size,
+                           policy, file_format);
 }
 
-CacheDBM::CacheDBM(std::unique_ptr<File> file, int64_t cap_rec_num, int64_t cap_mem_size) {
-  impl_ = new CacheDBMImpl(std::move(file), cap_rec_num, cap_mem_size);
+CacheDBM::CacheDBM(std::unique_ptr<File> file, int64_t cap_rec_num, int64_t cap_mem_size,
+                   EvictionPolicy policy, FileFormat file_format) {
+  impl_ = new CacheDBMImpl(std::move(file), cap_rec_num, cap_mem_size, policy, file_format);
 }
 
 CacheDBM::~CacheDBM() {
@@ -1002,6 +1798,62 @@ int64_t CacheDBM::GetMemoryUsage() {
   return impl_->GetMemoryUsage();
 }
 
+const char* CacheDBM::GetEvictionPolicyName(EvictionPolicy policy) {
+  switch (policy) {
+    case EVICT_LRU:
+      return "lru";
+    case EVICT_CLOCK:
+      return "clock";
+    case EVICT_S3FIFO:
+      return "s3fifo";
+    case EVICT_WTINYLFU:
+      return "wtinylfu";
+    default:
+      break;
+  }
+  return "default";
+}
+
+CacheDBM::EvictionPolicy CacheDBM::ParseEvictionPolicy(std::string_view name) {
+  const std::string lower_name = StrLowerCase(name);
+  if (lower_name == "lru") {
+    return EVICT_LRU;
+  }
+  if (lower_name == "clock") {
+    return EVICT_CLOCK;
+  }
+  if (lower_name == "s3fifo" || lower_name == "s3-fifo") {
+    return EVICT_S3FIFO;
+  }
+  if (lower_name == "wtinylfu" || lower_name == "w-tinylfu") {
+    return EVICT_WTINYLFU;
+  }
+  return EVICT_DEFAULT;
+}
+
+const char* CacheDBM::GetFileFormatName(FileFormat file_format) {
+  switch (file_format) {
+    case FORMAT_FLAT:
+      return "flat";
+    case FORMAT_SNAPSHOT:
+      return "snapshot";
+    default:
+      break;
+  }
+  return "default";
+}
+
+CacheDBM::FileFormat CacheDBM::ParseFileFormat(std::string_view name) {
+  const std::string lower_name = StrLowerCase(name);
+  if (lower_name == "flat") {
+    return FORMAT_FLAT;
+  }
+  if (lower_name == "snapshot") {
+    return FORMAT_SNAPSHOT;
+  }
+  return FORMAT_DEFAULT;
+}
+
 CacheDBM::Iterator::Iterator(CacheDBMImpl* dbm_impl) {
   impl_ = new CacheDBMIteratorImpl(dbm_impl);
 }
@@ -34,13 +34,44 @@ class CacheDBMIteratorImpl;
 /**
  * On-memory database manager implementation with LRU deletion.
  * @details All operations are thread-safe; Multiple threads can access the same database
- * concurrently.
+ * concurrently.  With EVICT_CLOCK and EVICT_S3FIFO, a hit only updates bits in the record
+ * atomically, so reading operations like Get share the lock of each internal slot and scale
+ * with the number of cores.  With EVICT_LRU and EVICT_WTINYLFU, every hit reorders the lists
+ * and reading operations on the same slot are serialized.
  */
 class CacheDBM final : public DBM {
  public:
   /** The default value of the maximum number of records. */
   static constexpr int64_t DEFAULT_CAP_REC_NUM = 1048576;
 
+  /**
+   * Enumeration for eviction policies.
+   */
+  enum EvictionPolicy : int32_t {
+    /** The default behavior, which is the same as EVICT_LRU. */
+    EVICT_DEFAULT = 0,
+    /** To remove the least recently used record.  Every hit moves the record in the list. */
+    EVICT_LRU = 1,
+    /** To approximate LRU with a reference bit and second chances.  Hits don't move records. */
+    EVICT_CLOCK = 2,
+    /** To use a small and a main FIFO queue with a ghost queue.  Hits don't move records. */
+    EVICT_S3FIFO = 3,
+    /** To use a window LRU and a segmented LRU with frequency-based admission. */
+    EVICT_WTINYLFU = 4,
+  };
+
+  /**
+   * Enumeration for formats of the database file.
+   */
+  enum FileFormat : int32_t {
+    /** To keep the format of the loaded file, or to use FORMAT_FLAT for a new file. */
+    FORMAT_DEFAULT = 0,
+    /** The flat record format, which is portable and read sequentially. */
+    FORMAT_FLAT = 1,
+    /** The memory image of the hash tables and the queues, which is mapped without parsing. */
+    FORMAT_SNAPSHOT = 2,
+  };
+
   /**
    * Iterator for each record.
    * @details When the database is updated, some iterators may or may not be invalided.
@@ -152,10 +183,14 @@ class CacheDBM final : public DBM {
    * @param cap_rec_num The maximum number of records.  -1 means that the default value 1048576 is
    * set.
    * @param cap_mem_size The total memory size to use.  -1 means unlimited.
+   * @param policy The eviction policy.
+   * @param file_format The format of the file to save records in.
    * @details If the number of records or the total memory size exceeds the capacity LRU
-   * (least resente used) records are removed implicitly.
+   * (least resente used) records are removed implicitly.  Other eviction policies can be
+   * specified instead of LRU.
    */
-  CacheDBM(int64_t cap_rec_num = -1, int64_t cap_mem_size = -1);
+  CacheDBM(int64_t cap_rec_num = -1, int64_t cap_mem_size = -1,
+           EvictionPolicy policy = EVICT_DEFAULT, FileFormat file_format = FORMAT_DEFAULT);
 
   /**
    * Constructor with a file object.
@@ -164,10 +199,14 @@ class CacheDBM final : public DBM {
    * set.  As the number of hash buckets is set by the maximum number of records, setting too large
    * value is not good for space efficiency.
    * @param cap_mem_size The total memory size to use.  -1 means unlimited.
+   * @param policy The eviction policy.
+   * @param file_format The format of the file to save records in.
    * @details If the number of records or the total memory size exceeds the capacity LRU
-   * (least resente used) records are removed implicitly.
+   * (least resente used) records are removed implicitly.  Other eviction policies can be
+   * specified instead of LRU.
    */
-  CacheDBM(std::unique_ptr<File> file, int64_t cap_rec_num = -1, int64_t cap_mem_size = -1);
+  CacheDBM(std::unique_ptr<File> file, int64_t cap_rec_num = -1, int64_t cap_mem_size = -1,
+           EvictionPolicy policy = EVICT_DEFAULT, FileFormat file_format = FORMAT_DEFAULT);
 
   /**
    * Destructor.
@@ -343,10 +382,40 @@ class CacheDBM final : public DBM {
   /**
    * Gets the current memory usage.
    * @return The current memory usage, or -1 on failure.
-   * @details The memory usage is estimated by the effective data size and the nuber of records.
+   * @details The memory usage is the size of the hash buckets plus the size of the regions of
+   * the slabs cut out for the records, which includes free blocks not reused yet.  Records used
+   * in place in a mapped snapshot are counted by their serialized size.
    */
   int64_t GetMemoryUsage();
 
+  /**
+   * Gets the name of an eviction policy.
+   * @param policy The eviction policy.
+   * @return The name of the eviction policy: "lru", "clock", "s3fifo", or "wtinylfu".
+   */
+  static const char* GetEvictionPolicyName(EvictionPolicy policy);
+
+  /**
+   * Parses the name of an eviction policy.
+   * @param name The name of the eviction policy, which is case-insensitive.
+   * @return The eviction policy, or EVICT_DEFAULT if the name is unknown.
+   */
+  static EvictionPolicy ParseEvictionPolicy(std::string_view name);
+
+  /**
+   * Gets the name of a file format.
+   * @param file_format The file format.
+   * @return The name of the file format: "flat" or "snapshot".
+   */
+  static const char* GetFileFormatName(FileFormat file_format);
+
+  /**
+   * Parses the name of a file format.
+   * @param name The name of the file format, which is case-insensitive.
+   * @return The file format, or FORMAT_DEFAULT if the name is unknown.
+   */
+  static FileFormat ParseFileFormat(std::string_view name);
+
  private:
   /** Pointer to the actual implementation. */
   class CacheDBMImpl* impl_;
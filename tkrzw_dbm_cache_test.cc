@@ -175,4 +175,310 @@ TEST_F(CacheDBMTest, LRURemove) {
   EXPECT_EQ(0, dbm.GetEffectiveDataSize());
 }
 
+TEST_F(CacheDBMTest, EvictionPolicies) {
+  const std::vector<tkrzw::CacheDBM::EvictionPolicy> policies = {
+    tkrzw::CacheDBM::EVICT_LRU, tkrzw::CacheDBM::EVICT_CLOCK,
+    tkrzw::CacheDBM::EVICT_S3FIFO, tkrzw::CacheDBM::EVICT_WTINYLFU};
+  for (const auto policy : policies) {
+    const std::string name = tkrzw::CacheDBM::GetEvictionPolicyName(policy);
+    EXPECT_EQ(policy, tkrzw::CacheDBM::ParseEvictionPolicy(name));
+    {
+      tkrzw::CacheDBM dbm(-1, -1, policy);
+      BasicTest(&dbm);
+    }
+    {
+      tkrzw::CacheDBM dbm(-1, -1, policy);
+      ProcessTest(&dbm);
+    }
+    {
+      tkrzw::CacheDBM dbm(-1, -1, policy);
+      RandomTestThread(&dbm);
+    }
+    {
+      tkrzw::CacheDBM dbm(-1, -1, policy);
+      RebuildRandomTest(&dbm);
+    }
+    tkrzw::CacheDBM dbm(1024, -1, policy);
+    for (int32_t i = 0; i < 4096; i++) {
+      const std::string key = tkrzw::ToString(i);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(key, key));
+      const std::string hot_key = tkrzw::ToString(i % 64);
+      dbm.Get(hot_key);
+    }
+    const int64_t count = dbm.CountSimple();
+    EXPECT_GE(count, 1024);
+    EXPECT_LT(count, 2000);
+    const auto meta = dbm.Inspect();
+    const std::map<std::string, std::string> meta_map(meta.begin(), meta.end());
+    EXPECT_EQ(name, tkrzw::SearchMap(meta_map, "eviction", ""));
+    EXPECT_EQ(count, tkrzw::StrToInt(tkrzw::SearchMap(meta_map, "slab_num_blocks", "")));
+    EXPECT_LE(tkrzw::StrToInt(tkrzw::SearchMap(meta_map, "slab_used_size", "")),
+              tkrzw::StrToInt(tkrzw::SearchMap(meta_map, "mem_usage", "")));
+    auto iter = dbm.MakeIterator();
+    EXPECT_EQ(tkrzw::Status::SUCCESS, iter->First());
+    int64_t eff_data_size = 0;
+    int64_t num_records = 0;
+    std::string key, value;
+    while (iter->Get(&key, &value).IsOK()) {
+      EXPECT_EQ(key, value);
+      eff_data_size += key.size() + value.size();
+      num_records++;
+      EXPECT_EQ(tkrzw::Status::SUCCESS, iter->Next());
+    }
+    EXPECT_EQ(count, num_records);
+    EXPECT_EQ(eff_data_size, dbm.GetEffectiveDataSize());
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.RebuildAdvanced(512));
+    EXPECT_LT(dbm.CountSimple(), count);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Clear());
+    EXPECT_EQ(0, dbm.CountSimple());
+    EXPECT_EQ(0, dbm.GetEffectiveDataSize());
+  }
+  EXPECT_EQ(tkrzw::CacheDBM::EVICT_DEFAULT, tkrzw::CacheDBM::ParseEvictionPolicy("foo"));
+}
+
+TEST_F(CacheDBMTest, MemoryChurn) {
+  constexpr int64_t slab_cap_size = 4 * 1024 * 1024;
+  const int64_t cap_mem_size = tkrzw::CacheDBM(20000, -1).GetMemoryUsage() + slab_cap_size;
+  tkrzw::CacheDBM dbm(20000, cap_mem_size);
+  for (int32_t value_size = 8; value_size <= 2048; value_size *= 2) {
+    const std::string value(value_size, 'v');
+    for (int32_t i = 0; i < 20000; i++) {
+      const std::string key = tkrzw::SPrintF("%08d", i);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(key, value));
+      ASSERT_LE(dbm.GetMemoryUsage(), cap_mem_size);
+    }
+    const auto meta = dbm.Inspect();
+    const std::map<std::string, std::string> meta_map(meta.begin(), meta.end());
+    const int64_t reserved_size =
+        tkrzw::StrToInt(tkrzw::SearchMap(meta_map, "slab_reserved_size", ""));
+    const int64_t occupied_size =
+        tkrzw::StrToInt(tkrzw::SearchMap(meta_map, "slab_occupied_size", ""));
+    EXPECT_GE(reserved_size, occupied_size);
+    EXPECT_LE(reserved_size, slab_cap_size * 2);
+    EXPECT_GT(dbm.CountSimple(), 0);
+  }
+}
+
+TEST_F(CacheDBMTest, SnapshotFormat) {
+  const auto snapshot = tkrzw::CacheDBM::FORMAT_SNAPSHOT;
+  EXPECT_EQ(snapshot, tkrzw::CacheDBM::ParseFileFormat(
+      tkrzw::CacheDBM::GetFileFormatName(snapshot)));
+  EXPECT_EQ(tkrzw::CacheDBM::FORMAT_DEFAULT, tkrzw::CacheDBM::ParseFileFormat("foo"));
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string file_path = tmp_dir.MakeUniquePath();
+  constexpr int32_t num_records = 20000;
+  const std::vector<tkrzw::CacheDBM::EvictionPolicy> policies = {
+    tkrzw::CacheDBM::EVICT_LRU, tkrzw::CacheDBM::EVICT_CLOCK,
+    tkrzw::CacheDBM::EVICT_S3FIFO, tkrzw::CacheDBM::EVICT_WTINYLFU};
+  for (const auto policy : policies) {
+    std::map<std::string, std::string> expected;
+    auto check_records = [&](tkrzw::DBM* dbm) {
+      EXPECT_EQ(expected.size(), dbm->CountSimple());
+      int64_t eff_data_size = 0;
+      for (const auto& record : expected) {
+        EXPECT_EQ(record.second, dbm->GetSimple(record.first));
+        eff_data_size += record.first.size() + record.second.size();
+      }
+      EXPECT_EQ(eff_data_size, dynamic_cast<tkrzw::CacheDBM*>(dbm)->GetEffectiveDataSize());
+    };
+    {
+      tkrzw::CacheDBM dbm(num_records * 2, -1, policy, snapshot);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Open(file_path, true, tkrzw::File::OPEN_TRUNCATE));
+      for (int32_t i = 0; i < num_records; i++) {
+        const std::string key = tkrzw::SPrintF("%08d", i);
+        const std::string value(i % 100, 'v');
+        EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(key, value));
+        expected.emplace(key, value);
+      }
+      EXPECT_EQ(expected["00000000"], dbm.GetSimple("00000000"));
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+    }
+    std::string content;
+    EXPECT_EQ(tkrzw::Status::SUCCESS, tkrzw::ReadFile(file_path, &content));
+    EXPECT_EQ("TkrzwCSN", content.substr(0, 8));
+    {
+      tkrzw::CacheDBM dbm(num_records * 2, -1, policy);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Open(file_path, true));
+      auto meta = dbm.Inspect();
+      std::map<std::string, std::string> meta_map(meta.begin(), meta.end());
+      EXPECT_EQ("snapshot", tkrzw::SearchMap(meta_map, "file_format", ""));
+      EXPECT_GE(tkrzw::StrToInt(tkrzw::SearchMap(meta_map, "snapshot_size", "")),
+                content.size());
+      EXPECT_EQ("0", tkrzw::SearchMap(meta_map, "slab_num_blocks", ""));
+      EXPECT_GT(dbm.GetMemoryUsage(), content.size() / 2);
+      check_records(&dbm);
+      for (int32_t i = 0; i < num_records; i += 3) {
+        const std::string key = tkrzw::SPrintF("%08d", i);
+        EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Remove(key));
+        expected.erase(key);
+      }
+      for (int32_t i = 1; i < num_records; i += 3) {
+        const std::string key = tkrzw::SPrintF("%08d", i);
+        EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(key, "x"));
+        expected[key] = "x";
+      }
+      for (int32_t i = 2; i < num_records; i += 3) {
+        const std::string key = tkrzw::SPrintF("%08d", i);
+        EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Append(key, "y", ":"));
+        expected[key] = expected[key] + ":y";
+      }
+      for (int32_t i = num_records; i < num_records + 2000; i++) {
+        const std::string key = tkrzw::SPrintF("%08d", i);
+        EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(key, key));
+        expected.emplace(key, key);
+      }
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Synchronize(false));
+      check_records(&dbm);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+      meta = dbm.Inspect();
+      meta_map = std::map<std::string, std::string>(meta.begin(), meta.end());
+      EXPECT_EQ("0", tkrzw::SearchMap(meta_map, "snapshot_size", ""));
+    }
+    if (policy == tkrzw::CacheDBM::EVICT_LRU) {
+      tkrzw::CacheDBM dbm(num_records / 2, -1, policy);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Open(file_path, false));
+      EXPECT_LE(dbm.CountSimple(), num_records / 2 + 32);
+      EXPECT_EQ(tkrzw::Status::NOT_FOUND_ERROR, dbm.Get("00000001"));
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Get(tkrzw::SPrintF("%08d", num_records + 1999)));
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+    }
+    {
+      constexpr int64_t cap_mem_size = 1024 * 1024;
+      tkrzw::CacheDBM dbm(num_records * 2, cap_mem_size, policy);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Open(file_path, false));
+      EXPECT_LE(dbm.GetMemoryUsage(), cap_mem_size + 32);
+      EXPECT_LT(dbm.CountSimple(), expected.size());
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+    }
+    {
+      const auto other_policy = policy == tkrzw::CacheDBM::EVICT_LRU ?
+          tkrzw::CacheDBM::EVICT_CLOCK : tkrzw::CacheDBM::EVICT_LRU;
+      tkrzw::CacheDBM dbm(num_records * 2, -1, other_policy);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Open(file_path, false));
+      const auto meta = dbm.Inspect();
+      const std::map<std::string, std::string> meta_map(meta.begin(), meta.end());
+      EXPECT_EQ("0", tkrzw::SearchMap(meta_map, "snapshot_size", ""));
+      check_records(&dbm);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+    }
+    {
+      tkrzw::CacheDBM dbm(num_records * 2, -1, policy, tkrzw::CacheDBM::FORMAT_FLAT);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set("extra", "record"));
+      expected.emplace("extra", "record");
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Open(file_path, true));
+      const auto meta = dbm.Inspect();
+      const std::map<std::string, std::string> meta_map(meta.begin(), meta.end());
+      EXPECT_EQ("0", tkrzw::SearchMap(meta_map, "snapshot_size", ""));
+      check_records(&dbm);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+    }
+    EXPECT_EQ(tkrzw::Status::SUCCESS, tkrzw::ReadFile(file_path, &content));
+    EXPECT_NE("TkrzwCSN", content.substr(0, 8));
+    {
+      tkrzw::CacheDBM dbm(num_records * 2, -1, policy, snapshot);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Open(file_path, true));
+      check_records(&dbm);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+    }
+    EXPECT_EQ(tkrzw::Status::SUCCESS, tkrzw::ReadFile(file_path, &content));
+    EXPECT_EQ("TkrzwCSN", content.substr(0, 8));
+    EXPECT_FALSE(tkrzw::PathIsFile(file_path + ".tmp"));
+    const auto CheckBroken = [&](int64_t offset, int64_t diff) {
+      std::string broken_content = content;
+      int64_t num = 0;
+      std::memcpy(&num, broken_content.data() + offset, sizeof(num));
+      num += diff;
+      std::memcpy(broken_content.data() + offset, &num, sizeof(num));
+      EXPECT_EQ(tkrzw::Status::SUCCESS, tkrzw::WriteFile(file_path, broken_content));
+      tkrzw::CacheDBM dbm(num_records * 2, -1, policy);
+      EXPECT_EQ(tkrzw::Status::BROKEN_DATA_ERROR, dbm.Open(file_path, false));
+    };
+    constexpr int64_t slot_offset = 40;
+    CheckBroken(slot_offset + 8, 1);
+    constexpr int64_t table_offset = slot_offset + 56;
+    int64_t bucket_pos = table_offset;
+    int64_t rec_offset = 0;
+    while (rec_offset == 0) {
+      std::memcpy(&rec_offset, content.data() + bucket_pos, sizeof(rec_offset));
+      bucket_pos += sizeof(rec_offset);
+    }
+    bucket_pos -= sizeof(rec_offset);
+    CheckBroken(bucket_pos, 1);
+    CheckBroken(bucket_pos, -1);
+    CheckBroken(rec_offset, 1);
+    CheckBroken(rec_offset + 16, 1);
+  }
+}
+
+TEST_F(CacheDBMTest, ScanResistance) {
+  const std::vector<tkrzw::CacheDBM::EvictionPolicy> policies = {
+    tkrzw::CacheDBM::EVICT_S3FIFO, tkrzw::CacheDBM::EVICT_WTINYLFU};
+  for (const auto policy : policies) {
+    tkrzw::CacheDBM dbm(4096, -1, policy);
+    for (int32_t round = 0; round < 4; round++) {
+      for (int32_t i = 0; i < 512; i++) {
+        const std::string key = tkrzw::SPrintF("hot-%d", i);
+        if (!dbm.Get(key).IsOK()) {
+          EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(key, key));
+        }
+      }
+    }
+    for (int32_t i = 0; i < 16384; i++) {
+      const std::string key = tkrzw::SPrintF("scan-%d", i);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(key, key));
+    }
+    int32_t num_hits = 0;
+    for (int32_t i = 0; i < 512; i++) {
+      const std::string key = tkrzw::SPrintF("hot-%d", i);
+      if (dbm.Get(key).IsOK()) {
+        num_hits++;
+      }
+    }
+    EXPECT_GT(num_hits, 256) << tkrzw::CacheDBM::GetEvictionPolicyName(policy);
+  }
+}
+
+TEST_F(CacheDBMTest, SharedHits) {
+  const std::vector<tkrzw::CacheDBM::EvictionPolicy> policies = {
+    tkrzw::CacheDBM::EVICT_CLOCK, tkrzw::CacheDBM::EVICT_S3FIFO};
+  for (const auto policy : policies) {
+    tkrzw::CacheDBM dbm(2048, -1, policy);
+    for (int32_t i = 0; i < 256; i++) {
+      const std::string key = tkrzw::SPrintF("hot-%d", i);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(key, key));
+    }
+    constexpr int32_t num_threads = 8;
+    std::atomic_int32_t num_hits(0);
+    auto reader = [&](int32_t id) {
+      for (int32_t i = 0; i < 20000; i++) {
+        const std::string key = tkrzw::SPrintF("hot-%d", (i * 7 + id) % 256);
+        std::string value;
+        const tkrzw::Status status = dbm.Get(key, &value);
+        if (status == tkrzw::Status::SUCCESS) {
+          EXPECT_EQ(key, value);
+          num_hits++;
+        } else {
+          EXPECT_EQ(tkrzw::Status::NOT_FOUND_ERROR, status);
+        }
+      }
+    };
+    auto writer = [&]() {
+      for (int32_t i = 0; i < 20000; i++) {
+        const std::string key = tkrzw::SPrintF("cold-%d", i);
+        EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(key, key));
+      }
+    };
+    std::vector<std::thread> threads;
+    for (int32_t i = 0; i < num_threads; i++) {
+      threads.emplace_back(std::thread(reader, i));
+    }
+    threads.emplace_back(std::thread(writer));
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    EXPECT_GT(num_hits.load(), 0);
+    EXPECT_LT(dbm.CountSimple(), 4096);
+  }
+}
+
 // END OF FILE
@@ -313,6 +313,135 @@ Status ImportDBMRecordsFromFlatRecords(DBM* dbm, File* file) {
   return Status(Status::SUCCESS);
 }
 
+Status ImportFlatRecordsInParallel(
+    File* file, int32_t num_threads, const std::function<void(int64_t)>& prepare,
+    const std::function<int32_t(uint64_t)>& assign,
+    const std::function<void(std::string_view, std::string_view, uint64_t)>& insert) {
+  assert(file != nullptr && num_threads > 0);
+  constexpr int64_t batch_num_records = 1LL << 16;
+  constexpr int64_t batch_data_size = 1LL << 26;
+  constexpr int64_t min_thread_data_size = 1LL << 22;
+  num_threads = std::max<int64_t>(
+      std::min<int64_t>(num_threads, file->GetSizeSimple() / min_thread_data_size), 1);
+  struct Entry final {
+    int64_t offset;
+    int32_t key_size;
+    int32_t value_size;
+    uint64_t hash;
+  };
+  struct Batch final {
+    std::string data;
+    std::vector<Entry> entries;
+  };
+  FlatRecordReader reader(file);
+  Batch batches[2];
+  std::vector<std::vector<const Entry*>> parts(num_threads);
+  std::vector<std::thread> threads;
+  Status status(Status::SUCCESS);
+  bool eof = false;
+  for (int32_t batch_index = 0; true; batch_index ^= 1) {
+    Batch* batch = batches + batch_index;
+    batch->data.clear();
+    batch->entries.clear();
+    while (!eof && static_cast<int64_t>(batch->entries.size()) < batch_num_records &&
+           static_cast<int64_t>(batch->data.size()) < batch_data_size) {
+      std::string_view key;
+      Status read_status = reader.Read(&key);
+      if (read_status != Status::SUCCESS) {
+        if (read_status != Status::NOT_FOUND_ERROR) {
+          status |= read_status;
+        }
+        eof = true;
+        break;
+      }
+      Entry entry;
+      entry.offset = batch->data.size();
+      entry.key_size = key.size();
+      entry.hash = PrimaryHash(key, UINT64MAX);
+      batch->data.append(key);
+      std::string_view value;
+      read_status = reader.Read(&value);
+      if (read_status != Status::SUCCESS) {
+        if (read_status != Status::NOT_FOUND_ERROR) {
+          status |= read_status;
+        } else {
+          status |= Status(Status::BROKEN_DATA_ERROR, "odd number of records");
+        }
+        eof = true;
+        break;
+      }
+      entry.value_size = value.size();
+      batch->data.append(value);
+      batch->entries.emplace_back(entry);
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    threads.clear();
+    if (status != Status::SUCCESS || batch->entries.empty()) {
+      break;
+    }
+    prepare(batch->entries.size());
+    if (num_threads == 1) {
+      for (const auto& entry : batch->entries) {
+        const std::string_view key(batch->data.data() + entry.offset, entry.key_size);
+        const std::string_view value(key.data() + key.size(), entry.value_size);
+        insert(key, value, entry.hash);
+      }
+      continue;
+    }
+    for (auto& part : parts) {
+      part.clear();
+    }
+    for (const auto& entry : batch->entries) {
+      parts[assign(entry.hash) % num_threads].emplace_back(&entry);
+    }
+    auto task = [&](int32_t thread_index, const Batch* batch) {
+      for (const Entry* entry : parts[thread_index]) {
+        const std::string_view key(batch->data.data() + entry->offset, entry->key_size);
+        const std::string_view value(key.data() + key.size(), entry->value_size);
+        insert(key, value, entry->hash);
+      }
+    };
+    for (int32_t i = 0; i < num_threads; i++) {
+      threads.emplace_back(task, i, batch);
+    }
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return status;
+}
+
+Status RewriteDBMFile(
+    File* file, const std::string& path, int32_t options,
+    const std::function<Status(File*)>& write, bool synchronize, bool hard) {
+  assert(file != nullptr);
+  const std::string tmp_path = path + ".tmp";
+  auto tmp_file = file->MakeFile();
+  Status status = tmp_file->Open(tmp_path, true, File::OPEN_TRUNCATE);
+  if (status != Status::SUCCESS) {
+    return status;
+  }
+  status |= write(tmp_file.get());
+  if (synchronize) {
+    status |= tmp_file->Synchronize(hard);
+  }
+  status |= tmp_file->Close();
+  if (status != Status::SUCCESS) {
+    RemoveFile(tmp_path);
+    return status;
+  }
+  status = RenameFile(tmp_path, path);
+  if (status != Status::SUCCESS) {
+    RemoveFile(tmp_path);
+    return status;
+  }
+  status |= file->Close();
+  status |= file->Open(path, true, options);
+  return status;
+}
+
 Status ExportDBMKeysToFlatRecords(DBM* dbm, File* file) {
   assert(dbm != nullptr && file != nullptr);
   Status status = file->Truncate(0);
@@ -14,8 +14,10 @@
 #ifndef _TKRZW_DBM_COMMON_IMPL_H
 #define _TKRZW_DBM_COMMON_IMPL_H
 
+#include <functional>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include <cinttypes>
 #include <cstdarg>
@@ -129,6 +131,78 @@ Status ExportDBMRecordsToFlatRecords(DBM* dbm, File* file);
  */
 Status ImportDBMRecordsFromFlatRecords(DBM* dbm, File* file);
 
+/**
+ * Imports records from flat records by multiple threads.
+ * @param file The file object to read records from.
+ * @param num_threads The number of threads to insert records.
+ * @param prepare A function called before each batch of records is inserted, with the number of
+ * records in the batch.
+ * @param assign A function to get the index of the thread to insert a record, from the hash
+ * value of the key.  It must return a value less than num_threads.
+ * @param insert A function to insert a record, with the hash value of the key.
+ * @return The result status.
+ * @details The calling thread reads the next batch of records while the records of the
+ * current batch are inserted by the other threads.  Records of the same key are inserted in the
+ * order of the file, by the same thread.  The hash value is PrimaryHash(key, UINT64MAX).  The
+ * number of threads is reduced so that each thread takes 4MiB of the file at least.  If only
+ * one thread remains, the calling thread inserts the records without starting other threads.
+ */
+Status ImportFlatRecordsInParallel(
+    File* file, int32_t num_threads, const std::function<void(int64_t)>& prepare,
+    const std::function<int32_t(uint64_t)>& assign,
+    const std::function<void(std::string_view, std::string_view, uint64_t)>& insert);
+
+/**
+ * Rewrites a database file by writing a temporary file and renaming it.
+ * @param file The file object of the database, which is opened.
+ * @param path The path of the database file.
+ * @param options The options to reopen the database file.
+ * @param write A function to write the content into the temporary file.
+ * @param synchronize If true, the temporary file is synchronized before renaming.
+ * @param hard True to do physical synchronization with the hardware.
+ * @return The result status.
+ * @details The temporary file has the path of the database file with the suffix ".tmp".  The
+ * file object is reopened with the new file.  As the old file is not truncated, a memory
+ * mapping of it is still valid.
+ */
+Status RewriteDBMFile(
+    File* file, const std::string& path, int32_t options,
+    const std::function<Status(File*)>& write, bool synchronize, bool hard);
+
+/**
+ * The flag of a link in a snapshot file, which marks a relative offset instead of an address.
+ */
+constexpr uint64_t SNAPSHOT_LINK_FLAG = 1ULL << 63;
+
+/**
+ * Makes a link between records to be written in a snapshot file.
+ * @param owner_offset The offset of the record which has the link.
+ * @param target_offset The offset of the linked record.
+ * @return The value of the link, which is resolved by ResolveSnapshotLink.
+ */
+inline int64_t MakeSnapshotLink(int64_t owner_offset, int64_t target_offset) {
+  return static_cast<int64_t>(
+      SNAPSHOT_LINK_FLAG | (static_cast<uint64_t>(target_offset - owner_offset) &
+                            ~SNAPSHOT_LINK_FLAG));
+}
+
+/**
+ * Resolves a link stored in a record.
+ * @param owner The address of the record which has the link.
+ * @param link The stored link, which is an address or a value made by MakeSnapshotLink.
+ * @return The address of the linked record.
+ * @details As user-space addresses don't have the top bit set, records of a mapped snapshot
+ * keep their links as relative offsets, which are resolved on each access without writing to
+ * the mapped pages.
+ */
+inline char* ResolveSnapshotLink(const char* owner, char* link) {
+  const uint64_t value = reinterpret_cast<uintptr_t>(link);
+  if (!(value & SNAPSHOT_LINK_FLAG)) {
+    return link;
+  }
+  return const_cast<char*>(owner) + (static_cast<int64_t>(value << 1) >> 1);
+}
+
 /**
  * Exports the keys of all records of a database to a flat record file.
  * @param dbm The DBM object of the database.
@@ -109,4 +109,54 @@ TEST(DBMCommonImplTest, GetHashBucketSize) {
   EXPECT_EQ(68719476767ULL, tkrzw::GetHashBucketSize(68719476736ULL));
 }
 
+TEST(DBMCommonImplTest, ImportFlatRecordsInParallel) {
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string file_path = tmp_dir.MakeUniquePath();
+  constexpr int32_t num_threads = 4;
+  for (const int32_t num_records : {100, 200000}) {
+    tkrzw::PositionalParallelFile file;
+    EXPECT_EQ(tkrzw::Status::SUCCESS, file.Open(file_path, true, tkrzw::File::OPEN_TRUNCATE));
+    tkrzw::FlatRecord flat_rec(&file);
+    const std::string value(64, 'v');
+    for (int32_t i = 0; i < num_records; i++) {
+      EXPECT_EQ(tkrzw::Status::SUCCESS, flat_rec.Write(tkrzw::ToString(i)));
+      EXPECT_EQ(tkrzw::Status::SUCCESS, flat_rec.Write(value));
+    }
+    std::mutex mutex;
+    std::map<int32_t, std::set<std::thread::id>> part_threads;
+    int64_t num_prepared = 0;
+    int64_t num_inserted = 0;
+    const auto status = tkrzw::ImportFlatRecordsInParallel(
+        &file, num_threads,
+        [&](int64_t batch_size) {
+          num_prepared += batch_size;
+        },
+        [&](uint64_t hash) {
+          return hash % num_threads;
+        },
+        [&](std::string_view key, std::string_view value, uint64_t hash) {
+          EXPECT_EQ(64, value.size());
+          EXPECT_EQ(tkrzw::PrimaryHash(key, tkrzw::UINT64MAX), hash);
+          std::lock_guard<std::mutex> lock(mutex);
+          part_threads[hash % num_threads].emplace(std::this_thread::get_id());
+          num_inserted++;
+        });
+    EXPECT_EQ(tkrzw::Status::SUCCESS, status);
+    EXPECT_EQ(num_records, num_prepared);
+    EXPECT_EQ(num_records, num_inserted);
+    std::set<std::thread::id> all_threads;
+    for (const auto& part : part_threads) {
+      all_threads.insert(part.second.begin(), part.second.end());
+    }
+    if (file.GetSizeSimple() < (1LL << 22) * 2) {
+      EXPECT_EQ(1, all_threads.size());
+      EXPECT_EQ(std::this_thread::get_id(), *all_threads.begin());
+    } else {
+      EXPECT_GT(all_threads.size(), 1);
+      EXPECT_EQ(0, all_threads.count(std::this_thread::get_id()));
+    }
+    EXPECT_EQ(tkrzw::Status::SUCCESS, file.Close());
+  }
+}
+
 // END OF FILE
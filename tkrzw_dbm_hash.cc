@@ -54,6 +54,7 @@ constexpr int32_t MAX_ALIGN_POW = 16;
 constexpr int64_t MAX_NUM_BUCKETS = 1099511627689LL;
 constexpr int32_t REBUILD_NONBLOCKING_MAX_TRIES = 3;
 constexpr int64_t REBUILD_BLOCKING_ALLOWANCE = 65536;
+constexpr double APPEND_BUFFER_MAX_DELAY = 1.0;
 
 enum StaticFlag : uint8_t {
   STATIC_FLAG_NONE = 0,
@@ -122,6 +123,7 @@ class HashDBMImpl final {
       std::string_view key, int64_t bucket_index, DBM::RecordProcessor* proc, bool writable);
   Status GetBucketValue(int64_t bucket_index, int64_t* value);
   Status SetBucketValue(int64_t bucket_index, int64_t value);
+  Status ReleaseFreeBlock(int64_t offset, int32_t size, int32_t key_size);
   Status ReadNextBucketRecords(HashDBMIteratorImpl* iter);
 
   bool open_;
@@ -138,6 +140,7 @@ class HashDBMImpl final {
   std::atomic_int64_t num_records_;
   std::atomic_int64_t eff_data_size_;
   int64_t file_size_;
+  int64_t synced_file_size_;
   int64_t mod_time_;
   uint32_t db_type_;
   std::string opaque_;
@@ -145,6 +148,8 @@ class HashDBMImpl final {
   IteratorList iterators_;
   FreeBlockPool fbp_;
   bool lock_mem_buckets_;
+  bool punch_free_blocks_;
+  int64_t append_buffer_size_;
   std::unique_ptr<File> file_;
   std::shared_timed_mutex mutex_;
   HashMutex record_mutex_;
@@ -175,10 +180,11 @@ HashDBMImpl::HashDBMImpl(std::unique_ptr<File> file)
       offset_width_(HashDBM::DEFAULT_OFFSET_WIDTH), align_pow_(HashDBM::DEFAULT_ALIGN_POW),
       closure_flags_(CLOSURE_FLAG_NONE),
       num_buckets_(HashDBM::DEFAULT_NUM_BUCKETS),
-      num_records_(0), eff_data_size_(0), file_size_(0), mod_time_(0),
+      num_records_(0), eff_data_size_(0), file_size_(0), synced_file_size_(-1), mod_time_(0),
       db_type_(0), opaque_(),
       record_base_(0), iterators_(),
       fbp_(HashDBM::DEFAULT_FBP_CAPACITY), lock_mem_buckets_(false),
+      punch_free_blocks_(false), append_buffer_size_(0),
       file_(std::move(file)),
       mutex_(), record_mutex_(RECORD_MUTEX_NUM_SLOTS, 1, PrimaryHash),
       file_mutex_() {}
@@ -218,6 +224,8 @@ Status HashDBMImpl::Open(const std::string& path, bool writable,
     fbp_.SetCapacity(tuning_params.fbp_capacity);
   }
   lock_mem_buckets_ = tuning_params.lock_mem_buckets;
+  punch_free_blocks_ = tuning_params.punch_free_blocks;
+  append_buffer_size_ = std::max<int64_t>(tuning_params.append_buffer_size, 0);
   Status status = file_->Open(path, writable, options);
   if (status != Status::SUCCESS) {
     return status;
@@ -277,6 +285,8 @@ Status HashDBMImpl::ProcessEach(DBM::RecordProcessor* proc, bool writable) {
   }
   if (!writable && (static_flags_ & STATIC_FLAG_UPDATE_IN_PLACE)) {
     ScopedHashLock record_lock(record_mutex_, writable);
+    ScopedFileAdvice advice(file_.get(), record_base_, -1,
+                            File::ADVICE_SEQUENTIAL, File::ADVICE_RANDOM);
     proc->ProcessEmpty(DBM::RecordProcessor::NOOP);
     const int64_t end_offset = file_->GetSizeSimple();
     int64_t offset = record_base_;
@@ -312,6 +322,8 @@ Status HashDBMImpl::ProcessEach(DBM::RecordProcessor* proc, bool writable) {
     return Status(Status::SUCCESS);
   }
   ScopedHashLock record_lock(record_mutex_, writable);
+  ScopedFileAdvice advice(file_.get(), 0, record_base_,
+                          File::ADVICE_SEQUENTIAL, File::ADVICE_RANDOM);
   proc->ProcessEmpty(DBM::RecordProcessor::NOOP);
   for (int64_t bucket_index = 0; bucket_index < num_buckets_; bucket_index++) {
     int64_t current_offset = 0;
@@ -464,6 +476,12 @@ Status HashDBMImpl::Rebuild(
     ScopedHashLock record_lock(record_mutex_, true);
     static_flags_ &= ~STATIC_FLAG_UPDATE_IN_PLACE;
     static_flags_ |= STATIC_FLAG_UPDATE_APPENDING;
+    // Records are imported from the file on the storage so they are not buffered.
+    status = file_->SetAppendBuffer(0, 0);
+    if (status != Status::SUCCESS) {
+      CleanUp();
+      return status;
+    }
     end_offset = file_->GetSizeSimple();
   }
   if (in_place) {
@@ -531,6 +549,8 @@ Status HashDBMImpl::Rebuild(
       fbp_.SetCapacity(tuning_params.fbp_capacity);
     }
     lock_mem_buckets_ = tuning_params.lock_mem_buckets;
+    punch_free_blocks_ = tuning_params.punch_free_blocks;
+    append_buffer_size_ = std::max<int64_t>(tuning_params.append_buffer_size, 0);
     status |= OpenImpl(true);
     db_type_ = db_type;
     opaque_ = opaque;
@@ -578,7 +598,13 @@ Status HashDBMImpl::Synchronize(bool hard, DBM::FileProcessor* proc) {
   file_size_ = file_->GetSizeSimple();
   mod_time_ = GetWallTime() * 1000000;
   Status status = SaveMetadata(true);
-  status |= file_->Synchronize(hard);
+  if (hard && file_size_ == synced_file_size_) {
+    // The physical size has already been trimmed, so only modified regions are written back.
+    status |= file_->SynchronizeRange(0, -1);
+  } else {
+    status |= file_->Synchronize(hard);
+    synced_file_size_ = file_size_;
+  }
   if (proc != nullptr) {
     proc->Process(path_);
   }
@@ -801,6 +827,7 @@ Status HashDBMImpl::ImportFromFileForward(
     }
     end_offset = last_sync_size;
   }
+  file->Advise(record_base, -1, File::ADVICE_SEQUENTIAL);
   Status import_status(Status::SUCCESS);
   class Importer final : public DBM::RecordProcessor {
    public:
@@ -890,6 +917,7 @@ Status HashDBMImpl::ImportFromFileBackward(
     CleanUp();
     return status;
   }
+  file->Advise(record_base, -1, File::ADVICE_SEQUENTIAL);
   status = HashRecord::ExtractOffsets(
       file.get(), offset_file.get(), record_base, offset_width, align_pow,
       skip_broken_records, end_offset);
@@ -897,6 +925,7 @@ Status HashDBMImpl::ImportFromFileBackward(
     CleanUp();
     return status;
   }
+  file->Advise(record_base, -1, File::ADVICE_RANDOM);
   const int64_t num_offsets = offset_file->GetSizeSimple() / offset_width_;
   const int64_t dead_num_buckets = std::min(num_offsets, num_buckets_);
   HashDBM::TuningParameters dead_tuning_params;
@@ -1029,8 +1058,19 @@ Status HashDBMImpl::OpenImpl(bool writable) {
         return status;
       }
     }
+    // Records are buffered only in the appending mode where the file grows sequentially.
+    status = file_->SetAppendBuffer(
+        (static_flags_ & STATIC_FLAG_UPDATE_APPENDING) ? append_buffer_size_ : 0,
+        APPEND_BUFFER_MAX_DELAY);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
   }
+  // Lookups access the buckets and the records randomly.  Failures of hints are ignored.
+  file_->Advise(0, -1, File::ADVICE_RANDOM);
+  file_->Advise(0, record_base_, File::ADVICE_HUGEPAGE);
   record_mutex_.Rehash(num_buckets_);
+  synced_file_size_ = -1;
   open_ = true;
   writable_ = writable;
   healthy_ = healthy;
@@ -1058,12 +1098,15 @@ Status HashDBMImpl::CloseImpl() {
   num_records_.store(0);
   eff_data_size_.store(0);
   file_size_ = 0;
+  synced_file_size_ = -1;
   mod_time_ = 0;
   db_type_ = 0;
   opaque_.clear();
   record_base_ = 0;
   fbp_.Clear();
   lock_mem_buckets_ = false;
+  punch_free_blocks_ = false;
+  append_buffer_size_ = 0;
   return status;
 }
 
@@ -1279,6 +1322,10 @@ Status HashDBMImpl::ProcessImpl(
             if (status != Status::SUCCESS) {
               return status;
             }
+            status = ReleaseFreeBlock(current_offset, old_rec_size, key.size());
+            if (status != Status::SUCCESS) {
+              return status;
+            }
             fbp_.InsertFreeBlock(current_offset, old_rec_size);
           } else {
             status = rec.Write(current_offset, nullptr);
@@ -1334,6 +1381,10 @@ Status HashDBMImpl::ProcessImpl(
             if (status != Status::SUCCESS) {
               return status;
             }
+            status = ReleaseFreeBlock(current_offset, old_rec_size, 0);
+            if (status != Status::SUCCESS) {
+              return status;
+            }
             fbp_.InsertFreeBlock(current_offset, old_rec_size);
           }
         }
@@ -1409,6 +1460,31 @@ Status HashDBMImpl::SetBucketValue(int64_t bucket_index, int64_t value) {
   return file_->Write(offset, buf, offset_width_);
 }
 
+Status HashDBMImpl::ReleaseFreeBlock(int64_t offset, int32_t size, int32_t key_size) {
+  if (!punch_free_blocks_) {
+    return Status(Status::SUCCESS);
+  }
+  // The record header, the key of a removal record, and the padding prefix are kept and only
+  // the zero-filled body of the padding is released, in whole pages to avoid rewriting partial
+  // blocks.
+  const int64_t prefix_size = sizeof(uint8_t) + offset_width_ + SizeVarNum(key_size) +
+      SizeVarNum(0) + sizeof(uint8_t) + key_size + sizeof(uint32_t) + sizeof(uint8_t);
+  int64_t start = offset + prefix_size;
+  const int64_t start_diff = start % PAGE_SIZE;
+  if (start_diff > 0) {
+    start += PAGE_SIZE - start_diff;
+  }
+  const int64_t end = offset + size - (offset + size) % PAGE_SIZE;
+  if (end <= start) {
+    return Status(Status::SUCCESS);
+  }
+  const Status status = file_->PunchHole(start, end - start);
+  if (status == Status::NOT_IMPLEMENTED_ERROR) {
+    return Status(Status::SUCCESS);
+  }
+  return status;
+}
+
 Status HashDBMImpl::ReadNextBucketRecords(HashDBMIteratorImpl* iter) {
   while (true) {
     int64_t bucket_index = iter->bucket_index_.load();
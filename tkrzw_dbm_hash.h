@@ -216,6 +216,28 @@ class HashDBM final : public DBM {
      * saved as a metadata of the database, it should be set each time when opening the database.
      */
     bool lock_mem_buckets = false;
+    /**
+     * Whether to release the storage of free blocks.
+     * @details If true and the underlying file class supports punching holes, the padding of a
+     * block freed by removing or moving a record is released in whole pages, so that removing
+     * large records returns disk space to the file system.  It costs a system call for each
+     * freed block and the released pages are allocated again when the block is reused.  So, it
+     * doesn't suit the OPEN_PREALLOCATE option or workloads which overwrite records frequently.
+     * As this parameter is not saved as a metadata of the database, it should be set each time
+     * when opening the database.
+     */
+    bool punch_free_blocks = false;
+    /**
+     * The size of the buffer to coalesce appended records.
+     * @details If it is positive and the update mode is appending, new records are kept in the
+     * buffer and written into the file at once when the buffer is full, when the file is
+     * accessed after the buffered ones have waited for a second, or when the database is
+     * synchronized.  A background thread writes them shortly after the delay if the database is
+     * idle.  Only the positional file classes support buffering.  Buffered records are lost if
+     * the process crashes.  As this parameter is not saved as a metadata of the
+     * database, it should be set each time when opening the database.
+     */
+    int64_t append_buffer_size = 0;
 
     /**
      * Constructor
@@ -202,9 +202,7 @@ void HashRecord::SetData(OperationType type, int32_t ideal_whole_size,
 
 Status HashRecord::Write(int64_t offset, int64_t* new_offset) const {
   char stack[WRITE_BUFFER_SIZE];
-  char* write_buf =
-      whole_size_ > static_cast<int32_t>(sizeof(stack)) ? new char[whole_size_] : stack;
-  char* wp = write_buf;
+  char* wp = stack;
   switch (type_) {
     case OP_SET:
       *(wp++) = RECORD_MAGIC_SET;
@@ -225,6 +223,33 @@ Status HashRecord::Write(int64_t offset, int64_t* new_offset) const {
   } else {
     *(wp++) = padding_size_;
   }
+  if (whole_size_ > static_cast<int32_t>(sizeof(stack))) {
+    // A large record is written as pieces to avoid copying the key and the value.
+    std::string padding(padding_size_, 0);
+    if (padding_size_ > 0) {
+      char* pp = padding.data();
+      if (padding_size_ >= PADDING_SIZE_MAGIC) {
+        WriteFixNum(pp, padding_size_, 4);
+        pp += 4;
+      }
+      *pp = PADDING_TOP_MAGIC;
+    }
+    const std::string_view pieces[] = {
+      std::string_view(stack, wp - stack), std::string_view(key_ptr_, key_size_),
+      std::string_view(value_ptr_, value_size_), padding};
+    constexpr size_t num_pieces = sizeof(pieces) / sizeof(*pieces);
+    if (offset < 0) {
+      return file_->AppendV(pieces, num_pieces, new_offset);
+    }
+    File::WriteExtent extents[num_pieces];
+    for (size_t i = 0; i < num_pieces; i++) {
+      extents[i].off = offset;
+      extents[i].buf = pieces[i].data();
+      extents[i].size = pieces[i].size();
+      offset += pieces[i].size();
+    }
+    return file_->WriteV(extents, num_pieces);
+  }
   std::memcpy(wp, key_ptr_, key_size_);
   wp += key_size_;
   std::memcpy(wp, value_ptr_, value_size_);
@@ -237,16 +262,10 @@ Status HashRecord::Write(int64_t offset, int64_t* new_offset) const {
     }
     *wp = PADDING_TOP_MAGIC;
   }
-  Status status(Status::SUCCESS);
   if (offset < 0) {
-    status = file_->Append(write_buf, whole_size_, new_offset);
-  } else {
-    status = file_->Write(offset, write_buf, whole_size_);
-  }
-  if (write_buf != stack) {
-    delete[] write_buf;
+    return file_->Append(stack, whole_size_, new_offset);
   }
-  return status;
+  return file_->Write(offset, stack, whole_size_);
 }
 
 Status HashRecord::WriteChildOffset(int64_t offset, int64_t child_offset) {
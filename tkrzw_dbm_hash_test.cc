@@ -1060,4 +1060,145 @@ TEST_F(HashDBMTest, Restore) {
   HashDBMRestoreTest(&dbm);
 }
 
+TEST_F(HashDBMTest, SynchronizeRange) {
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string file_path = tmp_dir.MakeUniquePath();
+  const std::string copy_path = tmp_dir.MakeUniquePath();
+  for (const auto& update_mode :
+           {tkrzw::HashDBM::UPDATE_IN_PLACE, tkrzw::HashDBM::UPDATE_APPENDING}) {
+    tkrzw::HashDBM dbm(std::make_unique<tkrzw::PositionalParallelFile>());
+    tkrzw::HashDBM::TuningParameters tuning_params;
+    tuning_params.update_mode = update_mode;
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.OpenAdvanced(
+        file_path, true, tkrzw::File::OPEN_TRUNCATE, tuning_params));
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set("one", "first"));
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Synchronize(true));
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set("one", "FIRST"));
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Synchronize(true));
+    tkrzw::Status copy_status(tkrzw::Status::UNKNOWN_ERROR);
+    tkrzw::DBM::FileProcessorCopyFile copier(&copy_status, copy_path);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Synchronize(true, &copier));
+    EXPECT_EQ(tkrzw::Status::SUCCESS, copy_status);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+    tkrzw::HashDBM copy_dbm;
+    EXPECT_EQ(tkrzw::Status::SUCCESS, copy_dbm.Open(copy_path, false));
+    EXPECT_TRUE(copy_dbm.IsHealthy());
+    EXPECT_EQ(tkrzw::GetFileSize(copy_path), copy_dbm.GetFileSizeSimple());
+    EXPECT_EQ("FIRST", copy_dbm.GetSimple("one"));
+    EXPECT_EQ(tkrzw::Status::SUCCESS, copy_dbm.Close());
+  }
+}
+
+TEST_F(HashDBMTest, FreeBlockRelease) {
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string file_path = tmp_dir.MakeUniquePath();
+  const std::string restored_path = tmp_dir.MakeUniquePath();
+  std::vector<std::unique_ptr<tkrzw::File>> files;
+  files.emplace_back(std::make_unique<tkrzw::PositionalParallelFile>());
+  files.emplace_back(std::make_unique<tkrzw::MemoryMapParallelFile>());
+  for (auto& file : files) {
+    tkrzw::HashDBM dbm(std::move(file));
+    tkrzw::HashDBM::TuningParameters tuning_params;
+    tuning_params.punch_free_blocks = true;
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.OpenAdvanced(
+        file_path, true, tkrzw::File::OPEN_TRUNCATE, tuning_params));
+    for (int32_t i = 0; i < 10; i++) {
+      const std::string key = tkrzw::ToString(i);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(key, std::string(20000, 'a' + i)));
+    }
+    for (int32_t i = 0; i < 10; i += 2) {
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Remove(tkrzw::ToString(i)));
+    }
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set("1", std::string(30000, 'x')));
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set("small", std::string(10000, 'y')));
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Synchronize(false));
+    EXPECT_EQ(6, dbm.CountSimple());
+    for (int32_t i = 0; i < 10; i++) {
+      const std::string key = tkrzw::ToString(i);
+      if (i == 1) {
+        EXPECT_EQ(std::string(30000, 'x'), dbm.GetSimple(key));
+      } else if (i % 2 == 0) {
+        EXPECT_EQ("*", dbm.GetSimple(key, "*"));
+      } else {
+        EXPECT_EQ(std::string(20000, 'a' + i), dbm.GetSimple(key));
+      }
+    }
+    EXPECT_EQ(std::string(10000, 'y'), dbm.GetSimple("small"));
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+    EXPECT_EQ(tkrzw::Status::SUCCESS,
+              tkrzw::HashDBM::RestoreDatabase(file_path, restored_path, -1));
+    tkrzw::HashDBM restored_dbm;
+    EXPECT_EQ(tkrzw::Status::SUCCESS, restored_dbm.Open(restored_path, false));
+    EXPECT_TRUE(restored_dbm.IsHealthy());
+    EXPECT_EQ(6, restored_dbm.CountSimple());
+    EXPECT_EQ(std::string(30000, 'x'), restored_dbm.GetSimple("1"));
+    EXPECT_EQ(std::string(10000, 'y'), restored_dbm.GetSimple("small"));
+    EXPECT_EQ(tkrzw::Status::SUCCESS, restored_dbm.Close());
+    EXPECT_EQ(tkrzw::Status::SUCCESS, tkrzw::RemoveFile(restored_path));
+  }
+}
+
+TEST_F(HashDBMTest, AppendBuffer) {
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string file_path = tmp_dir.MakeUniquePath();
+  std::vector<std::unique_ptr<tkrzw::File>> files;
+  files.emplace_back(std::make_unique<tkrzw::PositionalParallelFile>());
+  files.emplace_back(std::make_unique<tkrzw::PositionalAtomicFile>());
+  for (auto& file : files) {
+    tkrzw::HashDBM dbm(std::move(file));
+    tkrzw::HashDBM::TuningParameters tuning_params;
+    tuning_params.update_mode = tkrzw::HashDBM::UPDATE_APPENDING;
+    tuning_params.num_buckets = 100;
+    tuning_params.append_buffer_size = 4096;
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.OpenAdvanced(
+        file_path, true, tkrzw::File::OPEN_TRUNCATE, tuning_params));
+    for (int32_t i = 0; i < 1000; i++) {
+      const std::string key = tkrzw::ToString(i);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(key, key + ":" + key));
+      EXPECT_EQ(key + ":" + key, dbm.GetSimple(key));
+    }
+    for (int32_t i = 0; i < 1000; i += 3) {
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Remove(tkrzw::ToString(i)));
+    }
+    for (int32_t i = 1; i < 1000; i += 3) {
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Append(tkrzw::ToString(i), "x"));
+    }
+    auto check_records = [](tkrzw::HashDBM* dbm) {
+      EXPECT_EQ(666, dbm->CountSimple());
+      for (int32_t i = 0; i < 1000; i++) {
+        const std::string key = tkrzw::ToString(i);
+        if (i % 3 == 0) {
+          EXPECT_EQ("*", dbm->GetSimple(key, "*"));
+        } else if (i % 3 == 1) {
+          EXPECT_EQ(key + ":" + key + "x", dbm->GetSimple(key));
+        } else {
+          EXPECT_EQ(key + ":" + key, dbm->GetSimple(key));
+        }
+      }
+    };
+    check_records(&dbm);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Synchronize(false));
+    EXPECT_EQ(dbm.GetFileSizeSimple(), tkrzw::GetFileSize(file_path));
+    check_records(&dbm);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.RebuildAdvanced(tuning_params));
+    check_records(&dbm);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set("new", "record"));
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Open(file_path, false));
+    EXPECT_TRUE(dbm.IsHealthy());
+    EXPECT_EQ("record", dbm.GetSimple("new"));
+    EXPECT_EQ(667, dbm.CountSimple());
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+  }
+}
+
+TEST_F(HashDBMTest, Async) {
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string file_path = tmp_dir.MakeUniquePath();
+  tkrzw::HashDBM dbm(std::make_unique<tkrzw::MemoryMapParallelFile>());
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Open(file_path, true));
+  AsyncTest(&dbm);
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+}
+
 // END OF FILE
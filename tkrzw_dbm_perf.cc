@@ -30,11 +30,13 @@ static void PrintUsageAndDie() {
   P("    : Checks consistency with various operations.\n");
   P("  %s index [options]\n", progname);
   P("    : Checks performance of on-memory indexing.\n");
+  P("  %s cache [options]\n", progname);
+  P("    : Checks hit ratios of eviction policies of the cache database.\n");
   P("\n");
   P("\n");
   P("Common options:\n");
   P("  --dbm impl : The name of a DBM implementation:"
-    " auto, hash, tree, skip, tiny, baby, cache, stdhash, stdtree, poly, shard."
+    " auto, hash, tree, skip, tiny, baby, radix, cache, stdhash, stdtree, poly, shard."
     " (default: auto)\n");
   P("  --iter num : The number of iterations. (default: 10000)\n");
   P("  --size num : The size of each record value. (default: 8)\n");
@@ -42,7 +44,7 @@ static void PrintUsageAndDie() {
   P("  --verbose : Prints verbose reports.\n");
   P("  --path path : The path of the file to write or read.\n");
   P("  --file impl : The name of a file implementation:"
-    " mmap-para, mmap-atom, pos-para, pos-atom. (default: mmap-para)\n");
+    " mmap-para, mmap-atom, pos-para, pos-atom, uring, direct. (default: mmap-para)\n");
   P("  --no_wait : Fails if the file is locked by another process.\n");
   P("  --no_lock : Omits file locking.\n");
   P("  --alloc_init num : The initial allocation size. (default: %lld)\n",
@@ -75,6 +77,15 @@ static void PrintUsageAndDie() {
   P("  --random_key : Uses random keys rather than sequential ones.\n");
   P("  --random_value : Uses random length values rather than fixed ones.\n");
   P("\n");
+  P("Options for the cache subcommand:\n");
+  P("  --keys num : The number of unique keys of point accesses. (default: 100000)\n");
+  P("  --eviction expr : The eviction policies to check: lru, clock, s3fifo, wtinylfu,"
+    " separated by commas. (default: lru,clock,s3fifo,wtinylfu)\n");
+  P("  --zipf num : The exponent of the Zipfian distribution of point accesses."
+    " (default: 0.99)\n");
+  P("  --scan num : The probability to start a scan instead of a point access. (default: 0)\n");
+  P("  --scan_len num : The number of records accessed by a scan. (default: 1000)\n");
+  P("\n");
   P("Options for HashDBM:\n");
   P("  --append : Uses the appending mode rather than the in-place mode.\n");
   P("  --offset_width num : The width to represent the offset of records. (default: %d)\n",
@@ -153,6 +164,8 @@ std::unique_ptr<DBM> MakeDBMOrDie(
       dbm_impl_mod = "tiny";
     } else if (ext == "tkmb") {
       dbm_impl_mod = "baby";
+    } else if (ext == "tkmr") {
+      dbm_impl_mod = "radix";
     } else if (ext == "tkmc") {
       dbm_impl_mod = "cache";
     } else if (ext == "tksh") {
@@ -185,6 +198,9 @@ std::unique_ptr<DBM> MakeDBMOrDie(
   } else if (dbm_impl_mod == "baby") {
     dbm = std::make_unique<BabyDBM>(
         MakeFileOrDie(file_impl, alloc_init_size, alloc_increment));
+  } else if (dbm_impl_mod == "radix") {
+    dbm = std::make_unique<RadixDBM>(
+        MakeFileOrDie(file_impl, alloc_init_size, alloc_increment));
   } else if (dbm_impl_mod == "cache") {
     dbm = std::make_unique<CacheDBM>(
         MakeFileOrDie(file_impl, alloc_init_size, alloc_increment), cap_rec_num, cap_mem_size);
@@ -278,7 +294,7 @@ bool SetUpDBM(DBM* dbm, bool writable, bool initialize, const std::string& file_
     }
   }
   if (typeid(*dbm) == typeid(TinyDBM) || typeid(*dbm) == typeid(BabyDBM) ||
-      typeid(*dbm) == typeid(CacheDBM) ||
+      typeid(*dbm) == typeid(RadixDBM) || typeid(*dbm) == typeid(CacheDBM) ||
       typeid(*dbm) == typeid(StdHashDBM) || typeid(*dbm) == typeid(StdTreeDBM)) {
     if (!file_path.empty()) {
       const Status status = dbm->Open(file_path, writable, open_options);
@@ -440,7 +456,8 @@ bool TearDownDBM(DBM* dbm, const std::string& file_path, bool is_verbose) {
       }
     }
   }
-  if (typeid(*dbm) == typeid(BabyDBM) || typeid(*dbm) == typeid(StdTreeDBM)) {
+  if (typeid(*dbm) == typeid(BabyDBM) || typeid(*dbm) == typeid(RadixDBM) ||
+      typeid(*dbm) == typeid(StdTreeDBM)) {
     if (!file_path.empty()) {
       const Status status = dbm->Close();
       if (status != Status::SUCCESS) {
@@ -1180,6 +1197,141 @@ static int32_t ProcessWicked(int32_t argc, const char** args) {
   return has_error ? 1 : 0;
 }
 
+// Processes the cache subcommand.
+static int32_t ProcessCache(int32_t argc, const char** args) {
+  const std::map<std::string, int32_t>& cmd_configs = {
+    {"", 0}, {"--iter", 1}, {"--size", 1}, {"--threads", 1},
+    {"--keys", 1}, {"--eviction", 1}, {"--zipf", 1}, {"--scan", 1}, {"--scan_len", 1},
+    {"--cap_rec_num", 1}, {"--cap_mem_size", 1},
+  };
+  std::map<std::string, std::vector<std::string>> cmd_args;
+  std::string cmd_error;
+  if (!ParseCommandArguments(argc, args, cmd_configs, &cmd_args, &cmd_error)) {
+    EPrint("Invalid command: ", cmd_error, "\n\n");
+    PrintUsageAndDie();
+  }
+  const int32_t num_iterations = GetIntegerArgument(cmd_args, "--iter", 0, 10000);
+  const int32_t value_size = GetIntegerArgument(cmd_args, "--size", 0, 8);
+  const int32_t num_threads = GetIntegerArgument(cmd_args, "--threads", 0, 1);
+  const int32_t num_keys = GetIntegerArgument(cmd_args, "--keys", 0, 100000);
+  const std::string evictions =
+      GetStringArgument(cmd_args, "--eviction", 0, "lru,clock,s3fifo,wtinylfu");
+  const double zipf_exponent = GetDoubleArgument(cmd_args, "--zipf", 0, 0.99);
+  const double scan_ratio = GetDoubleArgument(cmd_args, "--scan", 0, 0);
+  const int32_t scan_length = GetIntegerArgument(cmd_args, "--scan_len", 0, 1000);
+  const int64_t cap_rec_num = GetIntegerArgument(cmd_args, "--cap_rec_num", 0, 10000);
+  const int64_t cap_mem_size = GetIntegerArgument(cmd_args, "--cap_mem_size", 0, -1);
+  if (num_iterations < 1) {
+    Die("Invalid number of iterations");
+  }
+  if (value_size < 1) {
+    Die("Invalid size of a record");
+  }
+  if (num_threads < 1) {
+    Die("Invalid number of threads");
+  }
+  if (num_keys < 1) {
+    Die("Invalid number of keys");
+  }
+  std::vector<CacheDBM::EvictionPolicy> policies;
+  for (const auto& name : StrSplit(evictions, ",", true)) {
+    const CacheDBM::EvictionPolicy policy = CacheDBM::ParseEvictionPolicy(name);
+    if (policy == CacheDBM::EVICT_DEFAULT) {
+      Die("Unknown eviction policy: ", name);
+    }
+    policies.emplace_back(policy);
+  }
+  std::vector<double> zipf_cdf(num_keys);
+  double zipf_total = 0;
+  for (int32_t i = 0; i < num_keys; i++) {
+    zipf_total += 1.0 / std::pow(i + 1, zipf_exponent);
+    zipf_cdf[i] = zipf_total;
+  }
+  for (auto& zipf_value : zipf_cdf) {
+    zipf_value /= zipf_total;
+  }
+  bool has_error = false;
+  for (const auto policy : policies) {
+    CacheDBM dbm(cap_rec_num, cap_mem_size, policy);
+    std::atomic_int64_t num_hits(0);
+    std::atomic_int64_t num_accesses(0);
+    std::atomic_int64_t num_point_hits(0);
+    std::atomic_int64_t num_point_accesses(0);
+    std::atomic_int64_t scan_cursor(0);
+    std::atomic_bool task_error(false);
+    auto task = [&](int32_t id) {
+      std::mt19937 mt(id);
+      std::uniform_real_distribution<double> prob_dist(0.0, 1.0);
+      const std::string value(value_size, '0' + id % 10);
+      int64_t my_hits = 0;
+      int64_t my_accesses = 0;
+      int64_t my_point_hits = 0;
+      int64_t my_point_accesses = 0;
+      auto access = [&](const std::string& key) {
+        my_accesses++;
+        const Status status = dbm.Get(key);
+        if (status == Status::SUCCESS) {
+          my_hits++;
+          return true;
+        }
+        if (status != Status::NOT_FOUND_ERROR) {
+          EPrintL("Get failed: ", status);
+          task_error = true;
+        } else {
+          const Status status = dbm.Set(key, value);
+          if (status != Status::SUCCESS) {
+            EPrintL("Set failed: ", status);
+            task_error = true;
+          }
+        }
+        return false;
+      };
+      for (int32_t i = 0; i < num_iterations && !task_error.load(); i++) {
+        if (scan_ratio > 0 && prob_dist(mt) < scan_ratio) {
+          const int64_t scan_start = scan_cursor.fetch_add(scan_length);
+          for (int32_t j = 0; j < scan_length; j++) {
+            access(SPrintF("s%010lld", scan_start + j));
+          }
+        } else {
+          const int32_t rank = std::lower_bound(
+              zipf_cdf.begin(), zipf_cdf.end(), prob_dist(mt)) - zipf_cdf.begin();
+          my_point_accesses++;
+          if (access(SPrintF("%08d", std::min(rank, num_keys - 1)))) {
+            my_point_hits++;
+          }
+        }
+      }
+      num_hits += my_hits;
+      num_accesses += my_accesses;
+      num_point_hits += my_point_hits;
+      num_point_accesses += my_point_accesses;
+    };
+    PrintF("Doing: eviction=%s num_iterations=%d num_threads=%d num_keys=%d"
+           " cap_rec_num=%lld zipf=%.2f scan=%.4f\n",
+           CacheDBM::GetEvictionPolicyName(policy), num_iterations, num_threads, num_keys,
+           cap_rec_num, zipf_exponent, scan_ratio);
+    const double start_time = GetWallTime();
+    std::vector<std::thread> threads;
+    for (int32_t i = 0; i < num_threads; i++) {
+      threads.emplace_back(std::thread(task, i));
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    const double elapsed_time = GetWallTime() - start_time;
+    if (task_error.load()) {
+      has_error = true;
+    }
+    PrintF("Done: elapsed_time=%.6f num_records=%lld qps=%.0f"
+           " hit_ratio=%.2f%% point_hit_ratio=%.2f%%\n",
+           elapsed_time, dbm.CountSimple(), num_accesses.load() / elapsed_time,
+           num_hits.load() * 100.0 / std::max<int64_t>(num_accesses.load(), 1),
+           num_point_hits.load() * 100.0 / std::max<int64_t>(num_point_accesses.load(), 1));
+    PrintL();
+  }
+  return has_error ? 1 : 0;
+}
+
 // Processes the index subcommand.
 static int32_t ProcessIndex(int32_t argc, const char** args) {
   const std::map<std::string, int32_t>& cmd_configs = {
@@ -1418,6 +1570,8 @@ int main(int argc, char** argv) {
     rv = tkrzw::ProcessWicked(argc - 1, args + 1);
   } else if (std::strcmp(args[1], "index") == 0) {
     rv = tkrzw::ProcessIndex(argc - 1, args + 1);
+  } else if (std::strcmp(args[1], "cache") == 0) {
+    rv = tkrzw::ProcessCache(argc - 1, args + 1);
   } else {
     tkrzw::PrintUsageAndDie();
   }
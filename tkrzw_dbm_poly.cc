@@ -13,6 +13,7 @@
 
 #include "tkrzw_dbm.h"
 #include "tkrzw_dbm_baby.h"
+#include "tkrzw_dbm_radix.h"
 #include "tkrzw_dbm_cache.h"
 #include "tkrzw_dbm_hash.h"
 #include "tkrzw_dbm_poly.h"
@@ -21,8 +22,10 @@
 #include "tkrzw_dbm_tiny.h"
 #include "tkrzw_dbm_tree.h"
 #include "tkrzw_file.h"
+#include "tkrzw_file_direct.h"
 #include "tkrzw_file_mmap.h"
 #include "tkrzw_file_pos.h"
+#include "tkrzw_file_uring.h"
 #include "tkrzw_file_util.h"
 #include "tkrzw_lib_common.h"
 #include "tkrzw_str_util.h"
@@ -47,6 +50,8 @@ std::string GuessClassNameFromPath(const std::string& path) {
     return "tiny";
   } else if (ext == "tkmb" || ext == "baby") {
     return "baby";
+  } else if (ext == "tkmr" || ext == "radix") {
+    return "radix";
   } else if (ext == "tkmc" || ext == "cache") {
     return "cache";
   } else if (ext == "tksh" || ext == "stdhash") {
@@ -116,6 +121,24 @@ SkipDBM::ReducerType GetReducerByName(const std::string& func_name) {
   return nullptr;
 }
 
+std::unique_ptr<File> MakeFileByName(const std::string& impl_name) {
+  const std::string lower_name = StrLowerCase(impl_name);
+  if (lower_name == "mmap-para" || lower_name == "memorymapparallelfile") {
+    return std::make_unique<MemoryMapParallelFile>();
+  } else if (lower_name == "mmap-atom" || lower_name == "memorymapatomicfile") {
+    return std::make_unique<MemoryMapAtomicFile>();
+  } else if (lower_name == "pos-para" || lower_name == "positionalparallelfile") {
+    return std::make_unique<PositionalParallelFile>();
+  } else if (lower_name == "pos-atom" || lower_name == "positionalatomicfile") {
+    return std::make_unique<PositionalAtomicFile>();
+  } else if (lower_name == "uring" || lower_name == "iouringparallelfile") {
+    return std::make_unique<IoUringParallelFile>();
+  } else if (lower_name == "direct" || lower_name == "directiofile") {
+    return std::make_unique<DirectIOFile>();
+  }
+  return nullptr;
+}
+
 void SetHashTuningParams(std::map<std::string, std::string>* params,
                          HashDBM::TuningParameters* tuning_params) {
   const std::string update_mode = StrLowerCase(SearchMap(*params, "update_mode", ""));
@@ -130,12 +153,17 @@ void SetHashTuningParams(std::map<std::string, std::string>* params,
   tuning_params->num_buckets = StrToInt(SearchMap(*params, "num_buckets", "-1"));
   tuning_params->fbp_capacity = StrToInt(SearchMap(*params, "fbp_capacity", "-1"));
   tuning_params->lock_mem_buckets = StrToBool(SearchMap(*params, "lock_mem_buckets", "false"));
+  tuning_params->punch_free_blocks =
+      StrToBool(SearchMap(*params, "punch_free_blocks", "false"));
+  tuning_params->append_buffer_size = StrToInt(SearchMap(*params, "append_buffer_size", "0"));
   params->erase("update_mode");
   params->erase("offset_width");
   params->erase("align_pow");
   params->erase("num_buckets");
   params->erase("fbp_capacity");
   params->erase("lock_mem_buckets");
+  params->erase("punch_free_blocks");
+  params->erase("append_buffer_size");
 }
 
 void SetTreeTuningParams(std::map<std::string, std::string>* params,
@@ -159,12 +187,14 @@ void SetSkipTuningParams(std::map<std::string, std::string>* params,
   tuning_params->sort_mem_size = StrToInt(SearchMap(*params, "sort_mem_size", "-1"));
   tuning_params->insert_in_order = StrToBool(SearchMap(*params, "insert_in_order", "false"));
   tuning_params->max_cached_records = StrToInt(SearchMap(*params, "max_cached_records", "-1"));
+  tuning_params->append_buffer_size = StrToInt(SearchMap(*params, "append_buffer_size", "-1"));
   params->erase("offset_width");
   params->erase("step_unit");
   params->erase("max_level");
   params->erase("sort_mem_size");
   params->erase("insert_in_order");
   params->erase("max_cached_records");
+  params->erase("append_buffer_size");
 }
 
 PolyDBM::PolyDBM() : dbm_(nullptr), open_(false) {}
@@ -184,6 +214,16 @@ Status PolyDBM::OpenAdvanced(
     class_name = "tiny";
   }
   mod_params.erase("dbm");
+  const std::string file_impl = SearchMap(mod_params, "file", "");
+  std::unique_ptr<File> file;
+  if (!file_impl.empty()) {
+    file = MakeFileByName(file_impl);
+    if (file == nullptr) {
+      return Status(Status::INVALID_ARGUMENT_ERROR,
+                    StrCat("unsupported file implementation: ", file_impl));
+    }
+  }
+  mod_params.erase("file");
   if (class_name == "hash" || class_name == "hashdbm") {
     HashDBM::TuningParameters tuning_params;
     SetHashTuningParams(&mod_params, &tuning_params);
@@ -191,7 +231,8 @@ Status PolyDBM::OpenAdvanced(
       return Status(Status::INVALID_ARGUMENT_ERROR,
                     StrCat("unsupported parameter: ", mod_params.begin()->first));
     }
-    auto hash_dbm = std::make_unique<HashDBM>();
+    auto hash_dbm = file == nullptr ?
+        std::make_unique<HashDBM>() : std::make_unique<HashDBM>(std::move(file));
     const Status status = hash_dbm->OpenAdvanced(path, writable, options, tuning_params);
     if (status != Status::SUCCESS) {
       return status;
@@ -209,7 +250,8 @@ Status PolyDBM::OpenAdvanced(
       return Status(Status::INVALID_ARGUMENT_ERROR,
                     StrCat("unsupported parameter: ", mod_params.begin()->first));
     }
-    auto tree_dbm = std::make_unique<TreeDBM>();
+    auto tree_dbm = file == nullptr ?
+        std::make_unique<TreeDBM>() : std::make_unique<TreeDBM>(std::move(file));
     const Status status = tree_dbm->OpenAdvanced(path, writable, options, tuning_params);
     if (status != Status::SUCCESS) {
       return status;
@@ -223,7 +265,8 @@ Status PolyDBM::OpenAdvanced(
       return Status(Status::INVALID_ARGUMENT_ERROR,
                     StrCat("unsupported parameter: ", mod_params.begin()->first));
     }
-    auto skip_dbm = std::make_unique<SkipDBM>();
+    auto skip_dbm = file == nullptr ?
+        std::make_unique<SkipDBM>() : std::make_unique<SkipDBM>(std::move(file));
     const Status status = skip_dbm->OpenAdvanced(path, writable, options, tuning_params);
     if (status != Status::SUCCESS) {
       return status;
@@ -232,12 +275,26 @@ Status PolyDBM::OpenAdvanced(
     dbm_ = std::move(skip_dbm);
   } else if (class_name == "tiny" || class_name == "tinydbm") {
     const int64_t num_buckets = StrToInt(SearchMap(mod_params, "num_buckets", "-1"));
+    const std::string table_type_name = SearchMap(mod_params, "table_type", "");
+    const std::string file_format_name = SearchMap(mod_params, "file_format", "");
     mod_params.erase("num_buckets");
+    mod_params.erase("table_type");
+    mod_params.erase("file_format");
     if (!mod_params.empty()) {
       return Status(Status::INVALID_ARGUMENT_ERROR,
                     StrCat("unsupported parameter: ", mod_params.begin()->first));
     }
-    auto tiny_dbm = std::make_unique<TinyDBM>(num_buckets);
+    const TinyDBM::TableType table_type = TinyDBM::ParseTableType(table_type_name);
+    if (!table_type_name.empty() && table_type == TinyDBM::TABLE_DEFAULT) {
+      return Status(Status::INVALID_ARGUMENT_ERROR,
+                    StrCat("unsupported table type: ", table_type_name));
+    }
+    const TinyDBM::FileFormat file_format = TinyDBM::ParseFileFormat(file_format_name);
+    if (!file_format_name.empty() && file_format == TinyDBM::FORMAT_DEFAULT) {
+      return Status(Status::INVALID_ARGUMENT_ERROR,
+                    StrCat("unsupported file format: ", file_format_name));
+    }
+    auto tiny_dbm = std::make_unique<TinyDBM>(num_buckets, table_type, file_format);
     if (!path.empty()) {
       const Status status = tiny_dbm->Open(path, writable, options);
       if (status != Status::SUCCESS) {
@@ -256,12 +313,19 @@ Status PolyDBM::OpenAdvanced(
                       StrCat("unsupported key comparator: ", comp_name));
       }
     }
+    const std::string file_format_name = SearchMap(mod_params, "file_format", "");
     mod_params.erase("key_comparator");
+    mod_params.erase("file_format");
     if (!mod_params.empty()) {
       return Status(Status::INVALID_ARGUMENT_ERROR,
                     StrCat("unsupported parameter: ", mod_params.begin()->first));
     }
-    auto baby_dbm = std::make_unique<BabyDBM>(key_comparator);
+    const BabyDBM::FileFormat file_format = BabyDBM::ParseFileFormat(file_format_name);
+    if (!file_format_name.empty() && file_format == BabyDBM::FORMAT_DEFAULT) {
+      return Status(Status::INVALID_ARGUMENT_ERROR,
+                    StrCat("unsupported file format: ", file_format_name));
+    }
+    auto baby_dbm = std::make_unique<BabyDBM>(key_comparator, file_format);
     if (!path.empty()) {
       const Status status = baby_dbm->Open(path, writable, options);
       if (status != Status::SUCCESS) {
@@ -270,16 +334,44 @@ Status PolyDBM::OpenAdvanced(
       open_ = true;
     }
     dbm_ = std::move(baby_dbm);
+  } else if (class_name == "radix" || class_name == "radixdbm") {
+    if (!mod_params.empty()) {
+      return Status(Status::INVALID_ARGUMENT_ERROR,
+                    StrCat("unsupported parameter: ", mod_params.begin()->first));
+    }
+    auto radix_dbm = std::make_unique<RadixDBM>();
+    if (!path.empty()) {
+      const Status status = radix_dbm->Open(path, writable, options);
+      if (status != Status::SUCCESS) {
+        return status;
+      }
+      open_ = true;
+    }
+    dbm_ = std::move(radix_dbm);
   } else if (class_name == "cache" || class_name == "cachedbm") {
     const int64_t cap_rec_num = StrToInt(SearchMap(mod_params, "cap_rec_num", "-1"));
     const int64_t cap_mem_size = StrToInt(SearchMap(mod_params, "cap_mem_size", "-1"));
+    const std::string eviction = SearchMap(mod_params, "eviction", "");
+    const std::string file_format_name = SearchMap(mod_params, "file_format", "");
     mod_params.erase("cap_rec_num");
     mod_params.erase("cap_mem_size");
+    mod_params.erase("eviction");
+    mod_params.erase("file_format");
     if (!mod_params.empty()) {
       return Status(Status::INVALID_ARGUMENT_ERROR,
                     StrCat("unsupported parameter: ", mod_params.begin()->first));
     }
-    auto cache_dbm = std::make_unique<CacheDBM>(cap_rec_num, cap_mem_size);
+    const CacheDBM::EvictionPolicy policy = CacheDBM::ParseEvictionPolicy(eviction);
+    if (!eviction.empty() && policy == CacheDBM::EVICT_DEFAULT) {
+      return Status(Status::INVALID_ARGUMENT_ERROR,
+                    StrCat("unsupported eviction policy: ", eviction));
+    }
+    const CacheDBM::FileFormat file_format = CacheDBM::ParseFileFormat(file_format_name);
+    if (!file_format_name.empty() && file_format == CacheDBM::FORMAT_DEFAULT) {
+      return Status(Status::INVALID_ARGUMENT_ERROR,
+                    StrCat("unsupported file format: ", file_format_name));
+    }
+    auto cache_dbm = std::make_unique<CacheDBM>(cap_rec_num, cap_mem_size, policy, file_format);
     if (!path.empty()) {
       const Status status = cache_dbm->Open(path, writable, options);
       if (status != Status::SUCCESS) {
@@ -290,12 +382,19 @@ Status PolyDBM::OpenAdvanced(
     dbm_ = std::move(cache_dbm);
   } else if (class_name == "stdhash" || class_name == "stdhashdbm") {
     const int64_t num_buckets = StrToInt(SearchMap(mod_params, "num_buckets", "-1"));
+    const std::string allocator = SearchMap(mod_params, "allocator", "");
     mod_params.erase("num_buckets");
+    mod_params.erase("allocator");
     if (!mod_params.empty()) {
       return Status(Status::INVALID_ARGUMENT_ERROR,
                     StrCat("unsupported parameter: ", mod_params.begin()->first));
     }
-    auto stdhash_dbm = std::make_unique<StdHashDBM>(num_buckets);
+    const StdAllocatorType alloc_type = ParseStdAllocatorType(allocator);
+    if (!allocator.empty() && alloc_type == STD_ALLOC_DEFAULT) {
+      return Status(Status::INVALID_ARGUMENT_ERROR,
+                    StrCat("unsupported allocator: ", allocator));
+    }
+    auto stdhash_dbm = std::make_unique<StdHashDBM>(num_buckets, alloc_type);
     if (!path.empty()) {
       const Status status = stdhash_dbm->Open(path, writable, options);
       if (status != Status::SUCCESS) {
@@ -305,11 +404,18 @@ Status PolyDBM::OpenAdvanced(
     }
     dbm_ = std::move(stdhash_dbm);
   } else if (class_name == "stdtree" || class_name == "stdtreedbm") {
+    const std::string allocator = SearchMap(mod_params, "allocator", "");
+    mod_params.erase("allocator");
     if (!mod_params.empty()) {
       return Status(Status::INVALID_ARGUMENT_ERROR,
                     StrCat("unsupported parameter: ", mod_params.begin()->first));
     }
-    auto stdtree_dbm = std::make_unique<StdTreeDBM>();
+    const StdAllocatorType alloc_type = ParseStdAllocatorType(allocator);
+    if (!allocator.empty() && alloc_type == STD_ALLOC_DEFAULT) {
+      return Status(Status::INVALID_ARGUMENT_ERROR,
+                    StrCat("unsupported allocator: ", allocator));
+    }
+    auto stdtree_dbm = std::make_unique<StdTreeDBM>(alloc_type);
     if (!path.empty()) {
       const Status status = stdtree_dbm->Open(path, writable, options);
       if (status != Status::SUCCESS) {
@@ -372,6 +478,31 @@ Status PolyDBM::Append(std::string_view key, std::string_view value, std::string
   return dbm_->Append(key, value, delim);
 }
 
+std::map<std::string, std::string> PolyDBM::GetMulti(
+    const std::initializer_list<std::string>& keys) {
+  return GetMulti(std::vector<std::string>(keys.begin(), keys.end()));
+}
+
+std::map<std::string, std::string> PolyDBM::GetMulti(const std::vector<std::string>& keys) {
+  if (dbm_ == nullptr) {
+    return std::map<std::string, std::string>();
+  }
+  return dbm_->GetMulti(keys);
+}
+
+Status PolyDBM::SetMulti(
+    const std::initializer_list<std::pair<std::string, std::string>>& records,
+    bool overwrite) {
+  return SetMulti(std::map<std::string, std::string>(records.begin(), records.end()), overwrite);
+}
+
+Status PolyDBM::SetMulti(const std::map<std::string, std::string>& records, bool overwrite) {
+  if (dbm_ == nullptr) {
+    return Status(Status::PRECONDITION_ERROR, "not opened database");
+  }
+  return dbm_->SetMulti(records, overwrite);
+}
+
 Status PolyDBM::ProcessEach(RecordProcessor* proc, bool writable) {
   if (dbm_ == nullptr) {
     return Status(Status::PRECONDITION_ERROR, "not opened database");
@@ -14,6 +14,7 @@
 #ifndef _TKRZW_DBM_POLY_H
 #define _TKRZW_DBM_POLY_H
 
+#include <initializer_list>
 #include <map>
 #include <memory>
 #include <string>
@@ -78,8 +79,8 @@ class ParamDBM : public DBM {
  * @details All operations except for Open and Close are thread-safe; Multiple threads can
  * access the same database concurrently.  Every opened database must be closed explicitly to
  * avoid data corruption.
- * @details This class is a wrapper of HashDBM, TreeDBM, SkipDBM, TinyDBM, BabyDBM, StdHashDBM,
- * and StdTreeDBM.  The open method specifies the actuall class used internally.
+ * @details This class is a wrapper of HashDBM, TreeDBM, SkipDBM, TinyDBM, BabyDBM, RadixDBM,
+ * StdHashDBM, and StdTreeDBM.  The open method specifies the actuall class used internally.
  */
 class PolyDBM final : public ParamDBM {
  public:
@@ -258,6 +259,7 @@ class PolyDBM final : public ParamDBM {
    *   - .tks : File skip database (SkipDBM)
    *   - .tkmt : On-memory hash database (TinyDBM)
    *   - .tkmb : On-memory tree database (BabyDBM)
+   *   - .tkmr : On-memory radix tree database (RadixDBM)
    *   - .tkmc : On-memory LRU cache database (CacheDBM)
    *   - .tksh : On-memory STL hash database (StdHashDBM)
    *   - .tkst : On-memory STL tree database (StdTreeDBM)
@@ -268,7 +270,12 @@ class PolyDBM final : public ParamDBM {
    *   - no_lock (bool): True to omit file locking.
    * @details The optional parameter "dbm" supercedes the decision of the database type by the
    * extension.  The value is the type name: "HashDBM", "TreeDBM", "SkipDBM", "TinyDBM",
-   * "BabyDBM", "CacheDBM", "StdHashDBM", "StdTreeDBM".
+   * "BabyDBM", "RadixDBM", "CacheDBM", "StdHashDBM", "StdTreeDBM".
+   * @details For HashDBM, TreeDBM, and SkipDBM, the optional parameter "file" specifies the
+   * file implementation: "mmap-para" for MemoryMapParallelFile, "mmap-atom" for
+   * MemoryMapAtomicFile, "pos-para" for PositionalParallelFile, "pos-atom" for
+   * PositionalAtomicFile, "uring" for IoUringParallelFile, and "direct" for DirectIOFile.  The
+   * default is "mmap-para".
    * @details For HashDBM, these optional parameters are supported.
    *   - update_mode (string): How to update the database file: "UPDATE_IN_PLACE" for the
    *     in-palce and "UPDATE_APPENDING" for the appending mode.
@@ -277,6 +284,8 @@ class PolyDBM final : public ParamDBM {
    *   - num_buckets (int): The number of buckets for hashing.
    *   - fbp_capacity (int): The capacity of the free block pool.
    *   - lock_mem_buckets (bool): True to lock the memory for the hash buckets.
+   *   - punch_free_blocks (bool): True to release the storage of free blocks.
+   *   - append_buffer_size (int): The size of the buffer for appending records.
    * @details For TreeDBM, all optional parameters for HashDBM are available.  In addition,
    * these optional parameters are supported.
    *   - max_page_size (int): The maximum size of a page.
@@ -296,13 +305,24 @@ class PolyDBM final : public ParamDBM {
    *   - insert_in_order (bool): If true, records are assumed to be inserted in ascending
    *     order of the key.
    *   - max_cached_records (int): The maximum number of cached records.
+   *   - append_buffer_size (int): The size of the buffer for appending records.
    * @details For TinyDBM, these optional parameters are supported.
    *   - num_buckets (int): The number of buckets for hashing.
+   *   - table_type (string): The layout of the hash table: "chain" or "swiss".
+   *   - file_format (string): The format of the file to save: "flat" or "snapshot".
    * @details For BabyDBM, these optional parameters are supported.
    *   - key_comparator (string): The comparator of record keys. The same ones as TreeDBM.
+   *   - file_format (string): The format of the file to save: "flat" or "snapshot".
    * @details For CacheDBM, these optional parameters are supported.
    *   - cap_rec_num (int): The maximum number of records.
    *   - cap_mem_size (int): The total memory size to use.
+   *   - eviction (string): The eviction policy: "lru", "clock", "s3fifo", or "wtinylfu".
+   *   - file_format (string): The format of the file to save: "flat" or "snapshot".
+   * @details For StdHashDBM, these optional parameters are supported.
+   *   - num_buckets (int): The number of buckets for hashing.
+   *   - allocator (string): The memory allocator of records: "global", "monotonic", or "pool".
+   * @details For StdTreeDBM, these optional parameters are supported.
+   *   - allocator (string): The memory allocator of records: "global", "monotonic", or "pool".
    */
   Status OpenAdvanced(const std::string& path, bool writable,
                       int32_t options = File::OPEN_DEFAULT,
@@ -363,6 +383,44 @@ class PolyDBM final : public ParamDBM {
   Status Append(
       std::string_view key, std::string_view value, std::string_view delim = "") override;
 
+  /**
+   * Gets the values of multiple records of keys.
+   * @param keys The keys of records to retrieve.
+   * @return A map of retrieved records.  Keys which don't match existing records are ignored.
+   */
+  std::map<std::string, std::string> GetMulti(
+      const std::initializer_list<std::string>& keys) override;
+
+  /**
+   * Gets the values of multiple records of keys, with a vector.
+   * @param keys The keys of records to retrieve.
+   * @return A map of retrieved records.  Keys which don't match existing records are ignored.
+   */
+  std::map<std::string, std::string> GetMulti(const std::vector<std::string>& keys) override;
+
+  /**
+   * Sets multiple records.
+   * @param records The records to store.
+   * @param overwrite Whether to overwrite the existing value if there's a record with the same
+   * key.  If true, the existing value is overwritten by the new value.  If false, the operation
+   * is given up and an error status is returned.
+   * @return The result status.
+   */
+  Status SetMulti(
+      const std::initializer_list<std::pair<std::string, std::string>>& records,
+      bool overwrite = true) override;
+
+  /**
+   * Sets multiple records, with a map of strings.
+   * @param records The records to store.
+   * @param overwrite Whether to overwrite the existing value if there's a record with the same
+   * key.  If true, the existing value is overwritten by the new value.  If false, the operation
+   * is given up and an error status is returned.
+   * @return The result status.
+   */
+  Status SetMulti(
+      const std::map<std::string, std::string>& records, bool overwrite = true) override;
+
   /**
    * Processes each and every record in the database with a processor.
    * @param proc The pointer to the processor object.
@@ -49,15 +49,17 @@ TEST_F(PolyDBMTest, BasicTest) {
      {{"dbm", "hash"}, {"num_buckets", "50"}}, {}, {{"offset_width", "3"}}},
     {"HashDBM", "casket.tkh",
      {{"update_mode", "update_appending"}, {"offset_width", "3"},
-      {"align_pow", "1"}, {"num_buckets", "50"}, {"lock_mem_buckets", "true"}}, {}, {}},
+      {"align_pow", "1"}, {"num_buckets", "50"}, {"lock_mem_buckets", "true"},
+      {"file", "uring"}}, {}, {}},
     {"TreeDBM", "casket",
      {{"dbm", "tree"}, {"key_comparator", "decimal"}}, {}, {{"max_page_size", "512"}}},
     {"TreeDBM", "casket.tkt",
-     {{"update_mode", "update_appending"}, {"key_comparator", "realnumber"}}, {}, {}},
+     {{"update_mode", "update_appending"}, {"key_comparator", "realnumber"},
+      {"file", "pos-para"}}, {}, {}},
     {"SkipDBM", "casket",
      {{"dbm", "skip"}, {"step_unit", "3"}}, {{"reducer", "last"}}, {{"max_level", "5"}}},
     {"SkipDBM", "casket.tks",
-     {{"insert_in_order", "true"}, {"step_unit", "8"}}, {}, {}},
+     {{"insert_in_order", "true"}, {"step_unit", "8"}, {"file", "uring"}}, {}, {}},
     {"TinyDBM", "",
      {{"dbm", "tiny"}, {"num_buckets", "50"}}, {}, {{"num_buckets", "30"}}},
     {"TinyDBM", "casket.tiny",
@@ -184,6 +186,10 @@ TEST_F(PolyDBMTest, BasicTest) {
       }
     }
   }
+  tkrzw::PolyDBM dbm;
+  EXPECT_EQ(tkrzw::Status::INVALID_ARGUMENT_ERROR, dbm.OpenAdvanced(
+      tkrzw::JoinPath(tmp_dir.Path(), "casket.tkh"), true, tkrzw::File::OPEN_TRUNCATE,
+      {{"file", "foo"}}));
 }
 
 TEST_F(PolyDBMTest, LargeRecord) {
@@ -0,0 +1,1430 @@
+/*************************************************************************************************
+ * On-memory database manager implementations based on adaptive radix tree
+ *
+ * Copyright 2020 Google LLC
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+ * except in compliance with the License.  You may obtain a copy of the License at
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software distributed under the
+ * License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied.  See the License for the specific language governing permissions
+ * and limitations under the License.
+ *************************************************************************************************/
+
+#include "tkrzw_dbm.h"
+#include "tkrzw_dbm_common_impl.h"
+#include "tkrzw_dbm_radix.h"
+#include "tkrzw_file.h"
+#include "tkrzw_file_mmap.h"
+#include "tkrzw_file_util.h"
+#include "tkrzw_lib_common.h"
+#include "tkrzw_str_util.h"
+#include "tkrzw_sys_config.h"
+
+namespace tkrzw {
+
+constexpr int32_t RADIX_PREFIX_INLINE_SIZE = 8;
+constexpr int32_t RADIX_NODE16_SHRINK_SIZE = 3;
+constexpr int32_t RADIX_NODE48_SHRINK_SIZE = 12;
+constexpr int32_t RADIX_NODE256_SHRINK_SIZE = 37;
+constexpr int32_t ITER_BUFFER_SIZE = 128;
+
+enum RadixNodeType : uint8_t {
+  RADIX_NODE4 = 0,
+  RADIX_NODE16 = 1,
+  RADIX_NODE48 = 2,
+  RADIX_NODE256 = 3,
+};
+
+struct RadixRecord final {
+  int32_t key_size;
+  int32_t value_size;
+  std::string_view GetKey() const;
+  std::string_view GetValue() const;
+};
+
+RadixRecord* CreateRadixRecord(std::string_view key, std::string_view value);
+RadixRecord* ModifyRadixRecord(RadixRecord* record, std::string_view new_value);
+RadixRecord* AppendRadixRecord(
+    RadixRecord* record, std::string_view cat_value, std::string_view cat_delim);
+void FreeRadixRecord(RadixRecord* record);
+
+struct RadixNode {
+  uint8_t type;
+  uint16_t num_children;
+  uint32_t prefix_size;
+  union {
+    uint8_t inline_prefix[RADIX_PREFIX_INLINE_SIZE];
+    uint8_t* heap_prefix;
+  };
+  void* leaf;
+  explicit RadixNode(uint8_t type)
+      : type(type), num_children(0), prefix_size(0), heap_prefix(nullptr), leaf(nullptr) {}
+  const uint8_t* GetPrefix() const {
+    return prefix_size > RADIX_PREFIX_INLINE_SIZE ? heap_prefix : inline_prefix;
+  }
+};
+
+struct RadixNode4 final : public RadixNode {
+  uint8_t keys[4];
+  void* children[4];
+  RadixNode4() : RadixNode(RADIX_NODE4), keys(), children() {}
+};
+
+struct RadixNode16 final : public RadixNode {
+  uint8_t keys[16];
+  void* children[16];
+  RadixNode16() : RadixNode(RADIX_NODE16), keys(), children() {}
+};
+
+struct RadixNode48 final : public RadixNode {
+  uint8_t child_index[256];
+  void* children[48];
+  RadixNode48() : RadixNode(RADIX_NODE48), child_index(), children() {}
+};
+
+struct RadixNode256 final : public RadixNode {
+  void* children[256];
+  RadixNode256() : RadixNode(RADIX_NODE256), children() {}
+};
+
+inline bool IsRadixLeaf(const void* ptr) {
+  return reinterpret_cast<uintptr_t>(ptr) & 1;
+}
+
+inline RadixRecord* GetRadixLeaf(const void* ptr) {
+  return reinterpret_cast<RadixRecord*>(reinterpret_cast<uintptr_t>(ptr) & ~uintptr_t(1));
+}
+
+inline void* MakeRadixLeaf(const RadixRecord* record) {
+  return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(record) | 1);
+}
+
+void SetRadixPrefix(RadixNode* node, const uint8_t* data, int32_t size);
+void DeleteRadixNode(RadixNode* node);
+void GetRadixChildren(const RadixNode* node, std::vector<void*>* children);
+void VisitRadixTree(const void* node, const std::function<void(const void*)>& visit);
+void FreeRadixTree(void* node);
+void** FindRadixChild(RadixNode* node, uint8_t byte);
+void* GetRadixChildAtOrAfter(const RadixNode* node, int32_t byte);
+void* GetRadixChildAtOrBefore(const RadixNode* node, int32_t byte);
+void AddRadixChild(void** ref, RadixNode* node, uint8_t byte, void* child);
+void RemoveRadixChild(void** ref, RadixNode* node, uint8_t byte);
+void CompactRadixNode(void** ref);
+RadixRecord* GetMinRadixRecord(const void* node);
+RadixRecord* GetMaxRadixRecord(const void* node);
+
+class RadixDBMImpl final {
+  friend class RadixDBMIteratorImpl;
+  typedef std::list<RadixDBMIteratorImpl*> IteratorList;
+ public:
+  explicit RadixDBMImpl(std::unique_ptr<File> file);
+  ~RadixDBMImpl();
+  Status Open(const std::string& path, bool writable, int32_t options);
+  Status Close();
+  Status Process(std::string_view key, DBM::RecordProcessor* proc, bool writable);
+  Status Append(std::string_view key, std::string_view value, std::string_view delim);
+  Status ProcessEach(DBM::RecordProcessor* proc, bool writable);
+  Status Count(int64_t* count);
+  Status GetFileSize(int64_t* size);
+  Status GetFilePath(std::string* path);
+  Status Clear();
+  Status Synchronize(bool hard, DBM::FileProcessor* proc);
+  std::vector<std::pair<std::string, std::string>> Inspect();
+  bool IsOpen();
+  bool IsWritable();
+  std::unique_ptr<DBM> MakeDBM();
+
+ private:
+  void** FindRecordSlot(std::string_view key);
+  void InsertRecord(RadixRecord* record);
+  RadixRecord* RemoveRecord(void** ref, std::string_view key, int32_t depth);
+  RadixRecord* FindGreater(const void* node, std::string_view key, int32_t depth, bool inclusive);
+  RadixRecord* FindLess(const void* node, std::string_view key, int32_t depth, bool inclusive);
+  void ProcessImpl(std::string_view key, DBM::RecordProcessor* proc, bool writable);
+  void AppendImpl(std::string_view key, std::string_view value, std::string_view delim);
+  Status ImportRecords();
+  Status ExportRecords();
+
+  IteratorList iterators_;
+  std::unique_ptr<File> file_;
+  bool open_;
+  bool writable_;
+  std::string path_;
+  std::atomic_int64_t num_records_;
+  void* root_;
+  std::shared_timed_mutex mutex_;
+};
+
+class RadixDBMIteratorImpl final {
+  friend class RadixDBMImpl;
+ public:
+  explicit RadixDBMIteratorImpl(RadixDBMImpl* dbm);
+  ~RadixDBMIteratorImpl();
+  Status First();
+  Status Last();
+  Status Jump(std::string_view key);
+  Status JumpLower(std::string_view key, bool inclusive);
+  Status JumpUpper(std::string_view key, bool inclusive);
+  Status Next();
+  Status Previous();
+  Status Process(DBM::RecordProcessor* proc, bool writable);
+
+ private:
+  void ClearPosition();
+  void SetPosition(const RadixRecord* record);
+
+  RadixDBMImpl* dbm_;
+  char stack_[ITER_BUFFER_SIZE];
+  char* key_ptr_;
+  int32_t key_size_;
+};
+
+std::string_view RadixRecord::GetKey() const {
+  const char* rp = reinterpret_cast<const char*>(this) + sizeof(*this);
+  return std::string_view(rp, key_size);
+}
+
+std::string_view RadixRecord::GetValue() const {
+  const char* rp = reinterpret_cast<const char*>(this) + sizeof(*this) + key_size;
+  return std::string_view(rp, value_size);
+}
+
+RadixRecord* CreateRadixRecord(std::string_view key, std::string_view value) {
+  RadixRecord* rec =
+      static_cast<RadixRecord*>(xmalloc(sizeof(RadixRecord) + key.size() + value.size()));
+  rec->key_size = key.size();
+  rec->value_size = value.size();
+  char* wp = reinterpret_cast<char*>(rec) + sizeof(*rec);
+  std::memcpy(wp, key.data(), key.size());
+  std::memcpy(wp + key.size(), value.data(), value.size());
+  return rec;
+}
+
+RadixRecord* ModifyRadixRecord(RadixRecord* record, std::string_view new_value) {
+  if (static_cast<int32_t>(new_value.size()) > record->value_size) {
+    record = static_cast<RadixRecord*>(xrealloc(
+        record, sizeof(RadixRecord) + record->key_size + new_value.size()));
+  }
+  char* wp = reinterpret_cast<char*>(record) + sizeof(*record) + record->key_size;
+  std::memcpy(wp, new_value.data(), new_value.size());
+  record->value_size = new_value.size();
+  return record;
+}
+
+RadixRecord* AppendRadixRecord(
+    RadixRecord* record, std::string_view cat_value, std::string_view cat_delim) {
+  const int32_t new_value_size = record->value_size + cat_delim.size() + cat_value.size();
+  record = static_cast<RadixRecord*>(xreallocappend(
+      record, sizeof(RadixRecord) + record->key_size + new_value_size));
+  char* wp = reinterpret_cast<char*>(record) + sizeof(*record) +
+      record->key_size + record->value_size;
+  std::memcpy(wp, cat_delim.data(), cat_delim.size());
+  wp += cat_delim.size();
+  std::memcpy(wp, cat_value.data(), cat_value.size());
+  record->value_size = new_value_size;
+  return record;
+}
+
+void FreeRadixRecord(RadixRecord* record) {
+  xfree(record);
+}
+
+void SetRadixPrefix(RadixNode* node, const uint8_t* data, int32_t size) {
+  uint8_t* old_heap = node->prefix_size > RADIX_PREFIX_INLINE_SIZE ? node->heap_prefix : nullptr;
+  if (size > RADIX_PREFIX_INLINE_SIZE) {
+    uint8_t* new_heap = static_cast<uint8_t*>(xmalloc(size));
+    std::memcpy(new_heap, data, size);
+    node->heap_prefix = new_heap;
+  } else {
+    std::memmove(node->inline_prefix, data, size);
+  }
+  node->prefix_size = size;
+  xfree(old_heap);
+}
+
+void DeleteRadixNode(RadixNode* node) {
+  if (node->prefix_size > RADIX_PREFIX_INLINE_SIZE) {
+    xfree(node->heap_prefix);
+  }
+  switch (node->type) {
+    case RADIX_NODE4:
+      delete static_cast<RadixNode4*>(node);
+      break;
+    case RADIX_NODE16:
+      delete static_cast<RadixNode16*>(node);
+      break;
+    case RADIX_NODE48:
+      delete static_cast<RadixNode48*>(node);
+      break;
+    default:
+      delete static_cast<RadixNode256*>(node);
+      break;
+  }
+}
+
+void GetRadixChildren(const RadixNode* node, std::vector<void*>* children) {
+  switch (node->type) {
+    case RADIX_NODE4: {
+      const RadixNode4* node4 = static_cast<const RadixNode4*>(node);
+      children->insert(children->end(), node4->children, node4->children + node4->num_children);
+      break;
+    }
+    case RADIX_NODE16: {
+      const RadixNode16* node16 = static_cast<const RadixNode16*>(node);
+      children->insert(
+          children->end(), node16->children, node16->children + node16->num_children);
+      break;
+    }
+    case RADIX_NODE48: {
+      const RadixNode48* node48 = static_cast<const RadixNode48*>(node);
+      for (int32_t i = 0; i < 256; i++) {
+        if (node48->child_index[i] != 0) {
+          children->emplace_back(node48->children[node48->child_index[i] - 1]);
+        }
+      }
+      break;
+    }
+    default: {
+      const RadixNode256* node256 = static_cast<const RadixNode256*>(node);
+      for (int32_t i = 0; i < 256; i++) {
+        if (node256->children[i] != nullptr) {
+          children->emplace_back(node256->children[i]);
+        }
+      }
+      break;
+    }
+  }
+}
+
+void VisitRadixTree(const void* node, const std::function<void(const void*)>& visit) {
+  std::vector<void*> stack;
+  std::vector<void*> children;
+  if (node != nullptr) {
+    stack.emplace_back(const_cast<void*>(node));
+  }
+  while (!stack.empty()) {
+    void* ptr = stack.back();
+    stack.pop_back();
+    visit(ptr);
+    if (IsRadixLeaf(ptr)) {
+      continue;
+    }
+    const RadixNode* inner = static_cast<const RadixNode*>(ptr);
+    children.clear();
+    GetRadixChildren(inner, &children);
+    stack.insert(stack.end(), children.rbegin(), children.rend());
+    if (inner->leaf != nullptr) {
+      stack.emplace_back(inner->leaf);
+    }
+  }
+}
+
+void FreeRadixTree(void* node) {
+  std::vector<void*> stack;
+  if (node != nullptr) {
+    stack.emplace_back(node);
+  }
+  while (!stack.empty()) {
+    void* ptr = stack.back();
+    stack.pop_back();
+    if (IsRadixLeaf(ptr)) {
+      FreeRadixRecord(GetRadixLeaf(ptr));
+      continue;
+    }
+    RadixNode* inner = static_cast<RadixNode*>(ptr);
+    if (inner->leaf != nullptr) {
+      stack.emplace_back(inner->leaf);
+    }
+    GetRadixChildren(inner, &stack);
+    DeleteRadixNode(inner);
+  }
+}
+
+inline int32_t SearchRadixNode16(const RadixNode16* node, uint8_t byte) {
+#if defined(_TKRZW_SIMD_SSE2)
+  const __m128i keys = _mm_loadu_si128(reinterpret_cast<const __m128i*>(node->keys));
+  const uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(keys, _mm_set1_epi8(byte))) &
+      ((1U << node->num_children) - 1);
+  return mask == 0 ? -1 : __builtin_ctz(mask);
+#elif defined(_TKRZW_SIMD_NEON)
+  const uint8x16_t eq = vceqq_u8(vld1q_u8(node->keys), vdupq_n_u8(byte));
+  const uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(eq), 4);
+  uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(nibbles), 0);
+  if (node->num_children < 16) {
+    mask &= (1ULL << (node->num_children * 4)) - 1;
+  }
+  return mask == 0 ? -1 : __builtin_ctzll(mask) / 4;
+#else
+  for (int32_t i = 0; i < node->num_children; i++) {
+    if (node->keys[i] == byte) {
+      return i;
+    }
+  }
+  return -1;
+#endif
+}
+
+void** FindRadixChild(RadixNode* node, uint8_t byte) {
+  switch (node->type) {
+    case RADIX_NODE4: {
+      RadixNode4* node4 = static_cast<RadixNode4*>(node);
+      for (int32_t i = 0; i < node4->num_children; i++) {
+        if (node4->keys[i] == byte) {
+          return node4->children + i;
+        }
+      }
+      return nullptr;
+    }
+    case RADIX_NODE16: {
+      RadixNode16* node16 = static_cast<RadixNode16*>(node);
+      const int32_t index = SearchRadixNode16(node16, byte);
+      return index < 0 ? nullptr : node16->children + index;
+    }
+    case RADIX_NODE48: {
+      RadixNode48* node48 = static_cast<RadixNode48*>(node);
+      const int32_t index = node48->child_index[byte];
+      return index == 0 ? nullptr : node48->children + index - 1;
+    }
+    default: {
+      RadixNode256* node256 = static_cast<RadixNode256*>(node);
+      return node256->children[byte] == nullptr ? nullptr : node256->children + byte;
+    }
+  }
+}
+
+void* GetRadixChildAtOrAfter(const RadixNode* node, int32_t byte) {
+  switch (node->type) {
+    case RADIX_NODE4: {
+      const RadixNode4* node4 = static_cast<const RadixNode4*>(node);
+      for (int32_t i = 0; i < node4->num_children; i++) {
+        if (node4->keys[i] >= byte) {
+          return node4->children[i];
+        }
+      }
+      return nullptr;
+    }
+    case RADIX_NODE16: {
+      const RadixNode16* node16 = static_cast<const RadixNode16*>(node);
+      for (int32_t i = 0; i < node16->num_children; i++) {
+        if (node16->keys[i] >= byte) {
+          return node16->children[i];
+        }
+      }
+      return nullptr;
+    }
+    case RADIX_NODE48: {
+      const RadixNode48* node48 = static_cast<const RadixNode48*>(node);
+      for (int32_t i = std::max(byte, 0); i < 256; i++) {
+        if (node48->child_index[i] != 0) {
+          return node48->children[node48->child_index[i] - 1];
+        }
+      }
+      return nullptr;
+    }
+    default: {
+      const RadixNode256* node256 = static_cast<const RadixNode256*>(node);
+      for (int32_t i = std::max(byte, 0); i < 256; i++) {
+        if (node256->children[i] != nullptr) {
+          return node256->children[i];
+        }
+      }
+      return nullptr;
+    }
+  }
+}
+
+void* GetRadixChildAtOrBefore(const RadixNode* node, int32_t byte) {
+  switch (node->type) {
+    case RADIX_NODE4: {
+      const RadixNode4* node4 = static_cast<const RadixNode4*>(node);
+      for (int32_t i = node4->num_children - 1; i >= 0; i--) {
+        if (node4->keys[i] <= byte) {
+          return node4->children[i];
+        }
+      }
+      return nullptr;
+    }
+    case RADIX_NODE16: {
+      const RadixNode16* node16 = static_cast<const RadixNode16*>(node);
+      for (int32_t i = node16->num_children - 1; i >= 0; i--) {
+        if (node16->keys[i] <= byte) {
+          return node16->children[i];
+        }
+      }
+      return nullptr;
+    }
+    case RADIX_NODE48: {
+      const RadixNode48* node48 = static_cast<const RadixNode48*>(node);
+      for (int32_t i = std::min(byte, 255); i >= 0; i--) {
+        if (node48->child_index[i] != 0) {
+          return node48->children[node48->child_index[i] - 1];
+        }
+      }
+      return nullptr;
+    }
+    default: {
+      const RadixNode256* node256 = static_cast<const RadixNode256*>(node);
+      for (int32_t i = std::min(byte, 255); i >= 0; i--) {
+        if (node256->children[i] != nullptr) {
+          return node256->children[i];
+        }
+      }
+      return nullptr;
+    }
+  }
+}
+
+template <typename SRCTYPE, typename DESTTYPE>
+DESTTYPE* MoveRadixHeader(SRCTYPE* src) {
+  DESTTYPE* dest = new DESTTYPE();
+  dest->num_children = src->num_children;
+  dest->prefix_size = src->prefix_size;
+  std::memcpy(dest->inline_prefix, src->inline_prefix, sizeof(dest->inline_prefix));
+  dest->leaf = src->leaf;
+  src->prefix_size = 0;
+  return dest;
+}
+
+template <typename NODETYPE>
+void InsertRadixSortedChild(NODETYPE* node, uint8_t byte, void* child) {
+  int32_t pos = 0;
+  while (pos < node->num_children && node->keys[pos] < byte) {
+    pos++;
+  }
+  for (int32_t i = node->num_children; i > pos; i--) {
+    node->keys[i] = node->keys[i - 1];
+    node->children[i] = node->children[i - 1];
+  }
+  node->keys[pos] = byte;
+  node->children[pos] = child;
+  node->num_children++;
+}
+
+template <typename NODETYPE>
+void EraseRadixSortedChild(NODETYPE* node, uint8_t byte) {
+  int32_t pos = 0;
+  while (pos < node->num_children && node->keys[pos] != byte) {
+    pos++;
+  }
+  for (int32_t i = pos + 1; i < node->num_children; i++) {
+    node->keys[i - 1] = node->keys[i];
+    node->children[i - 1] = node->children[i];
+  }
+  node->num_children--;
+}
+
+void AddRadixChild(void** ref, RadixNode* node, uint8_t byte, void* child) {
+  switch (node->type) {
+    case RADIX_NODE4: {
+      RadixNode4* node4 = static_cast<RadixNode4*>(node);
+      if (node4->num_children < 4) {
+        InsertRadixSortedChild(node4, byte, child);
+        return;
+      }
+      RadixNode16* node16 = MoveRadixHeader<RadixNode4, RadixNode16>(node4);
+      std::memcpy(node16->keys, node4->keys, sizeof(node4->keys));
+      std::memcpy(node16->children, node4->children, sizeof(node4->children));
+      DeleteRadixNode(node4);
+      InsertRadixSortedChild(node16, byte, child);
+      *ref = node16;
+      return;
+    }
+    case RADIX_NODE16: {
+      RadixNode16* node16 = static_cast<RadixNode16*>(node);
+      if (node16->num_children < 16) {
+        InsertRadixSortedChild(node16, byte, child);
+        return;
+      }
+      RadixNode48* node48 = MoveRadixHeader<RadixNode16, RadixNode48>(node16);
+      for (int32_t i = 0; i < node16->num_children; i++) {
+        node48->child_index[node16->keys[i]] = i + 1;
+        node48->children[i] = node16->children[i];
+      }
+      DeleteRadixNode(node16);
+      node48->child_index[byte] = node48->num_children + 1;
+      node48->children[node48->num_children] = child;
+      node48->num_children++;
+      *ref = node48;
+      return;
+    }
+    case RADIX_NODE48: {
+      RadixNode48* node48 = static_cast<RadixNode48*>(node);
+      if (node48->num_children < 48) {
+        int32_t pos = 0;
+        while (node48->children[pos] != nullptr) {
+          pos++;
+        }
+        node48->child_index[byte] = pos + 1;
+        node48->children[pos] = child;
+        node48->num_children++;
+        return;
+      }
+      RadixNode256* node256 = MoveRadixHeader<RadixNode48, RadixNode256>(node48);
+      for (int32_t i = 0; i < 256; i++) {
+        if (node48->child_index[i] != 0) {
+          node256->children[i] = node48->children[node48->child_index[i] - 1];
+        }
+      }
+      DeleteRadixNode(node48);
+      node256->children[byte] = child;
+      node256->num_children++;
+      *ref = node256;
+      return;
+    }
+    default: {
+      RadixNode256* node256 = static_cast<RadixNode256*>(node);
+      node256->children[byte] = child;
+      node256->num_children++;
+      return;
+    }
+  }
+}
+
+void RemoveRadixChild(void** ref, RadixNode* node, uint8_t byte) {
+  switch (node->type) {
+    case RADIX_NODE4: {
+      EraseRadixSortedChild(static_cast<RadixNode4*>(node), byte);
+      return;
+    }
+    case RADIX_NODE16: {
+      RadixNode16* node16 = static_cast<RadixNode16*>(node);
+      EraseRadixSortedChild(node16, byte);
+      if (node16->num_children > RADIX_NODE16_SHRINK_SIZE) {
+        return;
+      }
+      RadixNode4* node4 = MoveRadixHeader<RadixNode16, RadixNode4>(node16);
+      std::memcpy(node4->keys, node16->keys, node16->num_children);
+      std::memcpy(node4->children, node16->children, sizeof(void*) * node16->num_children);
+      DeleteRadixNode(node16);
+      *ref = node4;
+      return;
+    }
+    case RADIX_NODE48: {
+      RadixNode48* node48 = static_cast<RadixNode48*>(node);
+      node48->children[node48->child_index[byte] - 1] = nullptr;
+      node48->child_index[byte] = 0;
+      node48->num_children--;
+      if (node48->num_children > RADIX_NODE48_SHRINK_SIZE) {
+        return;
+      }
+      RadixNode16* node16 = MoveRadixHeader<RadixNode48, RadixNode16>(node48);
+      int32_t pos = 0;
+      for (int32_t i = 0; i < 256; i++) {
+        if (node48->child_index[i] != 0) {
+          node16->keys[pos] = i;
+          node16->children[pos] = node48->children[node48->child_index[i] - 1];
+          pos++;
+        }
+      }
+      DeleteRadixNode(node48);
+      *ref = node16;
+      return;
+    }
+    default: {
+      RadixNode256* node256 = static_cast<RadixNode256*>(node);
+      node256->children[byte] = nullptr;
+      node256->num_children--;
+      if (node256->num_children > RADIX_NODE256_SHRINK_SIZE) {
+        return;
+      }
+      RadixNode48* node48 = MoveRadixHeader<RadixNode256, RadixNode48>(node256);
+      int32_t pos = 0;
+      for (int32_t i = 0; i < 256; i++) {
+        if (node256->children[i] != nullptr) {
+          node48->child_index[i] = pos + 1;
+          node48->children[pos] = node256->children[i];
+          pos++;
+        }
+      }
+      DeleteRadixNode(node256);
+      *ref = node48;
+      return;
+    }
+  }
+}
+
+void CompactRadixNode(void** ref) {
+  RadixNode* node = static_cast<RadixNode*>(*ref);
+  if (node->num_children == 0) {
+    *ref = node->leaf;
+    DeleteRadixNode(node);
+    return;
+  }
+  if (node->num_children > 1 || node->leaf != nullptr || node->type != RADIX_NODE4) {
+    return;
+  }
+  RadixNode4* node4 = static_cast<RadixNode4*>(node);
+  void* child = node4->children[0];
+  if (!IsRadixLeaf(child)) {
+    RadixNode* child_node = static_cast<RadixNode*>(child);
+    std::string prefix;
+    prefix.reserve(node4->prefix_size + 1 + child_node->prefix_size);
+    prefix.append(reinterpret_cast<const char*>(node4->GetPrefix()), node4->prefix_size);
+    prefix.push_back(node4->keys[0]);
+    prefix.append(reinterpret_cast<const char*>(child_node->GetPrefix()),
+                  child_node->prefix_size);
+    SetRadixPrefix(child_node, reinterpret_cast<const uint8_t*>(prefix.data()), prefix.size());
+  }
+  *ref = child;
+  DeleteRadixNode(node4);
+}
+
+RadixRecord* GetMinRadixRecord(const void* node) {
+  while (node != nullptr && !IsRadixLeaf(node)) {
+    const RadixNode* inner = static_cast<const RadixNode*>(node);
+    if (inner->leaf != nullptr) {
+      return GetRadixLeaf(inner->leaf);
+    }
+    node = GetRadixChildAtOrAfter(inner, 0);
+  }
+  return node == nullptr ? nullptr : GetRadixLeaf(node);
+}
+
+RadixRecord* GetMaxRadixRecord(const void* node) {
+  while (node != nullptr && !IsRadixLeaf(node)) {
+    const RadixNode* inner = static_cast<const RadixNode*>(node);
+    const void* child = GetRadixChildAtOrBefore(inner, 255);
+    if (child == nullptr) {
+      return inner->leaf == nullptr ? nullptr : GetRadixLeaf(inner->leaf);
+    }
+    node = child;
+  }
+  return node == nullptr ? nullptr : GetRadixLeaf(node);
+}
+
+RadixDBMImpl::RadixDBMImpl(std::unique_ptr<File> file)
+    : iterators_(), file_(std::move(file)), open_(false), writable_(false), path_(),
+      num_records_(0), root_(nullptr), mutex_() {}
+
+RadixDBMImpl::~RadixDBMImpl() {
+  if (open_) {
+    Close();
+  }
+  for (auto* iterator : iterators_) {
+    iterator->dbm_ = nullptr;
+  }
+  FreeRadixTree(root_);
+}
+
+Status RadixDBMImpl::Open(const std::string& path, bool writable, int32_t options) {
+  std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+  if (open_) {
+    return Status(Status::PRECONDITION_ERROR, "opened database");
+  }
+  Status status = file_->Open(path, writable, options);
+  if (status != Status::SUCCESS) {
+    return status;
+  }
+  status = ImportRecords();
+  if (status != Status::SUCCESS) {
+    file_->Close();
+    return status;
+  }
+  open_ = true;
+  writable_ = writable;
+  path_ = path;
+  return Status(Status::SUCCESS);
+}
+
+Status RadixDBMImpl::Close() {
+  std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+  if (!open_) {
+    return Status(Status::PRECONDITION_ERROR, "not opened database");
+  }
+  for (auto* iterator : iterators_) {
+    iterator->ClearPosition();
+  }
+  Status status(Status::SUCCESS);
+  if (writable_) {
+    status |= ExportRecords();
+  }
+  status |= file_->Close();
+  FreeRadixTree(root_);
+  root_ = nullptr;
+  num_records_.store(0);
+  open_ = false;
+  writable_ = false;
+  path_.clear();
+  return status;
+}
+
+Status RadixDBMImpl::Process(std::string_view key, DBM::RecordProcessor* proc, bool writable) {
+  if (writable) {
+    std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+    ProcessImpl(key, proc, true);
+  } else {
+    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    ProcessImpl(key, proc, false);
+  }
+  return Status(Status::SUCCESS);
+}
+
+Status RadixDBMImpl::Append(
+    std::string_view key, std::string_view value, std::string_view delim) {
+  std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+  AppendImpl(key, value, delim);
+  return Status(Status::SUCCESS);
+}
+
+Status RadixDBMImpl::ProcessEach(DBM::RecordProcessor* proc, bool writable) {
+  if (writable) {
+    std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+    proc->ProcessEmpty(DBM::RecordProcessor::NOOP);
+    const RadixRecord* rec = GetMinRadixRecord(root_);
+    std::string key;
+    while (rec != nullptr) {
+      key = rec->GetKey();
+      ProcessImpl(key, proc, true);
+      rec = FindGreater(root_, key, 0, false);
+    }
+    proc->ProcessEmpty(DBM::RecordProcessor::NOOP);
+  } else {
+    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    proc->ProcessEmpty(DBM::RecordProcessor::NOOP);
+    VisitRadixTree(root_, [&](const void* node) {
+        if (IsRadixLeaf(node)) {
+          const RadixRecord* rec = GetRadixLeaf(node);
+          proc->ProcessFull(rec->GetKey(), rec->GetValue());
+        }
+      });
+    proc->ProcessEmpty(DBM::RecordProcessor::NOOP);
+  }
+  return Status(Status::SUCCESS);
+}
+
+Status RadixDBMImpl::Count(int64_t* count) {
+  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+  *count = num_records_.load();
+  return Status(Status::SUCCESS);
+}
+
+Status RadixDBMImpl::GetFileSize(int64_t* size) {
+  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+  if (!open_) {
+    return Status(Status::PRECONDITION_ERROR, "not opened database");
+  }
+  *size = file_->GetSizeSimple();
+  return Status(Status::SUCCESS);
+}
+
+Status RadixDBMImpl::GetFilePath(std::string* path) {
+  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+  if (!open_) {
+    return Status(Status::PRECONDITION_ERROR, "not opened database");
+  }
+  *path = path_;
+  return Status(Status::SUCCESS);
+}
+
+Status RadixDBMImpl::Clear() {
+  std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+  for (auto* iterator : iterators_) {
+    iterator->ClearPosition();
+  }
+  FreeRadixTree(root_);
+  root_ = nullptr;
+  num_records_.store(0);
+  return Status(Status::SUCCESS);
+}
+
+Status RadixDBMImpl::Synchronize(bool hard, DBM::FileProcessor* proc) {
+  std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+  Status status(Status::SUCCESS);
+  if (open_ && writable_) {
+    status |= ExportRecords();
+    status |= file_->Synchronize(hard);
+    if (proc != nullptr) {
+      proc->Process(path_);
+    }
+  }
+  return status;
+}
+
+std::vector<std::pair<std::string, std::string>> RadixDBMImpl::Inspect() {
+  std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+  std::vector<std::pair<std::string, std::string>> meta;
+  auto Add = [&](const std::string& name, const std::string& value) {
+    meta.emplace_back(std::make_pair(name, value));
+  };
+  Add("class", "RadixDBM");
+  if (open_) {
+    Add("path", path_);
+  }
+  Add("num_records", ToString(num_records_.load()));
+  int64_t num_nodes[4] = {0, 0, 0, 0};
+  VisitRadixTree(root_, [&](const void* node) {
+      if (!IsRadixLeaf(node)) {
+        num_nodes[static_cast<const RadixNode*>(node)->type]++;
+      }
+    });
+  Add("num_node4", ToString(num_nodes[RADIX_NODE4]));
+  Add("num_node16", ToString(num_nodes[RADIX_NODE16]));
+  Add("num_node48", ToString(num_nodes[RADIX_NODE48]));
+  Add("num_node256", ToString(num_nodes[RADIX_NODE256]));
+  return meta;
+}
+
+bool RadixDBMImpl::IsOpen() {
+  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+  return open_;
+}
+
+bool RadixDBMImpl::IsWritable() {
+  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+  return open_ && writable_;
+}
+
+std::unique_ptr<DBM> RadixDBMImpl::MakeDBM() {
+  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+  return std::make_unique<RadixDBM>(file_->MakeFile());
+}
+
+void** RadixDBMImpl::FindRecordSlot(std::string_view key) {
+  const int32_t key_size = key.size();
+  const uint8_t* key_ptr = reinterpret_cast<const uint8_t*>(key.data());
+  void** ref = &root_;
+  int32_t depth = 0;
+  while (*ref != nullptr) {
+    if (IsRadixLeaf(*ref)) {
+      return GetRadixLeaf(*ref)->GetKey() == key ? ref : nullptr;
+    }
+    RadixNode* node = static_cast<RadixNode*>(*ref);
+    const int32_t prefix_size = node->prefix_size;
+    if (key_size - depth < prefix_size ||
+        std::memcmp(node->GetPrefix(), key_ptr + depth, prefix_size) != 0) {
+      return nullptr;
+    }
+    depth += prefix_size;
+    if (depth == key_size) {
+      return node->leaf == nullptr ? nullptr : &node->leaf;
+    }
+    ref = FindRadixChild(node, key_ptr[depth]);
+    if (ref == nullptr) {
+      return nullptr;
+    }
+    depth++;
+  }
+  return nullptr;
+}
+
+void RadixDBMImpl::InsertRecord(RadixRecord* record) {
+  const std::string_view key = record->GetKey();
+  const int32_t key_size = key.size();
+  const uint8_t* key_ptr = reinterpret_cast<const uint8_t*>(key.data());
+  void* leaf = MakeRadixLeaf(record);
+  void** ref = &root_;
+  int32_t depth = 0;
+  while (true) {
+    if (*ref == nullptr) {
+      *ref = leaf;
+      return;
+    }
+    if (IsRadixLeaf(*ref)) {
+      const std::string_view other_key = GetRadixLeaf(*ref)->GetKey();
+      const int32_t other_size = other_key.size();
+      const uint8_t* other_ptr = reinterpret_cast<const uint8_t*>(other_key.data());
+      const int32_t min_size = std::min(key_size, other_size);
+      int32_t diff = depth;
+      while (diff < min_size && key_ptr[diff] == other_ptr[diff]) {
+        diff++;
+      }
+      RadixNode4* new_node = new RadixNode4();
+      SetRadixPrefix(new_node, key_ptr + depth, diff - depth);
+      if (other_size == diff) {
+        new_node->leaf = *ref;
+      } else {
+        InsertRadixSortedChild(new_node, other_ptr[diff], *ref);
+      }
+      if (key_size == diff) {
+        new_node->leaf = leaf;
+      } else {
+        InsertRadixSortedChild(new_node, key_ptr[diff], leaf);
+      }
+      *ref = new_node;
+      return;
+    }
+    RadixNode* node = static_cast<RadixNode*>(*ref);
+    const uint8_t* prefix = node->GetPrefix();
+    const int32_t prefix_size = node->prefix_size;
+    int32_t diff = 0;
+    while (diff < prefix_size && depth + diff < key_size &&
+           prefix[diff] == key_ptr[depth + diff]) {
+      diff++;
+    }
+    if (diff < prefix_size) {
+      RadixNode4* new_node = new RadixNode4();
+      SetRadixPrefix(new_node, prefix, diff);
+      const uint8_t edge = prefix[diff];
+      SetRadixPrefix(node, prefix + diff + 1, prefix_size - diff - 1);
+      InsertRadixSortedChild(new_node, edge, node);
+      if (depth + diff == key_size) {
+        new_node->leaf = leaf;
+      } else {
+        InsertRadixSortedChild(new_node, key_ptr[depth + diff], leaf);
+      }
+      *ref = new_node;
+      return;
+    }
+    depth += prefix_size;
+    if (depth == key_size) {
+      node->leaf = leaf;
+      return;
+    }
+    void** child = FindRadixChild(node, key_ptr[depth]);
+    if (child == nullptr) {
+      AddRadixChild(ref, node, key_ptr[depth], leaf);
+      return;
+    }
+    ref = child;
+    depth++;
+  }
+}
+
+RadixRecord* RadixDBMImpl::RemoveRecord(void** ref, std::string_view key, int32_t depth) {
+  if (*ref == nullptr) {
+    return nullptr;
+  }
+  if (IsRadixLeaf(*ref)) {
+    RadixRecord* rec = GetRadixLeaf(*ref);
+    if (rec->GetKey() != key) {
+      return nullptr;
+    }
+    *ref = nullptr;
+    return rec;
+  }
+  const int32_t key_size = key.size();
+  const uint8_t* key_ptr = reinterpret_cast<const uint8_t*>(key.data());
+  RadixNode* node = static_cast<RadixNode*>(*ref);
+  const int32_t prefix_size = node->prefix_size;
+  if (key_size - depth < prefix_size ||
+      std::memcmp(node->GetPrefix(), key_ptr + depth, prefix_size) != 0) {
+    return nullptr;
+  }
+  depth += prefix_size;
+  if (depth == key_size) {
+    if (node->leaf == nullptr) {
+      return nullptr;
+    }
+    RadixRecord* rec = GetRadixLeaf(node->leaf);
+    node->leaf = nullptr;
+    CompactRadixNode(ref);
+    return rec;
+  }
+  void** child = FindRadixChild(node, key_ptr[depth]);
+  if (child == nullptr) {
+    return nullptr;
+  }
+  RadixRecord* rec = RemoveRecord(child, key, depth + 1);
+  if (rec == nullptr) {
+    return nullptr;
+  }
+  if (*child == nullptr) {
+    RemoveRadixChild(ref, node, key_ptr[depth]);
+  }
+  CompactRadixNode(ref);
+  return rec;
+}
+
+RadixRecord* RadixDBMImpl::FindGreater(
+    const void* node, std::string_view key, int32_t depth, bool inclusive) {
+  if (node == nullptr) {
+    return nullptr;
+  }
+  if (IsRadixLeaf(node)) {
+    RadixRecord* rec = GetRadixLeaf(node);
+    const int32_t cmp = rec->GetKey().compare(key);
+    return cmp > 0 || (inclusive && cmp == 0) ? rec : nullptr;
+  }
+  const int32_t key_size = key.size();
+  const uint8_t* key_ptr = reinterpret_cast<const uint8_t*>(key.data());
+  const RadixNode* inner = static_cast<const RadixNode*>(node);
+  const uint8_t* prefix = inner->GetPrefix();
+  for (int32_t i = 0; i < static_cast<int32_t>(inner->prefix_size); i++) {
+    if (depth + i == key_size) {
+      return GetMinRadixRecord(node);
+    }
+    if (prefix[i] != key_ptr[depth + i]) {
+      return prefix[i] > key_ptr[depth + i] ? GetMinRadixRecord(node) : nullptr;
+    }
+  }
+  depth += inner->prefix_size;
+  if (depth == key_size) {
+    if (inclusive && inner->leaf != nullptr) {
+      return GetRadixLeaf(inner->leaf);
+    }
+    return GetMinRadixRecord(GetRadixChildAtOrAfter(inner, 0));
+  }
+  const uint8_t byte = key_ptr[depth];
+  void** child = FindRadixChild(const_cast<RadixNode*>(inner), byte);
+  if (child != nullptr) {
+    RadixRecord* rec = FindGreater(*child, key, depth + 1, inclusive);
+    if (rec != nullptr) {
+      return rec;
+    }
+  }
+  return GetMinRadixRecord(GetRadixChildAtOrAfter(inner, byte + 1));
+}
+
+RadixRecord* RadixDBMImpl::FindLess(
+    const void* node, std::string_view key, int32_t depth, bool inclusive) {
+  if (node == nullptr) {
+    return nullptr;
+  }
+  if (IsRadixLeaf(node)) {
+    RadixRecord* rec = GetRadixLeaf(node);
+    const int32_t cmp = rec->GetKey().compare(key);
+    return cmp < 0 || (inclusive && cmp == 0) ? rec : nullptr;
+  }
+  const int32_t key_size = key.size();
+  const uint8_t* key_ptr = reinterpret_cast<const uint8_t*>(key.data());
+  const RadixNode* inner = static_cast<const RadixNode*>(node);
+  const uint8_t* prefix = inner->GetPrefix();
+  for (int32_t i = 0; i < static_cast<int32_t>(inner->prefix_size); i++) {
+    if (depth + i == key_size) {
+      return nullptr;
+    }
+    if (prefix[i] != key_ptr[depth + i]) {
+      return prefix[i] < key_ptr[depth + i] ? GetMaxRadixRecord(node) : nullptr;
+    }
+  }
+  depth += inner->prefix_size;
+  RadixRecord* leaf_rec = inner->leaf == nullptr ? nullptr : GetRadixLeaf(inner->leaf);
+  if (depth == key_size) {
+    return inclusive ? leaf_rec : nullptr;
+  }
+  const uint8_t byte = key_ptr[depth];
+  void** child = FindRadixChild(const_cast<RadixNode*>(inner), byte);
+  if (child != nullptr) {
+    RadixRecord* rec = FindLess(*child, key, depth + 1, inclusive);
+    if (rec != nullptr) {
+      return rec;
+    }
+  }
+  if (byte > 0) {
+    const void* prev = GetRadixChildAtOrBefore(inner, byte - 1);
+    if (prev != nullptr) {
+      return GetMaxRadixRecord(prev);
+    }
+  }
+  return leaf_rec;
+}
+
+void RadixDBMImpl::ProcessImpl(
+    std::string_view key, DBM::RecordProcessor* proc, bool writable) {
+  void** slot = FindRecordSlot(key);
+  if (slot != nullptr) {
+    RadixRecord* rec = GetRadixLeaf(*slot);
+    const std::string_view new_value = proc->ProcessFull(rec->GetKey(), rec->GetValue());
+    if (new_value.data() != DBM::RecordProcessor::NOOP.data() && writable) {
+      if (new_value.data() == DBM::RecordProcessor::REMOVE.data()) {
+        RemoveRecord(&root_, key, 0);
+        FreeRadixRecord(rec);
+        num_records_.fetch_sub(1);
+      } else {
+        RadixRecord* new_rec = ModifyRadixRecord(rec, new_value);
+        if (new_rec != rec) {
+          *slot = MakeRadixLeaf(new_rec);
+        }
+      }
+    }
+  } else {
+    const std::string_view new_value = proc->ProcessEmpty(key);
+    if (new_value.data() != DBM::RecordProcessor::NOOP.data() &&
+        new_value.data() != DBM::RecordProcessor::REMOVE.data() &&
+        writable) {
+      InsertRecord(CreateRadixRecord(key, new_value));
+      num_records_.fetch_add(1);
+    }
+  }
+}
+
+void RadixDBMImpl::AppendImpl(
+    std::string_view key, std::string_view value, std::string_view delim) {
+  void** slot = FindRecordSlot(key);
+  if (slot != nullptr) {
+    *slot = MakeRadixLeaf(AppendRadixRecord(GetRadixLeaf(*slot), value, delim));
+  } else {
+    InsertRecord(CreateRadixRecord(key, value));
+    num_records_.fetch_add(1);
+  }
+}
+
+Status RadixDBMImpl::ImportRecords() {
+  FlatRecordReader reader(file_.get());
+  std::string key_store;
+  while (true) {
+    std::string_view key;
+    Status status = reader.Read(&key);
+    if (status != Status::SUCCESS) {
+      if (status != Status::NOT_FOUND_ERROR) {
+        return status;
+      }
+      break;
+    }
+    key_store = key;
+    std::string_view value;
+    status = reader.Read(&value);
+    if (status != Status::SUCCESS) {
+      if (status != Status::NOT_FOUND_ERROR) {
+        return status;
+      }
+      return Status(Status::BROKEN_DATA_ERROR, "odd number of records");
+    }
+    DBM::RecordProcessorSet setter(&status, value, true);
+    ProcessImpl(key_store, &setter, true);
+  }
+  return Status(Status::SUCCESS);
+}
+
+Status RadixDBMImpl::ExportRecords() {
+  Status status = file_->Truncate(0);
+  if (status != Status::SUCCESS) {
+    return status;
+  }
+  FlatRecord flat_rec(file_.get());
+  VisitRadixTree(root_, [&](const void* node) {
+      if (status == Status::SUCCESS && IsRadixLeaf(node)) {
+        const RadixRecord* rec = GetRadixLeaf(node);
+        status = flat_rec.Write(rec->GetKey());
+        if (status == Status::SUCCESS) {
+          status = flat_rec.Write(rec->GetValue());
+        }
+      }
+    });
+  return status;
+}
+
+RadixDBMIteratorImpl::RadixDBMIteratorImpl(RadixDBMImpl* dbm)
+    : dbm_(dbm), key_ptr_(nullptr), key_size_(0) {
+  std::lock_guard<std::shared_timed_mutex> lock(dbm_->mutex_);
+  dbm_->iterators_.emplace_back(this);
+}
+
+RadixDBMIteratorImpl::~RadixDBMIteratorImpl() {
+  if (dbm_ != nullptr) {
+    std::lock_guard<std::shared_timed_mutex> lock(dbm_->mutex_);
+    dbm_->iterators_.remove(this);
+  }
+  ClearPosition();
+}
+
+Status RadixDBMIteratorImpl::First() {
+  std::shared_lock<std::shared_timed_mutex> lock(dbm_->mutex_);
+  SetPosition(GetMinRadixRecord(dbm_->root_));
+  return Status(Status::SUCCESS);
+}
+
+Status RadixDBMIteratorImpl::Last() {
+  std::shared_lock<std::shared_timed_mutex> lock(dbm_->mutex_);
+  SetPosition(GetMaxRadixRecord(dbm_->root_));
+  return Status(Status::SUCCESS);
+}
+
+Status RadixDBMIteratorImpl::Jump(std::string_view key) {
+  std::shared_lock<std::shared_timed_mutex> lock(dbm_->mutex_);
+  SetPosition(dbm_->FindGreater(dbm_->root_, key, 0, true));
+  return Status(Status::SUCCESS);
+}
+
+Status RadixDBMIteratorImpl::JumpLower(std::string_view key, bool inclusive) {
+  std::shared_lock<std::shared_timed_mutex> lock(dbm_->mutex_);
+  SetPosition(dbm_->FindLess(dbm_->root_, key, 0, inclusive));
+  return Status(Status::SUCCESS);
+}
+
+Status RadixDBMIteratorImpl::JumpUpper(std::string_view key, bool inclusive) {
+  std::shared_lock<std::shared_timed_mutex> lock(dbm_->mutex_);
+  SetPosition(dbm_->FindGreater(dbm_->root_, key, 0, inclusive));
+  return Status(Status::SUCCESS);
+}
+
+Status RadixDBMIteratorImpl::Next() {
+  std::shared_lock<std::shared_timed_mutex> lock(dbm_->mutex_);
+  if (key_ptr_ == nullptr) {
+    return Status(Status::NOT_FOUND_ERROR);
+  }
+  const std::string_view key(key_ptr_, key_size_);
+  SetPosition(dbm_->FindGreater(dbm_->root_, key, 0, false));
+  return Status(Status::SUCCESS);
+}
+
+Status RadixDBMIteratorImpl::Previous() {
+  std::shared_lock<std::shared_timed_mutex> lock(dbm_->mutex_);
+  if (key_ptr_ == nullptr) {
+    return Status(Status::NOT_FOUND_ERROR);
+  }
+  const std::string_view key(key_ptr_, key_size_);
+  SetPosition(dbm_->FindLess(dbm_->root_, key, 0, false));
+  return Status(Status::SUCCESS);
+}
+
+Status RadixDBMIteratorImpl::Process(DBM::RecordProcessor* proc, bool writable) {
+  if (writable) {
+    std::lock_guard<std::shared_timed_mutex> lock(dbm_->mutex_);
+    if (key_ptr_ == nullptr) {
+      return Status(Status::NOT_FOUND_ERROR);
+    }
+    const std::string_view key(key_ptr_, key_size_);
+    SetPosition(dbm_->FindGreater(dbm_->root_, key, 0, true));
+    if (key_ptr_ == nullptr) {
+      return Status(Status::NOT_FOUND_ERROR);
+    }
+    dbm_->ProcessImpl(std::string_view(key_ptr_, key_size_), proc, true);
+  } else {
+    std::shared_lock<std::shared_timed_mutex> lock(dbm_->mutex_);
+    if (key_ptr_ == nullptr) {
+      return Status(Status::NOT_FOUND_ERROR);
+    }
+    const std::string_view key(key_ptr_, key_size_);
+    const RadixRecord* rec = dbm_->FindGreater(dbm_->root_, key, 0, true);
+    SetPosition(rec);
+    if (rec == nullptr) {
+      return Status(Status::NOT_FOUND_ERROR);
+    }
+    proc->ProcessFull(rec->GetKey(), rec->GetValue());
+  }
+  return Status(Status::SUCCESS);
+}
+
+void RadixDBMIteratorImpl::ClearPosition() {
+  if (key_ptr_ != stack_) {
+    delete[] key_ptr_;
+  }
+  key_ptr_ = nullptr;
+  key_size_ = 0;
+}
+
+void RadixDBMIteratorImpl::SetPosition(const RadixRecord* record) {
+  ClearPosition();
+  if (record == nullptr) {
+    return;
+  }
+  const std::string_view key = record->GetKey();
+  key_ptr_ = key.size() > sizeof(stack_) ? new char[key.size()] : stack_;
+  std::memcpy(key_ptr_, key.data(), key.size());
+  key_size_ = key.size();
+}
+
+RadixDBM::RadixDBM() {
+  impl_ = new RadixDBMImpl(std::make_unique<MemoryMapParallelFile>());
+}
+
+RadixDBM::RadixDBM(std::unique_ptr<File> file) {
+  impl_ = new RadixDBMImpl(std::move(file));
+}
+
+RadixDBM::~RadixDBM() {
+  delete impl_;
+}
+
+Status RadixDBM::Open(const std::string& path, bool writable, int32_t options) {
+  return impl_->Open(path, writable, options);
+}
+
+Status RadixDBM::Close() {
+  return impl_->Close();
+}
+
+Status RadixDBM::Process(std::string_view key, RecordProcessor* proc, bool writable) {
+  assert(proc != nullptr);
+  return impl_->Process(key, proc, writable);
+}
+
+Status RadixDBM::Append(std::string_view key, std::string_view value, std::string_view delim) {
+  return impl_->Append(key, value, delim);
+}
+
+Status RadixDBM::ProcessEach(RecordProcessor* proc, bool writable) {
+  assert(proc != nullptr);
+  return impl_->ProcessEach(proc, writable);
+}
+
+Status RadixDBM::Count(int64_t* count) {
+  assert(count != nullptr);
+  return impl_->Count(count);
+}
+
+Status RadixDBM::GetFileSize(int64_t* size) {
+  assert(size != nullptr);
+  return impl_->GetFileSize(size);
+}
+
+Status RadixDBM::GetFilePath(std::string* path) {
+  assert(path != nullptr);
+  return impl_->GetFilePath(path);
+}
+
+Status RadixDBM::Clear() {
+  return impl_->Clear();
+}
+
+Status RadixDBM::Synchronize(bool hard, FileProcessor* proc) {
+  return impl_->Synchronize(hard, proc);
+}
+
+std::vector<std::pair<std::string, std::string>> RadixDBM::Inspect() {
+  return impl_->Inspect();
+}
+
+bool RadixDBM::IsOpen() const {
+  return impl_->IsOpen();
+}
+
+bool RadixDBM::IsWritable() const {
+  return impl_->IsWritable();
+}
+
+std::unique_ptr<DBM::Iterator> RadixDBM::MakeIterator() {
+  std::unique_ptr<RadixDBM::Iterator> iter(new RadixDBM::Iterator(impl_));
+  return iter;
+}
+
+std::unique_ptr<DBM> RadixDBM::MakeDBM() const {
+  return impl_->MakeDBM();
+}
+
+RadixDBM::Iterator::Iterator(RadixDBMImpl* dbm_impl) {
+  impl_ = new RadixDBMIteratorImpl(dbm_impl);
+}
+
+RadixDBM::Iterator::~Iterator() {
+  delete impl_;
+}
+
+Status RadixDBM::Iterator::First() {
+  return impl_->First();
+}
+
+Status RadixDBM::Iterator::Last() {
+  return impl_->Last();
+}
+
+Status RadixDBM::Iterator::Jump(std::string_view key) {
+  return impl_->Jump(key);
+}
+
+Status RadixDBM::Iterator::JumpLower(std::string_view key, bool inclusive) {
+  return impl_->JumpLower(key, inclusive);
+}
+
+Status RadixDBM::Iterator::JumpUpper(std::string_view key, bool inclusive) {
+  return impl_->JumpUpper(key, inclusive);
+}
+
+Status RadixDBM::Iterator::Next() {
+  return impl_->Next();
+}
+
+Status RadixDBM::Iterator::Previous() {
+  return impl_->Previous();
+}
+
+Status RadixDBM::Iterator::Process(RecordProcessor* proc, bool writable) {
+  assert(proc != nullptr);
+  return impl_->Process(proc, writable);
+}
+
+}  // namespace tkrzw
+
+// END OF FILE
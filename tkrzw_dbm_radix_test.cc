@@ -0,0 +1,286 @@
+/*************************************************************************************************
+ * Tests for tkrzw_dbm_radix.h
+ *
+ * Copyright 2020 Google LLC
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+ * except in compliance with the License.  You may obtain a copy of the License at
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software distributed under the
+ * License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied.  See the License for the specific language governing permissions
+ * and limitations under the License.
+ *************************************************************************************************/
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include "tkrzw_file.h"
+#include "tkrzw_file_mmap.h"
+#include "tkrzw_file_pos.h"
+#include "tkrzw_file_util.h"
+#include "tkrzw_dbm.h"
+#include "tkrzw_dbm_radix.h"
+#include "tkrzw_dbm_test_common.h"
+#include "tkrzw_lib_common.h"
+#include "tkrzw_str_util.h"
+#include "tkrzw_sys_config.h"
+
+using namespace testing;
+
+// Main routine
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+class RadixDBMTest : public CommonDBMTest {};
+
+TEST_F(RadixDBMTest, File) {
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string file_path = tmp_dir.MakeUniquePath();
+  tkrzw::RadixDBM dbm;
+  FileTest(&dbm, file_path);
+}
+
+TEST_F(RadixDBMTest, LargeRecord) {
+  tkrzw::RadixDBM dbm;
+  LargeRecordTest(&dbm);
+}
+
+TEST_F(RadixDBMTest, Basic) {
+  tkrzw::RadixDBM dbm;
+  BasicTest(&dbm);
+}
+
+TEST_F(RadixDBMTest, Sequence) {
+  tkrzw::RadixDBM dbm;
+  SequenceTest(&dbm);
+}
+
+TEST_F(RadixDBMTest, Append) {
+  tkrzw::RadixDBM dbm;
+  AppendTest(&dbm);
+}
+
+TEST_F(RadixDBMTest, Process) {
+  tkrzw::RadixDBM dbm;
+  ProcessTest(&dbm);
+}
+
+TEST_F(RadixDBMTest, Random) {
+  tkrzw::RadixDBM dbm;
+  RandomTest(&dbm, 1);
+}
+
+TEST_F(RadixDBMTest, RandomThread) {
+  tkrzw::RadixDBM dbm;
+  RandomTestThread(&dbm);
+}
+
+TEST_F(RadixDBMTest, RebuildRandom) {
+  tkrzw::RadixDBM dbm;
+  RebuildRandomTest(&dbm);
+}
+
+TEST_F(RadixDBMTest, RecordMigration) {
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string flat_file_path = tmp_dir.MakeUniquePath();
+  tkrzw::RadixDBM dbm;
+  tkrzw::PositionalParallelFile file;
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Open(flat_file_path, true));
+  RecordMigrationTest(&dbm, &file);
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Close());
+}
+
+TEST_F(RadixDBMTest, BackIterator) {
+  tkrzw::RadixDBM dbm;
+  BackIteratorTest(&dbm);
+}
+
+TEST_F(RadixDBMTest, IteratorBound) {
+  tkrzw::RadixDBM dbm;
+  IteratorBoundTest(&dbm);
+}
+
+TEST_F(RadixDBMTest, Iterator) {
+  tkrzw::RadixDBM dbm;
+  std::vector<std::unique_ptr<tkrzw::DBM::Iterator>> iters;
+  for (int32_t i = 1; i <= 100; i++) {
+    const std::string key = tkrzw::SPrintF("%08d", i);
+    const std::string value = tkrzw::ToString(i);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(key, value));
+    auto iter = dbm.MakeIterator();
+    EXPECT_EQ(tkrzw::Status::SUCCESS, iter->Jump(key));
+    std::string iter_key, iter_value;
+    EXPECT_EQ(tkrzw::Status::SUCCESS, iter->Get(&iter_key, &iter_value));
+    EXPECT_EQ(key, iter_key);
+    EXPECT_EQ(value, iter_value);
+    iters.emplace_back(std::move(iter));
+  }
+  EXPECT_EQ(100, dbm.CountSimple());
+  auto iter = dbm.MakeIterator();
+  EXPECT_EQ(tkrzw::Status::SUCCESS, iter->First());
+  int32_t count = 0;
+  while (true) {
+    std::string iter_key, iter_value;
+    const tkrzw::Status status = iter->Get(&iter_key, &iter_value);
+    if (status != tkrzw::Status::SUCCESS) {
+      EXPECT_EQ(tkrzw::Status::NOT_FOUND_ERROR, status);
+      break;
+    }
+    EXPECT_EQ(count + 1, tkrzw::StrToInt(iter_key));
+    EXPECT_EQ(count + 1, tkrzw::StrToInt(iter_value));
+    count++;
+    EXPECT_EQ(tkrzw::Status::SUCCESS, iter->Next());
+  }
+  EXPECT_EQ(tkrzw::Status::SUCCESS, iter->First());
+  EXPECT_EQ("00000001", iter->GetKey());
+  EXPECT_EQ("1", iter->GetValue());
+  for (int32_t i = 1; i <= 33; i++) {
+    const std::string key = tkrzw::SPrintF("%08d", i);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Remove(key));
+    std::string iter_key, iter_value;
+    EXPECT_EQ(tkrzw::Status::SUCCESS, iter->Get(&iter_key, &iter_value));
+    EXPECT_EQ(i + 1, tkrzw::StrToInt(iter_key));
+    EXPECT_EQ(i + 1, tkrzw::StrToInt(iter_value));
+  }
+  EXPECT_EQ(67, dbm.CountSimple());
+  for (int32_t i = 99; i >= 66; i--) {
+    const std::string key = tkrzw::SPrintF("%08d", i);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Remove(key));
+  }
+  EXPECT_EQ(33, dbm.CountSimple());
+  EXPECT_EQ("00000034", iter->GetKey());
+  EXPECT_EQ("34", iter->GetValue());
+  for (size_t i = 0; i < iters.size(); i++) {
+    std::string iter_key, iter_value;
+    EXPECT_EQ(tkrzw::Status::SUCCESS, iters[i]->Get(&iter_key, &iter_value));
+    if (i <= 33) {
+      EXPECT_EQ(34, tkrzw::StrToInt(iter_key));
+    } else if (i >= 65) {
+      EXPECT_EQ(100, tkrzw::StrToInt(iter_key));
+    } else {
+      EXPECT_EQ(i + 1, tkrzw::StrToInt(iter_key));
+    }
+  }
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Clear());
+  EXPECT_EQ(0, dbm.CountSimple());
+  EXPECT_EQ("*", iter->GetKey("*"));
+  EXPECT_EQ("*", iter->GetValue("*"));
+  iters.clear();
+  for (int32_t i = 0; i <= 100; i++) {
+    const std::string key = tkrzw::ToString(i * i);
+    const std::string value = tkrzw::ToString(i);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(key, value));
+    auto iter = dbm.MakeIterator();
+    EXPECT_EQ(tkrzw::Status::SUCCESS, iter->Jump(key));
+    std::string iter_key, iter_value;
+    EXPECT_EQ(tkrzw::Status::SUCCESS, iter->Get(&iter_key, &iter_value));
+    EXPECT_EQ(key, iter_key);
+    EXPECT_EQ(value, iter_value);
+    iters.emplace_back(std::move(iter));
+  }
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set("z", "zzz"));
+  for (int32_t i = 0; i <= 50; i++) {
+    const std::string key = tkrzw::ToString(i * i);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Remove(key));
+  }
+  EXPECT_EQ(51, dbm.CountSimple());
+  for (size_t i = 0; i < iters.size(); i++) {
+    std::string iter_key, iter_value;
+    EXPECT_EQ(tkrzw::Status::SUCCESS, iters[i]->Get(&iter_key, &iter_value));
+    if (i > 50) {
+      EXPECT_EQ(i * i, tkrzw::StrToInt(iter_key));
+      EXPECT_EQ(i, tkrzw::StrToInt(iter_value));
+    }
+  }
+}
+
+TEST_F(RadixDBMTest, KeyOrder) {
+  tkrzw::RadixDBM dbm;
+  std::map<std::string, std::string> model;
+  const std::vector<std::string> seeds = {
+    "", "a", "ab", "abc", "abcdefghijklmnop", "abcdefghijklmnopq", "abd", "b",
+    std::string("\x00", 1), std::string("\x00\x00", 2), std::string("a\x00", 2), "\xff",
+    "\xff\xff", "a\xff"};
+  for (const auto& seed : seeds) {
+    model.emplace(seed, seed + ":" + tkrzw::ToString(seed.size()));
+  }
+  for (int32_t i = 0; i < 300; i++) {
+    const std::string key = std::string(1, static_cast<char>(i % 256)) + "x" +
+        tkrzw::ToString(i / 7);
+    model.emplace(key, tkrzw::ToString(i));
+  }
+  for (const auto& rec : model) {
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(rec.first, rec.second));
+  }
+  EXPECT_EQ(model.size(), dbm.CountSimple());
+  for (const auto& rec : model) {
+    EXPECT_EQ(rec.second, dbm.GetSimple(rec.first));
+  }
+  auto CheckBounds = [&](const std::string& key) {
+    auto iter = dbm.MakeIterator();
+    auto it = model.lower_bound(key);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, iter->Jump(key));
+    EXPECT_EQ(it == model.end() ? "*" : it->first, iter->GetKey("*"));
+    it = model.upper_bound(key);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, iter->JumpUpper(key, false));
+    EXPECT_EQ(it == model.end() ? "*" : it->first, iter->GetKey("*"));
+    it = model.upper_bound(key);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, iter->JumpLower(key, true));
+    EXPECT_EQ(it == model.begin() ? "*" : std::prev(it)->first, iter->GetKey("*"));
+    it = model.lower_bound(key);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, iter->JumpLower(key, false));
+    EXPECT_EQ(it == model.begin() ? "*" : std::prev(it)->first, iter->GetKey("*"));
+  };
+  const std::vector<std::string> probes = {
+    "", "a", "aa", "abc", "abcd", "abcdefghij", "abcdefghijklmnopqr", "ac", "c",
+    std::string("\x00", 1), std::string("\x00\x01", 2), "\xff", "\xff\xff\xff", "zx1"};
+  auto Check = [&]() {
+    for (const auto& probe : probes) {
+      CheckBounds(probe);
+    }
+    for (const auto& rec : model) {
+      CheckBounds(rec.first);
+    }
+    auto iter = dbm.MakeIterator();
+    EXPECT_EQ(tkrzw::Status::SUCCESS, iter->First());
+    for (const auto& rec : model) {
+      EXPECT_EQ(rec.first, iter->GetKey("*"));
+      EXPECT_EQ(tkrzw::Status::SUCCESS, iter->Next());
+    }
+    EXPECT_EQ("*", iter->GetKey("*"));
+    EXPECT_EQ(tkrzw::Status::SUCCESS, iter->Last());
+    for (auto it = model.rbegin(); it != model.rend(); ++it) {
+      EXPECT_EQ(it->first, iter->GetKey("*"));
+      EXPECT_EQ(tkrzw::Status::SUCCESS, iter->Previous());
+    }
+    EXPECT_EQ("*", iter->GetKey("*"));
+  };
+  Check();
+  int32_t count = 0;
+  for (auto it = model.begin(); it != model.end();) {
+    if (count++ % 3 == 0) {
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Remove(it->first));
+      it = model.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  EXPECT_EQ(model.size(), dbm.CountSimple());
+  Check();
+  const auto meta = dbm.Inspect();
+  const std::map<std::string, std::string> meta_map(meta.begin(), meta.end());
+  EXPECT_EQ("RadixDBM", tkrzw::SearchMap(meta_map, "class", ""));
+  EXPECT_GT(tkrzw::StrToInt(tkrzw::SearchMap(meta_map, "num_node48", "0")) +
+            tkrzw::StrToInt(tkrzw::SearchMap(meta_map, "num_node256", "0")), 0);
+  for (const auto& rec : model) {
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Remove(rec.first));
+  }
+  EXPECT_EQ(0, dbm.CountSimple());
+  const auto empty_meta = dbm.Inspect();
+  const std::map<std::string, std::string> empty_meta_map(empty_meta.begin(), empty_meta.end());
+  EXPECT_EQ("0", tkrzw::SearchMap(empty_meta_map, "num_node4", ""));
+}
+
+// END OF FILE
@@ -29,10 +29,20 @@
 #include "tkrzw_lib_common.h"
 #include "tkrzw_str_util.h"
 #include "tkrzw_sys_config.h"
+#include "tkrzw_thread_util.h"
 
 namespace tkrzw {
 
-ShardDBM::ShardDBM() : dbms_(), open_(false), path_() {}
+constexpr int32_t MULTI_PARALLEL_MIN_RECORDS = 128;
+constexpr int32_t NUM_ROUTE_SLOTS = 64;
+constexpr int32_t NUM_KEY_SLOTS = 256;
+constexpr int32_t MIGRATION_BATCH_SIZE = 1000;
+
+ShardDBM::ShardDBM()
+    : dbms_(), open_(false), path_(), num_threads_(1), writable_(false), options_(0),
+      params_(), num_shards_(0), splitting_(false), split_flags_(),
+      route_mutex_(NUM_ROUTE_SLOTS), key_mutex_(NUM_KEY_SLOTS), migration_mutex_(),
+      split_mutex_() {}
 
 ShardDBM::~ShardDBM() {
   if (open_) {
@@ -67,27 +77,72 @@ Status ShardDBM::OpenAdvanced(
       num_shards = 1;
     }
   }
-  dbms_.reserve(num_shards);
-  for (int32_t i = 0; i < num_shards; i++) {
-    dbms_.emplace_back(std::make_unique<PolyDBM>());
+  bool splitting = false;
+  if (!path.empty()) {
+    const auto GetPath = [&](int32_t index, int32_t total) {
+      return StrCat(path, SPrintF("-%05d-of-%05d", index, total));
+    };
+    if (!(options & File::OPEN_TRUNCATE) && !PathIsFile(GetPath(0, num_shards))) {
+      for (int32_t split_num_shards = num_shards * 2; split_num_shards < 100000;
+           split_num_shards *= 2) {
+        if (PathIsFile(GetPath(0, split_num_shards))) {
+          num_shards = split_num_shards;
+          break;
+        }
+      }
+    }
+    if (options & File::OPEN_TRUNCATE) {
+      for (int32_t i = num_shards; i < num_shards * 2; i++) {
+        if (PathIsFile(GetPath(i, num_shards * 2))) {
+          const Status status = RemoveFile(GetPath(i, num_shards * 2));
+          if (status != Status::SUCCESS) {
+            return status;
+          }
+        }
+      }
+    } else if (PathIsFile(GetPath(num_shards, num_shards * 2))) {
+      splitting = true;
+      for (int32_t i = 0; i < num_shards; i++) {
+        if (!PathIsFile(GetPath(i, num_shards)) && PathIsFile(GetPath(i, num_shards * 2))) {
+          const Status status = RenameFile(GetPath(i, num_shards * 2), GetPath(i, num_shards));
+          if (status != Status::SUCCESS) {
+            return status;
+          }
+        }
+      }
+    }
+  }
+  int32_t num_threads = StrToInt(SearchMap(params, "num_threads", "0"));
+  if (num_threads < 1) {
+    num_threads = std::thread::hardware_concurrency();
   }
   auto mod_params = params;
   mod_params.erase("num_shards");
-  for (int32_t i = 0; i < static_cast<int32_t>(dbms_.size()); i++) {
-    std::string shard_path;
-    if (!path.empty()) {
-      shard_path = StrCat(path, SPrintF("-%05d-of-%05d", i, static_cast<int32_t>(dbms_.size())));
-    }
+  mod_params.erase("num_threads");
+  num_shards_ = num_shards;
+  splitting_ = splitting;
+  const int32_t num_dbms = splitting ? num_shards * 2 : num_shards;
+  dbms_.reserve(num_dbms);
+  for (int32_t i = 0; i < num_dbms; i++) {
+    dbms_.emplace_back(std::make_shared<PolyDBM>());
+    const std::string shard_path = path.empty() ? "" : MakeShardPath(path, i);
     const Status status = dbms_[i]->OpenAdvanced(shard_path, writable, options, mod_params);
     if (status != Status::SUCCESS) {
       for (int32_t j = i - 1; j >= 0; j--) {
         dbms_[j]->Close();
       }
+      dbms_.clear();
+      splitting_ = false;
       return status;
     }
   }
+  split_flags_ = std::vector<std::atomic_bool>(splitting ? num_shards : 0);
   open_ = true;
   path_ = path;
+  num_threads_ = std::max(num_threads, 1);
+  writable_ = writable;
+  options_ = options & ~File::OPEN_TRUNCATE;
+  params_ = mod_params;
   return Status(Status::SUCCESS);
 }
 
@@ -102,6 +157,11 @@ Status ShardDBM::Close() {
   open_ = false;
   path_.clear();
   dbms_.clear();
+  num_threads_ = 1;
+  params_.clear();
+  num_shards_ = 0;
+  splitting_ = false;
+  split_flags_.clear();
   return status;
 }
 
@@ -109,45 +169,118 @@ Status ShardDBM::Process(std::string_view key, RecordProcessor* proc, bool writa
   if (!open_) {
     return Status(Status::PRECONDITION_ERROR, "not opened database");
   }
-  const int32_t shard_index = SecondaryHash(key, dbms_.size());
-  auto dbm = dbms_[shard_index];
-  return dbm->Process(key, proc, writable);
+  return ProcessRouted(key, writable, [&](PolyDBM* dbm) {
+      return dbm->Process(key, proc, writable);
+    });
 }
 
 Status ShardDBM::Get(std::string_view key, std::string* value) {
   if (!open_) {
     return Status(Status::PRECONDITION_ERROR, "not opened database");
   }
-  const int32_t shard_index = SecondaryHash(key, dbms_.size());
-  auto dbm = dbms_[shard_index];
-  return dbm->Get(key, value);
+  return ProcessRouted(key, false, [&](PolyDBM* dbm) {
+      return dbm->Get(key, value);
+    });
 }
 
 Status ShardDBM::Set(std::string_view key, std::string_view value, bool overwrite) {
   if (!open_) {
     return Status(Status::PRECONDITION_ERROR, "not opened database");
   }
-  const int32_t shard_index = SecondaryHash(key, dbms_.size());
-  auto dbm = dbms_[shard_index];
-  return dbm->Set(key, value, overwrite);
+  return ProcessRouted(key, true, [&](PolyDBM* dbm) {
+      return dbm->Set(key, value, overwrite);
+    });
 }
 
 Status ShardDBM::Remove(std::string_view key) {
   if (!open_) {
     return Status(Status::PRECONDITION_ERROR, "not opened database");
   }
-  const int32_t shard_index = SecondaryHash(key, dbms_.size());
-  auto dbm = dbms_[shard_index];
-  return dbm->Remove(key);
+  return ProcessRouted(key, true, [&](PolyDBM* dbm) {
+      return dbm->Remove(key);
+    });
 }
 
 Status ShardDBM::Append(std::string_view key, std::string_view value, std::string_view delim) {
   if (!open_) {
     return Status(Status::PRECONDITION_ERROR, "not opened database");
   }
-  const int32_t shard_index = SecondaryHash(key, dbms_.size());
-  auto dbm = dbms_[shard_index];
-  return dbm->Append(key, value, delim);
+  return ProcessRouted(key, true, [&](PolyDBM* dbm) {
+      return dbm->Append(key, value, delim);
+    });
+}
+
+std::map<std::string, std::string> ShardDBM::GetMulti(
+    const std::initializer_list<std::string>& keys) {
+  return GetMulti(std::vector<std::string>(keys.begin(), keys.end()));
+}
+
+std::map<std::string, std::string> ShardDBM::GetMulti(const std::vector<std::string>& keys) {
+  std::map<std::string, std::string> records;
+  if (!open_) {
+    return records;
+  }
+  {
+    ScopedSlottedLock route_lock(route_mutex_, 0, false);
+    if (!splitting_) {
+      const int32_t num_shards = dbms_.size();
+      std::vector<std::vector<std::string>> shard_keys(num_shards);
+      for (const auto& key : keys) {
+        shard_keys[SecondaryHash(key, num_shards)].emplace_back(key);
+      }
+      std::vector<std::map<std::string, std::string>> shard_records(num_shards);
+      const int32_t num_threads =
+          static_cast<int32_t>(keys.size()) < MULTI_PARALLEL_MIN_RECORDS ? 1 : num_threads_;
+      ParallelFor(num_shards, num_threads, [&](int32_t index) {
+        if (!shard_keys[index].empty()) {
+          shard_records[index] = dbms_[index]->GetMulti(shard_keys[index]);
+        }
+      });
+      for (auto& single_records : shard_records) {
+        records.merge(single_records);
+      }
+      return records;
+    }
+  }
+  return ParamDBM::GetMulti(keys);
+}
+
+Status ShardDBM::SetMulti(
+    const std::initializer_list<std::pair<std::string, std::string>>& records,
+    bool overwrite) {
+  return SetMulti(std::map<std::string, std::string>(records.begin(), records.end()), overwrite);
+}
+
+Status ShardDBM::SetMulti(const std::map<std::string, std::string>& records, bool overwrite) {
+  if (!open_) {
+    return Status(Status::PRECONDITION_ERROR, "not opened database");
+  }
+  {
+    ScopedSlottedLock route_lock(route_mutex_, 0, false);
+    if (!splitting_) {
+      const int32_t num_shards = dbms_.size();
+      std::vector<std::map<std::string, std::string>> shard_records(num_shards);
+      for (const auto& record : records) {
+        auto& single_records = shard_records[SecondaryHash(record.first, num_shards)];
+        single_records.emplace_hint(single_records.end(), record);
+      }
+      std::vector<Status> statuses(num_shards, Status(Status::SUCCESS));
+      const int32_t num_threads =
+          static_cast<int32_t>(records.size()) < MULTI_PARALLEL_MIN_RECORDS ? 1 : num_threads_;
+      ParallelFor(num_shards, num_threads, [&](int32_t index) {
+        if (!shard_records[index].empty()) {
+          statuses[index] = dbms_[index]->SetMulti(shard_records[index], overwrite);
+        }
+      });
+      for (const auto& status : statuses) {
+        if (status != Status::SUCCESS) {
+          return status;
+        }
+      }
+      return Status(Status::SUCCESS);
+    }
+  }
+  return ParamDBM::SetMulti(records, overwrite);
 }
 
 Status ShardDBM::ProcessEach(RecordProcessor* proc, bool writable) {
@@ -156,16 +289,32 @@ Status ShardDBM::ProcessEach(RecordProcessor* proc, bool writable) {
   }
   class ProxyProcessor final : public DBM::RecordProcessor {
    public:
-    explicit ProxyProcessor(DBM::RecordProcessor* proc) : proc_(proc) {}
+    ProxyProcessor(DBM::RecordProcessor* proc, std::mutex* mutex)
+        : proc_(proc), mutex_(mutex), value_() {}
     std::string_view ProcessFull(std::string_view key, std::string_view value) override {
-      return proc_->ProcessFull(key, value);
+      std::lock_guard<std::mutex> lock(*mutex_);
+      const std::string_view new_value = proc_->ProcessFull(key, value);
+      if (new_value.data() == NOOP.data() || new_value.data() == REMOVE.data()) {
+        return new_value;
+      }
+      value_ = new_value;
+      return value_;
     }
    private:
     DBM::RecordProcessor* proc_;
-  } proxy(proc);
+    std::mutex* mutex_;
+    std::string value_;
+  };
+  ScopedSlottedLock route_lock(route_mutex_, 0, false);
+  const auto migration_lock = ExcludeMigration();
   proc->ProcessEmpty(DBM::RecordProcessor::NOOP);
-  for (auto& dbm : dbms_) {
-    const Status status = dbm->ProcessEach(&proxy, writable);
+  std::mutex mutex;
+  std::vector<Status> statuses(dbms_.size(), Status(Status::SUCCESS));
+  ParallelFor(dbms_.size(), num_threads_, [&](int32_t index) {
+    ProxyProcessor proxy(proc, &mutex);
+    statuses[index] = dbms_[index]->ProcessEach(&proxy, writable);
+  });
+  for (const auto& status : statuses) {
     if (status != Status::SUCCESS) {
       return status;
     }
@@ -178,14 +327,19 @@ Status ShardDBM::Count(int64_t* count) {
   if (!open_) {
     return Status(Status::PRECONDITION_ERROR, "not opened database");
   }
+  ScopedSlottedLock route_lock(route_mutex_, 0, false);
+  const auto migration_lock = ExcludeMigration();
+  std::vector<int64_t> counts(dbms_.size(), 0);
+  std::vector<Status> statuses(dbms_.size(), Status(Status::SUCCESS));
+  ParallelFor(dbms_.size(), num_threads_, [&](int32_t index) {
+    statuses[index] = dbms_[index]->Count(&counts[index]);
+  });
   *count = 0;
-  for (auto dbm : dbms_) {
-    int64_t single_count = 0;
-    const Status status = dbm->Count(&single_count);
-    if (status != Status::SUCCESS) {
-      return status;
+  for (int32_t i = 0; i < static_cast<int32_t>(dbms_.size()); i++) {
+    if (statuses[i] != Status::SUCCESS) {
+      return statuses[i];
     }
-    *count += single_count;
+    *count += counts[i];
   }
   return Status(Status::SUCCESS);
 }
@@ -194,14 +348,18 @@ Status ShardDBM::GetFileSize(int64_t* size) {
   if (!open_) {
     return Status(Status::PRECONDITION_ERROR, "not opened database");
   }
+  ScopedSlottedLock route_lock(route_mutex_, 0, false);
+  std::vector<int64_t> sizes(dbms_.size(), 0);
+  std::vector<Status> statuses(dbms_.size(), Status(Status::SUCCESS));
+  ParallelFor(dbms_.size(), num_threads_, [&](int32_t index) {
+    statuses[index] = dbms_[index]->GetFileSize(&sizes[index]);
+  });
   *size = 0;
-  for (auto dbm : dbms_) {
-    int64_t single_size = 0;
-    const Status status = dbm->GetFileSize(&single_size);
-    if (status != Status::SUCCESS) {
-      return status;
+  for (int32_t i = 0; i < static_cast<int32_t>(dbms_.size()); i++) {
+    if (statuses[i] != Status::SUCCESS) {
+      return statuses[i];
     }
-    *size += single_size;
+    *size += sizes[i];
   }
   return Status(Status::SUCCESS);
 }
@@ -218,9 +376,15 @@ Status ShardDBM::Clear() {
   if (!open_) {
     return Status(Status::PRECONDITION_ERROR, "not opened database");
   }
+  ScopedSlottedLock route_lock(route_mutex_, 0, false);
+  const auto migration_lock = ExcludeMigration();
+  std::vector<Status> statuses(dbms_.size(), Status(Status::SUCCESS));
+  ParallelFor(dbms_.size(), num_threads_, [&](int32_t index) {
+    statuses[index] = dbms_[index]->Clear();
+  });
   Status status(Status::SUCCESS);
-  for (auto& dbm : dbms_) {
-    status |= dbm->Clear();
+  for (const auto& single_status : statuses) {
+    status |= single_status;
   }
   return status;
 }
@@ -229,9 +393,14 @@ Status ShardDBM::RebuildAdvanced(const std::map<std::string, std::string>& param
   if (!open_) {
     return Status(Status::PRECONDITION_ERROR, "not opened database");
   }
+  ScopedSlottedLock route_lock(route_mutex_, 0, false);
+  std::vector<Status> statuses(dbms_.size(), Status(Status::SUCCESS));
+  ParallelFor(dbms_.size(), num_threads_, [&](int32_t index) {
+    statuses[index] = dbms_[index]->RebuildAdvanced(params);
+  });
   Status status(Status::SUCCESS);
-  for (auto& dbm : dbms_) {
-    status |= dbm->RebuildAdvanced(params);
+  for (const auto& single_status : statuses) {
+    status |= single_status;
   }
   return status;
 }
@@ -240,6 +409,7 @@ Status ShardDBM::ShouldBeRebuilt(bool* tobe) {
   if (!open_) {
     return Status(Status::PRECONDITION_ERROR, "not opened database");
   }
+  ScopedSlottedLock route_lock(route_mutex_, 0, false);
   *tobe = false;
   for (auto& dbm : dbms_) {
     bool single_tobe = false;
@@ -259,9 +429,27 @@ Status ShardDBM::SynchronizeAdvanced(
   if (!open_) {
     return Status(Status::PRECONDITION_ERROR, "not opened database");
   }
+  class ProxyProcessor final : public DBM::FileProcessor {
+   public:
+    explicit ProxyProcessor(DBM::FileProcessor* proc) : proc_(proc), mutex_() {}
+    void Process(const std::string& path) override {
+      std::lock_guard<std::mutex> lock(mutex_);
+      proc_->Process(path);
+    }
+   private:
+    DBM::FileProcessor* proc_;
+    std::mutex mutex_;
+  } proxy(proc);
+  ScopedSlottedLock route_lock(route_mutex_, 0, false);
+  const auto migration_lock = ExcludeMigration();
+  std::vector<Status> statuses(dbms_.size(), Status(Status::SUCCESS));
+  ParallelFor(dbms_.size(), num_threads_, [&](int32_t index) {
+    statuses[index] = dbms_[index]->SynchronizeAdvanced(
+        hard, proc == nullptr ? nullptr : &proxy, params);
+  });
   Status status(Status::SUCCESS);
-  for (auto& dbm : dbms_) {
-    status |= dbm->SynchronizeAdvanced(hard, proc, params);
+  for (const auto& single_status : statuses) {
+    status |= single_status;
   }
   return status;
 }
@@ -270,10 +458,13 @@ Status ShardDBM::CopyFile(const std::string& dest_path) {
   if (!open_) {
     return Status(Status::PRECONDITION_ERROR, "not opened database");
   }
-  for (int32_t i = 0; i < static_cast<int32_t>(dbms_.size()); i++) {
-    const std::string shard_path = StrCat(dest_path, SPrintF(
-        "-%05d-of-%05d", i, static_cast<int32_t>(dbms_.size())));
-    const Status status = dbms_[i]->CopyFile(shard_path);
+  ScopedSlottedLock route_lock(route_mutex_, 0, false);
+  const auto migration_lock = ExcludeMigration();
+  std::vector<Status> statuses(dbms_.size(), Status(Status::SUCCESS));
+  ParallelFor(dbms_.size(), num_threads_, [&](int32_t index) {
+    statuses[index] = dbms_[index]->CopyFile(MakeShardPath(dest_path, index));
+  });
+  for (const auto& status : statuses) {
     if (status != Status::SUCCESS) {
       return status;
     }
@@ -281,11 +472,65 @@ Status ShardDBM::CopyFile(const std::string& dest_path) {
   return Status(Status::SUCCESS);
 }
 
+Status ShardDBM::SplitShards() {
+  if (!open_) {
+    return Status(Status::PRECONDITION_ERROR, "not opened database");
+  }
+  if (!writable_) {
+    return Status(Status::PRECONDITION_ERROR, "not writable database");
+  }
+  std::unique_lock<std::mutex> split_lock(split_mutex_, std::try_to_lock);
+  if (!split_lock.owns_lock()) {
+    return Status(Status::PRECONDITION_ERROR, "splitting shards in progress");
+  }
+  if (!splitting_) {
+    const int32_t num_shards = dbms_.size();
+    std::vector<std::shared_ptr<PolyDBM>> new_dbms;
+    std::vector<std::string> new_paths;
+    for (int32_t i = num_shards; i < num_shards * 2; i++) {
+      std::string shard_path;
+      if (!path_.empty()) {
+        shard_path = StrCat(path_, SPrintF("-%05d-of-%05d", i, num_shards * 2));
+      }
+      auto dbm = std::make_shared<PolyDBM>();
+      const Status status = dbm->OpenAdvanced(
+          shard_path, true, options_ | File::OPEN_TRUNCATE, params_);
+      if (status != Status::SUCCESS) {
+        for (size_t j = 0; j < new_dbms.size(); j++) {
+          new_dbms[j]->Close();
+          if (!new_paths[j].empty()) {
+            RemoveFile(new_paths[j]);
+          }
+        }
+        return status;
+      }
+      new_dbms.emplace_back(dbm);
+      new_paths.emplace_back(shard_path);
+    }
+    ScopedSlottedLock route_lock(route_mutex_, -1, true);
+    dbms_.insert(dbms_.end(), new_dbms.begin(), new_dbms.end());
+    split_flags_ = std::vector<std::atomic_bool>(num_shards);
+    num_shards_ = num_shards;
+    splitting_ = true;
+  }
+  for (int32_t i = 0; i < num_shards_; i++) {
+    if (!split_flags_[i].load()) {
+      const Status status = MigrateShard(i);
+      if (status != Status::SUCCESS) {
+        return status;
+      }
+      split_flags_[i].store(true);
+    }
+  }
+  return FinishSplit();
+}
+
 std::vector<std::pair<std::string, std::string>> ShardDBM::Inspect() {
   std::vector<std::pair<std::string, std::string>> merged;
   if (!open_) {
     return merged;
   }
+  ScopedSlottedLock route_lock(route_mutex_, 0, false);
   std::string class_name = "ShardDBM";
   for (const auto& rec : dbms_.front()->Inspect()) {
     if (rec.first == "class") {
@@ -307,6 +552,16 @@ std::vector<std::pair<std::string, std::string>> ShardDBM::Inspect() {
   merged.emplace_back(std::make_pair("num_records", ToString(num_records)));
   merged.emplace_back(std::make_pair("file_size", ToString(file_size)));
   merged.emplace_back(std::make_pair("path", path_));
+  merged.emplace_back(std::make_pair("num_shards", ToString(dbms_.size())));
+  if (splitting_) {
+    int32_t num_split_shards = 0;
+    for (const auto& split_flag : split_flags_) {
+      if (split_flag.load()) {
+        num_split_shards++;
+      }
+    }
+    merged.emplace_back(std::make_pair("num_split_shards", ToString(num_split_shards)));
+  }
   for (int32_t i = 0; i < static_cast<int32_t>(dbms_.size()); i++) {
     for (const auto& rec : dbms_[i]->Inspect()) {
       const std::string& name = SPrintF("%05d-%s", i, rec.first.c_str());
@@ -324,6 +579,7 @@ bool ShardDBM::IsWritable() const {
   if (!open_) {
     return false;
   }
+  ScopedSlottedLock route_lock(route_mutex_, 0, false);
   return dbms_.front()->IsWritable();
 }
 
@@ -331,6 +587,7 @@ bool ShardDBM::IsHealthy() const {
   if (!open_) {
     return false;
   }
+  ScopedSlottedLock route_lock(route_mutex_, 0, false);
   for (const auto& dbm : dbms_) {
     if (!dbm->IsHealthy()) {
       return false;
@@ -343,10 +600,12 @@ bool ShardDBM::IsOrdered() const {
   if (!open_) {
     return false;
   }
+  ScopedSlottedLock route_lock(route_mutex_, 0, false);
   return dbms_.front()->IsOrdered();
 }
 
 std::unique_ptr<DBM::Iterator> ShardDBM::MakeIterator() {
+  ScopedSlottedLock route_lock(route_mutex_, 0, false);
   std::unique_ptr<ShardDBM::Iterator> iter(new Iterator(&dbms_));
   return iter;
 }
@@ -359,9 +618,142 @@ DBM* ShardDBM::GetInternalDBM() const {
   if (!open_) {
     return nullptr;
   }
+  ScopedSlottedLock route_lock(route_mutex_, 0, false);
   return dbms_.front()->GetInternalDBM();
 }
 
+Status ShardDBM::ProcessRouted(
+    std::string_view key, bool writable, const std::function<Status(PolyDBM*)>& op) {
+  ScopedSlottedLock route_lock(route_mutex_, PrimaryHash(key, NUM_ROUTE_SLOTS), false);
+  if (!splitting_) {
+    return op(dbms_[SecondaryHash(key, dbms_.size())].get());
+  }
+  const int32_t old_index = SecondaryHash(key, num_shards_);
+  const int32_t new_index = SecondaryHash(key, num_shards_ * 2);
+  if (new_index == old_index || split_flags_[old_index].load()) {
+    return op(dbms_[new_index].get());
+  }
+  PolyDBM* old_dbm = dbms_[old_index].get();
+  PolyDBM* new_dbm = dbms_[new_index].get();
+  if (writable) {
+    std::shared_lock<std::shared_timed_mutex> migration_lock(migration_mutex_);
+    ScopedSlottedLock key_lock(key_mutex_, PrimaryHash(key, NUM_KEY_SLOTS), true);
+    const Status status = MoveRecord(key, old_dbm, new_dbm);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+    return op(new_dbm);
+  }
+  ScopedSlottedLock key_lock(key_mutex_, PrimaryHash(key, NUM_KEY_SLOTS), false);
+  return op(old_dbm->Get(key) == Status::SUCCESS ? old_dbm : new_dbm);
+}
+
+Status ShardDBM::MoveRecord(std::string_view key, PolyDBM* src_dbm, PolyDBM* dest_dbm) {
+  std::string value;
+  Status status = src_dbm->Get(key, &value);
+  if (status != Status::SUCCESS) {
+    return status == Status::NOT_FOUND_ERROR ? Status(Status::SUCCESS) : status;
+  }
+  status = dest_dbm->Set(key, value);
+  if (status != Status::SUCCESS) {
+    return status;
+  }
+  status = src_dbm->Remove(key);
+  return status == Status::NOT_FOUND_ERROR ? Status(Status::SUCCESS) : status;
+}
+
+Status ShardDBM::MigrateShard(int32_t index) {
+  class KeyCollector final : public DBM::RecordProcessor {
+   public:
+    KeyCollector(int32_t index, int32_t num_shards, std::vector<std::string>* keys)
+        : index_(index), num_shards_(num_shards), keys_(keys) {}
+    std::string_view ProcessFull(std::string_view key, std::string_view value) override {
+      if (static_cast<int32_t>(SecondaryHash(key, num_shards_)) != index_) {
+        keys_->emplace_back(key);
+      }
+      return NOOP;
+    }
+   private:
+    int32_t index_;
+    int32_t num_shards_;
+    std::vector<std::string>* keys_;
+  };
+  PolyDBM* old_dbm = dbms_[index].get();
+  std::vector<std::string> keys;
+  KeyCollector collector(index, num_shards_ * 2, &keys);
+  Status status = old_dbm->ProcessEach(&collector, false);
+  if (status != Status::SUCCESS) {
+    return status;
+  }
+  for (size_t batch_begin = 0; batch_begin < keys.size();
+       batch_begin += MIGRATION_BATCH_SIZE) {
+    const size_t batch_end = std::min(keys.size(), batch_begin + MIGRATION_BATCH_SIZE);
+    std::shared_lock<std::shared_timed_mutex> migration_lock(migration_mutex_);
+    for (size_t i = batch_begin; i < batch_end; i++) {
+      const std::string& key = keys[i];
+      PolyDBM* new_dbm = dbms_[SecondaryHash(key, num_shards_ * 2)].get();
+      ScopedSlottedLock key_lock(key_mutex_, PrimaryHash(key, NUM_KEY_SLOTS), true);
+      status = MoveRecord(key, old_dbm, new_dbm);
+      if (status != Status::SUCCESS) {
+        return status;
+      }
+    }
+  }
+  return Status(Status::SUCCESS);
+}
+
+Status ShardDBM::FinishSplit() {
+  ScopedSlottedLock route_lock(route_mutex_, -1, true);
+  if (!path_.empty()) {
+    const int32_t num_shards = num_shards_ * 2;
+    for (int32_t i = num_shards_ - 1; i >= 0; i--) {
+      std::string old_path;
+      Status status = dbms_[i]->GetFilePath(&old_path);
+      if (status != Status::SUCCESS) {
+        return status;
+      }
+      const std::string new_path = StrCat(path_, SPrintF("-%05d-of-%05d", i, num_shards));
+      status = dbms_[i]->Close();
+      bool renamed = false;
+      if (status == Status::SUCCESS) {
+        status = RenameFile(old_path, new_path);
+        renamed = status == Status::SUCCESS;
+      }
+      auto dbm = std::make_shared<PolyDBM>();
+      const Status open_status =
+          dbm->OpenAdvanced(renamed ? new_path : old_path, writable_, options_, params_);
+      if (open_status != Status::SUCCESS) {
+        for (auto& other_dbm : dbms_) {
+          if (other_dbm->IsOpen()) {
+            other_dbm->Close();
+          }
+        }
+        return status == Status::SUCCESS ? open_status : status;
+      }
+      dbms_[i] = dbm;
+      if (status != Status::SUCCESS) {
+        return status;
+      }
+    }
+  }
+  num_shards_ *= 2;
+  splitting_ = false;
+  split_flags_.clear();
+  return Status(Status::SUCCESS);
+}
+
+std::unique_lock<std::shared_timed_mutex> ShardDBM::ExcludeMigration() {
+  if (!splitting_) {
+    return std::unique_lock<std::shared_timed_mutex>();
+  }
+  return std::unique_lock<std::shared_timed_mutex>(migration_mutex_);
+}
+
+std::string ShardDBM::MakeShardPath(const std::string& prefix, int32_t index) const {
+  const int32_t num_shards = splitting_ && index >= num_shards_ ? num_shards_ * 2 : num_shards_;
+  return StrCat(prefix, SPrintF("-%05d-of-%05d", index, num_shards));
+}
+
 ShardDBM::Iterator::Iterator(std::vector<std::shared_ptr<PolyDBM>>* dbms)
     : slots_(), heap_(), comp_(nullptr), asc_(false) {
   slots_.resize(dbms->size());
@@ -369,10 +761,10 @@ ShardDBM::Iterator::Iterator(std::vector<std::shared_ptr<PolyDBM>>* dbms)
     slots_[i].iter = (*dbms)[i]->MakeIterator().release();
   }
   const auto* dbm = dbms->front()->GetInternalDBM();
-  if (typeid(*dbm) == typeid(TreeDBM)) {
+  if (dbm != nullptr && typeid(*dbm) == typeid(TreeDBM)) {
     comp_ = dynamic_cast<const TreeDBM*>(dbm)->GetKeyComparator();
   }
-  if (typeid(*dbm) == typeid(BabyDBM)) {
+  if (dbm != nullptr && typeid(*dbm) == typeid(BabyDBM)) {
     comp_ = dynamic_cast<const BabyDBM*>(dbm)->GetKeyComparator();
   }
   if (comp_ == nullptr) {
@@ -389,6 +781,9 @@ ShardDBM::Iterator::~Iterator() {
 Status ShardDBM::Iterator::First() {
   heap_.clear();
   for (auto& slot : slots_) {
+    if (slot.iter == nullptr) {
+      return Status(Status::PRECONDITION_ERROR, "not opened database");
+    }
     const Status status = slot.iter->First();
     if (status != Status::SUCCESS) {
       return status;
@@ -411,6 +806,9 @@ Status ShardDBM::Iterator::First() {
 Status ShardDBM::Iterator::Last() {
   heap_.clear();
   for (auto& slot : slots_) {
+    if (slot.iter == nullptr) {
+      return Status(Status::PRECONDITION_ERROR, "not opened database");
+    }
     const Status status = slot.iter->Last();
     if (status != Status::SUCCESS) {
       return status;
@@ -433,6 +831,9 @@ Status ShardDBM::Iterator::Last() {
 Status ShardDBM::Iterator::Jump(std::string_view key) {
   heap_.clear();
   for (auto& slot : slots_) {
+    if (slot.iter == nullptr) {
+      return Status(Status::PRECONDITION_ERROR, "not opened database");
+    }
     Status status = slot.iter->Jump(key);
     if (status != Status::SUCCESS) {
       if (status != Status::NOT_FOUND_ERROR) {
@@ -456,6 +857,9 @@ Status ShardDBM::Iterator::Jump(std::string_view key) {
 Status ShardDBM::Iterator::JumpLower(std::string_view key, bool inclusive) {
   heap_.clear();
   for (auto& slot : slots_) {
+    if (slot.iter == nullptr) {
+      return Status(Status::PRECONDITION_ERROR, "not opened database");
+    }
     Status status = slot.iter->JumpLower(key, inclusive);
     if (status != Status::SUCCESS) {
       if (status != Status::NOT_FOUND_ERROR) {
@@ -479,6 +883,9 @@ Status ShardDBM::Iterator::JumpLower(std::string_view key, bool inclusive) {
 Status ShardDBM::Iterator::JumpUpper(std::string_view key, bool inclusive) {
   heap_.clear();
   for (auto& slot : slots_) {
+    if (slot.iter == nullptr) {
+      return Status(Status::PRECONDITION_ERROR, "not opened database");
+    }
     Status status = slot.iter->JumpUpper(key, inclusive);
     if (status != Status::SUCCESS) {
       if (status != Status::NOT_FOUND_ERROR) {
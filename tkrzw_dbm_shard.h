@@ -14,8 +14,13 @@
 #ifndef _TKRZW_DBM_SHARD_H
 #define _TKRZW_DBM_SHARD_H
 
+#include <atomic>
+#include <functional>
+#include <initializer_list>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -29,6 +34,7 @@
 #include "tkrzw_lib_common.h"
 #include "tkrzw_dbm_poly.h"
 #include "tkrzw_str_util.h"
+#include "tkrzw_thread_util.h"
 
 namespace tkrzw {
 
@@ -246,7 +252,10 @@ class ShardDBM final : public ParamDBM {
    * Moreover, the parameter "num_shards" specifies the number of shards.  Each shard file has a
    * suffix like "-00003-of-00015".  If the number of shards is not specified and existing files
    * match the path, it is implicitly specified.  If there are no matching files, 1 is implicitly
-   * set.
+   * set.  If the files have been split into more shards than specified, the number of the split
+   * files is used.  The parameter "num_threads" specifies the maximum number of threads to process the
+   * shards concurrently in operations on the whole database, such as Synchronize and Rebuild.
+   * If it is not specified, the number of hardware threads is set.
    * @return The result status.
    */
   Status OpenAdvanced(const std::string& path, bool writable,
@@ -308,6 +317,49 @@ class ShardDBM final : public ParamDBM {
   Status Append(
       std::string_view key, std::string_view value, std::string_view delim = "") override;
 
+  /**
+   * Gets the values of multiple records of keys.
+   * @param keys The keys of records to retrieve.
+   * @return A map of retrieved records.  Keys which don't match existing records are ignored.
+   */
+  std::map<std::string, std::string> GetMulti(
+      const std::initializer_list<std::string>& keys) override;
+
+  /**
+   * Gets the values of multiple records of keys, with a vector.
+   * @param keys The keys of records to retrieve.
+   * @return A map of retrieved records.  Keys which don't match existing records are ignored.
+   * @details The keys are grouped by the shard and each group is retrieved by the GetMulti
+   * method of the shard.  If there are many keys, the groups are processed concurrently.
+   */
+  std::map<std::string, std::string> GetMulti(const std::vector<std::string>& keys) override;
+
+  /**
+   * Sets multiple records.
+   * @param records The records to store.
+   * @param overwrite Whether to overwrite the existing value if there's a record with the same
+   * key.  If true, the existing value is overwritten by the new value.  If false, the operation
+   * is given up and an error status is returned.
+   * @return The result status.
+   */
+  Status SetMulti(
+      const std::initializer_list<std::pair<std::string, std::string>>& records,
+      bool overwrite = true) override;
+
+  /**
+   * Sets multiple records, with a map of strings.
+   * @param records The records to store.
+   * @param overwrite Whether to overwrite the existing value if there's a record with the same
+   * key.  If true, the existing value is overwritten by the new value.  If false, the operation
+   * is given up and an error status is returned.
+   * @return The result status.
+   * @details The records are grouped by the shard and each group is stored by the SetMulti
+   * method of the shard.  If there are many records, the groups are processed concurrently.
+   * Then, on failure, records of other groups may have been stored.
+   */
+  Status SetMulti(
+      const std::map<std::string, std::string>& records, bool overwrite = true) override;
+
   /**
    * Processes each and every record in the database with a processor.
    * @param proc The pointer to the processor object.
@@ -315,7 +367,8 @@ class ShardDBM final : public ParamDBM {
    * @return The result status.
    * @details The ProcessFull of the processor is called repeatedly for each record.  The
    * ProcessEmpty of the processor is called once before the iteration and once after the
-   * iteration.
+   * iteration.  The shards are iterated concurrently, but calls of the processor are
+   * serialized.  Thus, the order of records is not guaranteed.
    */
   Status ProcessEach(RecordProcessor* proc, bool writable) override;
 
@@ -404,6 +457,24 @@ class ShardDBM final : public ParamDBM {
    */
   Status CopyFile(const std::string& dest_path) override;
 
+  /**
+   * Doubles the number of shards while the database is in use.
+   * @return The result status.
+   * @details Given the current number of shards N, N new shards are added and each record in
+   * the shard of the index i moves to the shard of the index i or i + N, which is determined by
+   * the hash value of the key.  Other threads can access the database during the migration.
+   * Operations on a record which has not moved yet check both the old shard and the new shard.
+   * This method blocks until all records have moved.  So, it should be called by a background
+   * thread.  At the end, files of the old shards are closed and renamed to have the new suffix,
+   * which blocks other operations for a while.  Iterators made before the end must not be used
+   * after that.  If the process crashes during the migration, opening the database resumes the
+   * state and calling this method again finishes the migration.  If a shard file cannot be
+   * renamed, the shard is reopened with the old name and calling this method again retries.  If
+   * it cannot be reopened either, all shards are closed and operations fail until the database
+   * is closed and opened again, which resumes the state.
+   */
+  Status SplitShards();
+
   /**
    * Inspects the database.
    * @return A vector of pairs of a property name and its value.
@@ -473,6 +544,75 @@ class ShardDBM final : public ParamDBM {
   bool open_;
   /** The stem name of the file paths of the internal databases. */
   std::string path_;
+  /** The maximum number of threads to process the shards concurrently. */
+  int32_t num_threads_;
+  /** Whether the internal databases are writable. */
+  bool writable_;
+  /** The options to open the internal databases. */
+  int32_t options_;
+  /** The parameters to open the internal databases. */
+  std::map<std::string, std::string> params_;
+  /** The number of shards, which is that before the split while splitting. */
+  int32_t num_shards_;
+  /** Whether shards are being split. */
+  bool splitting_;
+  /** Whether each of the old shards has been split. */
+  std::vector<std::atomic_bool> split_flags_;
+  /** The mutex to protect the routing of keys. */
+  mutable SlottedMutex route_mutex_;
+  /** The mutex to serialize accesses to records which are moving. */
+  SlottedMutex key_mutex_;
+  /** The mutex to exclude whole-database operations while records are moving. */
+  std::shared_timed_mutex migration_mutex_;
+  /** The mutex to serialize calls of SplitShards. */
+  std::mutex split_mutex_;
+
+  /**
+   * Calls an operation on the shard which owns a key.
+   * @param key The key of the record.
+   * @param writable True if the operation can edit the record.
+   * @param op The operation to call with the shard.
+   * @return The result status of the operation.
+   */
+  Status ProcessRouted(
+      std::string_view key, bool writable, const std::function<Status(PolyDBM*)>& op);
+
+  /**
+   * Moves a record from a shard to another.
+   * @param key The key of the record.
+   * @param src_dbm The source shard.
+   * @param dest_dbm The destination shard.
+   * @return The result status.
+   */
+  static Status MoveRecord(std::string_view key, PolyDBM* src_dbm, PolyDBM* dest_dbm);
+
+  /**
+   * Moves records which belong to the new shard from an old shard.
+   * @param index The index of the old shard.
+   * @return The result status.
+   */
+  Status MigrateShard(int32_t index);
+
+  /**
+   * Finishes splitting shards by renaming the files of the old shards.
+   * @return The result status.
+   */
+  Status FinishSplit();
+
+  /**
+   * Excludes moves of records from whole-database operations while splitting.
+   * @return The lock, which owns the migration mutex only while splitting.
+   * @details This must be called while the route mutex is locked.
+   */
+  std::unique_lock<std::shared_timed_mutex> ExcludeMigration();
+
+  /**
+   * Makes the path of a shard file.
+   * @param prefix The path prefix.
+   * @param index The index of the shard.
+   * @return The path of the shard file.
+   */
+  std::string MakeShardPath(const std::string& prefix, int32_t index) const;
 };
 
 }  // namespace tkrzw
@@ -269,4 +269,345 @@ TEST_F(ShardDBMTest, IteratorBound) {
   }
 }
 
+TEST_F(ShardDBMTest, ParallelFanOut) {
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string path = tkrzw::JoinPath(tmp_dir.Path(), "casket.tkh");
+  const std::string copy_path = tkrzw::JoinPath(tmp_dir.Path(), "casket-copy.tkh");
+  tkrzw::ShardDBM dbm;
+  const std::map<std::string, std::string> open_params = {
+    {"num_shards", "8"}, {"num_threads", "4"}, {"num_buckets", "100"}};
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.OpenAdvanced(
+      path, true, tkrzw::File::OPEN_TRUNCATE, open_params));
+  for (int32_t i = 0; i < 1000; i++) {
+    const std::string expr = tkrzw::ToString(i);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(expr, expr));
+  }
+  EXPECT_EQ(1000, dbm.CountSimple());
+  EXPECT_GT(dbm.GetFileSizeSimple(), 0);
+  class Counter final : public tkrzw::DBM::RecordProcessor {
+   public:
+    std::string_view ProcessFull(std::string_view key, std::string_view value) override {
+      count_++;
+      if (tkrzw::StrToInt(key) % 2 == 0) {
+        new_value_ = tkrzw::StrCat(value, ":", count_);
+        return new_value_;
+      }
+      return NOOP;
+    }
+    int32_t count_ = 0;
+    std::string new_value_;
+  } counter;
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.ProcessEach(&counter, true));
+  EXPECT_EQ(1000, counter.count_);
+  for (int32_t i = 0; i < 1000; i++) {
+    const std::string expr = tkrzw::ToString(i);
+    const std::string value = dbm.GetSimple(expr);
+    if (i % 2 == 0) {
+      EXPECT_TRUE(tkrzw::StrBeginsWith(value, expr + ":"));
+    } else {
+      EXPECT_EQ(expr, value);
+    }
+  }
+  class PathCollector final : public tkrzw::DBM::FileProcessor {
+   public:
+    void Process(const std::string& path) override {
+      paths_.emplace(path);
+    }
+    std::set<std::string> paths_;
+  } collector;
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Synchronize(false, &collector));
+  EXPECT_EQ(8, collector.paths_.size());
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Rebuild());
+  EXPECT_EQ(1000, dbm.CountSimple());
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.CopyFile(copy_path));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Clear());
+  EXPECT_EQ(0, dbm.CountSimple());
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+  tkrzw::ShardDBM copy_dbm;
+  EXPECT_EQ(tkrzw::Status::SUCCESS, copy_dbm.Open(copy_path, false));
+  EXPECT_EQ(1000, copy_dbm.CountSimple());
+  EXPECT_EQ("1", copy_dbm.GetSimple("1"));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, copy_dbm.Close());
+}
+
+TEST_F(ShardDBMTest, MultiRecords) {
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string path = tkrzw::JoinPath(tmp_dir.Path(), "casket.tkh");
+  tkrzw::ShardDBM dbm;
+  const std::map<std::string, std::string> open_params = {
+    {"num_shards", "4"}, {"num_threads", "4"}, {"num_buckets", "100"}};
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.OpenAdvanced(
+      path, true, tkrzw::File::OPEN_TRUNCATE, open_params));
+  for (const int32_t num_records : {10, 500}) {
+    std::map<std::string, std::string> records;
+    std::vector<std::string> keys;
+    for (int32_t i = 0; i < num_records; i++) {
+      const std::string key = tkrzw::SPrintF("%d-%d", num_records, i);
+      records.emplace(key, tkrzw::ToString(i * i));
+      keys.emplace_back(key);
+    }
+    keys.emplace_back("missing");
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.SetMulti(records));
+    EXPECT_EQ(records, dbm.GetMulti(keys));
+    EXPECT_EQ(tkrzw::Status::DUPLICATION_ERROR, dbm.SetMulti(records, false));
+    for (const auto& record : records) {
+      EXPECT_EQ(record.second, dbm.GetSimple(record.first));
+    }
+  }
+  EXPECT_EQ(510, dbm.CountSimple());
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.SetMulti({{"a", "A"}, {"b", "B"}}));
+  const auto ab_records = dbm.GetMulti({"a", "b", "c"});
+  EXPECT_EQ(2, ab_records.size());
+  EXPECT_EQ("A", tkrzw::SearchMap(ab_records, "a", ""));
+  EXPECT_EQ("B", tkrzw::SearchMap(ab_records, "b", ""));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+  EXPECT_TRUE(dbm.GetMulti({"a"}).empty());
+  EXPECT_EQ(tkrzw::Status::PRECONDITION_ERROR, dbm.SetMulti({{"a", "A"}}));
+}
+
+TEST_F(ShardDBMTest, SplitShards) {
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  struct Config final {
+    std::string path;
+    std::map<std::string, std::string> open_params;
+  };
+  const std::vector<Config> configs = {
+    {"", {{"dbm", "tiny"}, {"num_buckets", "100"}}},
+    {"casket.tkh", {{"num_buckets", "100"}}},
+    {"casket.tkt", {{"max_page_size", "100"}}},
+  };
+  for (const auto& config : configs) {
+    const std::string path =
+        config.path.empty() ? "" : tkrzw::JoinPath(tmp_dir.Path(), config.path);
+    tkrzw::ShardDBM dbm;
+    auto open_params = config.open_params;
+    open_params.emplace("num_shards", "3");
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.OpenAdvanced(
+        path, true, tkrzw::File::OPEN_TRUNCATE, open_params));
+    constexpr int32_t num_records = 3000;
+    for (int32_t i = 0; i < num_records; i++) {
+      const std::string expr = tkrzw::ToString(i);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(expr, expr));
+    }
+    std::atomic_bool done(false);
+    auto reader = [&]() {
+      std::mt19937 mt(1);
+      std::uniform_int_distribution<int32_t> dist(0, num_records / 2 - 1);
+      while (!done.load()) {
+        const std::string expr = tkrzw::ToString(dist(mt));
+        EXPECT_EQ(expr, dbm.GetSimple(expr));
+      }
+    };
+    auto writer = [&]() {
+      for (int32_t i = num_records / 2; i < num_records; i++) {
+        const std::string expr = tkrzw::ToString(i);
+        if (i % 3 == 0) {
+          EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Remove(expr));
+        } else {
+          EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Append(expr, "x", ":"));
+        }
+        const std::string new_expr = tkrzw::ToString(i + num_records);
+        EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(new_expr, new_expr));
+      }
+    };
+    std::thread reader_thread(reader);
+    std::thread writer_thread(writer);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.SplitShards());
+    writer_thread.join();
+    done.store(true);
+    reader_thread.join();
+    const auto GetMeta = [&]() {
+      const auto meta = dbm.Inspect();
+      return std::map<std::string, std::string>(meta.begin(), meta.end());
+    };
+    EXPECT_EQ("6", tkrzw::SearchMap(GetMeta(), "num_shards", ""));
+    EXPECT_EQ("", tkrzw::SearchMap(GetMeta(), "num_split_shards", ""));
+    const auto Check = [&](tkrzw::DBM* dbm) {
+      int64_t count = 0;
+      for (int32_t i = 0; i < num_records; i++) {
+        const std::string expr = tkrzw::ToString(i);
+        if (i < num_records / 2) {
+          EXPECT_EQ(expr, dbm->GetSimple(expr));
+          count++;
+        } else if (i % 3 == 0) {
+          EXPECT_EQ(tkrzw::Status::NOT_FOUND_ERROR, dbm->Get(expr));
+        } else {
+          EXPECT_EQ(expr + ":x", dbm->GetSimple(expr));
+          count++;
+        }
+      }
+      for (int32_t i = num_records / 2; i < num_records; i++) {
+        const std::string expr = tkrzw::ToString(i + num_records);
+        EXPECT_EQ(expr, dbm->GetSimple(expr));
+        count++;
+      }
+      EXPECT_EQ(count, dbm->CountSimple());
+    };
+    Check(&dbm);
+    if (!path.empty()) {
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+      EXPECT_FALSE(tkrzw::PathIsFile(path + "-00000-of-00003"));
+      EXPECT_TRUE(tkrzw::PathIsFile(path + "-00000-of-00006"));
+      EXPECT_TRUE(tkrzw::PathIsFile(path + "-00005-of-00006"));
+      open_params.erase("num_shards");
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.OpenAdvanced(path, true, 0, open_params));
+      EXPECT_EQ("6", tkrzw::SearchMap(GetMeta(), "num_shards", ""));
+      Check(&dbm);
+    }
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+  }
+}
+
+TEST_F(ShardDBMTest, ResumeSplitShards) {
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string path = tkrzw::JoinPath(tmp_dir.Path(), "casket.tkh");
+  tkrzw::ShardDBM dbm;
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.OpenAdvanced(
+      path, true, tkrzw::File::OPEN_TRUNCATE, {{"num_shards", "2"}}));
+  for (int32_t i = 0; i < 100; i++) {
+    const std::string expr = tkrzw::ToString(i);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(expr, expr));
+  }
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+  for (const auto& suffix : {"-00002-of-00004", "-00003-of-00004"}) {
+    tkrzw::PolyDBM new_dbm;
+    EXPECT_EQ(tkrzw::Status::SUCCESS, new_dbm.Open(path + suffix, true));
+    EXPECT_EQ(tkrzw::Status::SUCCESS, new_dbm.Close());
+  }
+  EXPECT_EQ(tkrzw::Status::SUCCESS,
+            tkrzw::RenameFile(path + "-00001-of-00002", path + "-00001-of-00004"));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Open(path, true));
+  auto meta = dbm.Inspect();
+  EXPECT_EQ("4", tkrzw::SearchMap(
+      std::map<std::string, std::string>(meta.begin(), meta.end()), "num_shards", ""));
+  EXPECT_EQ("0", tkrzw::SearchMap(
+      std::map<std::string, std::string>(meta.begin(), meta.end()), "num_split_shards", ""));
+  EXPECT_EQ(100, dbm.CountSimple());
+  for (int32_t i = 0; i < 100; i++) {
+    const std::string expr = tkrzw::ToString(i);
+    EXPECT_EQ(expr, dbm.GetSimple(expr));
+  }
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.SplitShards());
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Open(path, false));
+  EXPECT_EQ(100, dbm.CountSimple());
+  for (int32_t i = 0; i < 100; i++) {
+    const std::string expr = tkrzw::ToString(i);
+    EXPECT_EQ(expr, dbm.GetSimple(expr));
+  }
+  EXPECT_EQ(tkrzw::Status::PRECONDITION_ERROR, dbm.SplitShards());
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+}
+
+TEST_F(ShardDBMTest, SplitShardsFailure) {
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string path = tkrzw::JoinPath(tmp_dir.Path(), "casket.tkh");
+  tkrzw::ShardDBM dbm;
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.OpenAdvanced(
+      path, true, tkrzw::File::OPEN_TRUNCATE, {{"num_shards", "2"}}));
+  for (int32_t i = 0; i < 100; i++) {
+    const std::string expr = tkrzw::ToString(i);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(expr, expr));
+  }
+  const std::string occupied_path = path + "-00003-of-00004";
+  EXPECT_EQ(tkrzw::Status::SUCCESS, tkrzw::MakeDirectory(occupied_path));
+  EXPECT_NE(tkrzw::Status::SUCCESS, dbm.SplitShards());
+  EXPECT_FALSE(tkrzw::PathIsFile(path + "-00002-of-00004"));
+  auto meta = dbm.Inspect();
+  EXPECT_EQ("2", tkrzw::SearchMap(
+      std::map<std::string, std::string>(meta.begin(), meta.end()), "num_shards", ""));
+  EXPECT_EQ(100, dbm.CountSimple());
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+  EXPECT_EQ(tkrzw::Status::SUCCESS, tkrzw::RemoveDirectory(occupied_path));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Open(path, true));
+  meta = dbm.Inspect();
+  EXPECT_EQ("2", tkrzw::SearchMap(
+      std::map<std::string, std::string>(meta.begin(), meta.end()), "num_shards", ""));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.SplitShards());
+  EXPECT_EQ(100, dbm.CountSimple());
+  for (int32_t i = 0; i < 100; i++) {
+    const std::string expr = tkrzw::ToString(i);
+    EXPECT_EQ(expr, dbm.GetSimple(expr));
+  }
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+}
+
+TEST_F(ShardDBMTest, FinishSplitFailure) {
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string path = tkrzw::JoinPath(tmp_dir.Path(), "casket.tkh");
+  tkrzw::ShardDBM dbm;
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.OpenAdvanced(
+      path, true, tkrzw::File::OPEN_TRUNCATE, {{"num_shards", "2"}}));
+  for (int32_t i = 0; i < 100; i++) {
+    const std::string expr = tkrzw::ToString(i);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(expr, expr));
+  }
+  const std::string occupied_path = path + "-00000-of-00004";
+  EXPECT_EQ(tkrzw::Status::SUCCESS, tkrzw::MakeDirectory(occupied_path));
+  EXPECT_NE(tkrzw::Status::SUCCESS, dbm.SplitShards());
+  EXPECT_TRUE(tkrzw::PathIsFile(path + "-00000-of-00002"));
+  EXPECT_TRUE(tkrzw::PathIsFile(path + "-00001-of-00004"));
+  EXPECT_TRUE(dbm.IsHealthy());
+  EXPECT_EQ(100, dbm.CountSimple());
+  for (int32_t i = 0; i < 100; i++) {
+    const std::string expr = tkrzw::ToString(i);
+    EXPECT_EQ(expr, dbm.GetSimple(expr));
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Append(expr, "x", ":"));
+  }
+  auto iter = dbm.MakeIterator();
+  EXPECT_EQ(tkrzw::Status::SUCCESS, iter->First());
+  int64_t count = 0;
+  std::string key, value;
+  while (iter->Get(&key, &value) == tkrzw::Status::SUCCESS) {
+    EXPECT_EQ(key + ":x", value);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, iter->Next());
+    count++;
+  }
+  EXPECT_EQ(100, count);
+  iter.reset();
+  EXPECT_EQ(tkrzw::Status::SUCCESS, tkrzw::RemoveDirectory(occupied_path));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.SplitShards());
+  auto meta = dbm.Inspect();
+  EXPECT_EQ("4", tkrzw::SearchMap(
+      std::map<std::string, std::string>(meta.begin(), meta.end()), "num_shards", ""));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+  EXPECT_FALSE(tkrzw::PathIsFile(path + "-00000-of-00002"));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Open(path, false));
+  EXPECT_EQ(100, dbm.CountSimple());
+  for (int32_t i = 0; i < 100; i++) {
+    const std::string expr = tkrzw::ToString(i);
+    EXPECT_EQ(expr + ":x", dbm.GetSimple(expr));
+  }
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+}
+
+TEST_F(ShardDBMTest, ReopenSplitShards) {
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string path = tkrzw::JoinPath(tmp_dir.Path(), "casket.tkh");
+  tkrzw::ShardDBM dbm;
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.OpenAdvanced(
+      path, true, tkrzw::File::OPEN_TRUNCATE, {{"num_shards", "2"}}));
+  for (int32_t i = 0; i < 100; i++) {
+    const std::string expr = tkrzw::ToString(i);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(expr, expr));
+  }
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.SplitShards());
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.SplitShards());
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.OpenAdvanced(path, true, 0, {{"num_shards", "2"}}));
+  auto meta = dbm.Inspect();
+  EXPECT_EQ("8", tkrzw::SearchMap(
+      std::map<std::string, std::string>(meta.begin(), meta.end()), "num_shards", ""));
+  EXPECT_EQ("", tkrzw::SearchMap(
+      std::map<std::string, std::string>(meta.begin(), meta.end()), "num_split_shards", ""));
+  EXPECT_EQ(100, dbm.CountSimple());
+  for (int32_t i = 0; i < 100; i++) {
+    const std::string expr = tkrzw::ToString(i);
+    EXPECT_EQ(expr, dbm.GetSimple(expr));
+  }
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+  EXPECT_FALSE(tkrzw::PathIsFile(path + "-00000-of-00002"));
+  EXPECT_FALSE(tkrzw::PathIsFile(path + "-00000-of-00004"));
+}
+
 // END OF FILE
@@ -50,6 +50,7 @@ constexpr int64_t MIN_SORT_MEM_SIZE = 1LL << 10;
 constexpr int64_t MAX_SORT_MEM_SIZE = 8LL << 30;
 constexpr int32_t MIN_MAX_CACHED_RECORDS = 1;
 constexpr int32_t MAX_MAX_CACHED_RECORDS = 1 << 24;
+constexpr double APPEND_BUFFER_MAX_DELAY = 1.0;
 const char* REBUILD_FILE_SUFFIX = ".tmp.rebuild";
 const char* SORTER_FILE_SUFFIX = ".tmp.sorter";
 const char* SORTED_FILE_SUFFIX = ".tmp.sorted";
@@ -94,7 +95,7 @@ class SkipDBMImpl final {
   Status SetOpaqueMetadata(const std::string& opaque);
   Status Revert();
   bool IsUpdated();
-  Status MergeSkipDatabase(const std::string& src_path);
+  Status MergeSkipDatabases(const std::vector<std::string>& src_paths);
 
  private:
   void CancelIterators();
@@ -103,14 +104,16 @@ class SkipDBMImpl final {
   Status PrepareStorage();
   Status FinishStorage(SkipDBM::ReducerType reducer);
   Status DiscardStorage();
+  Status ProcessWritable(std::string_view key, DBM::RecordProcessor* proc);
+  Status InsertWritable(std::string_view key, std::string_view value);
   Status UpdateRecord(std::string_view key, std::string_view new_value);
   Status WriteRecord(std::string_view key, std::string_view value, File* file);
 
   bool open_;
   bool writable_;
   bool healthy_;
-  bool updated_;
-  bool removed_;
+  std::atomic_bool updated_;
+  std::atomic_bool removed_;
   std::string path_;
   uint8_t pkg_major_version_;
   uint8_t pkg_minor_version_;
@@ -131,6 +134,7 @@ class SkipDBMImpl final {
   int64_t sort_mem_size_;
   bool insert_in_order_;
   int32_t max_cached_records_;
+  int64_t append_buffer_size_;
   std::unique_ptr<RecordSorter> record_sorter_;
   std::vector<int64_t> past_offsets_;
   std::unique_ptr<SkipRecordCache> cache_;
@@ -174,6 +178,7 @@ SkipDBMImpl::SkipDBMImpl(std::unique_ptr<File> file)
       file_(std::move(file)), sorted_file_(nullptr), record_index_(0),
       sort_mem_size_(SkipDBM::DEFAULT_SORT_MEM_SIZE), insert_in_order_(false),
       max_cached_records_(SkipDBM::DEFAULT_MAX_CACHED_RECORDS),
+      append_buffer_size_(SkipDBM::DEFAULT_APPEND_BUFFER_SIZE),
       record_sorter_(nullptr), past_offsets_(),
       old_num_records_(0), old_eff_data_size_(0),
       mutex_() {}
@@ -214,6 +219,9 @@ Status SkipDBMImpl::Open(const std::string& path, bool writable,
     max_cached_records_ = std::min(std::max(
         tuning_params.max_cached_records, MIN_MAX_CACHED_RECORDS), MAX_MAX_CACHED_RECORDS);
   }
+  if (tuning_params.append_buffer_size >= 0) {
+    append_buffer_size_ = tuning_params.append_buffer_size;
+  }
   Status status = file_->Open(path, writable, options);
   if (status != Status::SUCCESS) {
     return status;
@@ -296,6 +304,7 @@ Status SkipDBMImpl::Close() {
   opaque_.clear();
   sort_mem_size_ = SkipDBM::DEFAULT_SORT_MEM_SIZE;
   insert_in_order_ = false;
+  append_buffer_size_ = SkipDBM::DEFAULT_APPEND_BUFFER_SIZE;
   record_sorter_.reset(nullptr);
   past_offsets_.clear();
   cache_.reset(nullptr);
@@ -306,38 +315,13 @@ Status SkipDBMImpl::Close() {
 
 Status SkipDBMImpl::Process(std::string_view key, DBM::RecordProcessor* proc, bool writable) {
   if (writable) {
-    std::lock_guard<std::shared_timed_mutex> lock(mutex_);
-    if (!open_) {
-      return Status(Status::PRECONDITION_ERROR, "not opened database");
-    }
-    if (!writable_) {
-      return Status(Status::PRECONDITION_ERROR, "not writable database");
-    }
-    if (!healthy_) {
-      return Status(Status::PRECONDITION_ERROR, "not healthy database");
-    }
-    SkipRecord rec(file_.get(), offset_width_, step_unit_, max_level_);
-    Status status = rec.Search(METADATA_SIZE, cache_.get(), key, false);
-    std::string_view new_value;
-    if (status == Status::SUCCESS) {
-      std::string_view rec_value = rec.GetValue();
-      if (rec_value.data() == nullptr) {
-        status = rec.ReadBody();
-        if (status != Status::SUCCESS) {
-          return status;
-        }
-        rec_value = rec.GetValue();
-      }
-      new_value = proc->ProcessFull(key, rec_value);
-    } else if (status == Status::NOT_FOUND_ERROR) {
-      new_value = proc->ProcessEmpty(key);
-    } else {
-      return status;
-    }
-    status = UpdateRecord(key, new_value);
-    if (status != Status::SUCCESS) {
-      return status;
+    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    if (!insert_in_order_) {
+      return ProcessWritable(key, proc);
     }
+    lock.unlock();
+    std::lock_guard<std::shared_timed_mutex> exclusive_lock(mutex_);
+    return ProcessWritable(key, proc);
   } else {
     std::shared_lock<std::shared_timed_mutex> lock(mutex_);
     if (!open_) {
@@ -365,17 +349,13 @@ Status SkipDBMImpl::Process(std::string_view key, DBM::RecordProcessor* proc, bo
 }
 
 Status SkipDBMImpl::Insert(std::string_view key, std::string_view value) {
-  std::lock_guard<std::shared_timed_mutex> lock(mutex_);
-  if (!open_) {
-    return Status(Status::PRECONDITION_ERROR, "not opened database");
-  }
-  if (!writable_) {
-    return Status(Status::PRECONDITION_ERROR, "not writable database");
-  }
-  if (!healthy_) {
-    return Status(Status::PRECONDITION_ERROR, "not healthy database");
+  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+  if (!insert_in_order_) {
+    return InsertWritable(key, value);
   }
-  return UpdateRecord(key, value);
+  lock.unlock();
+  std::lock_guard<std::shared_timed_mutex> exclusive_lock(mutex_);
+  return InsertWritable(key, value);
 }
 
 Status SkipDBMImpl::GetByIndex(int64_t index, std::string* key, std::string* value) {
@@ -417,6 +397,8 @@ Status SkipDBMImpl::ProcessEach(DBM::RecordProcessor* proc, bool writable) {
     if (!healthy_) {
       return Status(Status::PRECONDITION_ERROR, "not healthy database");
     }
+    ScopedFileAdvice advice(file_.get(), METADATA_SIZE, -1,
+                            File::ADVICE_SEQUENTIAL, File::ADVICE_NORMAL);
     proc->ProcessEmpty(DBM::RecordProcessor::NOOP);
     const int64_t end_offset = file_->GetSizeSimple();
     int64_t offset = METADATA_SIZE;
@@ -450,6 +432,8 @@ Status SkipDBMImpl::ProcessEach(DBM::RecordProcessor* proc, bool writable) {
     if (!open_) {
       return Status(Status::PRECONDITION_ERROR, "not opened database");
     }
+    ScopedFileAdvice advice(file_.get(), METADATA_SIZE, -1,
+                            File::ADVICE_SEQUENTIAL, File::ADVICE_NORMAL);
     proc->ProcessEmpty(DBM::RecordProcessor::NOOP);
     SkipRecord rec(file_.get(), offset_width_, step_unit_, max_level_);
     const int64_t end_offset = file_->GetSizeSimple();
@@ -584,6 +568,7 @@ Status SkipDBMImpl::Rebuild(const SkipDBM::TuningParameters& tuning_params) {
   tmp_tuning_params.step_unit = step_unit;
   tmp_tuning_params.max_level = max_level;
   tmp_tuning_params.insert_in_order = true;
+  tmp_tuning_params.append_buffer_size = append_buffer_size_;
   const std::string rebuild_path = path_ + REBUILD_FILE_SUFFIX;
   SkipDBM tmp_dbm(file_->MakeFile());
   auto CleanUp = [&]() {
@@ -596,33 +581,37 @@ Status SkipDBMImpl::Rebuild(const SkipDBM::TuningParameters& tuning_params) {
     CleanUp();
     return status;
   }
-  const int64_t end_offset = file_->GetSizeSimple();
-  int64_t offset = METADATA_SIZE;
-  int64_t index = 0;
-  tkrzw::SkipRecord rec(file_.get(), offset_width_, step_unit_, max_level_);
-  while (offset < end_offset) {
-    status = rec.ReadMetadataKey(offset, index);
-    if (status != Status::SUCCESS) {
-      CleanUp();
-      return status;
-    }
-    const std::string_view key = rec.GetKey();
-    std::string_view value = rec.GetValue();
-    if (value.data() == nullptr) {
-      status = rec.ReadBody();
+  {
+    ScopedFileAdvice advice(file_.get(), METADATA_SIZE, -1,
+                            File::ADVICE_SEQUENTIAL, File::ADVICE_NORMAL);
+    const int64_t end_offset = file_->GetSizeSimple();
+    int64_t offset = METADATA_SIZE;
+    int64_t index = 0;
+    tkrzw::SkipRecord rec(file_.get(), offset_width_, step_unit_, max_level_);
+    while (offset < end_offset) {
+      status = rec.ReadMetadataKey(offset, index);
       if (status != Status::SUCCESS) {
         CleanUp();
         return status;
       }
-      value = rec.GetValue();
-    }
-    status = tmp_dbm.Set(key, value);
-    if (status != Status::SUCCESS) {
-      CleanUp();
-      return status;
+      const std::string_view key = rec.GetKey();
+      std::string_view value = rec.GetValue();
+      if (value.data() == nullptr) {
+        status = rec.ReadBody();
+        if (status != Status::SUCCESS) {
+          CleanUp();
+          return status;
+        }
+        value = rec.GetValue();
+      }
+      status = tmp_dbm.Set(key, value);
+      if (status != Status::SUCCESS) {
+        CleanUp();
+        return status;
+      }
+      offset += rec.GetWholeSize();
+      index++;
     }
-    offset += rec.GetWholeSize();
-    index++;
   }
   status = tmp_dbm.Close();
   if (status != Status::SUCCESS) {
@@ -702,8 +691,8 @@ std::vector<std::pair<std::string, std::string>> SkipDBMImpl::Inspect() {
   Add("class", "SkipDBM");
   if (open_) {
     Add("healthy", ToString(healthy_));
-    Add("updated", ToString(updated_));
-    Add("removed", ToString(removed_));
+    Add("updated", ToString(updated_.load()));
+    Add("removed", ToString(removed_.load()));
     Add("path", path_);
     Add("pkg_major_version", ToString(pkg_major_version_));
     Add("pkg_minor_version", ToString(pkg_minor_version_));
@@ -825,8 +814,8 @@ bool SkipDBMImpl::IsUpdated() {
   return open_ && updated_;
 }
 
-Status SkipDBMImpl::MergeSkipDatabase(const std::string& src_path) {
-  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+Status SkipDBMImpl::MergeSkipDatabases(const std::vector<std::string>& src_paths) {
+  std::lock_guard<std::shared_timed_mutex> lock(mutex_);
   if (!open_) {
     return Status(Status::PRECONDITION_ERROR, "not opened database");
   }
@@ -836,33 +825,48 @@ Status SkipDBMImpl::MergeSkipDatabase(const std::string& src_path) {
   if (!healthy_) {
     return Status(Status::PRECONDITION_ERROR, "not healthy database");
   }
-  uint32_t src_offset_width = 0;
-  uint32_t src_step_unit = 0;
-  uint32_t src_max_level = 0;
-  {
-    SkipDBMImpl src_impl(file_->MakeFile());
-    Status status =
-        src_impl.Open(src_path, false, File::OPEN_DEFAULT, SkipDBM::TuningParameters());
-    if (status != Status::SUCCESS) {
-      return status;
+  struct SourceFile final {
+    std::unique_ptr<File> file;
+    uint32_t offset_width;
+    uint32_t step_unit;
+    uint32_t max_level;
+  };
+  std::vector<SourceFile> sources;
+  sources.reserve(src_paths.size());
+  for (const auto& src_path : src_paths) {
+    SourceFile source;
+    {
+      SkipDBMImpl src_impl(file_->MakeFile());
+      Status status =
+          src_impl.Open(src_path, false, File::OPEN_DEFAULT, SkipDBM::TuningParameters());
+      if (status != Status::SUCCESS) {
+        return status;
+      }
+      source.offset_width = src_impl.offset_width_;
+      source.step_unit = src_impl.step_unit_;
+      source.max_level = src_impl.max_level_;
+      status = src_impl.Close();
+      if (status != Status::SUCCESS) {
+        return status;
+      }
     }
-    src_offset_width = src_impl.offset_width_;
-    src_step_unit = src_impl.step_unit_;
-    src_max_level = src_impl.max_level_;
-    status = src_impl.Close();
+    source.file = file_->MakeFile();
+    const Status status = source.file->Open(src_path, false, File::OPEN_NO_LOCK);
     if (status != Status::SUCCESS) {
       return status;
     }
+    source.file->Advise(METADATA_SIZE, -1, File::ADVICE_SEQUENTIAL);
+    sources.emplace_back(std::move(source));
   }
-  auto src_file = file_->MakeFile();
-  Status status = src_file->Open(src_path, false, File::OPEN_NO_LOCK);
-  if (status != Status::SUCCESS) {
-    return status;
+  for (auto& source : sources) {
+    record_sorter_->AddSkipRecord(new SkipRecord(
+        source.file.get(), source.offset_width, source.step_unit, source.max_level),
+                                  METADATA_SIZE);
+    record_sorter_->TakeFileOwnership(std::move(source.file));
+  }
+  if (!sources.empty()) {
+    updated_ = true;
   }
-  record_sorter_->AddSkipRecord(new SkipRecord(
-      src_file.get(), src_offset_width, src_step_unit, src_max_level), METADATA_SIZE);
-  record_sorter_->TakeFileOwnership(std::move(src_file));
-  updated_ = true;
   return Status(Status::SUCCESS);
 }
 
@@ -956,6 +960,10 @@ Status SkipDBMImpl::PrepareStorage() {
     if (status != Status::SUCCESS) {
       return status;
     }
+    status = sorted_file_->SetAppendBuffer(append_buffer_size_, APPEND_BUFFER_MAX_DELAY);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
     record_index_ = 0;
     past_offsets_.clear();
     past_offsets_.resize(max_level_, 0);
@@ -992,6 +1000,7 @@ Status SkipDBMImpl::FinishStorage(SkipDBM::ReducerType reducer) {
         return status;
       }
       file_->Truncate(METADATA_SIZE);
+      file_->SetAppendBuffer(append_buffer_size_, APPEND_BUFFER_MAX_DELAY);
       record_sorter_->AddSkipRecord(new SkipRecord(
           swap_file.get(), offset_width_, step_unit_, max_level_), METADATA_SIZE);
     }
@@ -1078,6 +1087,7 @@ Status SkipDBMImpl::FinishStorage(SkipDBM::ReducerType reducer) {
   past_offsets_.clear();
   record_sorter_.reset(nullptr);
   updated_ = false;
+  status |= file_->SetAppendBuffer(0, 0);
   file_size_ = file_->GetSizeSimple();
   mod_time_ = GetWallTime() * 1000000;
   status |= SaveMetadata(false);
@@ -1122,6 +1132,50 @@ Status SkipDBMImpl::UpdateRecord(std::string_view key, std::string_view new_valu
   return Status(Status::SUCCESS);
 }
 
+Status SkipDBMImpl::ProcessWritable(std::string_view key, DBM::RecordProcessor* proc) {
+  if (!open_) {
+    return Status(Status::PRECONDITION_ERROR, "not opened database");
+  }
+  if (!writable_) {
+    return Status(Status::PRECONDITION_ERROR, "not writable database");
+  }
+  if (!healthy_) {
+    return Status(Status::PRECONDITION_ERROR, "not healthy database");
+  }
+  SkipRecord rec(file_.get(), offset_width_, step_unit_, max_level_);
+  Status status = rec.Search(METADATA_SIZE, cache_.get(), key, false);
+  std::string_view new_value;
+  if (status == Status::SUCCESS) {
+    std::string_view rec_value = rec.GetValue();
+    if (rec_value.data() == nullptr) {
+      status = rec.ReadBody();
+      if (status != Status::SUCCESS) {
+        return status;
+      }
+      rec_value = rec.GetValue();
+    }
+    new_value = proc->ProcessFull(key, rec_value);
+  } else if (status == Status::NOT_FOUND_ERROR) {
+    new_value = proc->ProcessEmpty(key);
+  } else {
+    return status;
+  }
+  return UpdateRecord(key, new_value);
+}
+
+Status SkipDBMImpl::InsertWritable(std::string_view key, std::string_view value) {
+  if (!open_) {
+    return Status(Status::PRECONDITION_ERROR, "not opened database");
+  }
+  if (!writable_) {
+    return Status(Status::PRECONDITION_ERROR, "not writable database");
+  }
+  if (!healthy_) {
+    return Status(Status::PRECONDITION_ERROR, "not healthy database");
+  }
+  return UpdateRecord(key, value);
+}
+
 Status SkipDBMImpl::WriteRecord(std::string_view key, std::string_view value, File* file) {
   SkipRecord rec(file, offset_width_, step_unit_, max_level_);
   rec.SetData(record_index_, key.data(), key.size(), value.data(), value.size());
@@ -1568,7 +1622,11 @@ bool SkipDBM::IsUpdated() {
 }
 
 Status SkipDBM::MergeSkipDatabase(const std::string& src_path) {
-  return impl_->MergeSkipDatabase(src_path);
+  return impl_->MergeSkipDatabases({src_path});
+}
+
+Status SkipDBM::MergeSkipDatabases(const std::vector<std::string>& src_paths) {
+  return impl_->MergeSkipDatabases(src_paths);
 }
 
 SkipDBM::Iterator::Iterator(SkipDBMImpl* dbm_impl) {
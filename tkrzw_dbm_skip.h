@@ -35,6 +35,9 @@ class SkipDBMIteratorImpl;
  * File database manager implementation based on skip list.
  * @details All operations are thread-safe; Multiple threads can access the same database
  * concurrently.  Every opened database must be closed explicitly to avoid data corruption.
+ * @details Unless the insert_in_order tuning parameter is set, updating operations only take
+ * a shared lock of the database and add records to staging buffers sharded by thread, so that
+ * multiple writer threads don't block each other until the database is synchronized.
  */
 class SkipDBM final : public DBM {
  public:
@@ -48,6 +51,8 @@ class SkipDBM final : public DBM {
   static constexpr int64_t DEFAULT_SORT_MEM_SIZE = 256LL << 20;
   /** The default value of the maximum cached records. */
   static constexpr int32_t DEFAULT_MAX_CACHED_RECORDS = 65536;
+  /** The default value of the size of the buffer for appending records. */
+  static constexpr int64_t DEFAULT_APPEND_BUFFER_SIZE = 1LL << 20;
   /** The size of the opaque metadata. */
   static constexpr int32_t OPAQUE_METADATA_SIZE = 64;
   /** The special removing value. */
@@ -222,6 +227,14 @@ class SkipDBM final : public DBM {
      * saved as a metadata of the database, it should be set each time when opening the database.
      */
     int32_t max_cached_records = -1;
+    /**
+     * The size of the buffer for appending records while building the database.
+     * @details Records written on synchronization or in the in-order mode are accumulated in
+     * the buffer and written into the file at once.  -1 means that the default value 1MB is
+     * set.  0 means that records are written directly.  As this parameter is not saved as a
+     * metadata of the database, it should be set each time when opening the database.
+     */
+    int64_t append_buffer_size = -1;
 
     /**
      * Constructor
@@ -573,6 +586,20 @@ class SkipDBM final : public DBM {
    */
   Status MergeSkipDatabase(const std::string& src_path);
 
+  /**
+   * Merges the contents of multiple skip database files at once.
+   * @param src_paths Paths to the source database files.
+   * @return The result status.
+   * @details Precondition: The database is opened as writable.
+   * @details All source files are validated before any of them is registered, so the merge is
+   * either done for all of them or for none of them.  The sources are combined by a single
+   * k-way merge when the database is synchronized, together with the existing records and the
+   * added records.  The ordering of records of the same key is the same as with
+   * MergeSkipDatabase, and records of the same key from the source files are in the order of
+   * the given paths.
+   */
+  Status MergeSkipDatabases(const std::vector<std::string>& src_paths);
+
   /**
    * Reduces the values of records of the same key by removing REMOVING_VALUE and past values.
    * @param key The common key of the records.
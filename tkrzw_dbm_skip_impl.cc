@@ -203,24 +203,24 @@ void SkipRecord::SetData(int64_t index, const char* key_ptr, int32_t key_size,
 
 Status SkipRecord::Write() {
   char stack[WRITE_BUFFER_SIZE];
-  char* write_buf = whole_size_ > static_cast<int32_t>(sizeof(stack)) ?
-      new char[whole_size_] : stack;
-  char* wp = write_buf;
+  char* wp = stack;
   *(wp++) = RECORD_MAGIC;
   std::memset(wp, 0, offset_width_ * level_);
   wp += offset_width_ * level_;
   wp += WriteVarNum(wp, key_size_);
   wp += WriteVarNum(wp, value_size_);
+  if (whole_size_ > static_cast<int32_t>(sizeof(stack))) {
+    // A large record is written as pieces to avoid copying the key and the value.
+    const std::string_view pieces[] = {
+      std::string_view(stack, wp - stack), std::string_view(key_ptr_, key_size_),
+      std::string_view(value_ptr_, value_size_)};
+    return file_->AppendV(pieces, sizeof(pieces) / sizeof(*pieces), &offset_);
+  }
   std::memcpy(wp, key_ptr_, key_size_);
   wp += key_size_;
   std::memcpy(wp, value_ptr_, value_size_);
   wp += value_size_;
-  Status status(Status::SUCCESS);
-  status = file_->Append(write_buf, whole_size_, &offset_);
-  if (write_buf != stack) {
-    delete[] write_buf;
-  }
-  return status;
+  return file_->Append(stack, whole_size_, &offset_);
 }
 
 Status SkipRecord::UpdatePastRecords(
@@ -528,7 +528,7 @@ void SkipRecordCache::Add(const SkipRecord& record) {
 
 RecordSorter::RecordSorter(const std::string& base_path, int64_t max_mem_size)
     : base_path_(base_path), max_mem_size_(max_mem_size), total_data_size_(0),
-      finished_(false), current_mem_size_(0) {}
+      finished_(false), stage_mem_size_(0), stage_seq_(1) {}
 
 RecordSorter::~RecordSorter() {
   for (const auto& tmp_file : tmp_files_) {
@@ -546,16 +546,24 @@ Status RecordSorter::Add(std::string_view key, std::string_view value) {
     return Status(Status::INFEASIBLE_ERROR, "already finished");
   }
   std::string record = SerializeStrPair(key, value);
-  current_mem_size_ += record.size() + REC_MEM_FOOT;
-  current_records_.emplace_back(std::move(record));
-  Status status(Status::SUCCESS);
-  if (!current_records_.empty() && current_mem_size_ >= max_mem_size_) {
-    status |= Flush();
+  const int64_t mem_size = record.size() + REC_MEM_FOOT;
+  auto& shard = stage_shards_[
+      std::hash<std::thread::id>()(std::this_thread::get_id()) % NUM_STAGE_SHARDS];
+  // The size is counted before the record is staged, so that a concurrent flush taking the
+  // record never makes the total negative.
+  const int64_t new_mem_size = stage_mem_size_.fetch_add(mem_size) + mem_size;
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.records.emplace_back(stage_seq_.fetch_add(1), std::move(record));
+  }
+  if (new_mem_size >= max_mem_size_) {
+    return Flush(false);
   }
-  return status;
+  return Status(Status::SUCCESS);
 }
 
 void RecordSorter::AddSkipRecord(SkipRecord* rec, int64_t record_base) {
+  std::lock_guard<std::mutex> flush_lock(flush_mutex_);
   skip_records_.emplace_back(rec, record_base);
 }
 
@@ -564,18 +572,17 @@ void RecordSorter::TakeFileOwnership(std::unique_ptr<File>&& file) {
 }
 
 bool RecordSorter::IsUpdated() const {
-  return !current_records_.empty() || !tmp_files_.empty() || !skip_records_.empty();
+  std::lock_guard<std::mutex> flush_lock(flush_mutex_);
+  return stage_mem_size_.load() > 0 || !tmp_files_.empty() || !skip_records_.empty();
 }
 
 Status RecordSorter::Finish() {
   if (finished_) {
     return Status(Status::INFEASIBLE_ERROR, "already finished");
   }
-  if (!current_records_.empty()) {
-    const Status status = Flush();
-    if (status != Status::SUCCESS) {
-      return status;
-    }
+  const Status status = Flush(true);
+  if (status != Status::SUCCESS) {
+    return status;
   }
   slots_.reserve(skip_records_.size() + tmp_files_.size());
   for (const auto& skip_record : skip_records_) {
@@ -618,8 +625,9 @@ Status RecordSorter::Finish() {
     if (status != Status::SUCCESS) {
       return status;
     }
+    int64_t seq = 0;
     std::string_view key, value;
-    DeserializeStrPair(rec, &key, &value);
+    ParseTmpRecord(rec, &seq, &key, &value);
     SortSlot slot;
     slot.id = slots_.size();
     slot.key = key;
@@ -629,6 +637,7 @@ Status RecordSorter::Finish() {
     slot.skip_record = nullptr;
     slot.offset = 0;
     slot.end_offset = 0;
+    slot.seq = seq;
     slots_.emplace_back(slot);
     heap_.emplace_back(&slots_.back());
     std::push_heap(heap_.begin(), heap_.end(), SortSlotComparator());
@@ -654,7 +663,7 @@ Status RecordSorter::Get(std::string* key, std::string* value) {
     const Status status = slot->flat_reader->Read(&rec);
     if (status == Status::SUCCESS) {
       std::string_view rec_key, rec_value;
-      DeserializeStrPair(rec, &rec_key, &rec_value);
+      ParseTmpRecord(rec, &slot->seq, &rec_key, &rec_value);
       slot->key = rec_key;
       slot->value = rec_value;
       std::push_heap(heap_.begin(), heap_.end(), SortSlotComparator());
@@ -691,8 +700,31 @@ Status RecordSorter::Get(std::string* key, std::string* value) {
   return Status(Status::SUCCESS);
 }
 
-Status RecordSorter::Flush() {
-  total_data_size_ += current_mem_size_;
+Status RecordSorter::Flush(bool force) {
+  std::lock_guard<std::mutex> flush_lock(flush_mutex_);
+  if (!force && stage_mem_size_.load() < max_mem_size_) {
+    return Status(Status::SUCCESS);
+  }
+  std::vector<std::pair<int64_t, std::string>> records;
+  for (auto& shard : stage_shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (records.empty()) {
+      records.swap(shard.records);
+    } else {
+      records.insert(records.end(), std::make_move_iterator(shard.records.begin()),
+                     std::make_move_iterator(shard.records.end()));
+      shard.records.clear();
+    }
+  }
+  if (records.empty()) {
+    return Status(Status::SUCCESS);
+  }
+  int64_t mem_size = 0;
+  for (const auto& record : records) {
+    mem_size += record.second.size() + REC_MEM_FOOT;
+  }
+  stage_mem_size_.fetch_sub(mem_size);
+  total_data_size_ += mem_size;
   TmpFileFlat tmp_file;
   tmp_file.path = base_path_ + SPrintF(".%05d", tmp_files_.size());
   if (total_data_size_ <= MAX_DATA_SIZE_MMAP_USE) {
@@ -706,22 +738,35 @@ Status RecordSorter::Flush() {
   if (status != Status::SUCCESS) {
     return status;
   }
-  std::stable_sort(current_records_.begin(), current_records_.end(),
-                   [](const std::string& a, const std::string& b) {
-                     return GetFirstFromSerializedStrPair(a) < GetFirstFromSerializedStrPair(b);
-                   });
+  std::sort(records.begin(), records.end(),
+            [](const std::pair<int64_t, std::string>& a,
+               const std::pair<int64_t, std::string>& b) {
+              const std::string_view a_key = GetFirstFromSerializedStrPair(a.second);
+              const std::string_view b_key = GetFirstFromSerializedStrPair(b.second);
+              return a_key == b_key ? a.first < b.first : a_key < b_key;
+            });
   FlatRecord rec(tmp_file.file);
-  for (const auto& record : current_records_) {
-    status = rec.Write(record);
+  std::string buf;
+  for (const auto& record : records) {
+    buf.resize(SizeVarNum(record.first));
+    WriteVarNum(buf.data(), record.first);
+    buf.append(record.second);
+    status = rec.Write(buf);
     if (status != Status::SUCCESS) {
       return status;
     }
   }
-  current_records_.clear();
-  current_mem_size_ = 0;
   return Status(Status::SUCCESS);
 }
 
+void RecordSorter::ParseTmpRecord(std::string_view rec, int64_t* seq,
+                                  std::string_view* key, std::string_view* value) {
+  uint64_t num = 0;
+  const size_t step = ReadVarNum(rec.data(), rec.size(), &num);
+  *seq = num;
+  DeserializeStrPair(rec.substr(step), key, value);
+}
+
 }  // namespace tkrzw
 
 // END OF FILE
@@ -283,6 +283,10 @@ public:
 
 /**
  * Sorter for a large amound of records based on merge sort on files.
+ * @details The Add method can be called concurrently by multiple threads.  Records are staged
+ * in buffers sharded by the calling thread and they are sorted into a temporary file when the
+ * total size exceeds the memory limit.  Records of the same key are ordered as they were added.
+ * The other methods must not be called concurrently.
  */
 class RecordSorter final {
  public:
@@ -372,8 +376,20 @@ class RecordSorter final {
     int64_t offset;
     /** The end offset. */
     int64_t end_offset;
+    /** The sequence number of the last retrieved record. */
+    int64_t seq;
     /** Constructor. */
-    SortSlot() : file(nullptr), offset(0), end_offset(0) {}
+    SortSlot() : file(nullptr), offset(0), end_offset(0), seq(0) {}
+  };
+
+  /**
+   * Structure of a staging buffer for added records.
+   */
+  struct StageShard final {
+    /** Pairs of the sequence number and the serialized record. */
+    std::vector<std::pair<int64_t, std::string>> records;
+    /** The mutex for the records. */
+    std::mutex mutex;
   };
 
   /**
@@ -387,18 +403,31 @@ class RecordSorter final {
      * @param True if the first one is greater.
      */
     bool operator ()(const SortSlot* lhs, const SortSlot* rhs) const {
-      return std::tie(lhs->key, lhs->id) > std::tie(rhs->key, rhs->id);
+      return std::tie(lhs->key, lhs->seq, lhs->id) > std::tie(rhs->key, rhs->seq, rhs->id);
     }
   };
 
   /**
-   * Flushes the current records into a file.
+   * Flushes the staged records into a file.
+   * @param force If true, the records are flushed even if they are within the memory limit.
    * @return The result status.
    */
-  Status Flush();
+  Status Flush(bool force);
+
+  /**
+   * Parses a record in a temporary file.
+   * @param rec The record data.
+   * @param seq The pointer to an integer to contain the sequence number.
+   * @param key The pointer to a string view object to contain the key.
+   * @param value The pointer to a string view object to contain the value.
+   */
+  static void ParseTmpRecord(std::string_view rec, int64_t* seq,
+                             std::string_view* key, std::string_view* value);
 
   /** Expected memory footprint for a record. */
-  static constexpr int32_t REC_MEM_FOOT = 8;
+  static constexpr int32_t REC_MEM_FOOT = 16;
+  /** The number of the staging shards. */
+  static constexpr int32_t NUM_STAGE_SHARDS = 16;
   /** The maximum data size to use mmap files. */
   static constexpr int64_t MAX_DATA_SIZE_MMAP_USE = 4LL << 30;
   /** The base path of the temporary files. */
@@ -409,10 +438,14 @@ class RecordSorter final {
   int64_t total_data_size_;
   /** True if adding is finished. */
   bool finished_;
-  /** Current serialized records. */
-  std::vector<std::string> current_records_;
-  /** The current memory size. */
-  int64_t current_mem_size_;
+  /** The staging buffers of added records. */
+  StageShard stage_shards_[NUM_STAGE_SHARDS];
+  /** The total memory size of the staged records. */
+  std::atomic_int64_t stage_mem_size_;
+  /** The sequence number of the next added record. */
+  std::atomic_int64_t stage_seq_;
+  /** The mutex for flushing the staged records. */
+  mutable std::mutex flush_mutex_;
   /** The temporary files. */
   std::vector<TmpFileFlat> tmp_files_;
   /** The skip record files. */
@@ -245,4 +245,50 @@ TEST(DBMSkipImplTest, RecordSorter) {
   EXPECT_TRUE(map.empty());
 }
 
+TEST(DBMSkipImplTest, RecordSorterConcurrent) {
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string base_path = tmp_dir.MakeUniquePath();
+  constexpr int32_t num_threads = 4;
+  constexpr int32_t num_iterations = 1000;
+  tkrzw::RecordSorter sorter(base_path, 1000);
+  auto task = [&](int32_t id) {
+    for (int32_t i = 0; i < num_iterations; i++) {
+      const std::string& key = tkrzw::SPrintF("%08d", i);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, sorter.Add(key, tkrzw::ToString(id)));
+      EXPECT_TRUE(sorter.IsUpdated());
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int32_t i = 0; i < num_threads; i++) {
+    threads.emplace_back(std::thread(task, i));
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (int32_t i = 0; i < num_iterations; i++) {
+    const std::string& key = tkrzw::SPrintF("%08d", i);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, sorter.Add(key, "last"));
+  }
+  EXPECT_EQ(tkrzw::Status::SUCCESS, sorter.Finish());
+  int32_t count = 0;
+  std::string last_key, last_value;
+  while (true) {
+    std::string key, value;
+    tkrzw::Status status = sorter.Get(&key, &value);
+    if (status != tkrzw::Status::SUCCESS) {
+      EXPECT_EQ(status, tkrzw::Status::NOT_FOUND_ERROR);
+      break;
+    }
+    EXPECT_GE(key, last_key);
+    if (!last_key.empty() && key != last_key) {
+      EXPECT_EQ("last", last_value);
+    }
+    count++;
+    last_key = key;
+    last_value = value;
+  }
+  EXPECT_EQ("last", last_value);
+  EXPECT_EQ(num_iterations * (num_threads + 1), count);
+}
+
 // END OF FILE
@@ -324,6 +324,7 @@ void SkipDBMTest::SkipDBMBasicTestAll(tkrzw::SkipDBM* dbm) {
           tuning_params.max_level = max_level;
           tuning_params.sort_mem_size = 3000;
           tuning_params.insert_in_order = insert_in_order;
+          tuning_params.append_buffer_size = 200;
           EXPECT_EQ(tkrzw::Status::SUCCESS, dbm->OpenAdvanced(
               file_path, true, tkrzw::File::OPEN_TRUNCATE, tuning_params));
           SkipDBMBasicTestOne(dbm, insert_in_order);
@@ -646,9 +647,12 @@ void SkipDBMTest::SkipDBMMergeTest(tkrzw::SkipDBM* dbm) {
   EXPECT_EQ(tkrzw::Status::SUCCESS, dbm->OpenAdvanced(
       file_path, true, tkrzw::File::OPEN_TRUNCATE, tuning_params));
   EXPECT_FALSE(dbm->IsUpdated());
-  for (const auto& src_path : src_paths) {
-    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm->MergeSkipDatabase(src_path));
-  }
+  EXPECT_NE(tkrzw::Status::SUCCESS, dbm->MergeSkipDatabases(
+      {src_paths.front(), tmp_dir.MakeUniquePath()}));
+  EXPECT_FALSE(dbm->IsUpdated());
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm->MergeSkipDatabase(src_paths.front()));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm->MergeSkipDatabases(
+      std::vector<std::string>(src_paths.begin() + 1, src_paths.end())));
   EXPECT_TRUE(dbm->IsUpdated());
   for (int32_t i = 1; i <= num_records; i++) {
     const std::string key = tkrzw::ToString(i * i);
@@ -706,11 +710,21 @@ TEST_F(SkipDBMTest, Basic) {
   SkipDBMBasicTestAll(&dbm);
 }
 
+TEST_F(SkipDBMTest, BasicPositional) {
+  tkrzw::SkipDBM dbm(std::make_unique<tkrzw::PositionalParallelFile>());
+  SkipDBMBasicTestAll(&dbm);
+}
+
 TEST_F(SkipDBMTest, Advanced) {
   tkrzw::SkipDBM dbm(std::make_unique<tkrzw::MemoryMapParallelFile>());
   SkipDBMAdvancedTest(&dbm);
 }
 
+TEST_F(SkipDBMTest, AdvancedPositional) {
+  tkrzw::SkipDBM dbm(std::make_unique<tkrzw::PositionalAtomicFile>());
+  SkipDBMAdvancedTest(&dbm);
+}
+
 TEST_F(SkipDBMTest, Process) {
   tkrzw::SkipDBM dbm(std::make_unique<tkrzw::MemoryMapParallelFile>());
   SkipDBMProcessTest(&dbm);
@@ -25,37 +25,127 @@ namespace tkrzw {
 
 typedef std::unordered_map<std::string, std::string> StringHashMap;
 typedef std::map<std::string, std::string> StringTreeMap;
+typedef std::pmr::unordered_map<std::pmr::string, std::pmr::string> ArenaStringHashMap;
+typedef std::pmr::map<std::pmr::string, std::pmr::string> ArenaStringTreeMap;
+
+template <class STRMAP>
+constexpr bool IS_HASH_MAP =
+    std::is_same_v<STRMAP, StringHashMap> || std::is_same_v<STRMAP, ArenaStringHashMap>;
+
+template <class STRMAP>
+constexpr bool IS_ARENA_MAP =
+    std::is_same_v<STRMAP, ArenaStringHashMap> || std::is_same_v<STRMAP, ArenaStringTreeMap>;
+
+constexpr int64_t ARENA_INITIAL_SIZE = 65536;
+
+std::unique_ptr<std::pmr::memory_resource> MakeRecordArena(StdAllocatorType alloc_type) {
+  switch (alloc_type) {
+    case STD_ALLOC_MONOTONIC:
+      return std::make_unique<std::pmr::monotonic_buffer_resource>(ARENA_INITIAL_SIZE);
+    case STD_ALLOC_POOL:
+      return std::make_unique<std::pmr::unsynchronized_pool_resource>();
+    default:
+      break;
+  }
+  return nullptr;
+}
+
+const char* GetStdAllocatorTypeName(StdAllocatorType alloc_type) {
+  switch (alloc_type) {
+    case STD_ALLOC_MONOTONIC:
+      return "monotonic";
+    case STD_ALLOC_POOL:
+      return "pool";
+    default:
+      break;
+  }
+  return "global";
+}
+
+StdAllocatorType ParseStdAllocatorType(std::string_view name) {
+  const std::string lower_name = StrLowerCase(name);
+  if (lower_name == "global") {
+    return STD_ALLOC_GLOBAL;
+  }
+  if (lower_name == "monotonic") {
+    return STD_ALLOC_MONOTONIC;
+  }
+  if (lower_name == "pool") {
+    return STD_ALLOC_POOL;
+  }
+  return STD_ALLOC_DEFAULT;
+}
+
+class StdDBMIteratorImplBase {
+ public:
+  virtual ~StdDBMIteratorImplBase() = default;
+  virtual Status First() = 0;
+  virtual Status Last() = 0;
+  virtual Status Jump(std::string_view key) = 0;
+  virtual Status JumpLower(std::string_view key, bool inclusive) = 0;
+  virtual Status JumpUpper(std::string_view key, bool inclusive) = 0;
+  virtual Status Next() = 0;
+  virtual Status Previous() = 0;
+  virtual Status Process(DBM::RecordProcessor* proc, bool writable) = 0;
+};
+
+class StdDBMImplBase {
+ public:
+  virtual ~StdDBMImplBase() = default;
+  virtual Status Open(const std::string& path, bool writable, int32_t options) = 0;
+  virtual Status Close() = 0;
+  virtual Status Process(std::string_view key, DBM::RecordProcessor* proc, bool writable) = 0;
+  virtual Status ProcessEach(DBM::RecordProcessor* proc, bool writable) = 0;
+  virtual Status Count(int64_t* count) = 0;
+  virtual Status GetFileSize(int64_t* size) = 0;
+  virtual Status GetFilePath(std::string* path) = 0;
+  virtual Status Clear() = 0;
+  virtual Status Rebuild() = 0;
+  virtual Status ShouldBeRebuilt(bool* tobe) = 0;
+  virtual Status Synchronize(bool hard, DBM::FileProcessor* proc) = 0;
+  virtual void Inspect(std::vector<std::pair<std::string, std::string>>* meta) = 0;
+  virtual bool IsOpen() = 0;
+  virtual bool IsWritable() = 0;
+  virtual std::unique_ptr<DBM> MakeDBM() = 0;
+  virtual StdDBMIteratorImplBase* MakeIterator() = 0;
+};
+
 template <class STRMAP> class StdDBMIteratorImpl;
 
 template <class STRMAP>
-class StdDBMImpl {
+class StdDBMImpl final : public StdDBMImplBase {
   friend class StdDBMIteratorImpl<STRMAP>;
   typedef std::list<StdDBMIteratorImpl<STRMAP>*> IteratorList;
  public:
-  StdDBMImpl(std::unique_ptr<File> file, int64_t num_buckets);
+  StdDBMImpl(std::unique_ptr<File> file, int64_t num_buckets, StdAllocatorType alloc_type);
   ~StdDBMImpl();
-  Status Open(const std::string& path, bool writable, int32_t options);
-  Status Close();
-  Status Process(std::string_view key, DBM::RecordProcessor* proc, bool writable);
-  Status ProcessEach(DBM::RecordProcessor* proc, bool writable);
-  Status Count(int64_t* count);
-  Status GetFileSize(int64_t* size);
-  Status GetFilePath(std::string* path);
-  Status Clear();
-  Status Rebuild();
-  Status ShouldBeRebuilt(bool* tobe);
-  Status Synchronize(bool hard, DBM::FileProcessor* proc);
-  void Inspect(std::vector<std::pair<std::string, std::string>>* meta);
-  bool IsOpen();
-  bool IsWritable();
-  std::unique_ptr<DBM> MakeDBM();
+  Status Open(const std::string& path, bool writable, int32_t options) override;
+  Status Close() override;
+  Status Process(std::string_view key, DBM::RecordProcessor* proc, bool writable) override;
+  Status ProcessEach(DBM::RecordProcessor* proc, bool writable) override;
+  Status Count(int64_t* count) override;
+  Status GetFileSize(int64_t* size) override;
+  Status GetFilePath(std::string* path) override;
+  Status Clear() override;
+  Status Rebuild() override;
+  Status ShouldBeRebuilt(bool* tobe) override;
+  Status Synchronize(bool hard, DBM::FileProcessor* proc) override;
+  void Inspect(std::vector<std::pair<std::string, std::string>>* meta) override;
+  bool IsOpen() override;
+  bool IsWritable() override;
+  std::unique_ptr<DBM> MakeDBM() override;
+  StdDBMIteratorImplBase* MakeIterator() override;
 
  private:
+  void InitMap(int64_t num_buckets);
+  void ClearMap();
   void CancelIterators();
   Status ImportRecords();
   Status ExportRecords();
 
-  STRMAP map_;
+  StdAllocatorType alloc_type_;
+  std::unique_ptr<std::pmr::memory_resource> arena_;
+  std::optional<STRMAP> map_;
   IteratorList iterators_;
   std::unique_ptr<File> file_;
   bool open_;
@@ -65,19 +155,19 @@ class StdDBMImpl {
 };
 
 template <class STRMAP>
-class StdDBMIteratorImpl {
+class StdDBMIteratorImpl final : public StdDBMIteratorImplBase {
   friend class StdDBMImpl<STRMAP>;
  public:
   explicit StdDBMIteratorImpl(StdDBMImpl<STRMAP>* dbm);
   ~StdDBMIteratorImpl();
-  Status First();
-  Status Last();
-  Status Jump(std::string_view key);
-  Status JumpLower(std::string_view key, bool inclusive);
-  Status JumpUpper(std::string_view key, bool inclusive);
-  Status Next();
-  Status Previous();
-  Status Process(DBM::RecordProcessor* proc, bool writable);
+  Status First() override;
+  Status Last() override;
+  Status Jump(std::string_view key) override;
+  Status JumpLower(std::string_view key, bool inclusive) override;
+  Status JumpUpper(std::string_view key, bool inclusive) override;
+  Status Next() override;
+  Status Previous() override;
+  Status Process(DBM::RecordProcessor* proc, bool writable) override;
 
  private:
   StdDBMImpl<STRMAP>* dbm_;
@@ -85,15 +175,11 @@ class StdDBMIteratorImpl {
 };
 
 template <class STRMAP>
-StdDBMImpl<STRMAP>::StdDBMImpl(std::unique_ptr<File> file, int64_t num_buckets)
-    : file_(std::move(file)), open_(false), writable_(false), path_() {
-}
-
-template <>
-StdDBMImpl<StringHashMap>::StdDBMImpl(std::unique_ptr<File> file, int64_t num_buckets)
-    : file_(std::move(file)), open_(false), writable_(false), path_() {
-  map_.rehash(num_buckets);
-  map_.max_load_factor(FLOATMAX);
+StdDBMImpl<STRMAP>::StdDBMImpl(
+    std::unique_ptr<File> file, int64_t num_buckets, StdAllocatorType alloc_type)
+    : alloc_type_(alloc_type), arena_(), map_(),
+      file_(std::move(file)), open_(false), writable_(false), path_() {
+  InitMap(num_buckets);
 }
 
 template <class STRMAP>
@@ -138,8 +224,8 @@ Status StdDBMImpl<STRMAP>::Close() {
     status |= ExportRecords();
   }
   status |= file_->Close();
+  ClearMap();
   CancelIterators();
-  map_.clear();
   open_ = false;
   writable_ = false;
   path_.clear();
@@ -149,15 +235,15 @@ Status StdDBMImpl<STRMAP>::Close() {
 template <class STRMAP>
 Status StdDBMImpl<STRMAP>::Process(
     std::string_view key, DBM::RecordProcessor* proc, bool writable) {
-  const std::string key_str(key);
+  const typename STRMAP::key_type key_str(key);
   if (writable) {
     std::lock_guard<std::shared_timed_mutex> lock(mutex_);
-    auto it = map_.find(key_str);
-    if (it == map_.end()) {
+    auto it = map_->find(key_str);
+    if (it == map_->end()) {
       const std::string_view new_value = proc->ProcessEmpty(key);
       if (new_value.data() != DBM::RecordProcessor::NOOP.data() &&
           new_value.data() != DBM::RecordProcessor::REMOVE.data()) {
-        map_.emplace(std::move(key_str), new_value);
+        map_->emplace(std::move(key_str), new_value);
       }
     } else {
       const std::string_view new_value = proc->ProcessFull(key, it->second);
@@ -168,14 +254,14 @@ Status StdDBMImpl<STRMAP>::Process(
             ++iterator->it_;
           }
         }
-        map_.erase(it);
+        map_->erase(it);
       } else {
         it->second = new_value;
       }
     }
   } else {
     std::shared_lock<std::shared_timed_mutex> lock(mutex_);
-    const auto& const_map = map_;
+    const auto& const_map = *map_;
     const auto it = const_map.find(key_str);
     if (it == const_map.end()) {
       proc->ProcessEmpty(key_str);
@@ -191,8 +277,8 @@ Status StdDBMImpl<STRMAP>::ProcessEach(DBM::RecordProcessor* proc, bool writable
   if (writable) {
     std::lock_guard<std::shared_timed_mutex> lock(mutex_);
     proc->ProcessEmpty(DBM::RecordProcessor::NOOP);
-    auto it = map_.begin();
-    while (it != map_.end()) {
+    auto it = map_->begin();
+    while (it != map_->end()) {
       const std::string_view new_value = proc->ProcessFull(it->first, it->second);
       if (new_value.data() == DBM::RecordProcessor::NOOP.data()) {
         ++it;
@@ -202,7 +288,7 @@ Status StdDBMImpl<STRMAP>::ProcessEach(DBM::RecordProcessor* proc, bool writable
             ++iterator->it_;
           }
         }
-        it = map_.erase(it);
+        it = map_->erase(it);
       } else {
         it->second = new_value;
         ++it;
@@ -212,7 +298,7 @@ Status StdDBMImpl<STRMAP>::ProcessEach(DBM::RecordProcessor* proc, bool writable
   } else {
     std::shared_lock<std::shared_timed_mutex> lock(mutex_);
     proc->ProcessEmpty(DBM::RecordProcessor::NOOP);
-    const auto& const_map = map_;
+    const auto& const_map = *map_;
     auto it = const_map.begin();
     while (it != const_map.end()) {
       proc->ProcessFull(it->first, it->second);
@@ -226,7 +312,7 @@ Status StdDBMImpl<STRMAP>::ProcessEach(DBM::RecordProcessor* proc, bool writable
 template <class STRMAP>
 Status StdDBMImpl<STRMAP>::Count(int64_t* count) {
   std::shared_lock<std::shared_timed_mutex> lock(mutex_);
-  *count = map_.size();
+  *count = map_->size();
   return Status(Status::SUCCESS);
 }
 
@@ -253,7 +339,7 @@ Status StdDBMImpl<STRMAP>::GetFilePath(std::string* path) {
 template <class STRMAP>
 Status StdDBMImpl<STRMAP>::Clear() {
   std::lock_guard<std::shared_timed_mutex> lock(mutex_);
-  map_.clear();
+  ClearMap();
   CancelIterators();
   return Status(Status::SUCCESS);
 }
@@ -261,14 +347,9 @@ Status StdDBMImpl<STRMAP>::Clear() {
 template <class STRMAP>
 Status StdDBMImpl<STRMAP>::Rebuild() {
   std::lock_guard<std::shared_timed_mutex> lock(mutex_);
-  CancelIterators();
-  return Status(Status::SUCCESS);
-}
-
-template <>
-Status StdDBMImpl<StringHashMap>::Rebuild() {
-  std::lock_guard<std::shared_timed_mutex> lock(mutex_);
-  map_.rehash(map_.size() * 2 + 1);
+  if constexpr (IS_HASH_MAP<STRMAP>) {
+    map_->rehash(map_->size() * 2 + 1);
+  }
   CancelIterators();
   return Status(Status::SUCCESS);
 }
@@ -276,14 +357,11 @@ Status StdDBMImpl<StringHashMap>::Rebuild() {
 template <class STRMAP>
 Status StdDBMImpl<STRMAP>::ShouldBeRebuilt(bool* tobe) {
   std::shared_lock<std::shared_timed_mutex> lock(mutex_);
-  *tobe = false;
-  return Status(Status::SUCCESS);
-}
-
-template <>
-Status StdDBMImpl<StringHashMap>::ShouldBeRebuilt(bool* tobe) {
-  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
-  *tobe = map_.load_factor() > 1.0;
+  if constexpr (IS_HASH_MAP<STRMAP>) {
+    *tobe = map_->load_factor() > 1.0;
+  } else {
+    *tobe = false;
+  }
   return Status(Status::SUCCESS);
 }
 
@@ -310,20 +388,11 @@ void StdDBMImpl<STRMAP>::Inspect(std::vector<std::pair<std::string, std::string>
   if (open_) {
     Add("path", path_);
   }
-  Add("num_records", ToString(map_.size()));
-}
-
-template <>
-void StdDBMImpl<StringHashMap>::Inspect(std::vector<std::pair<std::string, std::string>>* meta) {
-  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
- auto Add = [&](const std::string& name, const std::string& value) {
-    meta->emplace_back(std::make_pair(name, value));
-  };
-  if (open_) {
-    Add("path", path_);
+  Add("num_records", ToString(map_->size()));
+  if constexpr (IS_HASH_MAP<STRMAP>) {
+    Add("num_buckets", ToString(map_->bucket_count()));
   }
-  Add("num_records", ToString(map_.size()));
-  Add("num_buckets", ToString(map_.bucket_count()));
+  Add("allocator", GetStdAllocatorTypeName(alloc_type_));
 }
 
 template <class STRMAP>
@@ -341,19 +410,51 @@ bool StdDBMImpl<STRMAP>::IsWritable() {
 template <class STRMAP>
 std::unique_ptr<DBM> StdDBMImpl<STRMAP>::MakeDBM() {
   std::shared_lock<std::shared_timed_mutex> lock(mutex_);
-  return std::make_unique<StdTreeDBM>();
+  if constexpr (IS_HASH_MAP<STRMAP>) {
+    return std::make_unique<StdHashDBM>(map_->bucket_count(), alloc_type_);
+  } else {
+    return std::make_unique<StdTreeDBM>(alloc_type_);
+  }
 }
 
-template <>
-std::unique_ptr<DBM> StdDBMImpl<StringHashMap>::MakeDBM() {
-  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
-  return std::make_unique<StdHashDBM>(map_.bucket_count());
+template <class STRMAP>
+StdDBMIteratorImplBase* StdDBMImpl<STRMAP>::MakeIterator() {
+  return new StdDBMIteratorImpl<STRMAP>(this);
+}
+
+template <class STRMAP>
+void StdDBMImpl<STRMAP>::InitMap(int64_t num_buckets) {
+  if constexpr (IS_ARENA_MAP<STRMAP>) {
+    arena_ = MakeRecordArena(alloc_type_);
+    map_.emplace(typename STRMAP::allocator_type(arena_.get()));
+  } else {
+    map_.emplace();
+  }
+  if constexpr (IS_HASH_MAP<STRMAP>) {
+    map_->rehash(num_buckets);
+    map_->max_load_factor(FLOATMAX);
+  }
+}
+
+template <class STRMAP>
+void StdDBMImpl<STRMAP>::ClearMap() {
+  if constexpr (IS_ARENA_MAP<STRMAP>) {
+    int64_t num_buckets = 0;
+    if constexpr (IS_HASH_MAP<STRMAP>) {
+      num_buckets = map_->bucket_count();
+    }
+    // The map is destroyed before its arena, which is then released as a whole.
+    map_.reset();
+    InitMap(num_buckets);
+  } else {
+    map_->clear();
+  }
 }
 
 template <class STRMAP>
 void StdDBMImpl<STRMAP>::CancelIterators() {
   for (auto* iterator : iterators_) {
-    iterator->it_ = map_.end();
+    iterator->it_ = map_->end();
   }
 }
 
@@ -384,7 +485,7 @@ Status StdDBMImpl<STRMAP>::ImportRecords() {
       }
       return Status(Status::BROKEN_DATA_ERROR, "odd number of records");
     }
-    map_.emplace(key_store, value);
+    map_->emplace(key_store, value);
   }
   return Status(Status::SUCCESS);
 }
@@ -396,8 +497,8 @@ Status StdDBMImpl<STRMAP>::ExportRecords() {
     return status;
   }
   FlatRecord rec(file_.get());
-  auto it = map_.begin();
-  while (it != map_.end()) {
+  auto it = map_->begin();
+  while (it != map_->end()) {
     status = rec.Write(it->first);
     if (status != Status::SUCCESS) {
       return status;
@@ -416,7 +517,7 @@ StdDBMIteratorImpl<STRMAP>::StdDBMIteratorImpl(StdDBMImpl<STRMAP>* dbm)
     : dbm_(dbm) {
   std::lock_guard<std::shared_timed_mutex> lock(dbm_->mutex_);
   dbm_->iterators_.emplace_back(this);
-  it_ = dbm_->map_.end();
+  it_ = dbm_->map_->end();
 }
 
 template <class STRMAP>
@@ -430,96 +531,88 @@ StdDBMIteratorImpl<STRMAP>::~StdDBMIteratorImpl() {
 template <class STRMAP>
 Status StdDBMIteratorImpl<STRMAP>::First() {
   std::shared_lock<std::shared_timed_mutex> lock(dbm_->mutex_);
-  const auto& const_map = dbm_->map_;
+  const auto& const_map = *dbm_->map_;
   it_ = const_map.begin();
   return Status(Status::SUCCESS);
 }
 
 template <class STRMAP>
 Status StdDBMIteratorImpl<STRMAP>::Last() {
-  return Status(Status::NOT_IMPLEMENTED_ERROR);
-}
-
-template <>
-Status StdDBMIteratorImpl<StringTreeMap>::Last() {
-  std::shared_lock<std::shared_timed_mutex> lock(dbm_->mutex_);
-  const auto& const_map = dbm_->map_;
-  it_ = const_map.end();
-  if (it_ != const_map.begin()) {
-    it_--;
+  if constexpr (IS_HASH_MAP<STRMAP>) {
+    return Status(Status::NOT_IMPLEMENTED_ERROR);
+  } else {
+    std::shared_lock<std::shared_timed_mutex> lock(dbm_->mutex_);
+    const auto& const_map = *dbm_->map_;
+    it_ = const_map.end();
+    if (it_ != const_map.begin()) {
+      it_--;
+    }
+    return Status(Status::SUCCESS);
   }
-  return Status(Status::SUCCESS);
 }
 
 template <class STRMAP>
 Status StdDBMIteratorImpl<STRMAP>::Jump(std::string_view key) {
   std::shared_lock<std::shared_timed_mutex> lock(dbm_->mutex_);
-  const auto& const_map = dbm_->map_;
-  it_ = const_map.find(std::string(key));
-  if (it_ == dbm_->map_.end()) {
-    return Status(Status::NOT_FOUND_ERROR);
+  const auto& const_map = *dbm_->map_;
+  if constexpr (IS_HASH_MAP<STRMAP>) {
+    it_ = const_map.find(typename STRMAP::key_type(key));
+    if (it_ == const_map.end()) {
+      return Status(Status::NOT_FOUND_ERROR);
+    }
+  } else {
+    it_ = const_map.lower_bound(typename STRMAP::key_type(key));
   }
   return Status(Status::SUCCESS);
 }
 
-template <>
-Status StdDBMIteratorImpl<StringTreeMap>::Jump(std::string_view key) {
-  std::shared_lock<std::shared_timed_mutex> lock(dbm_->mutex_);
-  const auto& const_map = dbm_->map_;
-  it_ = const_map.lower_bound(std::string(key));
-  return Status(Status::SUCCESS);
-}
-
 template <class STRMAP>
 Status StdDBMIteratorImpl<STRMAP>::JumpLower(std::string_view key, bool inclusive) {
-  return Status(Status::NOT_IMPLEMENTED_ERROR);
-}
-
-template <>
-Status StdDBMIteratorImpl<StringTreeMap>::JumpLower(std::string_view key, bool inclusive) {
-  std::shared_lock<std::shared_timed_mutex> lock(dbm_->mutex_);
-  const auto& const_map = dbm_->map_;
-  it_ = const_map.lower_bound(std::string(key));
-  if (it_ == const_map.end()) {
-    if (it_ == const_map.begin()) {
-      return Status(Status::SUCCESS);
-    }
-    assert(!const_map.empty());
-    it_--;
-  }
-  while (true) {
-    const bool ok = inclusive ? it_->first <= key : it_->first < key;
-    if (ok) {
-      return Status(Status::SUCCESS);
+  if constexpr (IS_HASH_MAP<STRMAP>) {
+    return Status(Status::NOT_IMPLEMENTED_ERROR);
+  } else {
+    std::shared_lock<std::shared_timed_mutex> lock(dbm_->mutex_);
+    const auto& const_map = *dbm_->map_;
+    it_ = const_map.lower_bound(typename STRMAP::key_type(key));
+    if (it_ == const_map.end()) {
+      if (it_ == const_map.begin()) {
+        return Status(Status::SUCCESS);
+      }
+      assert(!const_map.empty());
+      it_--;
     }
-    if (it_ == const_map.begin()) {
-      break;
+    while (true) {
+      const bool ok = inclusive ? it_->first <= key : it_->first < key;
+      if (ok) {
+        return Status(Status::SUCCESS);
+      }
+      if (it_ == const_map.begin()) {
+        break;
+      }
+      it_--;
     }
-    it_--;
+    it_ = const_map.end();
+    return Status(Status::SUCCESS);
   }
-  it_ = const_map.end();
-  return Status(Status::SUCCESS);
 }
 
 template <class STRMAP>
 Status StdDBMIteratorImpl<STRMAP>::JumpUpper(std::string_view key, bool inclusive) {
-  std::shared_lock<std::shared_timed_mutex> lock(dbm_->mutex_);
-  return Status(Status::NOT_IMPLEMENTED_ERROR);
-}
-
-template <>
-Status StdDBMIteratorImpl<StringTreeMap>::JumpUpper(std::string_view key, bool inclusive) {
-  std::shared_lock<std::shared_timed_mutex> lock(dbm_->mutex_);
-  const auto& const_map = dbm_->map_;
-  it_ = inclusive ? const_map.lower_bound(std::string(key)) :
-      const_map.upper_bound(std::string(key));
-  return Status(Status::SUCCESS);
+  if constexpr (IS_HASH_MAP<STRMAP>) {
+    return Status(Status::NOT_IMPLEMENTED_ERROR);
+  } else {
+    std::shared_lock<std::shared_timed_mutex> lock(dbm_->mutex_);
+    const auto& const_map = *dbm_->map_;
+    it_ = inclusive ? const_map.lower_bound(typename STRMAP::key_type(key)) :
+        const_map.upper_bound(typename STRMAP::key_type(key));
+    return Status(Status::SUCCESS);
+  }
 }
 
 template <class STRMAP>
 Status StdDBMIteratorImpl<STRMAP>::Next() {
   std::shared_lock<std::shared_timed_mutex> lock(dbm_->mutex_);
-  const auto& const_map = dbm_->map_;
+  const auto& const_map = *dbm_->map_;
   if (it_ == const_map.end()) {
     return Status(Status::NOT_FOUND_ERROR);
   }
@@ -531,29 +624,28 @@ Status StdDBMIteratorImpl<STRMAP>::Next() {
 
 template <class STRMAP>
 Status StdDBMIteratorImpl<STRMAP>::Previous() {
-  return Status(Status::NOT_IMPLEMENTED_ERROR);
-}
-
-template <>
-Status StdDBMIteratorImpl<StringTreeMap>::Previous() {
-  std::shared_lock<std::shared_timed_mutex> lock(dbm_->mutex_);
-  const auto& const_map = dbm_->map_;
-  if (it_ == const_map.end()) {
-    return Status(Status::NOT_FOUND_ERROR);
-  }
-  if (it_ == const_map.begin()) {
-    it_ = const_map.end();
+  if constexpr (IS_HASH_MAP<STRMAP>) {
+    return Status(Status::NOT_IMPLEMENTED_ERROR);
   } else {
-    --it_;
+    std::shared_lock<std::shared_timed_mutex> lock(dbm_->mutex_);
+    const auto& const_map = *dbm_->map_;
+    if (it_ == const_map.end()) {
+      return Status(Status::NOT_FOUND_ERROR);
+    }
+    if (it_ == const_map.begin()) {
+      it_ = const_map.end();
+    } else {
+      --it_;
+    }
+    return Status(Status::SUCCESS);
   }
-  return Status(Status::SUCCESS);
 }
 
 template <class STRMAP>
 Status StdDBMIteratorImpl<STRMAP>::Process(DBM::RecordProcessor* proc, bool writable) {
   if (writable) {
     std::lock_guard<std::shared_timed_mutex> lock(dbm_->mutex_);
-    if (it_ == dbm_->map_.end()) {
+    if (it_ == dbm_->map_->end()) {
       return Status(Status::NOT_FOUND_ERROR);
     }
     const std::string_view new_value = proc->ProcessFull(it_->first, it_->second);
@@ -564,13 +656,13 @@ Status StdDBMIteratorImpl<STRMAP>::Process(DBM::RecordProcessor* proc, bool writ
           ++iterator->it_;
         }
       }
-      dbm_->map_.erase(it_++);
+      dbm_->map_->erase(it_++);
     } else {
-      dbm_->map_.find(it_->first)->second = new_value;
+      dbm_->map_->find(it_->first)->second = new_value;
     }
   } else {
     std::shared_lock<std::shared_timed_mutex> lock(dbm_->mutex_);
-    if (it_ == dbm_->map_.end()) {
+    if (it_ == dbm_->map_->end()) {
       return Status(Status::NOT_FOUND_ERROR);
     }
     proc->ProcessFull(it_->first, it_->second);
@@ -578,29 +670,30 @@ Status StdDBMIteratorImpl<STRMAP>::Process(DBM::RecordProcessor* proc, bool writ
   return Status(Status::SUCCESS);
 }
 
-class StdHashDBMImpl final : public StdDBMImpl<StringHashMap> {
- public:
-  explicit StdHashDBMImpl(std::unique_ptr<File> file, int64_t num_buckets)
-      : StdDBMImpl<StringHashMap>(std::move(file), num_buckets) {}
-};
-
-class StdHashDBMIteratorImpl final : public StdDBMIteratorImpl<StringHashMap> {
- public:
-  StdHashDBMIteratorImpl(StdHashDBMImpl* dbm) : StdDBMIteratorImpl<StringHashMap>(dbm) {}
-};
+template <class STRMAP, class ARENAMAP>
+StdDBMImplBase* MakeStdDBMImpl(
+    std::unique_ptr<File> file, int64_t num_buckets, StdAllocatorType alloc_type) {
+  if (alloc_type == STD_ALLOC_MONOTONIC || alloc_type == STD_ALLOC_POOL) {
+    return new StdDBMImpl<ARENAMAP>(std::move(file), num_buckets, alloc_type);
+  }
+  return new StdDBMImpl<STRMAP>(std::move(file), num_buckets, alloc_type);
+}
 
-StdHashDBM::StdHashDBM(int64_t num_buckets) {
+StdHashDBM::StdHashDBM(int64_t num_buckets, StdAllocatorType alloc_type) {
   if (num_buckets < 1) {
     num_buckets = DEFAULT_NUM_BUCKETS;
   }
-  impl_ = new StdHashDBMImpl(std::make_unique<MemoryMapParallelFile>(), num_buckets);
+  impl_ = MakeStdDBMImpl<StringHashMap, ArenaStringHashMap>(
+      std::make_unique<MemoryMapParallelFile>(), num_buckets, alloc_type);
 }
 
-StdHashDBM::StdHashDBM(std::unique_ptr<File> file, int64_t num_buckets) {
+StdHashDBM::StdHashDBM(
+    std::unique_ptr<File> file, int64_t num_buckets, StdAllocatorType alloc_type) {
   if (num_buckets < 1) {
     num_buckets = DEFAULT_NUM_BUCKETS;
   }
-  impl_ = new StdHashDBMImpl(std::move(file), num_buckets);
+  impl_ = MakeStdDBMImpl<StringHashMap, ArenaStringHashMap>(
+      std::move(file), num_buckets, alloc_type);
 }
 
 StdHashDBM::~StdHashDBM() {
@@ -681,8 +774,8 @@ std::unique_ptr<DBM> StdHashDBM::MakeDBM() const {
   return impl_->MakeDBM();
 }
 
-StdHashDBM::Iterator::Iterator(StdHashDBMImpl* dbm_impl) {
-  impl_ = new StdHashDBMIteratorImpl(dbm_impl);
+StdHashDBM::Iterator::Iterator(StdDBMImplBase* dbm_impl) {
+  impl_ = dbm_impl->MakeIterator();
 }
 
 StdHashDBM::Iterator::~Iterator() {
@@ -722,23 +815,13 @@ Status StdHashDBM::Iterator::Process(RecordProcessor* proc, bool writable) {
   return impl_->Process(proc, writable);
 }
 
-class StdTreeDBMImpl final : public StdDBMImpl<StringTreeMap> {
- public:
-  explicit StdTreeDBMImpl(std::unique_ptr<File> file)
-      : StdDBMImpl<StringTreeMap>(std::move(file), -1) {}
-};
-
-class StdTreeDBMIteratorImpl final : public StdDBMIteratorImpl<StringTreeMap> {
- public:
-  StdTreeDBMIteratorImpl(StdTreeDBMImpl* dbm) : StdDBMIteratorImpl<StringTreeMap>(dbm) {}
-};
-
-StdTreeDBM::StdTreeDBM() {
-  impl_ = new StdTreeDBMImpl(std::make_unique<MemoryMapParallelFile>());
+StdTreeDBM::StdTreeDBM(StdAllocatorType alloc_type) {
+  impl_ = MakeStdDBMImpl<StringTreeMap, ArenaStringTreeMap>(
+      std::make_unique<MemoryMapParallelFile>(), -1, alloc_type);
 }
 
-StdTreeDBM::StdTreeDBM(std::unique_ptr<File> file) {
-  impl_ = new StdTreeDBMImpl(std::move(file));
+StdTreeDBM::StdTreeDBM(std::unique_ptr<File> file, StdAllocatorType alloc_type) {
+  impl_ = MakeStdDBMImpl<StringTreeMap, ArenaStringTreeMap>(std::move(file), -1, alloc_type);
 }
 
 StdTreeDBM::~StdTreeDBM() {
@@ -819,8 +902,8 @@ std::unique_ptr<DBM> StdTreeDBM::MakeDBM() const {
   return impl_->MakeDBM();
 }
 
-StdTreeDBM::Iterator::Iterator(StdTreeDBMImpl* dbm_impl) {
-  impl_ = new StdTreeDBMIteratorImpl(dbm_impl);
+StdTreeDBM::Iterator::Iterator(StdDBMImplBase* dbm_impl) {
+  impl_ = dbm_impl->MakeIterator();
 }
 
 StdTreeDBM::Iterator::~Iterator() {
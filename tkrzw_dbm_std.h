@@ -28,8 +28,36 @@
 
 namespace tkrzw {
 
-class StdHashDBMImpl;
-class StdHashDBMIteratorImpl;
+class StdDBMImplBase;
+class StdDBMIteratorImplBase;
+
+/**
+ * Enumeration for memory allocators of records of StdHashDBM and StdTreeDBM.
+ */
+enum StdAllocatorType : int32_t {
+  /** The default behavior, which is the same as STD_ALLOC_GLOBAL. */
+  STD_ALLOC_DEFAULT = 0,
+  /** To use the standard containers which allocate each record from the global heap. */
+  STD_ALLOC_GLOBAL = 1,
+  /** To allocate records from a monotonic arena whose memory is released only as a whole. */
+  STD_ALLOC_MONOTONIC = 2,
+  /** To allocate records from pools of fixed-size blocks owned by the database. */
+  STD_ALLOC_POOL = 3,
+};
+
+/**
+ * Gets the name of a memory allocator of StdHashDBM and StdTreeDBM.
+ * @param alloc_type The memory allocator.
+ * @return The name of the memory allocator: "global", "monotonic", or "pool".
+ */
+const char* GetStdAllocatorTypeName(StdAllocatorType alloc_type);
+
+/**
+ * Parses the name of a memory allocator of StdHashDBM and StdTreeDBM.
+ * @param name The name of the memory allocator, which is case-insensitive.
+ * @return The memory allocator, or STD_ALLOC_DEFAULT if the name is unknown.
+ */
+StdAllocatorType ParseStdAllocatorType(std::string_view name);
 
 /**
  * On-memory database manager implemented with std::unordered_map.
@@ -133,26 +161,33 @@ class StdHashDBM final : public DBM {
      * Constructor.
      * @param dbm_impl The database implementation object.
      */
-    explicit Iterator(StdHashDBMImpl* dbm_impl);
+    explicit Iterator(StdDBMImplBase* dbm_impl);
 
     /** Pointer to the actual implementation. */
-    StdHashDBMIteratorImpl* impl_;
+    StdDBMIteratorImplBase* impl_;
   };
 
   /**
    * Default constructor.
    * @param num_buckets The number of buckets of the rebuild hash table.  -1 means that the
    * default value 1048583 is set.
+   * @param alloc_type The memory allocator of records.
+   * @details With STD_ALLOC_MONOTONIC or STD_ALLOC_POOL, std::pmr::unordered_map is used and the
+   * hash table and the records are allocated from a memory resource owned by the database, which
+   * Clear and Close release as a whole.  Otherwise, std::unordered_map is used.
    */
-  explicit StdHashDBM(int64_t num_buckets = -1);
+  explicit StdHashDBM(int64_t num_buckets = -1,
+                      StdAllocatorType alloc_type = STD_ALLOC_DEFAULT);
 
   /**
    * Constructor with a file object.
    * @param file The file object to handle the data.  The ownership is taken.
    * @param num_buckets The number of buckets of the rebuild hash table.  -1 means that the
    * default value 1048583 is set.
+   * @param alloc_type The memory allocator of records.
    */
-  StdHashDBM(std::unique_ptr<File> file, int64_t num_buckets = -1);
+  StdHashDBM(std::unique_ptr<File> file, int64_t num_buckets = -1,
+             StdAllocatorType alloc_type = STD_ALLOC_DEFAULT);
 
   /**
    * Destructor.
@@ -305,12 +340,9 @@ class StdHashDBM final : public DBM {
 
  private:
   /** Pointer to the actual implementation. */
-  class StdHashDBMImpl* impl_;
+  StdDBMImplBase* impl_;
 };
 
-class StdTreeDBMImpl;
-class StdTreeDBMIteratorImpl;
-
 /**
  * On-memory database manager implemented with std::map.
  * @details All operations are thread-safe; Multiple threads can access the same database
@@ -413,22 +445,28 @@ class StdTreeDBM final : public DBM {
      * Constructor.
      * @param dbm_impl The database implementation object.
      */
-    explicit Iterator(StdTreeDBMImpl* dbm_impl);
+    explicit Iterator(StdDBMImplBase* dbm_impl);
 
     /** Pointer to the actual implementation. */
-    StdTreeDBMIteratorImpl* impl_;
+    StdDBMIteratorImplBase* impl_;
   };
 
   /**
    * Default constructor.
+   * @param alloc_type The memory allocator of records.
+   * @details With STD_ALLOC_MONOTONIC or STD_ALLOC_POOL, std::pmr::map is used and the tree
+   * nodes and the records are allocated from a memory resource owned by the database, which Clear
+   * and Close release as a whole.  Otherwise, std::map is used.
    */
-  StdTreeDBM();
+  explicit StdTreeDBM(StdAllocatorType alloc_type = STD_ALLOC_DEFAULT);
 
   /**
    * Constructor with a file object.
    * @param file The file object to handle the data.  The ownership is taken.
+   * @param alloc_type The memory allocator of records.
    */
-  explicit StdTreeDBM(std::unique_ptr<File> file);
+  explicit StdTreeDBM(std::unique_ptr<File> file,
+                      StdAllocatorType alloc_type = STD_ALLOC_DEFAULT);
 
   /**
    * Destructor.
@@ -581,7 +619,7 @@ class StdTreeDBM final : public DBM {
 
  private:
   /** Pointer to the actual implementation. */
-  class StdTreeDBMImpl* impl_;
+  StdDBMImplBase* impl_;
 };
 
 }  // namespace tkrzw
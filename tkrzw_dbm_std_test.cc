@@ -97,6 +97,29 @@ TEST_F(StdHashDBMTest, RecordMigration) {
   EXPECT_EQ(tkrzw::Status::SUCCESS, file.Close());
 }
 
+TEST_F(StdHashDBMTest, Allocator) {
+  for (const auto alloc_type :
+           {tkrzw::STD_ALLOC_GLOBAL, tkrzw::STD_ALLOC_MONOTONIC, tkrzw::STD_ALLOC_POOL}) {
+    tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+    const std::string file_path = tmp_dir.MakeUniquePath();
+    tkrzw::StdHashDBM dbm(1000, alloc_type);
+    const auto meta = dbm.Inspect();
+    EXPECT_EQ(tkrzw::GetStdAllocatorTypeName(alloc_type),
+              tkrzw::SearchMap(std::map<std::string, std::string>(meta.begin(), meta.end()),
+                               "allocator", ""));
+    EXPECT_EQ(alloc_type, tkrzw::ParseStdAllocatorType(
+        tkrzw::GetStdAllocatorTypeName(alloc_type)));
+    BasicTest(&dbm);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Clear());
+    ProcessTest(&dbm);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Clear());
+    FileTest(&dbm, file_path);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Clear());
+    RandomTestThread(&dbm);
+  }
+  EXPECT_EQ(tkrzw::STD_ALLOC_DEFAULT, tkrzw::ParseStdAllocatorType("unknown"));
+}
+
 class StdTreeDBMTest : public CommonDBMTest {};
 
 TEST_F(StdTreeDBMTest, File) {
@@ -171,4 +194,27 @@ TEST_F(StdTreeDBMTest, IteratorBound) {
   IteratorBoundTest(&dbm);
 }
 
+TEST_F(StdTreeDBMTest, Allocator) {
+  for (const auto alloc_type :
+           {tkrzw::STD_ALLOC_GLOBAL, tkrzw::STD_ALLOC_MONOTONIC, tkrzw::STD_ALLOC_POOL}) {
+    tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+    const std::string file_path = tmp_dir.MakeUniquePath();
+    tkrzw::StdTreeDBM dbm(alloc_type);
+    const auto meta = dbm.Inspect();
+    EXPECT_EQ(tkrzw::GetStdAllocatorTypeName(alloc_type),
+              tkrzw::SearchMap(std::map<std::string, std::string>(meta.begin(), meta.end()),
+                               "allocator", ""));
+    EXPECT_EQ(alloc_type, tkrzw::ParseStdAllocatorType(
+        tkrzw::GetStdAllocatorTypeName(alloc_type)));
+    BasicTest(&dbm);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Clear());
+    ProcessTest(&dbm);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Clear());
+    FileTest(&dbm, file_path);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Clear());
+    RandomTestThread(&dbm);
+  }
+  EXPECT_EQ(tkrzw::STD_ALLOC_DEFAULT, tkrzw::ParseStdAllocatorType("unknown"));
+}
+
 // END OF FILE
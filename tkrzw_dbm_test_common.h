@@ -39,6 +39,7 @@ class CommonDBMTest : public Test {
   void RecordMigrationTest(tkrzw::DBM* dbm, tkrzw::File* file);
   void BackIteratorTest(tkrzw::DBM* dbm);
   void IteratorBoundTest(tkrzw::DBM* dbm);
+  void AsyncTest(tkrzw::DBM* dbm);
 };
 
 inline void CommonDBMTest::FileTest(tkrzw::DBM* dbm, const std::string& path) {
@@ -1133,4 +1134,29 @@ inline void CommonDBMTest::IteratorBoundTest(tkrzw::DBM* dbm) {
   EXPECT_EQ("", iter->GetKey());
 }
 
+inline void CommonDBMTest::AsyncTest(tkrzw::DBM* dbm) {
+  constexpr int32_t num_records = 1000;
+  std::vector<std::future<tkrzw::Status>> set_futures;
+  for (int32_t i = 0; i < num_records; i++) {
+    set_futures.emplace_back(dbm->SetAsync(tkrzw::ToString(i), tkrzw::ToString(i * i)));
+  }
+  for (auto& future : set_futures) {
+    EXPECT_EQ(tkrzw::Status::SUCCESS, future.get());
+  }
+  EXPECT_EQ(num_records, dbm->CountSimple());
+  EXPECT_EQ(tkrzw::Status::DUPLICATION_ERROR, dbm->SetAsync("0", "zero", false).get());
+  std::vector<std::future<std::pair<tkrzw::Status, std::string>>> get_futures;
+  for (int32_t i = 0; i < num_records; i++) {
+    get_futures.emplace_back(dbm->GetAsync(tkrzw::ToString(i)));
+  }
+  for (int32_t i = 0; i < num_records; i++) {
+    const auto result = get_futures[i].get();
+    EXPECT_EQ(tkrzw::Status::SUCCESS, result.first);
+    EXPECT_EQ(tkrzw::ToString(i * i), result.second);
+  }
+  const auto result = dbm->GetAsync("missing").get();
+  EXPECT_EQ(tkrzw::Status::NOT_FOUND_ERROR, result.first);
+  EXPECT_EQ("", result.second);
+}
+
 // END OF FILE
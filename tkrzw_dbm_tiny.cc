@@ -11,6 +11,7 @@
  * and limitations under the License.
  *************************************************************************************************/
 
+#include "tkrzw_containers.h"
 #include "tkrzw_dbm.h"
 #include "tkrzw_dbm_common_impl.h"
 #include "tkrzw_dbm_tiny.h"
@@ -27,6 +28,19 @@ namespace tkrzw {
 
 constexpr int32_t RECORD_MUTEX_NUM_SLOTS = 128;
 constexpr int64_t MAX_NUM_BUCKETS = 1099511627689LL;
+constexpr int32_t RESIZE_MIGRATION_STEP = 8;
+constexpr int32_t IMPORT_MAX_THREADS = 8;
+constexpr int64_t SNAPSHOT_BUFFER_SIZE = 1LL << 20;
+constexpr char SNAPSHOT_MAGIC[8] = {'T', 'k', 'r', 'z', 'w', 'T', 'S', 'N'};
+constexpr uint32_t SNAPSHOT_ENDIAN_MARK = 0x01020304;
+constexpr int32_t SWISS_GROUP_SIZE = 16;
+constexpr uint8_t SWISS_TAG_EMPTY = 0x00;
+constexpr uint8_t SWISS_TAG_USED = 0x80;
+#if defined(_TKRZW_SIMD_NEON)
+constexpr int32_t SWISS_LANE_WIDTH = 4;
+#else
+constexpr int32_t SWISS_LANE_WIDTH = 1;
+#endif
 
 struct TinyRecord final {
   char* child;
@@ -34,18 +48,47 @@ struct TinyRecord final {
   const char* key_ptr;
   int32_t value_size;
   const char* value_ptr;
-  char* Serialize() const;
-  char* Reserialize(char* ptr, int32_t old_value_size) const;
-  char* ReserializeAppend(
-      char* ptr, const std::string_view cat_value, const std::string_view cat_delim) const;
+  char* Serialize(SlabAllocator* alloc) const;
+  char* Reserialize(char* ptr, int32_t old_value_size, SlabAllocator* alloc,
+                    bool borrowed) const;
+  char* ReserializeAppend(char* ptr, const std::string_view cat_value,
+                          const std::string_view cat_delim, SlabAllocator* alloc,
+                          bool borrowed) const;
   void Deserialize(const char* ptr);
+  bool Deserialize(const char* ptr, int64_t max_size);
+  int32_t GetSerializedSize() const;
+};
+
+struct SwissGroup final {
+  uint8_t tags[SWISS_GROUP_SIZE];
+  char* records[SWISS_GROUP_SIZE];
+  SwissGroup* overflow;
+};
+
+struct SnapshotHeader final {
+  char magic[sizeof(SNAPSHOT_MAGIC)];
+  uint32_t endian_mark;
+  int32_t table_type;
+  int64_t num_buckets;
+  int64_t num_groups;
+  int64_t num_records;
+  int64_t records_offset;
+  int64_t end_offset;
+  int64_t reserved;
+};
+
+struct SnapshotGroup final {
+  uint8_t tags[SWISS_GROUP_SIZE];
+  int64_t overflow;
+  int64_t records[SWISS_GROUP_SIZE];
 };
 
 class TinyDBMImpl final {
   friend class TinyDBMIteratorImpl;
   typedef std::list<TinyDBMIteratorImpl*> IteratorList;
  public:
-  TinyDBMImpl(std::unique_ptr<File> file, int64_t num_buckets);
+  TinyDBMImpl(std::unique_ptr<File> file, int64_t num_buckets, TinyDBM::TableType table_type,
+              TinyDBM::FileFormat file_format);
   ~TinyDBMImpl();
   Status Open(const std::string& path, bool writable, int32_t options);
   Status Close();
@@ -66,14 +109,46 @@ class TinyDBMImpl final {
 
  private:
   void CancelIterators();
+  void SetNumBuckets(int64_t num_buckets);
   void InitializeBuckets();
+  void ReleaseBuckets();
   void ReleaseAllRecords();
-  Status ImportRecords();
-  Status ExportRecords();
-  void ProcessImpl(
-      std::string_view key, int64_t bucket_index, DBM::RecordProcessor* proc, bool writable);
-  void AppendImpl(
-      std::string_view key, int64_t bucket_index, std::string_view value, std::string_view delim);
+  void FreeRecord(char* ptr, int32_t size);
+  Status ImportRecords(const std::string& path);
+  Status ImportFlatRecords();
+  Status ImportSnapshot(const std::string& path);
+  Status ExportRecords(bool synchronize, bool hard);
+  Status WriteFlatRecords(File* file);
+  Status WriteSnapshot(File* file);
+  int64_t GetBucketIndex(uint64_t hash, int64_t num_buckets);
+  int64_t GetLockIndex(uint64_t hash);
+  int64_t GetNumLockBuckets();
+  template <typename FUNC>
+  void IterateBucket(int64_t bucket_index, FUNC func);
+  template <typename FUNC>
+  void IterateLockedBuckets(int64_t lock_index, FUNC func);
+  bool HasOldRecords(int64_t old_bucket_index);
+  void MigrateBucket(int64_t old_bucket_index);
+  bool MigrateSomeBuckets();
+  int64_t GetCapacity();
+  bool ShouldGrow();
+  void ReserveBuckets(int64_t num_records);
+  void AdjustBuckets();
+  void StartResize();
+  void FinishResize();
+  void ProcessImpl(std::string_view key, uint64_t hash, DBM::RecordProcessor* proc,
+                   bool writable);
+  void ProcessImplChain(std::string_view key, char** bucket,
+                        DBM::RecordProcessor* proc, bool writable);
+  void ProcessImplSwiss(std::string_view key, SwissGroup* group, uint8_t tag,
+                        DBM::RecordProcessor* proc, bool writable);
+  void AppendImpl(std::string_view key, uint64_t hash,
+                  std::string_view value, std::string_view delim);
+  void AppendImplChain(std::string_view key, char** bucket,
+                       std::string_view value, std::string_view delim);
+  void AppendImplSwiss(std::string_view key, SwissGroup* group, uint8_t tag,
+                       std::string_view value, std::string_view delim);
+  void InsertSwiss(SwissGroup* group, uint8_t tag, char* ptr);
   Status ReadNextBucketRecords(TinyDBMIteratorImpl* iter);
 
   IteratorList iterators_;
@@ -81,9 +156,21 @@ class TinyDBMImpl final {
   bool open_;
   bool writable_;
   std::string path_;
+  int32_t open_options_;
   std::atomic_int64_t num_records_;
+  TinyDBM::TableType table_type_;
+  TinyDBM::FileFormat file_format_;
+  TinyDBM::FileFormat open_format_;
   int64_t num_buckets_;
   char** buckets_;
+  SwissGroup* groups_;
+  int64_t old_num_buckets_;
+  char** old_buckets_;
+  SwissGroup* old_groups_;
+  std::atomic_int64_t migration_cursor_;
+  std::atomic_int64_t num_migrated_;
+  SlabAllocator alloc_;
+  PrivateMemoryMap snapshot_;
   std::shared_timed_mutex mutex_;
   HashMutex record_mutex_;
 };
@@ -103,13 +190,45 @@ class TinyDBMIteratorImpl final {
 
   TinyDBMImpl* dbm_;
   std::atomic_int64_t bucket_index_;
+  std::atomic_int64_t num_buckets_;
   std::vector<std::string> keys_;
 };
 
-char* TinyRecord::Serialize() const {
-  const int32_t size = sizeof(child) + SizeVarNum(key_size) + key_size +
-      SizeVarNum(value_size) + value_size;
-  char* ptr = static_cast<char*>(xmalloc(size));
+inline uint64_t MatchSwissTags(const uint8_t* tags, uint8_t tag) {
+#if defined(_TKRZW_SIMD_SSE2)
+  const __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tags));
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(tag)));
+#elif defined(_TKRZW_SIMD_NEON)
+  const uint8x16_t eq = vceqq_u8(vld1q_u8(tags), vdupq_n_u8(tag));
+  const uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(eq), 4);
+  return vget_lane_u64(vreinterpret_u64_u8(nibbles), 0);
+#else
+  uint64_t mask = 0;
+  for (int32_t i = 0; i < SWISS_GROUP_SIZE; i++) {
+    if (tags[i] == tag) {
+      mask |= 1ULL << i;
+    }
+  }
+  return mask;
+#endif
+}
+
+inline int32_t PopSwissLane(uint64_t* mask) {
+  const int32_t bit = __builtin_ctzll(*mask);
+  *mask &= ~(((1ULL << SWISS_LANE_WIDTH) - 1) << bit);
+  return bit / SWISS_LANE_WIDTH;
+}
+
+inline uint64_t HashRecordKey(std::string_view key) {
+  return PrimaryHash(key, UINT64MAX);
+}
+
+inline uint8_t GetSwissTag(uint64_t hash) {
+  return SWISS_TAG_USED | (hash & 0x7F);
+}
+
+char* TinyRecord::Serialize(SlabAllocator* alloc) const {
+  char* ptr = static_cast<char*>(alloc->Allocate(GetSerializedSize()));
   char* wp = ptr;
   std::memcpy(wp, &child, sizeof(child));
   wp += sizeof(child);
@@ -121,34 +240,38 @@ char* TinyRecord::Serialize() const {
   return ptr;
 }
 
-char* TinyRecord::Reserialize(char* ptr, int32_t old_value_size) const {
+char* TinyRecord::Reserialize(char* ptr, int32_t old_value_size, SlabAllocator* alloc,
+                              bool borrowed) const {
   const int32_t old_value_header_size = SizeVarNum(old_value_size);
   const int32_t new_value_header_size = SizeVarNum(value_size);
-  if (new_value_header_size > old_value_header_size) {
-    char* new_ptr = Serialize();
-    xfree(ptr);
+  const int32_t old_size = sizeof(child) + SizeVarNum(key_size) + key_size +
+      old_value_header_size + old_value_size;
+  if (borrowed || new_value_header_size > old_value_header_size ||
+      SlabAllocator::GetClassSize(GetSerializedSize()) != SlabAllocator::GetClassSize(old_size)) {
+    char* new_ptr = Serialize(alloc);
+    if (!borrowed) {
+      alloc->Deallocate(ptr, old_size);
+    }
     return new_ptr;
   }
-  if (value_size > old_value_size) {
-    const int32_t size = sizeof(child) + SizeVarNum(key_size) + key_size +
-        SizeVarNum(value_size) + value_size;
-    ptr = static_cast<char*>(xrealloc(ptr, size));
-  }
   char* wp = ptr + sizeof(child) + SizeVarNum(key_size) + key_size;
   wp += WriteVarNum(wp, value_size);
   std::memcpy(wp, value_ptr, value_size);
   return ptr;
 }
 
-char* TinyRecord::ReserializeAppend(
-    char* ptr, const std::string_view cat_value, const std::string_view cat_delim) const {
+char* TinyRecord::ReserializeAppend(char* ptr, const std::string_view cat_value,
+                                    const std::string_view cat_delim,
+                                    SlabAllocator* alloc, bool borrowed) const {
   const int32_t new_value_size = value_size + cat_delim.size() + cat_value.size();
   const int32_t old_value_header_size = SizeVarNum(value_size);
   const int32_t new_value_header_size = SizeVarNum(new_value_size);
-  if (new_value_header_size > old_value_header_size) {
-    const int32_t size = sizeof(child) + SizeVarNum(key_size) + key_size +
-        SizeVarNum(new_value_size) + new_value_size;
-    char* new_ptr = static_cast<char*>(xreallocappend(nullptr, size));
+  const int32_t old_size = GetSerializedSize();
+  const int32_t new_size = sizeof(child) + SizeVarNum(key_size) + key_size +
+      new_value_header_size + new_value_size;
+  if (borrowed || new_value_header_size > old_value_header_size ||
+      SlabAllocator::GetClassSize(new_size) != SlabAllocator::GetClassSize(old_size)) {
+    char* new_ptr = static_cast<char*>(alloc->Allocate(new_size));
     char* wp = new_ptr;
     std::memcpy(wp, &child, sizeof(child));
     wp += sizeof(child);
@@ -161,12 +284,11 @@ char* TinyRecord::ReserializeAppend(
     std::memcpy(wp, cat_delim.data(), cat_delim.size());
     wp += cat_delim.size();
     std::memcpy(wp, cat_value.data(), cat_value.size());
-    xfree(ptr);
+    if (!borrowed) {
+      alloc->Deallocate(ptr, old_size);
+    }
     return new_ptr;
   }
-  const int32_t size = sizeof(child) + SizeVarNum(key_size) + key_size +
-      SizeVarNum(new_value_size) + new_value_size;
-  ptr = static_cast<char*>(xreallocappend(ptr, size));
   char* wp = ptr + sizeof(child) + SizeVarNum(key_size) + key_size;
   wp += WriteVarNum(wp, new_value_size);
   wp += value_size;
@@ -180,6 +302,7 @@ void TinyRecord::Deserialize(const char* ptr) {
   const char* rp = ptr;
   constexpr int32_t dummy_size = 1 << 28;
   std::memcpy(&child, rp, sizeof(child));
+  child = ResolveSnapshotLink(ptr, child);
   rp += sizeof(child);
   uint64_t num = 0;
   rp += ReadVarNum(rp, dummy_size, &num);
@@ -191,16 +314,88 @@ void TinyRecord::Deserialize(const char* ptr) {
   value_ptr = rp;
 }
 
-TinyDBMImpl::TinyDBMImpl(std::unique_ptr<File> file, int64_t num_buckets)
+bool TinyRecord::Deserialize(const char* ptr, int64_t max_size) {
+  const char* rp = ptr;
+  if (max_size < static_cast<int64_t>(sizeof(child))) {
+    return false;
+  }
+  std::memcpy(&child, rp, sizeof(child));
+  child = ResolveSnapshotLink(ptr, child);
+  rp += sizeof(child);
+  max_size -= sizeof(child);
+  uint64_t num = 0;
+  int32_t step = ReadVarNum(rp, max_size, &num);
+  if (step < 1 || static_cast<int64_t>(num) > max_size - step) {
+    return false;
+  }
+  rp += step;
+  max_size -= step;
+  key_size = num;
+  key_ptr = rp;
+  rp += key_size;
+  max_size -= key_size;
+  step = ReadVarNum(rp, max_size, &num);
+  if (step < 1 || static_cast<int64_t>(num) > max_size - step) {
+    return false;
+  }
+  rp += step;
+  value_size = num;
+  value_ptr = rp;
+  return true;
+}
+
+int32_t TinyRecord::GetSerializedSize() const {
+  return sizeof(child) + SizeVarNum(key_size) + key_size + SizeVarNum(value_size) + value_size;
+}
+
+template <typename FUNC>
+void IterateChain(char* ptr, FUNC func) {
+  while (ptr != nullptr) {
+    char* child;
+    std::memcpy(&child, ptr, sizeof(child));
+    child = ResolveSnapshotLink(ptr, child);
+    func(ptr);
+    ptr = child;
+  }
+}
+
+template <typename FUNC>
+void IterateSwissGroup(SwissGroup* group, FUNC func) {
+  while (group != nullptr) {
+    for (int32_t i = 0; i < SWISS_GROUP_SIZE; i++) {
+      if (group->tags[i] != SWISS_TAG_EMPTY) {
+        func(group->records[i]);
+      }
+    }
+    group = group->overflow;
+  }
+}
+
+void FreeSwissGroups(SwissGroup* groups, int64_t num_groups) {
+  for (int64_t i = 0; i < num_groups; i++) {
+    SwissGroup* group = groups[i].overflow;
+    while (group != nullptr) {
+      SwissGroup* next = group->overflow;
+      xfree(group);
+      group = next;
+    }
+  }
+  xfree(groups);
+}
+
+TinyDBMImpl::TinyDBMImpl(
+    std::unique_ptr<File> file, int64_t num_buckets, TinyDBM::TableType table_type,
+    TinyDBM::FileFormat file_format)
     : iterators_(), file_(std::move(file)), open_(false), writable_(false), path_(),
-      num_records_(0), num_buckets_(0), buckets_(nullptr),
+      open_options_(File::OPEN_DEFAULT), num_records_(0),
+      table_type_(table_type == TinyDBM::TABLE_DEFAULT ? TinyDBM::TABLE_CHAIN : table_type),
+      file_format_(file_format), open_format_(TinyDBM::FORMAT_FLAT),
+      num_buckets_(0), buckets_(nullptr), groups_(nullptr),
+      old_num_buckets_(0), old_buckets_(nullptr), old_groups_(nullptr),
+      migration_cursor_(0), num_migrated_(0), alloc_(), snapshot_(),
       mutex_(),
       record_mutex_(RECORD_MUTEX_NUM_SLOTS, 1, PrimaryHash) {
-  if (num_buckets > 0) {
-    num_buckets_ = GetHashBucketSize(std::min(num_buckets, MAX_NUM_BUCKETS));
-  } else {
-    num_buckets_ = TinyDBM::DEFAULT_NUM_BUCKETS;
-  }
+  SetNumBuckets(num_buckets > 0 ? num_buckets : TinyDBM::DEFAULT_NUM_BUCKETS);
   InitializeBuckets();
 }
 
@@ -212,7 +407,7 @@ TinyDBMImpl::~TinyDBMImpl() {
     iterator->dbm_ = nullptr;
   }
   ReleaseAllRecords();
-  xfree(buckets_);
+  ReleaseBuckets();
 }
 
 Status TinyDBMImpl::Open(const std::string& path, bool writable, int32_t options) {
@@ -224,7 +419,7 @@ Status TinyDBMImpl::Open(const std::string& path, bool writable, int32_t options
   if (status != Status::SUCCESS) {
     return status;
   }
-  status = ImportRecords();
+  status = ImportRecords(path);
   if (status != Status::SUCCESS) {
     file_->Close();
     return status;
@@ -232,6 +427,7 @@ Status TinyDBMImpl::Open(const std::string& path, bool writable, int32_t options
   open_ = true;
   writable_ = writable;
   path_ = path;
+  open_options_ = options & ~File::OPEN_TRUNCATE;
   return Status(Status::SUCCESS);
 }
 
@@ -242,64 +438,89 @@ Status TinyDBMImpl::Close() {
   }
   Status status(Status::SUCCESS);
   if (writable_) {
-    status |= ExportRecords();
+    status |= ExportRecords(false, false);
   }
   status |= file_->Close();
   ReleaseAllRecords();
   CancelIterators();
-  xfree(buckets_);
+  ReleaseBuckets();
   InitializeBuckets();
   open_ = false;
   writable_ = false;
   path_.clear();
+  open_options_ = File::OPEN_DEFAULT;
+  open_format_ = TinyDBM::FORMAT_FLAT;
   num_records_.store(0);
   return status;
 }
 
 Status TinyDBMImpl::Process(std::string_view key, DBM::RecordProcessor* proc, bool writable) {
-  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
-  ScopedHashLock record_lock(record_mutex_, key, writable);
-  const int64_t bucket_index = record_lock.GetBucketIndex();
-  ProcessImpl(key, bucket_index, proc, writable);
+  bool adjust = false;
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    const uint64_t hash = HashRecordKey(key);
+    {
+      ScopedHashLock record_lock(record_mutex_, GetLockIndex(hash), writable);
+      ProcessImpl(key, hash, proc, writable);
+    }
+    if (writable) {
+      adjust = MigrateSomeBuckets();
+    }
+  }
+  if (adjust) {
+    AdjustBuckets();
+  }
   return Status(Status::SUCCESS);
 }
 
 Status TinyDBMImpl::Append(std::string_view key, std::string_view value, std::string_view delim) {
-  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
-  ScopedHashLock record_lock(record_mutex_, key, true);
-  const int64_t bucket_index = record_lock.GetBucketIndex();
-  AppendImpl(key, bucket_index, value, delim);
+  bool adjust = false;
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    const uint64_t hash = HashRecordKey(key);
+    {
+      ScopedHashLock record_lock(record_mutex_, GetLockIndex(hash), true);
+      AppendImpl(key, hash, value, delim);
+    }
+    adjust = MigrateSomeBuckets();
+  }
+  if (adjust) {
+    AdjustBuckets();
+  }
   return Status(Status::SUCCESS);
 }
 
 Status TinyDBMImpl::ProcessEach(DBM::RecordProcessor* proc, bool writable) {
   if (writable) {
     std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+    FinishResize();
     proc->ProcessEmpty(DBM::RecordProcessor::NOOP);
-    TinyRecord rec;
+    std::vector<std::string> keys;
     for (int64_t bucket_index = 0; bucket_index < num_buckets_; bucket_index++) {
-      char* ptr = buckets_[bucket_index];
-      while (ptr != nullptr) {
-        rec.Deserialize(ptr);
-        const std::string key(rec.key_ptr, rec.key_size);
-        ProcessImpl(key, bucket_index, proc, true);
-        ptr = rec.child;
+      keys.clear();
+      IterateBucket(bucket_index, [&](char* ptr) {
+          TinyRecord rec;
+          rec.Deserialize(ptr);
+          keys.emplace_back(std::string(rec.key_ptr, rec.key_size));
+        });
+      for (const auto& key : keys) {
+        ProcessImpl(key, HashRecordKey(key), proc, true);
       }
     }
     proc->ProcessEmpty(DBM::RecordProcessor::NOOP);
   } else {
     std::shared_lock<std::shared_timed_mutex> lock(mutex_);
     proc->ProcessEmpty(DBM::RecordProcessor::NOOP);
-    TinyRecord rec;
-    for (int64_t bucket_index = 0; bucket_index < num_buckets_; bucket_index++) {
-      char* ptr = buckets_[bucket_index];
-      while (ptr != nullptr) {
-        rec.Deserialize(ptr);
-        const std::string_view key(rec.key_ptr, rec.key_size);
-        const std::string_view value (rec.value_ptr, rec.value_size);
-        proc->ProcessFull(key, value);
-        ptr = rec.child;
-      }
+    const int64_t num_lock_buckets = GetNumLockBuckets();
+    for (int64_t lock_index = 0; lock_index < num_lock_buckets; lock_index++) {
+      ScopedHashLock record_lock(record_mutex_, lock_index, false);
+      IterateLockedBuckets(lock_index, [&](char* ptr) {
+          TinyRecord rec;
+          rec.Deserialize(ptr);
+          const std::string_view key(rec.key_ptr, rec.key_size);
+          const std::string_view value (rec.value_ptr, rec.value_size);
+          proc->ProcessFull(key, value);
+        });
     }
     proc->ProcessEmpty(DBM::RecordProcessor::NOOP);
   }
@@ -334,7 +555,7 @@ Status TinyDBMImpl::Clear() {
   std::lock_guard<std::shared_timed_mutex> lock(mutex_);
   ReleaseAllRecords();
   CancelIterators();
-  xfree(buckets_);
+  ReleaseBuckets();
   InitializeBuckets();
   num_records_.store(0);
   return Status(Status::SUCCESS);
@@ -342,32 +563,44 @@ Status TinyDBMImpl::Clear() {
 
 Status TinyDBMImpl::Rebuild(int64_t num_buckets) {
   std::lock_guard<std::shared_timed_mutex> lock(mutex_);
-  const int64_t old_num_buckets_ = num_buckets_;
+  FinishResize();
+  const int64_t old_num_buckets = num_buckets_;
   char** old_buckets = buckets_;
-  num_buckets_ = num_buckets > 0 ? num_buckets : num_records_ * 2 + 1;
-  num_buckets_ = GetHashBucketSize(std::min(num_buckets_, MAX_NUM_BUCKETS));
+  SwissGroup* old_groups = groups_;
+  SetNumBuckets(num_buckets > 0 ? num_buckets : num_records_ * 2 + 1);
   InitializeBuckets();
-  TinyRecord rec;
-  for (int64_t old_bucket_index = 0; old_bucket_index < old_num_buckets_; old_bucket_index++) {
-    char* ptr = old_buckets[old_bucket_index];
-    while (ptr != nullptr) {
-      rec.Deserialize(ptr);
-      const std::string_view rec_key(rec.key_ptr, rec.key_size);
-      const int64_t bucket_index = record_mutex_.GetBucketIndex(rec_key);
+  auto relink = [&](char* ptr) {
+    TinyRecord rec;
+    rec.Deserialize(ptr);
+    const uint64_t hash = HashRecordKey(std::string_view(rec.key_ptr, rec.key_size));
+    const int64_t bucket_index = GetBucketIndex(hash, num_buckets_);
+    if (table_type_ == TinyDBM::TABLE_SWISS) {
+      InsertSwiss(groups_ + bucket_index, GetSwissTag(hash), ptr);
+    } else {
       const char* top = buckets_[bucket_index];
-      memcpy(ptr, &top, sizeof(top));
+      std::memcpy(ptr, &top, sizeof(top));
       buckets_[bucket_index] = ptr;
-      ptr = rec.child;
+    }
+  };
+  for (int64_t old_bucket_index = 0; old_bucket_index < old_num_buckets; old_bucket_index++) {
+    if (old_groups != nullptr) {
+      IterateSwissGroup(old_groups + old_bucket_index, relink);
+    } else {
+      IterateChain(old_buckets[old_bucket_index], relink);
     }
   }
-  xfree(old_buckets);
+  if (old_groups != nullptr) {
+    FreeSwissGroups(old_groups, old_num_buckets);
+  } else {
+    xfree(old_buckets);
+  }
   CancelIterators();
   return Status(Status::SUCCESS);
 }
 
 Status TinyDBMImpl::ShouldBeRebuilt(bool* tobe) {
   std::shared_lock<std::shared_timed_mutex> lock(mutex_);
-  *tobe = num_records_.load() > num_buckets_;
+  *tobe = num_records_.load() > GetCapacity();
   return Status(Status::SUCCESS);
 }
 
@@ -375,8 +608,7 @@ Status TinyDBMImpl::Synchronize(bool hard, DBM::FileProcessor* proc) {
   std::lock_guard<std::shared_timed_mutex> lock(mutex_);
   Status status(Status::SUCCESS);
   if (open_ && writable_) {
-    status |= ExportRecords();
-    status |= file_->Synchronize(hard);
+    status |= ExportRecords(true, hard);
     if (proc != nullptr) {
       proc->Process(path_);
     }
@@ -395,7 +627,19 @@ std::vector<std::pair<std::string, std::string>> TinyDBMImpl::Inspect() {
     Add("path", path_);
   }
   Add("num_records", ToString(num_records_.load()));
-  Add("num_buckets", ToString(num_buckets_));
+  Add("num_buckets", ToString(table_type_ == TinyDBM::TABLE_SWISS ?
+                              num_buckets_ * SWISS_GROUP_SIZE : num_buckets_));
+  Add("num_old_buckets", ToString(table_type_ == TinyDBM::TABLE_SWISS ?
+                                  old_num_buckets_ * SWISS_GROUP_SIZE : old_num_buckets_));
+  Add("table_type", TinyDBM::GetTableTypeName(table_type_));
+  Add("slab_reserved_size", ToString(alloc_.GetReservedSize()));
+  Add("slab_occupied_size", ToString(alloc_.GetOccupiedSize()));
+  Add("slab_used_size", ToString(alloc_.GetUsedSize()));
+  Add("slab_num_blocks", ToString(alloc_.GetNumBlocks()));
+  if (open_) {
+    Add("file_format", TinyDBM::GetFileFormatName(open_format_));
+  }
+  Add("snapshot_size", ToString(snapshot_.Size()));
   return meta;
 }
 
@@ -411,7 +655,9 @@ bool TinyDBMImpl::IsWritable() {
 
 std::unique_ptr<DBM> TinyDBMImpl::MakeDBM() {
   std::shared_lock<std::shared_timed_mutex> lock(mutex_);
-  return std::make_unique<TinyDBM>(file_->MakeFile(), num_buckets_);
+  const int64_t num_buckets = table_type_ == TinyDBM::TABLE_SWISS ?
+      num_buckets_ * SWISS_GROUP_SIZE : num_buckets_;
+  return std::make_unique<TinyDBM>(file_->MakeFile(), num_buckets, table_type_, file_format_);
 }
 
 void TinyDBMImpl::CancelIterators() {
@@ -420,86 +666,599 @@ void TinyDBMImpl::CancelIterators() {
   }
 }
 
+void TinyDBMImpl::SetNumBuckets(int64_t num_buckets) {
+  num_buckets = std::min(num_buckets, MAX_NUM_BUCKETS);
+  if (table_type_ == TinyDBM::TABLE_SWISS) {
+    num_buckets = std::max<int64_t>(num_buckets / SWISS_GROUP_SIZE, 1);
+  }
+  num_buckets_ = GetHashBucketSize(num_buckets);
+}
+
 void TinyDBMImpl::InitializeBuckets() {
-  buckets_ = static_cast<char**>(xcalloc(num_buckets_, sizeof(*buckets_)));
+  if (table_type_ == TinyDBM::TABLE_SWISS) {
+    groups_ = static_cast<SwissGroup*>(xcalloc(num_buckets_, sizeof(*groups_)));
+  } else {
+    buckets_ = static_cast<char**>(xcalloc(num_buckets_, sizeof(*buckets_)));
+  }
   record_mutex_.Rehash(num_buckets_);
 }
 
+void TinyDBMImpl::ReleaseBuckets() {
+  if (groups_ != nullptr) {
+    FreeSwissGroups(groups_, num_buckets_);
+    groups_ = nullptr;
+  }
+  xfree(buckets_);
+  buckets_ = nullptr;
+  if (old_groups_ != nullptr) {
+    FreeSwissGroups(old_groups_, old_num_buckets_);
+    old_groups_ = nullptr;
+  }
+  xfree(old_buckets_);
+  old_buckets_ = nullptr;
+  old_num_buckets_ = 0;
+}
+
 void TinyDBMImpl::ReleaseAllRecords() {
-  for (int64_t bucket_index = 0; bucket_index < num_buckets_; bucket_index++) {
-    char* ptr = buckets_[bucket_index];
-    while (ptr != nullptr) {
-      char* child;
-      std::memcpy(&child, ptr, sizeof(child));
-      xfree(ptr);
-      ptr = child;
-    }
+  const int64_t num_lock_buckets = GetNumLockBuckets();
+  for (int64_t lock_index = 0; lock_index < num_lock_buckets; lock_index++) {
+    IterateLockedBuckets(lock_index, [&](char* ptr) {
+        TinyRecord rec;
+        rec.Deserialize(ptr);
+        FreeRecord(ptr, rec.GetSerializedSize());
+      });
+  }
+  alloc_.Clear();
+  if (snapshot_.Pointer() != nullptr) {
+    snapshot_.Close();
+  }
+}
+
+void TinyDBMImpl::FreeRecord(char* ptr, int32_t size) {
+  if (!snapshot_.Contains(ptr)) {
+    alloc_.Deallocate(ptr, size);
   }
 }
 
-Status TinyDBMImpl::ImportRecords() {
-  int64_t end_offset = 0;
-  Status status = file_->GetSize(&end_offset);
+Status TinyDBMImpl::ImportRecords(const std::string& path) {
+  int64_t file_size = 0;
+  Status status = file_->GetSize(&file_size);
   if (status != Status::SUCCESS) {
     return status;
   }
-  FlatRecordReader reader(file_.get());
-  std::string key_store;
-  while (true) {
-    std::string_view key;
-    Status status = reader.Read(&key);
+  open_format_ = TinyDBM::FORMAT_FLAT;
+  if (file_size >= static_cast<int64_t>(sizeof(SnapshotHeader))) {
+    char magic[sizeof(SNAPSHOT_MAGIC)];
+    status = file_->Read(0, magic, sizeof(magic));
     if (status != Status::SUCCESS) {
-      if (status != Status::NOT_FOUND_ERROR) {
-        return status;
+      return status;
+    }
+    if (std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) == 0) {
+      open_format_ = TinyDBM::FORMAT_SNAPSHOT;
+      return ImportSnapshot(path);
+    }
+  }
+  return ImportFlatRecords();
+}
+
+Status TinyDBMImpl::ImportFlatRecords() {
+  const int32_t num_threads = std::min(
+      std::max(static_cast<int32_t>(std::thread::hardware_concurrency()), 2),
+      IMPORT_MAX_THREADS);
+  return ImportFlatRecordsInParallel(
+      file_.get(), num_threads,
+      [&](int64_t batch_size) {
+        ReserveBuckets(num_records_.load() + batch_size);
+      },
+      [&](uint64_t hash) {
+        return GetBucketIndex(hash, num_buckets_) % num_threads;
+      },
+      [&](std::string_view key, std::string_view value, uint64_t hash) {
+        Status status(Status::SUCCESS);
+        DBM::RecordProcessorSet setter(&status, value, true);
+        ProcessImpl(key, hash, &setter, true);
+      });
+}
+
+Status TinyDBMImpl::ImportSnapshot(const std::string& path) {
+  Status status = snapshot_.Open(path);
+  if (status != Status::SUCCESS) {
+    return status;
+  }
+  char* const base = snapshot_.Pointer();
+  SnapshotHeader head;
+  std::memcpy(&head, base, sizeof(head));
+  const int64_t size = head.end_offset;
+  const bool swiss = head.table_type == TinyDBM::TABLE_SWISS;
+  const int64_t table_size = swiss ?
+      head.num_groups * static_cast<int64_t>(sizeof(SnapshotGroup)) :
+      head.num_buckets * static_cast<int64_t>(sizeof(int64_t));
+  if (head.endian_mark != SNAPSHOT_ENDIAN_MARK ||
+      (head.table_type != TinyDBM::TABLE_CHAIN && head.table_type != TinyDBM::TABLE_SWISS) ||
+      head.num_buckets < 1 || head.num_buckets > MAX_NUM_BUCKETS ||
+      head.num_groups < head.num_buckets || head.num_groups > size ||
+      head.records_offset != static_cast<int64_t>(sizeof(head)) + table_size ||
+      head.records_offset > size || size > snapshot_.Size()) {
+    snapshot_.Close();
+    return Status(Status::BROKEN_DATA_ERROR, "invalid snapshot header");
+  }
+  if (num_records_.load() > 0 || head.table_type != table_type_) {
+    const char* rp = base + head.records_offset;
+    const char* const end = base + size;
+    while (rp < end) {
+      TinyRecord rec;
+      if (!rec.Deserialize(rp, end - rp)) {
+        status = Status(Status::BROKEN_DATA_ERROR, "invalid snapshot record");
+        break;
       }
-      break;
+      const std::string_view key(rec.key_ptr, rec.key_size);
+      DBM::RecordProcessorSet setter(&status, std::string_view(rec.value_ptr, rec.value_size),
+                                     true);
+      ProcessImpl(key, HashRecordKey(key), &setter, true);
+      if (ShouldGrow()) {
+        StartResize();
+        FinishResize();
+      }
+      rp = rec.value_ptr + rec.value_size;
     }
-    key_store = key;
-    std::string_view value;
-    status = reader.Read(&value);
-    if (status != Status::SUCCESS) {
-      if (status != Status::NOT_FOUND_ERROR) {
-        return status;
+    snapshot_.Close();
+    return status;
+  }
+  // Records are laid out in the order of the table and each record is checked to begin where
+  // the previous one ends.  The mapped pages are only read, as links are resolved on access.
+  ReleaseBuckets();
+  num_buckets_ = head.num_buckets;
+  InitializeBuckets();
+  int64_t num_records = 0;
+  int64_t end_offset = head.records_offset;
+  auto check_record = [&](int64_t offset, TinyRecord* rec) {
+    if (offset != end_offset || !rec->Deserialize(base + offset, size - offset)) {
+      return false;
+    }
+    end_offset = rec->value_ptr + rec->value_size - base;
+    num_records++;
+    return true;
+  };
+  if (swiss) {
+    const SnapshotGroup* disk_groups =
+        reinterpret_cast<const SnapshotGroup*>(base + sizeof(head));
+    for (int64_t group_index = 0; group_index < head.num_groups && status == Status::SUCCESS;
+         group_index++) {
+      SnapshotGroup disk_group;
+      std::memcpy(&disk_group, disk_groups + group_index, sizeof(disk_group));
+      for (int32_t i = 0; i < SWISS_GROUP_SIZE; i++) {
+        TinyRecord rec;
+        if (disk_group.tags[i] != SWISS_TAG_EMPTY &&
+            !check_record(disk_group.records[i], &rec)) {
+          status = Status(Status::BROKEN_DATA_ERROR, "invalid snapshot record");
+          break;
+        }
+      }
+    }
+    for (int64_t bucket_index = 0; bucket_index < num_buckets_ && status == Status::SUCCESS;
+         bucket_index++) {
+      SwissGroup* group = groups_ + bucket_index;
+      int64_t group_index = bucket_index;
+      while (true) {
+        SnapshotGroup disk_group;
+        std::memcpy(&disk_group, disk_groups + group_index, sizeof(disk_group));
+        std::memcpy(group->tags, disk_group.tags, sizeof(group->tags));
+        for (int32_t i = 0; i < SWISS_GROUP_SIZE; i++) {
+          if (group->tags[i] != SWISS_TAG_EMPTY) {
+            group->records[i] = base + disk_group.records[i];
+          }
+        }
+        if (disk_group.overflow == 0) {
+          break;
+        }
+        if (disk_group.overflow <= group_index || disk_group.overflow >= head.num_groups) {
+          status = Status(Status::BROKEN_DATA_ERROR, "invalid snapshot group index");
+          break;
+        }
+        group->overflow = static_cast<SwissGroup*>(xcalloc(1, sizeof(*group->overflow)));
+        group = group->overflow;
+        group_index = disk_group.overflow;
+      }
+    }
+  } else {
+    const char* rp = base + sizeof(head);
+    for (int64_t bucket_index = 0; bucket_index < num_buckets_ && status == Status::SUCCESS;
+         bucket_index++) {
+      int64_t offset = 0;
+      std::memcpy(&offset, rp + bucket_index * sizeof(offset), sizeof(offset));
+      if (offset == 0) {
+        continue;
+      }
+      buckets_[bucket_index] = base + offset;
+      while (true) {
+        TinyRecord rec;
+        if (!check_record(offset, &rec)) {
+          status = Status(Status::BROKEN_DATA_ERROR, "invalid snapshot record");
+          break;
+        }
+        if (rec.child == nullptr) {
+          break;
+        }
+        if (rec.child != base + end_offset) {
+          status = Status(Status::BROKEN_DATA_ERROR, "invalid snapshot record link");
+          break;
+        }
+        offset = end_offset;
       }
-      return Status(Status::BROKEN_DATA_ERROR, "odd number of records");
     }
-    DBM::RecordProcessorSet setter(&status, value, true);
-    ScopedHashLock record_lock(record_mutex_, key_store, true);
-    const int64_t bucket_index = record_lock.GetBucketIndex();
-    ProcessImpl(key_store, bucket_index, &setter, true);
   }
+  if (status == Status::SUCCESS && (end_offset != size || num_records != head.num_records)) {
+    status = Status(Status::BROKEN_DATA_ERROR, "inconsistent number of snapshot records");
+  }
+  if (status != Status::SUCCESS) {
+    ReleaseBuckets();
+    InitializeBuckets();
+    snapshot_.Close();
+    return status;
+  }
+  num_records_.store(num_records);
   return Status(Status::SUCCESS);
 }
 
-Status TinyDBMImpl::ExportRecords() {
-  Status status = file_->Truncate(0);
-  if (status != Status::SUCCESS) {
+Status TinyDBMImpl::ExportRecords(bool synchronize, bool hard) {
+  FinishResize();
+  const TinyDBM::FileFormat format =
+      file_format_ == TinyDBM::FORMAT_DEFAULT ? open_format_ : file_format_;
+  if (format != TinyDBM::FORMAT_SNAPSHOT && snapshot_.Pointer() == nullptr) {
+    Status status = file_->Truncate(0);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+    status = WriteFlatRecords(file_.get());
+    if (synchronize) {
+      status |= file_->Synchronize(hard);
+    }
     return status;
   }
-  FlatRecord flat_rec(file_.get());
-  TinyRecord rec;
+  const Status status = RewriteDBMFile(
+      file_.get(), path_, open_options_,
+      [&](File* file) {
+        return format == TinyDBM::FORMAT_SNAPSHOT ? WriteSnapshot(file) : WriteFlatRecords(file);
+      }, synchronize, hard);
+  if (status == Status::SUCCESS) {
+    open_format_ = format;
+  }
+  return status;
+}
+
+Status TinyDBMImpl::WriteFlatRecords(File* file) {
+  Status status(Status::SUCCESS);
+  FlatRecord flat_rec(file);
   for (int64_t bucket_index = 0; bucket_index < num_buckets_; bucket_index++) {
-    char* ptr = buckets_[bucket_index];
-    while (ptr != nullptr) {
-      rec.Deserialize(ptr);
-      status = flat_rec.Write(std::string_view(rec.key_ptr, rec.key_size));
-      if (status != Status::SUCCESS) {
-        return status;
+    IterateBucket(bucket_index, [&](char* ptr) {
+        if (status != Status::SUCCESS) {
+          return;
+        }
+        TinyRecord rec;
+        rec.Deserialize(ptr);
+        status = flat_rec.Write(std::string_view(rec.key_ptr, rec.key_size));
+        if (status != Status::SUCCESS) {
+          return;
+        }
+        status = flat_rec.Write(std::string_view(rec.value_ptr, rec.value_size));
+      });
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+  }
+  return Status(Status::SUCCESS);
+}
+
+Status TinyDBMImpl::WriteSnapshot(File* file) {
+  const bool swiss = table_type_ == TinyDBM::TABLE_SWISS;
+  std::vector<const SwissGroup*> overflows;
+  if (swiss) {
+    for (int64_t bucket_index = 0; bucket_index < num_buckets_; bucket_index++) {
+      for (const SwissGroup* group = groups_[bucket_index].overflow; group != nullptr;
+           group = group->overflow) {
+        overflows.emplace_back(group);
+      }
+    }
+  }
+  SnapshotHeader head;
+  std::memset(&head, 0, sizeof(head));
+  std::memcpy(head.magic, SNAPSHOT_MAGIC, sizeof(head.magic));
+  head.endian_mark = SNAPSHOT_ENDIAN_MARK;
+  head.table_type = table_type_;
+  head.num_buckets = num_buckets_;
+  head.num_groups = num_buckets_ + overflows.size();
+  head.num_records = num_records_.load();
+  head.records_offset = sizeof(head) + (swiss ?
+      head.num_groups * static_cast<int64_t>(sizeof(SnapshotGroup)) :
+      head.num_buckets * static_cast<int64_t>(sizeof(int64_t)));
+  std::string buffer;
+  buffer.reserve(SNAPSHOT_BUFFER_SIZE * 2);
+  Status status(Status::SUCCESS);
+  auto write = [&](const void* data, size_t size) {
+    buffer.append(static_cast<const char*>(data), size);
+    if (static_cast<int64_t>(buffer.size()) >= SNAPSHOT_BUFFER_SIZE) {
+      status |= file->Append(buffer.data(), buffer.size());
+      buffer.clear();
+    }
+  };
+  write(&head, sizeof(head));
+  int64_t offset = head.records_offset;
+  if (swiss) {
+    auto write_group = [&](const SwissGroup* group, int64_t overflow_index) {
+      SnapshotGroup disk_group;
+      std::memset(&disk_group, 0, sizeof(disk_group));
+      std::memcpy(disk_group.tags, group->tags, sizeof(disk_group.tags));
+      disk_group.overflow = overflow_index;
+      for (int32_t i = 0; i < SWISS_GROUP_SIZE; i++) {
+        if (group->tags[i] != SWISS_TAG_EMPTY) {
+          TinyRecord rec;
+          rec.Deserialize(group->records[i]);
+          disk_group.records[i] = offset;
+          offset += rec.GetSerializedSize();
+        }
+      }
+      write(&disk_group, sizeof(disk_group));
+    };
+    int64_t next_overflow_index = num_buckets_;
+    for (int64_t bucket_index = 0; bucket_index < num_buckets_; bucket_index++) {
+      const SwissGroup* group = groups_ + bucket_index;
+      write_group(group, group->overflow == nullptr ? 0 : next_overflow_index);
+      for (const SwissGroup* overflow = group->overflow; overflow != nullptr;
+           overflow = overflow->overflow) {
+        next_overflow_index++;
       }
-      status = flat_rec.Write(std::string_view(rec.value_ptr, rec.value_size));
-      if (status != Status::SUCCESS) {
-        return status;
+    }
+    for (int64_t i = 0; i < static_cast<int64_t>(overflows.size()); i++) {
+      const SwissGroup* group = overflows[i];
+      write_group(group, group->overflow == nullptr ? 0 : num_buckets_ + i + 1);
+    }
+    auto write_records = [&](const SwissGroup* group) {
+      for (int32_t i = 0; i < SWISS_GROUP_SIZE; i++) {
+        if (group->tags[i] != SWISS_TAG_EMPTY) {
+          TinyRecord rec;
+          rec.Deserialize(group->records[i]);
+          const int64_t child = 0;
+          write(&child, sizeof(child));
+          write(group->records[i] + sizeof(child), rec.GetSerializedSize() - sizeof(child));
+        }
       }
-      ptr = rec.child;
+    };
+    for (int64_t bucket_index = 0; bucket_index < num_buckets_; bucket_index++) {
+      write_records(groups_ + bucket_index);
+    }
+    for (const auto* group : overflows) {
+      write_records(group);
+    }
+  } else {
+    for (int64_t bucket_index = 0; bucket_index < num_buckets_; bucket_index++) {
+      const int64_t head_offset = buckets_[bucket_index] == nullptr ? 0 : offset;
+      write(&head_offset, sizeof(head_offset));
+      IterateChain(buckets_[bucket_index], [&](char* ptr) {
+          TinyRecord rec;
+          rec.Deserialize(ptr);
+          offset += rec.GetSerializedSize();
+        });
+    }
+    offset = head.records_offset;
+    for (int64_t bucket_index = 0; bucket_index < num_buckets_; bucket_index++) {
+      IterateChain(buckets_[bucket_index], [&](char* ptr) {
+          TinyRecord rec;
+          rec.Deserialize(ptr);
+          const int64_t rec_size = rec.GetSerializedSize();
+          const int64_t child =
+              rec.child == nullptr ? 0 : MakeSnapshotLink(offset, offset + rec_size);
+          offset += rec_size;
+          write(&child, sizeof(child));
+          write(ptr + sizeof(child), rec_size - sizeof(child));
+        });
     }
   }
-  return Status(Status::SUCCESS);
+  if (!buffer.empty()) {
+    status |= file->Append(buffer.data(), buffer.size());
+  }
+  head.end_offset = offset;
+  status |= file->Write(offsetof(SnapshotHeader, end_offset), &head.end_offset,
+                        sizeof(head.end_offset));
+  return status;
+}
+
+int64_t TinyDBMImpl::GetBucketIndex(uint64_t hash, int64_t num_buckets) {
+  if (table_type_ == TinyDBM::TABLE_SWISS) {
+    return (hash >> 7) % num_buckets;
+  }
+  return hash % num_buckets;
+}
+
+int64_t TinyDBMImpl::GetLockIndex(uint64_t hash) {
+  return GetBucketIndex(hash, GetNumLockBuckets());
+}
+
+int64_t TinyDBMImpl::GetNumLockBuckets() {
+  return old_num_buckets_ > 0 ? old_num_buckets_ : num_buckets_;
+}
+
+template <typename FUNC>
+void TinyDBMImpl::IterateBucket(int64_t bucket_index, FUNC func) {
+  if (table_type_ == TinyDBM::TABLE_SWISS) {
+    IterateSwissGroup(groups_ + bucket_index, func);
+  } else {
+    IterateChain(buckets_[bucket_index], func);
+  }
+}
+
+template <typename FUNC>
+void TinyDBMImpl::IterateLockedBuckets(int64_t lock_index, FUNC func) {
+  if (old_num_buckets_ > 0) {
+    if (table_type_ == TinyDBM::TABLE_SWISS) {
+      IterateSwissGroup(old_groups_ + lock_index, func);
+    } else {
+      IterateChain(old_buckets_[lock_index], func);
+    }
+    IterateBucket(lock_index, func);
+    IterateBucket(lock_index + old_num_buckets_, func);
+  } else {
+    IterateBucket(lock_index, func);
+  }
+}
+
+bool TinyDBMImpl::HasOldRecords(int64_t old_bucket_index) {
+  if (table_type_ == TinyDBM::TABLE_SWISS) {
+    const SwissGroup* group = old_groups_ + old_bucket_index;
+    uint64_t tags[SWISS_GROUP_SIZE / sizeof(uint64_t)];
+    std::memcpy(tags, group->tags, sizeof(tags));
+    return group->overflow != nullptr || tags[0] != 0 || tags[1] != 0;
+  }
+  return old_buckets_[old_bucket_index] != nullptr;
+}
+
+void TinyDBMImpl::MigrateBucket(int64_t old_bucket_index) {
+  auto relink = [&](char* ptr) {
+    TinyRecord rec;
+    rec.Deserialize(ptr);
+    const uint64_t hash = HashRecordKey(std::string_view(rec.key_ptr, rec.key_size));
+    const int64_t bucket_index = GetBucketIndex(hash, num_buckets_);
+    if (table_type_ == TinyDBM::TABLE_SWISS) {
+      InsertSwiss(groups_ + bucket_index, GetSwissTag(hash), ptr);
+    } else {
+      const char* top = buckets_[bucket_index];
+      std::memcpy(ptr, &top, sizeof(top));
+      buckets_[bucket_index] = ptr;
+    }
+  };
+  if (table_type_ == TinyDBM::TABLE_SWISS) {
+    SwissGroup* group = old_groups_ + old_bucket_index;
+    IterateSwissGroup(group, relink);
+    SwissGroup* overflow = group->overflow;
+    while (overflow != nullptr) {
+      SwissGroup* next = overflow->overflow;
+      xfree(overflow);
+      overflow = next;
+    }
+    std::memset(group, 0, sizeof(*group));
+  } else {
+    IterateChain(old_buckets_[old_bucket_index], relink);
+    old_buckets_[old_bucket_index] = nullptr;
+  }
+}
+
+bool TinyDBMImpl::MigrateSomeBuckets() {
+  if (old_num_buckets_ == 0) {
+    return ShouldGrow();
+  }
+  for (int32_t i = 0; i < RESIZE_MIGRATION_STEP; i++) {
+    const int64_t old_bucket_index = migration_cursor_.fetch_add(1);
+    if (old_bucket_index >= old_num_buckets_) {
+      break;
+    }
+    {
+      ScopedHashLock record_lock(record_mutex_, old_bucket_index, true);
+      if (HasOldRecords(old_bucket_index)) {
+        MigrateBucket(old_bucket_index);
+      }
+    }
+    if (num_migrated_.fetch_add(1) + 1 == old_num_buckets_) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int64_t TinyDBMImpl::GetCapacity() {
+  if (table_type_ == TinyDBM::TABLE_SWISS) {
+    return num_buckets_ * SWISS_GROUP_SIZE * 7 / 8;
+  }
+  return num_buckets_;
+}
+
+bool TinyDBMImpl::ShouldGrow() {
+  if (old_num_buckets_ > 0 || num_buckets_ > MAX_NUM_BUCKETS / 2) {
+    return false;
+  }
+  return num_records_.load() > GetCapacity();
+}
+
+void TinyDBMImpl::ReserveBuckets(int64_t num_records) {
+  FinishResize();
+  while (GetCapacity() < num_records && num_buckets_ <= MAX_NUM_BUCKETS / 2) {
+    StartResize();
+    FinishResize();
+  }
+}
+
+void TinyDBMImpl::AdjustBuckets() {
+  std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+  if (old_num_buckets_ > 0) {
+    if (num_migrated_.load() >= old_num_buckets_) {
+      FinishResize();
+    }
+  } else if (ShouldGrow()) {
+    StartResize();
+  }
+}
+
+void TinyDBMImpl::StartResize() {
+  old_num_buckets_ = num_buckets_;
+  old_buckets_ = buckets_;
+  old_groups_ = groups_;
+  buckets_ = nullptr;
+  groups_ = nullptr;
+  num_buckets_ = old_num_buckets_ * 2;
+  if (table_type_ == TinyDBM::TABLE_SWISS) {
+    groups_ = static_cast<SwissGroup*>(xcalloc(num_buckets_, sizeof(*groups_)));
+  } else {
+    buckets_ = static_cast<char**>(xcalloc(num_buckets_, sizeof(*buckets_)));
+  }
+  migration_cursor_.store(0);
+  num_migrated_.store(0);
+  record_mutex_.Rehash(old_num_buckets_);
+}
+
+void TinyDBMImpl::FinishResize() {
+  if (old_num_buckets_ == 0) {
+    return;
+  }
+  for (int64_t old_bucket_index = migration_cursor_.load();
+       old_bucket_index < old_num_buckets_; old_bucket_index++) {
+    if (HasOldRecords(old_bucket_index)) {
+      MigrateBucket(old_bucket_index);
+    }
+  }
+  xfree(old_groups_);
+  old_groups_ = nullptr;
+  xfree(old_buckets_);
+  old_buckets_ = nullptr;
+  old_num_buckets_ = 0;
+  record_mutex_.Rehash(num_buckets_);
+}
+
+void TinyDBMImpl::ProcessImpl(std::string_view key, uint64_t hash,
+                              DBM::RecordProcessor* proc, bool writable) {
+  if (old_num_buckets_ > 0) {
+    const int64_t old_bucket_index = GetBucketIndex(hash, old_num_buckets_);
+    if (HasOldRecords(old_bucket_index)) {
+      if (!writable) {
+        if (table_type_ == TinyDBM::TABLE_SWISS) {
+          ProcessImplSwiss(key, old_groups_ + old_bucket_index, GetSwissTag(hash), proc, false);
+        } else {
+          ProcessImplChain(key, old_buckets_ + old_bucket_index, proc, false);
+        }
+        return;
+      }
+      MigrateBucket(old_bucket_index);
+    }
+  }
+  const int64_t bucket_index = GetBucketIndex(hash, num_buckets_);
+  if (table_type_ == TinyDBM::TABLE_SWISS) {
+    ProcessImplSwiss(key, groups_ + bucket_index, GetSwissTag(hash), proc, writable);
+  } else {
+    ProcessImplChain(key, buckets_ + bucket_index, proc, writable);
+  }
 }
 
-void TinyDBMImpl::ProcessImpl(
-    std::string_view key, int64_t bucket_index, DBM::RecordProcessor* proc, bool writable) {
+void TinyDBMImpl::ProcessImplChain(std::string_view key, char** bucket,
+                                   DBM::RecordProcessor* proc, bool writable) {
   TinyRecord rec;
-  char* top = buckets_[bucket_index];
+  char* top = *bucket;
   char* parent = nullptr;
   char* ptr = top;
   while (ptr != nullptr) {
@@ -510,9 +1269,9 @@ void TinyDBMImpl::ProcessImpl(
       std::string_view new_value = proc->ProcessFull(key, rec_value);
       if (new_value.data() != DBM::RecordProcessor::NOOP.data() && writable) {
         if (new_value.data() == DBM::RecordProcessor::REMOVE.data()) {
-          xfree(ptr);
+          FreeRecord(ptr, rec.GetSerializedSize());
           if (parent == nullptr) {
-            buckets_[bucket_index] = rec.child;
+            *bucket = rec.child;
           } else {
             std::memcpy(parent, &rec.child, sizeof(rec.child));
           }
@@ -520,10 +1279,10 @@ void TinyDBMImpl::ProcessImpl(
         } else {
           rec.value_ptr = new_value.data();
           rec.value_size = new_value.size();
-          char* new_ptr = rec.Reserialize(ptr, rec_value.size());
+          char* new_ptr = rec.Reserialize(ptr, rec_value.size(), &alloc_, snapshot_.Contains(ptr));
           if (new_ptr != ptr) {
             if (parent == nullptr) {
-              buckets_[bucket_index] = new_ptr;
+              *bucket = new_ptr;
             } else {
               std::memcpy(parent, &new_ptr, sizeof(new_ptr));
             }
@@ -543,26 +1302,41 @@ void TinyDBMImpl::ProcessImpl(
     rec.key_size = key.size();
     rec.value_ptr = new_value.data();
     rec.value_size = new_value.size();
-    buckets_[bucket_index] = rec.Serialize();
+    *bucket = rec.Serialize(&alloc_);
     num_records_.fetch_add(1);
   }
 }
 
-void TinyDBMImpl::AppendImpl(
-    std::string_view key, int64_t bucket_index, std::string_view value, std::string_view delim) {
+void TinyDBMImpl::AppendImpl(std::string_view key, uint64_t hash,
+                             std::string_view value, std::string_view delim) {
+  if (old_num_buckets_ > 0) {
+    const int64_t old_bucket_index = GetBucketIndex(hash, old_num_buckets_);
+    if (HasOldRecords(old_bucket_index)) {
+      MigrateBucket(old_bucket_index);
+    }
+  }
+  const int64_t bucket_index = GetBucketIndex(hash, num_buckets_);
+  if (table_type_ == TinyDBM::TABLE_SWISS) {
+    AppendImplSwiss(key, groups_ + bucket_index, GetSwissTag(hash), value, delim);
+  } else {
+    AppendImplChain(key, buckets_ + bucket_index, value, delim);
+  }
+}
+
+void TinyDBMImpl::AppendImplChain(std::string_view key, char** bucket,
+                                  std::string_view value, std::string_view delim) {
   TinyRecord rec;
-  char* top = buckets_[bucket_index];
+  char* top = *bucket;
   char* parent = nullptr;
   char* ptr = top;
   while (ptr != nullptr) {
     rec.Deserialize(ptr);
     const std::string_view rec_key(rec.key_ptr, rec.key_size);
-    const std::string_view rec_value(rec.value_ptr, rec.value_size);
     if (key == rec_key) {
-      char* new_ptr = rec.ReserializeAppend(ptr, value, delim);
+      char* new_ptr = rec.ReserializeAppend(ptr, value, delim, &alloc_, snapshot_.Contains(ptr));
       if (new_ptr != ptr) {
         if (parent == nullptr) {
-          buckets_[bucket_index] = new_ptr;
+          *bucket = new_ptr;
         } else {
           std::memcpy(parent, &new_ptr, sizeof(new_ptr));
         }
@@ -577,29 +1351,124 @@ void TinyDBMImpl::AppendImpl(
   rec.key_size = key.size();
   rec.value_ptr = value.data();
   rec.value_size = value.size();
-  buckets_[bucket_index] = rec.Serialize();
+  *bucket = rec.Serialize(&alloc_);
+  num_records_.fetch_add(1);
+}
+
+void TinyDBMImpl::ProcessImplSwiss(std::string_view key, SwissGroup* group, uint8_t tag,
+                                   DBM::RecordProcessor* proc, bool writable) {
+  SwissGroup* const head = group;
+  TinyRecord rec;
+  while (true) {
+    uint64_t mask = MatchSwissTags(group->tags, tag);
+    while (mask != 0) {
+      const int32_t slot = PopSwissLane(&mask);
+      char* ptr = group->records[slot];
+      rec.Deserialize(ptr);
+      const std::string_view rec_key(rec.key_ptr, rec.key_size);
+      if (key != rec_key) {
+        continue;
+      }
+      const std::string_view rec_value(rec.value_ptr, rec.value_size);
+      std::string_view new_value = proc->ProcessFull(key, rec_value);
+      if (new_value.data() != DBM::RecordProcessor::NOOP.data() && writable) {
+        if (new_value.data() == DBM::RecordProcessor::REMOVE.data()) {
+          FreeRecord(ptr, rec.GetSerializedSize());
+          group->tags[slot] = SWISS_TAG_EMPTY;
+          group->records[slot] = nullptr;
+          num_records_.fetch_sub(1);
+        } else {
+          rec.value_ptr = new_value.data();
+          rec.value_size = new_value.size();
+          group->records[slot] = rec.Reserialize(ptr, rec_value.size(), &alloc_, snapshot_.Contains(ptr));
+        }
+      }
+      return;
+    }
+    if (group->overflow == nullptr) {
+      break;
+    }
+    group = group->overflow;
+  }
+  const std::string_view new_value = proc->ProcessEmpty(key);
+  if (new_value.data() != DBM::RecordProcessor::NOOP.data() &&
+      new_value.data() != DBM::RecordProcessor::REMOVE.data() && writable) {
+    rec.child = nullptr;
+    rec.key_ptr = key.data();
+    rec.key_size = key.size();
+    rec.value_ptr = new_value.data();
+    rec.value_size = new_value.size();
+    InsertSwiss(head, tag, rec.Serialize(&alloc_));
+    num_records_.fetch_add(1);
+  }
+}
+
+void TinyDBMImpl::AppendImplSwiss(std::string_view key, SwissGroup* group, uint8_t tag,
+                                  std::string_view value, std::string_view delim) {
+  SwissGroup* const head = group;
+  TinyRecord rec;
+  while (group != nullptr) {
+    uint64_t mask = MatchSwissTags(group->tags, tag);
+    while (mask != 0) {
+      const int32_t slot = PopSwissLane(&mask);
+      char* ptr = group->records[slot];
+      rec.Deserialize(ptr);
+      const std::string_view rec_key(rec.key_ptr, rec.key_size);
+      if (key == rec_key) {
+        group->records[slot] = rec.ReserializeAppend(ptr, value, delim, &alloc_, snapshot_.Contains(ptr));
+        return;
+      }
+    }
+    group = group->overflow;
+  }
+  rec.child = nullptr;
+  rec.key_ptr = key.data();
+  rec.key_size = key.size();
+  rec.value_ptr = value.data();
+  rec.value_size = value.size();
+  InsertSwiss(head, tag, rec.Serialize(&alloc_));
   num_records_.fetch_add(1);
 }
 
+void TinyDBMImpl::InsertSwiss(SwissGroup* group, uint8_t tag, char* ptr) {
+  while (true) {
+    uint64_t mask = MatchSwissTags(group->tags, SWISS_TAG_EMPTY);
+    if (mask != 0) {
+      const int32_t slot = PopSwissLane(&mask);
+      group->tags[slot] = tag;
+      group->records[slot] = ptr;
+      return;
+    }
+    if (group->overflow == nullptr) {
+      group->overflow = static_cast<SwissGroup*>(xcalloc(1, sizeof(*group->overflow)));
+    }
+    group = group->overflow;
+  }
+}
+
 Status TinyDBMImpl::ReadNextBucketRecords(TinyDBMIteratorImpl* iter) {
+  const int64_t num_lock_buckets = GetNumLockBuckets();
   while (true) {
     int64_t bucket_index = iter->bucket_index_.load();
-    if (bucket_index < 0 || bucket_index >= num_buckets_)  {
+    const int64_t num_buckets = iter->num_buckets_.load();
+    if (bucket_index < 0 || bucket_index >= num_buckets ||
+        num_lock_buckets % num_buckets != 0) {
       break;
     }
     if (!iter->bucket_index_.compare_exchange_strong(bucket_index, bucket_index + 1)) {
       break;
     }
-    ScopedHashLock record_lock(record_mutex_, bucket_index, false);
-    if (record_lock.GetBucketIndex() < 0) {
-      break;
-    }
-    TinyRecord rec;
-    char* ptr = buckets_[bucket_index];
-    while (ptr != nullptr) {
-      rec.Deserialize(ptr);
-      iter->keys_.emplace_back(std::string(rec.key_ptr, rec.key_size));
-      ptr = rec.child;
+    for (int64_t lock_index = bucket_index; lock_index < num_lock_buckets;
+         lock_index += num_buckets) {
+      ScopedHashLock record_lock(record_mutex_, lock_index, false);
+      if (record_lock.GetBucketIndex() < 0) {
+        break;
+      }
+      IterateLockedBuckets(lock_index, [&](char* ptr) {
+          TinyRecord rec;
+          rec.Deserialize(ptr);
+          iter->keys_.emplace_back(std::string(rec.key_ptr, rec.key_size));
+        });
     }
     if (!iter->keys_.empty()) {
       return Status(Status::SUCCESS);
@@ -610,7 +1479,7 @@ Status TinyDBMImpl::ReadNextBucketRecords(TinyDBMIteratorImpl* iter) {
 }
 
 TinyDBMIteratorImpl::TinyDBMIteratorImpl(TinyDBMImpl* dbm)
-    : dbm_(dbm), bucket_index_(-1), keys_() {
+    : dbm_(dbm), bucket_index_(-1), num_buckets_(0), keys_() {
   std::lock_guard<std::shared_timed_mutex> lock(dbm_->mutex_);
   dbm_->iterators_.emplace_back(this);
 }
@@ -625,6 +1494,7 @@ TinyDBMIteratorImpl::~TinyDBMIteratorImpl() {
 Status TinyDBMIteratorImpl::First() {
   std::shared_lock<std::shared_timed_mutex> lock(dbm_->mutex_);
   bucket_index_.store(0);
+  num_buckets_.store(dbm_->GetNumLockBuckets());
   keys_.clear();
   return Status(Status::SUCCESS);
 }
@@ -633,10 +1503,8 @@ Status TinyDBMIteratorImpl::Jump(std::string_view key) {
   std::shared_lock<std::shared_timed_mutex> lock(dbm_->mutex_);
   bucket_index_.store(-1);
   keys_.clear();
-  {
-    ScopedHashLock record_lock(dbm_->record_mutex_, key, false);
-    bucket_index_.store(record_lock.GetBucketIndex());
-  }
+  num_buckets_.store(dbm_->GetNumLockBuckets());
+  bucket_index_.store(dbm_->GetLockIndex(HashRecordKey(key)));
   const Status status = dbm_->ReadNextBucketRecords(this);
   if (status != Status::SUCCESS) {
     return status;
@@ -684,9 +1552,9 @@ Status TinyDBMIteratorImpl::Process(DBM::RecordProcessor* proc, bool writable) {
     std::string_view value_;
   } proc_wrapper(proc);
   {
-    ScopedHashLock record_lock(dbm_->record_mutex_, first_key, writable);
-    const int64_t bucket_index = record_lock.GetBucketIndex();
-    dbm_->ProcessImpl(first_key, bucket_index, &proc_wrapper, writable);
+    const uint64_t hash = HashRecordKey(first_key);
+    ScopedHashLock record_lock(dbm_->record_mutex_, dbm_->GetLockIndex(hash), writable);
+    dbm_->ProcessImpl(first_key, hash, &proc_wrapper, writable);
   }
   const std::string_view value = proc_wrapper.Value();
   if (value.data() == nullptr) {
@@ -715,12 +1583,14 @@ Status TinyDBMIteratorImpl::ReadKeys() {
   return Status(Status::SUCCESS);
 }
 
-TinyDBM::TinyDBM(int64_t num_buckets) {
-  impl_ = new TinyDBMImpl(std::make_unique<MemoryMapParallelFile>(), num_buckets);
+TinyDBM::TinyDBM(int64_t num_buckets, TableType table_type, FileFormat file_format) {
+  impl_ = new TinyDBMImpl(std::make_unique<MemoryMapParallelFile>(), num_buckets, table_type,
+                          file_format);
 }
 
-TinyDBM::TinyDBM(std::unique_ptr<File> file, int64_t num_buckets) {
-  impl_ = new TinyDBMImpl(std::move(file), num_buckets);
+TinyDBM::TinyDBM(std::unique_ptr<File> file, int64_t num_buckets, TableType table_type,
+                 FileFormat file_format) {
+  impl_ = new TinyDBMImpl(std::move(file), num_buckets, table_type, file_format);
 }
 
 TinyDBM::~TinyDBM() {
@@ -802,6 +1672,52 @@ std::unique_ptr<DBM> TinyDBM::MakeDBM() const {
   return impl_->MakeDBM();
 }
 
+const char* TinyDBM::GetTableTypeName(TableType table_type) {
+  switch (table_type) {
+    case TABLE_CHAIN:
+      return "chain";
+    case TABLE_SWISS:
+      return "swiss";
+    default:
+      break;
+  }
+  return "default";
+}
+
+TinyDBM::TableType TinyDBM::ParseTableType(std::string_view name) {
+  const std::string lower_name = StrLowerCase(name);
+  if (lower_name == "chain") {
+    return TABLE_CHAIN;
+  }
+  if (lower_name == "swiss") {
+    return TABLE_SWISS;
+  }
+  return TABLE_DEFAULT;
+}
+
+const char* TinyDBM::GetFileFormatName(FileFormat file_format) {
+  switch (file_format) {
+    case FORMAT_FLAT:
+      return "flat";
+    case FORMAT_SNAPSHOT:
+      return "snapshot";
+    default:
+      break;
+  }
+  return "default";
+}
+
+TinyDBM::FileFormat TinyDBM::ParseFileFormat(std::string_view name) {
+  const std::string lower_name = StrLowerCase(name);
+  if (lower_name == "flat") {
+    return FORMAT_FLAT;
+  }
+  if (lower_name == "snapshot") {
+    return FORMAT_SNAPSHOT;
+  }
+  return FORMAT_DEFAULT;
+}
+
 TinyDBM::Iterator::Iterator(TinyDBMImpl* dbm_impl) {
   impl_ = new TinyDBMIteratorImpl(dbm_impl);
 }
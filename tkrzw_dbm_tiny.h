@@ -34,13 +34,39 @@ class TinyDBMIteratorImpl;
 /**
  * On-memory database manager implementation based on hash table.
  * @details All operations are thread-safe; Multiple threads can access the same database
- * concurrently.
+ * concurrently.  When the number of records exceeds the capacity of the hash table, the number
+ * of buckets is doubled incrementally.  Records are moved from the old buckets to the new ones
+ * a few buckets at a time by updating operations, so that no operation blocks for a long time.
  */
 class TinyDBM final : public DBM {
  public:
   /** The default value of the number of buckets. */
   static constexpr int64_t DEFAULT_NUM_BUCKETS = 1048583;
 
+  /**
+   * Enumeration for layouts of the hash table.
+   */
+  enum TableType : int32_t {
+    /** The default layout, which is the same as TABLE_CHAIN. */
+    TABLE_DEFAULT = 0,
+    /** To link records in each bucket by a pointer embedded in each record. */
+    TABLE_CHAIN = 1,
+    /** To put 16 one-byte hash tags and 16 record pointers in each bucket. */
+    TABLE_SWISS = 2,
+  };
+
+  /**
+   * Enumeration for formats of the database file.
+   */
+  enum FileFormat : int32_t {
+    /** To keep the format of the loaded file, or to use FORMAT_FLAT for a new file. */
+    FORMAT_DEFAULT = 0,
+    /** The flat record format, which is portable and read sequentially. */
+    FORMAT_FLAT = 1,
+    /** The memory image of the hash table, which is mapped on memory without parsing. */
+    FORMAT_SNAPSHOT = 2,
+  };
+
   /**
    * Iterator for each record.
    * @details When the database is updated, some iterators may or may not be invalided.
@@ -149,18 +175,27 @@ class TinyDBM final : public DBM {
 
   /**
    * Default constructor.
-   * @param num_buckets The number of buckets of the hash table.  -1 means that the default
-   * value 1048583 is set.
+   * @param num_buckets The initial number of buckets of the hash table.  -1 means that the
+   * default value 1048583 is set.  It grows automatically as records are added.
+   * @param table_type The layout of the hash table.
+   * @param file_format The format of the file to save records in.
+   * @details With TABLE_SWISS, the number of buckets is the number of record slots, which are
+   * grouped by 16.  Each lookup compares the 16 tags at once with SIMD instructions where
+   * available and dereferences only records whose tags match.
    */
-  explicit TinyDBM(int64_t num_buckets = -1);
+  explicit TinyDBM(int64_t num_buckets = -1, TableType table_type = TABLE_DEFAULT,
+                   FileFormat file_format = FORMAT_DEFAULT);
 
   /**
    * Constructor with a file object.
    * @param file The file object to handle the data.  The ownership is taken.
-   * @param num_buckets The number of buckets of the hash table.  -1 means that the default
-   * value 1048583 is set.
+   * @param num_buckets The initial number of buckets of the hash table.  -1 means that the
+   * default value 1048583 is set.  It grows automatically as records are added.
+   * @param table_type The layout of the hash table.
+   * @param file_format The format of the file to save records in.
    */
-  TinyDBM(std::unique_ptr<File> file, int64_t num_buckets = -1);
+  TinyDBM(std::unique_ptr<File> file, int64_t num_buckets = -1,
+          TableType table_type = TABLE_DEFAULT, FileFormat file_format = FORMAT_DEFAULT);
 
   /**
    * Destructor.
@@ -180,7 +215,10 @@ class TinyDBM final : public DBM {
    * @param options Bit-sum options for opening the file.
    * @return The result status.
    * @details As this database is an on-memory database, you can set records and retrieve them
-   * without opening a file.  If you open a file, records are loaded from the file.
+   * without opening a file.  If you open a file, records are loaded from the file.  A file of
+   * the flat format is parsed by one thread while records are inserted by multiple threads.  A
+   * file of the snapshot format is mapped privately on memory and records are used in place
+   * until they are modified.  The format is detected automatically.
    */
   Status Open(const std::string& path, bool writable,
               int32_t options = File::OPEN_DEFAULT) override;
@@ -188,7 +226,9 @@ class TinyDBM final : public DBM {
   /**
    * Closes the database file.
    * @return The result status.
-   * @details If a file is opened as writable, records are saved in the file.
+   * @details If a file is opened as writable, records are saved in the file.  If the file is
+   * of the snapshot format or a snapshot has been loaded, a new file is written under a
+   * temporary name and then renamed to the path, so that the loaded snapshot stays valid.
    */
   Status Close() override;
 
@@ -333,6 +373,34 @@ class TinyDBM final : public DBM {
    */
   std::unique_ptr<DBM> MakeDBM() const override;
 
+  /**
+   * Gets the name of a table type.
+   * @param table_type The table type.
+   * @return The name of the table type: "chain" or "swiss".
+   */
+  static const char* GetTableTypeName(TableType table_type);
+
+  /**
+   * Parses the name of a table type.
+   * @param name The name of the table type, which is case-insensitive.
+   * @return The table type, or TABLE_DEFAULT if the name is unknown.
+   */
+  static TableType ParseTableType(std::string_view name);
+
+  /**
+   * Gets the name of a file format.
+   * @param file_format The file format.
+   * @return The name of the file format: "flat" or "snapshot".
+   */
+  static const char* GetFileFormatName(FileFormat file_format);
+
+  /**
+   * Parses the name of a file format.
+   * @param name The name of the file format, which is case-insensitive.
+   * @return The file format, or FORMAT_DEFAULT if the name is unknown.
+   */
+  static FileFormat ParseFileFormat(std::string_view name);
+
  private:
   /** Pointer to the actual implementation. */
   class TinyDBMImpl* impl_;
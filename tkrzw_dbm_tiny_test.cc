@@ -92,4 +92,358 @@ TEST_F(TinyDBMTest, RecordMigration) {
   EXPECT_EQ(tkrzw::Status::SUCCESS, file.Close());
 }
 
+TEST_F(TinyDBMTest, SwissTable) {
+  const auto swiss = tkrzw::TinyDBM::TABLE_SWISS;
+  EXPECT_EQ(swiss, tkrzw::TinyDBM::ParseTableType(tkrzw::TinyDBM::GetTableTypeName(swiss)));
+  EXPECT_EQ(tkrzw::TinyDBM::TABLE_DEFAULT, tkrzw::TinyDBM::ParseTableType("foo"));
+  {
+    tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+    const std::string file_path = tmp_dir.MakeUniquePath();
+    tkrzw::TinyDBM dbm(1000, swiss);
+    FileTest(&dbm, file_path);
+  }
+  {
+    tkrzw::TinyDBM dbm(16, swiss);
+    BasicTest(&dbm);
+  }
+  {
+    tkrzw::TinyDBM dbm(1000, swiss);
+    SequenceTest(&dbm);
+  }
+  {
+    tkrzw::TinyDBM dbm(1000, swiss);
+    AppendTest(&dbm);
+  }
+  {
+    tkrzw::TinyDBM dbm(1000, swiss);
+    ProcessTest(&dbm);
+  }
+  {
+    tkrzw::TinyDBM dbm(10000, swiss);
+    RandomTestThread(&dbm);
+  }
+  {
+    tkrzw::TinyDBM dbm(2000, swiss);
+    RebuildRandomTest(&dbm);
+  }
+  tkrzw::TinyDBM dbm(16, swiss);
+  for (int32_t i = 0; i < 1000; i++) {
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(tkrzw::ToString(i), tkrzw::ToString(i * i)));
+  }
+  for (int32_t i = 0; i < 1000; i += 2) {
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Remove(tkrzw::ToString(i)));
+  }
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Rebuild());
+  bool tobe = true;
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.ShouldBeRebuilt(&tobe));
+  EXPECT_FALSE(tobe);
+  EXPECT_EQ(500, dbm.CountSimple());
+  for (int32_t i = 0; i < 1000; i++) {
+    const std::string expected = i % 2 == 0 ? "*" : tkrzw::ToString(i * i);
+    EXPECT_EQ(expected, dbm.GetSimple(tkrzw::ToString(i), "*"));
+  }
+  const auto meta = dbm.Inspect();
+  const std::map<std::string, std::string> meta_map(meta.begin(), meta.end());
+  EXPECT_EQ("swiss", tkrzw::SearchMap(meta_map, "table_type", ""));
+  EXPECT_EQ(0, tkrzw::StrToInt(tkrzw::SearchMap(meta_map, "num_buckets", "")) % 16);
+}
+
+TEST_F(TinyDBMTest, IncrementalResize) {
+  for (const auto table_type : {tkrzw::TinyDBM::TABLE_CHAIN, tkrzw::TinyDBM::TABLE_SWISS}) {
+    tkrzw::TinyDBM dbm(16, table_type);
+    std::map<std::string, std::string> expected;
+    for (int32_t i = 0; i < 100; i++) {
+      const std::string key = tkrzw::ToString(i);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(key, key));
+      expected.emplace(key, key);
+    }
+    auto iter = dbm.MakeIterator();
+    EXPECT_EQ(tkrzw::Status::SUCCESS, iter->First());
+    std::map<std::string, int32_t> visited;
+    for (int32_t i = 0; i < 50; i++) {
+      std::string key;
+      ASSERT_EQ(tkrzw::Status::SUCCESS, iter->Get(&key));
+      visited[key]++;
+      EXPECT_EQ(tkrzw::Status::SUCCESS, iter->Next());
+    }
+    for (int32_t i = 100; i < 10000; i++) {
+      const std::string key = tkrzw::ToString(i);
+      if (i % 3 == 0) {
+        EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Append(key, "x", ":"));
+        expected.emplace(key, "x");
+      } else {
+        EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(key, key));
+        expected.emplace(key, key);
+      }
+      if (i % 7 == 0) {
+        const std::string old_key = tkrzw::ToString(i / 7);
+        EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(old_key, key));
+        expected[old_key] = key;
+      }
+      if (i % 11 == 0) {
+        const std::string old_key = tkrzw::ToString(i / 11 + 100);
+        EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Remove(old_key));
+        expected.erase(old_key);
+      }
+    }
+    std::string key;
+    while (iter->Get(&key) == tkrzw::Status::SUCCESS) {
+      visited[key]++;
+      EXPECT_EQ(tkrzw::Status::SUCCESS, iter->Next());
+    }
+    for (int32_t i = 0; i < 100; i++) {
+      EXPECT_EQ(1, visited[tkrzw::ToString(i)]);
+    }
+    for (const auto& count : visited) {
+      EXPECT_EQ(1, count.second);
+    }
+    const auto meta = dbm.Inspect();
+    const std::map<std::string, std::string> meta_map(meta.begin(), meta.end());
+    EXPECT_GE(tkrzw::StrToInt(tkrzw::SearchMap(meta_map, "num_buckets", "")), 8192);
+    EXPECT_EQ(expected.size(), dbm.CountSimple());
+    for (const auto& record : expected) {
+      EXPECT_EQ(record.second, dbm.GetSimple(record.first));
+    }
+    int64_t count = 0;
+    iter->First();
+    while (iter->Get(&key) == tkrzw::Status::SUCCESS) {
+      EXPECT_EQ(expected[key], dbm.GetSimple(key));
+      count++;
+      iter->Next();
+    }
+    EXPECT_EQ(expected.size(), count);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Clear());
+    EXPECT_EQ(0, dbm.CountSimple());
+  }
+  for (const auto table_type : {tkrzw::TinyDBM::TABLE_CHAIN, tkrzw::TinyDBM::TABLE_SWISS}) {
+    tkrzw::TinyDBM dbm(16, table_type);
+    constexpr int32_t num_threads = 4;
+    constexpr int32_t num_iterations = 20000;
+    auto task = [&](int32_t id) {
+      for (int32_t i = 0; i < num_iterations; i++) {
+        const std::string key = tkrzw::ToString(i * num_threads + id);
+        EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(key, key));
+        const std::string old_key = tkrzw::ToString((i / 2) * num_threads + id);
+        EXPECT_EQ(old_key, dbm.GetSimple(old_key));
+      }
+    };
+    std::vector<std::thread> threads;
+    for (int32_t i = 0; i < num_threads; i++) {
+      threads.emplace_back(std::thread(task, i));
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    EXPECT_EQ(num_threads * num_iterations, dbm.CountSimple());
+    for (int32_t i = 0; i < num_threads * num_iterations; i++) {
+      const std::string key = tkrzw::ToString(i);
+      EXPECT_EQ(key, dbm.GetSimple(key));
+    }
+  }
+}
+
+TEST_F(TinyDBMTest, SnapshotFormat) {
+  const auto snapshot = tkrzw::TinyDBM::FORMAT_SNAPSHOT;
+  EXPECT_EQ(snapshot, tkrzw::TinyDBM::ParseFileFormat(
+      tkrzw::TinyDBM::GetFileFormatName(snapshot)));
+  EXPECT_EQ(tkrzw::TinyDBM::FORMAT_DEFAULT, tkrzw::TinyDBM::ParseFileFormat("foo"));
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string file_path = tmp_dir.MakeUniquePath();
+  for (const auto table_type : {tkrzw::TinyDBM::TABLE_CHAIN, tkrzw::TinyDBM::TABLE_SWISS}) {
+    std::map<std::string, std::string> expected;
+    {
+      tkrzw::TinyDBM dbm(64, table_type, snapshot);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Open(file_path, true, tkrzw::File::OPEN_TRUNCATE));
+      for (int32_t i = 0; i < 1000; i++) {
+        const std::string key = tkrzw::ToString(i * i);
+        const std::string value(i % 100, 'v');
+        EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(key, value));
+        expected.emplace(key, value);
+      }
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+    }
+    std::string content;
+    EXPECT_EQ(tkrzw::Status::SUCCESS, tkrzw::ReadFile(file_path, &content));
+    EXPECT_EQ("TkrzwTSN", content.substr(0, 8));
+    {
+      tkrzw::TinyDBM dbm(1, table_type);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Open(file_path, true));
+      auto meta = dbm.Inspect();
+      std::map<std::string, std::string> meta_map(meta.begin(), meta.end());
+      EXPECT_EQ("snapshot", tkrzw::SearchMap(meta_map, "file_format", ""));
+      EXPECT_GE(tkrzw::StrToInt(tkrzw::SearchMap(meta_map, "snapshot_size", "")), content.size());
+      EXPECT_EQ(expected.size(), dbm.CountSimple());
+      for (const auto& record : expected) {
+        EXPECT_EQ(record.second, dbm.GetSimple(record.first));
+      }
+      for (int32_t i = 0; i < 1000; i += 3) {
+        const std::string key = tkrzw::ToString(i * i);
+        EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Remove(key));
+        expected.erase(key);
+      }
+      for (int32_t i = 1; i < 1000; i += 3) {
+        const std::string key = tkrzw::ToString(i * i);
+        EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(key, "x"));
+        expected[key] = "x";
+      }
+      for (int32_t i = 2; i < 1000; i += 3) {
+        const std::string key = tkrzw::ToString(i * i);
+        EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Append(key, "y", ":"));
+        expected[key] = expected[key] + ":y";
+      }
+      for (int32_t i = 1000; i < 3000; i++) {
+        const std::string key = tkrzw::ToString(i * i);
+        EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(key, key));
+        expected.emplace(key, key);
+      }
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Synchronize(false));
+      EXPECT_EQ(expected.size(), dbm.CountSimple());
+      int64_t count = 0;
+      auto iter = dbm.MakeIterator();
+      iter->First();
+      std::string key, value;
+      while (iter->Get(&key, &value) == tkrzw::Status::SUCCESS) {
+        EXPECT_EQ(expected[key], value);
+        count++;
+        iter->Next();
+      }
+      EXPECT_EQ(expected.size(), count);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Rebuild());
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+      meta = dbm.Inspect();
+      meta_map = std::map<std::string, std::string>(meta.begin(), meta.end());
+      EXPECT_EQ("0", tkrzw::SearchMap(meta_map, "snapshot_size", ""));
+    }
+    {
+      tkrzw::TinyDBM dbm(100, table_type == tkrzw::TinyDBM::TABLE_CHAIN ?
+                         tkrzw::TinyDBM::TABLE_SWISS : tkrzw::TinyDBM::TABLE_CHAIN,
+                         tkrzw::TinyDBM::FORMAT_FLAT);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set("extra", "record"));
+      expected.emplace("extra", "record");
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Open(file_path, true));
+      const auto meta = dbm.Inspect();
+      const std::map<std::string, std::string> meta_map(meta.begin(), meta.end());
+      EXPECT_EQ("0", tkrzw::SearchMap(meta_map, "snapshot_size", ""));
+      EXPECT_EQ(expected.size(), dbm.CountSimple());
+      for (const auto& record : expected) {
+        EXPECT_EQ(record.second, dbm.GetSimple(record.first));
+      }
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+    }
+    EXPECT_EQ(tkrzw::Status::SUCCESS, tkrzw::ReadFile(file_path, &content));
+    EXPECT_NE("TkrzwTSN", content.substr(0, 8));
+    {
+      tkrzw::TinyDBM dbm(1, table_type, snapshot);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Open(file_path, true));
+      EXPECT_EQ(expected.size(), dbm.CountSimple());
+      for (const auto& record : expected) {
+        EXPECT_EQ(record.second, dbm.GetSimple(record.first));
+      }
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+    }
+    EXPECT_EQ(tkrzw::Status::SUCCESS, tkrzw::ReadFile(file_path, &content));
+    EXPECT_EQ("TkrzwTSN", content.substr(0, 8));
+    EXPECT_FALSE(tkrzw::PathIsFile(file_path + ".tmp"));
+    const auto CheckBroken = [&](int64_t offset, int64_t diff) {
+      std::string broken_content = content;
+      int64_t num = 0;
+      std::memcpy(&num, broken_content.data() + offset, sizeof(num));
+      num += diff;
+      std::memcpy(broken_content.data() + offset, &num, sizeof(num));
+      EXPECT_EQ(tkrzw::Status::SUCCESS, tkrzw::WriteFile(file_path, broken_content));
+      tkrzw::TinyDBM dbm(1, table_type);
+      EXPECT_EQ(tkrzw::Status::BROKEN_DATA_ERROR, dbm.Open(file_path, false));
+    };
+    CheckBroken(16, 1LL << 40);
+    CheckBroken(32, 1);
+    constexpr int64_t table_offset = 64;
+    int64_t rec_offset_pos = 0;
+    for (int64_t index = 0; rec_offset_pos == 0; index++) {
+      if (table_type == tkrzw::TinyDBM::TABLE_SWISS) {
+        const int64_t group_pos = table_offset + index * (16 + 8 + 16 * 8);
+        if (content[group_pos] != 0) {
+          rec_offset_pos = group_pos + 16 + 8;
+        }
+      } else {
+        const int64_t pos = table_offset + index * sizeof(int64_t);
+        int64_t num = 0;
+        std::memcpy(&num, content.data() + pos, sizeof(num));
+        if (num != 0) {
+          rec_offset_pos = pos;
+        }
+      }
+    }
+    CheckBroken(rec_offset_pos, 1);
+    CheckBroken(rec_offset_pos, -1);
+  }
+}
+
+TEST_F(TinyDBMTest, ParallelImport) {
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string file_path = tmp_dir.MakeUniquePath();
+  for (const auto table_type : {tkrzw::TinyDBM::TABLE_CHAIN, tkrzw::TinyDBM::TABLE_SWISS}) {
+    constexpr int32_t num_records = 100000;
+    {
+      tkrzw::TinyDBM dbm(100000, table_type);
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Open(file_path, true, tkrzw::File::OPEN_TRUNCATE));
+      for (int32_t i = 0; i < num_records; i++) {
+        EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(tkrzw::ToString(i), tkrzw::ToString(i * i)));
+      }
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+    }
+    tkrzw::TinyDBM dbm(16, table_type);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Open(file_path, false));
+    EXPECT_EQ(num_records, dbm.CountSimple());
+    for (int32_t i = 0; i < num_records; i++) {
+      EXPECT_EQ(tkrzw::ToString(i * i), dbm.GetSimple(tkrzw::ToString(i)));
+    }
+    const auto meta = dbm.Inspect();
+    const std::map<std::string, std::string> meta_map(meta.begin(), meta.end());
+    EXPECT_EQ("flat", tkrzw::SearchMap(meta_map, "file_format", ""));
+    EXPECT_GE(tkrzw::StrToInt(tkrzw::SearchMap(meta_map, "num_buckets", "")), num_records);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+  }
+}
+
+TEST_F(TinyDBMTest, SlabAllocation) {
+  tkrzw::TinyDBM dbm(1000);
+  for (int32_t i = 0; i < 1000; i++) {
+    const std::string key = tkrzw::ToString(i);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(key, key));
+    for (int32_t j = 0; j < i % 10; j++) {
+      EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Append(key, std::string(j * 100, 'x'), ","));
+    }
+  }
+  for (int32_t i = 0; i < 1000; i += 3) {
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Set(tkrzw::ToString(i), "short"));
+  }
+  for (int32_t i = 0; i < 1000; i += 5) {
+    EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Remove(tkrzw::ToString(i)));
+  }
+  auto meta = dbm.Inspect();
+  std::map<std::string, std::string> meta_map(meta.begin(), meta.end());
+  EXPECT_EQ(dbm.CountSimple(), tkrzw::StrToInt(tkrzw::SearchMap(meta_map, "slab_num_blocks", "")));
+  const int64_t used_size = tkrzw::StrToInt(tkrzw::SearchMap(meta_map, "slab_used_size", ""));
+  EXPECT_GT(used_size, 0);
+  EXPECT_GE(tkrzw::StrToInt(tkrzw::SearchMap(meta_map, "slab_reserved_size", "")), used_size);
+  for (int32_t i = 0; i < 1000; i++) {
+    const std::string key = tkrzw::ToString(i);
+    std::string value;
+    const tkrzw::Status status = dbm.Get(key, &value);
+    if (i % 5 == 0) {
+      EXPECT_EQ(tkrzw::Status::NOT_FOUND_ERROR, status);
+    } else if (i % 3 == 0) {
+      EXPECT_EQ("short", value);
+    } else {
+      EXPECT_EQ(tkrzw::Status::SUCCESS, status);
+      EXPECT_EQ(0, value.find(key));
+    }
+  }
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Clear());
+  meta = dbm.Inspect();
+  meta_map = std::map<std::string, std::string>(meta.begin(), meta.end());
+  EXPECT_EQ("0", tkrzw::SearchMap(meta_map, "slab_used_size", ""));
+  EXPECT_EQ("0", tkrzw::SearchMap(meta_map, "slab_reserved_size", ""));
+}
+
 // END OF FILE
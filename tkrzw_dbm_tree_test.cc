@@ -827,4 +827,13 @@ TEST_F(TreeDBMTest, Restore) {
   TreeDBMRestoreTest(&dbm);
 }
 
+TEST_F(TreeDBMTest, Async) {
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string file_path = tmp_dir.MakeUniquePath();
+  tkrzw::TreeDBM dbm(std::make_unique<tkrzw::MemoryMapParallelFile>());
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Open(file_path, true));
+  AsyncTest(&dbm);
+  EXPECT_EQ(tkrzw::Status::SUCCESS, dbm.Close());
+}
+
 // END OF FILE
@@ -47,10 +47,10 @@ static void PrintUsageAndDie() {
   P("\n");
   P("Common options:\n");
   P("  --dbm impl : The name of a DBM implementation:"
-    " auto, hash, tree, skip, tiny, baby, cache, stdhash, stdtree, poly, shard."
+    " auto, hash, tree, skip, tiny, baby, radix, cache, stdhash, stdtree, poly, shard."
     " (default: auto)\n");
   P("  --file impl : The name of a file implementation:"
-    " mmap-para, mmap-atom, pos-para, pos-atom. (default: mmap-para)\n");
+    " mmap-para, mmap-atom, pos-para, pos-atom, uring, direct. (default: mmap-para)\n");
   P("  --no_wait : Fails if the file is locked by another process.\n");
   P("  --no_lock : Omits file locking.\n");
   P("\n");
@@ -141,6 +141,8 @@ std::string GetDBMImplName(const std::string& dbm_impl, const std::string& file_
       return "tiny";
     } else if (ext == "tkmb") {
       return "baby";
+    } else if (ext == "tkmr") {
+      return "radix";
     } else if (ext == "tkmc") {
       return "cache";
     } else if (ext == "tksh") {
@@ -173,6 +175,8 @@ std::unique_ptr<DBM> MakeDBMOrDie(
     dbm = std::make_unique<TinyDBM>(MakeFileOrDie(file_impl, 0, 0));
   } else if (dbm_impl_mod == "baby") {
     dbm = std::make_unique<BabyDBM>(MakeFileOrDie(file_impl, 0, 0));
+  } else if (dbm_impl_mod == "radix") {
+    dbm = std::make_unique<RadixDBM>(MakeFileOrDie(file_impl, 0, 0));
   } else if (dbm_impl_mod == "cache") {
     dbm = std::make_unique<CacheDBM>(MakeFileOrDie(file_impl, 0, 0));
   } else if (dbm_impl_mod == "stdhash") {
@@ -314,7 +318,7 @@ bool OpenDBM(DBM* dbm, const std::string& path, bool writable, bool create, bool
     }
   }
   if (typeid(*dbm) == typeid(TinyDBM) || typeid(*dbm) == typeid(BabyDBM) ||
-      typeid(*dbm) == typeid(CacheDBM) ||
+      typeid(*dbm) == typeid(RadixDBM) || typeid(*dbm) == typeid(CacheDBM) ||
       typeid(*dbm) == typeid(StdHashDBM) || typeid(*dbm) == typeid(StdTreeDBM)) {
     const Status status = dbm->Open(path, writable, open_options);
     if (status != Status::SUCCESS) {
@@ -900,12 +904,9 @@ static int32_t ProcessMerge(int32_t argc, const char** args) {
   bool has_error = false;
   if (typeid(*dbm) == typeid(SkipDBM)) {
     SkipDBM* skip_dbm = dynamic_cast<SkipDBM*>(dbm.get());
-    Status status(Status::SUCCESS);
-    for (const auto& src_path : src_paths) {
-      status |= skip_dbm->MergeSkipDatabase(src_path);
-    }
+    Status status = skip_dbm->MergeSkipDatabases(src_paths);
     if (status != Status::SUCCESS) {
-      EPrintL("MergeSkipDatabase failed: ", status);
+      EPrintL("MergeSkipDatabases failed: ", status);
       has_error = true;
     }
     status = skip_dbm->SynchronizeAdvanced(
@@ -14,13 +14,17 @@
 #ifndef _TKRZW_FILE_H
 #define _TKRZW_FILE_H
 
+#include <future>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 #include <cinttypes>
 
 #include "tkrzw_lib_common.h"
+#include "tkrzw_thread_util.h"
 
 namespace tkrzw {
 
@@ -53,6 +57,52 @@ class File {
     OPEN_NO_WAIT = 1 << 2,
     /** To omit file locking. */
     OPEN_NO_LOCK = 1 << 3,
+    /** To allocate storage blocks when the file is extended. */
+    OPEN_PREALLOCATE = 1 << 4,
+  };
+
+  /**
+   * Enumeration of advice about access patterns.
+   */
+  enum AccessAdvice : int32_t {
+    /** No special treatment. */
+    ADVICE_NORMAL = 0,
+    /** Random access, for which read-ahead is useless. */
+    ADVICE_RANDOM = 1,
+    /** Sequential access, for which read-ahead is aggressive. */
+    ADVICE_SEQUENTIAL = 2,
+    /** The region will be accessed soon and should be read in advance. */
+    ADVICE_WILLNEED = 3,
+    /** The region will not be accessed soon and should be evicted from the cache. */
+    ADVICE_DONTNEED = 4,
+    /** The region is cold and should be reclaimed first on memory pressure. */
+    ADVICE_COLD = 5,
+    /** The region should be backed by huge pages. */
+    ADVICE_HUGEPAGE = 6,
+  };
+
+  /**
+   * Extent of a region to be read by vectored reading.
+   */
+  struct ReadExtent final {
+    /** The offset of a source region. */
+    int64_t off;
+    /** The pointer to the destination buffer. */
+    void* buf;
+    /** The size of the data to be read. */
+    size_t size;
+  };
+
+  /**
+   * Extent of a region to be written by vectored writing.
+   */
+  struct WriteExtent final {
+    /** The offset of the destination region. */
+    int64_t off;
+    /** The pointer to the source buffer. */
+    const void* buf;
+    /** The size of the data to be written. */
+    size_t size;
   };
 
   /**
@@ -95,6 +145,30 @@ class File {
     return data;
   }
 
+  /**
+   * Reads data asynchronously.
+   * @param off The offset of a source region.
+   * @param size The size of the data to be read.
+   * @return The future of a pair of the result status and the read data.  The data is empty on
+   * failure.
+   * @details The default implementation does Read in a worker thread of the shared I/O queue,
+   * which is given by TaskQueue::GetSharedIOQueue.  The file must not be closed until the
+   * future becomes ready.
+   */
+  virtual std::future<std::pair<Status, std::string>> ReadAsync(int64_t off, size_t size) {
+    auto promise = std::make_shared<std::promise<std::pair<Status, std::string>>>();
+    auto future = promise->get_future();
+    TaskQueue::GetSharedIOQueue()->Add([this, off, size, promise]() {
+      std::string data(size, 0);
+      const Status status = Read(off, const_cast<char*>(data.data()), size);
+      if (status != Status::SUCCESS) {
+        data.clear();
+      }
+      promise->set_value(std::make_pair(status, std::move(data)));
+    });
+    return future;
+  }
+
   /**
    * Writes data.
    * @param off The offset of the destination region.
@@ -134,6 +208,60 @@ class File {
     return Append(data.data(), data.size(), &off) == Status::SUCCESS ? off : -1;
   }
 
+  /**
+   * Reads data of multiple regions.
+   * @param extents The pointer to the array of the extents.
+   * @param num_extents The number of the extents.
+   * @return The result status.  If reading any of the extents fails, an error is returned.
+   * @details The default implementation calls Read for each extent.  Concrete classes combine
+   * the extents into fewer system calls or locking operations.
+   */
+  virtual Status ReadV(const ReadExtent* extents, size_t num_extents) {
+    for (size_t i = 0; i < num_extents; i++) {
+      const Status status = Read(extents[i].off, extents[i].buf, extents[i].size);
+      if (status != Status::SUCCESS) {
+        return status;
+      }
+    }
+    return Status(Status::SUCCESS);
+  }
+
+  /**
+   * Writes data of multiple regions.
+   * @param extents The pointer to the array of the extents.
+   * @param num_extents The number of the extents.
+   * @return The result status.  If writing any of the extents fails, an error is returned.
+   * @details The default implementation calls Write for each extent.  Concrete classes combine
+   * the extents into fewer system calls or locking operations.
+   */
+  virtual Status WriteV(const WriteExtent* extents, size_t num_extents) {
+    for (size_t i = 0; i < num_extents; i++) {
+      const Status status = Write(extents[i].off, extents[i].buf, extents[i].size);
+      if (status != Status::SUCCESS) {
+        return status;
+      }
+    }
+    return Status(Status::SUCCESS);
+  }
+
+  /**
+   * Appends data of multiple pieces at the end of the file.
+   * @param pieces The pointer to the array of the pieces, which are put contiguously.
+   * @param num_pieces The number of the pieces.
+   * @param off The pointer to an integer object to contain the offset at which the first piece
+   * has been put.  If it is nullptr, it is ignored.
+   * @return The result status.
+   * @details The default implementation concatenates the pieces and calls Append.
+   */
+  virtual Status AppendV(const std::string_view* pieces, size_t num_pieces,
+                         int64_t* off = nullptr) {
+    std::string data;
+    for (size_t i = 0; i < num_pieces; i++) {
+      data.append(pieces[i]);
+    }
+    return Append(data.data(), data.size(), off);
+  }
+
   /**
    * Expands the file size without writing data.
    * @param inc_size The size to increment the file size by.
@@ -171,6 +299,34 @@ class File {
    */
   virtual Status Synchronize(bool hard) = 0;
 
+  /**
+   * Synchronizes the content of a region of the file with the hardware.
+   * @param off The offset of the region.
+   * @param size The size of the region.  If it is negative, the region extends to the end of the
+   * file.
+   * @return The result status.
+   * @details Modified parts in the region are written back and the file size is not adjusted.
+   * Metadata is not synchronized unless it is necessary to read the data.  The default
+   * implementation calls Synchronize with hard synchronization, which also adjusts the file size.
+   * All concrete file classes of this library override it.
+   */
+  virtual Status SynchronizeRange(int64_t off, int64_t size) {
+    return Synchronize(true);
+  }
+
+  /**
+   * Releases storage blocks of a region of the file.
+   * @param off The offset of the region.
+   * @param size The size of the region.
+   * @return The result status.
+   * @details The file size is not changed and the region is read as zeros afterward.  Only
+   * blocks which are wholly inside the region are released and parts of the other blocks are
+   * zero-filled.  The default implementation returns NOT_IMPLEMENTED_ERROR.
+   */
+  virtual Status PunchHole(int64_t off, int64_t size) {
+    return Status(Status::NOT_IMPLEMENTED_ERROR);
+  }
+
   /**
    * Gets the size of the file.
    * @param size The pointer to an integer object to contain the result size.
@@ -197,6 +353,38 @@ class File {
    */
   virtual Status SetAllocationStrategy(int64_t init_size, double inc_factor) = 0;
 
+  /**
+   * Gives advice about the access pattern of a region.
+   * @param off The offset of the region.
+   * @param size The size of the region.  If it is negative, the region extends to the end of the
+   * file, including data to be added later.
+   * @param advice The advice about the access pattern.
+   * @return The result status.
+   * @details The advice is only a hint, which doesn't affect the content of the file.  The
+   * default implementation does nothing.  NORMAL, RANDOM, SEQUENTIAL, and HUGEPAGE describe
+   * the region persistently and the last one given for the region is effective.  WILLNEED,
+   * DONTNEED, and COLD are applied once to the current data.
+   */
+  virtual Status Advise(int64_t off, int64_t size, AccessAdvice advice) {
+    return Status(Status::SUCCESS);
+  }
+
+  /**
+   * Sets the buffer to coalesce appended data into large writes.
+   * @param size The capacity of the buffer.  If it is not positive, data are written directly.
+   * @param max_delay The maximum time in seconds for which data stay in the buffer.
+   * @return The result status.
+   * @details Data appended by Append and AppendV are kept in the buffer and written together
+   * when the buffer is full, when the file is synchronized, truncated, or closed, or when the
+   * file is accessed after the maximum delay.  Implementations may also flush expired data of
+   * an idle file in the background.
+   * Reading and writing a region in the buffer are done on the buffer.  This method must not be
+   * called concurrently with appending operations.  The default implementation does nothing.
+   */
+  virtual Status SetAppendBuffer(int64_t size, double max_delay) {
+    return Status(Status::SUCCESS);
+  }
+
   /**
    * Checks whether operations are done by memory mapping.
    * @return True if operations are done by memory mapping, or false if not.
@@ -0,0 +1,715 @@
+/*************************************************************************************************
+ * File implementation by direct I/O
+ *
+ * Copyright 2020 Google LLC
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+ * except in compliance with the License.  You may obtain a copy of the License at
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software distributed under the
+ * License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied.  See the License for the specific language governing permissions
+ * and limitations under the License.
+ *************************************************************************************************/
+
+#include "tkrzw_containers.h"
+#include "tkrzw_file.h"
+#include "tkrzw_file_direct.h"
+#include "tkrzw_file_util.h"
+#include "tkrzw_lib_common.h"
+#include "tkrzw_str_util.h"
+#include "tkrzw_sys_config.h"
+#include "tkrzw_thread_util.h"
+
+namespace tkrzw {
+
+constexpr int64_t DIRECT_BLOCK_SIZE = DirectIOFile::BLOCK_SIZE;
+constexpr int64_t DIRECT_BUFFER_SIZE = DIRECT_BLOCK_SIZE * 16;
+constexpr int32_t DIRECT_MAX_POOLED_BUFFERS = 16;
+constexpr int32_t DIRECT_NUM_LOCK_SLOTS = 256;
+
+// Rounds up a size to a multiple of the unit.
+static int64_t AlignSize(int64_t size, int64_t unit) {
+  const int64_t diff = size % unit;
+  return diff > 0 ? size + unit - diff : size;
+}
+
+// Reads aligned blocks until the end of the file.
+static int64_t ReadBlocks(int32_t fd, char* buf, int64_t size, int64_t off, int32_t* sys_err) {
+  int64_t done = 0;
+  while (done < size) {
+    const int64_t rsiz = pread(fd, buf + done, size - done, off + done);
+    if (rsiz < 0) {
+      *sys_err = errno;
+      return -1;
+    }
+    done += rsiz;
+    if (rsiz == 0 || rsiz % DIRECT_BLOCK_SIZE != 0) {
+      break;
+    }
+  }
+  return done;
+}
+
+// Writes aligned blocks.
+static Status WriteBlocks(int32_t fd, const char* buf, int64_t size, int64_t off) {
+  int64_t done = 0;
+  while (done < size) {
+    const int64_t rsiz = pwrite(fd, buf + done, size - done, off + done);
+    if (rsiz < 0) {
+      return GetErrnoStatus("pwrite", errno);
+    }
+    if (rsiz % DIRECT_BLOCK_SIZE != 0) {
+      return Status(Status::SYSTEM_ERROR, "unaligned partial write");
+    }
+    done += rsiz;
+  }
+  return Status(Status::SUCCESS);
+}
+
+class DirectIOFileImpl final {
+ public:
+  DirectIOFileImpl();
+  ~DirectIOFileImpl();
+  Status Open(const std::string& path, bool writable, int32_t options);
+  Status Close();
+  Status Read(int64_t off, void* buf, size_t size);
+  Status Write(int64_t off, const void* buf, size_t size);
+  Status Append(const void* buf, size_t size, int64_t* off);
+  Status Truncate(int64_t size);
+  Status Synchronize(bool hard);
+  Status SynchronizeRange(int64_t off, int64_t size);
+  Status GetSize(int64_t* size);
+  Status SetAllocationStrategy(int64_t init_size, double inc_factor);
+  Status SetCacheCapacity(int32_t num_blocks);
+  bool IsDirectIOEnabled() const;
+
+ private:
+  // Aligned buffer borrowed from the pool.
+  class PooledBuffer final {
+   public:
+    explicit PooledBuffer(DirectIOFileImpl* impl);
+    ~PooledBuffer();
+    char* Get() const;
+   private:
+    DirectIOFileImpl* impl_;
+    char* buf_;
+  };
+  // Locks of the slots of blocks in a region.
+  class BlockLocks final {
+   public:
+    BlockLocks(SlottedMutex& mutex, int64_t off, int64_t end, bool writable);
+    ~BlockLocks();
+   private:
+    SlottedMutex& mutex_;
+    int32_t indices_[DIRECT_BUFFER_SIZE / DIRECT_BLOCK_SIZE];
+    int32_t num_indices_;
+    bool writable_;
+  };
+  Status AdjustTruncSize(int64_t min_size);
+  int64_t AlignAllocSize(int64_t size) const;
+  Status WriteImpl(int64_t off, const char* buf, size_t size);
+  Status ReadEdgeBlock(int64_t off, char* buf);
+  bool GetCachedBlock(int64_t off, char* buf);
+  void SetCachedBlock(int64_t off, const char* buf, bool insert);
+  void ClearCache();
+  char* BorrowBuffer();
+  void ReturnBuffer(char* buf);
+
+  int32_t fd_;
+  std::atomic_int64_t file_size_;
+  std::atomic_int64_t trunc_size_;
+  bool writable_;
+  int32_t open_options_;
+  int64_t alloc_init_size_;
+  double alloc_inc_factor_;
+  int32_t cache_capacity_;
+  bool direct_;
+  std::mutex mutex_;
+  SlottedMutex block_mutex_;
+  LinkedHashMap<int64_t, std::string> cache_;
+  std::mutex cache_mutex_;
+  std::vector<char*> free_buffers_;
+  std::mutex pool_mutex_;
+};
+
+DirectIOFileImpl::PooledBuffer::PooledBuffer(DirectIOFileImpl* impl)
+    : impl_(impl), buf_(impl->BorrowBuffer()) {}
+
+DirectIOFileImpl::PooledBuffer::~PooledBuffer() {
+  impl_->ReturnBuffer(buf_);
+}
+
+char* DirectIOFileImpl::PooledBuffer::Get() const {
+  return buf_;
+}
+
+DirectIOFileImpl::BlockLocks::BlockLocks(
+    SlottedMutex& mutex, int64_t off, int64_t end, bool writable)
+    : mutex_(mutex), num_indices_(0), writable_(writable) {
+  for (int64_t block_off = off; block_off < end; block_off += DIRECT_BLOCK_SIZE) {
+    indices_[num_indices_++] = block_off / DIRECT_BLOCK_SIZE % DIRECT_NUM_LOCK_SLOTS;
+  }
+  std::sort(indices_, indices_ + num_indices_);
+  for (int32_t i = 0; i < num_indices_; i++) {
+    if (writable_) {
+      mutex_.LockOne(indices_[i]);
+    } else {
+      mutex_.LockOneShared(indices_[i]);
+    }
+  }
+}
+
+DirectIOFileImpl::BlockLocks::~BlockLocks() {
+  for (int32_t i = num_indices_ - 1; i >= 0; i--) {
+    if (writable_) {
+      mutex_.UnlockOne(indices_[i]);
+    } else {
+      mutex_.UnlockOneShared(indices_[i]);
+    }
+  }
+}
+
+DirectIOFileImpl::DirectIOFileImpl()
+    : fd_(-1), file_size_(0), trunc_size_(0), writable_(false), open_options_(0),
+      alloc_init_size_(File::DEFAULT_ALLOC_INIT_SIZE),
+      alloc_inc_factor_(File::DEFAULT_ALLOC_INC_FACTOR),
+      cache_capacity_(DirectIOFile::DEFAULT_CACHE_CAPACITY), direct_(false),
+      block_mutex_(DIRECT_NUM_LOCK_SLOTS) {}
+
+DirectIOFileImpl::~DirectIOFileImpl() {
+  if (fd_ >= 0) {
+    Close();
+  }
+  for (char* buf : free_buffers_) {
+    std::free(buf);
+  }
+}
+
+Status DirectIOFileImpl::Open(const std::string& path, bool writable, int32_t options) {
+  if (fd_ >= 0) {
+    return Status(Status::PRECONDITION_ERROR, "opened file");
+  }
+
+  // Opens the file.
+  int32_t oflags = O_RDONLY;
+  if (writable) {
+    oflags = O_RDWR;
+    if (!(options & File::OPEN_NO_CREATE)) {
+      oflags |= O_CREAT;
+    }
+    if (options & File::OPEN_TRUNCATE) {
+      oflags |= O_TRUNC;
+    }
+  }
+  bool direct = false;
+  int32_t fd = -1;
+#if defined(O_DIRECT)
+  fd = open(path.c_str(), oflags | O_DIRECT, FILEPERM);
+  if (fd >= 0) {
+    direct = true;
+  } else if (errno != EINVAL) {
+    return GetErrnoStatus("open", errno);
+  }
+#endif
+  if (fd < 0) {
+    fd = open(path.c_str(), oflags, FILEPERM);
+    if (fd < 0) {
+      return GetErrnoStatus("open", errno);
+    }
+#if defined(F_NOCACHE)
+    direct = fcntl(fd, F_NOCACHE, 1) == 0;
+#endif
+  }
+
+  // Locks the file.
+  if (!(options & File::OPEN_NO_LOCK)) {
+    struct flock flbuf;
+    std::memset(&flbuf, 0, sizeof(flbuf));
+    flbuf.l_type = writable ? F_WRLCK : F_RDLCK;
+    flbuf.l_whence = SEEK_SET;
+    flbuf.l_start = 0;
+    flbuf.l_len = 0;
+    flbuf.l_pid = 0;
+    const int32_t flcmd = options & File::OPEN_NO_WAIT ? F_SETLK : F_SETLKW;
+    if (fcntl(fd, flcmd, &flbuf) != 0) {
+      const Status status = GetErrnoStatus("fcntl-lock", errno);
+      close(fd);
+      return status;
+    }
+  }
+
+  // Checks the file size and type.
+  struct stat sbuf;
+  if (fstat(fd, &sbuf) != 0) {
+    const Status status = GetErrnoStatus("fstat", errno);
+    close(fd);
+    return status;
+  }
+  if (!S_ISREG(sbuf.st_mode)) {
+    close(fd);
+    return Status(Status::INFEASIBLE_ERROR, "not a regular file");
+  }
+  const int64_t file_size = sbuf.st_size;
+  if (file_size > MAX_MEMORY_SIZE) {
+    close(fd);
+    return Status(Status::INFEASIBLE_ERROR, "too large file");
+  }
+
+  // Truncates the file.
+  int64_t trunc_size = file_size;
+  if (writable) {
+    trunc_size = AlignAllocSize(std::max(trunc_size, alloc_init_size_));
+    if (ftruncate(fd, trunc_size) != 0) {
+      const Status status = GetErrnoStatus("ftruncate", errno);
+      close(fd);
+      return status;
+    }
+    if (options & File::OPEN_PREALLOCATE) {
+      const Status status = AllocateFileSpace(fd, file_size, trunc_size - file_size, false);
+      if (status != Status::SUCCESS) {
+        close(fd);
+        return status;
+      }
+    }
+  }
+
+  // Updates the internal data.
+  fd_ = fd;
+  file_size_.store(file_size);
+  trunc_size_.store(trunc_size);
+  writable_ = writable;
+  open_options_ = options;
+  direct_ = direct;
+
+  return Status(Status::SUCCESS);
+}
+
+Status DirectIOFileImpl::Close() {
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  Status status(Status::SUCCESS);
+
+  // Truncates the file.
+  if (writable_ && ftruncate(fd_, file_size_.load()) != 0) {
+    status |= GetErrnoStatus("ftruncate", errno);
+  }
+
+  // Unlocks the file.
+  if (!(open_options_ & File::OPEN_NO_LOCK)) {
+    struct flock flbuf;
+    std::memset(&flbuf, 0, sizeof(flbuf));
+    flbuf.l_type = F_UNLCK;
+    flbuf.l_whence = SEEK_SET;
+    flbuf.l_start = 0;
+    flbuf.l_len = 0;
+    flbuf.l_pid = 0;
+    if (fcntl(fd_, F_SETLKW, &flbuf) != 0) {
+      status |= GetErrnoStatus("fcntl-unlock", errno);
+    }
+  }
+
+  // Close the file.
+  if (close(fd_) != 0) {
+    status |= GetErrnoStatus("close", errno);
+  }
+
+  // Updates the internal data.
+  fd_ = -1;
+  file_size_.store(0);
+  trunc_size_.store(0);
+  writable_ = false;
+  open_options_ = 0;
+  direct_ = false;
+  ClearCache();
+
+  return status;
+}
+
+Status DirectIOFileImpl::Read(int64_t off, void* buf, size_t size) {
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  char* wp = static_cast<char*>(buf);
+  PooledBuffer block_buf(this);
+  while (size > 0) {
+    const int64_t block_off = off - off % DIRECT_BLOCK_SIZE;
+    const int64_t end = std::min<int64_t>(off + size, block_off + DIRECT_BUFFER_SIZE);
+    const int64_t block_end = AlignSize(end, DIRECT_BLOCK_SIZE);
+    const int64_t chunk_size = end - off;
+    BlockLocks locks(block_mutex_, block_off, block_end, false);
+    const bool single = block_end - block_off == DIRECT_BLOCK_SIZE;
+    if (!single || !GetCachedBlock(block_off, block_buf.Get())) {
+      int32_t sys_err = 0;
+      const int64_t rsiz = ReadBlocks(
+          fd_, block_buf.Get(), block_end - block_off, block_off, &sys_err);
+      if (rsiz < 0) {
+        return GetErrnoStatus("pread", sys_err);
+      }
+      if (rsiz < end - block_off) {
+        return Status(Status::INFEASIBLE_ERROR, "excessive region");
+      }
+      if (single && rsiz == DIRECT_BLOCK_SIZE) {
+        SetCachedBlock(block_off, block_buf.Get(), true);
+      }
+    }
+    std::memcpy(wp, block_buf.Get() + off - block_off, chunk_size);
+    wp += chunk_size;
+    off += chunk_size;
+    size -= chunk_size;
+  }
+  return Status(Status::SUCCESS);
+}
+
+Status DirectIOFileImpl::Write(int64_t off, const void* buf, size_t size) {
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  if (!writable_) {
+    return Status(Status::PRECONDITION_ERROR, "not writable file");
+  }
+  const int64_t end_position = off + size;
+  const Status status = AdjustTruncSize(end_position);
+  if (status != Status::SUCCESS) {
+    return status;
+  }
+  while (true) {
+    int64_t old_file_size = file_size_.load();
+    if (end_position <= old_file_size ||
+        file_size_.compare_exchange_weak(old_file_size, end_position)) {
+      break;
+    }
+  }
+  return WriteImpl(off, static_cast<const char*>(buf), size);
+}
+
+Status DirectIOFileImpl::Append(const void* buf, size_t size, int64_t* off) {
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  if (!writable_) {
+    return Status(Status::PRECONDITION_ERROR, "not writable file");
+  }
+  int64_t position = 0;
+  while (true) {
+    position = file_size_.load();
+    const int64_t end_position = position + size;
+    const Status status = AdjustTruncSize(end_position);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+    if (file_size_.compare_exchange_weak(position, end_position)) {
+      break;
+    }
+  }
+  if (off != nullptr) {
+    *off = position;
+  }
+  if (buf != nullptr) {
+    return WriteImpl(position, static_cast<const char*>(buf), size);
+  }
+  return Status(Status::SUCCESS);
+}
+
+Status DirectIOFileImpl::Truncate(int64_t size) {
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  if (!writable_) {
+    return Status(Status::PRECONDITION_ERROR, "not writable file");
+  }
+  const int64_t new_trunc_size =
+      AlignAllocSize(std::max(std::max(size, static_cast<int64_t>(PAGE_SIZE)), alloc_init_size_));
+  if (ftruncate(fd_, new_trunc_size) != 0) {
+    return GetErrnoStatus("ftruncate", errno);
+  }
+  file_size_.store(size);
+  trunc_size_.store(new_trunc_size);
+  ClearCache();
+  return Status(Status::SUCCESS);
+}
+
+Status DirectIOFileImpl::Synchronize(bool hard) {
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  if (!writable_) {
+    return Status(Status::PRECONDITION_ERROR, "not writable file");
+  }
+  Status status(Status::SUCCESS);
+  const int64_t old_trunc_size = trunc_size_.exchange(file_size_.load());
+  if (ftruncate(fd_, trunc_size_.load()) != 0) {
+    status |= GetErrnoStatus("ftruncate", errno);
+  }
+  if (open_options_ & File::OPEN_PREALLOCATE) {
+    // The blocks beyond the end are kept reserved for the data to be added later.
+    const int64_t trunc_size = trunc_size_.load();
+    status |= AllocateFileSpace(fd_, trunc_size, old_trunc_size - trunc_size, true);
+  }
+  if (hard && fsync(fd_) != 0) {
+    status |= GetErrnoStatus("fsync", errno);
+  }
+  return status;
+}
+
+Status DirectIOFileImpl::SynchronizeRange(int64_t off, int64_t size) {
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  if (!writable_) {
+    return Status(Status::PRECONDITION_ERROR, "not writable file");
+  }
+#if defined(_SYS_LINUX_)
+  if (fdatasync(fd_) != 0) {
+    return GetErrnoStatus("fdatasync", errno);
+  }
+#else
+  if (fsync(fd_) != 0) {
+    return GetErrnoStatus("fsync", errno);
+  }
+#endif
+  return Status(Status::SUCCESS);
+}
+
+Status DirectIOFileImpl::GetSize(int64_t* size) {
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  *size = file_size_.load();
+  return Status(Status::SUCCESS);
+}
+
+Status DirectIOFileImpl::SetAllocationStrategy(int64_t init_size, double inc_factor) {
+  if (fd_ >= 0) {
+    return Status(Status::PRECONDITION_ERROR, "alread opened file");
+  }
+  alloc_init_size_ = init_size;
+  alloc_inc_factor_ = inc_factor;
+  return Status(Status::SUCCESS);
+}
+
+Status DirectIOFileImpl::SetCacheCapacity(int32_t num_blocks) {
+  if (fd_ >= 0) {
+    return Status(Status::PRECONDITION_ERROR, "alread opened file");
+  }
+  cache_capacity_ = num_blocks;
+  return Status(Status::SUCCESS);
+}
+
+bool DirectIOFileImpl::IsDirectIOEnabled() const {
+  return direct_;
+}
+
+Status DirectIOFileImpl::AdjustTruncSize(int64_t min_size) {
+  if (min_size <= trunc_size_.load()) {
+    return Status(Status::SUCCESS);
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (min_size <= trunc_size_.load()) {
+    return Status(Status::SUCCESS);
+  }
+  const int64_t new_trunc_size = AlignAllocSize(
+      std::max(min_size, static_cast<int64_t>(trunc_size_.load() * alloc_inc_factor_)));
+  if (ftruncate(fd_, new_trunc_size) != 0) {
+    return GetErrnoStatus("ftruncate", errno);
+  }
+  if (open_options_ & File::OPEN_PREALLOCATE) {
+    const int64_t old_trunc_size = trunc_size_.load();
+    const Status status =
+        AllocateFileSpace(fd_, old_trunc_size, new_trunc_size - old_trunc_size, false);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+  }
+  trunc_size_.store(new_trunc_size);
+  return Status(Status::SUCCESS);
+}
+
+int64_t DirectIOFileImpl::AlignAllocSize(int64_t size) const {
+  return AlignSize(size, std::max<int64_t>(PAGE_SIZE, DIRECT_BLOCK_SIZE));
+}
+
+Status DirectIOFileImpl::WriteImpl(int64_t off, const char* buf, size_t size) {
+  PooledBuffer block_buf(this);
+  while (size > 0) {
+    const int64_t block_off = off - off % DIRECT_BLOCK_SIZE;
+    const int64_t end = std::min<int64_t>(off + size, block_off + DIRECT_BUFFER_SIZE);
+    const int64_t block_end = AlignSize(end, DIRECT_BLOCK_SIZE);
+    const int64_t chunk_size = end - off;
+    BlockLocks locks(block_mutex_, block_off, block_end, true);
+    if (off > block_off) {
+      const Status status = ReadEdgeBlock(block_off, block_buf.Get());
+      if (status != Status::SUCCESS) {
+        return status;
+      }
+    }
+    const int64_t last_block_off = block_end - DIRECT_BLOCK_SIZE;
+    if (end < block_end && (last_block_off > block_off || off == block_off)) {
+      const Status status =
+          ReadEdgeBlock(last_block_off, block_buf.Get() + last_block_off - block_off);
+      if (status != Status::SUCCESS) {
+        return status;
+      }
+    }
+    std::memcpy(block_buf.Get() + off - block_off, buf, chunk_size);
+    const Status status = WriteBlocks(fd_, block_buf.Get(), block_end - block_off, block_off);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+    const bool single = block_end - block_off == DIRECT_BLOCK_SIZE;
+    for (int64_t cur_off = block_off; cur_off < block_end; cur_off += DIRECT_BLOCK_SIZE) {
+      SetCachedBlock(cur_off, block_buf.Get() + cur_off - block_off, single);
+    }
+    buf += chunk_size;
+    off += chunk_size;
+    size -= chunk_size;
+  }
+  return Status(Status::SUCCESS);
+}
+
+Status DirectIOFileImpl::ReadEdgeBlock(int64_t off, char* buf) {
+  if (GetCachedBlock(off, buf)) {
+    return Status(Status::SUCCESS);
+  }
+  int32_t sys_err = 0;
+  const int64_t rsiz = ReadBlocks(fd_, buf, DIRECT_BLOCK_SIZE, off, &sys_err);
+  if (rsiz < 0) {
+    return GetErrnoStatus("pread", sys_err);
+  }
+  std::memset(buf + rsiz, 0, DIRECT_BLOCK_SIZE - rsiz);
+  return Status(Status::SUCCESS);
+}
+
+bool DirectIOFileImpl::GetCachedBlock(int64_t off, char* buf) {
+  if (cache_capacity_ < 1) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  const auto* rec = cache_.Get(off, LinkedHashMap<int64_t, std::string>::MOVE_LAST);
+  if (rec == nullptr) {
+    return false;
+  }
+  std::memcpy(buf, rec->value.data(), DIRECT_BLOCK_SIZE);
+  return true;
+}
+
+void DirectIOFileImpl::SetCachedBlock(int64_t off, const char* buf, bool insert) {
+  if (cache_capacity_ < 1) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  auto* rec = cache_.Get(off, LinkedHashMap<int64_t, std::string>::MOVE_LAST);
+  if (rec != nullptr) {
+    rec->value.assign(buf, DIRECT_BLOCK_SIZE);
+  } else if (insert) {
+    cache_.Set(off, std::string(buf, DIRECT_BLOCK_SIZE), true,
+               LinkedHashMap<int64_t, std::string>::MOVE_LAST);
+    while (static_cast<int64_t>(cache_.size()) > cache_capacity_) {
+      cache_.Remove(cache_.front().key);
+    }
+  }
+}
+
+void DirectIOFileImpl::ClearCache() {
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  cache_.clear();
+}
+
+char* DirectIOFileImpl::BorrowBuffer() {
+  {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    if (!free_buffers_.empty()) {
+      char* buf = free_buffers_.back();
+      free_buffers_.pop_back();
+      return buf;
+    }
+  }
+  void* buf = nullptr;
+  if (posix_memalign(&buf, DIRECT_BLOCK_SIZE, DIRECT_BUFFER_SIZE) != 0) {
+    throw std::bad_alloc();
+  }
+  return static_cast<char*>(buf);
+}
+
+void DirectIOFileImpl::ReturnBuffer(char* buf) {
+  {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    if (static_cast<int32_t>(free_buffers_.size()) < DIRECT_MAX_POOLED_BUFFERS) {
+      free_buffers_.emplace_back(buf);
+      return;
+    }
+  }
+  std::free(buf);
+}
+
+DirectIOFile::DirectIOFile() {
+  impl_ = new DirectIOFileImpl();
+}
+
+DirectIOFile::~DirectIOFile() {
+  delete impl_;
+}
+
+Status DirectIOFile::Open(const std::string& path, bool writable, int32_t options) {
+  return impl_->Open(path, writable, options);
+}
+
+Status DirectIOFile::Close() {
+  return impl_->Close();
+}
+
+Status DirectIOFile::Read(int64_t off, void* buf, size_t size) {
+  assert(off >= 0 && buf != nullptr);
+  return impl_->Read(off, buf, size);
+}
+
+Status DirectIOFile::Write(int64_t off, const void* buf, size_t size) {
+  assert(off >= 0 && buf != nullptr && size <= MAX_MEMORY_SIZE);
+  return impl_->Write(off, buf, size);
+}
+
+Status DirectIOFile::Append(const void* buf, size_t size, int64_t* off) {
+  assert(buf != nullptr && size <= MAX_MEMORY_SIZE);
+  return impl_->Append(buf, size, off);
+}
+
+Status DirectIOFile::Expand(size_t inc_size, int64_t* old_size) {
+  assert(inc_size <= MAX_MEMORY_SIZE);
+  return impl_->Append(nullptr, inc_size, old_size);
+}
+
+Status DirectIOFile::Truncate(int64_t size) {
+  assert(size >= 0 && size <= MAX_MEMORY_SIZE);
+  return impl_->Truncate(size);
+}
+
+Status DirectIOFile::Synchronize(bool hard) {
+  return impl_->Synchronize(hard);
+}
+
+Status DirectIOFile::SynchronizeRange(int64_t off, int64_t size) {
+  return impl_->SynchronizeRange(off, size);
+}
+
+Status DirectIOFile::GetSize(int64_t* size) {
+  assert(size != nullptr);
+  return impl_->GetSize(size);
+}
+
+Status DirectIOFile::SetAllocationStrategy(int64_t init_size, double inc_factor) {
+  assert(init_size > 0 && inc_factor > 0);
+  return impl_->SetAllocationStrategy(init_size, inc_factor);
+}
+
+Status DirectIOFile::SetCacheCapacity(int32_t num_blocks) {
+  assert(num_blocks >= 0);
+  return impl_->SetCacheCapacity(num_blocks);
+}
+
+bool DirectIOFile::IsDirectIOEnabled() const {
+  return impl_->IsDirectIOEnabled();
+}
+
+}  // namespace tkrzw
+
+// END OF FILE
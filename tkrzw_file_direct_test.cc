@@ -0,0 +1,135 @@
+/*************************************************************************************************
+ * Tests for tkrzw_file_direct.h
+ *
+ * Copyright 2020 Google LLC
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+ * except in compliance with the License.  You may obtain a copy of the License at
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software distributed under the
+ * License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied.  See the License for the specific language governing permissions
+ * and limitations under the License.
+ *************************************************************************************************/
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include "tkrzw_file.h"
+#include "tkrzw_file_test_common.h"
+#include "tkrzw_file_direct.h"
+#include "tkrzw_file_util.h"
+#include "tkrzw_lib_common.h"
+#include "tkrzw_sys_config.h"
+
+using namespace testing;
+
+// Main routine
+int main(int argc, char** argv) {
+  InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+class DirectIOFileTest : public CommonFileTest<tkrzw::DirectIOFile> {};
+
+TEST_F(DirectIOFileTest, Attributes) {
+  tkrzw::DirectIOFile file;
+  EXPECT_FALSE(file.IsMemoryMapping());
+  EXPECT_FALSE(file.IsAtomic());
+}
+
+TEST_F(DirectIOFileTest, EmptyFile) {
+  EmptyFileTest();
+}
+
+TEST_F(DirectIOFileTest, SimpleRead) {
+  SimpleReadTest();
+}
+
+TEST_F(DirectIOFileTest, SimpleWrite) {
+  SimpleWriteTest();
+}
+
+TEST_F(DirectIOFileTest, ReallocWrite) {
+  ReallocWriteTest();
+}
+
+TEST_F(DirectIOFileTest, ImplicitClose) {
+  ImplicitCloseTest();
+}
+
+TEST_F(DirectIOFileTest, OpenOptions) {
+  OpenOptionsTest();
+}
+
+TEST_F(DirectIOFileTest, OrderedThread) {
+  OrderedThreadTest();
+}
+
+TEST_F(DirectIOFileTest, RandomThread) {
+  RandomThreadTest();
+}
+
+TEST_F(DirectIOFileTest, FileReader) {
+  FileReaderTest();
+}
+
+TEST_F(DirectIOFileTest, FlatRecord) {
+  FlatRecordTest();
+}
+
+TEST_F(DirectIOFileTest, VectorIO) {
+  VectorIOTest();
+}
+
+TEST_F(DirectIOFileTest, AsyncRead) {
+  AsyncReadTest();
+}
+
+TEST_F(DirectIOFileTest, SynchronizeRange) {
+  SynchronizeRangeTest();
+}
+
+TEST_F(DirectIOFileTest, UnalignedAccess) {
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string file_path = tmp_dir.MakeUniquePath();
+  for (const int32_t cache_capacity : {0, 2, 256}) {
+    tkrzw::DirectIOFile file;
+    EXPECT_EQ(tkrzw::Status::SUCCESS, file.SetCacheCapacity(cache_capacity));
+    EXPECT_EQ(tkrzw::Status::SUCCESS, file.SetAllocationStrategy(1, 1.5));
+    EXPECT_EQ(tkrzw::Status::SUCCESS, file.Open(file_path, true, tkrzw::File::OPEN_TRUNCATE));
+    std::string expected;
+    std::mt19937 mt(cache_capacity);
+    std::uniform_int_distribution<int32_t> size_dist(1, tkrzw::DirectIOFile::BLOCK_SIZE * 3);
+    for (int32_t i = 0; i < 300; i++) {
+      const std::string data(size_dist(mt), 'a' + i % 26);
+      if (i % 3 == 0 || expected.empty()) {
+        int64_t off = 0;
+        EXPECT_EQ(tkrzw::Status::SUCCESS, file.Append(data.data(), data.size(), &off));
+        EXPECT_EQ(static_cast<int64_t>(expected.size()), off);
+        expected.append(data);
+      } else {
+        std::uniform_int_distribution<int64_t> off_dist(0, expected.size());
+        const int64_t off = off_dist(mt);
+        EXPECT_EQ(tkrzw::Status::SUCCESS, file.Write(off, data.data(), data.size()));
+        expected.resize(std::max(expected.size(), off + data.size()));
+        expected.replace(off, data.size(), data);
+      }
+      std::uniform_int_distribution<int64_t> off_dist(0, expected.size() - 1);
+      const int64_t off = off_dist(mt);
+      const int64_t size = std::min<int64_t>(size_dist(mt), expected.size() - off);
+      EXPECT_EQ(expected.substr(off, size), file.ReadSimple(off, size));
+    }
+    EXPECT_EQ(static_cast<int64_t>(expected.size()), file.GetSizeSimple());
+    EXPECT_EQ(expected, file.ReadSimple(0, expected.size()));
+    EXPECT_EQ(tkrzw::Status::SUCCESS, file.Truncate(1000));
+    EXPECT_EQ(expected.substr(0, 1000), file.ReadSimple(0, 1000));
+    EXPECT_EQ(tkrzw::Status::SUCCESS, file.Append("xyz", 3));
+    EXPECT_EQ(tkrzw::Status::PRECONDITION_ERROR, file.SetCacheCapacity(1));
+    EXPECT_EQ(tkrzw::Status::SUCCESS, file.Close());
+    std::string content;
+    EXPECT_EQ(tkrzw::Status::SUCCESS, tkrzw::ReadFile(file_path, &content));
+    EXPECT_EQ(expected.substr(0, 1000) + "xyz", content);
+  }
+}
+
+// END OF FILE
@@ -21,8 +21,168 @@
 
 namespace tkrzw {
 
+struct MapAdvice final {
+  int64_t off;
+  int64_t size;
+  File::AccessAdvice advice;
+};
+
+static Status ApplyMapAdvice(
+    char* map, int64_t map_size, int64_t off, int64_t size, File::AccessAdvice advice) {
+  int32_t madv = -1;
+  switch (advice) {
+    case File::ADVICE_NORMAL:
+      madv = MADV_NORMAL;
+      break;
+    case File::ADVICE_RANDOM:
+      madv = MADV_RANDOM;
+      break;
+    case File::ADVICE_SEQUENTIAL:
+      madv = MADV_SEQUENTIAL;
+      break;
+    case File::ADVICE_WILLNEED:
+      madv = MADV_WILLNEED;
+      break;
+    case File::ADVICE_DONTNEED:
+      madv = MADV_DONTNEED;
+      break;
+#if defined(MADV_COLD)
+    case File::ADVICE_COLD:
+      madv = MADV_COLD;
+      break;
+#endif
+#if defined(MADV_HUGEPAGE)
+    case File::ADVICE_HUGEPAGE:
+      madv = MADV_HUGEPAGE;
+      break;
+#endif
+    default:
+      break;
+  }
+  const int64_t begin = off - off % PAGE_SIZE;
+  const int64_t end = size < 0 ? map_size : std::min(off + size, map_size);
+  if (madv < 0 || map == nullptr || end <= begin) {
+    return Status(Status::SUCCESS);
+  }
+  if (madvise(map + begin, end - begin, madv) != 0) {
+    return GetErrnoStatus("madvise", errno);
+  }
+  return Status(Status::SUCCESS);
+}
+
+static void RecordMapAdvice(
+    std::vector<MapAdvice>* advices, int64_t off, int64_t size, File::AccessAdvice advice) {
+  const bool hugepage = advice == File::ADVICE_HUGEPAGE;
+  if (!hugepage && advice != File::ADVICE_NORMAL && advice != File::ADVICE_RANDOM &&
+      advice != File::ADVICE_SEQUENTIAL) {
+    return;
+  }
+  auto it = advices->begin();
+  while (it != advices->end()) {
+    if (it->off == off && it->size == size &&
+        (it->advice == File::ADVICE_HUGEPAGE) == hugepage) {
+      it = advices->erase(it);
+    } else {
+      ++it;
+    }
+  }
+  advices->emplace_back(MapAdvice{off, size, advice});
+}
+
+static void ResetMapAdvices(char* map, int64_t map_size, const std::vector<MapAdvice>& advices) {
+  // Split regions are merged so that the mapping can be remapped as a whole.
+  bool readahead = false;
+  bool hugepage = false;
+  for (const auto& rec : advices) {
+    if (rec.advice == File::ADVICE_HUGEPAGE) {
+      hugepage = true;
+    } else {
+      readahead = true;
+    }
+  }
+  if (readahead) {
+    madvise(map, map_size, MADV_NORMAL);
+  }
+#if defined(MADV_NOHUGEPAGE)
+  if (hugepage) {
+    madvise(map, map_size, MADV_NOHUGEPAGE);
+  }
+#endif
+}
+
+static void ReapplyMapAdvices(char* map, int64_t map_size, const std::vector<MapAdvice>& advices) {
+  for (const auto& rec : advices) {
+    ApplyMapAdvice(map, map_size, rec.off, rec.size, rec.advice);
+  }
+}
+
+template <typename EXTENT>
+static void GetExtentSpan(const EXTENT* extents, size_t num_extents,
+                          int64_t* min_off, int64_t* max_end) {
+  *min_off = INT64MAX;
+  *max_end = 0;
+  for (size_t i = 0; i < num_extents; i++) {
+    *min_off = std::min<int64_t>(*min_off, extents[i].off);
+    *max_end = std::max<int64_t>(*max_end, extents[i].off + extents[i].size);
+  }
+}
+
+static size_t GetPiecesSize(const std::string_view* pieces, size_t num_pieces) {
+  size_t size = 0;
+  for (size_t i = 0; i < num_pieces; i++) {
+    size += pieces[i].size();
+  }
+  return size;
+}
+
+static void CopyPieces(char* ptr, const std::string_view* pieces, size_t num_pieces) {
+  for (size_t i = 0; i < num_pieces; i++) {
+    std::memcpy(ptr, pieces[i].data(), pieces[i].size());
+    ptr += pieces[i].size();
+  }
+}
+
+// Writes back modified regions of the map and then synchronizes the data of the file.
+static Status SynchronizeMapRanges(
+    int32_t fd, char* map, int64_t map_size, const std::vector<DirtyRangeSet::Range>& ranges,
+    bool metadata) {
+  Status status(Status::SUCCESS);
+  for (const auto& range : ranges) {
+    const int64_t begin = range.first / PAGE_SIZE * PAGE_SIZE;
+    const int64_t end = std::min(range.first + range.second, map_size);
+    if (begin >= end) {
+      continue;
+    }
+#if defined(_SYS_LINUX_)
+    // On Linux, msync with MS_SYNC flushes the device cache for each region.  Thus, writeback of
+    // all regions is started first and fdatasync waits for them at once.
+    if (sync_file_range(fd, begin, end - begin, SYNC_FILE_RANGE_WRITE) != 0) {
+      status |= GetErrnoStatus("sync_file_range", errno);
+      break;
+    }
+#else
+    if (msync(map + begin, end - begin, MS_SYNC) != 0) {
+      status |= GetErrnoStatus("msync", errno);
+      break;
+    }
+#endif
+  }
+#if defined(_SYS_LINUX_)
+  if (!metadata) {
+    if (fdatasync(fd) != 0) {
+      status |= GetErrnoStatus("fdatasync", errno);
+    }
+    return status;
+  }
+#endif
+  if (fsync(fd) != 0) {
+    status |= GetErrnoStatus("fsync", errno);
+  }
+  return status;
+}
+
 class MemoryMapParallelFileImpl final {
-  friend class MemoryMapParallelFileZoneImpl;
+  friend class MemoryMapParallelFile::Zone;
  public:
   MemoryMapParallelFileImpl();
   ~MemoryMapParallelFileImpl();
@@ -30,47 +190,72 @@ class MemoryMapParallelFileImpl final {
   Status Close();
   Status Truncate(int64_t size);
   Status Synchronize(bool hard);
+  Status SynchronizeRange(int64_t off, int64_t size);
+  Status PunchHole(int64_t off, int64_t size);
   Status GetSize(int64_t* size);
   Status SetAllocationStrategy(int64_t init_size, double inc_factor);
   Status LockMemory(size_t size);
+  Status SetReservedSize(int64_t size);
+  Status Advise(int64_t off, int64_t size, File::AccessAdvice advice);
 
  private:
   Status AdjustMapSize(int64_t min_size);
+  Status RemapMemory(int64_t new_map_size);
+  Status ResizeReservedMap(int64_t new_map_size);
+  Status RelocateReservedMap(int64_t new_map_size);
+  char* ProtectMap(int32_t* epoch_slot);
+  void ReleaseMap(int32_t epoch_slot);
 
   int32_t fd_;
   std::atomic_int64_t file_size_;
-  char* map_;
+  std::atomic<char*> map_;
   std::atomic_int64_t map_size_;
   std::atomic_int64_t lock_size_;
   bool writable_;
   int32_t open_options_;
   int64_t alloc_init_size_;
   double alloc_inc_factor_;
+  int64_t reserve_size_;
+  int64_t space_size_;
+  int64_t mapped_size_;
+  std::vector<MapAdvice> advices_;
+  DirtyRangeSet dirty_ranges_;
+  std::atomic_int64_t synced_size_;
   std::shared_timed_mutex mutex_;
+  std::mutex grow_mutex_;
+  std::atomic_bool remapping_;
+  EpochReclaimer epoch_;
 };
 
-class MemoryMapParallelFileZoneImpl final {
- public:
-  MemoryMapParallelFileZoneImpl(
-      MemoryMapParallelFileImpl* file, bool writable, int64_t off, size_t size, Status* status);
-  ~MemoryMapParallelFileZoneImpl();
-  void SetLockedMutex(std::shared_timed_mutex* mutex);
-  int64_t Offset() const;
-  char* Pointer() const;
-  size_t Size() const;
+static int64_t AlignToPageSize(int64_t size) {
+  const int64_t diff = size % PAGE_SIZE;
+  if (diff > 0) {
+    size += PAGE_SIZE - diff;
+  }
+  return size;
+}
 
- private:
-  MemoryMapParallelFileImpl* file_;
-  int64_t off_;
-  size_t size_;
-  bool writable_;
-};
+static void* MapReservedSpace(int32_t fd, int64_t space_size, int64_t map_size, int32_t mprot) {
+  void* space = mmap(0, space_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (space == MAP_FAILED) {
+    return MAP_FAILED;
+  }
+  if (mmap(space, map_size, mprot, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+    const int32_t mmap_errno = errno;
+    munmap(space, space_size);
+    errno = mmap_errno;
+    return MAP_FAILED;
+  }
+  return space;
+}
 
 MemoryMapParallelFileImpl::MemoryMapParallelFileImpl() :
     fd_(-1), file_size_(-0), map_(nullptr), map_size_(0), lock_size_(0),
     writable_(false), open_options_(0),
     alloc_init_size_(File::DEFAULT_ALLOC_INIT_SIZE),
-    alloc_inc_factor_(File::DEFAULT_ALLOC_INC_FACTOR) {}
+    alloc_inc_factor_(File::DEFAULT_ALLOC_INC_FACTOR),
+    reserve_size_(0), space_size_(0), mapped_size_(0), synced_size_(-1),
+    remapping_(false) {}
 
 MemoryMapParallelFileImpl::~MemoryMapParallelFileImpl() {
   if (fd_ >= 0) {
@@ -149,10 +334,24 @@ Status MemoryMapParallelFileImpl::Open(
       close(fd);
       return status;
     }
+    if (options & File::OPEN_PREALLOCATE) {
+      const Status status = AllocateFileSpace(fd, file_size, map_size - file_size, false);
+      if (status != Status::SUCCESS) {
+        close(fd);
+        return status;
+      }
+    }
   } else {
     map_size = std::max(map_size, static_cast<int64_t>(PAGE_SIZE));
   }
-  void* map = mmap(0, map_size, mprot, MAP_SHARED, fd, 0);
+  int64_t space_size = 0;
+  void* map = nullptr;
+  if (writable && reserve_size_ > 0) {
+    space_size = AlignToPageSize(std::max(reserve_size_, map_size));
+    map = MapReservedSpace(fd, space_size, map_size, mprot);
+  } else {
+    map = mmap(0, map_size, mprot, MAP_SHARED, fd, 0);
+  }
   if (map == MAP_FAILED) {
     const Status status = GetErrnoStatus("mmap", errno);
     close(fd);
@@ -162,8 +361,10 @@ Status MemoryMapParallelFileImpl::Open(
   // Updates the internal data.
   fd_ = fd;
   file_size_.store(file_size);
-  map_ = static_cast<char*>(map);
+  map_.store(static_cast<char*>(map));
   map_size_.store(map_size);
+  space_size_ = space_size;
+  mapped_size_ = map_size;
   writable_ = writable;
   open_options_ = options;
 
@@ -177,8 +378,9 @@ Status MemoryMapParallelFileImpl::Close() {
   Status status(Status::SUCCESS);
 
   // Unmaps the memory.
-  const int64_t unmap_size = std::max(map_size_.load(), static_cast<int64_t>(PAGE_SIZE));
-  if (munmap(map_, unmap_size) != 0) {
+  const int64_t unmap_size = space_size_ > 0 ?
+      space_size_ : std::max(map_size_.load(), static_cast<int64_t>(PAGE_SIZE));
+  if (munmap(map_.load(), unmap_size) != 0) {
     status |= GetErrnoStatus("munmap", errno);
   }
 
@@ -209,11 +411,16 @@ Status MemoryMapParallelFileImpl::Close() {
   // Updates the internal data.
   fd_ = -1;
   file_size_ .store(0);
-  map_ = nullptr;
+  map_.store(nullptr);
   map_size_.store(0);
+  space_size_ = 0;
+  mapped_size_ = 0;
+  advices_.clear();
   lock_size_.store(0);
   writable_ = false;
   open_options_ = 0;
+  dirty_ranges_.Clear();
+  synced_size_ = -1;
 
   return status;
 }
@@ -225,7 +432,7 @@ Status MemoryMapParallelFileImpl::Truncate(int64_t size) {
   if (!writable_) {
     return Status(Status::PRECONDITION_ERROR, "not writable file");
   }
-  if (lock_size_.load() > 0 && munlock(map_, lock_size_.load()) != 0) {
+  if (lock_size_.load() > 0 && munlock(map_.load(), lock_size_.load()) != 0) {
     return GetErrnoStatus("munlock", errno);
   }
   lock_size_.store(0);
@@ -235,12 +442,28 @@ Status MemoryMapParallelFileImpl::Truncate(int64_t size) {
   if (diff > 0) {
     new_map_size += PAGE_SIZE - diff;
   }
-  void* new_map = mremap(map_, map_size_.load(), new_map_size, MREMAP_MAYMOVE);
+  if (space_size_ > 0) {
+    if (ftruncate(fd_, new_map_size) != 0) {
+      return GetErrnoStatus("ftruncate", errno);
+    }
+    const Status status = new_map_size <= space_size_ ?
+        ResizeReservedMap(new_map_size) : RelocateReservedMap(new_map_size);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+    map_size_.store(new_map_size);
+    file_size_.store(size);
+    return Status(Status::SUCCESS);
+  }
+  ResetMapAdvices(map_.load(), map_size_.load(), advices_);
+  void* new_map = mremap(map_.load(), map_size_.load(), new_map_size, MREMAP_MAYMOVE);
   if (new_map == MAP_FAILED) {
     return GetErrnoStatus("mremap", errno);
   }
-  map_ = static_cast<char*>(new_map);
+  map_.store(static_cast<char*>(new_map));
   map_size_.store(new_map_size);
+  mapped_size_ = new_map_size;
+  ReapplyMapAdvices(map_.load(), mapped_size_, advices_);
   if (ftruncate(fd_, new_map_size) != 0) {
     return GetErrnoStatus("ftruncate", errno);
   }
@@ -255,23 +478,56 @@ Status MemoryMapParallelFileImpl::Synchronize(bool hard) {
   if (!writable_) {
     return Status(Status::PRECONDITION_ERROR, "not writable file");
   }
+  std::lock_guard<std::mutex> grow_lock(grow_mutex_);
   std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+  remapping_.store(true);
+  epoch_.Synchronize();
   Status status(Status::SUCCESS);
-  map_size_.store(file_size_.load());
+  const int64_t old_map_size = map_size_.exchange(file_size_.load());
   if (ftruncate(fd_, map_size_.load()) != 0) {
     status |= GetErrnoStatus("ftruncate", errno);
   }
+  if (open_options_ & File::OPEN_PREALLOCATE) {
+    // The blocks beyond the end are kept reserved for the data to be added later.
+    const int64_t map_size = map_size_.load();
+    status |= AllocateFileSpace(fd_, map_size, old_map_size - map_size, true);
+  }
   if (hard) {
-    if (msync(map_, map_size_, MS_SYNC) != 0) {
-      status |= GetErrnoStatus("msync", errno);
-    }
-    if (fsync(fd_) != 0) {
-      status |= GetErrnoStatus("fsync", errno);
-    }
+    const int64_t map_size = map_size_.load();
+    status |= SynchronizeMapRanges(fd_, map_.load(), map_size, dirty_ranges_.Extract(),
+                                   map_size != synced_size_.load());
+    synced_size_.store(map_size);
+  }
+  remapping_.store(false);
+  return status;
+}
+
+Status MemoryMapParallelFileImpl::SynchronizeRange(int64_t off, int64_t size) {
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  if (!writable_) {
+    return Status(Status::PRECONDITION_ERROR, "not writable file");
   }
+  std::lock_guard<std::mutex> grow_lock(grow_mutex_);
+  const int64_t map_size = map_size_.load();
+  const Status status = SynchronizeMapRanges(fd_, map_.load(), map_size,
+                                             dirty_ranges_.Extract(off, size),
+                                             map_size != synced_size_.load());
+  synced_size_.store(map_size);
   return status;
 }
 
+Status MemoryMapParallelFileImpl::PunchHole(int64_t off, int64_t size) {
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  if (!writable_) {
+    return Status(Status::PRECONDITION_ERROR, "not writable file");
+  }
+  return PunchFileHole(fd_, off, size);
+}
+
 Status MemoryMapParallelFileImpl::GetSize(int64_t* size) {
   if (fd_ < 0) {
     return Status(Status::PRECONDITION_ERROR, "not opened file");
@@ -293,126 +549,174 @@ Status MemoryMapParallelFileImpl::LockMemory(size_t size) {
   if (fd_ < 0) {
     return Status(Status::PRECONDITION_ERROR, "not opened file");
   }
-  if (lock_size_.load() > 0 && munlock(map_, lock_size_.load()) != 0) {
+  if (lock_size_.load() > 0 && munlock(map_.load(), lock_size_.load()) != 0) {
     return GetErrnoStatus("munlock", errno);
   }
   lock_size_.store(0);
-  if (size > 0 && mlock(map_, size) != 0) {
+  if (size > 0 && mlock(map_.load(), size) != 0) {
     return GetErrnoStatus("mlock", errno);
   }
   lock_size_.store(size);
   return Status(Status::SUCCESS);
 }
 
+Status MemoryMapParallelFileImpl::SetReservedSize(int64_t size) {
+  if (fd_ >= 0) {
+    return Status(Status::PRECONDITION_ERROR, "alread opened file");
+  }
+  reserve_size_ = size;
+  return Status(Status::SUCCESS);
+}
+
+Status MemoryMapParallelFileImpl::Advise(int64_t off, int64_t size, File::AccessAdvice advice) {
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  std::lock_guard<std::mutex> grow_lock(grow_mutex_);
+  RecordMapAdvice(&advices_, off, size, advice);
+  return ApplyMapAdvice(map_.load(), mapped_size_, off, size, advice);
+}
+
 Status MemoryMapParallelFileImpl::AdjustMapSize(int64_t min_size) {
   if (min_size <= map_size_.load()) {
     return Status(Status::SUCCESS);
   }
-  std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+  std::lock_guard<std::mutex> grow_lock(grow_mutex_);
   if (min_size <= map_size_.load()) {
     return Status(Status::SUCCESS);
   }
-  if (lock_size_.load() > 0 && munlock(map_, lock_size_.load()) != 0) {
-    return GetErrnoStatus("munlock", errno);
-  }
   int64_t new_map_size =
       std::max(std::max(min_size, static_cast<int64_t>(
           map_size_.load() * alloc_inc_factor_)), static_cast<int64_t>(PAGE_SIZE));
-  const int64_t diff = new_map_size % PAGE_SIZE;
-  if (diff > 0) {
-    new_map_size += PAGE_SIZE - diff;
+  new_map_size = AlignToPageSize(new_map_size);
+  if (space_size_ > 0 && min_size <= space_size_) {
+    // The mapping is extended in place so that readers and writers are not blocked.
+    new_map_size = std::min(new_map_size, space_size_);
+    if (ftruncate(fd_, new_map_size) != 0) {
+      return GetErrnoStatus("ftruncate", errno);
+    }
+    if (open_options_ & File::OPEN_PREALLOCATE) {
+      const int64_t map_size = map_size_.load();
+      const Status status = AllocateFileSpace(fd_, map_size, new_map_size - map_size, false);
+      if (status != Status::SUCCESS) {
+        return status;
+      }
+    }
+    const Status status = ResizeReservedMap(new_map_size);
+    if (status == Status::SUCCESS) {
+      map_size_.store(new_map_size);
+    }
+    return status;
   }
+  std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+  // Readers coming after this take the shared lock.  Lock-free readers are waited for.
+  remapping_.store(true);
+  epoch_.Synchronize();
+  const Status status = RemapMemory(new_map_size);
+  remapping_.store(false);
+  return status;
+}
+
+Status MemoryMapParallelFileImpl::RemapMemory(int64_t new_map_size) {
   if (ftruncate(fd_, new_map_size) != 0) {
     return GetErrnoStatus("ftruncate", errno);
   }
-  void* new_map = mremap(map_, map_size_.load(), new_map_size, MREMAP_MAYMOVE);
+  if (open_options_ & File::OPEN_PREALLOCATE) {
+    const int64_t map_size = map_size_.load();
+    const Status status = AllocateFileSpace(fd_, map_size, new_map_size - map_size, false);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+  }
+  if (space_size_ > 0) {
+    const Status status = RelocateReservedMap(new_map_size);
+    if (status == Status::SUCCESS) {
+      map_size_.store(new_map_size);
+    }
+    return status;
+  }
+  if (lock_size_.load() > 0 && munlock(map_.load(), lock_size_.load()) != 0) {
+    return GetErrnoStatus("munlock", errno);
+  }
+  ResetMapAdvices(map_.load(), map_size_.load(), advices_);
+  void* new_map = mremap(map_.load(), map_size_.load(), new_map_size, MREMAP_MAYMOVE);
   if (new_map == MAP_FAILED) {
     return GetErrnoStatus("mremap", errno);
   }
-  map_ = static_cast<char*>(new_map);
+  map_.store(static_cast<char*>(new_map));
   map_size_.store(new_map_size);
-  if (lock_size_.load() > 0 && mlock(map_, lock_size_.load()) != 0) {
+  mapped_size_ = new_map_size;
+  ReapplyMapAdvices(map_.load(), mapped_size_, advices_);
+  if (lock_size_.load() > 0 && mlock(map_.load(), lock_size_.load()) != 0) {
     lock_size_.store(0);
     return GetErrnoStatus("mlock", errno);
   }
   return Status(Status::SUCCESS);
 }
 
-MemoryMapParallelFileZoneImpl::MemoryMapParallelFileZoneImpl(
-    MemoryMapParallelFileImpl* file, bool writable, int64_t off, size_t size, Status* status)
-    : file_(nullptr), off_(-1), size_(0), writable_(writable) {
-  if (file->fd_ < 0) {
-    status->Set(Status::PRECONDITION_ERROR, "not opened file");
-    return;
-  }
-  if (writable) {
-    if (!file->writable_) {
-      status->Set(Status::PRECONDITION_ERROR, "not writable file");
-      return;
+Status MemoryMapParallelFileImpl::ResizeReservedMap(int64_t new_map_size) {
+  char* map = map_.load();
+  if (new_map_size > mapped_size_) {
+    if (mmap(map + mapped_size_, new_map_size - mapped_size_, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_FIXED, fd_, mapped_size_) == MAP_FAILED) {
+      return GetErrnoStatus("mmap", errno);
     }
-    if (off < 0) {
-      int64_t old_file_size = 0;
-      while (true) {
-        old_file_size = file->file_size_.load();
-        const int64_t end_position = old_file_size + size;
-        const Status adjust_status = file->AdjustMapSize(end_position);
-        if (adjust_status != Status::SUCCESS) {
-          *status = adjust_status;
-          return;
-        }
-        if (file->file_size_.compare_exchange_weak(old_file_size, end_position)) {
-          break;
-        }
-      }
-      off = old_file_size;
-    } else {
-      const int64_t end_position = off + size;
-      const Status adjust_status = file->AdjustMapSize(end_position);
-      if (adjust_status != Status::SUCCESS) {
-        *status = adjust_status;
-        return;
-      }
-      while (true) {
-        int64_t old_file_size = file->file_size_.load();
-        if (end_position <= old_file_size ||
-            file->file_size_.compare_exchange_weak(old_file_size, end_position)) {
-          break;
-        }
-      }
-    }
-  } else {
-    if (off < 0) {
-      status->Set(Status::PRECONDITION_ERROR, "negative offset");
-      return;
-    }
-    if (off > file->file_size_.load()) {
-      status->Set(Status::INFEASIBLE_ERROR, "excessive offset");
-      return;
+    ReapplyMapAdvices(map, new_map_size, advices_);
+  } else if (new_map_size < mapped_size_) {
+    if (mmap(map + new_map_size, mapped_size_ - new_map_size, PROT_NONE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0) == MAP_FAILED) {
+      return GetErrnoStatus("mmap", errno);
     }
-    size = std::min(static_cast<int64_t>(size), file->file_size_.load() - off);
   }
-  file_ = file;
-  file_->mutex_.lock_shared();
-  off_ = off;
-  size_ = size;
+  mapped_size_ = new_map_size;
+  return Status(Status::SUCCESS);
 }
 
-MemoryMapParallelFileZoneImpl::~MemoryMapParallelFileZoneImpl() {
-  if (file_ != nullptr) {
-    file_->mutex_.unlock_shared();
+Status MemoryMapParallelFileImpl::RelocateReservedMap(int64_t new_map_size) {
+  if (lock_size_.load() > 0 && munlock(map_.load(), lock_size_.load()) != 0) {
+    return GetErrnoStatus("munlock", errno);
   }
+  const int64_t new_space_size = AlignToPageSize(std::max(
+      static_cast<int64_t>(space_size_ * alloc_inc_factor_), new_map_size));
+  void* new_map = MapReservedSpace(fd_, new_space_size, new_map_size, PROT_READ | PROT_WRITE);
+  if (new_map == MAP_FAILED) {
+    return GetErrnoStatus("mmap", errno);
+  }
+  if (munmap(map_.load(), space_size_) != 0) {
+    const Status status = GetErrnoStatus("munmap", errno);
+    munmap(new_map, new_space_size);
+    return status;
+  }
+  map_.store(static_cast<char*>(new_map));
+  space_size_ = new_space_size;
+  mapped_size_ = new_map_size;
+  ReapplyMapAdvices(map_.load(), mapped_size_, advices_);
+  if (lock_size_.load() > 0 && mlock(map_.load(), lock_size_.load()) != 0) {
+    lock_size_.store(0);
+    return GetErrnoStatus("mlock", errno);
+  }
+  return Status(Status::SUCCESS);
 }
 
-int64_t MemoryMapParallelFileZoneImpl::Offset() const {
-  return off_;
-}
-
-char* MemoryMapParallelFileZoneImpl::Pointer() const {
-  return file_->map_ + off_;
+char* MemoryMapParallelFileImpl::ProtectMap(int32_t* epoch_slot) {
+  *epoch_slot = epoch_.Enter();
+  if (*epoch_slot >= 0) {
+    if (!remapping_.load()) {
+      return map_.load();
+    }
+    epoch_.Leave(*epoch_slot);
+    *epoch_slot = -1;
+  }
+  mutex_.lock_shared();
+  return map_.load();
 }
 
-size_t MemoryMapParallelFileZoneImpl::Size() const {
-  return size_;
+void MemoryMapParallelFileImpl::ReleaseMap(int32_t epoch_slot) {
+  if (epoch_slot >= 0) {
+    epoch_.Leave(epoch_slot);
+  } else {
+    mutex_.unlock_shared();
+  }
 }
 
 MemoryMapParallelFile::MemoryMapParallelFile() {
@@ -434,69 +738,126 @@ Status MemoryMapParallelFile::Close() {
 Status MemoryMapParallelFile::MakeZone(
     bool writable, int64_t off, size_t size, std::unique_ptr<Zone>* zone) {
   Status status(Status::SUCCESS);
-  zone->reset(new Zone(impl_, writable, off, size, &status));
+  zone->reset(new Zone(this, writable, off, size, &status));
   return status;
 }
 
 Status MemoryMapParallelFile::Read(int64_t off, void* buf, size_t size) {
   assert(off >= 0 && buf != nullptr);
-  std::unique_ptr<Zone> zone;
-  Status status = MakeZone(false, off, size, &zone);
+  Status status(Status::SUCCESS);
+  Zone zone(this, false, off, size, &status);
   if (status != Status::SUCCESS) {
     return status;
   }
-  if (zone->Size() != size) {
+  if (zone.Size() != size) {
     return Status(Status::INFEASIBLE_ERROR, "excessive size");
   }
-  std::memcpy(buf, zone->Pointer(), zone->Size());
+  std::memcpy(buf, zone.Pointer(), zone.Size());
   return Status(Status::SUCCESS);
 }
 
 std::string MemoryMapParallelFile::ReadSimple(int64_t off, size_t size) {
   assert(off >= 0);
-  std::unique_ptr<Zone> zone;
-  Status status = MakeZone(false, off, size, &zone);
-  if (status != Status::SUCCESS || zone->Size() != size) {
+  Status status(Status::SUCCESS);
+  Zone zone(this, false, off, size, &status);
+  if (status != Status::SUCCESS || zone.Size() != size) {
     return "";
   }
-  std::string result(zone->Pointer(), size);
+  std::string result(zone.Pointer(), size);
   return result;
 }
 
 Status MemoryMapParallelFile::Write(int64_t off, const void* buf, size_t size) {
   assert(off >= 0 && buf != nullptr && size <= MAX_MEMORY_SIZE);
-  std::unique_ptr<Zone> zone;
-  Status status = MakeZone(true, off, size, &zone);
+  Status status(Status::SUCCESS);
+  Zone zone(this, true, off, size, &status);
   if (status != Status::SUCCESS) {
     return status;
   }
-  std::memcpy(zone->Pointer(), buf, zone->Size());
+  std::memcpy(zone.Pointer(), buf, zone.Size());
   return Status(Status::SUCCESS);
 }
 
 Status MemoryMapParallelFile::Append(const void* buf, size_t size, int64_t* off) {
   assert(buf != nullptr && size <= MAX_MEMORY_SIZE);
-  std::unique_ptr<Zone> zone;
-  Status status = MakeZone(true, -1, size, &zone);
+  Status status(Status::SUCCESS);
+  Zone zone(this, true, -1, size, &status);
   if (status != Status::SUCCESS) {
     return status;
   }
-  std::memcpy(zone->Pointer(), buf, zone->Size());
+  std::memcpy(zone.Pointer(), buf, zone.Size());
   if (off != nullptr) {
-    *off = zone->Offset();
+    *off = zone.Offset();
+  }
+  return Status(Status::SUCCESS);
+}
+
+Status MemoryMapParallelFile::ReadV(const ReadExtent* extents, size_t num_extents) {
+  assert(extents != nullptr || num_extents == 0);
+  if (num_extents == 0) {
+    return Status(Status::SUCCESS);
+  }
+  int64_t min_off = 0, max_end = 0;
+  GetExtentSpan(extents, num_extents, &min_off, &max_end);
+  const size_t span = max_end - min_off;
+  Status status(Status::SUCCESS);
+  Zone zone(this, false, min_off, span, &status);
+  if (status != Status::SUCCESS) {
+    return status;
+  }
+  if (zone.Size() != span) {
+    return Status(Status::INFEASIBLE_ERROR, "excessive size");
+  }
+  for (size_t i = 0; i < num_extents; i++) {
+    std::memcpy(extents[i].buf, zone.Pointer() + (extents[i].off - min_off), extents[i].size);
+  }
+  return Status(Status::SUCCESS);
+}
+
+Status MemoryMapParallelFile::WriteV(const WriteExtent* extents, size_t num_extents) {
+  assert(extents != nullptr || num_extents == 0);
+  if (num_extents == 0) {
+    return Status(Status::SUCCESS);
+  }
+  int64_t min_off = 0, max_end = 0;
+  GetExtentSpan(extents, num_extents, &min_off, &max_end);
+  Status status(Status::SUCCESS);
+  Zone zone(this, true, min_off, max_end - min_off, &status);
+  if (status != Status::SUCCESS) {
+    return status;
+  }
+  for (size_t i = 0; i < num_extents; i++) {
+    std::memcpy(zone.Pointer() + (extents[i].off - min_off), extents[i].buf, extents[i].size);
+  }
+  return Status(Status::SUCCESS);
+}
+
+Status MemoryMapParallelFile::AppendV(
+    const std::string_view* pieces, size_t num_pieces, int64_t* off) {
+  assert(pieces != nullptr || num_pieces == 0);
+  const size_t size = GetPiecesSize(pieces, num_pieces);
+  assert(size <= MAX_MEMORY_SIZE);
+  Status status(Status::SUCCESS);
+  Zone zone(this, true, -1, size, &status);
+  if (status != Status::SUCCESS) {
+    return status;
+  }
+  CopyPieces(zone.Pointer(), pieces, num_pieces);
+  if (off != nullptr) {
+    *off = zone.Offset();
   }
   return Status(Status::SUCCESS);
 }
 
 Status MemoryMapParallelFile::Expand(size_t inc_size, int64_t* old_size) {
   assert(inc_size <= MAX_MEMORY_SIZE);
-  std::unique_ptr<Zone> zone;
-  Status status = MakeZone(true, -1, inc_size, &zone);
+  Status status(Status::SUCCESS);
+  Zone zone(this, true, -1, inc_size, &status);
   if (status != Status::SUCCESS) {
     return status;
   }
   if (old_size != nullptr) {
-    *old_size = zone->Offset();
+    *old_size = zone.Offset();
   }
   return Status(Status::SUCCESS);
 }
@@ -510,6 +871,16 @@ Status MemoryMapParallelFile::Synchronize(bool hard) {
   return impl_->Synchronize(hard);
 }
 
+Status MemoryMapParallelFile::SynchronizeRange(int64_t off, int64_t size) {
+  assert(off >= 0);
+  return impl_->SynchronizeRange(off, size);
+}
+
+Status MemoryMapParallelFile::PunchHole(int64_t off, int64_t size) {
+  assert(off >= 0 && size >= 0);
+  return impl_->PunchHole(off, size);
+}
+
 Status MemoryMapParallelFile::GetSize(int64_t* size) {
   assert(size != nullptr);
   return impl_->GetSize(size);
@@ -525,26 +896,96 @@ Status MemoryMapParallelFile::LockMemory(size_t size) {
   return impl_->LockMemory(size);
 }
 
+Status MemoryMapParallelFile::SetReservedSize(int64_t size) {
+  assert(size >= 0);
+  return impl_->SetReservedSize(size);
+}
+
+Status MemoryMapParallelFile::Advise(int64_t off, int64_t size, AccessAdvice advice) {
+  assert(off >= 0);
+  return impl_->Advise(off, size, advice);
+}
+
 MemoryMapParallelFile::Zone::Zone(
-    MemoryMapParallelFileImpl* file_impl, bool writable, int64_t off, size_t size,
-    Status* status) {
-  impl_ = new MemoryMapParallelFileZoneImpl(file_impl, writable, off, size, status);
+    MemoryMapParallelFile* file, bool writable, int64_t off, size_t size, Status* status)
+    : file_impl_(nullptr), ptr_(nullptr), off_(-1), size_(0), epoch_slot_(-1),
+      writable_(writable) {
+  MemoryMapParallelFileImpl* file_impl = file->impl_;
+  if (file_impl->fd_ < 0) {
+    status->Set(Status::PRECONDITION_ERROR, "not opened file");
+    return;
+  }
+  if (writable) {
+    if (!file_impl->writable_) {
+      status->Set(Status::PRECONDITION_ERROR, "not writable file");
+      return;
+    }
+    if (off < 0) {
+      int64_t old_file_size = 0;
+      while (true) {
+        old_file_size = file_impl->file_size_.load();
+        const int64_t end_position = old_file_size + size;
+        const Status adjust_status = file_impl->AdjustMapSize(end_position);
+        if (adjust_status != Status::SUCCESS) {
+          *status = adjust_status;
+          return;
+        }
+        if (file_impl->file_size_.compare_exchange_weak(old_file_size, end_position)) {
+          break;
+        }
+      }
+      off = old_file_size;
+    } else {
+      const int64_t end_position = off + size;
+      const Status adjust_status = file_impl->AdjustMapSize(end_position);
+      if (adjust_status != Status::SUCCESS) {
+        *status = adjust_status;
+        return;
+      }
+      while (true) {
+        int64_t old_file_size = file_impl->file_size_.load();
+        if (end_position <= old_file_size ||
+            file_impl->file_size_.compare_exchange_weak(old_file_size, end_position)) {
+          break;
+        }
+      }
+    }
+  } else {
+    if (off < 0) {
+      status->Set(Status::PRECONDITION_ERROR, "negative offset");
+      return;
+    }
+    if (off > file_impl->file_size_.load()) {
+      status->Set(Status::INFEASIBLE_ERROR, "excessive offset");
+      return;
+    }
+    size = std::min(static_cast<int64_t>(size), file_impl->file_size_.load() - off);
+  }
+  file_impl_ = file_impl;
+  ptr_ = file_impl->ProtectMap(&epoch_slot_) + off;
+  off_ = off;
+  size_ = size;
 }
 
 MemoryMapParallelFile::Zone::~Zone() {
-  delete impl_;
+  if (file_impl_ != nullptr) {
+    if (writable_) {
+      file_impl_->dirty_ranges_.Add(off_, size_);
+    }
+    file_impl_->ReleaseMap(epoch_slot_);
+  }
 }
 
 int64_t MemoryMapParallelFile::Zone::Offset() const {
-  return impl_->Offset();
+  return off_;
 }
 
 char* MemoryMapParallelFile::Zone::Pointer() const {
-  return impl_->Pointer();
+  return ptr_;
 }
 
 size_t MemoryMapParallelFile::Zone::Size() const {
-  return impl_->Size();
+  return size_;
 }
 
 class MemoryMapAtomicFileImpl final {
@@ -556,9 +997,12 @@ class MemoryMapAtomicFileImpl final {
   Status Close();
   Status Truncate(int64_t size);
   Status Synchronize(bool hard);
+  Status SynchronizeRange(int64_t off, int64_t size);
+  Status PunchHole(int64_t off, int64_t size);
   Status GetSize(int64_t* size);
   Status SetAllocationStrategy(int64_t init_size, double inc_factor);
   Status LockMemory(size_t size);
+  Status Advise(int64_t off, int64_t size, File::AccessAdvice advice);
 
  private:
   int32_t fd_;
@@ -570,6 +1014,9 @@ class MemoryMapAtomicFileImpl final {
   int32_t open_options_;
   int64_t alloc_init_size_;
   double alloc_inc_factor_;
+  std::vector<MapAdvice> advices_;
+  DirtyRangeSet dirty_ranges_;
+  int64_t synced_size_;
   std::shared_timed_mutex mutex_;
 };
 
@@ -594,7 +1041,7 @@ MemoryMapAtomicFileImpl::MemoryMapAtomicFileImpl() :
     fd_(-1), file_size_(0), map_(nullptr), map_size_(0), lock_size_(0),
     writable_(false), open_options_(0),
     alloc_init_size_(File::DEFAULT_ALLOC_INIT_SIZE),
-    alloc_inc_factor_(File::DEFAULT_ALLOC_INC_FACTOR) {}
+    alloc_inc_factor_(File::DEFAULT_ALLOC_INC_FACTOR), synced_size_(-1) {}
 
 MemoryMapAtomicFileImpl::~MemoryMapAtomicFileImpl() {
   if (fd_ >= 0) {
@@ -674,6 +1121,13 @@ Status MemoryMapAtomicFileImpl::Open(
       close(fd);
       return status;
     }
+    if (options & File::OPEN_PREALLOCATE) {
+      const Status status = AllocateFileSpace(fd, file_size, map_size - file_size, false);
+      if (status != Status::SUCCESS) {
+        close(fd);
+        return status;
+      }
+    }
   } else {
     map_size = std::max(map_size, static_cast<int64_t>(PAGE_SIZE));
   }
@@ -737,9 +1191,12 @@ Status MemoryMapAtomicFileImpl::Close() {
   file_size_ = 0;
   map_ = nullptr;
   map_size_ = 0;
+  advices_.clear();
   lock_size_ = 0;
   writable_ = false;
   open_options_ = 0;
+  dirty_ranges_.Clear();
+  synced_size_ = -1;
 
   return status;
 }
@@ -762,12 +1219,14 @@ Status MemoryMapAtomicFileImpl::Truncate(int64_t size) {
   if (diff > 0) {
     new_map_size += PAGE_SIZE - diff;
   }
+  ResetMapAdvices(map_, map_size_, advices_);
   void* new_map = mremap(map_, map_size_, new_map_size, MREMAP_MAYMOVE);
   if (new_map == MAP_FAILED) {
     return GetErrnoStatus("mremap", errno);
   }
   map_ = static_cast<char*>(new_map);
   map_size_ = new_map_size;
+  ReapplyMapAdvices(map_, map_size_, advices_);
   if (ftruncate(fd_, new_map_size) != 0) {
     return GetErrnoStatus("ftruncate", errno);
   }
@@ -784,21 +1243,48 @@ Status MemoryMapAtomicFileImpl::Synchronize(bool hard) {
     return Status(Status::PRECONDITION_ERROR, "not writable file");
   }
   Status status(Status::SUCCESS);
+  const int64_t old_map_size = map_size_;
   map_size_ = file_size_;
   if (ftruncate(fd_, map_size_) != 0) {
     status |= GetErrnoStatus("ftruncate", errno);
   }
+  if (open_options_ & File::OPEN_PREALLOCATE) {
+    // The blocks beyond the end are kept reserved for the data to be added later.
+    status |= AllocateFileSpace(fd_, map_size_, old_map_size - map_size_, true);
+  }
   if (hard) {
-    if (msync(map_, map_size_, MS_SYNC) != 0) {
-      status |= GetErrnoStatus("msync", errno);
-    }
-    if (fsync(fd_) != 0) {
-      status |= GetErrnoStatus("fsync", errno);
-    }
+    status |= SynchronizeMapRanges(
+        fd_, map_, map_size_, dirty_ranges_.Extract(), map_size_ != synced_size_);
+    synced_size_ = map_size_;
+  }
+  return status;
+}
+
+Status MemoryMapAtomicFileImpl::SynchronizeRange(int64_t off, int64_t size) {
+  std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  if (!writable_) {
+    return Status(Status::PRECONDITION_ERROR, "not writable file");
   }
+  const Status status = SynchronizeMapRanges(
+      fd_, map_, map_size_, dirty_ranges_.Extract(off, size), map_size_ != synced_size_);
+  synced_size_ = map_size_;
   return status;
 }
 
+Status MemoryMapAtomicFileImpl::PunchHole(int64_t off, int64_t size) {
+  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  if (!writable_) {
+    return Status(Status::PRECONDITION_ERROR, "not writable file");
+  }
+  return PunchFileHole(fd_, off, size);
+}
+
 Status MemoryMapAtomicFileImpl::GetSize(int64_t* size) {
   std::shared_lock<std::shared_timed_mutex> lock(mutex_);
   if (fd_ < 0) {
@@ -834,6 +1320,15 @@ Status MemoryMapAtomicFileImpl::LockMemory(size_t size) {
   return Status(Status::SUCCESS);
 }
 
+Status MemoryMapAtomicFileImpl::Advise(int64_t off, int64_t size, File::AccessAdvice advice) {
+  std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  RecordMapAdvice(&advices_, off, size, advice);
+  return ApplyMapAdvice(map_, map_size_, off, size, advice);
+}
+
 MemoryMapAtomicFileZoneImpl::MemoryMapAtomicFileZoneImpl(
     MemoryMapAtomicFileImpl* file, bool writable, int64_t off, size_t size, Status* status)
     : file_(file), off_(-1), size_(0), writable_(writable) {
@@ -871,6 +1366,14 @@ MemoryMapAtomicFileZoneImpl::MemoryMapAtomicFileZoneImpl(
         *status = GetErrnoStatus("ftruncate", errno);
         return;
       }
+      if (file_->open_options_ & File::OPEN_PREALLOCATE) {
+        *status = AllocateFileSpace(
+            file_->fd_, file_->map_size_, new_map_size - file_->map_size_, false);
+        if (*status != Status::SUCCESS) {
+          return;
+        }
+      }
+      ResetMapAdvices(file_->map_, file_->map_size_, file_->advices_);
       void* new_map = mremap(file_->map_, file_->map_size_, new_map_size, MREMAP_MAYMOVE);
       if (new_map == MAP_FAILED) {
         *status = GetErrnoStatus("mremap", errno);
@@ -878,6 +1381,7 @@ MemoryMapAtomicFileZoneImpl::MemoryMapAtomicFileZoneImpl(
       }
       file_->map_ = static_cast<char*>(new_map);
       file_->map_size_ = new_map_size;
+      ReapplyMapAdvices(file_->map_, file_->map_size_, file_->advices_);
       if (file_->lock_size_ > 0 && mlock(file->map_, file_->lock_size_) != 0) {
         file_->lock_size_ = 0;
         *status = GetErrnoStatus("mlock", errno);
@@ -902,6 +1406,9 @@ MemoryMapAtomicFileZoneImpl::MemoryMapAtomicFileZoneImpl(
 
 MemoryMapAtomicFileZoneImpl::~MemoryMapAtomicFileZoneImpl() {
   if (writable_) {
+    if (off_ >= 0) {
+      file_->dirty_ranges_.Add(off_, size_);
+    }
     file_->mutex_.unlock();
   } else {
     file_->mutex_.unlock_shared();
@@ -993,6 +1500,63 @@ Status MemoryMapAtomicFile::Append(const void* buf, size_t size, int64_t* off) {
   return Status(Status::SUCCESS);
 }
 
+Status MemoryMapAtomicFile::ReadV(const ReadExtent* extents, size_t num_extents) {
+  assert(extents != nullptr || num_extents == 0);
+  if (num_extents == 0) {
+    return Status(Status::SUCCESS);
+  }
+  int64_t min_off = 0, max_end = 0;
+  GetExtentSpan(extents, num_extents, &min_off, &max_end);
+  const size_t span = max_end - min_off;
+  std::unique_ptr<Zone> zone;
+  Status status = MakeZone(false, min_off, span, &zone);
+  if (status != Status::SUCCESS) {
+    return status;
+  }
+  if (zone->Size() != span) {
+    return Status(Status::INFEASIBLE_ERROR, "excessive size");
+  }
+  for (size_t i = 0; i < num_extents; i++) {
+    std::memcpy(extents[i].buf, zone->Pointer() + (extents[i].off - min_off), extents[i].size);
+  }
+  return Status(Status::SUCCESS);
+}
+
+Status MemoryMapAtomicFile::WriteV(const WriteExtent* extents, size_t num_extents) {
+  assert(extents != nullptr || num_extents == 0);
+  if (num_extents == 0) {
+    return Status(Status::SUCCESS);
+  }
+  int64_t min_off = 0, max_end = 0;
+  GetExtentSpan(extents, num_extents, &min_off, &max_end);
+  std::unique_ptr<Zone> zone;
+  Status status = MakeZone(true, min_off, max_end - min_off, &zone);
+  if (status != Status::SUCCESS) {
+    return status;
+  }
+  for (size_t i = 0; i < num_extents; i++) {
+    std::memcpy(zone->Pointer() + (extents[i].off - min_off), extents[i].buf, extents[i].size);
+  }
+  return Status(Status::SUCCESS);
+}
+
+Status MemoryMapAtomicFile::AppendV(
+    const std::string_view* pieces, size_t num_pieces, int64_t* off) {
+  assert(pieces != nullptr || num_pieces == 0);
+  const size_t size = GetPiecesSize(pieces, num_pieces);
+  assert(size <= MAX_MEMORY_SIZE);
+  std::unique_ptr<Zone> zone;
+  Status status = MakeZone(true, -1, size, &zone);
+  if (status != Status::SUCCESS) {
+    return status;
+  }
+  CopyPieces(zone->Pointer(), pieces, num_pieces);
+  if (off != nullptr) {
+    *off = zone->Offset();
+  }
+  return Status(Status::SUCCESS);
+}
+
 Status MemoryMapAtomicFile::Expand(size_t inc_size, int64_t* old_size) {
   assert(inc_size <= MAX_MEMORY_SIZE);
   std::unique_ptr<Zone> zone;
@@ -1015,6 +1579,16 @@ Status MemoryMapAtomicFile::Synchronize(bool hard) {
   return impl_->Synchronize(hard);
 }
 
+Status MemoryMapAtomicFile::SynchronizeRange(int64_t off, int64_t size) {
+  assert(off >= 0);
+  return impl_->SynchronizeRange(off, size);
+}
+
+Status MemoryMapAtomicFile::PunchHole(int64_t off, int64_t size) {
+  assert(off >= 0 && size >= 0);
+  return impl_->PunchHole(off, size);
+}
+
 Status MemoryMapAtomicFile::GetSize(int64_t* size) {
   assert(size != nullptr);
   return impl_->GetSize(size);
@@ -1030,6 +1604,11 @@ Status MemoryMapAtomicFile::LockMemory(size_t size) {
   return impl_->LockMemory(size);
 }
 
+Status MemoryMapAtomicFile::Advise(int64_t off, int64_t size, AccessAdvice advice) {
+  assert(off >= 0);
+  return impl_->Advise(off, size, advice);
+}
+
 MemoryMapAtomicFile::Zone::Zone(
     MemoryMapAtomicFileImpl* file_impl, bool writable, int64_t off, size_t size, Status* status) {
   impl_ = new MemoryMapAtomicFileZoneImpl(file_impl, writable, off, size, status);
@@ -26,7 +26,6 @@
 namespace tkrzw {
 
 class MemoryMapParallelFileImpl;
-class MemoryMapParallelFileZoneImpl;
 
 /**
  * File implementation with memory mapping and locking for parallel operations.
@@ -38,12 +37,29 @@ class MemoryMapParallelFile final : public File {
  public:
   /**
    * Structure to make a shared section where a region can be accessed.
-   * @details The zone object contains a mutex which is locked by the constructor and unlocked by
-   * the destructor.  The user can access the region freely while the zone object is alive.
+   * @details The zone object protects the mapping from being moved by the constructor and
+   * releases it by the destructor.  The user can access the region freely while the zone object
+   * is alive.  The zone object doesn't allocate memory by itself so that it can be put on the
+   * stack.  Usually, the protection is done by entering an epoch without any lock.  A shared lock
+   * is taken only while the mapping is being remapped or all epoch slots are occupied.
    */
   class Zone {
     friend class MemoryMapParallelFile;
    public:
+    /**
+     * Constructor.
+     * @param file The file object.
+     * @param writable If true, the region is for reading and writing.  If false, the region is
+     * only for reading.
+     * @param off The offset of the region to access.
+     * @param size The size of the region to access.
+     * @param status The pointer to a status object to contain the result status.
+     * @details The semantics of the parameters are the same as MakeZone.  If the status is not
+     * success, the zone must not be accessed.
+     */
+    explicit Zone(
+        MemoryMapParallelFile* file, bool writable, int64_t off, size_t size, Status* status);
+
     /**
      * Destuctor.
      */
@@ -74,18 +90,18 @@ class MemoryMapParallelFile final : public File {
     size_t Size() const;
 
    private:
-    /**
-     * Constructor.
-     * @param file_impl The file implementation object.
-     * @param writable Whether the zone is writable.
-     * @param off The offset of a region.
-     * @param size The size of the data to be read.
-     */
-    explicit Zone(
-        MemoryMapParallelFileImpl* file_impl, bool writable,
-        int64_t off, size_t size, Status* status);
-
-    MemoryMapParallelFileZoneImpl* impl_;
+    /** The file implementation object, or nullptr if nothing is protected. */
+    MemoryMapParallelFileImpl* file_impl_;
+    /** The pointer to the region. */
+    char* ptr_;
+    /** The offset of the region. */
+    int64_t off_;
+    /** The size of the region. */
+    size_t size_;
+    /** The index of the epoch slot, or -1 if the shared lock is taken. */
+    int32_t epoch_slot_;
+    /** Whether the region is writable. */
+    bool writable_;
   };
 
   /**
@@ -132,7 +148,8 @@ class MemoryMapParallelFile final : public File {
    * @details If the writable flag is true and the region is out of the current file size, the file
    * is expanded.  If the writable flag is true and the offset is negative, the offset is set at
    * the end of the file.  If the writable flag is false and the region is out of the current file
-   * size, the size of the region is fitted to the file size or the operation fails.
+   * size, the size of the region is fitted to the file size or the operation fails.  To avoid
+   * allocation, the zone object can be constructed directly on the stack instead.
    */
   Status MakeZone(bool writable, int64_t off, size_t size, std::unique_ptr<Zone>* zone);
 
@@ -172,6 +189,36 @@ class MemoryMapParallelFile final : public File {
    */
   Status Append(const void* buf, size_t size, int64_t* off = nullptr) override;
 
+  /**
+   * Reads data of multiple regions.
+   * @param extents The pointer to the array of the extents.
+   * @param num_extents The number of the extents.
+   * @return The result status.
+   * @details All extents are read through a single zone which spans them.
+   */
+  Status ReadV(const ReadExtent* extents, size_t num_extents) override;
+
+  /**
+   * Writes data of multiple regions.
+   * @param extents The pointer to the array of the extents.
+   * @param num_extents The number of the extents.
+   * @return The result status.
+   * @details All extents are written through a single zone which spans them.
+   */
+  Status WriteV(const WriteExtent* extents, size_t num_extents) override;
+
+  /**
+   * Appends data of multiple pieces at the end of the file.
+   * @param pieces The pointer to the array of the pieces, which are put contiguously.
+   * @param num_pieces The number of the pieces.
+   * @param off The pointer to an integer object to contain the offset at which the first piece
+   * has been put.  If it is nullptr, it is ignored.
+   * @return The result status.
+   * @details The pieces are copied into a single zone at the end of the file.
+   */
+  Status AppendV(const std::string_view* pieces, size_t num_pieces,
+                 int64_t* off = nullptr) override;
+
   /**
    * Expands the file size without writing data.
    * @param inc_size The size to increment the file size by.
@@ -199,6 +246,28 @@ class MemoryMapParallelFile final : public File {
    */
   Status Synchronize(bool hard) override;
 
+  /**
+   * Synchronizes the content of a region of the file with the hardware.
+   * @param off The offset of the region.
+   * @param size The size of the region.  If it is negative, the region extends to the end of the
+   * file.
+   * @return The result status.
+   * @details Modified parts in the region are written back by "sync_file_range" on Linux or "msync"
+   * on other systems, and then the data is synchronized by "fdatasync".  "fsync" is used instead
+   * only if the file size has changed since the last synchronization.
+   */
+  Status SynchronizeRange(int64_t off, int64_t size) override;
+
+  /**
+   * Releases storage blocks of a region of the file.
+   * @param off The offset of the region.
+   * @param size The size of the region.
+   * @return The result status.
+   * @details The file size is not changed and the region is read as zeros afterward.  Only
+   * blocks which are wholly inside the region are released.
+   */
+  Status PunchHole(int64_t off, int64_t size) override;
+
   /**
    * Gets the size of the file.
    * @param size The pointer to an integer object to contain the result size.
@@ -216,6 +285,18 @@ class MemoryMapParallelFile final : public File {
    */
   Status SetAllocationStrategy(int64_t init_size, double inc_factor) override;
 
+  /**
+   * Gives advice about the access pattern of a region.
+   * @param off The offset of the region.
+   * @param size The size of the region.  If it is negative, the region extends to the end of the
+   * file.
+   * @param advice The advice about the access pattern.
+   * @return The result status.
+   * @details The advice is given to the mapping by "madvise".  NORMAL, RANDOM, SEQUENTIAL,
+   * and HUGEPAGE are remembered and applied again when the mapping is expanded.
+   */
+  Status Advise(int64_t off, int64_t size, AccessAdvice advice) override;
+
   /**
    * Locks the memory of the beginning region of the file, not to be swapped out.
    * @param size The size of the beginning region to lock.
@@ -224,6 +305,20 @@ class MemoryMapParallelFile final : public File {
    */
   Status LockMemory(size_t size);
 
+  /**
+   * Sets the size of the virtual address space reserved for the mapping.
+   * @param size The size of the reserved space.  0 means no reservation.
+   * @return The result status.
+   * @details By default, no space is reserved and the mapping is expanded by "mremap", which can
+   * move the mapping and blocks all readers and writers meanwhile.  If the reserved size is
+   * positive, the space of the size is reserved without committing memory when the file is
+   * opened as writable, and the mapping is expanded in place within it.  Then, the base address
+   * doesn't change and readers are not blocked while the file grows.  Only when the file
+   * exceeds the reserved space, the whole mapping is relocated into a larger space.  This
+   * method must be called before the file is opened.
+   */
+  Status SetReservedSize(int64_t size);
+
   /**
    * Checks whether operations are done by memory mapping.
    * @return True if operations are done by memory mapping, or false if not.
@@ -400,6 +495,36 @@ class MemoryMapAtomicFile final : public File {
    */
   Status Append(const void* buf, size_t size, int64_t* off = nullptr) override;
 
+  /**
+   * Reads data of multiple regions.
+   * @param extents The pointer to the array of the extents.
+   * @param num_extents The number of the extents.
+   * @return The result status.
+   * @details All extents are read through a single zone which spans them.
+   */
+  Status ReadV(const ReadExtent* extents, size_t num_extents) override;
+
+  /**
+   * Writes data of multiple regions.
+   * @param extents The pointer to the array of the extents.
+   * @param num_extents The number of the extents.
+   * @return The result status.
+   * @details All extents are written through a single zone which spans them.
+   */
+  Status WriteV(const WriteExtent* extents, size_t num_extents) override;
+
+  /**
+   * Appends data of multiple pieces at the end of the file.
+   * @param pieces The pointer to the array of the pieces, which are put contiguously.
+   * @param num_pieces The number of the pieces.
+   * @param off The pointer to an integer object to contain the offset at which the first piece
+   * has been put.  If it is nullptr, it is ignored.
+   * @return The result status.
+   * @details The pieces are copied into a single zone at the end of the file.
+   */
+  Status AppendV(const std::string_view* pieces, size_t num_pieces,
+                 int64_t* off = nullptr) override;
+
   /**
    * Expands the file size without writing data.
    * @param inc_size The size to increment the file size by.
@@ -427,6 +552,28 @@ class MemoryMapAtomicFile final : public File {
    */
   Status Synchronize(bool hard) override;
 
+  /**
+   * Synchronizes the content of a region of the file with the hardware.
+   * @param off The offset of the region.
+   * @param size The size of the region.  If it is negative, the region extends to the end of the
+   * file.
+   * @return The result status.
+   * @details Modified parts in the region are written back by "sync_file_range" on Linux or "msync"
+   * on other systems, and then the data is synchronized by "fdatasync".  "fsync" is used instead
+   * only if the file size has changed since the last synchronization.
+   */
+  Status SynchronizeRange(int64_t off, int64_t size) override;
+
+  /**
+   * Releases storage blocks of a region of the file.
+   * @param off The offset of the region.
+   * @param size The size of the region.
+   * @return The result status.
+   * @details The file size is not changed and the region is read as zeros afterward.  Only
+   * blocks which are wholly inside the region are released.
+   */
+  Status PunchHole(int64_t off, int64_t size) override;
+
   /**
    * Gets the size of the file.
    * @param size The pointer to an integer object to contain the result size.
@@ -444,6 +591,18 @@ class MemoryMapAtomicFile final : public File {
    */
   Status SetAllocationStrategy(int64_t init_size, double inc_factor) override;
 
+  /**
+   * Gives advice about the access pattern of a region.
+   * @param off The offset of the region.
+   * @param size The size of the region.  If it is negative, the region extends to the end of the
+   * file.
+   * @param advice The advice about the access pattern.
+   * @return The result status.
+   * @details The advice is given to the mapping by "madvise".  NORMAL, RANDOM, SEQUENTIAL,
+   * and HUGEPAGE are remembered and applied again when the mapping is expanded.
+   */
+  Status Advise(int64_t off, int64_t size, AccessAdvice advice) override;
+
   /**
    * Locks the memory of the beginning region of the file, not to be swapped out.
    * @param size The size of the beginning region to lock.
@@ -34,6 +34,7 @@ class MemoryMapFileTest : public CommonFileTest<FILE> {
  protected:
   void ZoneTest();
   void LockMemoryTest();
+  void AdviseTest();
 };
 
 template <class FILE>
@@ -106,6 +107,36 @@ void MemoryMapFileTest<FILE>::LockMemoryTest() {
   EXPECT_EQ(tkrzw::Status::SUCCESS, file.Close());
 }
 
+template <class FILE>
+void MemoryMapFileTest<FILE>::AdviseTest() {
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string file_path = tmp_dir.MakeUniquePath();
+  FILE file;
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.SetAllocationStrategy(4096, 1.5));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Open(file_path, true));
+  const std::string data(5000, 'a');
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Append(data.data(), data.size()));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Advise(0, -1, tkrzw::File::ADVICE_RANDOM));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Advise(4096, -1, tkrzw::File::ADVICE_SEQUENTIAL));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Advise(100, 200, tkrzw::File::ADVICE_WILLNEED));
+  file.Advise(0, 4096, tkrzw::File::ADVICE_HUGEPAGE);
+  for (int32_t i = 0; i < 100; i++) {
+    EXPECT_EQ(tkrzw::Status::SUCCESS, file.Append(data.data(), data.size()));
+  }
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Advise(0, -1, tkrzw::File::ADVICE_DONTNEED));
+  file.Advise(4096, 8192, tkrzw::File::ADVICE_COLD);
+  EXPECT_EQ(data, file.ReadSimple(0, data.size()));
+  EXPECT_EQ(data, file.ReadSimple(100 * data.size(), data.size()));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Truncate(3000));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Advise(0, -1, tkrzw::File::ADVICE_NORMAL));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Write(100000, "z", 1));
+  EXPECT_EQ(data.substr(0, 3000), file.ReadSimple(0, 3000));
+  EXPECT_EQ("z", file.ReadSimple(100000, 1));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Close());
+  EXPECT_EQ(tkrzw::Status::PRECONDITION_ERROR,
+            file.Advise(0, -1, tkrzw::File::ADVICE_RANDOM));
+}
+
 class MemoryMapParallelFileTest : public MemoryMapFileTest<tkrzw::MemoryMapParallelFile> {};
 
 TEST_F(MemoryMapParallelFileTest, Attributes) {
@@ -154,6 +185,26 @@ TEST_F(MemoryMapParallelFileTest, FlatRecord) {
   FlatRecordTest();
 }
 
+TEST_F(MemoryMapParallelFileTest, VectorIO) {
+  VectorIOTest();
+}
+
+TEST_F(MemoryMapParallelFileTest, AsyncRead) {
+  AsyncReadTest();
+}
+
+TEST_F(MemoryMapParallelFileTest, SynchronizeRange) {
+  SynchronizeRangeTest();
+}
+
+TEST_F(MemoryMapParallelFileTest, Allocation) {
+  AllocationTest();
+}
+
+TEST_F(MemoryMapParallelFileTest, AppendBuffer) {
+  AppendBufferTest();
+}
+
 TEST_F(MemoryMapParallelFileTest, Zone) {
   ZoneTest();
 }
@@ -162,6 +213,126 @@ TEST_F(MemoryMapParallelFileTest, LockMemory) {
   LockMemoryTest();
 }
 
+TEST_F(MemoryMapParallelFileTest, Advise) {
+  AdviseTest();
+}
+
+TEST_F(MemoryMapParallelFileTest, StackZoneAndRemap) {
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string file_path = tmp_dir.MakeUniquePath();
+  tkrzw::MemoryMapParallelFile file;
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.SetAllocationStrategy(1, 1.2));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Open(file_path, true));
+  {
+    tkrzw::Status status(tkrzw::Status::SUCCESS);
+    tkrzw::MemoryMapParallelFile::Zone zone(&file, true, 0, 8, &status);
+    ASSERT_EQ(tkrzw::Status::SUCCESS, status);
+    std::memcpy(zone.Pointer(), "01234567", 8);
+  }
+  {
+    tkrzw::Status status(tkrzw::Status::SUCCESS);
+    tkrzw::MemoryMapParallelFile::Zone zone(&file, false, 4, 8, &status);
+    ASSERT_EQ(tkrzw::Status::SUCCESS, status);
+    EXPECT_EQ(4, zone.Offset());
+    EXPECT_EQ("4567", std::string(zone.Pointer(), zone.Size()));
+  }
+  {
+    tkrzw::Status status(tkrzw::Status::SUCCESS);
+    tkrzw::MemoryMapParallelFile::Zone zone(&file, false, 9, 1, &status);
+    EXPECT_EQ(tkrzw::Status::INFEASIBLE_ERROR, status);
+  }
+  constexpr int32_t num_appends = 5000;
+  std::atomic_int64_t tail(8);
+  auto appender = [&]() {
+    for (int32_t i = 0; i < num_appends; i++) {
+      const std::string value = tkrzw::SPrintF("%08d", i);
+      int64_t off = 0;
+      EXPECT_EQ(tkrzw::Status::SUCCESS, file.Append(value.data(), value.size(), &off));
+      EXPECT_EQ(8 + i * 8, off);
+      tail.store(off + 8);
+    }
+  };
+  auto reader = [&]() {
+    char buf[8];
+    while (tail.load() < 8 + num_appends * 8) {
+      const int64_t end = tail.load();
+      const int64_t off = end - 8;
+      EXPECT_EQ(tkrzw::Status::SUCCESS, file.Read(off, buf, 8));
+      if (off > 0) {
+        EXPECT_EQ(tkrzw::SPrintF("%08d", static_cast<int32_t>(off / 8 - 1)),
+                  std::string(buf, 8));
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  threads.emplace_back(std::thread(appender));
+  for (int32_t i = 0; i < 3; i++) {
+    threads.emplace_back(std::thread(reader));
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  int64_t size = 0;
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.GetSize(&size));
+  EXPECT_EQ(8 + num_appends * 8, size);
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Close());
+}
+
+TEST_F(MemoryMapParallelFileTest, ReservedSpace) {
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string file_path = tmp_dir.MakeUniquePath();
+  tkrzw::MemoryMapParallelFile file;
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.SetAllocationStrategy(4096, 2));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.SetReservedSize(1 << 20));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Open(file_path, true));
+  EXPECT_EQ(tkrzw::Status::PRECONDITION_ERROR, file.SetReservedSize(1 << 21));
+  auto get_base = [&]() {
+    tkrzw::Status status(tkrzw::Status::SUCCESS);
+    tkrzw::MemoryMapParallelFile::Zone zone(&file, false, 0, 1, &status);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, status);
+    return zone.Pointer();
+  };
+  const std::string data(1000, 'x');
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Append(data.data(), data.size()));
+  const char* base = get_base();
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Advise(4096, -1, tkrzw::File::ADVICE_RANDOM));
+  std::vector<std::thread> threads;
+  for (int32_t i = 0; i < 4; i++) {
+    threads.emplace_back([&]() {
+      char buf[1000];
+      for (int32_t j = 0; j < 200; j++) {
+        EXPECT_EQ(tkrzw::Status::SUCCESS, file.Append(data.data(), data.size()));
+        EXPECT_EQ(tkrzw::Status::SUCCESS, file.Read(0, buf, sizeof(buf)));
+        EXPECT_EQ(data, std::string(buf, sizeof(buf)));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  int64_t size = 0;
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.GetSize(&size));
+  EXPECT_EQ(801000, size);
+  EXPECT_EQ(base, get_base());
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Synchronize(false));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Truncate(5000));
+  EXPECT_EQ(base, get_base());
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Write(4000, "abcd", 4));
+  for (int32_t i = 0; i < 2000; i++) {
+    EXPECT_EQ(tkrzw::Status::SUCCESS, file.Append(data.data(), data.size()));
+  }
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.GetSize(&size));
+  EXPECT_EQ(2005000, size);
+  EXPECT_EQ("abcd", file.ReadSimple(4000, 4));
+  EXPECT_EQ(data, file.ReadSimple(2004000, 1000));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Truncate(10));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Write(10, "efgh", 4));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Close());
+  std::string content;
+  EXPECT_EQ(tkrzw::Status::SUCCESS, tkrzw::ReadFile(file_path, &content));
+  EXPECT_EQ(data.substr(0, 10) + "efgh", content);
+}
+
 class MemoryMapAtomicFileTest : public MemoryMapFileTest<tkrzw::MemoryMapAtomicFile> {};
 
 TEST_F(MemoryMapAtomicFileTest, Attributes) {
@@ -210,6 +381,26 @@ TEST_F(MemoryMapAtomicFileTest, FlatRecord) {
   FlatRecordTest();
 }
 
+TEST_F(MemoryMapAtomicFileTest, VectorIO) {
+  VectorIOTest();
+}
+
+TEST_F(MemoryMapAtomicFileTest, AsyncRead) {
+  AsyncReadTest();
+}
+
+TEST_F(MemoryMapAtomicFileTest, SynchronizeRange) {
+  SynchronizeRangeTest();
+}
+
+TEST_F(MemoryMapAtomicFileTest, Allocation) {
+  AllocationTest();
+}
+
+TEST_F(MemoryMapAtomicFileTest, AppendBuffer) {
+  AppendBufferTest();
+}
+
 TEST_F(MemoryMapAtomicFileTest, Zone) {
   ZoneTest();
 }
@@ -218,4 +409,8 @@ TEST_F(MemoryMapAtomicFileTest, LockMemory) {
   LockMemoryTest();
 }
 
+TEST_F(MemoryMapAtomicFileTest, Advise) {
+  AdviseTest();
+}
+
 // END OF FILE
@@ -21,6 +21,390 @@
 
 namespace tkrzw {
 
+static Status AdviseFile(int32_t fd, int64_t off, int64_t size, File::AccessAdvice advice) {
+  int32_t fadv = -1;
+  switch (advice) {
+    case File::ADVICE_NORMAL:
+      fadv = POSIX_FADV_NORMAL;
+      break;
+    case File::ADVICE_RANDOM:
+      fadv = POSIX_FADV_RANDOM;
+      break;
+    case File::ADVICE_SEQUENTIAL:
+      fadv = POSIX_FADV_SEQUENTIAL;
+      break;
+    case File::ADVICE_WILLNEED:
+      fadv = POSIX_FADV_WILLNEED;
+      break;
+    case File::ADVICE_DONTNEED:
+      fadv = POSIX_FADV_DONTNEED;
+      break;
+    default:
+      break;
+  }
+  if (fadv < 0) {
+    return Status(Status::SUCCESS);
+  }
+  const int32_t rv = posix_fadvise(fd, off, size < 0 ? 0 : size, fadv);
+  if (rv != 0) {
+    return GetErrnoStatus("posix_fadvise", rv);
+  }
+  return Status(Status::SUCCESS);
+}
+
+constexpr int32_t MAX_IO_VECTORS = 64;
+
+static Status PReadVectors(int32_t fd, struct iovec* iovs, int32_t num_iovs, int64_t off) {
+  while (num_iovs > 0) {
+    const ssize_t rsiz = preadv(fd, iovs, num_iovs, off);
+    if (rsiz < 0) {
+      return GetErrnoStatus("preadv", errno);
+    }
+    size_t rest = rsiz;
+    while (num_iovs > 0 && rest >= iovs->iov_len) {
+      rest -= iovs->iov_len;
+      iovs++;
+      num_iovs--;
+    }
+    if (num_iovs > 0) {
+      if (rsiz == 0) {
+        return Status(Status::INFEASIBLE_ERROR, "excessive region");
+      }
+      iovs->iov_base = static_cast<char*>(iovs->iov_base) + rest;
+      iovs->iov_len -= rest;
+    }
+    off += rsiz;
+  }
+  return Status(Status::SUCCESS);
+}
+
+static Status PWriteVectors(int32_t fd, struct iovec* iovs, int32_t num_iovs, int64_t off) {
+  while (num_iovs > 0) {
+    const ssize_t wsiz = pwritev(fd, iovs, num_iovs, off);
+    if (wsiz < 0) {
+      return GetErrnoStatus("pwritev", errno);
+    }
+    size_t rest = wsiz;
+    while (num_iovs > 0 && rest >= iovs->iov_len) {
+      rest -= iovs->iov_len;
+      iovs++;
+      num_iovs--;
+    }
+    if (num_iovs > 0) {
+      iovs->iov_base = static_cast<char*>(iovs->iov_base) + rest;
+      iovs->iov_len -= rest;
+    }
+    off += wsiz;
+  }
+  return Status(Status::SUCCESS);
+}
+
+static Status ReadExtents(int32_t fd, const File::ReadExtent* extents, size_t num_extents) {
+  struct iovec iovs[MAX_IO_VECTORS];
+  size_t index = 0;
+  while (index < num_extents) {
+    const int64_t off = extents[index].off;
+    int64_t end = off;
+    int32_t num_iovs = 0;
+    while (index < num_extents && num_iovs < MAX_IO_VECTORS && extents[index].off == end) {
+      iovs[num_iovs].iov_base = extents[index].buf;
+      iovs[num_iovs].iov_len = extents[index].size;
+      end += extents[index].size;
+      num_iovs++;
+      index++;
+    }
+    const Status status = PReadVectors(fd, iovs, num_iovs, off);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+  }
+  return Status(Status::SUCCESS);
+}
+
+static Status WriteExtents(int32_t fd, const File::WriteExtent* extents, size_t num_extents) {
+  struct iovec iovs[MAX_IO_VECTORS];
+  size_t index = 0;
+  while (index < num_extents) {
+    const int64_t off = extents[index].off;
+    int64_t end = off;
+    int32_t num_iovs = 0;
+    while (index < num_extents && num_iovs < MAX_IO_VECTORS && extents[index].off == end) {
+      iovs[num_iovs].iov_base = const_cast<void*>(extents[index].buf);
+      iovs[num_iovs].iov_len = extents[index].size;
+      end += extents[index].size;
+      num_iovs++;
+      index++;
+    }
+    const Status status = PWriteVectors(fd, iovs, num_iovs, off);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+  }
+  return Status(Status::SUCCESS);
+}
+
+static Status WritePieces(
+    int32_t fd, const std::string_view* pieces, size_t num_pieces, int64_t off) {
+  struct iovec iovs[MAX_IO_VECTORS];
+  size_t index = 0;
+  while (index < num_pieces) {
+    const int64_t batch_off = off;
+    int32_t num_iovs = 0;
+    while (index < num_pieces && num_iovs < MAX_IO_VECTORS) {
+      iovs[num_iovs].iov_base = const_cast<char*>(pieces[index].data());
+      iovs[num_iovs].iov_len = pieces[index].size();
+      off += pieces[index].size();
+      num_iovs++;
+      index++;
+    }
+    const Status status = PWriteVectors(fd, iovs, num_iovs, batch_off);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+  }
+  return Status(Status::SUCCESS);
+}
+
+// Flushes modified regions and then synchronizes the data of the file with the device.
+static Status SynchronizeRanges(
+    int32_t fd, const std::vector<DirtyRangeSet::Range>& ranges, bool metadata) {
+  Status status(Status::SUCCESS);
+#if defined(_SYS_LINUX_)
+  for (const auto& range : ranges) {
+    if (sync_file_range(fd, range.first, range.second, SYNC_FILE_RANGE_WRITE) != 0) {
+      status |= GetErrnoStatus("sync_file_range", errno);
+      break;
+    }
+  }
+  if (!metadata) {
+    if (fdatasync(fd) != 0) {
+      status |= GetErrnoStatus("fdatasync", errno);
+    }
+    return status;
+  }
+#endif
+  if (fsync(fd) != 0) {
+    status |= GetErrnoStatus("fsync", errno);
+  }
+  return status;
+}
+
+static Status PReadFully(int32_t fd, void* buf, size_t size, int64_t off) {
+  char* wp = static_cast<char*>(buf);
+  while (size > 0) {
+    const int32_t rsiz = pread(fd, wp, size, off);
+    if (rsiz < 0) {
+      return GetErrnoStatus("pread", errno);
+    }
+    if (rsiz == 0) {
+      return Status(Status::INFEASIBLE_ERROR, "excessive region");
+    }
+    off += rsiz;
+    wp += rsiz;
+    size -= rsiz;
+  }
+  return Status(Status::SUCCESS);
+}
+
+// Buffer to coalesce appended data into a large write.
+class AppendBuffer final {
+ public:
+  AppendBuffer()
+      : capacity_(0), max_delay_(0), off_(0), time_(0), deadline_(0), flushed_end_(INT64MAX) {}
+
+  void SetCapacity(int64_t capacity, double max_delay) {
+    capacity_ = std::max<int64_t>(capacity, 0);
+    max_delay_ = max_delay;
+  }
+
+  int64_t GetCapacity() const {
+    return capacity_;
+  }
+
+  double GetMaxDelay() const {
+    return max_delay_;
+  }
+
+  // Checks whether a region can overlap buffered data, without locking.
+  bool MayOverlap(int64_t off, int64_t size) const {
+    return off + size > flushed_end_.load();
+  }
+
+  template <typename EXTENT>
+  bool MayOverlap(const EXTENT* extents, size_t num_extents) const {
+    for (size_t i = 0; i < num_extents; i++) {
+      if (MayOverlap(extents[i].off, extents[i].size)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Checks whether buffered data have waited longer than the maximum delay, without locking.
+  bool IsExpired() const {
+    return flushed_end_.load() != INT64MAX && GetWallTime() > deadline_.load();
+  }
+
+  std::mutex& GetMutex() {
+    return mutex_;
+  }
+
+  // The methods below must be called while the buffer is locked.
+
+  bool Contains(int64_t off, int64_t size) const {
+    return !data_.empty() && off >= off_ &&
+        off + size <= off_ + static_cast<int64_t>(data_.size());
+  }
+
+  bool Contains(const File::WriteExtent* extents, size_t num_extents) const {
+    for (size_t i = 0; i < num_extents; i++) {
+      if (!Contains(extents[i].off, extents[i].size)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool CanAdd(int64_t position, int64_t size) const {
+    if (data_.empty()) {
+      return true;
+    }
+    return position == off_ + static_cast<int64_t>(data_.size()) &&
+        static_cast<int64_t>(data_.size()) + size <= capacity_ &&
+        GetWallTime() - time_ <= max_delay_;
+  }
+
+  void Add(int64_t position, const std::string_view* pieces, size_t num_pieces) {
+    if (data_.empty()) {
+      off_ = position;
+      time_ = GetWallTime();
+      deadline_.store(time_ + max_delay_);
+      flushed_end_.store(position);
+    }
+    for (size_t i = 0; i < num_pieces; i++) {
+      data_.append(pieces[i]);
+    }
+  }
+
+  void Patch(int64_t off, const void* buf, size_t size) {
+    std::memcpy(data_.data() + off - off_, buf, size);
+  }
+
+  void Overlay(int64_t off, void* buf, size_t size) const {
+    const int64_t start = std::max(off, off_);
+    const int64_t end = std::min<int64_t>(off + size, off_ + data_.size());
+    if (!data_.empty() && start < end) {
+      std::memcpy(static_cast<char*>(buf) + start - off, data_.data() + start - off_, end - start);
+    }
+  }
+
+  Status Flush(int32_t fd, DirtyRangeSet* dirty_ranges) {
+    if (data_.empty()) {
+      return Status(Status::SUCCESS);
+    }
+    struct iovec iov;
+    iov.iov_base = data_.data();
+    iov.iov_len = data_.size();
+    const Status status = PWriteVectors(fd, &iov, 1, off_);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+    dirty_ranges->Add(off_, data_.size());
+    data_.clear();
+    flushed_end_.store(INT64MAX);
+    return Status(Status::SUCCESS);
+  }
+
+  void Clear() {
+    data_.clear();
+    flushed_end_.store(INT64MAX);
+  }
+
+ private:
+  int64_t capacity_;
+  double max_delay_;
+  std::string data_;
+  int64_t off_;
+  double time_;
+  std::atomic<double> deadline_;
+  std::atomic_int64_t flushed_end_;
+  std::mutex mutex_;
+};
+
+// Background thread to flush append buffers of idle files.
+class AppendBufferFlusher final {
+ public:
+  static AppendBufferFlusher* GetInstance() {
+    // The instance is never destroyed so that files closed at exit can unregister.
+    static AppendBufferFlusher* instance = new AppendBufferFlusher();
+    return instance;
+  }
+
+  void Register(const void* file, double interval, std::function<void()> flush) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_[file] = Entry{std::max(interval, MIN_INTERVAL), std::move(flush)};
+    if (!running_) {
+      std::thread(&AppendBufferFlusher::Run, this).detach();
+      running_ = true;
+    }
+    cond_.notify_one();
+  }
+
+  // Returns after the flush function of the file finishes if it is running.
+  void Unregister(const void* file) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    entries_.erase(file);
+    done_cond_.wait(lock, [&]() { return active_ != file; });
+  }
+
+ private:
+  struct Entry {
+    double interval;
+    std::function<void()> flush;
+  };
+  static constexpr double MIN_INTERVAL = 0.01;
+
+  void Run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::vector<const void*> files;
+    while (true) {
+      if (entries_.empty()) {
+        cond_.wait(lock);
+        continue;
+      }
+      double interval = entries_.begin()->second.interval;
+      for (const auto& entry : entries_) {
+        interval = std::min(interval, entry.second.interval);
+      }
+      cond_.wait_for(lock, std::chrono::microseconds(static_cast<int64_t>(interval * 1000000)));
+      files.clear();
+      for (const auto& entry : entries_) {
+        files.emplace_back(entry.first);
+      }
+      for (const void* file : files) {
+        const auto it = entries_.find(file);
+        if (it == entries_.end()) {
+          continue;
+        }
+        const std::function<void()> flush = it->second.flush;
+        active_ = file;
+        lock.unlock();
+        flush();
+        lock.lock();
+        active_ = nullptr;
+        done_cond_.notify_all();
+      }
+    }
+  }
+
+  std::map<const void*, Entry> entries_;
+  const void* active_ = nullptr;
+  bool running_ = false;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::condition_variable done_cond_;
+};
+
 class PositionalParallelFileImpl final {
  public:
   PositionalParallelFileImpl();
@@ -30,13 +414,23 @@ class PositionalParallelFileImpl final {
   Status Read(int64_t off, void* buf, size_t size);
   Status Write(int64_t off, const void* buf, size_t size);
   Status Append(const void* buf, size_t size, int64_t* off);
+  Status ReadV(const File::ReadExtent* extents, size_t num_extents);
+  Status WriteV(const File::WriteExtent* extents, size_t num_extents);
+  Status AppendV(const std::string_view* pieces, size_t num_pieces, int64_t* off);
   Status Truncate(int64_t size);
   Status Synchronize(bool hard);
+  Status SynchronizeRange(int64_t off, int64_t size);
+  Status PunchHole(int64_t off, int64_t size);
   Status GetSize(int64_t* size);
   Status SetAllocationStrategy(int64_t init_size, double inc_factor);
+  Status Advise(int64_t off, int64_t size, File::AccessAdvice advice);
+  Status SetAppendBuffer(int64_t size, double max_delay);
 
  private:
   Status AdjustTruncSize(int64_t min_size);
+  Status AppendBuffered(const std::string_view* pieces, size_t num_pieces, int64_t* off);
+  Status FlushExpiredAppendBuffer();
+  void StartBackgroundFlush(double max_delay);
 
   int32_t fd_;
   std::atomic_int64_t file_size_;
@@ -45,18 +439,22 @@ class PositionalParallelFileImpl final {
   int32_t open_options_;
   int64_t alloc_init_size_;
   double alloc_inc_factor_;
+  DirtyRangeSet dirty_ranges_;
+  std::atomic_int64_t synced_size_;
+  AppendBuffer append_buf_;
   std::mutex mutex_;
 };
 
 PositionalParallelFileImpl::PositionalParallelFileImpl()
     : fd_(-1), file_size_(0), trunc_size_(0), writable_(false), open_options_(0),
       alloc_init_size_(File::DEFAULT_ALLOC_INIT_SIZE),
-      alloc_inc_factor_(File::DEFAULT_ALLOC_INC_FACTOR) {}
+      alloc_inc_factor_(File::DEFAULT_ALLOC_INC_FACTOR), synced_size_(-1) {}
 
 PositionalParallelFileImpl::~PositionalParallelFileImpl() {
   if (fd_ >= 0) {
     Close();
   }
+  AppendBufferFlusher::GetInstance()->Unregister(this);
 }
 
 Status PositionalParallelFileImpl::Open(const std::string& path, bool writable, int32_t options) {
@@ -127,6 +525,13 @@ Status PositionalParallelFileImpl::Open(const std::string& path, bool writable,
       close(fd);
       return status;
     }
+    if (options & File::OPEN_PREALLOCATE) {
+      const Status status = AllocateFileSpace(fd, file_size, trunc_size - file_size, false);
+      if (status != Status::SUCCESS) {
+        close(fd);
+        return status;
+      }
+    }
   }
 
   // Updates the internal data.
@@ -135,6 +540,9 @@ Status PositionalParallelFileImpl::Open(const std::string& path, bool writable,
   trunc_size_.store(trunc_size);
   writable_ = writable;
   open_options_ = options;
+  if (writable && append_buf_.GetCapacity() > 0) {
+    StartBackgroundFlush(append_buf_.GetMaxDelay());
+  }
 
   return Status(Status::SUCCESS);
 }
@@ -143,8 +551,16 @@ Status PositionalParallelFileImpl::Close() {
   if (fd_ < 0) {
     return Status(Status::PRECONDITION_ERROR, "not opened file");
   }
+  AppendBufferFlusher::GetInstance()->Unregister(this);
   Status status(Status::SUCCESS);
 
+  // Writes the buffered data.
+  {
+    std::lock_guard<std::mutex> lock(append_buf_.GetMutex());
+    status |= append_buf_.Flush(fd_, &dirty_ranges_);
+    append_buf_.Clear();
+  }
+
   // Truncates the file.
   if (writable_ && ftruncate(fd_, file_size_.load()) != 0) {
     status |= GetErrnoStatus("ftruncate", errno);
@@ -175,6 +591,8 @@ Status PositionalParallelFileImpl::Close() {
   trunc_size_.store(0);
   writable_ = false;
   open_options_ = 0;
+  dirty_ranges_.Clear();
+  synced_size_ = -1;
 
   return status;
 }
@@ -183,20 +601,19 @@ Status PositionalParallelFileImpl::Read(int64_t off, void* buf, size_t size) {
   if (fd_ < 0) {
     return Status(Status::PRECONDITION_ERROR, "not opened file");
   }
-  char* wp = static_cast<char*>(buf);
-  while (size > 0) {
-    const int32_t rsiz = pread(fd_, wp, size, off);
-    if (rsiz < 0) {
-      return GetErrnoStatus("pread", errno);
-    }
-    if (rsiz == 0) {
-      return Status(Status::INFEASIBLE_ERROR, "excessive region");
+  const Status flush_status = FlushExpiredAppendBuffer();
+  if (flush_status != Status::SUCCESS) {
+    return flush_status;
+  }
+  if (append_buf_.MayOverlap(off, size)) {
+    std::lock_guard<std::mutex> lock(append_buf_.GetMutex());
+    const Status status = PReadFully(fd_, buf, size, off);
+    if (status == Status::SUCCESS) {
+      append_buf_.Overlay(off, buf, size);
     }
-    off += rsiz;
-    wp += rsiz;
-    size -= rsiz;
+    return status;
   }
-  return Status(Status::SUCCESS);
+  return PReadFully(fd_, buf, size, off);
 }
 
 Status PositionalParallelFileImpl::Write(int64_t off, const void* buf, size_t size) {
@@ -206,6 +623,22 @@ Status PositionalParallelFileImpl::Write(int64_t off, const void* buf, size_t si
   if (!writable_) {
     return Status(Status::PRECONDITION_ERROR, "not writable file");
   }
+  const Status flush_status = FlushExpiredAppendBuffer();
+  if (flush_status != Status::SUCCESS) {
+    return flush_status;
+  }
+  std::unique_lock<std::mutex> buf_lock(append_buf_.GetMutex(), std::defer_lock);
+  if (append_buf_.MayOverlap(off, size)) {
+    buf_lock.lock();
+    if (append_buf_.Contains(off, size)) {
+      append_buf_.Patch(off, buf, size);
+      return Status(Status::SUCCESS);
+    }
+    const Status status = append_buf_.Flush(fd_, &dirty_ranges_);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+  }
   const int64_t end_position = off + size;
   const Status status = AdjustTruncSize(end_position);
   if (status != Status::SUCCESS) {
@@ -218,6 +651,8 @@ Status PositionalParallelFileImpl::Write(int64_t off, const void* buf, size_t si
       break;
     }
   }
+  const int64_t dirty_off = off;
+  const int64_t dirty_size = size;
   const char* rp = static_cast<const char*>(buf);
   while (size > 0) {
     const int32_t rsiz = pwrite(fd_, rp, size, off);
@@ -228,6 +663,7 @@ Status PositionalParallelFileImpl::Write(int64_t off, const void* buf, size_t si
     rp += rsiz;
     size -= rsiz;
   }
+  dirty_ranges_.Add(dirty_off, dirty_size);
   return Status(Status::SUCCESS);
 }
 
@@ -238,6 +674,10 @@ Status PositionalParallelFileImpl::Append(const void* buf, size_t size, int64_t*
   if (!writable_) {
     return Status(Status::PRECONDITION_ERROR, "not writable file");
   }
+  if (buf != nullptr && append_buf_.GetCapacity() > 0) {
+    const std::string_view piece(static_cast<const char*>(buf), size);
+    return AppendBuffered(&piece, 1, off);
+  }
   int64_t position = 0;
   while (true) {
     position = file_size_.load();
@@ -254,6 +694,8 @@ Status PositionalParallelFileImpl::Append(const void* buf, size_t size, int64_t*
     *off = position;
   }
   if (buf != nullptr) {
+    const int64_t dirty_off = position;
+    const int64_t dirty_size = size;
     const char* rp = static_cast<const char*>(buf);
     while (size > 0) {
       const int32_t rsiz = pwrite(fd_, rp, size, position);
@@ -264,7 +706,118 @@ Status PositionalParallelFileImpl::Append(const void* buf, size_t size, int64_t*
       rp += rsiz;
       size -= rsiz;
     }
+    dirty_ranges_.Add(dirty_off, dirty_size);
+  }
+  return Status(Status::SUCCESS);
+}
+
+Status PositionalParallelFileImpl::ReadV(const File::ReadExtent* extents, size_t num_extents) {
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  const Status flush_status = FlushExpiredAppendBuffer();
+  if (flush_status != Status::SUCCESS) {
+    return flush_status;
+  }
+  if (append_buf_.MayOverlap(extents, num_extents)) {
+    std::lock_guard<std::mutex> lock(append_buf_.GetMutex());
+    const Status status = ReadExtents(fd_, extents, num_extents);
+    if (status == Status::SUCCESS) {
+      for (size_t i = 0; i < num_extents; i++) {
+        append_buf_.Overlay(extents[i].off, extents[i].buf, extents[i].size);
+      }
+    }
+    return status;
+  }
+  return ReadExtents(fd_, extents, num_extents);
+}
+
+Status PositionalParallelFileImpl::WriteV(
+    const File::WriteExtent* extents, size_t num_extents) {
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  if (!writable_) {
+    return Status(Status::PRECONDITION_ERROR, "not writable file");
+  }
+  const Status flush_status = FlushExpiredAppendBuffer();
+  if (flush_status != Status::SUCCESS) {
+    return flush_status;
+  }
+  std::unique_lock<std::mutex> buf_lock(append_buf_.GetMutex(), std::defer_lock);
+  if (append_buf_.MayOverlap(extents, num_extents)) {
+    buf_lock.lock();
+    if (append_buf_.Contains(extents, num_extents)) {
+      for (size_t i = 0; i < num_extents; i++) {
+        append_buf_.Patch(extents[i].off, extents[i].buf, extents[i].size);
+      }
+      return Status(Status::SUCCESS);
+    }
+    const Status status = append_buf_.Flush(fd_, &dirty_ranges_);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+  }
+  int64_t end_position = 0;
+  for (size_t i = 0; i < num_extents; i++) {
+    end_position = std::max<int64_t>(end_position, extents[i].off + extents[i].size);
+  }
+  const Status status = AdjustTruncSize(end_position);
+  if (status != Status::SUCCESS) {
+    return status;
+  }
+  while (true) {
+    int64_t old_file_size = file_size_.load();
+    if (end_position <= old_file_size ||
+        file_size_.compare_exchange_weak(old_file_size, end_position)) {
+      break;
+    }
+  }
+  const Status write_status = WriteExtents(fd_, extents, num_extents);
+  if (write_status != Status::SUCCESS) {
+    return write_status;
+  }
+  for (size_t i = 0; i < num_extents; i++) {
+    dirty_ranges_.Add(extents[i].off, extents[i].size);
+  }
+  return Status(Status::SUCCESS);
+}
+
+Status PositionalParallelFileImpl::AppendV(
+    const std::string_view* pieces, size_t num_pieces, int64_t* off) {
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  if (!writable_) {
+    return Status(Status::PRECONDITION_ERROR, "not writable file");
+  }
+  if (append_buf_.GetCapacity() > 0) {
+    return AppendBuffered(pieces, num_pieces, off);
+  }
+  int64_t size = 0;
+  for (size_t i = 0; i < num_pieces; i++) {
+    size += pieces[i].size();
+  }
+  int64_t position = 0;
+  while (true) {
+    position = file_size_.load();
+    const int64_t end_position = position + size;
+    const Status status = AdjustTruncSize(end_position);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+    if (file_size_.compare_exchange_weak(position, end_position)) {
+      break;
+    }
   }
+  if (off != nullptr) {
+    *off = position;
+  }
+  const Status write_status = WritePieces(fd_, pieces, num_pieces, position);
+  if (write_status != Status::SUCCESS) {
+    return write_status;
+  }
+  dirty_ranges_.Add(position, size);
   return Status(Status::SUCCESS);
 }
 
@@ -275,6 +828,13 @@ Status PositionalParallelFileImpl::Truncate(int64_t size) {
   if (!writable_) {
     return Status(Status::PRECONDITION_ERROR, "not writable file");
   }
+  {
+    std::lock_guard<std::mutex> lock(append_buf_.GetMutex());
+    const Status status = append_buf_.Flush(fd_, &dirty_ranges_);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+  }
   int64_t new_trunc_size =
       std::max(std::max(size, static_cast<int64_t>(PAGE_SIZE)), alloc_init_size_);
   const int64_t diff = new_trunc_size % PAGE_SIZE;
@@ -296,21 +856,78 @@ Status PositionalParallelFileImpl::Synchronize(bool hard) {
   if (!writable_) {
     return Status(Status::PRECONDITION_ERROR, "not writable file");
   }
+  {
+    std::lock_guard<std::mutex> lock(append_buf_.GetMutex());
+    const Status status = append_buf_.Flush(fd_, &dirty_ranges_);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+  }
   Status status(Status::SUCCESS);
-  trunc_size_.store(file_size_.load());
+  const int64_t old_trunc_size = trunc_size_.exchange(file_size_.load());
   if (ftruncate(fd_, trunc_size_.load()) != 0) {
     status |= GetErrnoStatus("ftruncate", errno);
   }
-  if (hard && fsync(fd_) != 0) {
-    status |= GetErrnoStatus("fsync", errno);
+  if (open_options_ & File::OPEN_PREALLOCATE) {
+    // The blocks beyond the end are kept reserved for the data to be added later.
+    const int64_t trunc_size = trunc_size_.load();
+    status |= AllocateFileSpace(fd_, trunc_size, old_trunc_size - trunc_size, true);
+  }
+  if (hard) {
+    const int64_t trunc_size = trunc_size_.load();
+    status |= SynchronizeRanges(fd_, dirty_ranges_.Extract(), trunc_size != synced_size_.load());
+    synced_size_.store(trunc_size);
+  }
+  return status;
+}
+
+Status PositionalParallelFileImpl::SynchronizeRange(int64_t off, int64_t size) {
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  if (!writable_) {
+    return Status(Status::PRECONDITION_ERROR, "not writable file");
+  }
+  {
+    std::lock_guard<std::mutex> lock(append_buf_.GetMutex());
+    const Status status = append_buf_.Flush(fd_, &dirty_ranges_);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
   }
+  const int64_t trunc_size = trunc_size_.load();
+  const Status status =
+      SynchronizeRanges(fd_, dirty_ranges_.Extract(off, size), trunc_size != synced_size_.load());
+  synced_size_.store(trunc_size);
   return status;
 }
 
+Status PositionalParallelFileImpl::PunchHole(int64_t off, int64_t size) {
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  if (!writable_) {
+    return Status(Status::PRECONDITION_ERROR, "not writable file");
+  }
+  std::unique_lock<std::mutex> buf_lock(append_buf_.GetMutex(), std::defer_lock);
+  if (append_buf_.MayOverlap(off, size)) {
+    buf_lock.lock();
+    const Status status = append_buf_.Flush(fd_, &dirty_ranges_);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+  }
+  return PunchFileHole(fd_, off, size);
+}
+
 Status PositionalParallelFileImpl::GetSize(int64_t* size) {
   if (fd_ < 0) {
     return Status(Status::PRECONDITION_ERROR, "not opened file");
   }
+  const Status flush_status = FlushExpiredAppendBuffer();
+  if (flush_status != Status::SUCCESS) {
+    return flush_status;
+  }
   *size = file_size_.load();
   return Status(Status::SUCCESS);
 }
@@ -319,8 +936,34 @@ Status PositionalParallelFileImpl::SetAllocationStrategy(int64_t init_size, doub
   if (fd_ >= 0) {
     return Status(Status::PRECONDITION_ERROR, "alread opened file");
   }
-  alloc_init_size_ = init_size;
-  alloc_inc_factor_ = inc_factor;
+  alloc_init_size_ = init_size;
+  alloc_inc_factor_ = inc_factor;
+  return Status(Status::SUCCESS);
+}
+
+Status PositionalParallelFileImpl::Advise(int64_t off, int64_t size, File::AccessAdvice advice) {
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  return AdviseFile(fd_, off, size, advice);
+}
+
+Status PositionalParallelFileImpl::SetAppendBuffer(int64_t size, double max_delay) {
+  {
+    std::lock_guard<std::mutex> lock(append_buf_.GetMutex());
+    if (fd_ >= 0 && writable_) {
+      const Status status = append_buf_.Flush(fd_, &dirty_ranges_);
+      if (status != Status::SUCCESS) {
+        return status;
+      }
+    }
+    append_buf_.SetCapacity(size, max_delay);
+  }
+  if (fd_ >= 0 && writable_ && size > 0) {
+    StartBackgroundFlush(max_delay);
+  } else {
+    AppendBufferFlusher::GetInstance()->Unregister(this);
+  }
   return Status(Status::SUCCESS);
 }
 
@@ -341,10 +984,74 @@ Status PositionalParallelFileImpl::AdjustTruncSize(int64_t min_size) {
   if (ftruncate(fd_, new_trunc_size) != 0) {
     return GetErrnoStatus("ftruncate", errno);
   }
+  if (open_options_ & File::OPEN_PREALLOCATE) {
+    const int64_t old_trunc_size = trunc_size_.load();
+    const Status status =
+        AllocateFileSpace(fd_, old_trunc_size, new_trunc_size - old_trunc_size, false);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+  }
   trunc_size_.store(new_trunc_size);
   return Status(Status::SUCCESS);
 }
 
+Status PositionalParallelFileImpl::AppendBuffered(
+    const std::string_view* pieces, size_t num_pieces, int64_t* off) {
+  int64_t size = 0;
+  for (size_t i = 0; i < num_pieces; i++) {
+    size += pieces[i].size();
+  }
+  std::lock_guard<std::mutex> lock(append_buf_.GetMutex());
+  int64_t position = 0;
+  while (true) {
+    position = file_size_.load();
+    const int64_t end_position = position + size;
+    const Status status = AdjustTruncSize(end_position);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+    if (file_size_.compare_exchange_weak(position, end_position)) {
+      break;
+    }
+  }
+  if (off != nullptr) {
+    *off = position;
+  }
+  if (!append_buf_.CanAdd(position, size)) {
+    const Status status = append_buf_.Flush(fd_, &dirty_ranges_);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+  }
+  if (size > append_buf_.GetCapacity()) {
+    const Status status = WritePieces(fd_, pieces, num_pieces, position);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+    dirty_ranges_.Add(position, size);
+    return Status(Status::SUCCESS);
+  }
+  append_buf_.Add(position, pieces, num_pieces);
+  return Status(Status::SUCCESS);
+}
+
+Status PositionalParallelFileImpl::FlushExpiredAppendBuffer() {
+  if (!append_buf_.IsExpired()) {
+    return Status(Status::SUCCESS);
+  }
+  std::lock_guard<std::mutex> lock(append_buf_.GetMutex());
+  if (!append_buf_.IsExpired()) {
+    return Status(Status::SUCCESS);
+  }
+  return append_buf_.Flush(fd_, &dirty_ranges_);
+}
+
+void PositionalParallelFileImpl::StartBackgroundFlush(double max_delay) {
+  AppendBufferFlusher::GetInstance()->Register(
+      this, max_delay, [this]() { FlushExpiredAppendBuffer(); });
+}
+
 PositionalParallelFile::PositionalParallelFile() {
   impl_ = new PositionalParallelFileImpl();
 }
@@ -381,6 +1088,22 @@ Status PositionalParallelFile::Expand(size_t inc_size, int64_t* old_size) {
   return impl_->Append(nullptr, inc_size, old_size);
 }
 
+Status PositionalParallelFile::ReadV(const ReadExtent* extents, size_t num_extents) {
+  assert(extents != nullptr || num_extents == 0);
+  return impl_->ReadV(extents, num_extents);
+}
+
+Status PositionalParallelFile::WriteV(const WriteExtent* extents, size_t num_extents) {
+  assert(extents != nullptr || num_extents == 0);
+  return impl_->WriteV(extents, num_extents);
+}
+
+Status PositionalParallelFile::AppendV(
+    const std::string_view* pieces, size_t num_pieces, int64_t* off) {
+  assert(pieces != nullptr || num_pieces == 0);
+  return impl_->AppendV(pieces, num_pieces, off);
+}
+
 Status PositionalParallelFile::Truncate(int64_t size) {
   assert(size >= 0 && size <= MAX_MEMORY_SIZE);
   return impl_->Truncate(size);
@@ -390,6 +1113,16 @@ Status PositionalParallelFile::Synchronize(bool hard) {
   return impl_->Synchronize(hard);
 }
 
+Status PositionalParallelFile::SynchronizeRange(int64_t off, int64_t size) {
+  assert(off >= 0);
+  return impl_->SynchronizeRange(off, size);
+}
+
+Status PositionalParallelFile::PunchHole(int64_t off, int64_t size) {
+  assert(off >= 0 && size >= 0);
+  return impl_->PunchHole(off, size);
+}
+
 Status PositionalParallelFile::GetSize(int64_t* size) {
   assert(size != nullptr);
   return impl_->GetSize(size);
@@ -400,6 +1133,16 @@ Status PositionalParallelFile::SetAllocationStrategy(int64_t init_size, double i
   return impl_->SetAllocationStrategy(init_size, inc_factor);
 }
 
+Status PositionalParallelFile::Advise(int64_t off, int64_t size, AccessAdvice advice) {
+  assert(off >= 0);
+  return impl_->Advise(off, size, advice);
+}
+
+Status PositionalParallelFile::SetAppendBuffer(int64_t size, double max_delay) {
+  assert(max_delay >= 0);
+  return impl_->SetAppendBuffer(size, max_delay);
+}
+
 class PositionalAtomicFileImpl final {
  public:
   PositionalAtomicFileImpl();
@@ -409,12 +1152,24 @@ class PositionalAtomicFileImpl final {
   Status Read(int64_t off, void* buf, size_t size);
   Status Write(int64_t off, const void* buf, size_t size);
   Status Append(const void* buf, size_t size, int64_t* off);
+  Status ReadV(const File::ReadExtent* extents, size_t num_extents);
+  Status WriteV(const File::WriteExtent* extents, size_t num_extents);
+  Status AppendV(const std::string_view* pieces, size_t num_pieces, int64_t* off);
   Status Truncate(int64_t size);
   Status Synchronize(bool hard);
+  Status SynchronizeRange(int64_t off, int64_t size);
+  Status PunchHole(int64_t off, int64_t size);
   Status GetSize(int64_t* size);
   Status SetAllocationStrategy(int64_t init_size, double inc_factor);
+  Status Advise(int64_t off, int64_t size, File::AccessAdvice advice);
+  Status SetAppendBuffer(int64_t size, double max_delay);
 
  private:
+  Status AdjustTruncSize(int64_t min_size);
+  Status AppendBuffered(const std::string_view* pieces, size_t num_pieces, int64_t* off);
+  Status FlushExpiredAppendBuffer();
+  void StartBackgroundFlush(double max_delay);
+
   int32_t fd_;
   int64_t file_size_;
   int64_t trunc_size_;
@@ -422,18 +1177,22 @@ class PositionalAtomicFileImpl final {
   int32_t open_options_;
   int64_t alloc_init_size_;
   double alloc_inc_factor_;
+  DirtyRangeSet dirty_ranges_;
+  int64_t synced_size_;
+  AppendBuffer append_buf_;
   std::shared_timed_mutex mutex_;
 };
 
 PositionalAtomicFileImpl::PositionalAtomicFileImpl()
     : fd_(-1), file_size_(0), trunc_size_(0), writable_(false), open_options_(0),
       alloc_init_size_(File::DEFAULT_ALLOC_INIT_SIZE),
-      alloc_inc_factor_(File::DEFAULT_ALLOC_INC_FACTOR) {}
+      alloc_inc_factor_(File::DEFAULT_ALLOC_INC_FACTOR), synced_size_(-1) {}
 
 PositionalAtomicFileImpl::~PositionalAtomicFileImpl() {
   if (fd_ >= 0) {
     Close();
   }
+  AppendBufferFlusher::GetInstance()->Unregister(this);
 }
 
 Status PositionalAtomicFileImpl::Open(const std::string& path, bool writable, int32_t options) {
@@ -505,6 +1264,13 @@ Status PositionalAtomicFileImpl::Open(const std::string& path, bool writable, in
       close(fd);
       return status;
     }
+    if (options & File::OPEN_PREALLOCATE) {
+      const Status status = AllocateFileSpace(fd, file_size, trunc_size - file_size, false);
+      if (status != Status::SUCCESS) {
+        close(fd);
+        return status;
+      }
+    }
   }
 
   // Updates the internal data.
@@ -513,17 +1279,26 @@ Status PositionalAtomicFileImpl::Open(const std::string& path, bool writable, in
   trunc_size_ = trunc_size;
   writable_ = writable;
   open_options_ = options;
+  if (writable && append_buf_.GetCapacity() > 0) {
+    StartBackgroundFlush(append_buf_.GetMaxDelay());
+  }
 
   return Status(Status::SUCCESS);
 }
 
 Status PositionalAtomicFileImpl::Close() {
+  // The flusher must be stopped before locking as it locks the file by itself.
+  AppendBufferFlusher::GetInstance()->Unregister(this);
   std::lock_guard<std::shared_timed_mutex> lock(mutex_);
   if (fd_ < 0) {
     return Status(Status::PRECONDITION_ERROR, "not opened file");
   }
   Status status(Status::SUCCESS);
 
+  // Writes the buffered data.
+  status |= append_buf_.Flush(fd_, &dirty_ranges_);
+  append_buf_.Clear();
+
   // Truncates the file.
   if (writable_ && ftruncate(fd_, file_size_) != 0) {
     status |= GetErrnoStatus("ftruncate", errno);
@@ -554,29 +1329,29 @@ Status PositionalAtomicFileImpl::Close() {
   trunc_size_ = 0;
   writable_ = false;
   open_options_ = 0;
+  dirty_ranges_.Clear();
+  synced_size_ = -1;
 
   return status;
 }
 
 Status PositionalAtomicFileImpl::Read(int64_t off, void* buf, size_t size) {
+  if (append_buf_.IsExpired()) {
+    std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+    const Status flush_status = FlushExpiredAppendBuffer();
+    if (flush_status != Status::SUCCESS) {
+      return flush_status;
+    }
+  }
   std::shared_lock<std::shared_timed_mutex> lock(mutex_);
   if (fd_ < 0) {
     return Status(Status::PRECONDITION_ERROR, "not opened file");
   }
-  char* wp = static_cast<char*>(buf);
-  while (size > 0) {
-    const int32_t rsiz = pread(fd_, wp, size, off);
-    if (rsiz < 0) {
-      return GetErrnoStatus("pread", errno);
-    }
-    if (rsiz == 0) {
-      return Status(Status::INFEASIBLE_ERROR, "excessive region");
-    }
-    off += rsiz;
-    wp += rsiz;
-    size -= rsiz;
+  const Status status = PReadFully(fd_, buf, size, off);
+  if (status == Status::SUCCESS && append_buf_.MayOverlap(off, size)) {
+    append_buf_.Overlay(off, buf, size);
   }
-  return Status(Status::SUCCESS);
+  return status;
 }
 
 Status PositionalAtomicFileImpl::Write(int64_t off, const void* buf, size_t size) {
@@ -587,20 +1362,28 @@ Status PositionalAtomicFileImpl::Write(int64_t off, const void* buf, size_t size
   if (!writable_) {
     return Status(Status::PRECONDITION_ERROR, "not writable file");
   }
-  const int64_t end_position = off + size;
-  if (end_position > trunc_size_) {
-    int64_t new_trunc_size =
-        std::max(end_position, static_cast<int64_t>(trunc_size_ * alloc_inc_factor_));
-    const int64_t diff = new_trunc_size % PAGE_SIZE;
-    if (diff > 0) {
-      new_trunc_size += PAGE_SIZE - diff;
+  const Status flush_status = FlushExpiredAppendBuffer();
+  if (flush_status != Status::SUCCESS) {
+    return flush_status;
+  }
+  if (append_buf_.MayOverlap(off, size)) {
+    if (append_buf_.Contains(off, size)) {
+      append_buf_.Patch(off, buf, size);
+      return Status(Status::SUCCESS);
     }
-    if (ftruncate(fd_, new_trunc_size) != 0) {
-      return GetErrnoStatus("ftruncate", errno);
+    const Status status = append_buf_.Flush(fd_, &dirty_ranges_);
+    if (status != Status::SUCCESS) {
+      return status;
     }
-    trunc_size_ = new_trunc_size;
+  }
+  const int64_t end_position = off + size;
+  const Status status = AdjustTruncSize(end_position);
+  if (status != Status::SUCCESS) {
+    return status;
   }
   file_size_ = std::max(file_size_, end_position);
+  const int64_t dirty_off = off;
+  const int64_t dirty_size = size;
   const char* rp = static_cast<const char*>(buf);
   while (size > 0) {
     const int32_t rsiz = pwrite(fd_, rp, size, off);
@@ -611,6 +1394,7 @@ Status PositionalAtomicFileImpl::Write(int64_t off, const void* buf, size_t size
     rp += rsiz;
     size -= rsiz;
   }
+  dirty_ranges_.Add(dirty_off, dirty_size);
   return Status(Status::SUCCESS);
 }
 
@@ -622,25 +1406,23 @@ Status PositionalAtomicFileImpl::Append(const void* buf, size_t size, int64_t* o
   if (!writable_) {
     return Status(Status::PRECONDITION_ERROR, "not writable file");
   }
+  if (buf != nullptr && append_buf_.GetCapacity() > 0) {
+    const std::string_view piece(static_cast<const char*>(buf), size);
+    return AppendBuffered(&piece, 1, off);
+  }
   int64_t position = file_size_;
   const int64_t end_position = position + size;
-  if (end_position > trunc_size_) {
-    int64_t new_trunc_size =
-        std::max(end_position, static_cast<int64_t>(trunc_size_ * alloc_inc_factor_));
-    const int64_t diff = new_trunc_size % PAGE_SIZE;
-    if (diff > 0) {
-      new_trunc_size += PAGE_SIZE - diff;
-    }
-    if (ftruncate(fd_, new_trunc_size) != 0) {
-      return GetErrnoStatus("ftruncate", errno);
-    }
-    trunc_size_ = new_trunc_size;
+  const Status status = AdjustTruncSize(end_position);
+  if (status != Status::SUCCESS) {
+    return status;
   }
   file_size_ = end_position;
   if (off != nullptr) {
     *off = position;
   }
   if (buf != nullptr) {
+    const int64_t dirty_off = position;
+    const int64_t dirty_size = size;
     const char* rp = static_cast<const char*>(buf);
     while (size > 0) {
       const int32_t rsiz = pwrite(fd_, rp, size, position);
@@ -651,7 +1433,151 @@ Status PositionalAtomicFileImpl::Append(const void* buf, size_t size, int64_t* o
       rp += rsiz;
       size -= rsiz;
     }
+    dirty_ranges_.Add(dirty_off, dirty_size);
+  }
+  return Status(Status::SUCCESS);
+}
+
+Status PositionalAtomicFileImpl::ReadV(const File::ReadExtent* extents, size_t num_extents) {
+  if (append_buf_.IsExpired()) {
+    std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+    const Status flush_status = FlushExpiredAppendBuffer();
+    if (flush_status != Status::SUCCESS) {
+      return flush_status;
+    }
+  }
+  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  const Status status = ReadExtents(fd_, extents, num_extents);
+  if (status == Status::SUCCESS && append_buf_.MayOverlap(extents, num_extents)) {
+    for (size_t i = 0; i < num_extents; i++) {
+      append_buf_.Overlay(extents[i].off, extents[i].buf, extents[i].size);
+    }
+  }
+  return status;
+}
+
+Status PositionalAtomicFileImpl::WriteV(const File::WriteExtent* extents, size_t num_extents) {
+  std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  if (!writable_) {
+    return Status(Status::PRECONDITION_ERROR, "not writable file");
+  }
+  const Status flush_status = FlushExpiredAppendBuffer();
+  if (flush_status != Status::SUCCESS) {
+    return flush_status;
+  }
+  if (append_buf_.MayOverlap(extents, num_extents)) {
+    if (append_buf_.Contains(extents, num_extents)) {
+      for (size_t i = 0; i < num_extents; i++) {
+        append_buf_.Patch(extents[i].off, extents[i].buf, extents[i].size);
+      }
+      return Status(Status::SUCCESS);
+    }
+    const Status status = append_buf_.Flush(fd_, &dirty_ranges_);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+  }
+  int64_t end_position = 0;
+  for (size_t i = 0; i < num_extents; i++) {
+    end_position = std::max<int64_t>(end_position, extents[i].off + extents[i].size);
+  }
+  const Status status = AdjustTruncSize(end_position);
+  if (status != Status::SUCCESS) {
+    return status;
+  }
+  file_size_ = std::max(file_size_, end_position);
+  const Status write_status = WriteExtents(fd_, extents, num_extents);
+  if (write_status != Status::SUCCESS) {
+    return write_status;
+  }
+  for (size_t i = 0; i < num_extents; i++) {
+    dirty_ranges_.Add(extents[i].off, extents[i].size);
+  }
+  return Status(Status::SUCCESS);
+}
+
+Status PositionalAtomicFileImpl::AppendV(
+    const std::string_view* pieces, size_t num_pieces, int64_t* off) {
+  std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  if (!writable_) {
+    return Status(Status::PRECONDITION_ERROR, "not writable file");
+  }
+  if (append_buf_.GetCapacity() > 0) {
+    return AppendBuffered(pieces, num_pieces, off);
+  }
+  int64_t size = 0;
+  for (size_t i = 0; i < num_pieces; i++) {
+    size += pieces[i].size();
+  }
+  const int64_t position = file_size_;
+  const int64_t end_position = position + size;
+  const Status status = AdjustTruncSize(end_position);
+  if (status != Status::SUCCESS) {
+    return status;
+  }
+  file_size_ = end_position;
+  if (off != nullptr) {
+    *off = position;
+  }
+  const Status write_status = WritePieces(fd_, pieces, num_pieces, position);
+  if (write_status != Status::SUCCESS) {
+    return write_status;
+  }
+  dirty_ranges_.Add(position, size);
+  return Status(Status::SUCCESS);
+}
+
+Status PositionalAtomicFileImpl::SetAppendBuffer(int64_t size, double max_delay) {
+  bool flushable = false;
+  {
+    std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+    if (fd_ >= 0 && writable_) {
+      const Status status = append_buf_.Flush(fd_, &dirty_ranges_);
+      if (status != Status::SUCCESS) {
+        return status;
+      }
+      flushable = size > 0;
+    }
+    append_buf_.SetCapacity(size, max_delay);
+  }
+  if (flushable) {
+    StartBackgroundFlush(max_delay);
+  } else {
+    AppendBufferFlusher::GetInstance()->Unregister(this);
+  }
+  return Status(Status::SUCCESS);
+}
+
+Status PositionalAtomicFileImpl::AdjustTruncSize(int64_t min_size) {
+  if (min_size <= trunc_size_) {
+    return Status(Status::SUCCESS);
+  }
+  int64_t new_trunc_size =
+      std::max(min_size, static_cast<int64_t>(trunc_size_ * alloc_inc_factor_));
+  const int64_t diff = new_trunc_size % PAGE_SIZE;
+  if (diff > 0) {
+    new_trunc_size += PAGE_SIZE - diff;
+  }
+  if (ftruncate(fd_, new_trunc_size) != 0) {
+    return GetErrnoStatus("ftruncate", errno);
+  }
+  if (open_options_ & File::OPEN_PREALLOCATE) {
+    const Status status =
+        AllocateFileSpace(fd_, trunc_size_, new_trunc_size - trunc_size_, false);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
   }
+  trunc_size_ = new_trunc_size;
   return Status(Status::SUCCESS);
 }
 
@@ -663,6 +1589,10 @@ Status PositionalAtomicFileImpl::Truncate(int64_t size) {
   if (!writable_) {
     return Status(Status::PRECONDITION_ERROR, "not writable file");
   }
+  const Status flush_status = append_buf_.Flush(fd_, &dirty_ranges_);
+  if (flush_status != Status::SUCCESS) {
+    return flush_status;
+  }
   int64_t new_trunc_size =
       std::max(std::max(size, static_cast<int64_t>(PAGE_SIZE)), alloc_init_size_);
   const int64_t diff = new_trunc_size % PAGE_SIZE;
@@ -685,18 +1615,70 @@ Status PositionalAtomicFileImpl::Synchronize(bool hard) {
   if (!writable_) {
     return Status(Status::PRECONDITION_ERROR, "not writable file");
   }
+  const Status flush_status = append_buf_.Flush(fd_, &dirty_ranges_);
+  if (flush_status != Status::SUCCESS) {
+    return flush_status;
+  }
   Status status(Status::SUCCESS);
+  const int64_t old_trunc_size = trunc_size_;
   trunc_size_ = file_size_;
   if (ftruncate(fd_, trunc_size_) != 0) {
     status |= GetErrnoStatus("ftruncate", errno);
   }
-  if (hard && fsync(fd_) != 0) {
-    status |= GetErrnoStatus("fsync", errno);
+  if (open_options_ & File::OPEN_PREALLOCATE) {
+    // The blocks beyond the end are kept reserved for the data to be added later.
+    status |= AllocateFileSpace(fd_, trunc_size_, old_trunc_size - trunc_size_, true);
+  }
+  if (hard) {
+    status |= SynchronizeRanges(fd_, dirty_ranges_.Extract(), trunc_size_ != synced_size_);
+    synced_size_ = trunc_size_;
+  }
+  return status;
+}
+
+Status PositionalAtomicFileImpl::SynchronizeRange(int64_t off, int64_t size) {
+  std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  if (!writable_) {
+    return Status(Status::PRECONDITION_ERROR, "not writable file");
   }
+  const Status flush_status = append_buf_.Flush(fd_, &dirty_ranges_);
+  if (flush_status != Status::SUCCESS) {
+    return flush_status;
+  }
+  const Status status =
+      SynchronizeRanges(fd_, dirty_ranges_.Extract(off, size), trunc_size_ != synced_size_);
+  synced_size_ = trunc_size_;
   return status;
 }
 
+Status PositionalAtomicFileImpl::PunchHole(int64_t off, int64_t size) {
+  std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  if (!writable_) {
+    return Status(Status::PRECONDITION_ERROR, "not writable file");
+  }
+  if (append_buf_.MayOverlap(off, size)) {
+    const Status status = append_buf_.Flush(fd_, &dirty_ranges_);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+  }
+  return PunchFileHole(fd_, off, size);
+}
+
 Status PositionalAtomicFileImpl::GetSize(int64_t* size) {
+  if (append_buf_.IsExpired()) {
+    std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+    const Status flush_status = FlushExpiredAppendBuffer();
+    if (flush_status != Status::SUCCESS) {
+      return flush_status;
+    }
+  }
   std::shared_lock<std::shared_timed_mutex> lock(mutex_);
   if (fd_ < 0) {
     return Status(Status::PRECONDITION_ERROR, "not opened file");
@@ -715,6 +1697,64 @@ Status PositionalAtomicFileImpl::SetAllocationStrategy(int64_t init_size, double
   return Status(Status::SUCCESS);
 }
 
+Status PositionalAtomicFileImpl::Advise(int64_t off, int64_t size, File::AccessAdvice advice) {
+  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  return AdviseFile(fd_, off, size, advice);
+}
+
+Status PositionalAtomicFileImpl::AppendBuffered(
+    const std::string_view* pieces, size_t num_pieces, int64_t* off) {
+  int64_t size = 0;
+  for (size_t i = 0; i < num_pieces; i++) {
+    size += pieces[i].size();
+  }
+  const int64_t position = file_size_;
+  const int64_t end_position = position + size;
+  const Status adjust_status = AdjustTruncSize(end_position);
+  if (adjust_status != Status::SUCCESS) {
+    return adjust_status;
+  }
+  file_size_ = end_position;
+  if (off != nullptr) {
+    *off = position;
+  }
+  if (!append_buf_.CanAdd(position, size)) {
+    const Status status = append_buf_.Flush(fd_, &dirty_ranges_);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+  }
+  if (size > append_buf_.GetCapacity()) {
+    const Status status = WritePieces(fd_, pieces, num_pieces, position);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+    dirty_ranges_.Add(position, size);
+    return Status(Status::SUCCESS);
+  }
+  append_buf_.Add(position, pieces, num_pieces);
+  return Status(Status::SUCCESS);
+}
+
+Status PositionalAtomicFileImpl::FlushExpiredAppendBuffer() {
+  if (fd_ < 0 || !append_buf_.IsExpired()) {
+    return Status(Status::SUCCESS);
+  }
+  return append_buf_.Flush(fd_, &dirty_ranges_);
+}
+
+void PositionalAtomicFileImpl::StartBackgroundFlush(double max_delay) {
+  AppendBufferFlusher::GetInstance()->Register(this, max_delay, [this]() {
+    if (append_buf_.IsExpired()) {
+      std::lock_guard<std::shared_timed_mutex> lock(mutex_);
+      FlushExpiredAppendBuffer();
+    }
+  });
+}
+
 PositionalAtomicFile::PositionalAtomicFile() {
   impl_ = new PositionalAtomicFileImpl();
 }
@@ -751,6 +1791,22 @@ Status PositionalAtomicFile::Expand(size_t inc_size, int64_t* old_size) {
   return impl_->Append(nullptr, inc_size, old_size);
 }
 
+Status PositionalAtomicFile::ReadV(const ReadExtent* extents, size_t num_extents) {
+  assert(extents != nullptr || num_extents == 0);
+  return impl_->ReadV(extents, num_extents);
+}
+
+Status PositionalAtomicFile::WriteV(const WriteExtent* extents, size_t num_extents) {
+  assert(extents != nullptr || num_extents == 0);
+  return impl_->WriteV(extents, num_extents);
+}
+
+Status PositionalAtomicFile::AppendV(
+    const std::string_view* pieces, size_t num_pieces, int64_t* off) {
+  assert(pieces != nullptr || num_pieces == 0);
+  return impl_->AppendV(pieces, num_pieces, off);
+}
+
 Status PositionalAtomicFile::Truncate(int64_t size) {
   assert(size >= 0 && size <= MAX_MEMORY_SIZE);
   return impl_->Truncate(size);
@@ -760,6 +1816,16 @@ Status PositionalAtomicFile::Synchronize(bool hard) {
   return impl_->Synchronize(hard);
 }
 
+Status PositionalAtomicFile::SynchronizeRange(int64_t off, int64_t size) {
+  assert(off >= 0);
+  return impl_->SynchronizeRange(off, size);
+}
+
+Status PositionalAtomicFile::PunchHole(int64_t off, int64_t size) {
+  assert(off >= 0 && size >= 0);
+  return impl_->PunchHole(off, size);
+}
+
 Status PositionalAtomicFile::GetSize(int64_t* size) {
   assert(size != nullptr);
   return impl_->GetSize(size);
@@ -770,6 +1836,16 @@ Status PositionalAtomicFile::SetAllocationStrategy(int64_t init_size, double inc
   return impl_->SetAllocationStrategy(init_size, inc_factor);
 }
 
+Status PositionalAtomicFile::Advise(int64_t off, int64_t size, AccessAdvice advice) {
+  assert(off >= 0);
+  return impl_->Advise(off, size, advice);
+}
+
+Status PositionalAtomicFile::SetAppendBuffer(int64_t size, double max_delay) {
+  assert(max_delay >= 0);
+  return impl_->SetAppendBuffer(size, max_delay);
+}
+
 }  // namespace tkrzw
 
 // END OF FILE
@@ -96,6 +96,36 @@ class PositionalParallelFile final : public File {
    */
   Status Append(const void* buf, size_t size, int64_t* off = nullptr) override;
 
+  /**
+   * Reads data of multiple regions.
+   * @param extents The pointer to the array of the extents.
+   * @param num_extents The number of the extents.
+   * @return The result status.
+   * @details Runs of contiguous extents are transferred by a single preadv call.
+   */
+  Status ReadV(const ReadExtent* extents, size_t num_extents) override;
+
+  /**
+   * Writes data of multiple regions.
+   * @param extents The pointer to the array of the extents.
+   * @param num_extents The number of the extents.
+   * @return The result status.
+   * @details Runs of contiguous extents are transferred by a single pwritev call.
+   */
+  Status WriteV(const WriteExtent* extents, size_t num_extents) override;
+
+  /**
+   * Appends data of multiple pieces at the end of the file.
+   * @param pieces The pointer to the array of the pieces, which are put contiguously.
+   * @param num_pieces The number of the pieces.
+   * @param off The pointer to an integer object to contain the offset at which the first piece
+   * has been put.  If it is nullptr, it is ignored.
+   * @return The result status.
+   * @details The pieces are written by pwritev without being concatenated.
+   */
+  Status AppendV(const std::string_view* pieces, size_t num_pieces,
+                 int64_t* off = nullptr) override;
+
   /**
    * Expands the file size without writing data.
    * @param inc_size The size to increment the file size by.
@@ -123,6 +153,28 @@ class PositionalParallelFile final : public File {
    */
   Status Synchronize(bool hard) override;
 
+  /**
+   * Synchronizes the content of a region of the file with the hardware.
+   * @param off The offset of the region.
+   * @param size The size of the region.  If it is negative, the region extends to the end of the
+   * file.
+   * @return The result status.
+   * @details Modified parts in the region are written back by "sync_file_range" and then the data
+   * is synchronized by "fdatasync".  "fsync" is used instead only if the file size has changed
+   * since the last synchronization.
+   */
+  Status SynchronizeRange(int64_t off, int64_t size) override;
+
+  /**
+   * Releases storage blocks of a region of the file.
+   * @param off The offset of the region.
+   * @param size The size of the region.
+   * @return The result status.
+   * @details The file size is not changed and the region is read as zeros afterward.  Only
+   * blocks which are wholly inside the region are released.
+   */
+  Status PunchHole(int64_t off, int64_t size) override;
+
   /**
    * Gets the size of the file.
    * @param size The pointer to an integer object to contain the result size.
@@ -140,6 +192,31 @@ class PositionalParallelFile final : public File {
    */
   Status SetAllocationStrategy(int64_t init_size, double inc_factor) override;
 
+  /**
+   * Gives advice about the access pattern of a region.
+   * @param off The offset of the region.
+   * @param size The size of the region.  If it is negative, the region extends to the end of the
+   * file.
+   * @param advice The advice about the access pattern.
+   * @return The result status.
+   * @details The advice is given to the file system by "posix_fadvise".  RANDOM and
+   * SEQUENTIAL affect read-ahead of the whole file.  COLD and HUGEPAGE are ignored.
+   */
+  Status Advise(int64_t off, int64_t size, AccessAdvice advice) override;
+
+  /**
+   * Sets the buffer to coalesce appended data into large writes.
+   * @param size The capacity of the buffer.  If it is not positive, data are written directly.
+   * @param max_delay The maximum time in seconds for which data stay in the buffer.
+   * @return The result status.
+   * @details Data appended by Append and AppendV are kept in the buffer and written together
+   * by one call of "pwrite".  Reading and writing a region in the buffer are done on the
+   * buffer.  The buffer is flushed when the file is synchronized, truncated, or closed.  It is
+   * also flushed by Read, ReadV, Write, WriteV, Append, AppendV, and GetSize called after the
+   * maximum delay, or by a background thread shared by all files while the file is idle.
+   */
+  Status SetAppendBuffer(int64_t size, double max_delay) override;
+
   /**
    * Checks whether operations are done by memory mapping.
    * @return True if operations are done by memory mapping, or false if not.
@@ -239,6 +316,36 @@ class PositionalAtomicFile final : public File {
    */
   Status Append(const void* buf, size_t size, int64_t* off = nullptr) override;
 
+  /**
+   * Reads data of multiple regions.
+   * @param extents The pointer to the array of the extents.
+   * @param num_extents The number of the extents.
+   * @return The result status.
+   * @details Runs of contiguous extents are transferred by a single preadv call.
+   */
+  Status ReadV(const ReadExtent* extents, size_t num_extents) override;
+
+  /**
+   * Writes data of multiple regions.
+   * @param extents The pointer to the array of the extents.
+   * @param num_extents The number of the extents.
+   * @return The result status.
+   * @details Runs of contiguous extents are transferred by a single pwritev call.
+   */
+  Status WriteV(const WriteExtent* extents, size_t num_extents) override;
+
+  /**
+   * Appends data of multiple pieces at the end of the file.
+   * @param pieces The pointer to the array of the pieces, which are put contiguously.
+   * @param num_pieces The number of the pieces.
+   * @param off The pointer to an integer object to contain the offset at which the first piece
+   * has been put.  If it is nullptr, it is ignored.
+   * @return The result status.
+   * @details The pieces are written by pwritev without being concatenated.
+   */
+  Status AppendV(const std::string_view* pieces, size_t num_pieces,
+                 int64_t* off = nullptr) override;
+
   /**
    * Expands the file size without writing data.
    * @param inc_size The size to increment the file size by.
@@ -266,6 +373,28 @@ class PositionalAtomicFile final : public File {
    */
   Status Synchronize(bool hard) override;
 
+  /**
+   * Synchronizes the content of a region of the file with the hardware.
+   * @param off The offset of the region.
+   * @param size The size of the region.  If it is negative, the region extends to the end of the
+   * file.
+   * @return The result status.
+   * @details Modified parts in the region are written back by "sync_file_range" and then the data
+   * is synchronized by "fdatasync".  "fsync" is used instead only if the file size has changed
+   * since the last synchronization.
+   */
+  Status SynchronizeRange(int64_t off, int64_t size) override;
+
+  /**
+   * Releases storage blocks of a region of the file.
+   * @param off The offset of the region.
+   * @param size The size of the region.
+   * @return The result status.
+   * @details The file size is not changed and the region is read as zeros afterward.  Only
+   * blocks which are wholly inside the region are released.
+   */
+  Status PunchHole(int64_t off, int64_t size) override;
+
   /**
    * Gets the size of the file.
    * @param size The pointer to an integer object to contain the result size.
@@ -283,6 +412,31 @@ class PositionalAtomicFile final : public File {
    */
   Status SetAllocationStrategy(int64_t init_size, double inc_factor) override;
 
+  /**
+   * Gives advice about the access pattern of a region.
+   * @param off The offset of the region.
+   * @param size The size of the region.  If it is negative, the region extends to the end of the
+   * file.
+   * @param advice The advice about the access pattern.
+   * @return The result status.
+   * @details The advice is given to the file system by "posix_fadvise".  RANDOM and
+   * SEQUENTIAL affect read-ahead of the whole file.  COLD and HUGEPAGE are ignored.
+   */
+  Status Advise(int64_t off, int64_t size, AccessAdvice advice) override;
+
+  /**
+   * Sets the buffer to coalesce appended data into large writes.
+   * @param size The capacity of the buffer.  If it is not positive, data are written directly.
+   * @param max_delay The maximum time in seconds for which data stay in the buffer.
+   * @return The result status.
+   * @details Data appended by Append and AppendV are kept in the buffer and written together
+   * by one call of "pwrite".  Reading and writing a region in the buffer are done on the
+   * buffer.  The buffer is flushed when the file is synchronized, truncated, or closed.  It is
+   * also flushed by Read, ReadV, Write, WriteV, Append, AppendV, and GetSize called after the
+   * maximum delay, or by a background thread shared by all files while the file is idle.
+   */
+  Status SetAppendBuffer(int64_t size, double max_delay) override;
+
   /**
    * Checks whether operations are done by memory mapping.
    * @return True if operations are done by memory mapping, or false if not.
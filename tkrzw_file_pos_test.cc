@@ -80,6 +80,26 @@ TEST_F(PositionalParallelFileTest, FlatRecord) {
   FlatRecordTest();
 }
 
+TEST_F(PositionalParallelFileTest, VectorIO) {
+  VectorIOTest();
+}
+
+TEST_F(PositionalParallelFileTest, AsyncRead) {
+  AsyncReadTest();
+}
+
+TEST_F(PositionalParallelFileTest, SynchronizeRange) {
+  SynchronizeRangeTest();
+}
+
+TEST_F(PositionalParallelFileTest, Allocation) {
+  AllocationTest();
+}
+
+TEST_F(PositionalParallelFileTest, AppendBuffer) {
+  AppendBufferTest();
+}
+
 class PositionalAtomicFileTest : public PositionalFileTest<tkrzw::PositionalAtomicFile> {};
 
 TEST_F(PositionalAtomicFileTest, Attributes) {
@@ -128,4 +148,24 @@ TEST_F(PositionalAtomicFileTest, FlatRecord) {
   FlatRecordTest();
 }
 
+TEST_F(PositionalAtomicFileTest, VectorIO) {
+  VectorIOTest();
+}
+
+TEST_F(PositionalAtomicFileTest, AsyncRead) {
+  AsyncReadTest();
+}
+
+TEST_F(PositionalAtomicFileTest, SynchronizeRange) {
+  SynchronizeRangeTest();
+}
+
+TEST_F(PositionalAtomicFileTest, Allocation) {
+  AllocationTest();
+}
+
+TEST_F(PositionalAtomicFileTest, AppendBuffer) {
+  AppendBufferTest();
+}
+
 // END OF FILE
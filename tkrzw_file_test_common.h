@@ -35,6 +35,11 @@ class CommonFileTest : public Test {
   void RandomThreadTest();
   void FileReaderTest();
   void FlatRecordTest();
+  void VectorIOTest();
+  void AsyncReadTest();
+  void SynchronizeRangeTest();
+  void AllocationTest();
+  void AppendBufferTest();
 };
 
 template <class FILE>
@@ -408,4 +413,268 @@ void CommonFileTest<FILE>::FlatRecordTest() {
   EXPECT_EQ(tkrzw::Status::SUCCESS, file.Close());
 }
 
+template <class FILE>
+void CommonFileTest<FILE>::VectorIOTest() {
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string file_path = tmp_dir.MakeUniquePath();
+  FILE file;
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Open(file_path, true));
+  const std::string_view pieces[] = {"0123", "", "456", "789"};
+  int64_t off = -1;
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.AppendV(pieces, 4, &off));
+  EXPECT_EQ(0, off);
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.AppendV(pieces, 2, &off));
+  EXPECT_EQ(10, off);
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.AppendV(nullptr, 0, &off));
+  EXPECT_EQ(14, off);
+  const tkrzw::File::WriteExtent write_extents[] = {
+    {2, "AB", 2}, {4, "CD", 2}, {12, "EF", 2}, {16, "GHI", 3}};
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.WriteV(write_extents, 4));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.WriteV(nullptr, 0));
+  EXPECT_EQ(19, file.GetSizeSimple());
+  char buf[19];
+  std::memset(buf, 'x', sizeof(buf));
+  const tkrzw::File::ReadExtent read_extents[] = {
+    {16, buf + 16, 3}, {0, buf, 8}, {8, buf + 8, 6}, {14, buf + 14, 2}};
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.ReadV(read_extents, 4));
+  std::string expected("01ABCD678901EF");
+  expected.append(2, '\0');
+  expected.append("GHI");
+  EXPECT_EQ(expected, std::string(buf, 19));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.ReadV(nullptr, 0));
+  const tkrzw::File::ReadExtent excessive_extents[] = {{0, buf, 8}, {1 << 20, buf, 4}};
+  EXPECT_EQ(tkrzw::Status::INFEASIBLE_ERROR, file.ReadV(excessive_extents, 2));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Close());
+  std::string content;
+  EXPECT_EQ(tkrzw::Status::SUCCESS, tkrzw::ReadFile(file_path, &content));
+  EXPECT_EQ(expected, content);
+}
+
+template <class FILE>
+void CommonFileTest<FILE>::AsyncReadTest() {
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string file_path = tmp_dir.MakeUniquePath();
+  FILE file;
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Open(file_path, true));
+  constexpr int32_t num_records = 1000;
+  constexpr int32_t record_size = 10;
+  for (int32_t i = 0; i < num_records; i++) {
+    const std::string data = tkrzw::SPrintF("%010d", i);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, file.Append(data.data(), data.size()));
+  }
+  std::vector<std::future<std::pair<tkrzw::Status, std::string>>> futures;
+  for (int32_t i = num_records - 1; i >= 0; i--) {
+    futures.emplace_back(file.ReadAsync(i * record_size, record_size));
+  }
+  for (int32_t i = 0; i < num_records; i++) {
+    const auto result = futures[i].get();
+    EXPECT_EQ(tkrzw::Status::SUCCESS, result.first);
+    EXPECT_EQ(tkrzw::SPrintF("%010d", num_records - 1 - i), result.second);
+  }
+  const auto result = file.ReadAsync(1 << 20, record_size).get();
+  EXPECT_EQ(tkrzw::Status::INFEASIBLE_ERROR, result.first);
+  EXPECT_EQ("", result.second);
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Close());
+}
+
+template <class FILE>
+void CommonFileTest<FILE>::SynchronizeRangeTest() {
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string file_path = tmp_dir.MakeUniquePath();
+  auto read_file = [&]() {
+    std::string content;
+    EXPECT_EQ(tkrzw::Status::SUCCESS, tkrzw::ReadFile(file_path, &content));
+    return content;
+  };
+  FILE file;
+  EXPECT_EQ(tkrzw::Status::PRECONDITION_ERROR, file.SynchronizeRange(0, -1));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Open(file_path, true));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.SynchronizeRange(0, -1));
+  const std::string data(10000, 'a');
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Append(data.data(), data.size()));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Synchronize(true));
+  EXPECT_EQ(data, read_file());
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Write(5000, "XYZ", 3));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Write(9000, "xyz", 3));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.SynchronizeRange(4096, 4096));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.SynchronizeRange(0, -1));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.SynchronizeRange(0, -1));
+  std::string expected = data;
+  expected.replace(5000, 3, "XYZ");
+  expected.replace(9000, 3, "xyz");
+  EXPECT_EQ(expected, read_file().substr(0, expected.size()));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Append("END", 3));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Synchronize(true));
+  EXPECT_EQ(expected + "END", read_file());
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Close());
+  EXPECT_EQ(expected + "END", read_file());
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Open(file_path, false));
+  EXPECT_EQ(tkrzw::Status::PRECONDITION_ERROR, file.SynchronizeRange(0, -1));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Close());
+}
+
+template <class FILE>
+void CommonFileTest<FILE>::AllocationTest() {
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string file_path = tmp_dir.MakeUniquePath();
+  auto read_file = [&]() {
+    std::string content;
+    EXPECT_EQ(tkrzw::Status::SUCCESS, tkrzw::ReadFile(file_path, &content));
+    return content;
+  };
+  FILE file;
+  EXPECT_EQ(tkrzw::Status::PRECONDITION_ERROR, file.PunchHole(0, 1));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.SetAllocationStrategy(1, 2));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Open(
+      file_path, true, tkrzw::File::OPEN_TRUNCATE | tkrzw::File::OPEN_PREALLOCATE));
+  std::string expected;
+  for (int32_t i = 0; i < 20; i++) {
+    const std::string data(1000, 'a' + i);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, file.Append(data.data(), data.size()));
+    expected.append(data);
+  }
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Synchronize(false));
+  EXPECT_EQ(expected, read_file());
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Append("END", 3));
+  expected.append("END");
+  const tkrzw::Status status = file.PunchHole(4096, 8292);
+  if (status != tkrzw::Status::NOT_IMPLEMENTED_ERROR) {
+    EXPECT_EQ(tkrzw::Status::SUCCESS, status);
+    expected.replace(4096, 8292, std::string(8292, 0));
+  }
+  EXPECT_EQ(expected.size(), file.GetSizeSimple());
+  char buf[20003];
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Read(0, buf, sizeof(buf)));
+  EXPECT_EQ(expected, std::string(buf, sizeof(buf)));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Write(5000, "XYZ", 3));
+  expected.replace(5000, 3, "XYZ");
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Close());
+  EXPECT_EQ(expected, read_file());
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Open(file_path, false));
+  EXPECT_EQ(tkrzw::Status::PRECONDITION_ERROR, file.PunchHole(0, 1));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Close());
+}
+
+template <class FILE>
+void CommonFileTest<FILE>::AppendBufferTest() {
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string file_path = tmp_dir.MakeUniquePath();
+  auto read_file = [&]() {
+    std::string content;
+    EXPECT_EQ(tkrzw::Status::SUCCESS, tkrzw::ReadFile(file_path, &content));
+    return content;
+  };
+  FILE file;
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.SetAppendBuffer(100, 10.0));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Open(file_path, true));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Append("0123456789", 10));
+  std::string expected = "0123456789";
+  int64_t off = -1;
+  for (int32_t i = 0; i < 30; i++) {
+    const std::string data = tkrzw::SPrintF("%05d", i);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, file.Append(data.data(), data.size(), &off));
+    EXPECT_EQ(expected.size(), off);
+    expected.append(data);
+    EXPECT_EQ(expected.size(), file.GetSizeSimple());
+  }
+  char buf[160];
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Read(0, buf, expected.size()));
+  EXPECT_EQ(expected, std::string(buf, expected.size()));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Read(expected.size() - 8, buf, 8));
+  EXPECT_EQ(expected.substr(expected.size() - 8), std::string(buf, 8));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Write(expected.size() - 3, "XYZ", 3));
+  expected.replace(expected.size() - 3, 3, "XYZ");
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Write(3, "abcd", 4));
+  expected.replace(3, 4, "abcd");
+  const tkrzw::File::WriteExtent write_extents[] = {{1, "!", 1}, {150, "?", 1}};
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.WriteV(write_extents, 2));
+  expected.replace(1, 1, "!");
+  expected.replace(150, 1, "?");
+  const std::string_view pieces[] = {"END", "", "end"};
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.AppendV(pieces, 3, &off));
+  EXPECT_EQ(expected.size(), off);
+  expected.append("ENDend");
+  const std::string large_data(200, 'L');
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Append(large_data.data(), large_data.size(), &off));
+  EXPECT_EQ(expected.size(), off);
+  expected.append(large_data);
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Append("tail", 4));
+  expected.append("tail");
+  const tkrzw::Status punch_status = file.PunchHole(expected.size() - 4, 4);
+  if (punch_status != tkrzw::Status::NOT_IMPLEMENTED_ERROR) {
+    EXPECT_EQ(tkrzw::Status::SUCCESS, punch_status);
+    expected.replace(expected.size() - 4, 4, std::string(4, 0));
+  }
+  std::string actual(expected.size(), 0);
+  const tkrzw::File::ReadExtent read_extents[] = {
+    {0, actual.data(), 100}, {100, actual.data() + 100, expected.size() - 100}};
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.ReadV(read_extents, 2));
+  EXPECT_EQ(expected, actual);
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Synchronize(false));
+  EXPECT_EQ(expected, read_file());
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Append("more", 4));
+  expected.append("more");
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Truncate(expected.size() - 2));
+  expected.resize(expected.size() - 2);
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.SetAppendBuffer(0, 0));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Append("last", 4));
+  expected.append("last");
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Synchronize(false));
+  EXPECT_EQ(expected, read_file());
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.SetAppendBuffer(100, 0));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Append("final", 5));
+  expected.append("final");
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Close());
+  EXPECT_EQ(expected, read_file());
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.SetAppendBuffer(100, 0.01));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Open(file_path, true));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Append("aged", 4));
+  expected.append("aged");
+  tkrzw::Sleep(0.05);
+  EXPECT_EQ(expected.size(), file.GetSizeSimple());
+  EXPECT_EQ(expected, read_file().substr(0, expected.size()));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Append("read", 4));
+  expected.append("read");
+  tkrzw::Sleep(0.05);
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Read(0, buf, 4));
+  EXPECT_EQ(expected, read_file().substr(0, expected.size()));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Append("idle", 4));
+  expected.append("idle");
+  tkrzw::Sleep(0.2);
+  EXPECT_EQ(expected, read_file().substr(0, expected.size()));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Close());
+  constexpr int32_t num_threads = 4;
+  constexpr int32_t num_iterations = 2000;
+  constexpr int32_t record_size = 10;
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.SetAppendBuffer(1000, 10.0));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Open(file_path, true, tkrzw::File::OPEN_TRUNCATE));
+  auto append_func = [&](int32_t id) {
+    const std::string data(record_size, 'a' + id);
+    const std::string patch(record_size / 2, 'A' + id);
+    char read_buf[record_size];
+    for (int32_t i = 0; i < num_iterations; i++) {
+      int64_t rec_off = -1;
+      EXPECT_EQ(tkrzw::Status::SUCCESS, file.Append(data.data(), data.size(), &rec_off));
+      EXPECT_EQ(tkrzw::Status::SUCCESS, file.Read(rec_off, read_buf, record_size));
+      EXPECT_EQ(data, std::string(read_buf, record_size));
+      EXPECT_EQ(tkrzw::Status::SUCCESS, file.Write(rec_off, patch.data(), patch.size()));
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int32_t i = 0; i < num_threads; i++) {
+    threads.emplace_back(std::thread(append_func, i));
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Close());
+  const std::string content = read_file();
+  EXPECT_EQ(num_threads * num_iterations * record_size, content.size());
+  for (size_t off = 0; off < content.size(); off += record_size) {
+    const char id = content[off] - 'A';
+    EXPECT_EQ(std::string(record_size / 2, 'A' + id) + std::string(record_size / 2, 'a' + id),
+              content.substr(off, record_size));
+  }
+}
+
 // END OF FILE
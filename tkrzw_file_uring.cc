@@ -0,0 +1,971 @@
+/*************************************************************************************************
+ * File implementation by io_uring
+ *
+ * Copyright 2020 Google LLC
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+ * except in compliance with the License.  You may obtain a copy of the License at
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software distributed under the
+ * License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied.  See the License for the specific language governing permissions
+ * and limitations under the License.
+ *************************************************************************************************/
+
+#include "tkrzw_file.h"
+#include "tkrzw_file_uring.h"
+#include "tkrzw_file_util.h"
+#include "tkrzw_lib_common.h"
+#include "tkrzw_str_util.h"
+#include "tkrzw_sys_config.h"
+#include "tkrzw_thread_util.h"
+
+#if defined(_SYS_LINUX_) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#if defined(IORING_FEAT_CUR_PERSONALITY) && defined(__NR_io_uring_setup)
+#define _TKRZW_IO_URING_
+#endif
+#endif
+
+namespace tkrzw {
+
+// Reading or writing operation on a region.
+struct IoUringOperation final {
+  // True for writing or false for reading.
+  bool write;
+  // The offset of the region.
+  int64_t off;
+  // The buffer given by the caller.
+  char* buf;
+  // The size of the region.
+  size_t size;
+  // The size which has been done.
+  size_t done;
+  // The buffer used for I/O, which is either the caller's buffer or the fixed buffer.
+  char* io_buf;
+  // True if the I/O buffer is in the fixed buffer.
+  bool fixed;
+};
+
+// Does operations by positional access.
+static Status DoOperationsByPosition(int32_t fd, IoUringOperation* ops, size_t num_ops) {
+  for (size_t i = 0; i < num_ops; i++) {
+    auto& op = ops[i];
+    int64_t off = op.off;
+    char* ptr = op.buf;
+    size_t size = op.size;
+    while (size > 0) {
+      const int32_t rsiz = op.write ? pwrite(fd, ptr, size, off) : pread(fd, ptr, size, off);
+      if (rsiz < 0) {
+        return GetErrnoStatus(op.write ? "pwrite" : "pread", errno);
+      }
+      if (rsiz == 0 && !op.write) {
+        return Status(Status::INFEASIBLE_ERROR, "excessive region");
+      }
+      off += rsiz;
+      ptr += rsiz;
+      size -= rsiz;
+    }
+  }
+  return Status(Status::SUCCESS);
+}
+
+#if defined(_TKRZW_IO_URING_)
+
+// Submission queue and completion queue of io_uring.
+class IoUringQueue final {
+ public:
+  // The number of entries of the submission queue.
+  static constexpr uint32_t NUM_ENTRIES = 64;
+  // The size of the registered buffer to copy small data.
+  static constexpr size_t FIXED_BUFFER_SIZE = 1 << 16;
+  // The maximum size of a single operation.
+  static constexpr size_t MAX_OPERATION_SIZE = 1 << 30;
+  IoUringQueue();
+  ~IoUringQueue();
+  Status Open(int32_t fd);
+  void Close();
+  bool IsOpen() const;
+  bool IsBroken() const;
+  Status Submit(IoUringOperation* ops, size_t num_ops);
+
+ private:
+  void Prepare(IoUringOperation* ops, uint32_t index);
+  int32_t Enter(uint32_t to_submit, uint32_t min_complete, uint32_t flags);
+
+  int32_t ring_fd_;
+  int32_t fd_;
+  bool fixed_file_;
+  void* sq_ptr_;
+  size_t sq_size_;
+  void* cq_ptr_;
+  size_t cq_size_;
+  io_uring_sqe* sqes_;
+  size_t sqes_size_;
+  uint32_t* sq_tail_;
+  uint32_t sq_mask_;
+  uint32_t* sq_array_;
+  uint32_t* cq_head_;
+  uint32_t* cq_tail_;
+  uint32_t cq_mask_;
+  io_uring_cqe* cqes_;
+  char* fixed_buf_;
+  bool broken_;
+};
+
+IoUringQueue::IoUringQueue()
+    : ring_fd_(-1), fd_(-1), fixed_file_(false),
+      sq_ptr_(nullptr), sq_size_(0), cq_ptr_(nullptr), cq_size_(0),
+      sqes_(nullptr), sqes_size_(0),
+      sq_tail_(nullptr), sq_mask_(0), sq_array_(nullptr),
+      cq_head_(nullptr), cq_tail_(nullptr), cq_mask_(0), cqes_(nullptr),
+      fixed_buf_(nullptr), broken_(false) {}
+
+IoUringQueue::~IoUringQueue() {
+  Close();
+}
+
+Status IoUringQueue::Open(int32_t fd) {
+  io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  const int32_t ring_fd = syscall(__NR_io_uring_setup, NUM_ENTRIES, &params);
+  if (ring_fd < 0) {
+    return GetErrnoStatus("io_uring_setup", errno);
+  }
+  ring_fd_ = ring_fd;
+  fd_ = fd;
+
+  // Maps the queues.
+  sq_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single_mmap) {
+    sq_size_ = std::max(sq_size_, cq_size_);
+    cq_size_ = 0;
+  }
+  void* sq_ptr = mmap(nullptr, sq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring_fd_, IORING_OFF_SQ_RING);
+  if (sq_ptr == MAP_FAILED) {
+    const Status status = GetErrnoStatus("mmap", errno);
+    Close();
+    return status;
+  }
+  sq_ptr_ = sq_ptr;
+  if (single_mmap) {
+    cq_ptr_ = sq_ptr_;
+  } else {
+    void* cq_ptr = mmap(nullptr, cq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ring_fd_, IORING_OFF_CQ_RING);
+    if (cq_ptr == MAP_FAILED) {
+      const Status status = GetErrnoStatus("mmap", errno);
+      Close();
+      return status;
+    }
+    cq_ptr_ = cq_ptr;
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    ring_fd_, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    const Status status = GetErrnoStatus("mmap", errno);
+    Close();
+    return status;
+  }
+  sqes_ = static_cast<io_uring_sqe*>(sqes);
+  char* sq_base = static_cast<char*>(sq_ptr_);
+  sq_tail_ = reinterpret_cast<uint32_t*>(sq_base + params.sq_off.tail);
+  sq_mask_ = *reinterpret_cast<uint32_t*>(sq_base + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<uint32_t*>(sq_base + params.sq_off.array);
+  char* cq_base = static_cast<char*>(cq_ptr_);
+  cq_head_ = reinterpret_cast<uint32_t*>(cq_base + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<uint32_t*>(cq_base + params.cq_off.tail);
+  cq_mask_ = *reinterpret_cast<uint32_t*>(cq_base + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe*>(cq_base + params.cq_off.cqes);
+
+  // Checks whether the needed operations are supported.
+  constexpr size_t num_probe_ops = 256;
+  std::vector<char> probe_buf(sizeof(io_uring_probe) + num_probe_ops * sizeof(io_uring_probe_op));
+  auto* probe = reinterpret_cast<io_uring_probe*>(probe_buf.data());
+  if (syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_PROBE,
+              probe, num_probe_ops) != 0) {
+    const Status status = GetErrnoStatus("io_uring_register", errno);
+    Close();
+    return status;
+  }
+  for (const int32_t opcode : {IORING_OP_READ, IORING_OP_WRITE,
+                               IORING_OP_READ_FIXED, IORING_OP_WRITE_FIXED}) {
+    if (opcode > probe->last_op || !(probe->ops[opcode].flags & IO_URING_OP_SUPPORTED)) {
+      Close();
+      return Status(Status::NOT_IMPLEMENTED_ERROR, "unsupported io_uring operation");
+    }
+  }
+
+  // Registers the file and the fixed buffer.  Failures are not fatal.
+  fixed_file_ = syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_FILES, &fd_, 1) == 0;
+  void* fixed_buf = mmap(nullptr, FIXED_BUFFER_SIZE, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (fixed_buf != MAP_FAILED) {
+    struct iovec iov;
+    iov.iov_base = fixed_buf;
+    iov.iov_len = FIXED_BUFFER_SIZE;
+    if (syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_BUFFERS, &iov, 1) == 0) {
+      fixed_buf_ = static_cast<char*>(fixed_buf);
+    } else {
+      munmap(fixed_buf, FIXED_BUFFER_SIZE);
+    }
+  }
+  return Status(Status::SUCCESS);
+}
+
+void IoUringQueue::Close() {
+  if (fixed_buf_ != nullptr) {
+    munmap(fixed_buf_, FIXED_BUFFER_SIZE);
+    fixed_buf_ = nullptr;
+  }
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+    sqes_ = nullptr;
+  }
+  if (cq_ptr_ != nullptr && cq_ptr_ != sq_ptr_) {
+    munmap(cq_ptr_, cq_size_);
+  }
+  cq_ptr_ = nullptr;
+  if (sq_ptr_ != nullptr) {
+    munmap(sq_ptr_, sq_size_);
+    sq_ptr_ = nullptr;
+  }
+  if (ring_fd_ >= 0) {
+    close(ring_fd_);
+    ring_fd_ = -1;
+  }
+  fd_ = -1;
+  fixed_file_ = false;
+  broken_ = false;
+}
+
+bool IoUringQueue::IsOpen() const {
+  return ring_fd_ >= 0;
+}
+
+bool IoUringQueue::IsBroken() const {
+  return broken_;
+}
+
+Status IoUringQueue::Submit(IoUringOperation* ops, size_t num_ops) {
+  size_t fixed_used = 0;
+  for (size_t i = 0; i < num_ops; i++) {
+    auto& op = ops[i];
+    op.done = 0;
+    if (fixed_buf_ != nullptr && op.size <= FIXED_BUFFER_SIZE - fixed_used) {
+      op.io_buf = fixed_buf_ + fixed_used;
+      op.fixed = true;
+      fixed_used += op.size;
+      if (op.write) {
+        std::memcpy(op.io_buf, op.buf, op.size);
+      }
+    } else {
+      op.io_buf = op.buf;
+      op.fixed = false;
+    }
+  }
+  Status status(Status::SUCCESS);
+  std::vector<uint32_t> retries;
+  size_t next_index = 0;
+  uint32_t num_queued = 0;
+  uint32_t num_in_flight = 0;
+  while (true) {
+    while (num_queued + num_in_flight < NUM_ENTRIES) {
+      uint32_t index = 0;
+      if (!retries.empty()) {
+        index = retries.back();
+        retries.pop_back();
+      } else if (next_index < num_ops && status == Status::SUCCESS) {
+        index = next_index++;
+        if (ops[index].size == 0) {
+          continue;
+        }
+      } else {
+        break;
+      }
+      Prepare(ops, index);
+      num_queued++;
+    }
+    if (num_queued + num_in_flight == 0) {
+      break;
+    }
+    const int32_t num_submitted = Enter(num_queued, 1, IORING_ENTER_GETEVENTS);
+    if (num_submitted < 0) {
+      if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+        continue;
+      }
+      // Operations in flight might be still running.  This object must not be used anymore.
+      broken_ = true;
+      return GetErrnoStatus("io_uring_enter", errno);
+    }
+    num_queued -= num_submitted;
+    num_in_flight += num_submitted;
+    uint32_t head = *cq_head_;
+    const uint32_t tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+      const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+      const uint32_t index = cqe.user_data;
+      const int32_t res = cqe.res;
+      head++;
+      num_in_flight--;
+      auto& op = ops[index];
+      if (res < 0) {
+        if (res == -EINTR || res == -EAGAIN) {
+          retries.emplace_back(index);
+        } else {
+          status |= GetErrnoStatus(op.write ? "io_uring-write" : "io_uring-read", -res);
+        }
+      } else if (res == 0 && !op.write) {
+        status |= Status(Status::INFEASIBLE_ERROR, "excessive region");
+      } else {
+        op.done += res;
+        if (op.done < op.size) {
+          retries.emplace_back(index);
+        }
+      }
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+  }
+  if (status == Status::SUCCESS) {
+    for (size_t i = 0; i < num_ops; i++) {
+      const auto& op = ops[i];
+      if (op.fixed && !op.write) {
+        std::memcpy(op.buf, op.io_buf, op.size);
+      }
+    }
+  }
+  return status;
+}
+
+void IoUringQueue::Prepare(IoUringOperation* ops, uint32_t index) {
+  const auto& op = ops[index];
+  const uint32_t tail = *sq_tail_;
+  const uint32_t sq_index = tail & sq_mask_;
+  io_uring_sqe* sqe = sqes_ + sq_index;
+  std::memset(sqe, 0, sizeof(*sqe));
+  if (op.fixed) {
+    sqe->opcode = op.write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+    sqe->buf_index = 0;
+  } else {
+    sqe->opcode = op.write ? IORING_OP_WRITE : IORING_OP_READ;
+  }
+  if (fixed_file_) {
+    sqe->flags = IOSQE_FIXED_FILE;
+    sqe->fd = 0;
+  } else {
+    sqe->fd = fd_;
+  }
+  sqe->off = op.off + op.done;
+  sqe->addr = reinterpret_cast<uintptr_t>(op.io_buf + op.done);
+  sqe->len = std::min(op.size - op.done, MAX_OPERATION_SIZE);
+  sqe->user_data = index;
+  sq_array_[sq_index] = sq_index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+}
+
+int32_t IoUringQueue::Enter(uint32_t to_submit, uint32_t min_complete, uint32_t flags) {
+  return syscall(__NR_io_uring_enter, ring_fd_, to_submit, min_complete, flags, nullptr, 0);
+}
+
+#else
+
+// Dummy queue for environments without io_uring.
+class IoUringQueue final {
+ public:
+  Status Open(int32_t fd) {
+    return Status(Status::NOT_IMPLEMENTED_ERROR, "io_uring is not supported");
+  }
+  void Close() {}
+  bool IsOpen() const {
+    return false;
+  }
+  bool IsBroken() const {
+    return false;
+  }
+  Status Submit(IoUringOperation* ops, size_t num_ops) {
+    return Status(Status::NOT_IMPLEMENTED_ERROR, "io_uring is not supported");
+  }
+};
+
+#endif
+
+class IoUringParallelFileImpl final {
+ public:
+  // The number of queues shared by threads.
+  static constexpr int32_t NUM_QUEUES = 8;
+  IoUringParallelFileImpl();
+  ~IoUringParallelFileImpl();
+  Status Open(const std::string& path, bool writable, int32_t options);
+  Status Close();
+  Status Read(int64_t off, void* buf, size_t size);
+  Status ReadBatch(const IoUringParallelFile::ReadRequest* requests, size_t num_requests);
+  std::future<std::pair<Status, std::string>> ReadAsync(int64_t off, size_t size);
+  Status Write(int64_t off, const void* buf, size_t size);
+  Status Append(const void* buf, size_t size, int64_t* off);
+  Status Truncate(int64_t size);
+  Status Synchronize(bool hard);
+  Status SynchronizeRange(int64_t off, int64_t size);
+  Status PunchHole(int64_t off, int64_t size);
+  Status GetSize(int64_t* size);
+  Status SetAllocationStrategy(int64_t init_size, double inc_factor);
+  bool IsIoUringEnabled() const;
+
+ private:
+  Status AdjustTruncSize(int64_t min_size);
+  Status DoOperations(IoUringOperation* ops, size_t num_ops);
+  void ReadPendingRequests();
+  void WaitAsyncReads();
+
+  // Asynchronous reading operation waiting for submission.
+  struct AsyncRead final {
+    int64_t off;
+    size_t size;
+    std::promise<std::pair<Status, std::string>> promise;
+  };
+
+  int32_t fd_;
+  std::atomic_int64_t file_size_;
+  std::atomic_int64_t trunc_size_;
+  bool writable_;
+  int32_t open_options_;
+  int64_t alloc_init_size_;
+  double alloc_inc_factor_;
+  std::mutex mutex_;
+  bool uring_enabled_;
+  IoUringQueue queues_[NUM_QUEUES];
+  std::mutex queue_mutexes_[NUM_QUEUES];
+  std::mutex async_mutex_;
+  std::vector<AsyncRead> async_reads_;
+  bool async_running_;
+  std::condition_variable async_cond_;
+};
+
+IoUringParallelFileImpl::IoUringParallelFileImpl()
+    : fd_(-1), file_size_(0), trunc_size_(0), writable_(false), open_options_(0),
+      alloc_init_size_(File::DEFAULT_ALLOC_INIT_SIZE),
+      alloc_inc_factor_(File::DEFAULT_ALLOC_INC_FACTOR), uring_enabled_(false),
+      async_running_(false) {}
+
+IoUringParallelFileImpl::~IoUringParallelFileImpl() {
+  WaitAsyncReads();
+  if (fd_ >= 0) {
+    Close();
+  }
+}
+
+Status IoUringParallelFileImpl::Open(const std::string& path, bool writable, int32_t options) {
+  if (fd_ >= 0) {
+    return Status(Status::PRECONDITION_ERROR, "opened file");
+  }
+
+  // Opens the file.
+  int32_t oflags = O_RDONLY;
+  if (writable) {
+    oflags = O_RDWR;
+    if (!(options & File::OPEN_NO_CREATE)) {
+      oflags |= O_CREAT;
+    }
+    if (options & File::OPEN_TRUNCATE) {
+      oflags |= O_TRUNC;
+    }
+  }
+  const int32_t fd = open(path.c_str(), oflags, FILEPERM);
+  if (fd < 0) {
+    return GetErrnoStatus("open", errno);
+  }
+
+  // Locks the file.
+  if (!(options & File::OPEN_NO_LOCK)) {
+    struct flock flbuf;
+    std::memset(&flbuf, 0, sizeof(flbuf));
+    flbuf.l_type = writable ? F_WRLCK : F_RDLCK;
+    flbuf.l_whence = SEEK_SET;
+    flbuf.l_start = 0;
+    flbuf.l_len = 0;
+    flbuf.l_pid = 0;
+    const int32_t flcmd = options & File::OPEN_NO_WAIT ? F_SETLK : F_SETLKW;
+    if (fcntl(fd, flcmd, &flbuf) != 0) {
+      const Status status = GetErrnoStatus("fcntl-lock", errno);
+      close(fd);
+      return status;
+    }
+  }
+
+  // Checks the file size and type.
+  struct stat sbuf;
+  if (fstat(fd, &sbuf) != 0) {
+    const Status status = GetErrnoStatus("fstat", errno);
+    close(fd);
+    return status;
+  }
+  if (!S_ISREG(sbuf.st_mode)) {
+    close(fd);
+    return Status(Status::INFEASIBLE_ERROR, "not a regular file");
+  }
+  const int64_t file_size = sbuf.st_size;
+  if (file_size > MAX_MEMORY_SIZE) {
+    close(fd);
+    return Status(Status::INFEASIBLE_ERROR, "too large file");
+  }
+
+  // Truncates the file.
+  int64_t trunc_size = file_size;
+  if (writable) {
+    trunc_size = std::max(trunc_size, alloc_init_size_);
+    const int64_t diff = trunc_size % PAGE_SIZE;
+    if (diff > 0) {
+      trunc_size += PAGE_SIZE - diff;
+    }
+    if (ftruncate(fd, trunc_size) != 0) {
+      const Status status = GetErrnoStatus("ftruncate", errno);
+      close(fd);
+      return status;
+    }
+    if (options & File::OPEN_PREALLOCATE) {
+      const Status status = AllocateFileSpace(fd, file_size, trunc_size - file_size, false);
+      if (status != Status::SUCCESS) {
+        close(fd);
+        return status;
+      }
+    }
+  }
+
+  // Sets up the first queue to check whether io_uring is available.  The other queues are set
+  // up lazily when they are used first.
+  uring_enabled_ = queues_[0].Open(fd) == Status::SUCCESS;
+
+  // Updates the internal data.
+  fd_ = fd;
+  file_size_.store(file_size);
+  trunc_size_.store(trunc_size);
+  writable_ = writable;
+  open_options_ = options;
+
+  return Status(Status::SUCCESS);
+}
+
+Status IoUringParallelFileImpl::Close() {
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  Status status(Status::SUCCESS);
+
+  // Finishes the outstanding asynchronous reads.
+  WaitAsyncReads();
+
+  // Closes the queues.
+  for (auto& queue : queues_) {
+    queue.Close();
+  }
+
+  // Truncates the file.
+  if (writable_ && ftruncate(fd_, file_size_.load()) != 0) {
+    status |= GetErrnoStatus("ftruncate", errno);
+  }
+
+  // Unlocks the file.
+  if (!(open_options_ & File::OPEN_NO_LOCK)) {
+    struct flock flbuf;
+    std::memset(&flbuf, 0, sizeof(flbuf));
+    flbuf.l_type = F_UNLCK;
+    flbuf.l_whence = SEEK_SET;
+    flbuf.l_start = 0;
+    flbuf.l_len = 0;
+    flbuf.l_pid = 0;
+    if (fcntl(fd_, F_SETLKW, &flbuf) != 0) {
+      status |= GetErrnoStatus("fcntl-unlock", errno);
+    }
+  }
+
+  // Close the file.
+  if (close(fd_) != 0) {
+    status |= GetErrnoStatus("close", errno);
+  }
+
+  // Updates the internal data.
+  fd_ = -1;
+  file_size_.store(0);
+  trunc_size_.store(0);
+  writable_ = false;
+  open_options_ = 0;
+  uring_enabled_ = false;
+
+  return status;
+}
+
+Status IoUringParallelFileImpl::Read(int64_t off, void* buf, size_t size) {
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  IoUringOperation op;
+  op.write = false;
+  op.off = off;
+  op.buf = static_cast<char*>(buf);
+  op.size = size;
+  return DoOperations(&op, 1);
+}
+
+Status IoUringParallelFileImpl::ReadBatch(
+    const IoUringParallelFile::ReadRequest* requests, size_t num_requests) {
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  std::vector<IoUringOperation> ops(num_requests);
+  for (size_t i = 0; i < num_requests; i++) {
+    auto& op = ops[i];
+    op.write = false;
+    op.off = requests[i].off;
+    op.buf = static_cast<char*>(requests[i].buf);
+    op.size = requests[i].size;
+  }
+  return DoOperations(ops.data(), ops.size());
+}
+
+std::future<std::pair<Status, std::string>> IoUringParallelFileImpl::ReadAsync(
+    int64_t off, size_t size) {
+  std::promise<std::pair<Status, std::string>> promise;
+  auto future = promise.get_future();
+  bool scheduled = false;
+  {
+    std::lock_guard<std::mutex> lock(async_mutex_);
+    async_reads_.emplace_back(AsyncRead{off, size, std::move(promise)});
+    if (!async_running_) {
+      async_running_ = true;
+      scheduled = true;
+    }
+  }
+  if (scheduled) {
+    TaskQueue::GetSharedIOQueue()->Add([this]() { ReadPendingRequests(); });
+  }
+  return future;
+}
+
+void IoUringParallelFileImpl::ReadPendingRequests() {
+  while (true) {
+    std::vector<AsyncRead> reads;
+    {
+      std::lock_guard<std::mutex> lock(async_mutex_);
+      if (async_reads_.empty()) {
+        async_running_ = false;
+        async_cond_.notify_all();
+        return;
+      }
+      reads.swap(async_reads_);
+    }
+    std::vector<std::string> bufs(reads.size());
+    std::vector<IoUringParallelFile::ReadRequest> requests(reads.size());
+    for (size_t i = 0; i < reads.size(); i++) {
+      bufs[i].resize(reads[i].size);
+      requests[i].off = reads[i].off;
+      requests[i].buf = const_cast<char*>(bufs[i].data());
+      requests[i].size = reads[i].size;
+    }
+    if (ReadBatch(requests.data(), requests.size()) == Status::SUCCESS) {
+      for (size_t i = 0; i < reads.size(); i++) {
+        reads[i].promise.set_value(std::make_pair(Status(Status::SUCCESS), std::move(bufs[i])));
+      }
+      continue;
+    }
+    for (size_t i = 0; i < reads.size(); i++) {
+      const Status status = Read(reads[i].off, requests[i].buf, reads[i].size);
+      if (status != Status::SUCCESS) {
+        bufs[i].clear();
+      }
+      reads[i].promise.set_value(std::make_pair(status, std::move(bufs[i])));
+    }
+  }
+}
+
+void IoUringParallelFileImpl::WaitAsyncReads() {
+  std::unique_lock<std::mutex> lock(async_mutex_);
+  async_cond_.wait(lock, [this]() { return !async_running_; });
+}
+
+Status IoUringParallelFileImpl::Write(int64_t off, const void* buf, size_t size) {
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  if (!writable_) {
+    return Status(Status::PRECONDITION_ERROR, "not writable file");
+  }
+  const int64_t end_position = off + size;
+  const Status status = AdjustTruncSize(end_position);
+  if (status != Status::SUCCESS) {
+    return status;
+  }
+  while (true) {
+    int64_t old_file_size = file_size_.load();
+    if (end_position <= old_file_size ||
+        file_size_.compare_exchange_weak(old_file_size, end_position)) {
+      break;
+    }
+  }
+  IoUringOperation op;
+  op.write = true;
+  op.off = off;
+  op.buf = const_cast<char*>(static_cast<const char*>(buf));
+  op.size = size;
+  return DoOperations(&op, 1);
+}
+
+Status IoUringParallelFileImpl::Append(const void* buf, size_t size, int64_t* off) {
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  if (!writable_) {
+    return Status(Status::PRECONDITION_ERROR, "not writable file");
+  }
+  int64_t position = 0;
+  while (true) {
+    position = file_size_.load();
+    const int64_t end_position = position + size;
+    const Status status = AdjustTruncSize(end_position);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+    if (file_size_.compare_exchange_weak(position, end_position)) {
+      break;
+    }
+  }
+  if (off != nullptr) {
+    *off = position;
+  }
+  if (buf != nullptr) {
+    IoUringOperation op;
+    op.write = true;
+    op.off = position;
+    op.buf = const_cast<char*>(static_cast<const char*>(buf));
+    op.size = size;
+    return DoOperations(&op, 1);
+  }
+  return Status(Status::SUCCESS);
+}
+
+Status IoUringParallelFileImpl::Truncate(int64_t size) {
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  if (!writable_) {
+    return Status(Status::PRECONDITION_ERROR, "not writable file");
+  }
+  int64_t new_trunc_size =
+      std::max(std::max(size, static_cast<int64_t>(PAGE_SIZE)), alloc_init_size_);
+  const int64_t diff = new_trunc_size % PAGE_SIZE;
+  if (diff > 0) {
+    new_trunc_size += PAGE_SIZE - diff;
+  }
+  if (ftruncate(fd_, new_trunc_size) != 0) {
+    return GetErrnoStatus("ftruncate", errno);
+  }
+  file_size_.store(size);
+  trunc_size_.store(new_trunc_size);
+  return Status(Status::SUCCESS);
+}
+
+Status IoUringParallelFileImpl::Synchronize(bool hard) {
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  if (!writable_) {
+    return Status(Status::PRECONDITION_ERROR, "not writable file");
+  }
+  Status status(Status::SUCCESS);
+  const int64_t old_trunc_size = trunc_size_.exchange(file_size_.load());
+  if (ftruncate(fd_, trunc_size_.load()) != 0) {
+    status |= GetErrnoStatus("ftruncate", errno);
+  }
+  if (open_options_ & File::OPEN_PREALLOCATE) {
+    // The blocks beyond the end are kept reserved for the data to be added later.
+    const int64_t trunc_size = trunc_size_.load();
+    status |= AllocateFileSpace(fd_, trunc_size, old_trunc_size - trunc_size, true);
+  }
+  if (hard && fsync(fd_) != 0) {
+    status |= GetErrnoStatus("fsync", errno);
+  }
+  return status;
+}
+
+Status IoUringParallelFileImpl::SynchronizeRange(int64_t off, int64_t size) {
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  if (!writable_) {
+    return Status(Status::PRECONDITION_ERROR, "not writable file");
+  }
+#if defined(_SYS_LINUX_)
+  if (fdatasync(fd_) != 0) {
+    return GetErrnoStatus("fdatasync", errno);
+  }
+#else
+  if (fsync(fd_) != 0) {
+    return GetErrnoStatus("fsync", errno);
+  }
+#endif
+  return Status(Status::SUCCESS);
+}
+
+Status IoUringParallelFileImpl::PunchHole(int64_t off, int64_t size) {
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  if (!writable_) {
+    return Status(Status::PRECONDITION_ERROR, "not writable file");
+  }
+  return PunchFileHole(fd_, off, size);
+}
+
+Status IoUringParallelFileImpl::GetSize(int64_t* size) {
+  if (fd_ < 0) {
+    return Status(Status::PRECONDITION_ERROR, "not opened file");
+  }
+  *size = file_size_.load();
+  return Status(Status::SUCCESS);
+}
+
+Status IoUringParallelFileImpl::SetAllocationStrategy(int64_t init_size, double inc_factor) {
+  if (fd_ >= 0) {
+    return Status(Status::PRECONDITION_ERROR, "alread opened file");
+  }
+  alloc_init_size_ = init_size;
+  alloc_inc_factor_ = inc_factor;
+  return Status(Status::SUCCESS);
+}
+
+bool IoUringParallelFileImpl::IsIoUringEnabled() const {
+  return uring_enabled_;
+}
+
+Status IoUringParallelFileImpl::AdjustTruncSize(int64_t min_size) {
+  if (min_size <= trunc_size_.load()) {
+    return Status(Status::SUCCESS);
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (min_size <= trunc_size_.load()) {
+    return Status(Status::SUCCESS);
+  }
+  int64_t new_trunc_size =
+      std::max(min_size, static_cast<int64_t>(trunc_size_.load() * alloc_inc_factor_));
+  const int64_t diff = new_trunc_size % PAGE_SIZE;
+  if (diff > 0) {
+    new_trunc_size += PAGE_SIZE - diff;
+  }
+  if (ftruncate(fd_, new_trunc_size) != 0) {
+    return GetErrnoStatus("ftruncate", errno);
+  }
+  if (open_options_ & File::OPEN_PREALLOCATE) {
+    const int64_t old_trunc_size = trunc_size_.load();
+    const Status status =
+        AllocateFileSpace(fd_, old_trunc_size, new_trunc_size - old_trunc_size, false);
+    if (status != Status::SUCCESS) {
+      return status;
+    }
+  }
+  trunc_size_.store(new_trunc_size);
+  return Status(Status::SUCCESS);
+}
+
+Status IoUringParallelFileImpl::DoOperations(IoUringOperation* ops, size_t num_ops) {
+  if (uring_enabled_) {
+    static std::atomic_uint32_t thread_count(0);
+    thread_local const int32_t queue_index = thread_count.fetch_add(1) % NUM_QUEUES;
+    std::lock_guard<std::mutex> lock(queue_mutexes_[queue_index]);
+    auto& queue = queues_[queue_index];
+    if (!queue.IsBroken() && (queue.IsOpen() || queue.Open(fd_) == Status::SUCCESS)) {
+      return queue.Submit(ops, num_ops);
+    }
+  }
+  return DoOperationsByPosition(fd_, ops, num_ops);
+}
+
+IoUringParallelFile::IoUringParallelFile() {
+  impl_ = new IoUringParallelFileImpl();
+}
+
+IoUringParallelFile::~IoUringParallelFile() {
+  delete impl_;
+}
+
+Status IoUringParallelFile::Open(const std::string& path, bool writable, int32_t options) {
+  return impl_->Open(path, writable, options);
+}
+
+Status IoUringParallelFile::Close() {
+  return impl_->Close();
+}
+
+Status IoUringParallelFile::Read(int64_t off, void* buf, size_t size) {
+  assert(off >= 0 && buf != nullptr);
+  return impl_->Read(off, buf, size);
+}
+
+Status IoUringParallelFile::ReadBatch(const ReadRequest* requests, size_t num_requests) {
+  assert(requests != nullptr || num_requests == 0);
+  return impl_->ReadBatch(requests, num_requests);
+}
+
+std::future<std::pair<Status, std::string>> IoUringParallelFile::ReadAsync(
+    int64_t off, size_t size) {
+  assert(off >= 0);
+  return impl_->ReadAsync(off, size);
+}
+
+Status IoUringParallelFile::ReadV(const ReadExtent* extents, size_t num_extents) {
+  assert(extents != nullptr || num_extents == 0);
+  return impl_->ReadBatch(extents, num_extents);
+}
+
+Status IoUringParallelFile::Write(int64_t off, const void* buf, size_t size) {
+  assert(off >= 0 && buf != nullptr && size <= MAX_MEMORY_SIZE);
+  return impl_->Write(off, buf, size);
+}
+
+Status IoUringParallelFile::Append(const void* buf, size_t size, int64_t* off) {
+  assert(buf != nullptr && size <= MAX_MEMORY_SIZE);
+  return impl_->Append(buf, size, off);
+}
+
+Status IoUringParallelFile::Expand(size_t inc_size, int64_t* old_size) {
+  assert(inc_size <= MAX_MEMORY_SIZE);
+  return impl_->Append(nullptr, inc_size, old_size);
+}
+
+Status IoUringParallelFile::Truncate(int64_t size) {
+  assert(size >= 0 && size <= MAX_MEMORY_SIZE);
+  return impl_->Truncate(size);
+}
+
+Status IoUringParallelFile::Synchronize(bool hard) {
+  return impl_->Synchronize(hard);
+}
+
+Status IoUringParallelFile::SynchronizeRange(int64_t off, int64_t size) {
+  return impl_->SynchronizeRange(off, size);
+}
+
+Status IoUringParallelFile::PunchHole(int64_t off, int64_t size) {
+  assert(off >= 0 && size >= 0);
+  return impl_->PunchHole(off, size);
+}
+
+Status IoUringParallelFile::GetSize(int64_t* size) {
+  assert(size != nullptr);
+  return impl_->GetSize(size);
+}
+
+Status IoUringParallelFile::SetAllocationStrategy(int64_t init_size, double inc_factor) {
+  assert(init_size > 0 && inc_factor > 0);
+  return impl_->SetAllocationStrategy(init_size, inc_factor);
+}
+
+bool IoUringParallelFile::IsIoUringEnabled() const {
+  return impl_->IsIoUringEnabled();
+}
+
+}  // namespace tkrzw
+
+// END OF FILE
@@ -0,0 +1,246 @@
+/*************************************************************************************************
+ * File implementation by io_uring
+ *
+ * Copyright 2020 Google LLC
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+ * except in compliance with the License.  You may obtain a copy of the License at
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software distributed under the
+ * License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied.  See the License for the specific language governing permissions
+ * and limitations under the License.
+ *************************************************************************************************/
+
+#ifndef _TKRZW_FILE_URING_H
+#define _TKRZW_FILE_URING_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <cinttypes>
+
+#include "tkrzw_file.h"
+#include "tkrzw_lib_common.h"
+
+namespace tkrzw {
+
+class IoUringParallelFileImpl;
+
+/**
+ * File implementation with asynchronous I/O by io_uring for parallel operations.
+ * @details Reading and writing operations are submitted to submission queues of io_uring which
+ * are shared by threads in a round-robin manner.  The file descriptor and a small bounce buffer
+ * are registered to each queue so that the kernel doesn't look them up on each operation.
+ * Several independent reads can be submitted with one system call by the ReadBatch method.  If
+ * the kernel doesn't support io_uring, operations are done by "pread" and "pwrite" instead.
+ * Reading and writing operations are thread-safe; Multiple threads can access the same file
+ * concurrently.  Other operations including Open, Close, Truncate, and Synchronize are not
+ * thread-safe.  Moreover, locking doesn't assure atomicity of reading and writing operations.
+ */
+class IoUringParallelFile final : public File {
+ public:
+  /**
+   * Default constructor
+   */
+  IoUringParallelFile();
+
+  /**
+   * Destructor.
+   */
+  virtual ~IoUringParallelFile();
+
+  /**
+   * Copy and assignment are disabled.
+   */
+  explicit IoUringParallelFile(const IoUringParallelFile& rhs) = delete;
+  IoUringParallelFile& operator =(const IoUringParallelFile& rhs) = delete;
+
+  /**
+   * Opens a file.
+   * @param path A path of the file.
+   * @param writable If true, the file is writable.  If false, it is read-only.
+   * @param options Bit-sum options.
+   * @return The result status.
+   * @details By default, exclusive locking against other processes is done for a writer and
+   * shared locking against other processes is done for a reader.
+   */
+  Status Open(const std::string& path, bool writable, int32_t options = OPEN_DEFAULT) override;
+
+  /**
+   * Closes the file.
+   * @return The result status.
+   */
+  Status Close() override;
+
+  /**
+   * Reads data.
+   * @param off The offset of a source region.
+   * @param buf The pointer to the destination buffer.
+   * @param size The size of the data to be read.
+   * @return The result status.
+   */
+  Status Read(int64_t off, void* buf, size_t size) override;
+
+  /**
+   * Request of a reading operation in a batch, which is the same as a read extent.
+   */
+  typedef ReadExtent ReadRequest;
+
+  /**
+   * Reads multiple regions at once.
+   * @param requests The pointer to the array of the requests.
+   * @param num_requests The number of the requests.
+   * @return The result status.  If any of the requests fails, an error is returned.
+   * @details The requests are submitted together and done in parallel by the kernel.
+   */
+  Status ReadBatch(const ReadRequest* requests, size_t num_requests);
+
+  /**
+   * Reads data of multiple regions.
+   * @param extents The pointer to the array of the extents.
+   * @param num_extents The number of the extents.
+   * @return The result status.
+   * @details This is the same as ReadBatch.
+   */
+  Status ReadV(const ReadExtent* extents, size_t num_extents) override;
+
+  /**
+   * Reads data asynchronously.
+   * @param off The offset of a source region.
+   * @param size The size of the data to be read.
+   * @return The future of a pair of the result status and the read data.  The data is empty on
+   * failure.
+   * @details Requests which are pending at the same time are submitted together by a worker
+   * thread of the shared I/O queue, so that many outstanding reads occupy only one thread.  If
+   * io_uring is not enabled, they are read by "pread" in the same way.  Closing or destructing
+   * the file waits for outstanding requests to be done.
+   */
+  std::future<std::pair<Status, std::string>> ReadAsync(int64_t off, size_t size) override;
+
+  /**
+   * Writes data.
+   * @param off The offset of the destination region.
+   * @param buf The pointer to the source buffer.
+   * @param size The size of the data to be written.
+   * @return The result status.
+   */
+  Status Write(int64_t off, const void* buf, size_t size) override;
+
+  /**
+   * Appends data at the end of the file.
+   * @param buf The pointer to the source buffer.
+   * @param size The size of the data to be written.
+   * @param off The pointer to an integer object to contain the offset at which the data has been
+   * put.  If it is nullptr, it is ignored.
+   * @return The result status.
+   */
+  Status Append(const void* buf, size_t size, int64_t* off = nullptr) override;
+
+  /**
+   * Expands the file size without writing data.
+   * @param inc_size The size to increment the file size by.
+   * @param old_size The pointer to an integer object to contain the old size of the file.
+   * put.  If it is nullptr, it is ignored.
+   * @return The result status.
+   */
+  Status Expand(size_t inc_size, int64_t* old_size = nullptr) override;
+
+  /**
+   * Truncates the file.
+   * @param size The new size of the file.
+   * @return The result status.
+   */
+  Status Truncate(int64_t size) override;
+
+  /**
+   * Synchronizes the content of the file to the file system.
+   * @param hard True to do physical synchronization with the hardware or false to do only
+   * logical synchronization with the file system.
+   * @return The result status.
+   * @details The pysical file size can be larger than the logical size in order to improve
+   * performance by reducing frequency of allocation.  Thus, you should call this function before
+   * accessing the file with external tools.
+   */
+  Status Synchronize(bool hard) override;
+
+  /**
+   * Synchronizes the content of a region of the file with the hardware.
+   * @param off The offset of the region.
+   * @param size The size of the region.  If it is negative, the region extends to the end of the
+   * file.
+   * @return The result status.
+   * @details As data is not buffered in the process, the whole data of the file is synchronized
+   * by "fdatasync".  The file size is not adjusted.
+   */
+  Status SynchronizeRange(int64_t off, int64_t size) override;
+
+  /**
+   * Releases storage blocks of a region of the file.
+   * @param off The offset of the region.
+   * @param size The size of the region.
+   * @return The result status.
+   * @details The file size is not changed and the region is read as zeros afterward.  Only
+   * blocks which are wholly inside the region are released.
+   */
+  Status PunchHole(int64_t off, int64_t size) override;
+
+  /**
+   * Gets the size of the file.
+   * @param size The pointer to an integer object to contain the result size.
+   * @return The result status.
+   */
+  Status GetSize(int64_t* size) override;
+
+  /**
+   * Sets allocation strategy.
+   * @param init_size An initial size of allocation.
+   * @param inc_factor A factor to increase the size of allocation.
+   * @return The result status.
+   * @details By default, the initial size is 1MB and the increasing factor is 2.  This method
+   * must be called before the file is opened.
+   */
+  Status SetAllocationStrategy(int64_t init_size, double inc_factor) override;
+
+  /**
+   * Checks whether operations are done by io_uring.
+   * @return True if operations are done by io_uring, or false if they fall back to positional
+   * access.
+   * @details This is meaningful only after the file is opened.
+   */
+  bool IsIoUringEnabled() const;
+
+  /**
+   * Checks whether operations are done by memory mapping.
+   * @return True if operations are done by memory mapping, or false if not.
+   */
+  bool IsMemoryMapping() const override {
+    return false;
+  }
+
+  /**
+   * Checks whether updating operations are atomic and thread-safe.
+   * @return Always false.  Atomicity is not assured.  Some operations are not thread-safe.
+   */
+  bool IsAtomic() const override {
+    return false;
+  }
+
+  /**
+   * Makes a new file object of the same concrete class.
+   * @return The new file object.
+   */
+  std::unique_ptr<File> MakeFile() const override {
+    return std::make_unique<IoUringParallelFile>();
+  }
+
+ private:
+  /** Pointer to the actual implementation. */
+  IoUringParallelFileImpl* impl_;
+};
+
+}  // namespace tkrzw
+
+#endif  // _TKRZW_FILE_URING_H
+
+// END OF FILE
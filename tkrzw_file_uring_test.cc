@@ -0,0 +1,156 @@
+/*************************************************************************************************
+ * Tests for tkrzw_file_uring.h
+ *
+ * Copyright 2020 Google LLC
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file
+ * except in compliance with the License.  You may obtain a copy of the License at
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software distributed under the
+ * License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied.  See the License for the specific language governing permissions
+ * and limitations under the License.
+ *************************************************************************************************/
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include "tkrzw_file.h"
+#include "tkrzw_file_test_common.h"
+#include "tkrzw_file_uring.h"
+#include "tkrzw_file_util.h"
+#include "tkrzw_lib_common.h"
+#include "tkrzw_sys_config.h"
+
+using namespace testing;
+
+// Main routine
+int main(int argc, char** argv) {
+  InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+class IoUringParallelFileTest : public CommonFileTest<tkrzw::IoUringParallelFile> {};
+
+TEST_F(IoUringParallelFileTest, Attributes) {
+  tkrzw::IoUringParallelFile file;
+  EXPECT_FALSE(file.IsMemoryMapping());
+  EXPECT_FALSE(file.IsAtomic());
+}
+
+TEST_F(IoUringParallelFileTest, EmptyFile) {
+  EmptyFileTest();
+}
+
+TEST_F(IoUringParallelFileTest, SimpleRead) {
+  SimpleReadTest();
+}
+
+TEST_F(IoUringParallelFileTest, SimpleWrite) {
+  SimpleWriteTest();
+}
+
+TEST_F(IoUringParallelFileTest, ReallocWrite) {
+  ReallocWriteTest();
+}
+
+TEST_F(IoUringParallelFileTest, ImplicitClose) {
+  ImplicitCloseTest();
+}
+
+TEST_F(IoUringParallelFileTest, OpenOptions) {
+  OpenOptionsTest();
+}
+
+TEST_F(IoUringParallelFileTest, OrderedThread) {
+  OrderedThreadTest();
+}
+
+TEST_F(IoUringParallelFileTest, RandomThread) {
+  RandomThreadTest();
+}
+
+TEST_F(IoUringParallelFileTest, FileReader) {
+  FileReaderTest();
+}
+
+TEST_F(IoUringParallelFileTest, FlatRecord) {
+  FlatRecordTest();
+}
+
+TEST_F(IoUringParallelFileTest, VectorIO) {
+  VectorIOTest();
+}
+
+TEST_F(IoUringParallelFileTest, AsyncRead) {
+  AsyncReadTest();
+}
+
+TEST_F(IoUringParallelFileTest, SynchronizeRange) {
+  SynchronizeRangeTest();
+}
+
+TEST_F(IoUringParallelFileTest, CloseWithAsyncReads) {
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string file_path = tmp_dir.MakeUniquePath();
+  constexpr int32_t num_records = 1000;
+  constexpr int32_t record_size = 10;
+  std::string content;
+  for (int32_t i = 0; i < num_records; i++) {
+    content.append(tkrzw::SPrintF("%010d", i));
+  }
+  EXPECT_EQ(tkrzw::Status::SUCCESS, tkrzw::WriteFile(file_path, content));
+  for (const bool destruct : {false, true}) {
+    std::vector<std::future<std::pair<tkrzw::Status, std::string>>> futures;
+    {
+      tkrzw::IoUringParallelFile file;
+      EXPECT_EQ(tkrzw::Status::SUCCESS, file.Open(file_path, false));
+      for (int32_t i = 0; i < num_records; i++) {
+        futures.emplace_back(file.ReadAsync(i * record_size, record_size));
+      }
+      if (!destruct) {
+        EXPECT_EQ(tkrzw::Status::SUCCESS, file.Close());
+      }
+    }
+    for (int32_t i = 0; i < num_records; i++) {
+      EXPECT_EQ(std::future_status::ready, futures[i].wait_for(std::chrono::seconds(0)));
+      const auto result = futures[i].get();
+      EXPECT_EQ(tkrzw::Status::SUCCESS, result.first);
+      EXPECT_EQ(tkrzw::SPrintF("%010d", i), result.second);
+    }
+  }
+}
+
+TEST_F(IoUringParallelFileTest, Allocation) {
+  AllocationTest();
+}
+
+TEST_F(IoUringParallelFileTest, ReadBatch) {
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string file_path = tmp_dir.MakeUniquePath();
+  tkrzw::IoUringParallelFile file;
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Open(file_path, true));
+  constexpr int32_t num_records = 200;
+  constexpr int32_t record_size = 1000;
+  for (int32_t i = 0; i < num_records; i++) {
+    const std::string data(record_size, 'a' + i % 26);
+    EXPECT_EQ(tkrzw::Status::SUCCESS, file.Write(i * record_size, data.data(), data.size()));
+  }
+  std::vector<std::string> bufs(num_records, std::string(record_size, 0));
+  std::vector<tkrzw::IoUringParallelFile::ReadRequest> requests;
+  for (int32_t i = num_records - 1; i >= 0; i--) {
+    requests.push_back({i * record_size, bufs[i].data(), record_size});
+  }
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.ReadBatch(requests.data(), requests.size()));
+  for (int32_t i = 0; i < num_records; i++) {
+    EXPECT_EQ(std::string(record_size, 'a' + i % 26), bufs[i]);
+  }
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.ReadBatch(nullptr, 0));
+  char buf[8];
+  requests = {{0, buf, sizeof(buf)}, {1LL << 30, buf, sizeof(buf)}};
+  EXPECT_EQ(tkrzw::Status::INFEASIBLE_ERROR, file.ReadBatch(requests.data(), requests.size()));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, file.Close());
+  EXPECT_EQ(tkrzw::Status::PRECONDITION_ERROR, file.ReadBatch(requests.data(), 1));
+  EXPECT_FALSE(file.IsIoUringEnabled());
+}
+
+// END OF FILE
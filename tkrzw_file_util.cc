@@ -382,6 +382,45 @@ Status RemoveDirectory(const std::string& path, bool recursive) {
   return status;
 }
 
+Status AllocateFileSpace(int32_t fd, int64_t off, int64_t size, bool keep_size) {
+  if (size <= 0) {
+    return Status(Status::SUCCESS);
+  }
+#if defined(_SYS_LINUX_)
+  const int32_t mode = keep_size ? FALLOC_FL_KEEP_SIZE : 0;
+  while (fallocate(fd, mode, off, size) != 0) {
+    if (errno == EINTR) {
+      continue;
+    }
+    if (errno == EOPNOTSUPP || errno == ENOSYS) {
+      break;
+    }
+    return GetErrnoStatus("fallocate", errno);
+  }
+#endif
+  return Status(Status::SUCCESS);
+}
+
+Status PunchFileHole(int32_t fd, int64_t off, int64_t size) {
+  if (size <= 0) {
+    return Status(Status::SUCCESS);
+  }
+#if defined(_SYS_LINUX_)
+  while (fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, off, size) != 0) {
+    if (errno == EINTR) {
+      continue;
+    }
+    if (errno == EOPNOTSUPP || errno == ENOSYS) {
+      return Status(Status::NOT_IMPLEMENTED_ERROR);
+    }
+    return GetErrnoStatus("fallocate", errno);
+  }
+  return Status(Status::SUCCESS);
+#else
+  return Status(Status::NOT_IMPLEMENTED_ERROR);
+#endif
+}
+
 TemporaryDirectory::TemporaryDirectory(
     bool cleanup, const std::string& prefix, const std::string& base_dir)
     : cleanup_(cleanup) {
@@ -423,6 +462,61 @@ Status TemporaryDirectory::CleanUp() const {
   return status;
 }
 
+PrivateMemoryMap::PrivateMemoryMap() : ptr_(nullptr), size_(0) {}
+
+PrivateMemoryMap::~PrivateMemoryMap() {
+  if (ptr_ != nullptr) {
+    Close();
+  }
+}
+
+Status PrivateMemoryMap::Open(const std::string& path) {
+  if (ptr_ != nullptr) {
+    return Status(Status::PRECONDITION_ERROR, "opened map");
+  }
+  const int32_t fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return GetErrnoStatus("open", errno);
+  }
+  struct stat sbuf;
+  if (fstat(fd, &sbuf) != 0) {
+    const Status status = GetErrnoStatus("fstat", errno);
+    close(fd);
+    return status;
+  }
+  if (sbuf.st_size < 1) {
+    close(fd);
+    return Status(Status::INFEASIBLE_ERROR, "empty file");
+  }
+  void* map = mmap(0, sbuf.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  if (map == MAP_FAILED) {
+    const Status status = GetErrnoStatus("mmap", errno);
+    close(fd);
+    return status;
+  }
+  if (close(fd) != 0) {
+    const Status status = GetErrnoStatus("close", errno);
+    munmap(map, sbuf.st_size);
+    return status;
+  }
+  ptr_ = static_cast<char*>(map);
+  size_ = sbuf.st_size;
+  return Status(Status::SUCCESS);
+}
+
+Status PrivateMemoryMap::Close() {
+  if (ptr_ == nullptr) {
+    return Status(Status::PRECONDITION_ERROR, "not opened map");
+  }
+  Status status(Status::SUCCESS);
+  if (munmap(ptr_, size_) != 0) {
+    status |= GetErrnoStatus("munmap", errno);
+  }
+  ptr_ = nullptr;
+  size_ = 0;
+  return status;
+}
+
 FileReader::FileReader(File* file) : file_(file), offset_(0), data_size_(0), index_(0) {}
 
 Status FileReader::ReadLine(std::string* str, size_t max_size) {
@@ -460,6 +554,135 @@ Status FileReader::ReadLine(std::string* str, size_t max_size) {
   return Status(Status::NOT_FOUND_ERROR);
 }
 
+ScopedFileAdvice::ScopedFileAdvice(
+    File* file, int64_t off, int64_t size, File::AccessAdvice advice,
+    File::AccessAdvice restored_advice)
+    : file_(file), off_(off), size_(size), restored_advice_(restored_advice) {
+  file_->Advise(off_, size_, advice);
+}
+
+ScopedFileAdvice::~ScopedFileAdvice() {
+  file_->Advise(off_, size_, restored_advice_);
+}
+
+struct DirtyRangeSet::Shard final {
+  std::mutex mutex;
+  std::vector<Range> ranges;
+};
+
+DirtyRangeSet::DirtyRangeSet(int32_t num_shards) : num_shards_(num_shards) {
+  assert(num_shards > 0);
+  shards_ = new Shard[num_shards];
+}
+
+DirtyRangeSet::~DirtyRangeSet() {
+  delete[] shards_;
+}
+
+void DirtyRangeSet::Add(int64_t off, int64_t size) {
+  assert(off >= 0 && size >= 0);
+  if (size == 0) {
+    return;
+  }
+  const size_t shard_index =
+      std::hash<std::thread::id>()(std::this_thread::get_id()) % num_shards_;
+  Shard& shard = shards_[shard_index];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  if (!shard.ranges.empty()) {
+    auto& last = shard.ranges.back();
+    const int64_t end = off + size;
+    const int64_t last_end = last.first + last.second;
+    if (off <= last_end && end >= last.first) {
+      last.first = std::min(last.first, off);
+      last.second = std::max(last_end, end) - last.first;
+      return;
+    }
+  }
+  shard.ranges.emplace_back(off, size);
+  if (shard.ranges.size() > MAX_SHARD_RANGES) {
+    Compact(&shard.ranges);
+  }
+}
+
+std::vector<DirtyRangeSet::Range> DirtyRangeSet::Extract(int64_t off, int64_t size) {
+  assert(off >= 0);
+  const int64_t end = size < 0 ? INT64MAX : off + size;
+  std::vector<Range> ranges;
+  for (int32_t i = 0; i < num_shards_; i++) {
+    Shard& shard = shards_[i];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    ranges.insert(ranges.end(), shard.ranges.begin(), shard.ranges.end());
+    shard.ranges.clear();
+  }
+  Normalize(&ranges);
+  std::vector<Range> extracted, rests;
+  for (const auto& range : ranges) {
+    const int64_t range_end = range.first + range.second;
+    const int64_t inner_off = std::max(range.first, off);
+    const int64_t inner_end = std::min(range_end, end);
+    if (inner_off >= inner_end) {
+      rests.emplace_back(range);
+      continue;
+    }
+    extracted.emplace_back(inner_off, inner_end - inner_off);
+    if (range.first < inner_off) {
+      rests.emplace_back(range.first, inner_off - range.first);
+    }
+    if (inner_end < range_end) {
+      rests.emplace_back(inner_end, range_end - inner_end);
+    }
+  }
+  if (!rests.empty()) {
+    Shard& shard = shards_[0];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.ranges.insert(shard.ranges.end(), rests.begin(), rests.end());
+    if (shard.ranges.size() > MAX_SHARD_RANGES) {
+      Compact(&shard.ranges);
+    }
+  }
+  return extracted;
+}
+
+void DirtyRangeSet::Clear() {
+  for (int32_t i = 0; i < num_shards_; i++) {
+    Shard& shard = shards_[i];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.ranges.clear();
+  }
+}
+
+void DirtyRangeSet::Normalize(std::vector<Range>* ranges) {
+  if (ranges->empty()) {
+    return;
+  }
+  std::sort(ranges->begin(), ranges->end());
+  size_t num_merged = 0;
+  for (size_t i = 1; i < ranges->size(); i++) {
+    auto& last = (*ranges)[num_merged];
+    const auto& range = (*ranges)[i];
+    const int64_t last_end = last.first + last.second;
+    if (range.first <= last_end) {
+      last.second = std::max(last_end, range.first + range.second) - last.first;
+    } else {
+      (*ranges)[++num_merged] = range;
+    }
+  }
+  ranges->resize(num_merged + 1);
+}
+
+void DirtyRangeSet::Compact(std::vector<Range>* ranges) {
+  Normalize(ranges);
+  // Unless merging halves the regions, they are collapsed so that sorting is not repeated
+  // on every addition.
+  if (ranges->size() > MAX_SHARD_RANGES / 2) {
+    const int64_t off = ranges->front().first;
+    const int64_t end = ranges->back().first + ranges->back().second;
+    ranges->clear();
+    ranges->shrink_to_fit();
+    ranges->emplace_back(off, end - off);
+  }
+}
+
 FlatRecord::FlatRecord(File* file) :
     file_(file), offset_(0), whole_size_(0),
     data_ptr_(nullptr), data_size_(0), body_buf_(nullptr) {}
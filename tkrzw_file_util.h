@@ -15,8 +15,10 @@
 #define _TKRZW_FILE_UTIL_H
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include <cinttypes>
@@ -188,6 +190,29 @@ Status MakeDirectory(const std::string& path, bool recursive = false);
  */
 Status RemoveDirectory(const std::string& path, bool recursive = false);
 
+/**
+ * Allocates storage blocks of a region of an opened file.
+ * @param fd The file descriptor.
+ * @param off The offset of the region.
+ * @param size The size of the region.
+ * @param keep_size If true, the file size is not changed even if the region exceeds the end.
+ * @return The result status.
+ * @details If the file system doesn't support allocation, nothing is done and success is
+ * returned.  Allocated blocks beyond the end are released when the file is truncated.
+ */
+Status AllocateFileSpace(int32_t fd, int64_t off, int64_t size, bool keep_size);
+
+/**
+ * Releases storage blocks of a region of an opened file.
+ * @param fd The file descriptor.
+ * @param off The offset of the region.
+ * @param size The size of the region.
+ * @return The result status.
+ * @details The file size is not changed and the region is read as zeros afterward.  If the
+ * file system doesn't support releasing, NOT_IMPLEMENTED_ERROR is returned.
+ */
+Status PunchFileHole(int32_t fd, int64_t off, int64_t size);
+
 /**
  * Temporary directory whose life duration is bound with the object.
  */
@@ -241,6 +266,75 @@ class TemporaryDirectory {
   Status creation_status_;
 };
 
+/**
+ * Private memory mapping of a whole file.
+ * @details The region is readable and writable, but modifications are not written back to the
+ * file.  Each page is loaded when it is accessed first and it is copied when it is modified
+ * first.  Renaming or removing the file doesn't affect the region.
+ */
+class PrivateMemoryMap final {
+ public:
+  /**
+   * Default constructor.
+   */
+  PrivateMemoryMap();
+
+  /**
+   * Destructor.
+   */
+  ~PrivateMemoryMap();
+
+  /**
+   * Copy and assignment are disabled.
+   */
+  explicit PrivateMemoryMap(const PrivateMemoryMap& rhs) = delete;
+  PrivateMemoryMap& operator =(const PrivateMemoryMap& rhs) = delete;
+
+  /**
+   * Maps a file.
+   * @param path A path of the file.
+   * @return The result status.
+   */
+  Status Open(const std::string& path);
+
+  /**
+   * Unmaps the file.
+   * @return The result status.
+   */
+  Status Close();
+
+  /**
+   * Gets the pointer to the mapped region.
+   * @return The pointer to the mapped region or nullptr if no file is mapped.
+   */
+  char* Pointer() const {
+    return ptr_;
+  }
+
+  /**
+   * Gets the size of the mapped region.
+   * @return The size of the mapped region.
+   */
+  int64_t Size() const {
+    return size_;
+  }
+
+  /**
+   * Checks whether an address is in the mapped region.
+   * @param ptr The address to check.
+   * @return True if the address is in the mapped region.
+   */
+  bool Contains(const void* ptr) const {
+    return ptr >= ptr_ && ptr < ptr_ + size_;
+  }
+
+ private:
+  /** The pointer to the mapped region. */
+  char* ptr_;
+  /** The size of the mapped region. */
+  int64_t size_;
+};
+
 /**
  * File reader.
  */
@@ -275,6 +369,118 @@ class FileReader {
   size_t index_;
 };
 
+/**
+ * Scoped advice about the access pattern of a region of a file.
+ * @details The advice is given by the constructor and another advice is given by the destructor
+ * to restore the usual access pattern.  Failures are ignored because advice is only a hint.
+ */
+class ScopedFileAdvice final {
+ public:
+  /**
+   * Constructor.
+   * @param file A file object to advise.  Ownership is not taken.
+   * @param off The offset of the region.
+   * @param size The size of the region.  If it is negative, the region extends to the end of the
+   * file.
+   * @param advice The advice given while this object is alive.
+   * @param restored_advice The advice given when this object is destroyed.
+   */
+  ScopedFileAdvice(File* file, int64_t off, int64_t size, File::AccessAdvice advice,
+                   File::AccessAdvice restored_advice);
+
+  /**
+   * Destructor.
+   */
+  ~ScopedFileAdvice();
+
+  /**
+   * Copy and assignment are disabled.
+   */
+  explicit ScopedFileAdvice(const ScopedFileAdvice& rhs) = delete;
+  ScopedFileAdvice& operator =(const ScopedFileAdvice& rhs) = delete;
+
+ private:
+  /** The file object, unowned. */
+  File* file_;
+  /** The offset of the region. */
+  int64_t off_;
+  /** The size of the region. */
+  int64_t size_;
+  /** The advice to restore. */
+  File::AccessAdvice restored_advice_;
+};
+
+/**
+ * Set of regions of a file which have been modified since the last synchronization.
+ * @details Regions are recorded in shards chosen by the calling thread so that concurrent
+ * writers rarely contend.  Overlapping and adjacent regions are merged.  If a shard has too
+ * many disjoint regions, they are collapsed into one region covering all of them, so memory
+ * usage is bounded even if the set is never extracted.
+ */
+class DirtyRangeSet final {
+ public:
+  /** Pair of the offset and the size of a region. */
+  typedef std::pair<int64_t, int64_t> Range;
+  /** The maximum number of regions kept in each shard. */
+  static constexpr size_t MAX_SHARD_RANGES = 1024;
+
+  /**
+   * Constructor.
+   * @param num_shards The number of shards.
+   */
+  explicit DirtyRangeSet(int32_t num_shards = 16);
+
+  /**
+   * Destructor.
+   */
+  ~DirtyRangeSet();
+
+  /**
+   * Copy and assignment are disabled.
+   */
+  explicit DirtyRangeSet(const DirtyRangeSet& rhs) = delete;
+  DirtyRangeSet& operator =(const DirtyRangeSet& rhs) = delete;
+
+  /**
+   * Adds a modified region.
+   * @param off The offset of the region.
+   * @param size The size of the region.
+   */
+  void Add(int64_t off, int64_t size);
+
+  /**
+   * Removes the modified regions which overlap a region and returns them.
+   * @param off The offset of the region.
+   * @param size The size of the region.  If it is negative, the region extends to the end of the
+   * file.
+   * @return The merged regions in ascending order of the offset, which are clipped to the given
+   * region.  Parts outside the given region are kept in the set.
+   */
+  std::vector<Range> Extract(int64_t off = 0, int64_t size = -1);
+
+  /**
+   * Removes all regions.
+   */
+  void Clear();
+
+ private:
+  /** The shard of regions. */
+  struct Shard;
+  /**
+   * Sorts regions and merges overlapping and adjacent ones.
+   */
+  static void Normalize(std::vector<Range>* ranges);
+  /**
+   * Reduces regions of a shard which has exceeded the limit.
+   */
+  static void Compact(std::vector<Range>* ranges);
+
+  /** The number of the shards. */
+  int32_t num_shards_;
+  /** The array of the shards. */
+  Shard* shards_;
+};
+
 /**
  * Flat record structure in the file.
  */
@@ -17,6 +17,7 @@
 #include "tkrzw_file_util.h"
 #include "tkrzw_lib_common.h"
 #include "tkrzw_sys_config.h"
+#include "tkrzw_thread_util.h"
 
 using namespace testing;
 
@@ -248,4 +249,106 @@ TEST(FileUtilTest, TemporaryDirectory) {
   EXPECT_EQ(tkrzw::Status::SUCCESS, tkrzw::RemoveDirectory(tmp_path, true));
 }
 
+TEST(FileUtilTest, PrivateMemoryMap) {
+  tkrzw::TemporaryDirectory tmp_dir(true, "tkrzw-");
+  const std::string file_path = tmp_dir.MakeUniquePath();
+  const std::string new_path = tmp_dir.MakeUniquePath();
+  tkrzw::PrivateMemoryMap map;
+  EXPECT_EQ(tkrzw::Status::NOT_FOUND_ERROR, map.Open(file_path));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, tkrzw::WriteFile(file_path, ""));
+  EXPECT_EQ(tkrzw::Status::INFEASIBLE_ERROR, map.Open(file_path));
+  EXPECT_EQ(nullptr, map.Pointer());
+  EXPECT_EQ(tkrzw::Status::SUCCESS, tkrzw::WriteFile(file_path, "abcdefgh"));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, map.Open(file_path));
+  EXPECT_EQ(tkrzw::Status::PRECONDITION_ERROR, map.Open(file_path));
+  EXPECT_EQ(8, map.Size());
+  EXPECT_EQ("abcdefgh", std::string_view(map.Pointer(), map.Size()));
+  EXPECT_TRUE(map.Contains(map.Pointer()));
+  EXPECT_TRUE(map.Contains(map.Pointer() + 7));
+  EXPECT_FALSE(map.Contains(map.Pointer() + 8));
+  std::memcpy(map.Pointer(), "ABCD", 4);
+  EXPECT_EQ("ABCDefgh", std::string_view(map.Pointer(), map.Size()));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, tkrzw::WriteFile(new_path, "01234567"));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, tkrzw::RenameFile(new_path, file_path));
+  EXPECT_EQ("ABCDefgh", std::string_view(map.Pointer(), map.Size()));
+  EXPECT_EQ(tkrzw::Status::SUCCESS, map.Close());
+  EXPECT_EQ(tkrzw::Status::PRECONDITION_ERROR, map.Close());
+  std::string content;
+  EXPECT_EQ(tkrzw::Status::SUCCESS, tkrzw::ReadFile(file_path, &content));
+  EXPECT_EQ("01234567", content);
+}
+
+TEST(FileUtilTest, DirtyRangeSet) {
+  typedef tkrzw::DirtyRangeSet::Range Range;
+  tkrzw::DirtyRangeSet ranges(4);
+  EXPECT_THAT(ranges.Extract(), ElementsAre());
+  ranges.Add(100, 10);
+  ranges.Add(110, 5);
+  ranges.Add(105, 20);
+  ranges.Add(0, 10);
+  ranges.Add(200, 0);
+  ranges.Add(50, 10);
+  ranges.Add(55, 10);
+  EXPECT_THAT(ranges.Extract(),
+              ElementsAre(Range(0, 10), Range(50, 15), Range(100, 25)));
+  EXPECT_THAT(ranges.Extract(), ElementsAre());
+  ranges.Add(0, 100);
+  ranges.Add(200, 100);
+  EXPECT_THAT(ranges.Extract(50, 200), ElementsAre(Range(50, 50), Range(200, 50)));
+  EXPECT_THAT(ranges.Extract(0, 10), ElementsAre(Range(0, 10)));
+  EXPECT_THAT(ranges.Extract(), ElementsAre(Range(10, 40), Range(250, 50)));
+  constexpr int32_t num_threads = 4;
+  constexpr int32_t num_iterations = 5000;
+  std::vector<std::thread> threads;
+  for (int32_t i = 0; i < num_threads; i++) {
+    threads.emplace_back([&, i]() {
+      for (int32_t j = 0; j < num_iterations; j++) {
+        ranges.Add((j * num_threads + i) * 10, 10);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_THAT(ranges.Extract(), ElementsAre(Range(0, num_threads * num_iterations * 10)));
+  ranges.Add(10, 10);
+  ranges.Clear();
+  EXPECT_THAT(ranges.Extract(), ElementsAre());
+}
+
+TEST(FileUtilTest, DirtyRangeSetScattered) {
+  typedef tkrzw::DirtyRangeSet::Range Range;
+  constexpr int32_t num_shards = 4;
+  constexpr int32_t num_ranges = 200000;
+  tkrzw::DirtyRangeSet ranges(num_shards);
+  const double start_time = tkrzw::GetWallTime();
+  for (int32_t i = 0; i < num_ranges; i++) {
+    ranges.Add((i * 7919LL % num_ranges) * 100, 10);
+  }
+  for (int32_t i = 0; i < num_ranges; i++) {
+    ranges.Add(i * 100LL + 50, 10);
+  }
+  EXPECT_LT(tkrzw::GetWallTime() - start_time, 10.0);
+  const std::vector<Range> extracted = ranges.Extract();
+  EXPECT_LE(extracted.size(), num_shards * tkrzw::DirtyRangeSet::MAX_SHARD_RANGES);
+  for (int32_t i = 0; i < num_ranges; i += 97) {
+    for (const int64_t off : {i * 100LL, i * 100LL + 50}) {
+      bool covered = false;
+      for (const auto& range : extracted) {
+        if (off >= range.first && off + 10 <= range.first + range.second) {
+          covered = true;
+          break;
+        }
+      }
+      EXPECT_TRUE(covered);
+    }
+  }
+  EXPECT_THAT(ranges.Extract(), ElementsAre());
+  for (int32_t i = 0; i < num_ranges; i++) {
+    ranges.Add(i * 100LL, 10);
+  }
+  EXPECT_THAT(ranges.Extract(100, 1000), ElementsAre(Range(100, 1000)));
+  EXPECT_LE(ranges.Extract().size(), num_shards * tkrzw::DirtyRangeSet::MAX_SHARD_RANGES);
+}
+
 // END OF FILE
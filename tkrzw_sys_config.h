@@ -88,15 +88,20 @@
 #include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <fstream>
 #include <functional>
+#include <future>
 #include <initializer_list>
 #include <limits>
 #include <list>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <memory_resource>
 #include <mutex>
+#include <optional>
 #include <random>
 #include <regex>
 #include <set>
@@ -106,6 +111,7 @@
 #include <string_view>
 #include <thread>
 #include <tuple>
+#include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -131,10 +137,19 @@ extern "C" {
 #include <sys/times.h>
 #include <sys/wait.h>
 #include <sys/resource.h>
+#include <sys/uio.h>
 #include <fcntl.h>
 #include <dirent.h>
 }  // extern "C"
 
+#if defined(__SSE2__)
+#define _TKRZW_SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#define _TKRZW_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
 namespace tkrzw {
 
 /**
@@ -28,6 +28,36 @@ void Sleep(double sec) {
   std::this_thread::sleep_for(std::chrono::microseconds(static_cast<int64_t>(sec * 1000000)));
 }
 
+void ParallelFor(int32_t num_tasks, int32_t num_threads,
+                 const std::function<void(int32_t)>& task) {
+  num_threads = std::min(num_threads, num_tasks);
+  if (num_threads <= 1) {
+    for (int32_t index = 0; index < num_tasks; index++) {
+      task(index);
+    }
+    return;
+  }
+  std::atomic_int32_t next_index(0);
+  auto worker = [&]() {
+    while (true) {
+      const int32_t index = next_index.fetch_add(1);
+      if (index >= num_tasks) {
+        break;
+      }
+      task(index);
+    }
+  };
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads - 1);
+  for (int32_t i = 1; i < num_threads; i++) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
 SlottedMutex::SlottedMutex(int32_t num_slots) : num_slots_(num_slots) {
   assert(num_slots > 0);
   slots_ = new std::shared_timed_mutex[num_slots];
@@ -283,6 +313,187 @@ int64_t ScopedHashLock::GetBucketIndex() const {
   return bucket_index_;
 }
 
+constexpr int32_t EPOCH_NUM_RETIRE_SHARDS = 16;
+constexpr int32_t EPOCH_RECLAIM_THRESHOLD = 64;
+
+struct alignas(64) EpochReclaimer::ReaderSlot final {
+  std::atomic_uint64_t epoch{0};
+};
+
+struct alignas(64) EpochReclaimer::RetireShard final {
+  struct Retired final {
+    void* ptr;
+    Deleter deleter;
+    uint64_t epoch;
+  };
+  std::mutex mutex;
+  std::vector<Retired> retired;
+};
+
+static int32_t GetThreadSlotSeed() {
+  static thread_local int32_t seed =
+      std::hash<std::thread::id>()(std::this_thread::get_id()) & INT32MAX;
+  return seed;
+}
+
+EpochReclaimer::EpochReclaimer(int32_t num_slots) : num_slots_(num_slots), epoch_(1) {
+  assert(num_slots > 0);
+  reader_slots_ = new ReaderSlot[num_slots];
+  retire_shards_ = new RetireShard[EPOCH_NUM_RETIRE_SHARDS];
+}
+
+EpochReclaimer::~EpochReclaimer() {
+  for (int32_t i = 0; i < EPOCH_NUM_RETIRE_SHARDS; i++) {
+    for (const auto& retired : retire_shards_[i].retired) {
+      retired.deleter(retired.ptr);
+    }
+  }
+  delete[] retire_shards_;
+  delete[] reader_slots_;
+}
+
+int32_t EpochReclaimer::Enter() {
+  const uint64_t epoch = epoch_.load();
+  const int32_t seed = GetThreadSlotSeed();
+  for (int32_t i = 0; i < num_slots_; i++) {
+    const int32_t slot_index = (seed + i) % num_slots_;
+    auto& slot_epoch = reader_slots_[slot_index].epoch;
+    uint64_t expected = 0;
+    if (slot_epoch.load(std::memory_order_relaxed) == 0 &&
+        slot_epoch.compare_exchange_strong(expected, epoch)) {
+      return slot_index;
+    }
+  }
+  return -1;
+}
+
+void EpochReclaimer::Leave(int32_t slot_index) {
+  assert(slot_index >= 0 && slot_index < num_slots_);
+  reader_slots_[slot_index].epoch.store(0, std::memory_order_release);
+}
+
+void EpochReclaimer::Retire(void* ptr, Deleter deleter) {
+  RetireShard* shard = retire_shards_ + GetThreadSlotSeed() % EPOCH_NUM_RETIRE_SHARDS;
+  std::lock_guard<std::mutex> lock(shard->mutex);
+  shard->retired.emplace_back(RetireShard::Retired{ptr, deleter, epoch_.load()});
+  if (static_cast<int32_t>(shard->retired.size()) >= EPOCH_RECLAIM_THRESHOLD) {
+    Reclaim(shard);
+  }
+}
+
+void EpochReclaimer::Synchronize() {
+  const uint64_t epoch = epoch_.fetch_add(1) + 1;
+  for (int32_t i = 0; i < num_slots_; i++) {
+    while (true) {
+      const uint64_t slot_epoch = reader_slots_[i].epoch.load();
+      if (slot_epoch == 0 || slot_epoch >= epoch) {
+        break;
+      }
+      std::this_thread::yield();
+    }
+  }
+}
+
+uint64_t EpochReclaimer::GetMinActiveEpoch() {
+  uint64_t min_epoch = epoch_.load();
+  for (int32_t i = 0; i < num_slots_; i++) {
+    const uint64_t slot_epoch = reader_slots_[i].epoch.load();
+    if (slot_epoch != 0) {
+      min_epoch = std::min(min_epoch, slot_epoch);
+    }
+  }
+  return min_epoch;
+}
+
+void EpochReclaimer::Reclaim(RetireShard* shard) {
+  epoch_.fetch_add(1);
+  const uint64_t min_epoch = GetMinActiveEpoch();
+  auto& retired = shard->retired;
+  auto it = std::partition(retired.begin(), retired.end(),
+                           [&](const RetireShard::Retired& item) {
+                             return item.epoch >= min_epoch;
+                           });
+  for (auto free_it = it; free_it != retired.end(); ++free_it) {
+    free_it->deleter(free_it->ptr);
+  }
+  retired.erase(it, retired.end());
+}
+
+TaskQueue::TaskQueue() : running_(false) {}
+
+TaskQueue::~TaskQueue() {
+  Stop();
+}
+
+void TaskQueue::Start(int32_t num_worker_threads) {
+  assert(num_worker_threads > 0);
+  std::lock_guard<std::mutex> lock(mutex_);
+  assert(!running_);
+  running_ = true;
+  threads_.reserve(num_worker_threads);
+  for (int32_t i = 0; i < num_worker_threads; i++) {
+    threads_.emplace_back([this]() { Work(); });
+  }
+}
+
+void TaskQueue::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!running_) {
+      return;
+    }
+    running_ = false;
+  }
+  cond_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+  threads_.clear();
+}
+
+void TaskQueue::Add(Task task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+      tasks_.emplace_back(std::move(task));
+      cond_.notify_one();
+      return;
+    }
+  }
+  task();
+}
+
+int64_t TaskQueue::GetSize() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return tasks_.size();
+}
+
+TaskQueue* TaskQueue::GetSharedIOQueue() {
+  static TaskQueue queue;
+  static std::once_flag once;
+  std::call_once(once, []() {
+    const int32_t num_cores = std::thread::hardware_concurrency();
+    queue.Start(std::max(8, num_cores * 2));
+  });
+  return &queue;
+}
+
+void TaskQueue::Work() {
+  while (true) {
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cond_.wait(lock, [this]() { return !tasks_.empty() || !running_; });
+      if (tasks_.empty()) {
+        break;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
 }  // namespace tkrzw
 
 // END OF FILE
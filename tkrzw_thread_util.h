@@ -15,9 +15,14 @@
 #define _TKRZW_THREAD_UTIL_H
 
 #include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
 #include <shared_mutex>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <vector>
 
 #include <cinttypes>
@@ -38,6 +43,18 @@ double GetWallTime();
  */
 void Sleep(double sec);
 
+/**
+ * Runs a task for each index with multiple threads.
+ * @param num_tasks The number of tasks.
+ * @param num_threads The maximum number of threads, including the calling thread.
+ * @param task The function called with each index from 0 to num_tasks - 1.
+ * @details Each thread takes the next index until all tasks are done.  This function returns
+ * after all tasks are done.  If num_threads is 1 or less, the tasks are done in order by the
+ * calling thread.
+ */
+void ParallelFor(int32_t num_tasks, int32_t num_threads,
+                 const std::function<void(int32_t)>& task);
+
 /**
  * Slotted shared mutex.
  */
@@ -307,6 +324,150 @@ class ScopedHashLock final {
   bool writable_;
 };
 
+/**
+ * Epoch-based reclamation of memory shared with optimistic readers.
+ * @details Readers enter a critical section before reading shared data without locks and
+ * leave it after that.  Writers retire unlinked memory instead of freeing it.  Retired memory
+ * is freed when all readers which might see it have left their critical sections.  Each
+ * reader occupies its own slot on a separate cache line, so entering and leaving a critical
+ * section doesn't contend with other readers.
+ */
+class EpochReclaimer final {
+ public:
+  /** The type of functions to free retired memory. */
+  typedef void (*Deleter)(void*);
+
+  /**
+   * Constructor.
+   * @param num_slots The number of slots for readers.
+   */
+  explicit EpochReclaimer(int32_t num_slots = 128);
+
+  /**
+   * Destructor.
+   * @details All retired memory is freed.  No reader must be in a critical section.
+   */
+  ~EpochReclaimer();
+
+  /**
+   * Enters a critical section.
+   * @return The index of the slot of the reader, or -1 if all slots are occupied.
+   * @details If the return value is -1, the caller must read the data with locks.
+   */
+  int32_t Enter();
+
+  /**
+   * Leaves a critical section.
+   * @param slot_index The index of the slot returned by the Enter method.
+   */
+  void Leave(int32_t slot_index);
+
+  /**
+   * Retires memory which is no longer reachable by new readers.
+   * @param ptr The pointer to the memory.
+   * @param deleter The function to free the memory.
+   */
+  void Retire(void* ptr, Deleter deleter);
+
+  /**
+   * Waits until all readers which have entered critical sections before leave them.
+   */
+  void Synchronize();
+
+ private:
+  /** The slot of a reader. */
+  struct ReaderSlot;
+  /** The shard of retired memory. */
+  struct RetireShard;
+  /**
+   * Gets the minimum epoch of active readers.
+   */
+  uint64_t GetMinActiveEpoch();
+  /**
+   * Frees retired memory which no reader can see.
+   */
+  void Reclaim(RetireShard* shard);
+
+  /** The number of the slots. */
+  int32_t num_slots_;
+  /** The current epoch. */
+  std::atomic_uint64_t epoch_;
+  /** The array of the reader slots. */
+  ReaderSlot* reader_slots_;
+  /** The array of the retire shards. */
+  RetireShard* retire_shards_;
+};
+
+/**
+ * Queue of tasks done by a fixed number of worker threads.
+ * @details Tasks are done in the order of addition by any of the worker threads.  This class is
+ * used to do blocking operations asynchronously without a thread per operation.
+ */
+class TaskQueue final {
+ public:
+  /** The type of tasks. */
+  typedef std::function<void()> Task;
+
+  /**
+   * Default constructor.
+   */
+  TaskQueue();
+
+  /**
+   * Destructor.
+   * @details The worker threads are stopped after all tasks are done.
+   */
+  ~TaskQueue();
+
+  /**
+   * Starts the worker threads.
+   * @param num_worker_threads The number of the worker threads.
+   * @details This must not be called while the worker threads are running.
+   */
+  void Start(int32_t num_worker_threads);
+
+  /**
+   * Stops the worker threads after all tasks are done.
+   */
+  void Stop();
+
+  /**
+   * Adds a task to the queue.
+   * @param task The task to be done.
+   * @details If the worker threads are not running, the task is done by the calling thread.
+   */
+  void Add(Task task);
+
+  /**
+   * Gets the number of tasks which have not been started.
+   * @return The number of tasks which have not been started.
+   */
+  int64_t GetSize();
+
+  /**
+   * Gets the queue shared in the process to do asynchronous I/O operations.
+   * @return The pointer to the shared queue, whose worker threads are started on the first call.
+   */
+  static TaskQueue* GetSharedIOQueue();
+
+ private:
+  /**
+   * Takes tasks and does them until the queue is stopped.
+   */
+  void Work();
+
+  /** The mutex for the tasks. */
+  std::mutex mutex_;
+  /** The condition variable to notify addition of tasks. */
+  std::condition_variable cond_;
+  /** The tasks which have not been started. */
+  std::deque<Task> tasks_;
+  /** The worker threads. */
+  std::vector<std::thread> threads_;
+  /** Whether the worker threads are running. */
+  bool running_;
+};
+
 }  // namespace tkrzw
 
 #endif  // _TKRZW_THREAD_UTIL_H
@@ -35,6 +35,29 @@ TEST(ThreadUtilTest, GetWallTimeAndSleep) {
   EXPECT_GT(end_time, start_time);
 }
 
+TEST(ThreadUtilTest, ParallelFor) {
+  for (const int32_t num_threads : {0, 1, 4, 16}) {
+    constexpr int32_t num_tasks = 10;
+    std::vector<std::atomic_int32_t> counts(num_tasks);
+    std::set<std::thread::id> thread_ids;
+    std::mutex mutex;
+    tkrzw::ParallelFor(num_tasks, num_threads, [&](int32_t index) {
+      counts[index].fetch_add(1);
+      std::lock_guard<std::mutex> lock(mutex);
+      thread_ids.emplace(std::this_thread::get_id());
+    });
+    for (const auto& count : counts) {
+      EXPECT_EQ(1, count.load());
+    }
+    EXPECT_LE(static_cast<int32_t>(thread_ids.size()), std::max(1, num_threads));
+    if (num_threads <= 1) {
+      EXPECT_EQ(1, thread_ids.size());
+      EXPECT_EQ(std::this_thread::get_id(), *thread_ids.begin());
+    }
+  }
+  tkrzw::ParallelFor(0, 4, [&](int32_t index) { FAIL(); });
+}
+
 TEST(ThreadUtilTest, SlottedMutex) {
   constexpr int32_t num_threads = 5;
   constexpr int32_t num_iterations = 20000;
@@ -304,4 +327,97 @@ TEST(ThreadUtilTest, HashMutex) {
   }
 }
 
+TEST(ThreadUtilTest, EpochReclaimer) {
+  constexpr int32_t num_threads = 5;
+  constexpr int32_t num_iterations = 20000;
+  constexpr int64_t magic = 0x12345678;
+  static std::atomic_int64_t num_freed;
+  num_freed.store(0);
+  struct Cell {
+    std::atomic_int64_t value;
+  };
+  auto deleter = [](void* ptr) {
+    Cell* cell = static_cast<Cell*>(ptr);
+    cell->value.store(0);
+    delete cell;
+    num_freed.fetch_add(1);
+  };
+  int64_t num_retired = 0;
+  {
+    tkrzw::EpochReclaimer reclaimer(4);
+    std::atomic<Cell*> shared(new Cell{{magic}});
+    std::atomic_int64_t num_retired_all(0);
+    auto func = [&](int32_t id) {
+      std::mt19937 mt(id);
+      std::uniform_int_distribution<int32_t> writable_dist(0, 3);
+      for (int32_t i = 0; i < num_iterations; i++) {
+        if (writable_dist(mt) == 0) {
+          Cell* old_cell = shared.exchange(new Cell{{magic}});
+          reclaimer.Retire(old_cell, deleter);
+          num_retired_all.fetch_add(1);
+        } else {
+          const int32_t slot_index = reclaimer.Enter();
+          if (slot_index < 0) {
+            continue;
+          }
+          const Cell* cell = shared.load();
+          std::this_thread::yield();
+          EXPECT_EQ(magic, cell->value.load());
+          reclaimer.Leave(slot_index);
+        }
+      }
+    };
+    std::vector<std::thread> threads;
+    for (int32_t i = 0; i < num_threads; i++) {
+      threads.emplace_back(std::thread(func, i));
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    num_retired = num_retired_all.load();
+    EXPECT_GT(num_retired, 0);
+    EXPECT_GT(num_freed.load(), 0);
+    const int32_t slot_index = reclaimer.Enter();
+    EXPECT_GE(slot_index, 0);
+    reclaimer.Leave(slot_index);
+    reclaimer.Synchronize();
+    delete shared.load();
+  }
+  EXPECT_EQ(num_retired, num_freed.load());
+}
+
+TEST(ThreadUtilTest, TaskQueue) {
+  tkrzw::TaskQueue queue;
+  std::atomic_int32_t count(0);
+  queue.Add([&]() { count.fetch_add(1); });
+  EXPECT_EQ(1, count.load());
+  EXPECT_EQ(0, queue.GetSize());
+  constexpr int32_t num_tasks = 1000;
+  queue.Start(4);
+  std::set<std::thread::id> thread_ids;
+  std::mutex mutex;
+  for (int32_t i = 0; i < num_tasks; i++) {
+    queue.Add([&]() {
+      count.fetch_add(1);
+      std::lock_guard<std::mutex> lock(mutex);
+      thread_ids.emplace(std::this_thread::get_id());
+    });
+  }
+  queue.Stop();
+  EXPECT_EQ(num_tasks + 1, count.load());
+  EXPECT_EQ(0, queue.GetSize());
+  EXPECT_LE(thread_ids.size(), 4);
+  EXPECT_EQ(0, thread_ids.count(std::this_thread::get_id()));
+  queue.Start(2);
+  std::promise<int32_t> promise;
+  auto future = promise.get_future();
+  queue.Add([&]() { promise.set_value(123); });
+  EXPECT_EQ(123, future.get());
+  tkrzw::TaskQueue* shared_queue = tkrzw::TaskQueue::GetSharedIOQueue();
+  EXPECT_EQ(shared_queue, tkrzw::TaskQueue::GetSharedIOQueue());
+  std::promise<bool> shared_promise;
+  shared_queue->Add([&]() { shared_promise.set_value(true); });
+  EXPECT_TRUE(shared_promise.get_future().get());
+}
+
 // END OF FILE